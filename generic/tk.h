@@ -891,6 +891,38 @@ typedef struct Tk_FakeWin {
  *                              Used on macOS to indicate that key events can be
  *                              processed with the NSTextInputClient protocol.
  *                              Not currently accessible through the public API.
+ * TK_OBSCURED			1 means that the window is completely hidden
+ *				behind other windows, as reported by the most
+ *				recent VisibilityNotify event.  Display
+ *				procedures may skip repainting while this is
+ *				set on a window or one of its ancestors; the
+ *				Expose events generated when the window is
+ *				uncovered replay the repaint.
+ * TK_WM_TRANSACTION		1 means a construction transaction started
+ *				with [wm transaction begin] is open on this
+ *				toplevel: tiered idle callbacks are held and
+ *				mapping is deferred until the commit.
+ * TK_DEFERRED_MAP		1 means Tk_MapWindow was called on this
+ *				toplevel while a construction transaction was
+ *				open; the map is performed at commit time.
+ * TK_WIN_OPAQUE		1 means the widget mapped on this window is
+ *				known to cover its entire allocated rectangle
+ *				with its own background, so nothing an
+ *				ancestor draws beneath it can ever become
+ *				visible.  Set automatically when a solid
+ *				background is assigned with
+ *				Tk_SetWindowBackground, and declared
+ *				explicitly by widgets that paint their whole
+ *				area themselves (e.g. the themed widgets).
+ *				Containers consult it (via
+ *				TkWindowAreaObscured) to skip background
+ *				fills underneath their children.
+ * TK_RESTACK_PENDING		1 means a batched restack of this window is
+ *				waiting to be sent to the server; the window
+ *				is recorded in its display's restack list
+ *				and the request is issued when the list is
+ *				flushed, just before the next round of
+ *				redisplays.
  */
 
 #define TK_MAPPED		1
@@ -914,6 +946,11 @@ typedef struct Tk_FakeWin {
 #define TK_PROP_PROPCHANGE	0x40000
 #define TK_WM_MANAGEABLE	0x80000
 #define TK_CAN_INPUT_TEXT       0x100000
+#define TK_OBSCURED		0x200000
+#define TK_WM_TRANSACTION	0x400000
+#define TK_DEFERRED_MAP		0x800000
+#define TK_WIN_OPAQUE		0x1000000
+#define TK_RESTACK_PENDING	0x2000000
 
 /*
  *----------------------------------------------------------------------
@@ -1303,6 +1340,18 @@ typedef struct Tk_PhotoImageBlock {
 #define TK_PHOTO_COMPOSITE_OVERLAY	0
 #define TK_PHOTO_COMPOSITE_SET		1
 
+/*
+ * The following flag may be OR'ed into the compositing rule passed to
+ * Tk_PhotoPutBlock. It transfers ownership of blockPtr->pixelPtr, which
+ * must have been allocated with Tk_AttemptAlloc and must not point into
+ * the image's own storage, to the photo image. When the block exactly
+ * matches the image's internal 32-bit RGBA layout the buffer is adopted
+ * as the image's pixel storage without copying; otherwise it is copied
+ * and freed. Either way the caller must not use the buffer afterwards.
+ */
+
+#define TK_PHOTO_ADOPT			8
+
 /*
  * Procedure prototypes and structures used in reading and writing photo
  * images:
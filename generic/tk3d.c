@@ -1432,6 +1432,94 @@ Tk_Get3DBorderColors(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkComputeShadowColors --
+ *
+ *	Computes the light and dark shadow colors for a 3-D border from its
+ *	background color.  The ramp is a pure function of the base color, so
+ *	it is shared here rather than recomputed in each platform's
+ *	TkpGetShadows.  The shadow colors get computed using whichever
+ *	formula results in the greatest change in color:
+ *	1. Lighter shadow is half-way to white, darker shadow is half way to
+ *	   dark.
+ *	2. Lighter shadow is 40% brighter than background, darker shadow is
+ *	   40% darker than background.
+ *
+ * Results:
+ *	Stores the red, green and blue fields of *lightPtr and *darkPtr.
+ *
+ * Side effects:
+ *	None.  No colors are allocated; that is up to the caller.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkComputeShadowColors(
+    XColor *bgPtr,		/* Background color of the border. */
+    XColor *lightPtr,		/* Filled in with the light shadow color. */
+    XColor *darkPtr)		/* Filled in with the dark shadow color. */
+{
+    int r, g, b, tmp1, tmp2;
+
+    /*
+     * For the dark shadow, cut 40% from each of the background color
+     * components.  But if the background is already very dark, make the dark
+     * color a little lighter than the background by increasing each color
+     * component 1/4th of the way to MAX_INTENSITY.
+     *
+     * For the light shadow, boost each component by 40% or half-way to
+     * white, whichever is greater (the first approach works better for
+     * unsaturated colors, the second for saturated ones).  But if the
+     * background is already very bright, instead choose a slightly darker
+     * color for the light shadow by reducing each color component by 10%.
+     *
+     * Compute the colors using integers, not using lightPtr->red etc.: these
+     * are shorts and may have problems with integer overflow.
+     */
+
+    r = (int) bgPtr->red;
+    g = (int) bgPtr->green;
+    b = (int) bgPtr->blue;
+
+    if (r*0.5*r + g*1.0*g + b*0.28*b < MAX_INTENSITY*0.05*MAX_INTENSITY) {
+	darkPtr->red = (MAX_INTENSITY + 3*r)/4;
+	darkPtr->green = (MAX_INTENSITY + 3*g)/4;
+	darkPtr->blue = (MAX_INTENSITY + 3*b)/4;
+    } else {
+	darkPtr->red = (60 * r)/100;
+	darkPtr->green = (60 * g)/100;
+	darkPtr->blue = (60 * b)/100;
+    }
+
+    if (g > MAX_INTENSITY*0.95) {
+	lightPtr->red = (90 * r)/100;
+	lightPtr->green = (90 * g)/100;
+	lightPtr->blue = (90 * b)/100;
+    } else {
+	tmp1 = (14 * r)/10;
+	if (tmp1 > MAX_INTENSITY) {
+	    tmp1 = MAX_INTENSITY;
+	}
+	tmp2 = (MAX_INTENSITY + r)/2;
+	lightPtr->red = (tmp1 > tmp2) ? tmp1 : tmp2;
+	tmp1 = (14 * g)/10;
+	if (tmp1 > MAX_INTENSITY) {
+	    tmp1 = MAX_INTENSITY;
+	}
+	tmp2 = (MAX_INTENSITY + g)/2;
+	lightPtr->green = (tmp1 > tmp2) ? tmp1 : tmp2;
+	tmp1 = (14 * b)/10;
+	if (tmp1 > MAX_INTENSITY) {
+	    tmp1 = MAX_INTENSITY;
+	}
+	tmp2 = (MAX_INTENSITY + b)/2;
+	lightPtr->blue = (tmp1 > tmp2) ? tmp1 : tmp2;
+    }
+}
+
 /*
  * Local Variables:
  * mode: c
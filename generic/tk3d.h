@@ -78,6 +78,8 @@ typedef struct TkBorder {
  * Declarations for platform specific interfaces used by this module.
  */
 
+MODULE_SCOPE void	TkComputeShadowColors(XColor *bgPtr,
+			    XColor *lightPtr, XColor *darkPtr);
 MODULE_SCOPE TkBorder	*TkpGetBorder(void);
 MODULE_SCOPE void	TkpGetShadows(TkBorder *borderPtr, Tk_Window tkwin);
 MODULE_SCOPE void	TkpFreeBorder(TkBorder *borderPtr);
@@ -58,11 +58,12 @@
 
 /*************************************************************************/
 /*
- * Two array types will be provided:
+ * Three array types will be provided:
  * Use TK_ARRAY_DEFINE if your array is aggregating the elements. Use
  * TK_PTR_ARRAY_DEFINE if your array contains pointers to elements. But
  * in latter case the array is not responsible for the lifetime of the
- * elements.
+ * elements. Use TK_SMALL_ARRAY_DEFINE for an array that lives by value
+ * inside its owner and keeps small sizes in inline storage (see below).
  */
 /*************************************************************************/
 /*
@@ -597,6 +598,205 @@ AT##_Contains(const AT *arr, const ElemType *elem)				\
     return AT##_Find(arr, elem) != -1;						\
 }										\
 /* ------------------------------------------------------------------------- */
+
+/*
+ * A small array (TK_SMALL_ARRAY_DEFINE) differs from the two array types
+ * above: it lives by value inside its owner, so the array itself costs no
+ * allocation, and it stores up to InlineCapacity elements inline, only
+ * spilling into a ckalloc'ed buffer (with geometric growth) beyond that.
+ * Use it for arrays that are almost always small, where the common case
+ * should not touch the heap. The elements may be read and written directly
+ * through the "buf" member. Because "buf" points into the struct itself
+ * while the inline storage is in use, the struct must not be relocated
+ * with memcpy; use Array_Move to transfer the contents instead.
+ * -------------------------------------------------------------------------------
+ * typedef struct { int key, value; } Pair;
+ * TK_SMALL_ARRAY_DEFINE(MyArray, Pair, 4);
+ * Pair p = { 1, 2 };
+ * MyArray arr;
+ * MyArray_Init(&arr);
+ * MyArray_Append(&arr, &p);
+ * for (i = 0; i < MyArray_Size(&arr); ++i) {
+ *     printf("%d -> %d\n", arr.buf[i].key, arr.buf[i].value);
+ * }
+ * MyArray_Free(&arr);
+ * -------------------------------------------------------------------------------
+ */
+
+#define TK_SMALL_ARRAY_DEFINE(AT, ElemType, InlineCapacity) /* AT = type of array */\
+/* ------------------------------------------------------------------------- */	\
+typedef struct AT {								\
+    size_t size;								\
+    size_t capacity;								\
+    ElemType *buf;								\
+    ElemType inlineBuf[InlineCapacity];						\
+} AT;										\
+										\
+__TK_ARRAY_UNUSED								\
+static void									\
+AT##_Init(AT *arr)								\
+{										\
+    assert(arr);								\
+    arr->size = 0;								\
+    arr->capacity = InlineCapacity;						\
+    arr->buf = arr->inlineBuf;							\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static int									\
+AT##_IsEmpty(const AT *arr)							\
+{										\
+    assert(arr);								\
+    return arr->size == 0u;							\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static size_t									\
+AT##_Size(const AT *arr)							\
+{										\
+    assert(arr);								\
+    return arr->size;								\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static size_t									\
+AT##_Capacity(const AT *arr)							\
+{										\
+    assert(arr);								\
+    return arr->capacity;							\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static ElemType *								\
+AT##_First(AT *arr)								\
+{										\
+    assert(arr);								\
+    return arr->buf;								\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static ElemType *								\
+AT##_Last(AT *arr)								\
+{										\
+    assert(arr);								\
+    return arr->buf + arr->size;						\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static void									\
+AT##_Reserve(AT *arr, size_t numElems)						\
+{										\
+    assert(arr);								\
+    if (numElems > arr->capacity) {						\
+	size_t newCapacity = arr->capacity + arr->capacity/2;			\
+	if (newCapacity < numElems) {						\
+	    newCapacity = numElems;						\
+	}									\
+	if (arr->buf == arr->inlineBuf) {					\
+	    arr->buf = (ElemType *)ckalloc(newCapacity*sizeof(ElemType));	\
+	    memcpy(arr->buf, arr->inlineBuf, arr->size*sizeof(ElemType));	\
+	} else {								\
+	    arr->buf = (ElemType *)ckrealloc(arr->buf, newCapacity*sizeof(ElemType));\
+	}									\
+	arr->capacity = newCapacity;						\
+    }										\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static void									\
+AT##_SetSize(AT *arr, size_t newSize)						\
+{										\
+    assert(arr);								\
+    assert(newSize <= arr->capacity);						\
+    arr->size = newSize;							\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static void									\
+AT##_Append(AT *arr, ElemType *elem)						\
+{										\
+    assert(arr);								\
+    AT##_Reserve(arr, arr->size + 1);						\
+    arr->buf[arr->size++] = *elem;						\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static size_t									\
+AT##_PopBack(AT *arr)								\
+{										\
+    assert(!AT##_IsEmpty(arr));							\
+    return arr->size -= 1;							\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static ElemType *								\
+AT##_Get(const AT *arr, size_t at)						\
+{										\
+    assert(arr);								\
+    assert(at < arr->size);							\
+    return (ElemType *) &arr->buf[at];						\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static void									\
+AT##_Set(AT *arr, size_t at, ElemType *elem)					\
+{										\
+    assert(arr);								\
+    assert(at < arr->size);							\
+    arr->buf[at] = *elem;							\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static void									\
+AT##_Move(AT *dstArr, AT *srcArr)						\
+{										\
+    assert(dstArr);								\
+    assert(srcArr);								\
+    assert(dstArr != srcArr);							\
+    dstArr->size = srcArr->size;						\
+    if (srcArr->buf == srcArr->inlineBuf) {					\
+	dstArr->capacity = InlineCapacity;					\
+	dstArr->buf = dstArr->inlineBuf;					\
+	memcpy(dstArr->buf, srcArr->buf, srcArr->size*sizeof(ElemType));	\
+    } else {									\
+	dstArr->capacity = srcArr->capacity;					\
+	dstArr->buf = srcArr->buf;						\
+    }										\
+    AT##_Init(srcArr);								\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static void									\
+AT##_Free(AT *arr)								\
+{										\
+    assert(arr);								\
+    if (arr->buf != arr->inlineBuf) {						\
+	ckfree(arr->buf);							\
+    }										\
+    AT##_Init(arr);								\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static int									\
+AT##_Find(const AT *arr, const ElemType *elem)					\
+{										\
+    size_t i;									\
+    assert(arr);								\
+    for (i = 0; i < arr->size; ++i) {						\
+	if (memcmp(&arr->buf[i], elem, sizeof(ElemType)) == 0) {		\
+	    return (int) i;							\
+	}									\
+    }										\
+    return -1;									\
+}										\
+										\
+__TK_ARRAY_UNUSED								\
+static int									\
+AT##_Contains(const AT *arr, const ElemType *elem)				\
+{										\
+    return AT##_Find(arr, elem) != -1;						\
+}
+/* ------------------------------------------------------------------------- */
 
 #endif /* TK_ARRAY_DEFINED */
 
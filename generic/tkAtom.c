@@ -47,6 +47,27 @@ static const char *const atomNameArray[] = {
     NULL
 };
 
+/*
+ * The following list contains the names of atoms that Tk is likely to ask
+ * for later on: the bursts issued by the selection, clipboard and window
+ * manager code, plus the virtual-root query and the "send" registry. They
+ * are interned with a single XInternAtoms round trip when a display's atom
+ * cache is initialized, so each name's first use becomes a cache hit
+ * instead of a separate synchronous server round trip.
+ */
+
+static const char *const prefetchNameArray[] = {
+    "MULTIPLE",		"INCR",			"TARGETS",
+    "TIMESTAMP",	"TEXT",			"COMPOUND_TEXT",
+    "UTF8_STRING",	"ATOM_PAIR",		"CLIPBOARD",
+    "TK_APPLICATION",	"TK_WINDOW",		"WM_PROTOCOLS",
+    "WM_DELETE_WINDOW",	"_NET_WM_PING",		"_NET_WM_STATE",
+    "_NET_WM_STATE_ABOVE",			"_NET_WM_STATE_MAXIMIZED_VERT",
+    "_NET_WM_STATE_MAXIMIZED_HORZ",		"_NET_WM_STATE_FULLSCREEN",
+    "_NET_WM_WINDOW_TYPE",			"__WM_ROOT",
+    "__SWM_ROOT",	"Comm"
+};
+
 /*
  * Forward references to functions defined in this file:
  */
@@ -204,6 +225,35 @@ AtomInit(
 	hPtr = Tcl_CreateHashEntry(&dispPtr->atomTable, INT2PTR(atom), &isNew);
 	Tcl_SetHashValue(hPtr, (char *)name);
     }
+
+    /*
+     * Prefetch the atoms that Tk is known to use, all in one server round
+     * trip.
+     */
+
+    {
+	Atom atoms[sizeof(prefetchNameArray) / sizeof(char *)];
+	int i, isNew;
+	int count = (int) (sizeof(prefetchNameArray) / sizeof(char *));
+	const char *name2;
+
+	if (XInternAtoms(dispPtr->display, (char **) prefetchNameArray,
+		count, False, atoms) != 0) {
+	    for (i = 0; i < count; i++) {
+		hPtr = Tcl_CreateHashEntry(&dispPtr->nameTable,
+			prefetchNameArray[i], &isNew);
+		if (!isNew) {
+		    continue;
+		}
+		Tcl_SetHashValue(hPtr, INT2PTR(atoms[i]));
+		name2 = (const char *)Tcl_GetHashKey(&dispPtr->nameTable,
+			hPtr);
+		hPtr = Tcl_CreateHashEntry(&dispPtr->atomTable,
+			INT2PTR(atoms[i]), &isNew);
+		Tcl_SetHashValue(hPtr, (char *)name2);
+	    }
+	}
+    }
 }
 
 /*
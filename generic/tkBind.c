@@ -287,6 +287,33 @@ TK_PTR_ARRAY_DEFINE(VirtOwners, Tcl_HashEntry); /* define array of hash entries
  * binding tables and virtual event tables.
  */
 
+/*
+ * At bind time the binding script is scanned once for % sequences and the
+ * result is stored as a substitution plan: an alternating list of literal
+ * text runs and percent characters. At fire time ExpandPercents only walks
+ * this plan, so scripts are not re-parsed for every matched event.
+ */
+
+typedef struct SubstSpec {
+    const char *literal;	/* Literal text preceding the percent sequence. Points into the
+    				 * script of the owning PatSeq. */
+    Tcl_Size length;		/* Number of bytes of literal text (possibly zero). */
+    int spec;			/* Percent character to substitute after the literal text, or -1
+    				 * at the end of the script. */
+} SubstSpec;
+
+typedef struct SubstPlan {
+    unsigned numSpecs;		/* Number of entries in specs. */
+    SubstSpec specs[1];		/* Array of "numSpecs" entries; enough space will be allocated
+    				 * for all of them. */
+} SubstPlan;
+
+/*
+ * Compute memory size of struct SubstPlan with given number of entries.
+ * The caller must be sure that the number of entries is greater than zero.
+ */
+#define SUBSTPLAN_MEMSIZE(numSpecs) (sizeof(SubstPlan) + (numSpecs - 1)*sizeof(SubstSpec))
+
 typedef struct PatSeq {
     unsigned numPats;		/* Number of patterns in sequence (usually 1). */
     unsigned count;		/* Total number of repetition counts, summed over count in TkPattern. */
@@ -297,6 +324,8 @@ typedef struct PatSeq {
     unsigned modMaskUsed:1;	/* Does at least one pattern contain a non-zero modifier mask? */
     DEBUG(unsigned owned:1;)	/* For debugging purposes. */
     char *script;		/* Binding script to evaluate when sequence matches (ckalloc()ed) */
+    SubstPlan *planPtr;		/* Substitution plan compiled from script, or NULL if the script
+    				 * contains no percent sequences (ckalloc()ed) */
     Tcl_Obj* object;		/* Token for object with which binding is associated. For virtual
     				 * event table this is NULL. */
     struct PatSeq *nextSeqPtr;	/* Next in list of all pattern sequences that have the same initial
@@ -721,8 +750,9 @@ static int		CreateVirtualEvent(Tcl_Interp *interp, VirtualEventTable *vetPtr,
 			    char *virtString, const char *eventString);
 static int		DeleteVirtualEvent(Tcl_Interp *interp, VirtualEventTable *vetPtr,
 			    char *virtString, const char *eventString);
+static SubstPlan *	CompileSubstPlan(const char *script);
 static void		DeleteVirtualEventTable(VirtualEventTable *vetPtr);
-static void		ExpandPercents(TkWindow *winPtr, const char *before, Event *eventPtr,
+static void		ExpandPercents(TkWindow *winPtr, const PatSeq *psPtr, Event *eventPtr,
 			    unsigned scriptCount, Tcl_DString *dsPtr);
 static PatSeq *		FindSequence(Tcl_Interp *interp, LookupTables *lookupTables,
 			    void *object, const char *eventString, int create,
@@ -916,6 +946,9 @@ FreePatSeq(
     assert(!psPtr->owned);
     DEBUG(MARK_PSENTRY(psPtr);)
     ckfree(psPtr->script);
+    if (psPtr->planPtr) {
+	ckfree(psPtr->planPtr);
+    }
     if (!psPtr->object) {
 	VirtOwners_Free(&psPtr->ptr.owners);
     }
@@ -1718,6 +1751,10 @@ Tk_CreateBinding(
     }
     ckfree(oldStr);
     psPtr->script = newStr;
+    if (psPtr->planPtr) {
+	ckfree(psPtr->planPtr);
+    }
+    psPtr->planPtr = CompileSubstPlan(newStr);
     return eventMask;
 }
 
@@ -2490,7 +2527,7 @@ Tk_BindEvent(
 	}
 
 	if (matchPtrArr[k]) {
-	    ExpandPercents(winPtr, matchPtrArr[k]->script, curEvent, scriptCount++, &scripts);
+	    ExpandPercents(winPtr, matchPtrArr[k], curEvent, scriptCount++, &scripts);
 	    /* Null is added to the scripts string to separate the various scripts. */
 	    Tcl_DStringAppend(&scripts, "", 1);
 	}
@@ -2819,6 +2856,7 @@ MatchPatterns(
     PatSeq *bestPtr;
     PatSeq *bestPhysPtr;
     unsigned bestModMask;
+    unsigned curModMask;
     const PSModMaskArr *bestModMaskArr = NULL;
     int isModKeyOnly = 0;
     Tcl_Size i;
@@ -2836,6 +2874,12 @@ MatchPatterns(
     bestPhysPtr = NULL;
     window = curEvent->xev.xany.window;
 
+    /*
+     * The current modifier state is the same for all candidates, so resolve
+     * the Alt and Meta modifiers once instead of per list entry.
+     */
+    curModMask = ResolveModifiers(dispPtr, bindPtr->curModMask);
+
     /*
      * Modifier key events interlaced between patterns parts of a
      * sequence shall not prevent a sequence from ultimately
@@ -2887,7 +2931,6 @@ MatchPatterns(
 		     * be the better place.
 		     */
 		    unsigned modMask = ResolveModifiers(dispPtr, patPtr->modMask);
-		    unsigned curModMask = ResolveModifiers(dispPtr, bindPtr->curModMask);
 
 		    psEntry->expired = 1; /* Remove it from promotion list. */
                     psEntry->keepIt = 0;  /* Don't keep matching patterns. */
@@ -2978,13 +3021,89 @@ MatchPatterns(
     return bestPtr;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * CompileSubstPlan --
+ *
+ *	Scan a binding script for % sequences and build the substitution plan
+ *	that ExpandPercents walks at fire time. This is done once, when the
+ *	script is bound.
+ *
+ * Results:
+ *	The return value is a ckalloc()ed substitution plan, or NULL if the
+ *	script contains no percent characters and can be used verbatim.
+ *
+ * Side effects:
+ *	Memory is allocated.
+ *
+ *--------------------------------------------------------------
+ */
+
+static SubstPlan *
+CompileSubstPlan(
+    const char *script)		/* Binding script to scan for percent sequences. */
+{
+    SubstPlan *planPtr;
+    const char *p;
+    unsigned numSpecs;
+    unsigned i;
+
+    assert(script);
+
+    if (!strchr(script, '%')) {
+	return NULL;
+    }
+
+    /*
+     * Count the percent sequences. The literal tail of the script (possibly
+     * empty) occupies one extra entry.
+     */
+
+    numSpecs = 1;
+    for (p = script; *p; ++p) {
+	if (*p == '%' && p[1]) {
+	    numSpecs += 1;
+	    ++p;
+	}
+    }
+
+    planPtr = (SubstPlan *)ckalloc(SUBSTPLAN_MEMSIZE(numSpecs));
+    planPtr->numSpecs = numSpecs;
+
+    i = 0;
+    p = script;
+    while (1) {
+	const char *start = p;
+
+	while (*p && *p != '%') {
+	    ++p;
+	}
+	planPtr->specs[i].literal = start;
+	planPtr->specs[i].length = (Tcl_Size)(p - start);
+	if (!*p) {
+	    planPtr->specs[i++].spec = -1;
+	    break;
+	}
+	planPtr->specs[i++].spec = (unsigned char) p[1];
+	if (!p[1]) {
+	    break;
+	}
+	p += 2;
+    }
+    assert(i == numSpecs);
+
+    return planPtr;
+}
+
 /*
  *--------------------------------------------------------------
  *
  * ExpandPercents --
  *
- *	Given a command and an event, produce a new command by replacing %
- *	constructs in the original command with information from the X event.
+ *	Given a pattern sequence and an event, produce a new command by
+ *	replacing % constructs in the bound script with information from the
+ *	X event, following the substitution plan compiled at bind time.
  *
  * Results:
  *	The new expanded command is appended to the dynamic string given by
@@ -2999,7 +3118,8 @@ MatchPatterns(
 static void
 ExpandPercents(
     TkWindow *winPtr,		/* Window where event occurred: needed to get input context. */
-    const char *before,		/* Command containing percent expressions to be replaced. */
+    const PatSeq *psPtr,	/* Matched pattern sequence whose script contains the percent
+    				 * expressions to be replaced. */
     Event *eventPtr,		/* Event containing information to be used in % replacements. */
     unsigned scriptCount,	/* The number of script-based binding patterns matched so far for
     				 * this event. */
@@ -3008,12 +3128,25 @@ ExpandPercents(
     unsigned flags;
     Tcl_DString buf;
     XEvent *evPtr;
+    const SubstPlan *planPtr;
+    unsigned i;
 
     assert(winPtr);
-    assert(before);
+    assert(psPtr);
+    assert(psPtr->script);
     assert(eventPtr);
     assert(dsPtr);
 
+    planPtr = psPtr->planPtr;
+    if (!planPtr) {
+	/*
+	 * The script contains no percent sequences; append it verbatim.
+	 */
+
+	Tcl_DStringAppend(dsPtr, psPtr->script, TCL_INDEX_NONE);
+	return;
+    }
+
     Tcl_DStringInit(&buf);
     evPtr = &eventPtr->xev;
     flags = (evPtr->type < TK_LASTEVENT) ? flagArray[evPtr->type] : 0;
@@ -3028,33 +3161,26 @@ ExpandPercents(
 	string = numStorage;						\
     }
 
-    while (1) {
+    for (i = 0; i < planPtr->numSpecs; ++i) {
+	const SubstSpec *specPtr = &planPtr->specs[i];
 	char numStorage[TCL_INTEGER_SPACE];
 	const char *string;
 	long long number;     /* signed */
 	unsigned long long unumber;   /* unsigned */
 
 	/*
-	 * Find everything up to the next % character and append it to the
-	 * result string.
+	 * Append the literal text preceding this substitution.
 	 */
 
-	for (string = before; *string && *string != '%'; ++string)
-	    ;
-	if (string != before) {
-	    Tcl_DStringAppend(dsPtr, before, (Tcl_Size)(string - before));
-	    before = string;
+	if (specPtr->length > 0) {
+	    Tcl_DStringAppend(dsPtr, specPtr->literal, specPtr->length);
 	}
-	if (!*before) {
-	    break;
+	if (specPtr->spec < 0) {
+	    continue;
 	}
 
-	/*
-	 * There's a percent sequence here. Process it.
-	 */
-
 	string = "??";
-	switch (before[1]) {
+	switch (specPtr->spec) {
 	case '#':
 	    SET_UNUMBER(evPtr->xany.serial);
 	    break;
@@ -3286,7 +3412,7 @@ ExpandPercents(
 	    }
 	    break;
 	default:
-	    numStorage[0] = before[1];
+	    numStorage[0] = (char) specPtr->spec;
 	    numStorage[1] = '\0';
 	    string = numStorage;
 	    break;
@@ -3300,7 +3426,6 @@ ExpandPercents(
 	    spaceNeeded = Tcl_ConvertElement(
 		    string, Tcl_DStringValue(dsPtr) + length, cvtFlags | TCL_DONT_USE_BRACES);
 	    Tcl_DStringSetLength(dsPtr, length + spaceNeeded);
-	    before += 2;
 	}
     }
 
@@ -4828,6 +4953,7 @@ FindSequence(
     psPtr->added = 0;
     psPtr->modMaskUsed = (modMask != 0);
     psPtr->script = NULL;
+    psPtr->planPtr = NULL;
     psPtr->nextSeqPtr = (PatSeq *)Tcl_GetHashValue(hPtr);
     psPtr->hPtr = hPtr;
     psPtr->ptr.nextObj = NULL;
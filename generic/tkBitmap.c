@@ -328,6 +328,7 @@ GetBitmap(
 		bitmapPtr = bitmapPtr->nextPtr) {
 	    if ((Tk_Display(tkwin) == bitmapPtr->display) &&
 		    (Tk_ScreenNumber(tkwin) == bitmapPtr->screenNum)) {
+		dispPtr->bitmapCacheHits++;
 		bitmapPtr->resourceRefCount++;
 		return bitmapPtr;
 	    }
@@ -336,6 +337,8 @@ GetBitmap(
 	existingBitmapPtr = NULL;
     }
 
+    dispPtr->bitmapCacheMisses++;
+
     /*
      * No suitable bitmap exists. Create a new bitmap from the information
      * contained in the string. If the string starts with "@" then the rest of
@@ -1200,6 +1203,40 @@ TkGetBitmapPredefTable(void)
     return &tsdPtr->predefBitmapTable;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkBitmapCacheStatsObj --
+ *
+ *	Builds the bitmap cache part of the value returned by [tk memstats]:
+ *	a dictionary with the keys "hits" and "misses", counting the named
+ *	bitmap lookups that were satisfied from bitmapNameTable and those
+ *	that had to create the bitmap.
+ *
+ * Results:
+ *	A fresh unshared Tcl_Obj.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tcl_Obj *
+TkBitmapCacheStatsObj(
+    TkDisplay *dispPtr)		/* Display to report on. */
+{
+    Tcl_Obj *resultObj = Tcl_NewDictObj();
+
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("hits", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dispPtr->bitmapCacheHits));
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("misses", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dispPtr->bitmapCacheMisses));
+    return resultObj;
+}
+
 /*
  * Local Variables:
  * mode: c
@@ -0,0 +1,211 @@
+/*
+ * tkBlink.c --
+ *
+ *	This file implements the blink timer shared by every widget that
+ *	toggles something periodically, most notably the insertion cursor.
+ *	Widgets subscribe while they want to blink - typically while they
+ *	have the input focus - and unsubscribe when they stop.  All
+ *	subscribers in a thread toggle in phase off one timer, and the
+ *	timer only exists while there are subscribers, so an application
+ *	without a focused text-editing widget schedules no periodic
+ *	wakeups at all.
+ *
+ * Copyright © 2026 Tcl Core Team.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#include "tkInt.h"
+
+/*
+ * One of the following structures exists for each subscriber to the blink
+ * timer in a thread.
+ */
+
+typedef struct BlinkClient {
+    TkBlinkProc *proc;		/* Procedure toggling the subscriber. */
+    void *clientData;		/* Argument to pass to proc. */
+    struct BlinkClient *nextPtr;/* Next in list of subscribers, or NULL for
+				 * the end of the list. */
+} BlinkClient;
+
+typedef struct ThreadSpecificData {
+    BlinkClient *clientPtr;	/* First in list of subscribers, or NULL. */
+    Tcl_TimerToken timer;	/* The shared timer, or NULL when there are
+				 * no subscribers. */
+    int onTime;			/* Milliseconds the "on" phase lasts. */
+    int offTime;		/* Milliseconds the "off" phase lasts. */
+    int on;			/* Non-zero means the current phase is
+				 * "on". */
+} ThreadSpecificData;
+static Tcl_ThreadDataKey dataKey;
+
+/*
+ * Forward declarations for functions defined in this file:
+ */
+
+static void		BlinkTimerProc(void *clientData);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * BlinkTimerProc --
+ *
+ *	Timer handler for the shared blink timer. Flips the phase, tells
+ *	every subscriber about it and reschedules itself for the duration
+ *	of the new phase.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Whatever the subscribers do; usually a redraw of the insertion
+ *	cursor area.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+BlinkTimerProc(
+    TCL_UNUSED(void *))
+{
+    BlinkClient *bcPtr, *nextPtr;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    tsdPtr->timer = NULL;
+    if (tsdPtr->clientPtr == NULL) {
+	return;
+    }
+    tsdPtr->on = !tsdPtr->on;
+
+    /*
+     * A subscriber may remove itself from inside its callback (when it
+     * notices it should no longer blink), so fetch the successor before
+     * each call.
+     */
+
+    for (bcPtr = tsdPtr->clientPtr; bcPtr != NULL; bcPtr = nextPtr) {
+	nextPtr = bcPtr->nextPtr;
+	bcPtr->proc(bcPtr->clientData, tsdPtr->on);
+    }
+    if ((tsdPtr->clientPtr != NULL) && (tsdPtr->timer == NULL)) {
+	tsdPtr->timer = Tcl_CreateTimerHandler(
+		tsdPtr->on ? tsdPtr->onTime : tsdPtr->offTime,
+		BlinkTimerProc, NULL);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkBlinkAdd --
+ *
+ *	Subscribes a callback to the shared blink timer of the current
+ *	thread. The caller is expected to have put itself into the "on"
+ *	state already (widgets show the cursor as soon as they get the
+ *	focus); if the timer is already running for other subscribers, the
+ *	callback is invoked once immediately to align the new subscriber
+ *	with the shared phase. The on and off periods of the most recent
+ *	subscriber drive the timer; in practice every subscription comes
+ *	from the widget that just acquired the focus, so its option values
+ *	win.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The callback will be invoked at each phase change until it is
+ *	removed with TkBlinkRemove. Adding a callback that is already
+ *	subscribed just updates the periods.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkBlinkAdd(
+    TkBlinkProc *proc,		/* Procedure toggling the subscriber. */
+    void *clientData,		/* Argument to pass to proc. */
+    int onTime,			/* Milliseconds the "on" phase lasts. */
+    int offTime)		/* Milliseconds the "off" phase lasts. */
+{
+    BlinkClient *bcPtr;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    tsdPtr->onTime = onTime;
+    tsdPtr->offTime = offTime;
+    for (bcPtr = tsdPtr->clientPtr; bcPtr != NULL; bcPtr = bcPtr->nextPtr) {
+	if ((bcPtr->proc == proc) && (bcPtr->clientData == clientData)) {
+	    return;
+	}
+    }
+    bcPtr = (BlinkClient *)ckalloc(sizeof(BlinkClient));
+    bcPtr->proc = proc;
+    bcPtr->clientData = clientData;
+    bcPtr->nextPtr = tsdPtr->clientPtr;
+    tsdPtr->clientPtr = bcPtr;
+    if (tsdPtr->timer == NULL) {
+	tsdPtr->on = 1;
+	tsdPtr->timer = Tcl_CreateTimerHandler(onTime, BlinkTimerProc, NULL);
+    } else {
+	proc(clientData, tsdPtr->on);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkBlinkRemove --
+ *
+ *	Removes a subscriber from the shared blink timer. The timer is
+ *	deleted when the last subscriber goes away, so an idle application
+ *	does not wake up at all.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The callback will not be invoked any more. Removing a callback
+ *	that is not subscribed is a no-op.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkBlinkRemove(
+    TkBlinkProc *proc,		/* Procedure that was passed to
+				 * TkBlinkAdd. */
+    void *clientData)		/* Argument that was passed to TkBlinkAdd. */
+{
+    BlinkClient *bcPtr, *prevPtr;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    prevPtr = NULL;
+    for (bcPtr = tsdPtr->clientPtr; bcPtr != NULL;
+	    prevPtr = bcPtr, bcPtr = bcPtr->nextPtr) {
+	if ((bcPtr->proc == proc) && (bcPtr->clientData == clientData)) {
+	    if (prevPtr == NULL) {
+		tsdPtr->clientPtr = bcPtr->nextPtr;
+	    } else {
+		prevPtr->nextPtr = bcPtr->nextPtr;
+	    }
+	    ckfree(bcPtr);
+	    break;
+	}
+    }
+    if ((tsdPtr->clientPtr == NULL) && (tsdPtr->timer != NULL)) {
+	Tcl_DeleteTimerHandler(tsdPtr->timer);
+	tsdPtr->timer = NULL;
+    }
+}
+
+/*
+ * Local Variables:
+ * mode: c
+ * c-basic-offset: 4
+ * fill-column: 78
+ * End:
+ */
@@ -71,6 +71,23 @@ typedef struct ArcItem {
 				 * height. */
     double endPoint[2];         /* End point of arc used when specifying
 				 * height. */
+    double startSin, startCos;	/* Cached sine and cosine of the (negated)
+				 * start angle; see ComputeArcOutline. */
+    double endSin, endCos;	/* Likewise for start+extent. */
+    double corner1Cos, corner1Sin;
+				/* Cached unit vector from center1 towards
+				 * the outermost corner of the outline. */
+    double corner2Cos, corner2Sin;
+				/* Likewise from center2. */
+    double cachedStart;		/* Start, extent and oval dimensions the
+				 * cached values above were computed from;
+				 * the trig is only redone when one of them
+				 * actually changes. */
+    double cachedExtent;
+    double cachedBoxWidth;
+    double cachedBoxHeight;
+    int trigValid;		/* Non-zero means the cached values above
+				 * are usable. */
 } ArcItem;
 
 /*
@@ -295,6 +312,7 @@ CreateArc(
     arcPtr->extent = 90;
     arcPtr->outlinePtr = NULL;
     arcPtr->numOutlinePoints = 0;
+    arcPtr->trigValid = 0;
     arcPtr->tsoffset.flags = 0;
     arcPtr->tsoffset.xoffset = 0;
     arcPtr->tsoffset.yoffset = 0;
@@ -380,14 +398,8 @@ ArcCoords(
 		return TCL_ERROR;
 	    }
 	}
-	if ((Tk_CanvasGetCoordFromObj(interp, canvas, objv[0],
- 		    &arcPtr->bbox[0]) != TCL_OK)
-		|| (Tk_CanvasGetCoordFromObj(interp, canvas, objv[1],
-		    &arcPtr->bbox[1]) != TCL_OK)
-		|| (Tk_CanvasGetCoordFromObj(interp, canvas, objv[2],
-			&arcPtr->bbox[2]) != TCL_OK)
-		|| (Tk_CanvasGetCoordFromObj(interp, canvas, objv[3],
-			&arcPtr->bbox[3]) != TCL_OK)) {
+	if (TkCanvasGetCoords(interp, canvas, 4, objv,
+		arcPtr->bbox) != TCL_OK) {
 	    return TCL_ERROR;
 	}
 
@@ -1623,6 +1635,7 @@ ComputeArcOutline(
     double boxWidth, boxHeight;
     double vertex[2], corner1[2], corner2[2];
     double *outlinePtr;
+    int recomputed = 0;
     Tk_State state = arcPtr->header.state;
 
     /*
@@ -1663,12 +1676,31 @@ ComputeArcOutline(
 
     boxWidth = arcPtr->bbox[2] - arcPtr->bbox[0];
     boxHeight = arcPtr->bbox[3] - arcPtr->bbox[1];
-    angle = -arcPtr->start*PI/180.0;
-    sin1 = sin(angle);
-    cos1 = cos(angle);
-    angle -= arcPtr->extent*PI/180.0;
-    sin2 = sin(angle);
-    cos2 = cos(angle);
+
+    /*
+     * The endpoint and corner trigonometry only depends on the angles and
+     * the shape of the oval, so it is cached in the item; translations and
+     * configure calls that leave them alone (the common case for gauges
+     * that move hundreds of arcs per frame) rebuild the outline without
+     * calling any trig functions.
+     */
+
+    if (!arcPtr->trigValid || (arcPtr->cachedStart != arcPtr->start)
+	    || (arcPtr->cachedExtent != arcPtr->extent)) {
+	angle = -arcPtr->start*PI/180.0;
+	arcPtr->startSin = sin(angle);
+	arcPtr->startCos = cos(angle);
+	angle -= arcPtr->extent*PI/180.0;
+	arcPtr->endSin = sin(angle);
+	arcPtr->endCos = cos(angle);
+	arcPtr->cachedStart = arcPtr->start;
+	arcPtr->cachedExtent = arcPtr->extent;
+	recomputed = 1;
+    }
+    sin1 = arcPtr->startSin;
+    cos1 = arcPtr->startCos;
+    sin2 = arcPtr->endSin;
+    cos2 = arcPtr->endCos;
     vertex[0] = (arcPtr->bbox[0] + arcPtr->bbox[2])/2.0;
     vertex[1] = (arcPtr->bbox[1] + arcPtr->bbox[3])/2.0;
     arcPtr->center1[0] = vertex[0] + cos1*boxWidth/2.0;
@@ -1706,20 +1738,31 @@ ComputeArcOutline(
     }
     halfWidth = width/2.0;
 
-    if (((boxWidth*sin1) == 0.0) && ((boxHeight*cos1) == 0.0)) {
-	angle = 0.0;
-    } else {
-	angle = atan2(boxWidth*sin1, boxHeight*cos1);
-    }
-    corner1[0] = arcPtr->center1[0] + cos(angle)*halfWidth;
-    corner1[1] = arcPtr->center1[1] + sin(angle)*halfWidth;
-    if (((boxWidth*sin2) == 0.0) && ((boxHeight*cos2) == 0.0)) {
-	angle = 0.0;
-    } else {
-	angle = atan2(boxWidth*sin2, boxHeight*cos2);
-    }
-    corner2[0] = arcPtr->center2[0] + cos(angle)*halfWidth;
-    corner2[1] = arcPtr->center2[1] + sin(angle)*halfWidth;
+    if (recomputed || !arcPtr->trigValid
+	    || (arcPtr->cachedBoxWidth != boxWidth)
+	    || (arcPtr->cachedBoxHeight != boxHeight)) {
+	if (((boxWidth*sin1) == 0.0) && ((boxHeight*cos1) == 0.0)) {
+	    angle = 0.0;
+	} else {
+	    angle = atan2(boxWidth*sin1, boxHeight*cos1);
+	}
+	arcPtr->corner1Cos = cos(angle);
+	arcPtr->corner1Sin = sin(angle);
+	if (((boxWidth*sin2) == 0.0) && ((boxHeight*cos2) == 0.0)) {
+	    angle = 0.0;
+	} else {
+	    angle = atan2(boxWidth*sin2, boxHeight*cos2);
+	}
+	arcPtr->corner2Cos = cos(angle);
+	arcPtr->corner2Sin = sin(angle);
+	arcPtr->cachedBoxWidth = boxWidth;
+	arcPtr->cachedBoxHeight = boxHeight;
+	arcPtr->trigValid = 1;
+    }
+    corner1[0] = arcPtr->center1[0] + arcPtr->corner1Cos*halfWidth;
+    corner1[1] = arcPtr->center1[1] + arcPtr->corner1Sin*halfWidth;
+    corner2[0] = arcPtr->center2[0] + arcPtr->corner2Cos*halfWidth;
+    corner2[1] = arcPtr->center2[1] + arcPtr->corner2Sin*halfWidth;
 
     /*
      * For a chord outline, generate a six-sided polygon with three points for
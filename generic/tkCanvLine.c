@@ -66,6 +66,23 @@ typedef struct LineItem {
     const Tk_SmoothMethod *smooth; /* Non-zero means draw line smoothed (i.e.
 				 * with Bezier splines). */
     int splineSteps;		/* Number of steps in each spline segment. */
+    const Tk_SmoothMethod *smoothMethod;
+				/* Smoothing method the cache below was
+				 * computed with. */
+    double *smoothCoordPtr;	/* Cached flattened smoothed coordinates
+				 * (malloc'ed), or NULL if no valid cache is
+				 * held. */
+    int numSmoothPoints;	/* Number of points at *smoothCoordPtr. */
+    int smoothAllocated;	/* Number of points of space allocated
+				 * there. */
+    int smoothNumControl;	/* Number of control points the cache covers;
+				 * less than numPoints right after an
+				 * append. */
+    int smoothLastSpan;		/* Points produced by the final spline span,
+				 * or 0 if the cache cannot be extended
+				 * incrementally. */
+    int smoothSteps;		/* splineSteps value the cache was computed
+				 * with. */
 } LineItem;
 
 /*
@@ -104,6 +121,9 @@ static void		LineDeleteCoords(Tk_Canvas canvas,
 			    Tk_Item *itemPtr, Tcl_Size first, Tcl_Size last);
 static void		LineInsert(Tk_Canvas canvas,
 			    Tk_Item *itemPtr, Tcl_Size beforeThis, Tcl_Obj *obj);
+static double *	LineSmoothedPoints(Tk_Canvas canvas,
+			    LineItem *linePtr, int *numPointsPtr);
+static void		LineSmoothInvalidate(LineItem *linePtr);
 static int		LineToArea(Tk_Canvas canvas,
 			    Tk_Item *itemPtr, double *rectPtr);
 static double		LineToPoint(Tk_Canvas canvas,
@@ -313,6 +333,13 @@ CreateLine(
     linePtr->lastArrowPtr = NULL;
     linePtr->smooth = NULL;
     linePtr->splineSteps = 12;
+    linePtr->smoothMethod = NULL;
+    linePtr->smoothCoordPtr = NULL;
+    linePtr->numSmoothPoints = 0;
+    linePtr->smoothAllocated = 0;
+    linePtr->smoothNumControl = 0;
+    linePtr->smoothLastSpan = 0;
+    linePtr->smoothSteps = 0;
 
     /*
      * Count the number of points and then parse them into a point array.
@@ -413,20 +440,18 @@ LineCoords(
 
     numPoints = objc/2;
     if (linePtr->numPoints != numPoints) {
-	coordPtr = (double *)ckalloc(sizeof(double) * objc);
+	coordPtr = (double *)TkCanvasPoolAlloc(canvas, sizeof(double) * objc);
 	if (linePtr->coordPtr != NULL) {
-	    ckfree(linePtr->coordPtr);
+	    TkCanvasPoolFree(canvas, linePtr->coordPtr);
 	}
 	linePtr->coordPtr = coordPtr;
 	linePtr->numPoints = numPoints;
     }
-    coordPtr = linePtr->coordPtr;
-    for (i = 0; i < objc ; i++) {
-	if (Tk_CanvasGetCoordFromObj(interp, canvas, objv[i],
-		coordPtr++) != TCL_OK) {
-	    return TCL_ERROR;
-	}
+    if (TkCanvasGetCoords(interp, canvas, objc, objv,
+	    linePtr->coordPtr) != TCL_OK) {
+	return TCL_ERROR;
     }
+    LineSmoothInvalidate(linePtr);
 
     /*
      * Update arrowheads by throwing away any existing arrow-head information
@@ -549,6 +574,7 @@ ConfigureLine(
     } else if (linePtr->splineSteps > 100) {
 	linePtr->splineSteps = 100;
     }
+    LineSmoothInvalidate(linePtr);
 
     if ((!linePtr->numPoints) || (state == TK_STATE_HIDDEN)) {
 	ComputeLineBbox(canvas, linePtr);
@@ -609,7 +635,7 @@ ConfigureLine(
 
 static void
 DeleteLine(
-    TCL_UNUSED(Tk_Canvas),		/* Info about overall canvas widget. */
+    Tk_Canvas canvas,		/* Info about overall canvas widget. */
     Tk_Item *itemPtr,		/* Item that is being deleted. */
     Display *display)		/* Display containing window for canvas. */
 {
@@ -617,7 +643,10 @@ DeleteLine(
 
     Tk_DeleteOutline(display, &linePtr->outline);
     if (linePtr->coordPtr != NULL) {
-	ckfree(linePtr->coordPtr);
+	TkCanvasPoolFree(canvas, linePtr->coordPtr);
+    }
+    if (linePtr->smoothCoordPtr != NULL) {
+	ckfree(linePtr->smoothCoordPtr);
     }
     if (linePtr->arrowGC != NULL) {
 	Tk_FreeGC(display, linePtr->arrowGC);
@@ -815,6 +844,190 @@ ComputeLineBbox(
     linePtr->header.y2 += 1;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * LineSmoothedPoints --
+ *
+ *	Return the flattened smoothed form of a line, computing or updating
+ *	the cache held in the item as needed. When points have only been
+ *	appended since the cache was built and the line is an open Bezier
+ *	curve, just the spline spans that depend on the old last point are
+ *	regenerated and the rest of the cache is reused, so a device that
+ *	appends to a long trace pays for the new spans rather than the whole
+ *	curve.
+ *
+ * Results:
+ *	Returns a pointer to the cached coordinates (owned by the item; the
+ *	caller must not free it) and stores the number of points at
+ *	*numPointsPtr. Only valid for smoothed lines with more than two
+ *	points.
+ *
+ * Side effects:
+ *	The cache in the item is (re)computed or extended.
+ *
+ *--------------------------------------------------------------
+ */
+
+static double *
+LineSmoothedPoints(
+    Tk_Canvas canvas,		/* Canvas containing the line. */
+    LineItem *linePtr,		/* Line whose smoothed form is wanted. */
+    int *numPointsPtr)		/* Store the number of points here. */
+{
+    double control[8], *outPtr, *p;
+    int numPoints, maxPoints, closed, span, i;
+    int numSteps = linePtr->splineSteps;
+
+    maxPoints = linePtr->smooth->coordProc(canvas, NULL, linePtr->numPoints,
+	    numSteps, NULL, NULL);
+    closed = (linePtr->coordPtr[0]
+	    == linePtr->coordPtr[2*linePtr->numPoints-2])
+	    && (linePtr->coordPtr[1]
+	    == linePtr->coordPtr[2*linePtr->numPoints-1]);
+
+    if ((linePtr->smoothCoordPtr != NULL)
+	    && (linePtr->smoothMethod == linePtr->smooth)
+	    && (linePtr->smoothSteps == numSteps)) {
+	if (linePtr->smoothNumControl == linePtr->numPoints) {
+	    *numPointsPtr = linePtr->numSmoothPoints;
+	    return linePtr->smoothCoordPtr;
+	}
+
+	/*
+	 * Points were appended since the cache was built. In an open Bezier
+	 * curve each spline span only depends on a three-point window of
+	 * control points, so only the old final span (whose end conditions
+	 * changed) has to be dropped and regenerated along with the spans
+	 * for the new points. The control point setup below mirrors
+	 * TkMakeBezierCurve, including its single-point output for spans
+	 * with coincident control points.
+	 */
+
+	if ((linePtr->smooth == &tkBezierSmoothMethod) && !closed
+		&& (linePtr->smoothLastSpan > 0)
+		&& (linePtr->smoothNumControl >= 3)
+		&& (linePtr->smoothNumControl < linePtr->numPoints)) {
+	    if (linePtr->smoothAllocated < maxPoints) {
+		linePtr->smoothCoordPtr = (double *)ckrealloc(
+			linePtr->smoothCoordPtr,
+			2 * maxPoints * sizeof(double));
+		linePtr->smoothAllocated = maxPoints;
+	    }
+	    numPoints = linePtr->numSmoothPoints - linePtr->smoothLastSpan;
+	    outPtr = linePtr->smoothCoordPtr + 2*numPoints;
+	    span = 0;
+	    for (i = linePtr->smoothNumControl - 1; i < linePtr->numPoints;
+		    i++) {
+		p = linePtr->coordPtr + 2*(i - 2);
+		if (i == 2) {
+		    control[0] = p[0];
+		    control[1] = p[1];
+		    control[2] = 0.333*p[0] + 0.667*p[2];
+		    control[3] = 0.333*p[1] + 0.667*p[3];
+		} else {
+		    control[0] = 0.5*p[0] + 0.5*p[2];
+		    control[1] = 0.5*p[1] + 0.5*p[3];
+		    control[2] = 0.167*p[0] + 0.833*p[2];
+		    control[3] = 0.167*p[1] + 0.833*p[3];
+		}
+		if (i == linePtr->numPoints - 1) {
+		    control[4] = .667*p[2] + .333*p[4];
+		    control[5] = .667*p[3] + .333*p[5];
+		    control[6] = p[4];
+		    control[7] = p[5];
+		} else {
+		    control[4] = .833*p[2] + .167*p[4];
+		    control[5] = .833*p[3] + .167*p[5];
+		    control[6] = 0.5*p[2] + 0.5*p[4];
+		    control[7] = 0.5*p[3] + 0.5*p[5];
+		}
+		if (((p[0] == p[2]) && (p[1] == p[3]))
+			|| ((p[2] == p[4]) && (p[3] == p[5]))) {
+		    outPtr[0] = control[6];
+		    outPtr[1] = control[7];
+		    span = 1;
+		} else {
+		    TkBezierPoints(control, numSteps, outPtr);
+		    span = numSteps;
+		}
+		outPtr += 2*span;
+		numPoints += span;
+	    }
+	    linePtr->smoothLastSpan = span;
+	    linePtr->smoothNumControl = linePtr->numPoints;
+	    linePtr->numSmoothPoints = numPoints;
+	    *numPointsPtr = numPoints;
+	    return linePtr->smoothCoordPtr;
+	}
+    }
+
+    /*
+     * Build (or rebuild) the cache from scratch.
+     */
+
+    if ((linePtr->smoothCoordPtr == NULL)
+	    || (linePtr->smoothAllocated < maxPoints)) {
+	if (linePtr->smoothCoordPtr != NULL) {
+	    ckfree(linePtr->smoothCoordPtr);
+	}
+	linePtr->smoothCoordPtr = (double *)ckalloc(
+		2 * maxPoints * sizeof(double));
+	linePtr->smoothAllocated = maxPoints;
+    }
+    numPoints = linePtr->smooth->coordProc(canvas, linePtr->coordPtr,
+	    linePtr->numPoints, numSteps, NULL, linePtr->smoothCoordPtr);
+    linePtr->smoothMethod = linePtr->smooth;
+    linePtr->smoothSteps = numSteps;
+    linePtr->smoothNumControl = linePtr->numPoints;
+    linePtr->numSmoothPoints = numPoints;
+    if ((linePtr->smooth == &tkBezierSmoothMethod) && !closed) {
+	p = linePtr->coordPtr + 2*(linePtr->numPoints - 3);
+	if (((p[0] == p[2]) && (p[1] == p[3]))
+		|| ((p[2] == p[4]) && (p[3] == p[5]))) {
+	    linePtr->smoothLastSpan = 1;
+	} else {
+	    linePtr->smoothLastSpan = numSteps;
+	}
+    } else {
+	linePtr->smoothLastSpan = 0;
+    }
+    *numPointsPtr = numPoints;
+    return linePtr->smoothCoordPtr;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * LineSmoothInvalidate --
+ *
+ *	Throw away the cached smoothed form of a line because its control
+ *	points changed in a way the cache cannot absorb. The cache is
+ *	rebuilt lazily on the next LineSmoothedPoints call.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory is freed.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+LineSmoothInvalidate(
+    LineItem *linePtr)		/* Line whose cache is now stale. */
+{
+    if (linePtr->smoothCoordPtr != NULL) {
+	ckfree(linePtr->smoothCoordPtr);
+	linePtr->smoothCoordPtr = NULL;
+    }
+    linePtr->numSmoothPoints = 0;
+    linePtr->smoothAllocated = 0;
+    linePtr->smoothNumControl = 0;
+    linePtr->smoothLastSpan = 0;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -847,6 +1060,7 @@ DisplayLine(
     XPoint staticPoints[MAX_STATIC_POINTS*3];
     XPoint *pointPtr;
     double linewidth;
+    double *linePoints;
     int numPoints;
     Tk_State state = itemPtr->state;
 
@@ -870,15 +1084,15 @@ DisplayLine(
     /*
      * Build up an array of points in screen coordinates. Use a static array
      * unless the line has an enormous number of points; in this case,
-     * dynamically allocate an array. For smoothed lines, generate the curve
-     * points on each redisplay.
+     * dynamically allocate an array. Smoothed lines draw from the cached
+     * flattened curve instead of regenerating it on each redisplay.
      */
 
     if ((linePtr->smooth) && (linePtr->numPoints > 2)) {
-	numPoints = linePtr->smooth->coordProc(canvas, NULL,
-		linePtr->numPoints, linePtr->splineSteps, NULL, NULL);
+	linePoints = LineSmoothedPoints(canvas, linePtr, &numPoints);
     } else {
 	numPoints = linePtr->numPoints;
+	linePoints = linePtr->coordPtr;
     }
 
     if (numPoints <= MAX_STATIC_POINTS) {
@@ -887,13 +1101,8 @@ DisplayLine(
 	pointPtr = (XPoint *)ckalloc(numPoints * 3 * sizeof(XPoint));
     }
 
-    if ((linePtr->smooth) && (linePtr->numPoints > 2)) {
-	numPoints = linePtr->smooth->coordProc(canvas, linePtr->coordPtr,
-		linePtr->numPoints, linePtr->splineSteps, pointPtr, NULL);
-    } else {
-	numPoints = TkCanvTranslatePath((TkCanvas *) canvas, numPoints,
-		linePtr->coordPtr, 0, pointPtr);
-    }
+    numPoints = TkCanvTranslatePath((TkCanvas *) canvas, numPoints,
+	    linePoints, 0, pointPtr);
 
     /*
      * Display line, the free up line storage if it was dynamically allocated.
@@ -988,6 +1197,17 @@ LineInsert(
 	beforeThis = length;
     }
 
+    /*
+     * Appending at the end of a plain line leaves the smoothing cache
+     * extendable; any other insertion (or arrowhead end adjustment)
+     * invalidates it.
+     */
+
+    if ((beforeThis != length) || (linePtr->firstArrowPtr != NULL)
+	    || (linePtr->lastArrowPtr != NULL)) {
+	LineSmoothInvalidate(linePtr);
+    }
+
     /*
      * With arrows, the end points of the line are adjusted so that a thick
      * line doesn't stick out past the arrowheads (see ConfigureArrows).
@@ -1001,7 +1221,8 @@ LineInsert(
 	linePtr->coordPtr[length-2] = linePtr->lastArrowPtr[0];
 	linePtr->coordPtr[length-1] = linePtr->lastArrowPtr[1];
     }
-    newCoordPtr = (double *)ckalloc(sizeof(double) * (length + objc));
+    newCoordPtr = (double *)TkCanvasPoolAlloc(canvas,
+	    sizeof(double) * (length + objc));
     for (i=0; i<beforeThis; i++) {
 	newCoordPtr[i] = linePtr->coordPtr[i];
     }
@@ -1009,7 +1230,7 @@ LineInsert(
 	if (Tcl_GetDoubleFromObj(NULL, objv[i],
 		&newCoordPtr[i + beforeThis]) != TCL_OK) {
 	    Tcl_ResetResult(Canvas(canvas)->interp);
-	    ckfree(newCoordPtr);
+	    TkCanvasPoolFree(canvas, newCoordPtr);
 	    return;
 	}
     }
@@ -1018,7 +1239,7 @@ LineInsert(
 	newCoordPtr[i+objc] = linePtr->coordPtr[i];
     }
     if (linePtr->coordPtr) {
-        ckfree(linePtr->coordPtr);
+	TkCanvasPoolFree(canvas, linePtr->coordPtr);
     }
     linePtr->coordPtr = newCoordPtr;
     length += objc ;
@@ -1243,6 +1464,8 @@ LineDeleteCoords(
 	return;
     }
 
+    LineSmoothInvalidate(linePtr);
+
     /*
      * With arrows, the end points of the line are adjusted so that a thick
      * line doesn't stick out past the arrowheads (see ConfigureArrows).
@@ -1491,15 +1714,7 @@ LineToPoint(
     }
 
     if ((linePtr->smooth) && (linePtr->numPoints > 2)) {
-	numPoints = linePtr->smooth->coordProc(canvas, NULL,
-		linePtr->numPoints, linePtr->splineSteps, NULL, NULL);
-	if (numPoints <= MAX_STATIC_POINTS) {
-	    linePoints = staticSpace;
-	} else {
-	    linePoints = (double *)ckalloc(2 * numPoints * sizeof(double));
-	}
-	numPoints = linePtr->smooth->coordProc(canvas, linePtr->coordPtr,
-		linePtr->numPoints, linePtr->splineSteps, NULL, linePoints);
+	linePoints = LineSmoothedPoints(canvas, linePtr, &numPoints);
     } else {
 	numPoints = linePtr->numPoints;
 	linePoints = linePtr->coordPtr;
@@ -1654,7 +1869,8 @@ LineToPoint(
     }
 
   done:
-    if ((linePoints != staticSpace) && (linePoints != linePtr->coordPtr)) {
+    if ((linePoints != staticSpace) && (linePoints != linePtr->coordPtr)
+	    && (linePoints != linePtr->smoothCoordPtr)) {
 	ckfree(linePoints);
     }
     return bestDist;
@@ -1725,15 +1941,7 @@ LineToArea(
      */
 
     if ((linePtr->smooth) && (linePtr->numPoints > 2)) {
-	numPoints = linePtr->smooth->coordProc(canvas, NULL,
-		linePtr->numPoints, linePtr->splineSteps, NULL, NULL);
-	if (numPoints <= MAX_STATIC_POINTS) {
-	    linePoints = staticSpace;
-	} else {
-	    linePoints = (double *)ckalloc(2 * numPoints * sizeof(double));
-	}
-	numPoints = linePtr->smooth->coordProc(canvas, linePtr->coordPtr,
-		linePtr->numPoints, linePtr->splineSteps, NULL, linePoints);
+	linePoints = LineSmoothedPoints(canvas, linePtr, &numPoints);
     } else {
 	numPoints = linePtr->numPoints;
 	linePoints = linePtr->coordPtr;
@@ -1775,7 +1983,8 @@ LineToArea(
     }
 
   done:
-    if ((linePoints != staticSpace) && (linePoints != linePtr->coordPtr)) {
+    if ((linePoints != staticSpace) && (linePoints != linePtr->coordPtr)
+	    && (linePoints != linePtr->smoothCoordPtr)) {
 	ckfree(linePoints);
     }
     return result;
@@ -1836,6 +2045,7 @@ ScaleLine(
 	coordPtr[0] = originX + scaleX*(*coordPtr - originX);
 	coordPtr[1] = originY + scaleY*(coordPtr[1] - originY);
     }
+    LineSmoothInvalidate(linePtr);
     if (linePtr->arrow != ARROWS_NONE) {
 	ConfigureArrows(canvas, linePtr);
     }
@@ -1979,6 +2189,13 @@ TranslateLine(
 	    coordPtr[1] += deltaY;
 	}
     }
+    if (linePtr->smoothCoordPtr != NULL) {
+	for (i = 0, coordPtr = linePtr->smoothCoordPtr;
+		i < linePtr->numSmoothPoints; i++, coordPtr += 2) {
+	    coordPtr[0] += deltaX;
+	    coordPtr[1] += deltaY;
+	}
+    }
     ComputeLineBbox(canvas, linePtr);
 }
 
@@ -2029,6 +2246,7 @@ RotateLine(
 	    TkRotatePoint(originX, originY, s, c, &coordPtr[0], &coordPtr[1]);
 	}
     }
+    LineSmoothInvalidate(linePtr);
     ComputeLineBbox(canvas, linePtr);
 }
 
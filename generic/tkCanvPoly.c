@@ -49,6 +49,20 @@ typedef struct PolygonItem  {
     int splineSteps;		/* Number of steps in each spline segment. */
     int autoClosed;		/* Zero means the given polygon was closed,
 				   one means that we auto closed it. */
+    int *edgeBuckets;		/* Offsets into edgeList: bucket b holds the
+				 * edge indices edgeList[edgeBuckets[b]]
+				 * through edgeList[edgeBuckets[b+1]-1].
+				 * NULL means no edge table has been built
+				 * (or the coordinates have changed since the
+				 * last one). */
+    int *edgeList;		/* Edge indices grouped by x-bucket; an edge
+				 * spanning several buckets appears once in
+				 * each of them. */
+    int numEdgeBuckets;		/* Number of buckets at *edgeBuckets. */
+    double edgeXOrigin;		/* X coordinate of the left side of bucket 0;
+				 * shifted in place on translation so moves
+				 * do not invalidate the table. */
+    double edgeBucketSize;	/* Width of each bucket in canvas units. */
 } PolygonItem;
 
 /*
@@ -164,13 +178,17 @@ static void		DisplayPolygon(Tk_Canvas canvas,
 static int		GetPolygonIndex(Tcl_Interp *interp,
 			    Tk_Canvas canvas, Tk_Item *itemPtr,
 			    Tcl_Obj *obj, Tcl_Size *indexPtr);
+static void		PolygonBuildEdgeTable(PolygonItem *polyPtr);
 static int		PolygonCoords(Tcl_Interp *interp,
 			    Tk_Canvas canvas, Tk_Item *itemPtr,
 			    Tcl_Size objc, Tcl_Obj *const objv[]);
 static void		PolygonDeleteCoords(Tk_Canvas canvas,
 			    Tk_Item *itemPtr, Tcl_Size first, Tcl_Size last);
+static void		PolygonFreeEdgeTable(PolygonItem *polyPtr);
 static void		PolygonInsert(Tk_Canvas canvas,
 			    Tk_Item *itemPtr, Tcl_Size beforeThis, Tcl_Obj *obj);
+static int		PolygonPointInside(PolygonItem *polyPtr,
+			    double *pointPtr);
 static int		PolygonToArea(Tk_Canvas canvas,
 			    Tk_Item *itemPtr, double *rectPtr);
 static double		PolygonToPoint(Tk_Canvas canvas,
@@ -222,6 +240,16 @@ Tk_ItemType tkPolygonType = {
  */
 
 #define MAX_STATIC_POINTS 200
+
+/*
+ * Point hit-testing on polygons with at least this many points goes through
+ * a precomputed table that groups the edges into buckets by their x-range,
+ * so only the edges whose x-span contains the query point are visited.
+ * Smaller polygons are cheap enough to scan directly.
+ */
+
+#define POLY_INDEX_MIN_POINTS	64
+#define POLY_INDEX_MAX_BUCKETS	1024
 
 /*
  *--------------------------------------------------------------
@@ -281,6 +309,9 @@ CreatePolygon(
     polyPtr->smooth = NULL;
     polyPtr->splineSteps = 12;
     polyPtr->autoClosed = 0;
+    polyPtr->edgeBuckets = NULL;
+    polyPtr->edgeList = NULL;
+    polyPtr->numEdgeBuckets = 0;
 
     /*
      * Count the number of points and then parse them into a point array.
@@ -371,7 +402,7 @@ PolygonCoords(
     numPoints = objc/2;
     if (polyPtr->pointsAllocated <= numPoints) {
 	if (polyPtr->coordPtr != NULL) {
-	    ckfree(polyPtr->coordPtr);
+	    TkCanvasPoolFree(canvas, polyPtr->coordPtr);
 	}
 
 	/*
@@ -379,14 +410,13 @@ PolygonCoords(
 	 * another point to close the polygon.
 	 */
 
-	polyPtr->coordPtr = (double *)ckalloc(sizeof(double) * (objc+2));
+	polyPtr->coordPtr = (double *)TkCanvasPoolAlloc(canvas,
+		sizeof(double) * (objc+2));
 	polyPtr->pointsAllocated = numPoints+1;
     }
-    for (i = objc-1; i >= 0; i--) {
-	if (Tk_CanvasGetCoordFromObj(interp, canvas, objv[i],
-		&polyPtr->coordPtr[i]) != TCL_OK) {
-	    return TCL_ERROR;
-	}
+    if (TkCanvasGetCoords(interp, canvas, objc, objv,
+	    polyPtr->coordPtr) != TCL_OK) {
+	return TCL_ERROR;
     }
     polyPtr->numPoints = numPoints;
     polyPtr->autoClosed = 0;
@@ -403,6 +433,7 @@ PolygonCoords(
 	polyPtr->coordPtr[objc+1] = polyPtr->coordPtr[1];
     }
 
+    PolygonFreeEdgeTable(polyPtr);
     ComputePolygonBbox(canvas, polyPtr);
     return TCL_OK;
 }
@@ -567,15 +598,16 @@ ConfigurePolygon(
 
 static void
 DeletePolygon(
-    TCL_UNUSED(Tk_Canvas),		/* Info about overall canvas widget. */
+    Tk_Canvas canvas,		/* Info about overall canvas widget. */
     Tk_Item *itemPtr,		/* Item that is being deleted. */
     Display *display)		/* Display containing window for canvas. */
 {
     PolygonItem *polyPtr = (PolygonItem *) itemPtr;
 
     Tk_DeleteOutline(display, &polyPtr->outline);
+    PolygonFreeEdgeTable(polyPtr);
     if (polyPtr->coordPtr != NULL) {
-	ckfree(polyPtr->coordPtr);
+	TkCanvasPoolFree(canvas, polyPtr->coordPtr);
     }
     if (polyPtr->fillColor != NULL) {
 	Tk_FreeColor(polyPtr->fillColor);
@@ -854,6 +886,89 @@ TkFillPolygon(
     }
 }
 
+#ifdef TK_RENDER_POLYGONS
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PolygonRenderFill --
+ *
+ *	Try to fill a polygon's interior with antialiased edges on the
+ *	server. Used instead of XFillPolygon when the canvas has -antialias
+ *	set, the fill is a solid color and the port advertises
+ *	TK_RENDER_POLYGONS. Smoothed polygons are filled from the spline
+ *	points as doubles, so the curve keeps its subpixel positions.
+ *
+ * Results:
+ *	Returns 1 if the interior was drawn; 0 means the display cannot do
+ *	it and the caller must fall back to the core fill.
+ *
+ * Side effects:
+ *	Draws into drawable.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PolygonRenderFill(
+    Tk_Canvas canvas,		/* Canvas containing the item. */
+    PolygonItem *polyPtr,	/* Polygon to fill. */
+    Tk_State state,		/* Resolved state of the item. */
+    Display *display,		/* Display on which to draw. */
+    Drawable drawable)		/* Pixmap or window to draw into. */
+{
+    TkCanvas *canvasPtr = Canvas(canvas);
+    double staticCoords[2*MAX_STATIC_POINTS];
+    double *coordPtr;
+    XColor *color;
+    int i, numPoints, filled;
+
+    color = polyPtr->fillColor;
+    if (canvasPtr->currentItemPtr == (Tk_Item *) polyPtr) {
+	if (polyPtr->activeFillColor != NULL) {
+	    color = polyPtr->activeFillColor;
+	}
+    } else if (state == TK_STATE_DISABLED) {
+	if (polyPtr->disabledFillColor != NULL) {
+	    color = polyPtr->disabledFillColor;
+	}
+    }
+    if (color == NULL) {
+	return 0;
+    }
+
+    if (!polyPtr->smooth || (polyPtr->numPoints < 4)) {
+	numPoints = polyPtr->numPoints;
+	if (numPoints <= MAX_STATIC_POINTS) {
+	    coordPtr = staticCoords;
+	} else {
+	    coordPtr = (double *) ckalloc(2*numPoints * sizeof(double));
+	}
+	memcpy(coordPtr, polyPtr->coordPtr, 2*numPoints * sizeof(double));
+    } else {
+	numPoints = polyPtr->smooth->coordProc(canvas, NULL,
+		polyPtr->numPoints, polyPtr->splineSteps, NULL, NULL);
+	if (numPoints <= MAX_STATIC_POINTS) {
+	    coordPtr = staticCoords;
+	} else {
+	    coordPtr = (double *) ckalloc(2*numPoints * sizeof(double));
+	}
+	numPoints = polyPtr->smooth->coordProc(canvas, polyPtr->coordPtr,
+		polyPtr->numPoints, polyPtr->splineSteps, NULL, coordPtr);
+    }
+    for (i = 0; i < numPoints; i++) {
+	coordPtr[2*i] -= canvasPtr->drawableXOrigin;
+	coordPtr[2*i + 1] -= canvasPtr->drawableYOrigin;
+    }
+    filled = TkpDrawAntialiasedPolygon(display, Tk_Visual(canvasPtr->tkwin),
+	    drawable, color, coordPtr, numPoints);
+    if (coordPtr != staticCoords) {
+	ckfree(coordPtr);
+    }
+    return filled;
+}
+#endif /* TK_RENDER_POLYGONS */
+
 /*
  *--------------------------------------------------------------
  *
@@ -958,8 +1073,17 @@ DisplayPolygon(
 		(unsigned) intLineWidth+1, (unsigned) intLineWidth+1,
 		0, 64*360);
     } else if (!polyPtr->smooth || polyPtr->numPoints < 4) {
+	GC fillGC = polyPtr->fillGC;
+
+#ifdef TK_RENDER_POLYGONS
+	if (Canvas(canvas)->antialias && (fillGC != NULL) && (stipple == None)
+		&& PolygonRenderFill(canvas, polyPtr, state, display,
+			drawable)) {
+	    fillGC = NULL;
+	}
+#endif /* TK_RENDER_POLYGONS */
 	TkFillPolygon(canvas, polyPtr->coordPtr, polyPtr->numPoints,
-		    display, drawable, polyPtr->fillGC, polyPtr->outline.gc);
+		    display, drawable, fillGC, polyPtr->outline.gc);
     } else {
 	int numPoints;
 	XPoint staticPoints[MAX_STATIC_POINTS];
@@ -980,8 +1104,18 @@ DisplayPolygon(
 	numPoints = polyPtr->smooth->coordProc(canvas, polyPtr->coordPtr,
 		polyPtr->numPoints, polyPtr->splineSteps, pointPtr, NULL);
 	if (polyPtr->fillGC != NULL) {
-	    XFillPolygon(display, drawable, polyPtr->fillGC, pointPtr,
-		    numPoints, Complex, CoordModeOrigin);
+	    int filled = 0;
+
+#ifdef TK_RENDER_POLYGONS
+	    if (Canvas(canvas)->antialias && (stipple == None)) {
+		filled = PolygonRenderFill(canvas, polyPtr, state, display,
+			drawable);
+	    }
+#endif /* TK_RENDER_POLYGONS */
+	    if (!filled) {
+		XFillPolygon(display, drawable, polyPtr->fillGC, pointPtr,
+			numPoints, Complex, CoordModeOrigin);
+	    }
 	}
 	if (polyPtr->outline.gc != NULL) {
 	    XDrawLines(display, drawable, polyPtr->outline.gc, pointPtr,
@@ -1045,14 +1179,15 @@ PolygonInsert(
     while ((int)beforeThis < 0) {
 	beforeThis += length;
     }
-    newCoordPtr = (double *)ckalloc(sizeof(double) * (length + 2 + objc));
+    newCoordPtr = (double *)TkCanvasPoolAlloc(canvas,
+	    sizeof(double) * (length + 2 + objc));
     for (i=0; i<(int)beforeThis; i++) {
 	newCoordPtr[i] = polyPtr->coordPtr[i];
     }
     for (i=0; i<objc; i++) {
 	if (Tcl_GetDoubleFromObj(NULL, objv[i],
 		&newCoordPtr[i+beforeThis]) != TCL_OK){
-	    ckfree(newCoordPtr);
+	    TkCanvasPoolFree(canvas, newCoordPtr);
 	    return;
 	}
     }
@@ -1061,7 +1196,7 @@ PolygonInsert(
 	newCoordPtr[i+objc] = polyPtr->coordPtr[i];
     }
     if (polyPtr->coordPtr) {
-	ckfree(polyPtr->coordPtr);
+	TkCanvasPoolFree(canvas, polyPtr->coordPtr);
     }
     length += objc;
     polyPtr->coordPtr = newCoordPtr;
@@ -1186,6 +1321,7 @@ PolygonInsert(
 	}
     }
 
+    PolygonFreeEdgeTable(polyPtr);
     ComputePolygonBbox(canvas, polyPtr);
 }
 
@@ -1238,10 +1374,11 @@ PolygonDeleteCoords(
 	count += length;
     }
 
+    PolygonFreeEdgeTable(polyPtr);
     if (count >= length) {
 	polyPtr->numPoints = 0;
 	if (polyPtr->coordPtr != NULL) {
-	    ckfree(polyPtr->coordPtr);
+	    TkCanvasPoolFree(canvas, polyPtr->coordPtr);
 	    polyPtr->coordPtr = NULL;
 	}
 	ComputePolygonBbox(canvas, polyPtr);
@@ -1263,6 +1400,199 @@ PolygonDeleteCoords(
     ComputePolygonBbox(canvas, polyPtr);
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * PolygonBuildEdgeTable --
+ *
+ *	Build the x-bucketed edge table for a polygon. Each edge is entered
+ *	into every bucket its x-range overlaps, so a point query only has to
+ *	look at the edges in the single bucket containing the point's x
+ *	coordinate.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory is allocated for the edgeBuckets and edgeList arrays.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+PolygonBuildEdgeTable(
+    PolygonItem *polyPtr)	/* Polygon to build the table for. */
+{
+    double xMin, xMax, invSize, *coordPtr;
+    int numEdges = polyPtr->numPoints - 1;
+    int numBuckets, total, first, last, b, i;
+    int *countPtr;
+
+    xMin = xMax = polyPtr->coordPtr[0];
+    for (i = 1, coordPtr = polyPtr->coordPtr + 2; i < polyPtr->numPoints;
+	    i++, coordPtr += 2) {
+	if (*coordPtr < xMin) {
+	    xMin = *coordPtr;
+	} else if (*coordPtr > xMax) {
+	    xMax = *coordPtr;
+	}
+    }
+
+    numBuckets = numEdges;
+    if (numBuckets > POLY_INDEX_MAX_BUCKETS) {
+	numBuckets = POLY_INDEX_MAX_BUCKETS;
+    }
+    polyPtr->edgeBucketSize = (xMax - xMin) / numBuckets;
+    if (!(polyPtr->edgeBucketSize > 0.0)) {
+	polyPtr->edgeBucketSize = 1.0;
+	numBuckets = 1;
+    }
+    polyPtr->edgeXOrigin = xMin;
+    polyPtr->numEdgeBuckets = numBuckets;
+    invSize = 1.0 / polyPtr->edgeBucketSize;
+
+    /*
+     * Two passes over the edges: count how many land in each bucket, turn
+     * the counts into offsets, then fill in the edge lists.
+     */
+
+    countPtr = (int *)ckalloc(numBuckets * sizeof(int));
+    memset(countPtr, 0, numBuckets * sizeof(int));
+    total = 0;
+    for (i = 0, coordPtr = polyPtr->coordPtr; i < numEdges;
+	    i++, coordPtr += 2) {
+	first = (int) ((MIN(coordPtr[0], coordPtr[2]) - xMin) * invSize);
+	last = (int) ((MAX(coordPtr[0], coordPtr[2]) - xMin) * invSize);
+	if (first < 0) {
+	    first = 0;
+	}
+	if (last >= numBuckets) {
+	    last = numBuckets - 1;
+	}
+	for (b = first; b <= last; b++) {
+	    countPtr[b]++;
+	    total++;
+	}
+    }
+
+    polyPtr->edgeBuckets = (int *)ckalloc((numBuckets + 1) * sizeof(int));
+    polyPtr->edgeList = (int *)ckalloc(total * sizeof(int));
+    polyPtr->edgeBuckets[0] = 0;
+    for (b = 0; b < numBuckets; b++) {
+	polyPtr->edgeBuckets[b+1] = polyPtr->edgeBuckets[b] + countPtr[b];
+	countPtr[b] = polyPtr->edgeBuckets[b];
+    }
+    for (i = 0, coordPtr = polyPtr->coordPtr; i < numEdges;
+	    i++, coordPtr += 2) {
+	first = (int) ((MIN(coordPtr[0], coordPtr[2]) - xMin) * invSize);
+	last = (int) ((MAX(coordPtr[0], coordPtr[2]) - xMin) * invSize);
+	if (first < 0) {
+	    first = 0;
+	}
+	if (last >= numBuckets) {
+	    last = numBuckets - 1;
+	}
+	for (b = first; b <= last; b++) {
+	    polyPtr->edgeList[countPtr[b]++] = i;
+	}
+    }
+    ckfree(countPtr);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PolygonFreeEdgeTable --
+ *
+ *	Discard a polygon's edge table, typically because its coordinates
+ *	have changed. A new table is built on the next point query that
+ *	wants one.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory is freed.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+PolygonFreeEdgeTable(
+    PolygonItem *polyPtr)	/* Polygon whose table is now stale. */
+{
+    if (polyPtr->edgeBuckets != NULL) {
+	ckfree(polyPtr->edgeBuckets);
+	ckfree(polyPtr->edgeList);
+	polyPtr->edgeBuckets = NULL;
+	polyPtr->edgeList = NULL;
+	polyPtr->numEdgeBuckets = 0;
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PolygonPointInside --
+ *
+ *	Decide whether a point lies inside a polygon using its edge table.
+ *	Only the edges in the bucket containing the point's x coordinate are
+ *	examined; the crossing rules match TkPolygonToPoint exactly (the left
+ *	x coordinate of an edge counts as within its range, the right one
+ *	does not, so a point exactly below a vertex is not counted twice).
+ *
+ * Results:
+ *	1 if the point is inside the polygon, 0 if it is not. The caller
+ *	must have built the edge table already.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PolygonPointInside(
+    PolygonItem *polyPtr,	/* Polygon to check against; must have an
+				 * edge table. */
+    double *pointPtr)		/* Points to coords for point. */
+{
+    double *pPtr;
+    int bucket, i, intersections = 0;
+
+    bucket = (int) ((pointPtr[0] - polyPtr->edgeXOrigin)
+	    / polyPtr->edgeBucketSize);
+    if ((bucket < 0) || (bucket >= polyPtr->numEdgeBuckets)) {
+	return 0;
+    }
+    for (i = polyPtr->edgeBuckets[bucket];
+	    i < polyPtr->edgeBuckets[bucket+1]; i++) {
+	pPtr = polyPtr->coordPtr + 2*polyPtr->edgeList[i];
+
+	if (pPtr[2] == pPtr[0]) {
+	    /*
+	     * Vertical edges cannot cross the vertical ray from the point.
+	     */
+	} else if (pPtr[3] == pPtr[1]) {
+	    if ((pointPtr[1] < pPtr[1])
+		    && (pointPtr[0] >= MIN(pPtr[0], pPtr[2]))
+		    && (pointPtr[0] < MAX(pPtr[0], pPtr[2]))) {
+		intersections++;
+	    }
+	} else {
+	    double m1 = (pPtr[3] - pPtr[1])/(pPtr[2] - pPtr[0]);
+	    double b1 = pPtr[1] - m1*pPtr[0];
+
+	    if ((m1*pointPtr[0] + b1 > pointPtr[1])
+		    && (pointPtr[0] >= MIN(pPtr[0], pPtr[2]))
+		    && (pointPtr[0] < MAX(pPtr[0], pPtr[2]))) {
+		intersections++;
+	    }
+	}
+    }
+    return intersections & 0x1;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -1337,6 +1667,23 @@ PolygonToPoint(
     } else {
 	numPoints = polyPtr->numPoints;
 	polyPoints = polyPtr->coordPtr;
+
+	/*
+	 * Query large polygons through the x-bucketed edge table, which only
+	 * visits the edges whose x-range contains the point. When the point
+	 * lands inside the fill this answers the query without measuring the
+	 * distance to every edge.
+	 */
+
+	if (numPoints >= POLY_INDEX_MIN_POINTS) {
+	    if (polyPtr->edgeBuckets == NULL) {
+		PolygonBuildEdgeTable(polyPtr);
+	    }
+	    if (PolygonPointInside(polyPtr, pointPtr)) {
+		bestDist = 0.0;
+		goto donepoint;
+	    }
+	}
     }
 
     bestDist = TkPolygonToPoint(polyPoints, numPoints, pointPtr);
@@ -1683,6 +2030,7 @@ ScalePolygon(
 	*coordPtr = originX + scaleX*(*coordPtr - originX);
 	coordPtr[1] = originY + scaleY*(coordPtr[1] - originY);
     }
+    PolygonFreeEdgeTable(polyPtr);
     ComputePolygonBbox(canvas, polyPtr);
 }
 
@@ -1807,6 +2155,7 @@ RotatePolygon(
 	    i++, coordPtr += 2) {
 	TkRotatePoint(originX, originY, s, c, &coordPtr[0], &coordPtr[1]);
     }
+    PolygonFreeEdgeTable(polyPtr);
     ComputePolygonBbox(canvas, polyPtr);
 }
 
@@ -1843,6 +2192,13 @@ TranslatePolygon(
 	*coordPtr += deltaX;
 	coordPtr[1] += deltaY;
     }
+
+    /*
+     * A translation moves every edge by the same amount, so the edge table
+     * stays correct once its origin is shifted along with the coordinates.
+     */
+
+    polyPtr->edgeXOrigin += deltaX;
     ComputePolygonBbox(canvas, polyPtr);
 }
 
@@ -138,6 +138,17 @@ static void		PostscriptBitmap(Tk_Window tkwin, Pixmap bitmap,
 			    int startX, int startY, int width, int height,
 			    Tcl_Obj *psObj);
 static inline Tcl_Obj *	GetPostscriptBuffer(Tcl_Interp *interp);
+static int		FlushPostscript(TkPostscriptInfo *psInfoPtr,
+			    Tcl_Obj **psObjPtr, int force);
+
+/*
+ * When output goes to a channel, generated Postscript is flushed to it
+ * whenever the accumulation buffer grows past this size (and once more at
+ * the end), so export memory stays bounded no matter how large the scene
+ * is while small fragments are still batched into few channel writes.
+ */
+
+#define PS_STREAM_BUFFER_SIZE	65536
 
 /*
  *--------------------------------------------------------------
@@ -485,17 +496,13 @@ TkCanvPostscriptObjCmd(
 
 	Tcl_AppendObjToObj(psObj, preambleObj);
 
-	if (psInfo.chan != NULL) {
-	    if (Tcl_WriteObj(psInfo.chan, psObj) == TCL_IO_FAILURE) {
-	    channelWriteFailed:
-		Tcl_SetObjResult(interp, Tcl_ObjPrintf(
-			"problem writing postscript data to channel: %s",
-			Tcl_PosixError(interp)));
-		result = TCL_ERROR;
-		goto cleanup;
-	    }
-	    Tcl_DecrRefCount(psObj);
-	    psObj = Tcl_NewObj();
+	if (FlushPostscript(&psInfo, &psObj, 0) != TCL_OK) {
+	channelWriteFailed:
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "problem writing postscript data to channel: %s",
+		    Tcl_PosixError(interp)));
+	    result = TCL_ERROR;
+	    goto cleanup;
 	}
 
 	/*
@@ -539,12 +546,8 @@ TkCanvPostscriptObjCmd(
 			(Tk_PostscriptInfo)psInfoPtr),
 		psInfo.x, Tk_PostscriptY((double)psInfo.y2,
 			(Tk_PostscriptInfo)psInfoPtr));
-	if (psInfo.chan != NULL) {
-	    if (Tcl_WriteObj(psInfo.chan, psObj) == TCL_IO_FAILURE) {
-		goto channelWriteFailed;
-	    }
-	    Tcl_DecrRefCount(psObj);
-	    psObj = Tcl_NewObj();
+	if (FlushPostscript(&psInfo, &psObj, 0) != TCL_OK) {
+	    goto channelWriteFailed;
 	}
     }
 
@@ -581,12 +584,8 @@ TkCanvPostscriptObjCmd(
 	Tcl_AppendToObj(psObj, "grestore\n", TCL_INDEX_NONE);
 	Tcl_ResetResult(interp);
 
-	if (psInfo.chan != NULL) {
-	    if (Tcl_WriteObj(psInfo.chan, psObj) == TCL_IO_FAILURE) {
-		goto channelWriteFailed;
-	    }
-	    Tcl_DecrRefCount(psObj);
-	    psObj = Tcl_NewObj();
+	if (FlushPostscript(&psInfo, &psObj, 0) != TCL_OK) {
+	    goto channelWriteFailed;
 	}
     }
 
@@ -601,12 +600,10 @@ TkCanvPostscriptObjCmd(
 		"%%Trailer\n"
 		"end\n"
 		"%%EOF\n", TCL_INDEX_NONE);
+    }
 
-	if (psInfo.chan != NULL) {
-	    if (Tcl_WriteObj(psInfo.chan, psObj) == TCL_IO_FAILURE) {
-		goto channelWriteFailed;
-	    }
-	}
+    if (FlushPostscript(&psInfo, &psObj, 1) != TCL_OK) {
+	goto channelWriteFailed;
     }
 
     if (psInfo.chan == NULL) {
@@ -669,6 +666,51 @@ GetPostscriptBuffer(
     return psObj;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * FlushPostscript --
+ *
+ *	Write accumulated Postscript to the output channel, if there is one,
+ *	once the buffer has grown past PS_STREAM_BUFFER_SIZE (always, when
+ *	force is non-zero). After a successful write the buffer object is
+ *	replaced with a fresh empty one.
+ *
+ * Results:
+ *	A standard Tcl result. TCL_ERROR means the channel write failed.
+ *
+ * Side effects:
+ *	Data may be written to the channel.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+FlushPostscript(
+    TkPostscriptInfo *psInfoPtr,/* Postscript state; identifies the output
+				 * channel, if any. */
+    Tcl_Obj **psObjPtr,		/* Accumulation buffer; replaced with a fresh
+				 * object after a flush. */
+    int force)			/* Non-zero means flush even a small
+				 * buffer. */
+{
+    Tcl_Size length;
+
+    if (psInfoPtr->chan == NULL) {
+	return TCL_OK;
+    }
+    (void) Tcl_GetStringFromObj(*psObjPtr, &length);
+    if (length == 0 || (!force && (length < PS_STREAM_BUFFER_SIZE))) {
+	return TCL_OK;
+    }
+    if (Tcl_WriteObj(psInfoPtr->chan, *psObjPtr) == TCL_IO_FAILURE) {
+	return TCL_ERROR;
+    }
+    Tcl_DecrRefCount(*psObjPtr);
+    *psObjPtr = Tcl_NewObj();
+    return TCL_OK;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -18,6 +18,38 @@
 #include "tkWinInt.h"
 #endif
 
+/*
+ * Computed text layouts are shared between text items. Schematic-style
+ * canvases often hold thousands of items carrying the same few strings in
+ * the same font, and each Tk_ComputeTextLayout call re-measures every
+ * character, so items displaying identical (string, font, wrap width,
+ * justify) tuples reference one refcounted layout record instead. The
+ * records live in a per-thread hash table; the parameters are kept on the
+ * record so that an item can also cheaply detect that its current layout is
+ * still correct (e.g. across moves and unrelated configure calls) and skip
+ * the recomputation entirely.
+ */
+
+typedef struct SharedTextLayout {
+    Tk_TextLayout layout;	/* The computed layout itself. */
+    int width, height;		/* Pixel size reported when it was made. */
+    Tk_Font tkfont;		/* Font the layout was computed with. */
+    int wrapWidth;		/* -width value it was computed with. */
+    Tk_Justify justify;		/* -justify value it was computed with. */
+    Tcl_Size numChars;		/* Length of string in characters. */
+    char *string;		/* Malloc'ed copy of the laid out string. */
+    int refCount;		/* Number of text items using this record;
+				 * freed when this drops to zero. */
+    Tcl_HashEntry *hashPtr;	/* Entry in the per-thread layout table. */
+} SharedTextLayout;
+
+typedef struct {
+    int initialized;		/* Non-zero means the table is ready. */
+    Tcl_HashTable layoutTable;	/* Maps (font, wrap width, justify, string)
+				 * to SharedTextLayout records. */
+} ThreadSpecificData;
+static Tcl_ThreadDataKey dataKey;
+
 /*
  * The structure below defines the record for each text item.
  */
@@ -68,7 +100,11 @@ typedef struct TextItem {
 
     Tcl_Size numChars;		/* Length of text in characters. */
     Tcl_Size numBytes;		/* Length of text in bytes. */
-    Tk_TextLayout textLayout;	/* Cached text layout information. */
+    Tk_TextLayout textLayout;	/* Cached text layout information; owned by
+				 * layoutRef, not the item. */
+    SharedTextLayout *layoutRef;
+				/* Shared record the layout above belongs to,
+				 * or NULL if no layout is held. */
     int actualWidth;		/* Width of text as computed. Used to make
 				 * selections of wrapped text display
 				 * right. */
@@ -218,6 +254,8 @@ static const Tk_ConfigSpec configSpecs[] = {
  */
 
 static void		ComputeTextBbox(Tk_Canvas canvas, TextItem *textPtr);
+static SharedTextLayout * TextLayoutGet(TextItem *textPtr);
+static void		TextLayoutRelease(TextItem *textPtr);
 static int		ConfigureText(Tcl_Interp *interp,
 			    Tk_Canvas canvas, Tk_Item *itemPtr, Tcl_Size argc,
 			    Tcl_Obj *const objv[], int flags);
@@ -353,6 +391,7 @@ CreateText(
     textPtr->numChars	= 0;
     textPtr->numBytes	= 0;
     textPtr->textLayout = NULL;
+    textPtr->layoutRef	= NULL;
     textPtr->actualWidth = 0;
     textPtr->drawOrigin[0] = textPtr->drawOrigin[1] = 0.0;
     textPtr->gc		= NULL;
@@ -677,7 +716,7 @@ DeleteText(
 	ckfree(textPtr->text);
     }
 
-    Tk_FreeTextLayout(textPtr->textLayout);
+    TextLayoutRelease(textPtr);
     if (textPtr->gc != NULL) {
 	Tk_FreeGC(display, textPtr->gc);
     }
@@ -723,10 +762,24 @@ ComputeTextBbox(
 	state = Canvas(canvas)->canvas_state;
     }
 
-    Tk_FreeTextLayout(textPtr->textLayout);
-    textPtr->textLayout = Tk_ComputeTextLayout(textPtr->tkfont,
-	    textPtr->text, textPtr->numChars, textPtr->width,
-	    textPtr->justify, 0, &width, &height);
+    /*
+     * Reuse the layout the item already holds when the string and layout
+     * parameters are unchanged; moves, scales and configure calls touching
+     * unrelated options then skip the measurement pass completely.
+     */
+
+    if ((textPtr->layoutRef == NULL)
+	    || (textPtr->layoutRef->tkfont != textPtr->tkfont)
+	    || (textPtr->layoutRef->wrapWidth != textPtr->width)
+	    || (textPtr->layoutRef->justify != textPtr->justify)
+	    || (textPtr->layoutRef->numChars != textPtr->numChars)
+	    || (strcmp(textPtr->layoutRef->string, textPtr->text) != 0)) {
+	TextLayoutRelease(textPtr);
+	textPtr->layoutRef = TextLayoutGet(textPtr);
+	textPtr->textLayout = textPtr->layoutRef->layout;
+    }
+    width = textPtr->layoutRef->width;
+    height = textPtr->layoutRef->height;
 
     if (state == TK_STATE_HIDDEN || textPtr->color == NULL) {
 	width = height = 0;
@@ -845,6 +898,109 @@ ComputeTextBbox(
     textPtr->header.y2 = ROUND(tmp);
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * TextLayoutGet --
+ *
+ *	Find or create the shared layout record for a text item's current
+ *	string, font, wrap width and justification.
+ *
+ * Results:
+ *	A record whose reference count has been incremented on the caller's
+ *	behalf. Never returns NULL.
+ *
+ * Side effects:
+ *	May compute a new text layout and enter it into the per-thread
+ *	layout table.
+ *
+ *--------------------------------------------------------------
+ */
+
+static SharedTextLayout *
+TextLayoutGet(
+    TextItem *textPtr)		/* Item needing a layout. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    SharedTextLayout *sharedPtr;
+    Tcl_HashEntry *hPtr;
+    Tcl_DString key;
+    char prefix[64];
+    int isNew;
+
+    if (!tsdPtr->initialized) {
+	Tcl_InitHashTable(&tsdPtr->layoutTable, TCL_STRING_KEYS);
+	tsdPtr->initialized = 1;
+    }
+
+    snprintf(prefix, sizeof(prefix), "%p %d %d ", (void *) textPtr->tkfont,
+	    textPtr->width, (int) textPtr->justify);
+    Tcl_DStringInit(&key);
+    Tcl_DStringAppend(&key, prefix, TCL_INDEX_NONE);
+    Tcl_DStringAppend(&key, textPtr->text, TCL_INDEX_NONE);
+    hPtr = Tcl_CreateHashEntry(&tsdPtr->layoutTable,
+	    Tcl_DStringValue(&key), &isNew);
+    Tcl_DStringFree(&key);
+
+    if (isNew) {
+	sharedPtr = (SharedTextLayout *)ckalloc(sizeof(SharedTextLayout));
+	sharedPtr->layout = Tk_ComputeTextLayout(textPtr->tkfont,
+		textPtr->text, textPtr->numChars, textPtr->width,
+		textPtr->justify, 0, &sharedPtr->width, &sharedPtr->height);
+	sharedPtr->tkfont = textPtr->tkfont;
+	sharedPtr->wrapWidth = textPtr->width;
+	sharedPtr->justify = textPtr->justify;
+	sharedPtr->numChars = textPtr->numChars;
+	sharedPtr->string = (char *)ckalloc(textPtr->numBytes + 1);
+	memcpy(sharedPtr->string, textPtr->text, textPtr->numBytes + 1);
+	sharedPtr->refCount = 0;
+	sharedPtr->hashPtr = hPtr;
+	Tcl_SetHashValue(hPtr, sharedPtr);
+    } else {
+	sharedPtr = (SharedTextLayout *)Tcl_GetHashValue(hPtr);
+    }
+    sharedPtr->refCount++;
+    return sharedPtr;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TextLayoutRelease --
+ *
+ *	Drop a text item's reference to its shared layout record, if it
+ *	holds one.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The record, its layout and its table entry are freed when the last
+ *	reference goes away.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+TextLayoutRelease(
+    TextItem *textPtr)		/* Item giving up its layout. */
+{
+    SharedTextLayout *sharedPtr = textPtr->layoutRef;
+
+    if (sharedPtr == NULL) {
+	return;
+    }
+    textPtr->layoutRef = NULL;
+    textPtr->textLayout = NULL;
+    if (--sharedPtr->refCount <= 0) {
+	Tk_FreeTextLayout(sharedPtr->layout);
+	ckfree(sharedPtr->string);
+	Tcl_DeleteHashEntry(sharedPtr->hashPtr);
+	ckfree(sharedPtr);
+    }
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -49,8 +49,41 @@ static const Tk_SmoothMethod tkRawSmoothMethod = {
 static void		SmoothMethodCleanupProc(void *clientData,
 			    Tcl_Interp *interp);
 static SmoothAssocData *InitSmoothMethods(Tcl_Interp *interp);
+#define DASH_STACK_ELEMENTS	16	/* Converted dash lists up to this
+					 * many elements live on the stack
+					 * during Tk_ChangeOutlineGC. */
+
+/*
+ * The reserved1 field of a Tk_Outline points to one of the following
+ * structures, holding the X11 dash lists resolved from the outline's dash
+ * patterns and widths at configure time, so that the draw-time code in
+ * Tk_ChangeOutlineGC only has to hand precomputed bytes to the GC dash
+ * cache. One list is kept per state the draw code can resolve to.
+ */
+
+#define OUTLINE_NORMAL		0
+#define OUTLINE_ACTIVE		1
+#define OUTLINE_DISABLED	2
+#define OUTLINE_STATES		3
+
+typedef struct OutlineDash {
+    int number;			/* Number of bytes in the resolved list. 0
+				 * means the pattern needs no dash list. */
+    char *listPtr;		/* The resolved list. Points to space below,
+				 * or to malloc'd storage for longer
+				 * lists. */
+    char space[2 * DASH_STACK_ELEMENTS];
+				/* Inline storage for the common case. */
+} OutlineDash;
+
+typedef struct OutlineDashes {
+    OutlineDash dash[OUTLINE_STATES];
+				/* Indexed by the OUTLINE_* state codes. */
+} OutlineDashes;
+
 static int		DashConvert(char *l, const char *p, int n,
 			    double width);
+static void		ResolveOutlineDashes(Tk_Outline *outline);
 static void		TranslateAndAppendCoords(TkCanvas *canvPtr,
 			    double x, double y, XPoint *outArr, int numOut);
 static inline Tcl_Obj *	GetPostscriptBuffer(Tcl_Interp *interp);
@@ -280,6 +313,57 @@ Tk_CanvasGetCoordFromObj(
     return Tk_GetDoublePixelsFromObj(Canvas(canvas)->interp, Canvas(canvas)->tkwin, obj, doublePtr);
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * TkCanvasGetCoords --
+ *
+ *	Convert a whole array of coordinate objects, as produced by a list
+ *	or by command arguments, into canvas coordinates in a single pass.
+ *
+ * Results:
+ *	The return value is a standard Tcl return result. If TCL_OK is
+ *	returned then all objc coordinates have been stored at coordPtr;
+ *	otherwise TCL_ERROR is returned and an error message is left in the
+ *	interp's result.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkCanvasGetCoords(
+    Tcl_Interp *interp,		/* Interpreter for error reporting. */
+    Tk_Canvas canvas,		/* Canvas to which coordinates apply. */
+    Tcl_Size objc,		/* Number of coordinates to convert. */
+    Tcl_Obj *const objv[],	/* Array of coordinate objects (any screen
+				 * coordinate form may be used here). */
+    double *coordPtr)		/* Place to store objc converted
+				 * coordinates. */
+{
+    Tcl_Size i;
+    double d;
+
+    for (i = 0; i < objc; i++) {
+	/*
+	 * Coordinate lists are overwhelmingly plain numbers whose objects
+	 * already carry a numeric internal rep, so try the direct
+	 * conversion first and only fall back to the full screen-distance
+	 * parser for values with a unit suffix.
+	 */
+
+	if (Tcl_GetDoubleFromObj(NULL, objv[i], &d) == TCL_OK) {
+	    coordPtr[i] = d;
+	} else if (Tk_CanvasGetCoordFromObj(interp, canvas, objv[i],
+		&coordPtr[i]) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+    }
+    return TCL_OK;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -974,6 +1058,9 @@ Tk_CreateOutline(
     outline->dash.number = 0;
     outline->activeDash.number = 0;
     outline->disabledDash.number = 0;
+    outline->reserved1 = NULL;
+    outline->reserved2 = NULL;
+    outline->reserved3 = NULL;
     outline->tsoffset.flags = 0;
     outline->tsoffset.xoffset = 0;
     outline->tsoffset.yoffset = 0;
@@ -1019,6 +1106,18 @@ Tk_DeleteOutline(
     if ((unsigned) ABS(outline->disabledDash.number) > sizeof(char *)) {
 	ckfree(outline->disabledDash.pattern.pt);
     }
+    if (outline->reserved1 != NULL) {
+	OutlineDashes *cachePtr = (OutlineDashes *)outline->reserved1;
+	int i;
+
+	for (i = 0; i < OUTLINE_STATES; i++) {
+	    if (cachePtr->dash[i].listPtr != cachePtr->dash[i].space) {
+		ckfree(cachePtr->dash[i].listPtr);
+	    }
+	}
+	ckfree(cachePtr);
+	outline->reserved1 = NULL;
+    }
     if (outline->color != NULL) {
 	Tk_FreeColor(outline->color);
     }
@@ -1082,6 +1181,14 @@ Tk_ConfigOutlineGC(
     if (outline->disabledWidth < 0) {
 	outline->disabledWidth = 0.0;
     }
+
+    /*
+     * Resolve the dash lists for every state now, while the widths and
+     * patterns are fresh, so each redraw can reuse the converted bytes.
+     */
+
+    ResolveOutlineDashes(outline);
+
     if (state==TK_STATE_HIDDEN) {
 	return 0;
     }
@@ -1225,22 +1332,60 @@ Tk_ChangeOutlineGC(
 	return 0;
     }
 
-    if ((dash->number<-1) ||
+    if (outline->reserved1 != NULL) {
+	/*
+	 * Tk_ConfigOutlineGC resolved the dash list for every state, so
+	 * just hand the precomputed bytes to the GC dash cache.
+	 */
+
+	OutlineDashes *cachePtr = (OutlineDashes *)outline->reserved1;
+	OutlineDash *odPtr;
+
+	if (Canvas(canvas)->currentItemPtr == item) {
+	    odPtr = &cachePtr->dash[OUTLINE_ACTIVE];
+	} else if (state == TK_STATE_DISABLED) {
+	    odPtr = &cachePtr->dash[OUTLINE_DISABLED];
+	} else {
+	    odPtr = &cachePtr->dash[OUTLINE_NORMAL];
+	}
+	if (odPtr->number > 0) {
+	    TkSetDashes(Canvas(canvas)->display, outline->gc,
+		    outline->offset, odPtr->listPtr, odPtr->number);
+	}
+    } else if ((dash->number<-1) ||
 	    ((dash->number == -1) && (dash->pattern.array[0] != ','))) {
+	char staticBuf[2 * DASH_STACK_ELEMENTS];
 	char *q;
 	int i = -dash->number;
 
 	p = (i > (int)sizeof(char *)) ? dash->pattern.pt : dash->pattern.array;
-	q = (char *)ckalloc(2 * i);
+	q = (2*i <= (int)sizeof(staticBuf)) ? staticBuf
+		: (char *)ckalloc(2 * i);
 	i = DashConvert(q, p, i, width);
-	XSetDashes(Canvas(canvas)->display, outline->gc, outline->offset, q,i);
-	ckfree(q);
+	TkSetDashes(Canvas(canvas)->display, outline->gc, outline->offset,
+		q, i);
+	if (q != staticBuf) {
+	    ckfree(q);
+	}
     } else if (dash->number>2 || (dash->number==2 &&
 	    (dash->pattern.array[0]!=dash->pattern.array[1]))) {
 	p = (dash->number > (int) sizeof(char *))
 		? dash->pattern.pt : dash->pattern.array;
-	XSetDashes(Canvas(canvas)->display, outline->gc, outline->offset, p,
+	TkSetDashes(Canvas(canvas)->display, outline->gc, outline->offset, p,
 		dash->number);
+    } else if (dash->number != 0) {
+	/*
+	 * Simple repeating patterns rely on the dash character the GC was
+	 * created with; declare that state through the cache so a shared GC
+	 * that another item left holding a longer list is put right, and so
+	 * nothing is sent when the GC is already correct (the common case).
+	 */
+
+	char single = ((unsigned int)ABS(dash->number) > sizeof(char *))
+		? dash->pattern.pt[0] : dash->pattern.array[0];
+
+	TkSetDashes(Canvas(canvas)->display, outline->gc, outline->offset,
+		&single, 1);
     }
     if (stipple!=None) {
 	int w = 0; int h = 0;
@@ -1295,30 +1440,16 @@ Tk_ResetOutlineGC(
     Tk_Item *item,
     Tk_Outline *outline)
 {
-    char dashList;
-    double width;
-    Tk_Dash *dash;
     XColor *color;
     Pixmap stipple;
     Tk_State state = item->state;
 
-    width = outline->width;
-    if (width < 1.0) {
-	width = 1.0;
-    }
-    dash = &(outline->dash);
     color = outline->color;
     stipple = outline->stipple;
     if (state == TK_STATE_NULL) {
 	state = Canvas(canvas)->canvas_state;
     }
     if (Canvas(canvas)->currentItemPtr == item) {
-	if (outline->activeWidth>width) {
-	    width = outline->activeWidth;
-	}
-	if (outline->activeDash.number != 0) {
-	    dash = &(outline->activeDash);
-	}
 	if (outline->activeColor!=NULL) {
 	    color = outline->activeColor;
 	}
@@ -1326,12 +1457,6 @@ Tk_ResetOutlineGC(
 	    stipple = outline->activeStipple;
 	}
     } else if (state == TK_STATE_DISABLED) {
-	if (outline->disabledWidth>width) {
-	    width = outline->disabledWidth;
-	}
-	if (outline->disabledDash.number != 0) {
-	    dash = &(outline->disabledDash);
-	}
 	if (outline->disabledColor!=NULL) {
 	    color = outline->disabledColor;
 	}
@@ -1343,19 +1468,13 @@ Tk_ResetOutlineGC(
 	return 0;
     }
 
-    if ((dash->number > 2) || (dash->number < -1) || (dash->number==2 &&
-	    (dash->pattern.array[0] != dash->pattern.array[1])) ||
-	    ((dash->number == -1) && (dash->pattern.array[0] != ','))) {
-	if ((unsigned int)ABS(dash->number) > sizeof(char *)) {
-	    dashList = dash->pattern.pt[0];
-	} else if (dash->number != 0) {
-	    dashList = dash->pattern.array[0];
-	} else {
-	    dashList = (char) (4 * width + 0.5);
-	}
-	XSetDashes(Canvas(canvas)->display, outline->gc, outline->offset,
-		&dashList , 1);
-    }
+    /*
+     * No dash restore here: dash state stays cached with the GC, and the
+     * next dashed draw declares what it needs through TkSetDashes (see
+     * Tk_ChangeOutlineGC), so unchanged outlines cost no GC traffic at
+     * all.
+     */
+
     if (stipple != None) {
 	XSetTSOrigin(Canvas(canvas)->display, outline->gc, 0, 0);
 	return 1;
@@ -1363,6 +1482,108 @@ Tk_ResetOutlineGC(
     return 0;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * ResolveOutlineDashes
+ *
+ *	Convert the outline's dash patterns into ready-to-use X11 dash lists
+ *	for the normal, active and disabled states, mirroring the state and
+ *	width resolution done in Tk_ChangeOutlineGC. The result is stored in
+ *	the structure hanging off the outline's reserved1 field, which is
+ *	allocated here on first use.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory may be allocated. Previously resolved lists are replaced.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+ResolveOutlineDashes(
+    Tk_Outline *outline)	/* Outline whose dash lists to resolve. */
+{
+    OutlineDashes *cachePtr = (OutlineDashes *)outline->reserved1;
+    const char *p;
+    int state, n;
+
+    if (cachePtr == NULL) {
+	cachePtr = (OutlineDashes *)ckalloc(sizeof(OutlineDashes));
+	for (state = 0; state < OUTLINE_STATES; state++) {
+	    cachePtr->dash[state].listPtr = cachePtr->dash[state].space;
+	}
+	outline->reserved1 = cachePtr;
+    }
+
+    for (state = 0; state < OUTLINE_STATES; state++) {
+	OutlineDash *odPtr = &cachePtr->dash[state];
+	Tk_Dash *dash = &outline->dash;
+	double width = outline->width;
+
+	if (width < 1.0) {
+	    width = 1.0;
+	}
+	if (state == OUTLINE_ACTIVE) {
+	    if (outline->activeWidth > width) {
+		width = outline->activeWidth;
+	    }
+	    if (outline->activeDash.number != 0) {
+		dash = &outline->activeDash;
+	    }
+	} else if (state == OUTLINE_DISABLED) {
+	    if (outline->disabledWidth > width) {
+		width = outline->disabledWidth;
+	    }
+	    if (outline->disabledDash.number != 0) {
+		dash = &outline->disabledDash;
+	    }
+	}
+
+	if (odPtr->listPtr != odPtr->space) {
+	    ckfree(odPtr->listPtr);
+	    odPtr->listPtr = odPtr->space;
+	}
+	odPtr->number = 0;
+
+	if ((dash->number < -1) ||
+		((dash->number == -1) && (dash->pattern.array[0] != ','))) {
+	    n = -dash->number;
+	    p = (n > (int)sizeof(char *)) ? dash->pattern.pt
+		    : dash->pattern.array;
+	    if (2*n > (int)sizeof(odPtr->space)) {
+		odPtr->listPtr = (char *)ckalloc(2 * n);
+	    }
+	    n = DashConvert(odPtr->listPtr, p, n, width);
+	    if (n > 0) {
+		odPtr->number = n;
+	    }
+	} else if (dash->number > 2 || (dash->number == 2 &&
+		(dash->pattern.array[0] != dash->pattern.array[1]))) {
+	    n = dash->number;
+	    p = (n > (int)sizeof(char *)) ? dash->pattern.pt
+		    : dash->pattern.array;
+	    if (n > (int)sizeof(odPtr->space)) {
+		odPtr->listPtr = (char *)ckalloc(n);
+	    }
+	    memcpy(odPtr->listPtr, p, (size_t)n);
+	    odPtr->number = n;
+	} else if (dash->number != 0) {
+	    /*
+	     * Simple repeating pattern: a single dash byte is enough; see
+	     * the corresponding branch in Tk_ChangeOutlineGC.
+	     */
+
+	    odPtr->listPtr[0] =
+		    ((unsigned int)ABS(dash->number) > sizeof(char *))
+		    ? dash->pattern.pt[0] : dash->pattern.array[0];
+	    odPtr->number = 1;
+	}
+    }
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -1896,6 +2117,175 @@ TkRotatePoint(
     *xPtr = originX + x * cosine + y * sine;
     *yPtr = originY - x * sine + y * cosine;
 }
+
+/*
+ * The functions below implement the per-canvas memory pool declared in
+ * tkCanvas.h. Blocks are carved sequentially out of fixed-size arena chunks
+ * and carry a one-word header recording their size class; freed blocks go
+ * onto a per-class free list for reuse. Requests too large to pool fall
+ * through to ckalloc with a sentinel class in the header, so TkCanvasPoolFree
+ * works uniformly on either kind of block.
+ */
+
+typedef struct TkCanvasPoolChunk {
+    struct TkCanvasPoolChunk *nextPtr;
+				/* Next older chunk in the canvas's chain. */
+} TkCanvasPoolChunk;
+
+#define POOL_CHUNK_SIZE		8192	/* Bytes per arena chunk. */
+#define POOL_HEADER_SIZE	16	/* Block header size; also keeps
+					 * payloads 16-byte aligned. */
+#define POOL_LARGE_CLASS	((size_t) -1)
+					/* Header value for blocks that came
+					 * straight from ckalloc. */
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkCanvasPoolInit, TkCanvasPoolDrain --
+ *
+ *	Set up the pool for a new canvas, and release every chunk when the
+ *	canvas is destroyed. Individual large blocks are returned by
+ *	TkCanvasPoolFree as they die, so the drain only has to walk the chunk
+ *	chain.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory is initialized or released.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkCanvasPoolInit(
+    TkCanvas *canvasPtr)	/* Canvas being created. */
+{
+    int i;
+
+    canvasPtr->poolChunkPtr = NULL;
+    canvasPtr->poolFreeByte = NULL;
+    canvasPtr->poolBytesLeft = 0;
+    for (i = 0; i < TK_CANVAS_POOL_NCLASSES; i++) {
+	canvasPtr->poolFreeLists[i] = NULL;
+    }
+}
+
+void
+TkCanvasPoolDrain(
+    TkCanvas *canvasPtr)	/* Canvas being destroyed. */
+{
+    TkCanvasPoolChunk *chunkPtr, *nextPtr;
+
+    for (chunkPtr = canvasPtr->poolChunkPtr; chunkPtr != NULL;
+	    chunkPtr = nextPtr) {
+	nextPtr = chunkPtr->nextPtr;
+	TkMemFree(chunkPtr);
+    }
+    TkCanvasPoolInit(canvasPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkCanvasPoolAlloc --
+ *
+ *	Allocate a block of storage whose lifetime is tied to a canvas, such
+ *	as an item record or a coordinate array.
+ *
+ * Results:
+ *	A pointer to a block of at least the requested size. The block must
+ *	be released with TkCanvasPoolFree (or will be reclaimed wholesale
+ *	when the canvas is destroyed); it must never be passed to ckfree or
+ *	ckrealloc.
+ *
+ * Side effects:
+ *	A new arena chunk may be allocated.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void *
+TkCanvasPoolAlloc(
+    Tk_Canvas canvas,		/* Canvas that owns the storage. */
+    size_t size)		/* Number of bytes needed. */
+{
+    TkCanvas *canvasPtr = Canvas(canvas);
+    size_t total, sizeClass;
+    char *blockPtr;
+
+    if (size == 0) {
+	size = 1;
+    }
+    total = size + POOL_HEADER_SIZE;
+    if (total > (size_t) TK_CANVAS_POOL_GRAIN * TK_CANVAS_POOL_NCLASSES) {
+	blockPtr = (char *)ckalloc(total);
+	*(size_t *) blockPtr = POOL_LARGE_CLASS;
+	return blockPtr + POOL_HEADER_SIZE;
+    }
+    sizeClass = (total + TK_CANVAS_POOL_GRAIN - 1) / TK_CANVAS_POOL_GRAIN - 1;
+    total = (sizeClass + 1) * TK_CANVAS_POOL_GRAIN;
+    if (canvasPtr->poolFreeLists[sizeClass] != NULL) {
+	blockPtr = (char *)canvasPtr->poolFreeLists[sizeClass];
+	canvasPtr->poolFreeLists[sizeClass] =
+		*(void **) (blockPtr + POOL_HEADER_SIZE);
+    } else {
+	if (canvasPtr->poolBytesLeft < total) {
+	    TkCanvasPoolChunk *chunkPtr = (TkCanvasPoolChunk *)
+		    TkMemAlloc(TK_MEM_CANVAS, POOL_CHUNK_SIZE);
+
+	    chunkPtr->nextPtr = canvasPtr->poolChunkPtr;
+	    canvasPtr->poolChunkPtr = chunkPtr;
+	    canvasPtr->poolFreeByte = (char *)chunkPtr + POOL_HEADER_SIZE;
+	    canvasPtr->poolBytesLeft = POOL_CHUNK_SIZE - POOL_HEADER_SIZE;
+	}
+	blockPtr = canvasPtr->poolFreeByte;
+	canvasPtr->poolFreeByte += total;
+	canvasPtr->poolBytesLeft -= total;
+    }
+    *(size_t *) blockPtr = sizeClass;
+    return blockPtr + POOL_HEADER_SIZE;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkCanvasPoolFree --
+ *
+ *	Release a block obtained from TkCanvasPoolAlloc.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Pooled blocks go back on their size class's free list for reuse;
+ *	large blocks are returned to the general allocator.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkCanvasPoolFree(
+    Tk_Canvas canvas,		/* Canvas that owns the storage. */
+    void *ptr)			/* Block to release; may be NULL. */
+{
+    TkCanvas *canvasPtr = Canvas(canvas);
+    char *blockPtr;
+    size_t sizeClass;
+
+    if (ptr == NULL) {
+	return;
+    }
+    blockPtr = (char *)ptr - POOL_HEADER_SIZE;
+    sizeClass = *(size_t *) blockPtr;
+    if (sizeClass == POOL_LARGE_CLASS) {
+	ckfree(blockPtr);
+	return;
+    }
+    *(void **) ptr = canvasPtr->poolFreeLists[sizeClass];
+    canvasPtr->poolFreeLists[sizeClass] = blockPtr;
+}
 
 /*
  * Local Variables:
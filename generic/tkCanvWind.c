@@ -181,6 +181,7 @@ CreateWinItem(
     if (objc == 0) {
 	Tcl_Panic("canvas did not pass any coords");
     }
+    Canvas(canvas)->numWinItems++;
 
     /*
      * Initialize item's record.
@@ -409,6 +410,7 @@ DeleteWinItem(
     WindowItem *winItemPtr = (WindowItem *) itemPtr;
     Tk_Window canvasTkwin = Tk_CanvasTkwin(canvas);
 
+    Canvas(canvas)->numWinItems--;
     if (winItemPtr->tkwin != NULL) {
 	Tk_DeleteEventHandler(winItemPtr->tkwin, StructureNotifyMask,
 		WinItemStructureProc, winItemPtr);
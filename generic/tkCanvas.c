@@ -14,6 +14,7 @@
  */
 
 #include "tkInt.h"
+#include "tkArray.h"
 #include "tkCanvas.h"
 #include "default.h"
 #include "tkPort.h"
@@ -28,6 +29,29 @@
  * See tkCanvas.h for key data structures used to implement canvases.
  */
 
+#ifndef USE_OLD_TAG_SEARCH
+/*
+ * Compiled tag search expressions (see TagSearchScanExpr) are sequences of
+ * operator and tag uids. Most expressions are short, so the uid array keeps
+ * its first entries inline and only spills to the heap for unusually long
+ * expressions.
+ */
+
+TK_SMALL_ARRAY_DEFINE(TagExprUids, Tk_Uid, 16);
+
+struct TagSearchExpr_s {
+    TagSearchExpr *next;	/* For linked lists of expressions - used in
+				 * bindings. */
+    Tk_Uid uid;			/* The uid of the whole expression. */
+    TagExprUids uids;		/* Expression compiled to an array of uids. */
+    int length;			/* Length of expression. */
+    int index;			/* Current position in expression
+				 * evaluation. */
+    int match;			/* This expression matches event's item's
+				 * tags. */
+};
+#endif /* not USE_OLD_TAG_SEARCH */
+
 /*
  * The structure defined below is used to keep track of a tag search in
  * progress. No field should be accessed by anyone other than TagSearchScan,
@@ -62,6 +86,12 @@ typedef struct TagSearch {
     unsigned int rewritebufferAllocated;
 				/* Available space for rewrites. */
     TagSearchExpr *expr;	/* Compiled tag expression. */
+    Tk_Item **tagItems;		/* For single-tag searches: snapshot of the
+				 * items carrying the tag, in display order,
+				 * taken from the canvas's tag index. NULL
+				 * for other search types. */
+    int numTagItems;		/* Number of entries in tagItems. */
+    int tagItemIndex;		/* Next entry to consider returning. */
 } TagSearch;
 
 /*
@@ -92,6 +122,8 @@ static const Tk_CustomOption offsetOption = {
  */
 
 static const Tk_ConfigSpec configSpecs[] = {
+    {TK_CONFIG_BOOLEAN, "-antialias", "antialias", "Antialias",
+	"0", offsetof(TkCanvas, antialias), 0, NULL},
     {TK_CONFIG_BORDER, "-background", "background", "Background",
 	DEF_CANVAS_BG_COLOR, offsetof(TkCanvas, bgBorder),
 	TK_CONFIG_COLOR_ONLY, NULL},
@@ -132,6 +164,10 @@ static const Tk_ConfigSpec configSpecs[] = {
 	DEF_CANVAS_INSERT_ON_TIME, offsetof(TkCanvas, insertOnTime), 0, NULL},
     {TK_CONFIG_PIXELS, "-insertwidth", "insertWidth", "InsertWidth",
 	DEF_CANVAS_INSERT_WIDTH, offsetof(TkCanvas, textInfo.insertWidth), 0, NULL},
+    {TK_CONFIG_COLOR, "-lodcolor", "lodColor", "Foreground",
+	"black", offsetof(TkCanvas, lodColor), 0, NULL},
+    {TK_CONFIG_PIXELS, "-lodthreshold", "lodThreshold", "LodThreshold",
+	"0", offsetof(TkCanvas, lodThreshold), 0, NULL},
     {TK_CONFIG_CUSTOM, "-offset", "offset", "Offset", "0,0",
 	offsetof(TkCanvas, tsoffset),TK_CONFIG_DONT_SET_DEFAULT,
 	&offsetOption},
@@ -249,7 +285,7 @@ static void		DefaultRotateImplementation(TkCanvas *canvasPtr,
 static Tcl_FreeProc	DestroyCanvas;
 static int		DrawCanvas(Tcl_Interp *interp, void *clientData, Tk_PhotoHandle photohandle, int subsample, int zoom);
 static void		DisplayCanvas(void *clientData);
-static void		DoItem(Tcl_Obj *accumObj,
+static void		DoItem(TkCanvas *canvasPtr, Tcl_Obj *accumObj,
 			    Tk_Item *itemPtr, Tk_Uid tag);
 static void		EventuallyRedrawItem(TkCanvas *canvasPtr,
 			    Tk_Item *itemPtr);
@@ -261,7 +297,12 @@ static int		FindArea(Tcl_Interp *interp, TkCanvas *canvasPtr,
 			    Tcl_Obj *const *objv, Tk_Uid uid, int enclosed);
 static double		GridAlign(double coord, double spacing);
 static void		InitCanvas(void);
+static void		ItemAffineTransform(TkCanvas *canvasPtr,
+			    Tk_Item *itemPtr, const double matrix[6]);
 static void		PickCurrentItem(TkCanvas *canvasPtr, XEvent *eventPtr);
+static void		ComputeScrollFractions(int screen1, int screen2,
+			    int object1, int object2, double *firstPtr,
+			    double *lastPtr);
 static Tcl_Obj *	ScrollFractions(int screen1,
 			    int screen2, int object1, int object2);
 static int		RelinkItems(TkCanvas *canvasPtr, Tcl_Obj *tag,
@@ -278,6 +319,69 @@ static int		TagSearchEvalExpr(TagSearchExpr *expr,
 static Tk_Item *	TagSearchFirst(TagSearch *searchPtr);
 static Tk_Item *	TagSearchNext(TagSearch *searchPtr);
 
+/*
+ * The structures below implement a spatial index over item bounding boxes.
+ * The canvas is divided into a grid of fixed-size cells; each cell keeps the
+ * list of items whose bounding boxes overlap it, so that area searches and
+ * redraw culling only need to visit the cells covered by the query rectangle
+ * instead of walking the whole display list. Items whose bounding boxes span
+ * more than INDEX_MAX_CELLS cells are kept on a separate "oversize" list that
+ * is always scanned; this bounds the per-item bookkeeping cost for things
+ * like full-scene background rectangles.
+ */
+
+#define INDEX_CELL_SHIFT	8	/* Cells are 256x256 canvas pixels. */
+#define INDEX_MAX_CELLS		64	/* Span limit before an item is moved
+					 * to the oversize list. */
+#define INDEX_CELL_OF(coord)	((coord) >> INDEX_CELL_SHIFT)
+#define INDEX_LINEAR_MAX	4096	/* Scenes up to this many items are
+					 * culled by a linear sweep over the
+					 * packed bounding box arrays rather
+					 * than by probing grid cells; the
+					 * sweep touches only contiguous
+					 * memory and needs no sort. */
+
+typedef struct TkCanvasIndexItem {
+    Tk_Item *itemPtr;		/* Item this record describes. */
+    int x1, y1, x2, y2;		/* Bounding box currently recorded in the
+				 * index (may lag itemPtr's real bbox until
+				 * the next EventuallyRedrawItem call). */
+    int oversize;		/* Non-zero means the item lives on the
+				 * canvas's oversize list, not in cells. */
+    struct TkCanvasIndexItem *nextOversizePtr, *prevOversizePtr;
+				/* Links on the oversize list. */
+    unsigned long order;	/* Cached position in the display list; only
+				 * meaningful while indexOrderValid is set. */
+    unsigned long queryEpoch;	/* Epoch of the last query that visited this
+				 * record; used to de-duplicate candidates. */
+    int bboxSlot;		/* Position of this record's box in the
+				 * canvas's packed bounding box arrays, or -1;
+				 * only meaningful while indexBBoxValid is
+				 * set. */
+} TkCanvasIndexItem;
+
+typedef struct IndexCell {
+    int numItems;		/* Number of records stored in items. */
+    int maxItems;		/* Allocated slots in items. */
+    TkCanvasIndexItem **items;	/* Malloc'ed array of record pointers. */
+} IndexCell;
+
+static void		CanvasIndexInit(TkCanvas *canvasPtr);
+static void		CanvasIndexFree(TkCanvas *canvasPtr);
+static void		CanvasIndexItem(TkCanvas *canvasPtr, Tk_Item *itemPtr);
+static void		CanvasUnindexItem(TkCanvas *canvasPtr,
+			    Tk_Item *itemPtr);
+static int		CanvasIndexQuery(TkCanvas *canvasPtr, int x1, int y1,
+			    int x2, int y2, TkCanvasIndexItem ***recsPtr);
+static void		CanvasIndexRebuildBBoxes(TkCanvas *canvasPtr);
+static void		CanvasIndexRevalidate(TkCanvas *canvasPtr);
+static int		CanvasIndexSweep(TkCanvas *canvasPtr, int x1, int y1,
+			    int x2, int y2, TkCanvasIndexItem ***recsPtr);
+static void		CanvasAddDamage(TkCanvas *canvasPtr, int x1, int y1,
+			    int x2, int y2);
+static int		CanvasItemCollapsed(TkCanvas *canvasPtr,
+			    Tk_Item *itemPtr);
+
 /*
  * The structure below defines canvas class behavior by means of functions
  * that can be invoked from generic window code.
@@ -309,6 +413,797 @@ static const Tk_ClassProcs canvasClass = {
     FindItems(interp, canvasPtr, objc, objv, (objPtr), (n), &searchPtr)
 #define RELINK_ITEMS(objPtr, itemPtr) \
     result = RelinkItems(canvasPtr, (objPtr), (itemPtr), &searchPtr)
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasIndexInit, CanvasIndexFree --
+ *
+ *	Set up and tear down the spatial index for a canvas.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Hash tables are initialized or freed, along with all per-cell arrays
+ *	and per-item records.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+CanvasIndexInit(
+    TkCanvas *canvasPtr)	/* Canvas being created. */
+{
+    Tcl_InitHashTable(&canvasPtr->indexCellTable, 2);
+    Tcl_InitHashTable(&canvasPtr->indexItemTable, TCL_ONE_WORD_KEYS);
+    canvasPtr->indexOversizePtr = NULL;
+    canvasPtr->indexNextOrder = 0;
+    canvasPtr->indexQueryEpoch = 0;
+    canvasPtr->indexOrderValid = 1;
+    canvasPtr->indexBBoxes = NULL;
+    canvasPtr->indexBBoxRecs = NULL;
+    canvasPtr->indexNumBBoxes = 0;
+    canvasPtr->indexMaxBBoxes = 0;
+    canvasPtr->indexBBoxValid = 0;
+    canvasPtr->indexNumItems = 0;
+    canvasPtr->indexSuspect = 0;
+}
+
+static void
+CanvasIndexFree(
+    TkCanvas *canvasPtr)	/* Canvas being destroyed. */
+{
+    Tcl_HashEntry *entryPtr;
+    Tcl_HashSearch search;
+
+    for (entryPtr = Tcl_FirstHashEntry(&canvasPtr->indexCellTable, &search);
+	    entryPtr != NULL; entryPtr = Tcl_NextHashEntry(&search)) {
+	IndexCell *cellPtr = (IndexCell *)Tcl_GetHashValue(entryPtr);
+
+	ckfree(cellPtr->items);
+	ckfree(cellPtr);
+    }
+    Tcl_DeleteHashTable(&canvasPtr->indexCellTable);
+    for (entryPtr = Tcl_FirstHashEntry(&canvasPtr->indexItemTable, &search);
+	    entryPtr != NULL; entryPtr = Tcl_NextHashEntry(&search)) {
+	ckfree(Tcl_GetHashValue(entryPtr));
+    }
+    Tcl_DeleteHashTable(&canvasPtr->indexItemTable);
+    canvasPtr->indexOversizePtr = NULL;
+    if (canvasPtr->indexBBoxes != NULL) {
+	ckfree(canvasPtr->indexBBoxes);
+	ckfree(canvasPtr->indexBBoxRecs);
+	canvasPtr->indexBBoxes = NULL;
+	canvasPtr->indexBBoxRecs = NULL;
+    }
+    canvasPtr->indexNumBBoxes = 0;
+    canvasPtr->indexMaxBBoxes = 0;
+    canvasPtr->indexBBoxValid = 0;
+    canvasPtr->indexNumItems = 0;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasIndexRemoveFromCells --
+ *
+ *	Remove an item's record from every cell covered by the bounding box
+ *	recorded in the index, or unlink it from the oversize list.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Cell arrays are updated; cells that become empty are freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+CanvasIndexRemoveFromCells(
+    TkCanvas *canvasPtr,	/* Canvas whose index is being updated. */
+    TkCanvasIndexItem *recPtr)	/* Record to remove. */
+{
+    int cx, cy, key[2];
+    Tcl_HashEntry *entryPtr;
+
+    if (recPtr->oversize) {
+	if (recPtr->prevOversizePtr != NULL) {
+	    recPtr->prevOversizePtr->nextOversizePtr =
+		    recPtr->nextOversizePtr;
+	} else {
+	    canvasPtr->indexOversizePtr = recPtr->nextOversizePtr;
+	}
+	if (recPtr->nextOversizePtr != NULL) {
+	    recPtr->nextOversizePtr->prevOversizePtr =
+		    recPtr->prevOversizePtr;
+	}
+	recPtr->nextOversizePtr = recPtr->prevOversizePtr = NULL;
+	recPtr->oversize = 0;
+	return;
+    }
+    for (cy = INDEX_CELL_OF(recPtr->y1); cy <= INDEX_CELL_OF(recPtr->y2);
+	    cy++) {
+	for (cx = INDEX_CELL_OF(recPtr->x1); cx <= INDEX_CELL_OF(recPtr->x2);
+		cx++) {
+	    IndexCell *cellPtr;
+	    int i;
+
+	    key[0] = cx; key[1] = cy;
+	    entryPtr = Tcl_FindHashEntry(&canvasPtr->indexCellTable,
+		    (char *) key);
+	    if (entryPtr == NULL) {
+		continue;
+	    }
+	    cellPtr = (IndexCell *)Tcl_GetHashValue(entryPtr);
+	    for (i = 0; i < cellPtr->numItems; i++) {
+		if (cellPtr->items[i] == recPtr) {
+		    cellPtr->items[i] = cellPtr->items[cellPtr->numItems-1];
+		    cellPtr->numItems--;
+		    break;
+		}
+	    }
+	    if (cellPtr->numItems == 0) {
+		ckfree(cellPtr->items);
+		ckfree(cellPtr);
+		Tcl_DeleteHashEntry(entryPtr);
+	    }
+	}
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasIndexItem --
+ *
+ *	Bring the spatial index up to date for one item. Creates the item's
+ *	record on first use; afterwards this is cheap whenever the bounding
+ *	box hasn't changed, so it may be called from every redraw hook.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The item is inserted into the cells covered by its current bounding
+ *	box (or onto the oversize list), after removal from its old ones.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+CanvasIndexItem(
+    TkCanvas *canvasPtr,	/* Canvas containing the item. */
+    Tk_Item *itemPtr)		/* Item whose bounding box may have moved. */
+{
+    Tcl_HashEntry *entryPtr;
+    TkCanvasIndexItem *recPtr;
+    int isNew, cx, cy, key[2];
+    long spanX, spanY;
+
+    entryPtr = Tcl_CreateHashEntry(&canvasPtr->indexItemTable,
+	    (char *) itemPtr, &isNew);
+    if (isNew) {
+	recPtr = (TkCanvasIndexItem *)ckalloc(sizeof(TkCanvasIndexItem));
+	recPtr->itemPtr = itemPtr;
+	recPtr->oversize = 0;
+	recPtr->nextOversizePtr = recPtr->prevOversizePtr = NULL;
+	recPtr->order = canvasPtr->indexNextOrder++;
+	recPtr->queryEpoch = 0;
+	recPtr->bboxSlot = -1;
+	Tcl_SetHashValue(entryPtr, recPtr);
+	canvasPtr->indexNumItems++;
+	canvasPtr->indexBBoxValid = 0;
+    } else {
+	recPtr = (TkCanvasIndexItem *)Tcl_GetHashValue(entryPtr);
+	if ((recPtr->x1 == itemPtr->x1) && (recPtr->y1 == itemPtr->y1)
+		&& (recPtr->x2 == itemPtr->x2)
+		&& (recPtr->y2 == itemPtr->y2)) {
+	    return;
+	}
+	CanvasIndexRemoveFromCells(canvasPtr, recPtr);
+    }
+    recPtr->x1 = itemPtr->x1;
+    recPtr->y1 = itemPtr->y1;
+    recPtr->x2 = itemPtr->x2;
+    recPtr->y2 = itemPtr->y2;
+    if (canvasPtr->indexBBoxValid && (recPtr->bboxSlot >= 0)) {
+	int *bb = canvasPtr->indexBBoxes + 4 * recPtr->bboxSlot;
+
+	bb[0] = recPtr->x1;
+	bb[1] = recPtr->y1;
+	bb[2] = recPtr->x2;
+	bb[3] = recPtr->y2;
+    }
+    spanX = (long) INDEX_CELL_OF(recPtr->x2) - INDEX_CELL_OF(recPtr->x1) + 1;
+    spanY = (long) INDEX_CELL_OF(recPtr->y2) - INDEX_CELL_OF(recPtr->y1) + 1;
+    if (spanX * spanY > INDEX_MAX_CELLS) {
+	recPtr->oversize = 1;
+	recPtr->prevOversizePtr = NULL;
+	recPtr->nextOversizePtr = canvasPtr->indexOversizePtr;
+	if (canvasPtr->indexOversizePtr != NULL) {
+	    canvasPtr->indexOversizePtr->prevOversizePtr = recPtr;
+	}
+	canvasPtr->indexOversizePtr = recPtr;
+	return;
+    }
+    for (cy = INDEX_CELL_OF(recPtr->y1); cy <= INDEX_CELL_OF(recPtr->y2);
+	    cy++) {
+	for (cx = INDEX_CELL_OF(recPtr->x1); cx <= INDEX_CELL_OF(recPtr->x2);
+		cx++) {
+	    IndexCell *cellPtr;
+
+	    key[0] = cx; key[1] = cy;
+	    entryPtr = Tcl_CreateHashEntry(&canvasPtr->indexCellTable,
+		    (char *) key, &isNew);
+	    if (isNew) {
+		cellPtr = (IndexCell *)ckalloc(sizeof(IndexCell));
+		cellPtr->numItems = 0;
+		cellPtr->maxItems = 4;
+		cellPtr->items = (TkCanvasIndexItem **)ckalloc(
+			cellPtr->maxItems * sizeof(TkCanvasIndexItem *));
+		Tcl_SetHashValue(entryPtr, cellPtr);
+	    } else {
+		cellPtr = (IndexCell *)Tcl_GetHashValue(entryPtr);
+		if (cellPtr->numItems >= cellPtr->maxItems) {
+		    cellPtr->maxItems *= 2;
+		    cellPtr->items = (TkCanvasIndexItem **)ckrealloc(
+			    cellPtr->items,
+			    cellPtr->maxItems * sizeof(TkCanvasIndexItem *));
+		}
+	    }
+	    cellPtr->items[cellPtr->numItems++] = recPtr;
+	}
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasUnindexItem --
+ *
+ *	Remove an item from the spatial index, e.g. because it is being
+ *	deleted.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The item's record and cell references are freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+CanvasUnindexItem(
+    TkCanvas *canvasPtr,	/* Canvas containing the item. */
+    Tk_Item *itemPtr)		/* Item being removed from the canvas. */
+{
+    Tcl_HashEntry *entryPtr;
+    TkCanvasIndexItem *recPtr;
+
+    entryPtr = Tcl_FindHashEntry(&canvasPtr->indexItemTable,
+	    (char *) itemPtr);
+    if (entryPtr == NULL) {
+	return;
+    }
+    recPtr = (TkCanvasIndexItem *)Tcl_GetHashValue(entryPtr);
+    CanvasIndexRemoveFromCells(canvasPtr, recPtr);
+    ckfree(recPtr);
+    Tcl_DeleteHashEntry(entryPtr);
+    canvasPtr->indexNumItems--;
+    canvasPtr->indexBBoxValid = 0;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasIndexRevalidate --
+ *
+ *	Bring the spatial index back in sync with the items after damage
+ *	was reported from outside the canvas core. EventuallyRedrawItem
+ *	brackets every bounding box change the core makes, but image and
+ *	window items (and item types registered through the public
+ *	Tk_CreateItemType) recompute header.x1..y2 themselves and then call
+ *	only Tk_CanvasEventuallyRedraw, so their recorded boxes can go stale
+ *	and queries would miss them entirely.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Every record whose stored bounding box no longer matches its item is
+ *	re-indexed. Does nothing unless Tk_CanvasEventuallyRedraw has been
+ *	called since the last revalidation, so in the common case this is a
+ *	single flag test.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+CanvasIndexRevalidate(
+    TkCanvas *canvasPtr)	/* Canvas whose index may be stale. */
+{
+    Tcl_HashEntry *entryPtr;
+    Tcl_HashSearch search;
+
+    if (!canvasPtr->indexSuspect) {
+	return;
+    }
+    canvasPtr->indexSuspect = 0;
+    for (entryPtr = Tcl_FirstHashEntry(&canvasPtr->indexItemTable, &search);
+	    entryPtr != NULL; entryPtr = Tcl_NextHashEntry(&search)) {
+	TkCanvasIndexItem *recPtr = (TkCanvasIndexItem *)
+		Tcl_GetHashValue(entryPtr);
+	Tk_Item *itemPtr = recPtr->itemPtr;
+
+	if ((recPtr->x1 != itemPtr->x1) || (recPtr->y1 != itemPtr->y1)
+		|| (recPtr->x2 != itemPtr->x2)
+		|| (recPtr->y2 != itemPtr->y2)) {
+	    CanvasIndexItem(canvasPtr, itemPtr);
+	}
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasIndexCompareOrder --
+ *
+ *	qsort comparison callback: order candidate records by their cached
+ *	position in the display list, so queries report items in the same
+ *	order a full list walk would.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+CanvasIndexCompareOrder(
+    const void *a,
+    const void *b)
+{
+    const TkCanvasIndexItem *recA = *(TkCanvasIndexItem *const *) a;
+    const TkCanvasIndexItem *recB = *(TkCanvasIndexItem *const *) b;
+
+    if (recA->order < recB->order) {
+	return -1;
+    } else if (recA->order > recB->order) {
+	return 1;
+    }
+    return 0;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasIndexQuery --
+ *
+ *	Collect all indexed items whose recorded bounding boxes overlap the
+ *	given rectangle, in display-list order.
+ *
+ * Results:
+ *	Returns the number of candidate items found, and stores a ckalloc'ed
+ *	array of record pointers (or NULL if none) at *recsPtr. The caller
+ *	must ckfree the array. Candidates are only guaranteed to pass the
+ *	bounding-box test recorded in the index; callers should re-check the
+ *	item's actual bounding box and state as needed.
+ *
+ * Side effects:
+ *	If the display list has been reordered since the last query, every
+ *	item's cached order number is recomputed first.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+CanvasIndexQuery(
+    TkCanvas *canvasPtr,	/* Canvas to search. */
+    int x1, int y1,		/* Upper-left corner of query area. */
+    int x2, int y2,		/* Lower-right corner of query area. */
+    TkCanvasIndexItem ***recsPtr)
+				/* Where to store the candidate array. */
+{
+    TkCanvasIndexItem **recs, *recPtr;
+    int numRecs, maxRecs, cx, cy, key[2];
+    Tcl_HashEntry *entryPtr;
+
+    CanvasIndexRevalidate(canvasPtr);
+    if (canvasPtr->indexNumItems <= INDEX_LINEAR_MAX) {
+	return CanvasIndexSweep(canvasPtr, x1, y1, x2, y2, recsPtr);
+    }
+
+    if (!canvasPtr->indexOrderValid) {
+	Tk_Item *itemPtr;
+	unsigned long order = 0;
+
+	for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
+		itemPtr = itemPtr->nextPtr) {
+	    entryPtr = Tcl_FindHashEntry(&canvasPtr->indexItemTable,
+		    (char *) itemPtr);
+	    if (entryPtr != NULL) {
+		((TkCanvasIndexItem *)Tcl_GetHashValue(entryPtr))->order =
+			order;
+	    }
+	    order++;
+	}
+	canvasPtr->indexNextOrder = order;
+	canvasPtr->indexOrderValid = 1;
+    }
+
+    canvasPtr->indexQueryEpoch++;
+    numRecs = 0;
+    maxRecs = 32;
+    recs = (TkCanvasIndexItem **)ckalloc(
+	    maxRecs * sizeof(TkCanvasIndexItem *));
+    for (cy = INDEX_CELL_OF(y1); cy <= INDEX_CELL_OF(y2); cy++) {
+	for (cx = INDEX_CELL_OF(x1); cx <= INDEX_CELL_OF(x2); cx++) {
+	    IndexCell *cellPtr;
+	    int i;
+
+	    key[0] = cx; key[1] = cy;
+	    entryPtr = Tcl_FindHashEntry(&canvasPtr->indexCellTable,
+		    (char *) key);
+	    if (entryPtr == NULL) {
+		continue;
+	    }
+	    cellPtr = (IndexCell *)Tcl_GetHashValue(entryPtr);
+	    for (i = 0; i < cellPtr->numItems; i++) {
+		recPtr = cellPtr->items[i];
+		if (recPtr->queryEpoch == canvasPtr->indexQueryEpoch) {
+		    continue;
+		}
+		recPtr->queryEpoch = canvasPtr->indexQueryEpoch;
+		if ((recPtr->x1 >= x2) || (recPtr->x2 < x1)
+			|| (recPtr->y1 >= y2) || (recPtr->y2 < y1)) {
+		    continue;
+		}
+		if (numRecs >= maxRecs) {
+		    maxRecs *= 2;
+		    recs = (TkCanvasIndexItem **)ckrealloc(recs,
+			    maxRecs * sizeof(TkCanvasIndexItem *));
+		}
+		recs[numRecs++] = recPtr;
+	    }
+	}
+    }
+    for (recPtr = canvasPtr->indexOversizePtr; recPtr != NULL;
+	    recPtr = recPtr->nextOversizePtr) {
+	if ((recPtr->x1 >= x2) || (recPtr->x2 < x1)
+		|| (recPtr->y1 >= y2) || (recPtr->y2 < y1)) {
+	    continue;
+	}
+	if (numRecs >= maxRecs) {
+	    maxRecs *= 2;
+	    recs = (TkCanvasIndexItem **)ckrealloc(recs,
+		    maxRecs * sizeof(TkCanvasIndexItem *));
+	}
+	recs[numRecs++] = recPtr;
+    }
+    if (numRecs > 1) {
+	qsort(recs, numRecs, sizeof(TkCanvasIndexItem *),
+		CanvasIndexCompareOrder);
+    }
+    *recsPtr = recs;
+    return numRecs;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasIndexRebuildBBoxes --
+ *
+ *	Rebuild the packed bounding box arrays from the current display
+ *	list. The boxes are stored four ints per item in display order, with
+ *	a parallel array of record pointers, so a query is a linear sweep
+ *	over contiguous memory and its results need no sorting.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The packed arrays are (re)allocated as needed and marked valid.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+CanvasIndexRebuildBBoxes(
+    TkCanvas *canvasPtr)	/* Canvas whose packed arrays to rebuild. */
+{
+    Tk_Item *itemPtr;
+    Tcl_HashEntry *entryPtr;
+    int numBBoxes = 0;
+
+    if (canvasPtr->indexMaxBBoxes < canvasPtr->indexNumItems) {
+	int maxBBoxes = canvasPtr->indexMaxBBoxes ?
+		2 * canvasPtr->indexMaxBBoxes : 64;
+
+	while (maxBBoxes < canvasPtr->indexNumItems) {
+	    maxBBoxes *= 2;
+	}
+	if (canvasPtr->indexBBoxes != NULL) {
+	    ckfree(canvasPtr->indexBBoxes);
+	    ckfree(canvasPtr->indexBBoxRecs);
+	}
+	canvasPtr->indexBBoxes = (int *)ckalloc(
+		maxBBoxes * 4 * sizeof(int));
+	canvasPtr->indexBBoxRecs = (TkCanvasIndexItem **)ckalloc(
+		maxBBoxes * sizeof(TkCanvasIndexItem *));
+	canvasPtr->indexMaxBBoxes = maxBBoxes;
+    }
+    for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
+	    itemPtr = itemPtr->nextPtr) {
+	TkCanvasIndexItem *recPtr;
+	int *bb;
+
+	entryPtr = Tcl_FindHashEntry(&canvasPtr->indexItemTable,
+		(char *) itemPtr);
+	if (entryPtr == NULL) {
+	    continue;
+	}
+	recPtr = (TkCanvasIndexItem *)Tcl_GetHashValue(entryPtr);
+	bb = canvasPtr->indexBBoxes + 4 * numBBoxes;
+	bb[0] = recPtr->x1;
+	bb[1] = recPtr->y1;
+	bb[2] = recPtr->x2;
+	bb[3] = recPtr->y2;
+	canvasPtr->indexBBoxRecs[numBBoxes] = recPtr;
+	recPtr->bboxSlot = numBBoxes;
+	numBBoxes++;
+    }
+    canvasPtr->indexNumBBoxes = numBBoxes;
+    canvasPtr->indexBBoxValid = 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasIndexSweep --
+ *
+ *	Find the items overlapping an area by sweeping the packed bounding
+ *	box arrays. This is how small and medium scenes are culled: chasing
+ *	the item list reads each bounding box from a separate cold cache
+ *	line, while the sweep reads sixteen bytes per item from contiguous
+ *	memory, which compilers also vectorize readily.
+ *
+ * Results:
+ *	Same contract as CanvasIndexQuery: the number of overlapping items,
+ *	with a ckalloc'ed array of their records in display order stored at
+ *	*recsPtr. The caller must free the array.
+ *
+ * Side effects:
+ *	Rebuilds the packed arrays if they are stale.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+CanvasIndexSweep(
+    TkCanvas *canvasPtr,	/* Canvas to search. */
+    int x1, int y1,		/* Upper-left corner of query area. */
+    int x2, int y2,		/* Lower-right corner of query area. */
+    TkCanvasIndexItem ***recsPtr)
+				/* Where to store the candidate array. */
+{
+    TkCanvasIndexItem **recs;
+    const int *bb;
+    int numRecs = 0, maxRecs = 32, i;
+
+    if (!canvasPtr->indexBBoxValid) {
+	CanvasIndexRebuildBBoxes(canvasPtr);
+    }
+    recs = (TkCanvasIndexItem **)ckalloc(
+	    maxRecs * sizeof(TkCanvasIndexItem *));
+    bb = canvasPtr->indexBBoxes;
+    for (i = 0; i < canvasPtr->indexNumBBoxes; i++, bb += 4) {
+	if ((bb[0] >= x2) || (bb[2] < x1) || (bb[1] >= y2) || (bb[3] < y1)) {
+	    continue;
+	}
+	if (numRecs >= maxRecs) {
+	    maxRecs *= 2;
+	    recs = (TkCanvasIndexItem **)ckrealloc(recs,
+		    maxRecs * sizeof(TkCanvasIndexItem *));
+	}
+	recs[numRecs++] = canvasPtr->indexBBoxRecs[i];
+    }
+    *recsPtr = recs;
+    return numRecs;
+}
+
+/*
+ * The structure below is the value stored in a canvas's tagIndexTable: the
+ * set of items carrying one particular tag, in display order as of the epoch
+ * at which the list was built.
+ */
+
+typedef struct TagIndexList {
+    int numItems;		/* Number of entries in items. */
+    int maxItems;		/* Allocated slots in items. */
+    unsigned long epoch;	/* tagIndexEpoch value when built; the list
+				 * is stale if this lags the canvas. */
+    Tk_Item **items;		/* Malloc'ed array of items with the tag. */
+} TagIndexList;
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasTagIndexGet --
+ *
+ *	Return the (up to date) list of items carrying the given tag,
+ *	rebuilding it with one walk of the display list if it is stale or has
+ *	never been built.
+ *
+ * Results:
+ *	A pointer to the tag's index list; never NULL. The list is owned by
+ *	the canvas and is only valid until the next canvas modification, so
+ *	callers that iterate across script evaluation must take a snapshot.
+ *
+ * Side effects:
+ *	May allocate or rebuild the list.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static TagIndexList *
+CanvasTagIndexGet(
+    TkCanvas *canvasPtr,	/* Canvas to search. */
+    Tk_Uid uid)			/* Tag being searched for. */
+{
+    Tcl_HashEntry *entryPtr;
+    TagIndexList *listPtr;
+    Tk_Item *itemPtr;
+    Tk_Uid *tagPtr;
+    int isNew, count;
+
+    entryPtr = Tcl_CreateHashEntry(&canvasPtr->tagIndexTable, (char *) uid,
+	    &isNew);
+    if (isNew) {
+	listPtr = (TagIndexList *)ckalloc(sizeof(TagIndexList));
+	listPtr->numItems = 0;
+	listPtr->maxItems = 8;
+	listPtr->items = (Tk_Item **)ckalloc(
+		listPtr->maxItems * sizeof(Tk_Item *));
+	listPtr->epoch = canvasPtr->tagIndexEpoch - 1;
+	Tcl_SetHashValue(entryPtr, listPtr);
+    } else {
+	listPtr = (TagIndexList *)Tcl_GetHashValue(entryPtr);
+    }
+    if (listPtr->epoch == canvasPtr->tagIndexEpoch) {
+	return listPtr;
+    }
+    listPtr->numItems = 0;
+    for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
+	    itemPtr = itemPtr->nextPtr) {
+	for (tagPtr = itemPtr->tagPtr, count = (int)itemPtr->numTags;
+		count > 0; tagPtr++, count--) {
+	    if (*tagPtr == uid) {
+		if (listPtr->numItems >= listPtr->maxItems) {
+		    listPtr->maxItems *= 2;
+		    listPtr->items = (Tk_Item **)ckrealloc(listPtr->items,
+			    listPtr->maxItems * sizeof(Tk_Item *));
+		}
+		listPtr->items[listPtr->numItems++] = itemPtr;
+		break;
+	    }
+	}
+    }
+    listPtr->epoch = canvasPtr->tagIndexEpoch;
+    return listPtr;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasTagItemValid --
+ *
+ *	Check that an item pointer taken from a tag index snapshot still
+ *	refers to a live item that carries the tag. Needed because scripts
+ *	run during a search (e.g. from a delete) may remove or retag items
+ *	after the snapshot was taken.
+ *
+ * Results:
+ *	1 if the item may be returned from the search, 0 otherwise.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+CanvasTagItemValid(
+    TkCanvas *canvasPtr,	/* Canvas being searched. */
+    Tk_Item *itemPtr,		/* Item from a snapshot; may be stale. */
+    Tk_Uid uid)			/* Tag the search is looking for. */
+{
+    Tk_Uid *tagPtr;
+    int count;
+
+    /*
+     * Liveness is checked against the spatial index's item table, which has
+     * an entry for every item from creation to deletion; the lookup is safe
+     * even if itemPtr has been freed because only the pointer value is
+     * hashed.
+     */
+
+    if (Tcl_FindHashEntry(&canvasPtr->indexItemTable,
+	    (char *) itemPtr) == NULL) {
+	return 0;
+    }
+    for (tagPtr = itemPtr->tagPtr, count = (int)itemPtr->numTags;
+	    count > 0; tagPtr++, count--) {
+	if (*tagPtr == uid) {
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasTagIndexFree --
+ *
+ *	Release all tag index storage for a canvas being destroyed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory is released.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+CanvasTagIndexFree(
+    TkCanvas *canvasPtr)	/* Canvas being destroyed. */
+{
+    Tcl_HashEntry *entryPtr;
+    Tcl_HashSearch search;
+
+    for (entryPtr = Tcl_FirstHashEntry(&canvasPtr->tagIndexTable, &search);
+	    entryPtr != NULL; entryPtr = Tcl_NextHashEntry(&search)) {
+	TagIndexList *listPtr = (TagIndexList *)Tcl_GetHashValue(entryPtr);
+
+	ckfree(listPtr->items);
+	ckfree(listPtr);
+    }
+    Tcl_DeleteHashTable(&canvasPtr->tagIndexTable);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasItemLayer --
+ *
+ *	Look up the layer an item has been assigned to with the [layer]
+ *	widget command.
+ *
+ * Results:
+ *	The item's layer number; 0 (the live layer) if it was never assigned
+ *	to another one.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+CanvasItemLayer(
+    TkCanvas *canvasPtr,	/* Canvas containing the item. */
+    Tk_Item *itemPtr)		/* Item whose layer is wanted. */
+{
+    Tcl_HashEntry *entryPtr;
+
+    if (canvasPtr->numLayerItems == 0) {
+	return 0;
+    }
+    entryPtr = Tcl_FindHashEntry(&canvasPtr->layerTable, (char *) itemPtr);
+    if (entryPtr == NULL) {
+	return 0;
+    }
+    return PTR2INT(Tcl_GetHashValue(entryPtr));
+}
 
 /*
  * ----------------------------------------------------------------------
@@ -540,6 +1435,57 @@ ItemRotate(
     }
 }
 
+/*
+ * Canvas serialization format. The "serialize" widget command writes the
+ * whole display list as one byte array: a magic tag, a native byte-order
+ * mark (which also covers the coordinate doubles), a format version and an
+ * item count, followed by one record per item holding the type name, the
+ * raw coordinates and the options whose values differ from their defaults.
+ * The "deserialize" command recreates the items through the same bulk path
+ * as "createmany".
+ */
+
+#define CANVAS_SERIAL_MAGIC	"TkCv"
+#define CANVAS_SERIAL_MARK	0x01020304u
+#define CANVAS_SERIAL_VERSION	1
+
+static inline void
+SerialPutUint(
+    Tcl_DString *bufPtr,
+    unsigned int value)
+{
+    Tcl_DStringAppend(bufPtr, (char *) &value, sizeof(unsigned int));
+}
+
+static inline int
+SerialGetUint(
+    const unsigned char **pPtr,
+    const unsigned char *end,
+    unsigned int *valuePtr)
+{
+    if ((size_t) (end - *pPtr) < sizeof(unsigned int)) {
+	return 0;
+    }
+    memcpy(valuePtr, *pPtr, sizeof(unsigned int));
+    *pPtr += sizeof(unsigned int);
+    return 1;
+}
+
+static inline int
+SerialGetBlock(
+    const unsigned char **pPtr,
+    const unsigned char *end,
+    size_t length,
+    const unsigned char **blockPtr)
+{
+    if ((size_t) (end - *pPtr) < length) {
+	return 0;
+    }
+    *blockPtr = *pPtr;
+    *pPtr += length;
+    return 1;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -621,6 +1567,72 @@ DefaultRotateImplementation(
     Tcl_ResetResult(interp);
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * ItemAffineTransform --
+ *
+ *	Apply an affine transform, given as the six-element matrix
+ *	{a b c d tx ty} mapping (x,y) to (a*x+c*y+tx, b*x+d*y+ty), to the
+ *	coordinates of an item. Works by reading the coordinates out of the
+ *	item and writing the transformed values back, in the same way as
+ *	DefaultRotateImplementation.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+ItemAffineTransform(
+    TkCanvas *canvasPtr,
+    Tk_Item *itemPtr,
+    const double matrix[6])
+{
+    Tcl_Size i, objc;
+    int ok = 1;
+    Tcl_Obj **objv, **newObjv;
+    double *coordv;
+    Tcl_Interp *interp = canvasPtr->interp;
+
+    if (ItemCoords(canvasPtr, itemPtr, 0, NULL) == TCL_OK &&
+	    Tcl_ListObjGetElements(NULL, Tcl_GetObjResult(interp),
+		    &objc, &objv) == TCL_OK) {
+	coordv = (double *) ckalloc(sizeof(double) * objc);
+	for (i=0 ; i<objc ; i++) {
+	    if (Tcl_GetDoubleFromObj(NULL, objv[i], &coordv[i]) != TCL_OK) {
+		ok = 0;
+		break;
+	    }
+	}
+	if (ok) {
+	    for (i=0 ; i<objc ; i+=2) {
+		double px = coordv[i+0];
+		double py = coordv[i+1];
+
+		coordv[i+0] = matrix[0]*px + matrix[2]*py + matrix[4];
+		coordv[i+1] = matrix[1]*px + matrix[3]*py + matrix[5];
+	    }
+
+	    newObjv = (Tcl_Obj **) ckalloc(sizeof(Tcl_Obj *) * objc);
+	    for (i=0 ; i<objc ; i++) {
+		newObjv[i] = Tcl_NewDoubleObj(coordv[i]);
+		Tcl_IncrRefCount(newObjv[i]);
+	    }
+	    ItemCoords(canvasPtr, itemPtr, objc, newObjv);
+	    for (i=0 ; i<objc ; i++) {
+		Tcl_DecrRefCount(newObjv[i]);
+	    }
+	    ckfree((void *)newObjv);
+	}
+	ckfree((void *)coordv);
+    }
+
+    /*
+     * The interpreter result was (probably) modified above; reset it.
+     */
+
+    Tcl_ResetResult(interp);
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -686,6 +1698,10 @@ Tk_CanvasObjCmd(
     canvasPtr->highlightColorPtr = NULL;
     canvasPtr->inset = 0;
     canvasPtr->pixmapGC = NULL;
+    canvasPtr->antialias = 0;
+    canvasPtr->lodThreshold = 0;
+    canvasPtr->lodColor = NULL;
+    canvasPtr->lodGC = NULL;
     canvasPtr->width = None;
     canvasPtr->height = None;
     canvasPtr->confine = 0;
@@ -744,6 +1760,16 @@ Tk_CanvasObjCmd(
     canvasPtr->tsoffset.yoffset = 0;
     canvasPtr->bindTagExprs = NULL;
     Tcl_InitHashTable(&canvasPtr->idTable, TCL_ONE_WORD_KEYS);
+    CanvasIndexInit(canvasPtr);
+    canvasPtr->numDamage = 0;
+    canvasPtr->numWinItems = 0;
+    TkCanvasPoolInit(canvasPtr);
+    Tcl_InitHashTable(&canvasPtr->tagIndexTable, TCL_ONE_WORD_KEYS);
+    canvasPtr->tagIndexEpoch = 1;
+    Tcl_InitHashTable(&canvasPtr->layerTable, TCL_ONE_WORD_KEYS);
+    canvasPtr->numLayerItems = 0;
+    canvasPtr->layerPixmap = None;
+    canvasPtr->layerValid = 0;
 
     Tk_SetClass(canvasPtr->tkwin, "Canvas");
     Tk_SetClassProcs(canvasPtr->tkwin, &canvasClass, canvasPtr);
@@ -804,26 +1830,28 @@ CanvasWidgetCmd(
     static const char *const canvasOptionStrings[] = {
 	"addtag",	"bbox",		"bind",		"canvasx",
 	"canvasy",	"cget",		"configure",	"coords",
-	"create",	"dchars",	"delete",	"dtag",
+	"create",	"createmany",	"dchars",	"delete",
+	"deserialize",	"dtag",
 	"find",		"focus",	"gettags",	"icursor",
         "image",	"imove",	"index",	"insert",
-	"itemcget",	"itemconfigure",
+	"itemcget",	"itemconfigure",	"layer",
 	"lower",	"move",		"moveto",	"postscript",
 	"raise",	"rchars",	"rotate",	"scale",
-	"scan",		"select",	"type",		"xview",
-	"yview",	NULL
+	"scan",		"select",	"serialize",	"transform",
+	"type",		"xview",	"yview",	NULL
     };
     enum canvasOptionStringsEnum {
 	CANV_ADDTAG,	CANV_BBOX,	CANV_BIND,	CANV_CANVASX,
 	CANV_CANVASY,	CANV_CGET,	CANV_CONFIGURE,	CANV_COORDS,
-	CANV_CREATE,	CANV_DCHARS,	CANV_DELETE,	CANV_DTAG,
+	CANV_CREATE,	CANV_CREATEMANY,	CANV_DCHARS,	CANV_DELETE,
+	CANV_DESERIALIZE,	CANV_DTAG,
 	CANV_FIND,	CANV_FOCUS,	CANV_GETTAGS,	CANV_ICURSOR,
         CANV_IMAGE,	CANV_IMOVE,	CANV_INDEX,	CANV_INSERT,
-	CANV_ITEMCGET,	CANV_ITEMCONFIGURE,
+	CANV_ITEMCGET,	CANV_ITEMCONFIGURE,	CANV_LAYER,
 	CANV_LOWER,	CANV_MOVE,	CANV_MOVETO,	CANV_POSTSCRIPT,
 	CANV_RAISE,	CANV_RCHARS,	CANV_ROTATE,	CANV_SCALE,
-	CANV_SCAN,	CANV_SELECT,	CANV_TYPE,	CANV_XVIEW,
-	CANV_YVIEW
+	CANV_SCAN,	CANV_SELECT,	CANV_SERIALIZE,	CANV_TRANSFORM,
+	CANV_TYPE,	CANV_XVIEW,	CANV_YVIEW
     };
 
     if (objc < 2) {
@@ -1120,6 +2148,54 @@ CanvasWidgetCmd(
 	    result = TCL_ERROR;
 	    goto done;
 	}
+	if (strcmp(Tcl_GetString(objv[2]), "-batch") == 0) {
+	    Tcl_Size coordc;
+	    Tcl_Obj **coordv;
+	    int argIdx;
+
+	    /*
+	     * Batched form: [$c coords -batch id coordList ?id coordList?],
+	     * replacing one widget command invocation per item with a single
+	     * pass that applies every coordinate list and lets the damage
+	     * accumulator merge the redraws. This is what keeps large
+	     * animations from being dominated by per-item command dispatch.
+	     */
+
+	    if ((objc < 5) || (objc % 2 != 1)) {
+		Tcl_WrongNumArgs(interp, 2, objv,
+			"-batch tagOrId coordList ?tagOrId coordList ...?");
+		result = TCL_ERROR;
+		goto done;
+	    }
+	    for (argIdx = 3; argIdx < objc; argIdx += 2) {
+		if (Tcl_ListObjGetElements(interp, objv[argIdx+1], &coordc,
+			&coordv) != TCL_OK) {
+		    result = TCL_ERROR;
+		    goto done;
+		}
+		if (coordc == 0) {
+		    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+			    "coordinate list for \"%s\" is empty",
+			    Tcl_GetString(objv[argIdx])));
+		    Tcl_SetErrorCode(interp, "TK", "CANVAS", "COORDS",
+			    (char *)NULL);
+		    result = TCL_ERROR;
+		    goto done;
+		}
+		FIRST_CANVAS_ITEM_MATCHING(objv[argIdx], &searchPtr,
+			goto done);
+		if (itemPtr == NULL) {
+		    continue;
+		}
+		EventuallyRedrawItem(canvasPtr, itemPtr);
+		result = ItemCoords(canvasPtr, itemPtr, coordc, coordv);
+		EventuallyRedrawItem(canvasPtr, itemPtr);
+		if (result != TCL_OK) {
+		    goto done;
+		}
+	    }
+	    break;
+	}
 	FIRST_CANVAS_ITEM_MATCHING(objv[2], &searchPtr, goto done);
 	if (itemPtr != NULL) {
 	    if (objc != 3) {
@@ -1266,7 +2342,8 @@ CanvasWidgetCmd(
 	}
 
 	typePtr = matchPtr;
-	itemPtr = (Tk_Item *)ckalloc(typePtr->itemSize);
+	itemPtr = (Tk_Item *)TkCanvasPoolAlloc((Tk_Canvas) canvasPtr,
+		typePtr->itemSize);
 	itemPtr->id = canvasPtr->nextId++;
 	itemPtr->tagPtr = itemPtr->staticTagSpace;
 	itemPtr->tagSpace = TK_TAG_SPACE;
@@ -1276,7 +2353,7 @@ CanvasWidgetCmd(
 	itemPtr->redraw_flags = 0;
 
 	if (ItemCreate(canvasPtr, itemPtr, objc, objv) != TCL_OK) {
-	    ckfree(itemPtr);
+	    TkCanvasPoolFree((Tk_Canvas) canvasPtr, itemPtr);
 	    result = TCL_ERROR;
 	    goto done;
 	}
@@ -1297,9 +2374,150 @@ CanvasWidgetCmd(
 	itemPtr->redraw_flags |= FORCE_REDRAW;
 	EventuallyRedrawItem(canvasPtr, itemPtr);
 	canvasPtr->flags |= REPICK_NEEDED;
+	canvasPtr->tagIndexEpoch++;
 	Tcl_SetObjResult(interp, Tcl_NewWideIntObj(itemPtr->id));
 	break;
     }
+    case CANV_CREATEMANY: {
+	Tk_ItemType *typePtr;
+	Tk_ItemType *matchPtr = NULL;
+	Tcl_HashEntry *entryPtr;
+	Tk_Item *tailPtr, *newPtr;
+	Tcl_Obj **coordObjs, **optObjs, **args, *idListObj;
+	Tcl_Size numCoords, numOpts, k, length;
+	int isNew = 0;
+	const char *arg;
+
+	if ((objc != 4) && (objc != 5)) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "type coordsList ?optionsList?");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	arg = Tcl_GetStringFromObj(objv[2], &length);
+	c = arg[0];
+	Tcl_MutexLock(&typeListMutex);
+	for (typePtr = typeList; typePtr != NULL; typePtr = typePtr->nextPtr){
+	    if ((c == typePtr->name[0])
+		    && (!strncmp(arg, typePtr->name, length))) {
+		if (matchPtr != NULL) {
+		    Tcl_MutexUnlock(&typeListMutex);
+		    goto badManyType;
+		}
+		matchPtr = typePtr;
+	    }
+	}
+	Tcl_MutexUnlock(&typeListMutex);
+	if (matchPtr == NULL) {
+	badManyType:
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "unknown or ambiguous item type \"%s\"", arg));
+	    Tcl_SetErrorCode(interp, "TK", "LOOKUP", "CANVAS_ITEM_TYPE", arg,
+		    NULL);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	typePtr = matchPtr;
+	if (Tcl_ListObjGetElements(interp, objv[3], &numCoords,
+		&coordObjs) != TCL_OK) {
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	numOpts = 0;
+	optObjs = NULL;
+	if ((objc == 5) && (Tcl_ListObjGetElements(interp, objv[4], &numOpts,
+		&optObjs) != TCL_OK)) {
+	    result = TCL_ERROR;
+	    goto done;
+	}
+
+	/*
+	 * Each item is created with the same argument vector: its coordinate
+	 * list in slot 0 followed by the shared options, so the option
+	 * objects (and the values their internal representations cache) are
+	 * reused across the whole batch.
+	 */
+
+	args = (Tcl_Obj **)ckalloc((1 + numOpts) * sizeof(Tcl_Obj *));
+	if (numOpts > 0) {
+	    memcpy(args + 1, optObjs, numOpts * sizeof(Tcl_Obj *));
+	}
+	tailPtr = canvasPtr->lastItemPtr;
+	idListObj = Tcl_NewListObj(numCoords, NULL);
+	Tcl_IncrRefCount(idListObj);
+	for (k = 0; k < numCoords; k++) {
+	    newPtr = (Tk_Item *)TkCanvasPoolAlloc((Tk_Canvas) canvasPtr,
+		    typePtr->itemSize);
+	    newPtr->id = canvasPtr->nextId++;
+	    newPtr->tagPtr = newPtr->staticTagSpace;
+	    newPtr->tagSpace = TK_TAG_SPACE;
+	    newPtr->numTags = 0;
+	    newPtr->typePtr = typePtr;
+	    newPtr->state = TK_STATE_NULL;
+	    newPtr->redraw_flags = 0;
+	    args[0] = coordObjs[k];
+	    if (typePtr->createProc(interp, (Tk_Canvas) canvasPtr, newPtr,
+		    1 + numOpts, args) != TCL_OK) {
+		TkCanvasPoolFree((Tk_Canvas) canvasPtr, newPtr);
+
+		/*
+		 * Unwind the items created so far (they are contiguous at
+		 * the tail of the display list), so a failed batch leaves
+		 * the canvas as it was.
+		 */
+
+		while (canvasPtr->lastItemPtr != tailPtr) {
+		    itemPtr = canvasPtr->lastItemPtr;
+		    EventuallyRedrawItem(canvasPtr, itemPtr);
+		    ItemDelete(canvasPtr, itemPtr);
+		    if (itemPtr->tagPtr != itemPtr->staticTagSpace) {
+			ckfree(itemPtr->tagPtr);
+		    }
+		    entryPtr = Tcl_FindHashEntry(&canvasPtr->idTable,
+			    INT2PTR(itemPtr->id));
+		    Tcl_DeleteHashEntry(entryPtr);
+		    CanvasUnindexItem(canvasPtr, itemPtr);
+		    canvasPtr->lastItemPtr = itemPtr->prevPtr;
+		    if (itemPtr->prevPtr != NULL) {
+			itemPtr->prevPtr->nextPtr = NULL;
+		    } else {
+			canvasPtr->firstItemPtr = NULL;
+		    }
+		    TkCanvasPoolFree((Tk_Canvas) canvasPtr, itemPtr);
+		}
+		canvasPtr->hotPtr = NULL;
+		canvasPtr->hotPrevPtr = NULL;
+		canvasPtr->tagIndexEpoch++;
+		Tcl_DecrRefCount(idListObj);
+		ckfree(args);
+		result = TCL_ERROR;
+		goto done;
+	    }
+	    newPtr->nextPtr = NULL;
+	    entryPtr = Tcl_CreateHashEntry(&canvasPtr->idTable,
+		    INT2PTR(newPtr->id), &isNew);
+	    Tcl_SetHashValue(entryPtr, newPtr);
+	    newPtr->prevPtr = canvasPtr->lastItemPtr;
+	    if (canvasPtr->lastItemPtr == NULL) {
+		canvasPtr->firstItemPtr = newPtr;
+	    } else {
+		canvasPtr->lastItemPtr->nextPtr = newPtr;
+	    }
+	    canvasPtr->lastItemPtr = newPtr;
+	    newPtr->redraw_flags |= FORCE_REDRAW;
+	    EventuallyRedrawItem(canvasPtr, newPtr);
+	    Tcl_ListObjAppendElement(NULL, idListObj,
+		    Tcl_NewWideIntObj(newPtr->id));
+	}
+	ckfree(args);
+	canvasPtr->hotPtr = canvasPtr->lastItemPtr;
+	canvasPtr->hotPrevPtr = (canvasPtr->hotPtr != NULL)
+		? canvasPtr->hotPtr->prevPtr : NULL;
+	canvasPtr->flags |= REPICK_NEEDED;
+	canvasPtr->tagIndexEpoch++;
+	Tcl_SetObjResult(interp, idListObj);
+	Tcl_DecrRefCount(idListObj);
+	break;
+    }
     case CANV_DCHARS: {
 	Tcl_Size first, last;
 	int x1, x2, y1, y2;
@@ -1364,6 +2582,17 @@ CanvasWidgetCmd(
 		entryPtr = Tcl_FindHashEntry(&canvasPtr->idTable,
 			INT2PTR(itemPtr->id));
 		Tcl_DeleteHashEntry(entryPtr);
+		CanvasUnindexItem(canvasPtr, itemPtr);
+		canvasPtr->tagIndexEpoch++;
+		if (canvasPtr->numLayerItems > 0) {
+		    entryPtr = Tcl_FindHashEntry(&canvasPtr->layerTable,
+			    (char *) itemPtr);
+		    if (entryPtr != NULL) {
+			Tcl_DeleteHashEntry(entryPtr);
+			canvasPtr->numLayerItems--;
+			canvasPtr->layerValid = 0;
+		    }
+		}
 		if (itemPtr->nextPtr != NULL) {
 		    itemPtr->nextPtr->prevPtr = itemPtr->prevPtr;
 		}
@@ -1379,7 +2608,7 @@ CanvasWidgetCmd(
 		if (canvasPtr->lastItemPtr == itemPtr) {
 		    canvasPtr->lastItemPtr = itemPtr->prevPtr;
 		}
-		ckfree(itemPtr);
+		TkCanvasPoolFree((Tk_Canvas) canvasPtr, itemPtr);
 		if (itemPtr == canvasPtr->currentItemPtr) {
 		    canvasPtr->currentItemPtr = NULL;
 		    canvasPtr->flags |= REPICK_NEEDED;
@@ -1402,6 +2631,252 @@ CanvasWidgetCmd(
 	}
 	break;
     }
+    case CANV_DESERIALIZE: {
+	Tk_ItemType *typePtr = NULL;
+	Tcl_HashEntry *entryPtr;
+	Tk_Item *tailPtr, *newPtr;
+	Tcl_Obj **args, **coordElems, *idListObj;
+	const unsigned char *p, *end, *block;
+	Tcl_Size length, maxArgs, maxCoords, numArgs = 0;
+	unsigned int mark, version, numItems, numCoords, numOpts, k, j;
+	unsigned char nameLen;
+	char typeName[256];
+	double coord;
+	int isNew = 0;
+
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "data");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	p = Tcl_GetByteArrayFromObj(objv[2], &length);
+	end = p + length;
+	if ((length < 16) || (memcmp(p, CANVAS_SERIAL_MAGIC, 4) != 0)) {
+	    goto badSerialData;
+	}
+	p += 4;
+	SerialGetUint(&p, end, &mark);
+	SerialGetUint(&p, end, &version);
+	SerialGetUint(&p, end, &numItems);
+	if (mark != CANVAS_SERIAL_MARK) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "canvas data was serialized with a different byte order",
+		    TCL_INDEX_NONE));
+	    Tcl_SetErrorCode(interp, "TK", "CANVAS", "SERIAL", "BYTEORDER",
+		    (char *)NULL);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if (version != CANVAS_SERIAL_VERSION) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "unsupported canvas serialization version %u", version));
+	    Tcl_SetErrorCode(interp, "TK", "CANVAS", "SERIAL", "VERSION",
+		    (char *)NULL);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+
+	maxArgs = 8;
+	args = (Tcl_Obj **)ckalloc(maxArgs * sizeof(Tcl_Obj *));
+	maxCoords = 32;
+	coordElems = (Tcl_Obj **)ckalloc(maxCoords * sizeof(Tcl_Obj *));
+	tailPtr = canvasPtr->lastItemPtr;
+	idListObj = Tcl_NewListObj(numItems, NULL);
+	Tcl_IncrRefCount(idListObj);
+
+	for (k = 0; k < numItems; k++) {
+	    /*
+	     * Type name; consecutive items of the same type (the common case
+	     * in a serialized scene) reuse the previous lookup.
+	     */
+
+	    if (!SerialGetBlock(&p, end, 1, &block)) {
+		goto corruptSerial;
+	    }
+	    nameLen = block[0];
+	    if (!SerialGetBlock(&p, end, nameLen, &block)) {
+		goto corruptSerial;
+	    }
+	    if ((typePtr == NULL) || (strlen(typePtr->name) != nameLen)
+		    || (memcmp(typePtr->name, block, nameLen) != 0)) {
+		Tk_ItemType *tp;
+
+		memcpy(typeName, block, nameLen);
+		typeName[nameLen] = '\0';
+		typePtr = NULL;
+		Tcl_MutexLock(&typeListMutex);
+		for (tp = typeList; tp != NULL; tp = tp->nextPtr) {
+		    if (strcmp(tp->name, typeName) == 0) {
+			typePtr = tp;
+			break;
+		    }
+		}
+		Tcl_MutexUnlock(&typeListMutex);
+		if (typePtr == NULL) {
+		    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+			    "unknown item type \"%s\" in canvas"
+			    " serialization", typeName));
+		    Tcl_SetErrorCode(interp, "TK", "LOOKUP",
+			    "CANVAS_ITEM_TYPE", typeName, (char *)NULL);
+		    goto unwindSerial;
+		}
+	    }
+
+	    /*
+	     * Coordinates, then the option name/value pairs, assembled into
+	     * the same argument vector shape that "create" passes to the
+	     * type's createProc: the coordinate list in slot 0 followed by
+	     * the option words.
+	     */
+
+	    if (!SerialGetUint(&p, end, &numCoords)
+		    || (numCoords > (unsigned int)
+			((end - p) / (int) sizeof(double)))
+		    || !SerialGetBlock(&p, end, numCoords * sizeof(double),
+			&block)) {
+		goto corruptSerial;
+	    }
+	    if ((Tcl_Size) numCoords > maxCoords) {
+		maxCoords = (Tcl_Size) numCoords;
+		coordElems = (Tcl_Obj **)ckrealloc(coordElems,
+			maxCoords * sizeof(Tcl_Obj *));
+	    }
+	    for (j = 0; j < numCoords; j++) {
+		memcpy(&coord, block + j * sizeof(double), sizeof(double));
+		coordElems[j] = Tcl_NewDoubleObj(coord);
+	    }
+	    args[0] = Tcl_NewListObj((Tcl_Size) numCoords, coordElems);
+	    Tcl_IncrRefCount(args[0]);
+	    numArgs = 1;
+
+	    if (!SerialGetUint(&p, end, &numOpts)
+		    || (numOpts > (unsigned int) ((end - p) / 5))) {
+		goto corruptSerial;
+	    }
+	    if ((Tcl_Size) (1 + 2*numOpts) > maxArgs) {
+		maxArgs = 1 + 2*numOpts;
+		args = (Tcl_Obj **)ckrealloc(args,
+			maxArgs * sizeof(Tcl_Obj *));
+	    }
+	    for (j = 0; j < numOpts; j++) {
+		unsigned int vLen;
+
+		if (!SerialGetBlock(&p, end, 1, &block)) {
+		    goto corruptSerial;
+		}
+		nameLen = block[0];
+		if (!SerialGetBlock(&p, end, nameLen, &block)) {
+		    goto corruptSerial;
+		}
+		args[numArgs] = Tcl_NewStringObj((const char *) block,
+			nameLen);
+		Tcl_IncrRefCount(args[numArgs]);
+		numArgs++;
+		if (!SerialGetUint(&p, end, &vLen)
+			|| !SerialGetBlock(&p, end, vLen, &block)) {
+		    goto corruptSerial;
+		}
+		args[numArgs] = Tcl_NewStringObj((const char *) block, vLen);
+		Tcl_IncrRefCount(args[numArgs]);
+		numArgs++;
+	    }
+
+	    newPtr = (Tk_Item *)TkCanvasPoolAlloc((Tk_Canvas) canvasPtr,
+		    typePtr->itemSize);
+	    newPtr->id = canvasPtr->nextId++;
+	    newPtr->tagPtr = newPtr->staticTagSpace;
+	    newPtr->tagSpace = TK_TAG_SPACE;
+	    newPtr->numTags = 0;
+	    newPtr->typePtr = typePtr;
+	    newPtr->state = TK_STATE_NULL;
+	    newPtr->redraw_flags = 0;
+	    if (typePtr->createProc(interp, (Tk_Canvas) canvasPtr, newPtr,
+		    numArgs, args) != TCL_OK) {
+		TkCanvasPoolFree((Tk_Canvas) canvasPtr, newPtr);
+		goto unwindSerial;
+	    }
+	    while (numArgs > 0) {
+		Tcl_DecrRefCount(args[--numArgs]);
+	    }
+	    newPtr->nextPtr = NULL;
+	    entryPtr = Tcl_CreateHashEntry(&canvasPtr->idTable,
+		    INT2PTR(newPtr->id), &isNew);
+	    Tcl_SetHashValue(entryPtr, newPtr);
+	    newPtr->prevPtr = canvasPtr->lastItemPtr;
+	    if (canvasPtr->lastItemPtr == NULL) {
+		canvasPtr->firstItemPtr = newPtr;
+	    } else {
+		canvasPtr->lastItemPtr->nextPtr = newPtr;
+	    }
+	    canvasPtr->lastItemPtr = newPtr;
+	    newPtr->redraw_flags |= FORCE_REDRAW;
+	    EventuallyRedrawItem(canvasPtr, newPtr);
+	    Tcl_ListObjAppendElement(NULL, idListObj,
+		    Tcl_NewWideIntObj(newPtr->id));
+	}
+	ckfree(args);
+	ckfree(coordElems);
+	canvasPtr->hotPtr = canvasPtr->lastItemPtr;
+	canvasPtr->hotPrevPtr = (canvasPtr->hotPtr != NULL)
+		? canvasPtr->hotPtr->prevPtr : NULL;
+	canvasPtr->flags |= REPICK_NEEDED;
+	canvasPtr->tagIndexEpoch++;
+	Tcl_SetObjResult(interp, idListObj);
+	Tcl_DecrRefCount(idListObj);
+	break;
+
+    corruptSerial:
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		"malformed canvas serialization", TCL_INDEX_NONE));
+	Tcl_SetErrorCode(interp, "TK", "CANVAS", "SERIAL", "DATA",
+		(char *)NULL);
+
+	/*
+	 * Unwind the items created so far (they are contiguous at the tail
+	 * of the display list), so a failed restore leaves the canvas as it
+	 * was.
+	 */
+
+    unwindSerial:
+	while (numArgs > 0) {
+	    Tcl_DecrRefCount(args[--numArgs]);
+	}
+	while (canvasPtr->lastItemPtr != tailPtr) {
+	    itemPtr = canvasPtr->lastItemPtr;
+	    EventuallyRedrawItem(canvasPtr, itemPtr);
+	    ItemDelete(canvasPtr, itemPtr);
+	    if (itemPtr->tagPtr != itemPtr->staticTagSpace) {
+		ckfree(itemPtr->tagPtr);
+	    }
+	    entryPtr = Tcl_FindHashEntry(&canvasPtr->idTable,
+		    INT2PTR(itemPtr->id));
+	    Tcl_DeleteHashEntry(entryPtr);
+	    CanvasUnindexItem(canvasPtr, itemPtr);
+	    canvasPtr->lastItemPtr = itemPtr->prevPtr;
+	    if (itemPtr->prevPtr != NULL) {
+		itemPtr->prevPtr->nextPtr = NULL;
+	    } else {
+		canvasPtr->firstItemPtr = NULL;
+	    }
+	    TkCanvasPoolFree((Tk_Canvas) canvasPtr, itemPtr);
+	}
+	canvasPtr->hotPtr = NULL;
+	canvasPtr->hotPrevPtr = NULL;
+	canvasPtr->tagIndexEpoch++;
+	Tcl_DecrRefCount(idListObj);
+	ckfree(args);
+	ckfree(coordElems);
+	result = TCL_ERROR;
+	goto done;
+
+    badSerialData:
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		"malformed canvas serialization", TCL_INDEX_NONE));
+	Tcl_SetErrorCode(interp, "TK", "CANVAS", "SERIAL", "DATA",
+		(char *)NULL);
+	result = TCL_ERROR;
+	goto done;
+    }
     case CANV_DTAG: {
 	Tk_Uid tag;
 	Tcl_Size i;
@@ -1428,6 +2903,7 @@ CanvasWidgetCmd(
                             itemPtr->tagPtr + i + 1,
                             (itemPtr->numTags - (i+1)) * sizeof(Tk_Uid));
 		    itemPtr->numTags--;
+		    canvasPtr->tagIndexEpoch++;
 
                     /*
                      * There must be no break here: all tags with the same name must
@@ -1617,12 +3093,74 @@ CanvasWidgetCmd(
 		result = ItemConfigure(canvasPtr, itemPtr, objc-3, objv+3);
 		EventuallyRedrawItem(canvasPtr, itemPtr);
 		canvasPtr->flags |= REPICK_NEEDED;
+		canvasPtr->tagIndexEpoch++;
 	    }
 	    if ((result != TCL_OK) || (objc < 5)) {
 		break;
 	    }
 	}
 	break;
+    case CANV_LAYER: {
+	int layer, isNew;
+	Tcl_HashEntry *entryPtr;
+
+	if ((objc != 3) && (objc != 4)) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "tagOrId ?layer?");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if (objc == 3) {
+	    FIRST_CANVAS_ITEM_MATCHING(objv[2], &searchPtr, goto done);
+	    if (itemPtr != NULL) {
+		Tcl_SetObjResult(interp, Tcl_NewWideIntObj(
+			CanvasItemLayer(canvasPtr, itemPtr)));
+	    }
+	    break;
+	}
+	if (Tcl_GetIntFromObj(interp, objv[3], &layer) != TCL_OK) {
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if ((layer < 0) || (layer >= TK_CANVAS_MAX_LAYERS)) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "bad layer %d: must be between 0 and %d",
+		    layer, TK_CANVAS_MAX_LAYERS - 1));
+	    Tcl_SetErrorCode(interp, "TK", "CANVAS", "LAYER", (char *)NULL);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	FOR_EVERY_CANVAS_ITEM_MATCHING(objv[2], &searchPtr, goto done) {
+	    /*
+	     * Window items must be drawn live (their display proc maps and
+	     * unmaps the subwindow), so they always stay on layer 0.
+	     */
+
+	    if (AlwaysRedraw(itemPtr) && (layer != 0)) {
+		continue;
+	    }
+	    if (CanvasItemLayer(canvasPtr, itemPtr) == layer) {
+		continue;
+	    }
+	    if (layer == 0) {
+		entryPtr = Tcl_FindHashEntry(&canvasPtr->layerTable,
+			(char *) itemPtr);
+		if (entryPtr != NULL) {
+		    Tcl_DeleteHashEntry(entryPtr);
+		    canvasPtr->numLayerItems--;
+		}
+	    } else {
+		entryPtr = Tcl_CreateHashEntry(&canvasPtr->layerTable,
+			(char *) itemPtr, &isNew);
+		if (isNew) {
+		    canvasPtr->numLayerItems++;
+		}
+		Tcl_SetHashValue(entryPtr, INT2PTR(layer));
+	    }
+	    canvasPtr->layerValid = 0;
+	    EventuallyRedrawItem(canvasPtr, itemPtr);
+	}
+	break;
+    }
     case CANV_LOWER: {
 
 	if ((objc != 3) && (objc != 4)) {
@@ -2018,6 +3556,146 @@ CanvasWidgetCmd(
 	}
 	break;
     }
+    case CANV_SERIALIZE: {
+	Tcl_DString buf;
+	const Tk_ConfigSpec *specPtr;
+	Tcl_Obj **coordv;
+	Tcl_Size coordc, j, valueLen, countOffset, optCountOffset;
+	unsigned int numItems = 0, numOpts;
+	unsigned char byte;
+	double coord;
+	const char *value, *defValue;
+
+	if (objc != 2) {
+	    Tcl_WrongNumArgs(interp, 2, objv, NULL);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	Tcl_DStringInit(&buf);
+	Tcl_DStringAppend(&buf, CANVAS_SERIAL_MAGIC, 4);
+	SerialPutUint(&buf, CANVAS_SERIAL_MARK);
+	SerialPutUint(&buf, CANVAS_SERIAL_VERSION);
+	countOffset = Tcl_DStringLength(&buf);
+	SerialPutUint(&buf, 0);
+
+	for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
+		itemPtr = itemPtr->nextPtr) {
+	    byte = (unsigned char) strlen(itemPtr->typePtr->name);
+	    Tcl_DStringAppend(&buf, (char *) &byte, 1);
+	    Tcl_DStringAppend(&buf, itemPtr->typePtr->name, byte);
+
+	    /*
+	     * Coordinates, written as raw doubles.
+	     */
+
+	    Tcl_ResetResult(interp);
+	    if ((ItemCoords(canvasPtr, itemPtr, 0, NULL) != TCL_OK)
+		    || (Tcl_ListObjGetElements(interp,
+			Tcl_GetObjResult(interp), &coordc,
+			&coordv) != TCL_OK)) {
+		Tcl_DStringFree(&buf);
+		result = TCL_ERROR;
+		goto done;
+	    }
+	    SerialPutUint(&buf, (unsigned int) coordc);
+	    for (j = 0; j < coordc; j++) {
+		if (Tcl_GetDoubleFromObj(interp, coordv[j],
+			&coord) != TCL_OK) {
+		    Tcl_DStringFree(&buf);
+		    result = TCL_ERROR;
+		    goto done;
+		}
+		Tcl_DStringAppend(&buf, (char *) &coord, sizeof(double));
+	    }
+	    Tcl_ResetResult(interp);
+
+	    /*
+	     * Options whose current value differs from the default, written
+	     * as name/value string pairs.
+	     */
+
+	    optCountOffset = Tcl_DStringLength(&buf);
+	    SerialPutUint(&buf, 0);
+	    numOpts = 0;
+	    for (specPtr = itemPtr->typePtr->configSpecs;
+		    specPtr->type != TK_CONFIG_END; specPtr++) {
+		if (specPtr->type == TK_CONFIG_SYNONYM) {
+		    continue;
+		}
+		if (Tk_ConfigureValue(interp, canvasPtr->tkwin,
+			itemPtr->typePtr->configSpecs, itemPtr,
+			specPtr->argvName, 0) != TCL_OK) {
+		    Tcl_DStringFree(&buf);
+		    result = TCL_ERROR;
+		    goto done;
+		}
+		value = Tcl_GetStringFromObj(Tcl_GetObjResult(interp),
+			&valueLen);
+		defValue = (specPtr->defValue != NULL)
+			? specPtr->defValue : "";
+		if (strcmp(value, defValue) != 0) {
+		    byte = (unsigned char) strlen(specPtr->argvName);
+		    Tcl_DStringAppend(&buf, (char *) &byte, 1);
+		    Tcl_DStringAppend(&buf, specPtr->argvName, byte);
+		    SerialPutUint(&buf, (unsigned int) valueLen);
+		    Tcl_DStringAppend(&buf, value, valueLen);
+		    numOpts++;
+		}
+		Tcl_ResetResult(interp);
+	    }
+	    memcpy(Tcl_DStringValue(&buf) + optCountOffset, &numOpts,
+		    sizeof(unsigned int));
+	    numItems++;
+	}
+	memcpy(Tcl_DStringValue(&buf) + countOffset, &numItems,
+		sizeof(unsigned int));
+	Tcl_SetObjResult(interp, Tcl_NewByteArrayObj(
+		(unsigned char *) Tcl_DStringValue(&buf),
+		Tcl_DStringLength(&buf)));
+	Tcl_DStringFree(&buf);
+	break;
+    }
+    case CANV_TRANSFORM: {
+	double m[6];
+	int i;
+
+	if (objc != 9) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "tagOrId a b c d tx ty");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	for (i = 0; i < 6; i++) {
+	    if (Tcl_GetDoubleFromObj(interp, objv[3+i], &m[i]) != TCL_OK) {
+		result = TCL_ERROR;
+		goto done;
+	    }
+	}
+	if ((m[0]*m[3] - m[1]*m[2]) == 0.0) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "transform matrix cannot be singular", TCL_INDEX_NONE));
+	    Tcl_SetErrorCode(interp, "TK", "CANVAS", "BAD_TRANSFORM", NULL);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	FOR_EVERY_CANVAS_ITEM_MATCHING(objv[2], &searchPtr, goto done) {
+	    EventuallyRedrawItem(canvasPtr, itemPtr);
+	    if ((m[0] == 1.0) && (m[1] == 0.0)
+		    && (m[2] == 0.0) && (m[3] == 1.0)) {
+		/*
+		 * A pure translation; route it through the item's native
+		 * translateProc, which is much cheaper than rewriting the
+		 * coordinate list.
+		 */
+
+		ItemTranslate(canvasPtr, itemPtr, m[4], m[5]);
+	    } else {
+		ItemAffineTransform(canvasPtr, itemPtr, m);
+	    }
+	    EventuallyRedrawItem(canvasPtr, itemPtr);
+	    canvasPtr->flags |= REPICK_NEEDED;
+	}
+	break;
+    }
     case CANV_TYPE:
 	if (objc != 3) {
 	    Tcl_WrongNumArgs(interp, 2, objv, "tag");
@@ -2200,7 +3878,7 @@ DestroyCanvas(
 	if (itemPtr->tagPtr != itemPtr->staticTagSpace) {
 	    ckfree(itemPtr->tagPtr);
 	}
-	ckfree(itemPtr);
+	TkCanvasPoolFree((Tk_Canvas) canvasPtr, itemPtr);
     }
 
     /*
@@ -2209,9 +3887,19 @@ DestroyCanvas(
      */
 
     Tcl_DeleteHashTable(&canvasPtr->idTable);
+    CanvasIndexFree(canvasPtr);
+    CanvasTagIndexFree(canvasPtr);
+    Tcl_DeleteHashTable(&canvasPtr->layerTable);
+    if (canvasPtr->layerPixmap != None) {
+	Tk_FreePixmap(canvasPtr->display, canvasPtr->layerPixmap);
+    }
+    TkCanvasPoolDrain(canvasPtr);
     if (canvasPtr->pixmapGC != NULL) {
 	Tk_FreeGC(canvasPtr->display, canvasPtr->pixmapGC);
     }
+    if (canvasPtr->lodGC != NULL) {
+	Tk_FreeGC(canvasPtr->display, canvasPtr->lodGC);
+    }
     expr = canvasPtr->bindTagExprs;
     while (expr) {
 	next = expr->next;
@@ -2288,6 +3976,14 @@ ConfigureCanvas(
     }
     canvasPtr->pixmapGC = newGC;
 
+    gcValues.foreground = canvasPtr->lodColor->pixel;
+    newGC = Tk_GetGC(canvasPtr->tkwin,
+	    GCFunction|GCGraphicsExposures|GCForeground, &gcValues);
+    if (canvasPtr->lodGC != NULL) {
+	Tk_FreeGC(canvasPtr->display, canvasPtr->lodGC);
+    }
+    canvasPtr->lodGC = newGC;
+
     /*
      * Reconfigure items to reflect changed state disabled/normal.
      */
@@ -2964,7 +4660,98 @@ done:
         XFreeGC(displayPtr,xgc);
     return result;
 }
-
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasLayerRender --
+ *
+ *	Bring the retained layer pixmap up to date with the items assigned to
+ *	layers 1 and up, covering the part of the canvas that is visible in
+ *	the window. Does nothing if the cache is already current.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	canvasPtr->layerPixmap may be (re)allocated and redrawn.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+CanvasLayerRender(
+    TkCanvas *canvasPtr)	/* Canvas whose layer cache is wanted. */
+{
+    Tk_Window tkwin = canvasPtr->tkwin;
+    Tk_Item *itemPtr;
+    TkCanvasIndexItem **recs;
+    int numRecs, i, layer, saveXOrigin, saveYOrigin;
+    int x1 = canvasPtr->xOrigin + canvasPtr->inset;
+    int y1 = canvasPtr->yOrigin + canvasPtr->inset;
+    int x2 = canvasPtr->xOrigin + Tk_Width(tkwin) - canvasPtr->inset;
+    int y2 = canvasPtr->yOrigin + Tk_Height(tkwin) - canvasPtr->inset;
+    int width = x2 - x1;
+    int height = y2 - y1;
+
+    if ((width <= 0) || (height <= 0)) {
+	return;
+    }
+    if (canvasPtr->layerValid && (canvasPtr->layerPixmap != None)
+	    && (canvasPtr->layerXOrigin == x1)
+	    && (canvasPtr->layerYOrigin == y1)
+	    && (canvasPtr->layerWidth == width)
+	    && (canvasPtr->layerHeight == height)) {
+	return;
+    }
+    if ((canvasPtr->layerPixmap != None)
+	    && ((canvasPtr->layerWidth != width)
+	    || (canvasPtr->layerHeight != height))) {
+	Tk_FreePixmap(Tk_Display(tkwin), canvasPtr->layerPixmap);
+	canvasPtr->layerPixmap = None;
+    }
+    if (canvasPtr->layerPixmap == None) {
+	canvasPtr->layerPixmap = Tk_GetPixmap(Tk_Display(tkwin),
+		Tk_WindowId(tkwin), width, height, Tk_Depth(tkwin));
+    }
+    canvasPtr->layerXOrigin = x1;
+    canvasPtr->layerYOrigin = y1;
+    canvasPtr->layerWidth = width;
+    canvasPtr->layerHeight = height;
+
+    /*
+     * Items draw relative to drawableXOrigin/drawableYOrigin, so point those
+     * at the cache while rendering it.
+     */
+
+    saveXOrigin = canvasPtr->drawableXOrigin;
+    saveYOrigin = canvasPtr->drawableYOrigin;
+    canvasPtr->drawableXOrigin = x1;
+    canvasPtr->drawableYOrigin = y1;
+    XFillRectangle(Tk_Display(tkwin), canvasPtr->layerPixmap,
+	    canvasPtr->pixmapGC, 0, 0, (unsigned) width, (unsigned) height);
+    numRecs = CanvasIndexQuery(canvasPtr, x1, y1, x2, y2, &recs);
+    for (layer = 1; layer < TK_CANVAS_MAX_LAYERS; layer++) {
+	for (i = 0; i < numRecs; i++) {
+	    itemPtr = recs[i]->itemPtr;
+	    if (CanvasItemLayer(canvasPtr, itemPtr) != layer) {
+		continue;
+	    }
+	    if (itemPtr->state == TK_STATE_HIDDEN ||
+		    (itemPtr->state == TK_STATE_NULL &&
+		    canvasPtr->canvas_state == TK_STATE_HIDDEN)) {
+		continue;
+	    }
+	    ItemDisplay(canvasPtr, itemPtr, canvasPtr->layerPixmap,
+		    x1, y1, width, height);
+	}
+    }
+    ckfree(recs);
+    canvasPtr->drawableXOrigin = saveXOrigin;
+    canvasPtr->drawableYOrigin = saveYOrigin;
+    canvasPtr->layerValid = 1;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -2990,8 +4777,13 @@ DisplayCanvas(
     TkCanvas *canvasPtr = (TkCanvas *)clientData;
     Tk_Window tkwin = canvasPtr->tkwin;
     Tk_Item *itemPtr;
+    TkCanvasIndexItem **recs;
     Pixmap pixmap;
+    XPoint *lodPoints = NULL;
+    int numLodPoints = 0, maxLodPoints = 0;
     int screenX1, screenX2, screenY1, screenY2, width, height;
+    int numRecs, i, recordPaint;
+    Tcl_Time paintStart;
 #ifdef MAC_OSX_TK
     TkWindow *winPtr;
     MacDrawable *macWin;
@@ -3001,7 +4793,7 @@ DisplayCanvas(
 	return;
     }
 
-    if (!Tk_IsMapped(tkwin)) {
+    if (!Tk_IsMapped(tkwin) || TkWindowObscured((TkWindow *) tkwin)) {
 	goto done;
     }
 
@@ -3049,143 +4841,250 @@ DisplayCanvas(
 	}
     }
 
+    recordPaint = TkPaintRecording();
+    if (recordPaint) {
+	Tcl_GetTime(&paintStart);
+    }
+
     /*
-     * Compute the intersection between the area that needs redrawing and the
-     * area that's visible on the screen.
+     * Repaint each accumulated damage rectangle that is visible on the
+     * screen. Keeping the damaged areas as separate rectangles (rather than
+     * one all-encompassing bounding box) means that two small dirty spots at
+     * opposite corners of the window only cost two small repaints instead of
+     * a full-window one.
      */
 
     if ((canvasPtr->redrawX1 < canvasPtr->redrawX2)
 	    && (canvasPtr->redrawY1 < canvasPtr->redrawY2)) {
-	screenX1 = canvasPtr->xOrigin + canvasPtr->inset;
-	screenY1 = canvasPtr->yOrigin + canvasPtr->inset;
-	screenX2 = canvasPtr->xOrigin + Tk_Width(tkwin) - canvasPtr->inset;
-	screenY2 = canvasPtr->yOrigin + Tk_Height(tkwin) - canvasPtr->inset;
-	if (canvasPtr->redrawX1 > screenX1) {
-	    screenX1 = canvasPtr->redrawX1;
-	}
-	if (canvasPtr->redrawY1 > screenY1) {
-	    screenY1 = canvasPtr->redrawY1;
-	}
-	if (canvasPtr->redrawX2 < screenX2) {
-	    screenX2 = canvasPtr->redrawX2;
-	}
-	if (canvasPtr->redrawY2 < screenY2) {
-	    screenY2 = canvasPtr->redrawY2;
-	}
-	if ((screenX1 >= screenX2) || (screenY1 >= screenY2)) {
-	    goto borders;
-	}
+	int rectIdx;
+
+	for (rectIdx = 0; rectIdx < canvasPtr->numDamage; rectIdx++) {
+
+	    /*
+	     * Compute the intersection between this damaged area and the
+	     * area that's visible on the screen.
+	     */
+
+	    screenX1 = canvasPtr->xOrigin + canvasPtr->inset;
+	    screenY1 = canvasPtr->yOrigin + canvasPtr->inset;
+	    screenX2 = canvasPtr->xOrigin + Tk_Width(tkwin)
+		    - canvasPtr->inset;
+	    screenY2 = canvasPtr->yOrigin + Tk_Height(tkwin)
+		    - canvasPtr->inset;
+	    if (canvasPtr->damage[rectIdx].x1 > screenX1) {
+		screenX1 = canvasPtr->damage[rectIdx].x1;
+	    }
+	    if (canvasPtr->damage[rectIdx].y1 > screenY1) {
+		screenY1 = canvasPtr->damage[rectIdx].y1;
+	    }
+	    if (canvasPtr->damage[rectIdx].x2 < screenX2) {
+		screenX2 = canvasPtr->damage[rectIdx].x2;
+	    }
+	    if (canvasPtr->damage[rectIdx].y2 < screenY2) {
+		screenY2 = canvasPtr->damage[rectIdx].y2;
+	    }
+	    if ((screenX1 >= screenX2) || (screenY1 >= screenY2)) {
+		continue;
+	    }
 
-	width = screenX2 - screenX1;
-	height = screenY2 - screenY1;
+	    width = screenX2 - screenX1;
+	    height = screenY2 - screenY1;
 
 #ifndef TK_NO_DOUBLE_BUFFERING
-	/*
-	 * Redrawing is done in a temporary pixmap that is allocated here and
-	 * freed at the end of the function. All drawing is done to the
-	 * pixmap, and the pixmap is copied to the screen at the end of the
-	 * function. The temporary pixmap serves two purposes:
-	 *
-	 * 1. It provides a smoother visual effect (no clearing and gradual
-	 *    redraw will be visible to users).
-	 * 2. It allows us to redraw only the objects that overlap the redraw
-	 *    area. Otherwise incorrect results could occur from redrawing
-	 *    things that stick outside of the redraw area (we'd have to
-	 *    redraw everything in order to make the overlaps look right).
-	 *
-	 * Some tricky points about the pixmap:
-	 *
-	 * 1. We only allocate a large enough pixmap to hold the area that has
-	 *    to be redisplayed. This saves time in in the X server for large
-	 *    objects that cover much more than the area being redisplayed:
-	 *    only the area of the pixmap will actually have to be redrawn.
-	 * 2. Some X servers (e.g. the one for DECstations) have troubles with
-	 *    with characters that overlap an edge of the pixmap (on the DEC
-	 *    servers, as of 8/18/92, such characters are drawn one pixel too
-	 *    far to the right). To handle this problem, make the pixmap a bit
-	 *    larger than is absolutely needed so that for normal-sized fonts
-	 *    the characters that overlap the edge of the pixmap will be
-	 *    outside the area we care about.
-	 */
+	    /*
+	     * Redrawing is done in a temporary pixmap that is allocated here
+	     * and freed before moving to the next damaged area. All drawing
+	     * is done to the pixmap, and the pixmap is copied to the screen
+	     * when the area is complete. The temporary pixmap serves two
+	     * purposes:
+	     *
+	     * 1. It provides a smoother visual effect (no clearing and
+	     *    gradual redraw will be visible to users).
+	     * 2. It allows us to redraw only the objects that overlap the
+	     *    redraw area. Otherwise incorrect results could occur from
+	     *    redrawing things that stick outside of the redraw area
+	     *    (we'd have to redraw everything in order to make the
+	     *    overlaps look right).
+	     *
+	     * Some tricky points about the pixmap:
+	     *
+	     * 1. We only allocate a large enough pixmap to hold the area
+	     *    that has to be redisplayed. This saves time in in the X
+	     *    server for large objects that cover much more than the area
+	     *    being redisplayed: only the area of the pixmap will
+	     *    actually have to be redrawn.
+	     * 2. Some X servers (e.g. the one for DECstations) have troubles
+	     *    with characters that overlap an edge of the pixmap (on the
+	     *    DEC servers, as of 8/18/92, such characters are drawn one
+	     *    pixel too far to the right). To handle this problem, make
+	     *    the pixmap a bit larger than is absolutely needed so that
+	     *    for normal-sized fonts the characters that overlap the edge
+	     *    of the pixmap will be outside the area we care about.
+	     */
 
-	canvasPtr->drawableXOrigin = screenX1 - 30;
-	canvasPtr->drawableYOrigin = screenY1 - 30;
-	pixmap = Tk_GetPixmap(Tk_Display(tkwin), Tk_WindowId(tkwin),
-	    (screenX2 + 30 - canvasPtr->drawableXOrigin),
-	    (screenY2 + 30 - canvasPtr->drawableYOrigin),
-	    Tk_Depth(tkwin));
+	    canvasPtr->drawableXOrigin = screenX1 - 30;
+	    canvasPtr->drawableYOrigin = screenY1 - 30;
+	    pixmap = TkGetPaintBuffer(tkwin,
+		(screenX2 + 30 - canvasPtr->drawableXOrigin),
+		(screenY2 + 30 - canvasPtr->drawableYOrigin));
 #else
-	canvasPtr->drawableXOrigin = canvasPtr->xOrigin;
-	canvasPtr->drawableYOrigin = canvasPtr->yOrigin;
-	pixmap = Tk_WindowId(tkwin);
-	Tk_ClipDrawableToRect(Tk_Display(tkwin), pixmap,
-		screenX1 - canvasPtr->xOrigin, screenY1 - canvasPtr->yOrigin,
-		width, height);
+	    canvasPtr->drawableXOrigin = canvasPtr->xOrigin;
+	    canvasPtr->drawableYOrigin = canvasPtr->yOrigin;
+	    pixmap = Tk_WindowId(tkwin);
+	    Tk_ClipDrawableToRect(Tk_Display(tkwin), pixmap,
+		    screenX1 - canvasPtr->xOrigin,
+		    screenY1 - canvasPtr->yOrigin, width, height);
 #endif /* TK_NO_DOUBLE_BUFFERING */
 
-	/*
-	 * Clear the area to be redrawn.
-	 */
+	    /*
+	     * Paint the background of the area: the retained rendering of
+	     * the cached layers when any exist, otherwise a plain
+	     * background fill.
+	     */
 
-	XFillRectangle(Tk_Display(tkwin), pixmap, canvasPtr->pixmapGC,
-		screenX1 - canvasPtr->drawableXOrigin,
-		screenY1 - canvasPtr->drawableYOrigin, (unsigned int) width,
-		(unsigned int) height);
+	    if (canvasPtr->numLayerItems > 0) {
+		CanvasLayerRender(canvasPtr);
+	    }
+	    if ((canvasPtr->numLayerItems > 0)
+		    && (canvasPtr->layerPixmap != None)) {
+		XCopyArea(Tk_Display(tkwin), canvasPtr->layerPixmap, pixmap,
+			canvasPtr->pixmapGC,
+			screenX1 - canvasPtr->layerXOrigin,
+			screenY1 - canvasPtr->layerYOrigin,
+			(unsigned int) width, (unsigned int) height,
+			screenX1 - canvasPtr->drawableXOrigin,
+			screenY1 - canvasPtr->drawableYOrigin);
+	    } else {
+		XFillRectangle(Tk_Display(tkwin), pixmap, canvasPtr->pixmapGC,
+			screenX1 - canvasPtr->drawableXOrigin,
+			screenY1 - canvasPtr->drawableYOrigin,
+			(unsigned int) width, (unsigned int) height);
+	    }
 
-	/*
-	 * Scan through the item list, redrawing those items that need it. An
-	 * item must be redraw if either (a) it intersects the smaller
-	 * on-screen area or (b) it intersects the full canvas area and its
-	 * type requests that it be redrawn always (e.g. so subwindows can be
-	 * unmapped when they move off-screen).
-	 */
+	    /*
+	     * Redraw those items that overlap this damaged area, using the
+	     * spatial index to find them.
+	     */
 
-	for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
-		itemPtr = itemPtr->nextPtr) {
-	    if ((itemPtr->x1 >= screenX2)
-		    || (itemPtr->y1 >= screenY2)
-		    || (itemPtr->x2 < screenX1)
-		    || (itemPtr->y2 < screenY1)) {
-		if (!AlwaysRedraw(itemPtr)
-			|| (itemPtr->x1 >= canvasPtr->redrawX2)
-			|| (itemPtr->y1 >= canvasPtr->redrawY2)
-			|| (itemPtr->x2 < canvasPtr->redrawX1)
-			|| (itemPtr->y2 < canvasPtr->redrawY1)) {
+	    numRecs = CanvasIndexQuery(canvasPtr, screenX1, screenY1,
+		    screenX2, screenY2, &recs);
+	    for (i = 0; i < numRecs; i++) {
+		itemPtr = recs[i]->itemPtr;
+		if ((itemPtr->x1 >= screenX2)
+			|| (itemPtr->y1 >= screenY2)
+			|| (itemPtr->x2 < screenX1)
+			|| (itemPtr->y2 < screenY1)) {
+		    continue;
+		}
+		if (itemPtr->state == TK_STATE_HIDDEN ||
+			(itemPtr->state == TK_STATE_NULL &&
+			canvasPtr->canvas_state == TK_STATE_HIDDEN)) {
+		    continue;
+		}
+		if (CanvasItemLayer(canvasPtr, itemPtr) != 0) {
+		    continue;
+		}
+		if ((canvasPtr->lodThreshold > 0)
+			&& CanvasItemCollapsed(canvasPtr, itemPtr)) {
+		    if (numLodPoints >= maxLodPoints) {
+			maxLodPoints = maxLodPoints ? 2*maxLodPoints : 256;
+			lodPoints = (XPoint *)(lodPoints == NULL
+				? ckalloc(maxLodPoints * sizeof(XPoint))
+				: ckrealloc(lodPoints,
+				maxLodPoints * sizeof(XPoint)));
+		    }
+		    lodPoints[numLodPoints].x = (short)
+			    ((itemPtr->x1 + itemPtr->x2) / 2
+			    - canvasPtr->drawableXOrigin);
+		    lodPoints[numLodPoints].y = (short)
+			    ((itemPtr->y1 + itemPtr->y2) / 2
+			    - canvasPtr->drawableYOrigin);
+		    numLodPoints++;
 		    continue;
 		}
+		ItemDisplay(canvasPtr, itemPtr, pixmap, screenX1, screenY1,
+			width, height);
+	    }
+	    ckfree(recs);
+
+	    /*
+	     * Draw all the collapsed items of this damage area as one batch
+	     * of points.
+	     */
+
+	    if (numLodPoints > 0) {
+		XDrawPoints(Tk_Display(tkwin), pixmap, canvasPtr->lodGC,
+			lodPoints, numLodPoints, CoordModeOrigin);
+		numLodPoints = 0;
+	    }
+
+#ifndef TK_NO_DOUBLE_BUFFERING
+	    /*
+	     * Copy from the temporary pixmap to the screen, then release the
+	     * temporary pixmap for reuse.
+	     */
+
+	    XCopyArea(Tk_Display(tkwin), pixmap, Tk_WindowId(tkwin),
+		    canvasPtr->pixmapGC,
+		    screenX1 - canvasPtr->drawableXOrigin,
+		    screenY1 - canvasPtr->drawableYOrigin,
+		    (unsigned int) width, (unsigned int) height,
+		    screenX1 - canvasPtr->xOrigin,
+		    screenY1 - canvasPtr->yOrigin);
+	    TkReleasePaintBuffer(tkwin, pixmap);
+#else
+	    Tk_ClipDrawableToRect(Tk_Display(tkwin), pixmap, 0, 0, -1, -1);
+#endif /* TK_NO_DOUBLE_BUFFERING */
+	}
+
+	/*
+	 * Items whose type requests that they always be redrawn (e.g. window
+	 * items, so subwindows can be unmapped when they move off-screen)
+	 * may have been dirtied in an area that lies entirely off-screen, in
+	 * which case no damage pass above displayed them. Give any such item
+	 * that now lies completely outside the visible window a display call
+	 * with a None drawable, which tells it that it is no longer visible.
+	 */
+
+	numRecs = CanvasIndexQuery(canvasPtr, canvasPtr->redrawX1,
+		canvasPtr->redrawY1, canvasPtr->redrawX2,
+		canvasPtr->redrawY2, &recs);
+	for (i = 0; i < numRecs; i++) {
+	    itemPtr = recs[i]->itemPtr;
+	    if (!AlwaysRedraw(itemPtr)) {
+		continue;
+	    }
+	    if ((itemPtr->x1 < canvasPtr->xOrigin + Tk_Width(tkwin))
+		    && (itemPtr->y1 < canvasPtr->yOrigin + Tk_Height(tkwin))
+		    && (itemPtr->x2 >= canvasPtr->xOrigin)
+		    && (itemPtr->y2 >= canvasPtr->yOrigin)) {
+		continue;
 	    }
 	    if (itemPtr->state == TK_STATE_HIDDEN ||
 		    (itemPtr->state == TK_STATE_NULL &&
 		    canvasPtr->canvas_state == TK_STATE_HIDDEN)) {
 		continue;
 	    }
-	    ItemDisplay(canvasPtr, itemPtr, pixmap, screenX1, screenY1, width,
-		    height);
+	    ItemDisplay(canvasPtr, itemPtr, None, 0, 0, 0, 0);
+	}
+	ckfree(recs);
+	if (lodPoints != NULL) {
+	    ckfree(lodPoints);
 	}
 
-#ifndef TK_NO_DOUBLE_BUFFERING
-	/*
-	 * Copy from the temporary pixmap to the screen, then free up the
-	 * temporary pixmap.
-	 */
-
-	XCopyArea(Tk_Display(tkwin), pixmap, Tk_WindowId(tkwin),
-		canvasPtr->pixmapGC,
-		screenX1 - canvasPtr->drawableXOrigin,
-		screenY1 - canvasPtr->drawableYOrigin,
-		(unsigned int) width, (unsigned int) height,
-		screenX1 - canvasPtr->xOrigin, screenY1 - canvasPtr->yOrigin);
-	Tk_FreePixmap(Tk_Display(tkwin), pixmap);
-#else
-	Tk_ClipDrawableToRect(Tk_Display(tkwin), pixmap, 0, 0, -1, -1);
-#endif /* TK_NO_DOUBLE_BUFFERING */
+	if (recordPaint) {
+	    TkRecordPaint(tkwin, &paintStart,
+		    canvasPtr->redrawX1 - canvasPtr->xOrigin,
+		    canvasPtr->redrawY1 - canvasPtr->yOrigin,
+		    canvasPtr->redrawX2 - canvasPtr->redrawX1,
+		    canvasPtr->redrawY2 - canvasPtr->redrawY1);
+	}
     }
 
     /*
      * Draw the window borders, if needed.
      */
 
-  borders:
     if (canvasPtr->flags & REDRAW_BORDERS) {
 	canvasPtr->flags &= ~REDRAW_BORDERS;
 	if (canvasPtr->borderWidth > 0) {
@@ -3217,6 +5116,7 @@ DisplayCanvas(
     canvasPtr->flags &= ~(REDRAW_PENDING|BBOX_NOT_EMPTY);
     canvasPtr->redrawX1 = canvasPtr->redrawX2 = 0;
     canvasPtr->redrawY1 = canvasPtr->redrawY2 = 0;
+    canvasPtr->numDamage = 0;
     if (canvasPtr->flags & UPDATE_SCROLLBARS) {
 	CanvasUpdateScrollbars(canvasPtr);
     }
@@ -3270,7 +5170,7 @@ CanvasEventProc(
 		    canvasPtr->widgetCmd);
 	}
 	if (canvasPtr->flags & REDRAW_PENDING) {
-	    Tcl_CancelIdleCall(DisplayCanvas, canvasPtr);
+	    TkCancelDoWhenIdle(DisplayCanvas, canvasPtr);
 	}
 	Tcl_EventuallyFree(canvasPtr, DestroyCanvas);
     } else if (eventPtr->type == ConfigureNotify) {
@@ -3387,6 +5287,16 @@ Tk_CanvasEventuallyRedraw(
 	return;
     }
 
+    /*
+     * The caller may be an item type that has just recomputed its bounding
+     * box without going through EventuallyRedrawItem, so the spatial index
+     * can no longer trust its recorded boxes. This must be noted even when
+     * the damage lies off-screen: the box change is real either way, and
+     * "find" queries don't care about visibility.
+     */
+
+    canvasPtr->indexSuspect = 1;
+
     if ((x1 >= x2) || (y1 >= y2) ||
  	    (x2 < canvasPtr->xOrigin) || (y2 < canvasPtr->yOrigin) ||
 	    (x1 >= canvasPtr->xOrigin + Tk_Width(canvasPtr->tkwin)) ||
@@ -3413,12 +5323,165 @@ Tk_CanvasEventuallyRedraw(
 	canvasPtr->redrawY2 = y2;
 	canvasPtr->flags |= BBOX_NOT_EMPTY;
     }
+    CanvasAddDamage(canvasPtr, x1, y1, x2, y2);
     if (!(canvasPtr->flags & REDRAW_PENDING)) {
-	Tcl_DoWhenIdle(DisplayCanvas, canvasPtr);
+	TkDoWhenIdle(DisplayCanvas, canvasPtr, TK_IDLE_DISPLAY);
 	canvasPtr->flags |= REDRAW_PENDING;
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasItemCollapsed --
+ *
+ *	Decide whether an item is small enough to be rendered as a
+ *	level-of-detail point. The decision has hysteresis: an item
+ *	collapses when its bounding box drops below the threshold in both
+ *	dimensions, but only expands again once it exceeds the threshold by
+ *	a quarter, so items hovering at the boundary do not flicker between
+ *	representations.
+ *
+ * Results:
+ *	1 if the item should be drawn as a point, 0 if it should be drawn
+ *	through its type's displayProc.
+ *
+ * Side effects:
+ *	Updates the LOD_COLLAPSED flag on the item.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+CanvasItemCollapsed(
+    TkCanvas *canvasPtr,	/* Canvas being displayed. */
+    Tk_Item *itemPtr)		/* Item to classify. */
+{
+    int threshold = canvasPtr->lodThreshold;
+    int size = itemPtr->x2 - itemPtr->x1;
+
+    /*
+     * Window items must be drawn live (their display proc positions, maps
+     * and unmaps the subwindow), so they never collapse no matter how
+     * small they get; otherwise the stale subwindow would keep floating
+     * over the canvas.
+     */
+
+    if (AlwaysRedraw(itemPtr)) {
+	itemPtr->redraw_flags &= ~LOD_COLLAPSED;
+	return 0;
+    }
+    if (itemPtr->y2 - itemPtr->y1 > size) {
+	size = itemPtr->y2 - itemPtr->y1;
+    }
+    if (itemPtr->redraw_flags & LOD_COLLAPSED) {
+	if (size >= threshold + (threshold + 3) / 4) {
+	    itemPtr->redraw_flags &= ~LOD_COLLAPSED;
+	    return 0;
+	}
+	return 1;
+    }
+    if (size < threshold) {
+	itemPtr->redraw_flags |= LOD_COLLAPSED;
+	return 1;
+    }
+    return 0;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CanvasAddDamage --
+ *
+ *	Add a rectangle to the canvas's damage accumulator. Rectangles that
+ *	overlap or nearly touch an existing damaged area are merged with it;
+ *	when the accumulator is full, the new rectangle is merged with
+ *	whichever existing one grows the least.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The damage list is updated. The caller is responsible for updating
+ *	the redrawX1..redrawY2 union and scheduling the redisplay.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+CanvasAddDamage(
+    TkCanvas *canvasPtr,	/* Information about widget. */
+    int x1, int y1,		/* Upper left corner of damaged area. */
+    int x2, int y2)		/* Lower right corner of damaged area. */
+{
+    int i, best;
+    double growth, bestGrowth;
+
+    /*
+     * Merge with an existing rectangle when the new area overlaps or nearly
+     * touches it; splitting abutting damage into separate display passes
+     * would cost more than it saves.
+     */
+
+    for (i = 0; i < canvasPtr->numDamage; i++) {
+	if ((x1 < canvasPtr->damage[i].x2 + 16)
+		&& (x2 > canvasPtr->damage[i].x1 - 16)
+		&& (y1 < canvasPtr->damage[i].y2 + 16)
+		&& (y2 > canvasPtr->damage[i].y1 - 16)) {
+	    goto merge;
+	}
+    }
+    if (canvasPtr->numDamage < TK_CANVAS_MAX_DAMAGE) {
+	i = canvasPtr->numDamage++;
+	canvasPtr->damage[i].x1 = x1;
+	canvasPtr->damage[i].y1 = y1;
+	canvasPtr->damage[i].x2 = x2;
+	canvasPtr->damage[i].y2 = y2;
+	return;
+    }
+
+    /*
+     * The accumulator is full: merge into the rectangle whose union with
+     * the new area adds the least extra surface.
+     */
+
+    best = 0;
+    bestGrowth = -1.0;
+    for (i = 0; i < canvasPtr->numDamage; i++) {
+	double ux1 = (x1 < canvasPtr->damage[i].x1)
+		? x1 : canvasPtr->damage[i].x1;
+	double uy1 = (y1 < canvasPtr->damage[i].y1)
+		? y1 : canvasPtr->damage[i].y1;
+	double ux2 = (x2 > canvasPtr->damage[i].x2)
+		? x2 : canvasPtr->damage[i].x2;
+	double uy2 = (y2 > canvasPtr->damage[i].y2)
+		? y2 : canvasPtr->damage[i].y2;
+
+	growth = (ux2 - ux1) * (uy2 - uy1)
+		- ((double) canvasPtr->damage[i].x2 - canvasPtr->damage[i].x1)
+		* ((double) canvasPtr->damage[i].y2 - canvasPtr->damage[i].y1);
+	if ((bestGrowth < 0) || (growth < bestGrowth)) {
+	    bestGrowth = growth;
+	    best = i;
+	}
+    }
+    i = best;
+
+  merge:
+    if (x1 < canvasPtr->damage[i].x1) {
+	canvasPtr->damage[i].x1 = x1;
+    }
+    if (y1 < canvasPtr->damage[i].y1) {
+	canvasPtr->damage[i].y1 = y1;
+    }
+    if (x2 > canvasPtr->damage[i].x2) {
+	canvasPtr->damage[i].x2 = x2;
+    }
+    if (y2 > canvasPtr->damage[i].y2) {
+	canvasPtr->damage[i].y2 = y2;
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -3445,6 +5508,20 @@ EventuallyRedrawItem(
     if (itemPtr == NULL || canvasPtr->tkwin == NULL) {
 	return;
     }
+
+    /*
+     * This is called both before and after every change to an item's
+     * bounding box, which makes it the natural place to keep the spatial
+     * index current.
+     */
+
+    CanvasIndexItem(canvasPtr, itemPtr);
+
+    if ((canvasPtr->numLayerItems > 0)
+	    && (CanvasItemLayer(canvasPtr, itemPtr) != 0)) {
+	canvasPtr->layerValid = 0;
+    }
+
     if ((itemPtr->x1 >= itemPtr->x2) || (itemPtr->y1 >= itemPtr->y2) ||
  	    (itemPtr->x2 < canvasPtr->xOrigin) ||
 	    (itemPtr->y2 < canvasPtr->yOrigin) ||
@@ -3475,10 +5552,12 @@ EventuallyRedrawItem(
 	    canvasPtr->redrawY2 = itemPtr->y2;
 	    canvasPtr->flags |= BBOX_NOT_EMPTY;
 	}
+	CanvasAddDamage(canvasPtr, itemPtr->x1, itemPtr->y1, itemPtr->x2,
+		itemPtr->y2);
 	itemPtr->redraw_flags |= FORCE_REDRAW;
     }
     if (!(canvasPtr->flags & REDRAW_PENDING)) {
-	Tcl_DoWhenIdle(DisplayCanvas, canvasPtr);
+	TkDoWhenIdle(DisplayCanvas, canvasPtr, TK_IDLE_DISPLAY);
 	canvasPtr->flags |= REDRAW_PENDING;
     }
 }
@@ -3665,8 +5744,7 @@ TagSearchExprInit(
 
     if (expr == NULL) {
 	expr = (TagSearchExpr *)ckalloc(sizeof(TagSearchExpr));
-	expr->allocated = 0;
-	expr->uids = NULL;
+	TagExprUids_Init(&expr->uids);
 	expr->next = NULL;
     }
     expr->uid = NULL;
@@ -3694,9 +5772,7 @@ TagSearchExprDestroy(
     TagSearchExpr *expr)
 {
     if (expr != NULL) {
-    	if (expr->uids) {
-	    ckfree(expr->uids);
-	}
+	TagExprUids_Free(&expr->uids);
 	ckfree(expr);
     }
 }
@@ -3754,7 +5830,14 @@ TagSearchScan(
 
 	searchPtr->rewritebufferAllocated = 100;
 	searchPtr->rewritebuffer = (char *)ckalloc(searchPtr->rewritebufferAllocated);
+	searchPtr->tagItems = NULL;
     }
+    if (searchPtr->tagItems != NULL) {
+	ckfree(searchPtr->tagItems);
+	searchPtr->tagItems = NULL;
+    }
+    searchPtr->numTagItems = 0;
+    searchPtr->tagItemIndex = 0;
     TagSearchExprInit(&searchPtr->expr);
 
     /*
@@ -3899,6 +5982,9 @@ TagSearchDestroy(
 {
     if (searchPtr) {
 	TagSearchExprDestroy(searchPtr->expr);
+	if (searchPtr->tagItems != NULL) {
+	    ckfree(searchPtr->tagItems);
+	}
 	ckfree(searchPtr->rewritebuffer);
 	ckfree(searchPtr);
     }
@@ -3950,15 +6036,7 @@ TagSearchScanExpr(
 	 * Need two slots free at this point, not one. [Bug 2931374]
 	 */
 
-	if (expr->index >= expr->allocated-1) {
-	    expr->allocated += 15;
-	    if (expr->uids) {
-		expr->uids = (Tk_Uid *)ckrealloc(expr->uids,
-			expr->allocated * sizeof(Tk_Uid));
-	    } else {
-		expr->uids = (Tk_Uid *)ckalloc(expr->allocated * sizeof(Tk_Uid));
-	    }
-	}
+	TagExprUids_Reserve(&expr->uids, (size_t)expr->index + 2);
 
 	if (looking_for_tag) {
 	    switch (c) {
@@ -3982,10 +6060,10 @@ TagSearchScanExpr(
 
 	    case '(':		/* Scan (negated) subexpr recursively */
 		if (negate_result) {
-		    expr->uids[expr->index++] = searchUids->negparenUid;
+		    expr->uids.buf[expr->index++] = searchUids->negparenUid;
 		    negate_result = 0;
 		} else {
-		    expr->uids[expr->index++] = searchUids->parenUid;
+		    expr->uids.buf[expr->index++] = searchUids->parenUid;
 		}
 		if (TagSearchScanExpr(interp, searchPtr, expr) != TCL_OK) {
 		    /*
@@ -4001,10 +6079,10 @@ TagSearchScanExpr(
 
 	    case '"':		/* Quoted tag string */
 		if (negate_result) {
-		    expr->uids[expr->index++] = searchUids->negtagvalUid;
+		    expr->uids.buf[expr->index++] = searchUids->negtagvalUid;
 		    negate_result = 0;
 		} else {
-		    expr->uids[expr->index++] = searchUids->tagvalUid;
+		    expr->uids.buf[expr->index++] = searchUids->tagvalUid;
 		}
 		tag = searchPtr->rewritebuffer;
 		found_endquote = 0;
@@ -4035,7 +6113,7 @@ TagSearchScanExpr(
 		    return TCL_ERROR;
 		}
 		*tag++ = '\0';
-		expr->uids[expr->index++] =
+		expr->uids.buf[expr->index++] =
 			Tk_GetUid(searchPtr->rewritebuffer);
 		looking_for_tag = 0;
 		found_tag = 1;
@@ -4053,10 +6131,10 @@ TagSearchScanExpr(
 
 	    default:		/* Unquoted tag string */
 		if (negate_result) {
-		    expr->uids[expr->index++] = searchUids->negtagvalUid;
+		    expr->uids.buf[expr->index++] = searchUids->negtagvalUid;
 		    negate_result = 0;
 		} else {
-		    expr->uids[expr->index++] = searchUids->tagvalUid;
+		    expr->uids.buf[expr->index++] = searchUids->tagvalUid;
 		}
 		tag = searchPtr->rewritebuffer;
 		*tag++ = c;
@@ -4092,7 +6170,7 @@ TagSearchScanExpr(
 		    }
 		}
 		*++tag = '\0';
-		expr->uids[expr->index++] =
+		expr->uids.buf[expr->index++] =
 			Tk_GetUid(searchPtr->rewritebuffer);
 		looking_for_tag = 0;
 		found_tag = 1;
@@ -4115,7 +6193,7 @@ TagSearchScanExpr(
 			    "INCOMPLETE_OP", NULL);
 		    return TCL_ERROR;
 		}
-		expr->uids[expr->index++] = searchUids->andUid;
+		expr->uids.buf[expr->index++] = searchUids->andUid;
 		looking_for_tag = 1;
 		break;
 
@@ -4128,17 +6206,17 @@ TagSearchScanExpr(
 			    "INCOMPLETE_OP", NULL);
 		    return TCL_ERROR;
 		}
-		expr->uids[expr->index++] = searchUids->orUid;
+		expr->uids.buf[expr->index++] = searchUids->orUid;
 		looking_for_tag = 1;
 		break;
 
 	    case '^':		/* XOR operator */
-		expr->uids[expr->index++] = searchUids->xorUid;
+		expr->uids.buf[expr->index++] = searchUids->xorUid;
 		looking_for_tag = 1;
 		break;
 
 	    case ')':		/* End subexpression */
-		expr->uids[expr->index++] = searchUids->endparenUid;
+		expr->uids.buf[expr->index++] = searchUids->endparenUid;
 		goto breakwhile;
 
 	    default:		/* syntax error */
@@ -4200,13 +6278,13 @@ TagSearchEvalExpr(
     negate_result = 0;
     looking_for_tag = 1;
     while (expr->index < expr->length) {
-	uid = expr->uids[expr->index++];
+	uid = expr->uids.buf[expr->index++];
 	if (looking_for_tag) {
 	    if (uid == searchUids->tagvalUid) {
 /*
  *		assert(expr->index < expr->length);
  */
-		uid = expr->uids[expr->index++];
+		uid = expr->uids.buf[expr->index++];
 		result = 0;
 
 		/*
@@ -4226,7 +6304,7 @@ TagSearchEvalExpr(
 /*
  *		assert(expr->index < expr->length);
  */
-		uid = expr->uids[expr->index++];
+		uid = expr->uids.buf[expr->index++];
 		result = 0;
 
 		/*
@@ -4275,7 +6353,7 @@ TagSearchEvalExpr(
 
 		parendepth = 0;
 		while (expr->index < expr->length) {
-		    uid = expr->uids[expr->index++];
+		    uid = expr->uids.buf[expr->index++];
 		    if (uid == searchUids->tagvalUid ||
 			    uid == searchUids->negtagvalUid) {
 			expr->index++;
@@ -4340,8 +6418,7 @@ TagSearchFirst(
     TagSearch *searchPtr)	/* Record describing tag search */
 {
     Tk_Item *itemPtr, *lastPtr;
-    Tk_Uid uid, *tagPtr;
-    int count;
+    Tk_Uid uid;
 
     /*
      * Short circuit impossible searches for null tags.
@@ -4393,19 +6470,36 @@ TagSearchFirst(
 
     if (searchPtr->type == SEARCH_TYPE_TAG) {
 	/*
-	 * Optimized single-tag search
+	 * Optimized single-tag search, driven by the canvas's tag index
+	 * instead of a walk over the whole display list. The index list is
+	 * copied into the search record so that scripts run during the
+	 * search cannot pull it out from under us; each entry is then
+	 * re-validated as it is returned.
 	 */
 
+	TagIndexList *listPtr;
+
 	uid = searchPtr->expr->uid;
-	for (lastPtr = NULL, itemPtr = searchPtr->canvasPtr->firstItemPtr;
-		itemPtr != NULL; lastPtr=itemPtr, itemPtr=itemPtr->nextPtr) {
-	    for (tagPtr = itemPtr->tagPtr, count = (int)itemPtr->numTags;
-		    count > 0; tagPtr++, count--) {
-		if (*tagPtr == uid) {
-		    searchPtr->lastPtr = lastPtr;
-		    searchPtr->currentPtr = itemPtr;
-		    return itemPtr;
-		}
+	listPtr = CanvasTagIndexGet(searchPtr->canvasPtr, uid);
+	if (searchPtr->tagItems != NULL) {
+	    ckfree(searchPtr->tagItems);
+	    searchPtr->tagItems = NULL;
+	}
+	searchPtr->numTagItems = listPtr->numItems;
+	searchPtr->tagItemIndex = 0;
+	if (listPtr->numItems > 0) {
+	    searchPtr->tagItems = (Tk_Item **)ckalloc(
+		    listPtr->numItems * sizeof(Tk_Item *));
+	    memcpy(searchPtr->tagItems, listPtr->items,
+		    listPtr->numItems * sizeof(Tk_Item *));
+	}
+	lastPtr = NULL;
+	while (searchPtr->tagItemIndex < searchPtr->numTagItems) {
+	    itemPtr = searchPtr->tagItems[searchPtr->tagItemIndex++];
+	    if (CanvasTagItemValid(searchPtr->canvasPtr, itemPtr, uid)) {
+		searchPtr->lastPtr = itemPtr->prevPtr;
+		searchPtr->currentPtr = itemPtr;
+		return itemPtr;
 	    }
 	}
     } else {
@@ -4454,8 +6548,29 @@ TagSearchNext(
     TagSearch *searchPtr)	/* Record describing search in progress. */
 {
     Tk_Item *itemPtr, *lastPtr;
-    Tk_Uid uid, *tagPtr;
-    int count;
+    Tk_Uid uid;
+
+    if (searchPtr->type == SEARCH_TYPE_TAG) {
+	/*
+	 * Optimized single-tag search: continue through the snapshot taken
+	 * by TagSearchFirst, re-validating each entry as it is returned.
+	 */
+
+	if (searchPtr->searchOver) {
+	    return NULL;
+	}
+	uid = searchPtr->expr->uid;
+	while (searchPtr->tagItemIndex < searchPtr->numTagItems) {
+	    itemPtr = searchPtr->tagItems[searchPtr->tagItemIndex++];
+	    if (CanvasTagItemValid(searchPtr->canvasPtr, itemPtr, uid)) {
+		searchPtr->lastPtr = itemPtr->prevPtr;
+		searchPtr->currentPtr = itemPtr;
+		return itemPtr;
+	    }
+	}
+	searchPtr->searchOver = 1;
+	return NULL;
+    }
 
     /*
      * Find next item in list (this may not actually be a suitable one to
@@ -4494,27 +6609,6 @@ TagSearchNext(
 	return itemPtr;
     }
 
-    if (searchPtr->type == SEARCH_TYPE_TAG) {
-	/*
-	 * Optimized single-tag search
-	 */
-
-	uid = searchPtr->expr->uid;
-	for (; itemPtr != NULL; lastPtr = itemPtr, itemPtr = itemPtr->nextPtr) {
-	    for (tagPtr = itemPtr->tagPtr, count = (int)itemPtr->numTags;
-		    count > 0; tagPtr++, count--) {
-		if (*tagPtr == uid) {
-		    searchPtr->lastPtr = lastPtr;
-		    searchPtr->currentPtr = itemPtr;
-		    return itemPtr;
-		}
-	    }
-	}
-	searchPtr->lastPtr = lastPtr;
-	searchPtr->searchOver = 1;
-	return NULL;
-    }
-
     /*
      * Else.... evaluate tag expression
      */
@@ -4553,6 +6647,7 @@ TagSearchNext(
 
 static void
 DoItem(
+    TkCanvas *canvasPtr,	/* Canvas containing the item. */
     Tcl_Obj *accumObj,		/* Object in which to (possibly) record item
 				 * id. */
     Tk_Item *itemPtr,		/* Item to (possibly) modify. */
@@ -4602,6 +6697,7 @@ DoItem(
 
     *tagPtr = tag;
     itemPtr->numTags++;
+    canvasPtr->tagIndexEpoch++;
 }
 
 /*
@@ -4682,7 +6778,7 @@ FindItems(
 	}
 	if ((lastPtr != NULL) && (lastPtr->nextPtr != NULL)) {
 	    resultObj = Tcl_NewObj();
-	    DoItem(resultObj, lastPtr->nextPtr, uid);
+	    DoItem(canvasPtr, resultObj, lastPtr->nextPtr, uid);
 	    Tcl_SetObjResult(interp, resultObj);
 	}
 	break;
@@ -4696,7 +6792,7 @@ FindItems(
 	resultObj = Tcl_NewObj();
 	for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
 		itemPtr = itemPtr->nextPtr) {
-	    DoItem(resultObj, itemPtr, uid);
+	    DoItem(canvasPtr, resultObj, itemPtr, uid);
 	}
 	Tcl_SetObjResult(interp, resultObj);
 	break;
@@ -4710,7 +6806,7 @@ FindItems(
 		return TCL_ERROR);
 	if ((itemPtr != NULL) && (itemPtr->prevPtr != NULL)) {
 	    resultObj = Tcl_NewObj();
-	    DoItem(resultObj, itemPtr->prevPtr, uid);
+	    DoItem(canvasPtr, resultObj, itemPtr->prevPtr, uid);
 	    Tcl_SetObjResult(interp, resultObj);
 	}
 	break;
@@ -4744,6 +6840,72 @@ FindItems(
 	    halo = 0.0;
 	}
 
+	/*
+	 * When no explicit start item is given (the common case, e.g. hit
+	 * testing after mouse motion), drive the search from the spatial
+	 * index with an expanding ring around the point instead of walking
+	 * the whole display list. Each pass queries a box around the point
+	 * and keeps the topmost item at minimal distance; once that distance
+	 * fits inside the queried box no item outside it can be closer, so
+	 * the answer is final. On dense scenes this calls the item Point
+	 * procs for a handful of nearby items only. (Partitioning the
+	 * candidates across worker threads was considered instead, but item
+	 * Point procs touch interp and display state and must run on the
+	 * widget's thread; index pruning removes the same work without
+	 * that hazard.)
+	 */
+
+	if (objc < first+5) {
+	    TkCanvasIndexItem **recs;
+	    int numRecs, i, all;
+	    double range, newDist, edge;
+
+	    closestPtr = NULL;
+	    closestDist = 0.0;
+	    range = halo + 64;
+	    while (1) {
+		edge = coords[0] - range;
+		x1 = (edge < (double) INT_MIN) ? INT_MIN : (int) edge;
+		edge = coords[1] - range;
+		y1 = (edge < (double) INT_MIN) ? INT_MIN : (int) edge;
+		edge = coords[0] + range;
+		x2 = (edge > (double) INT_MAX) ? INT_MAX : (int) edge;
+		edge = coords[1] + range;
+		y2 = (edge > (double) INT_MAX) ? INT_MAX : (int) edge;
+		numRecs = CanvasIndexQuery(canvasPtr, x1, y1, x2, y2, &recs);
+		all = (numRecs >= (int) canvasPtr->indexItemTable.numEntries);
+		closestPtr = NULL;
+		for (i = 0; i < numRecs; i++) {
+		    itemPtr = recs[i]->itemPtr;
+		    if (itemPtr->state == TK_STATE_HIDDEN ||
+			    (itemPtr->state == TK_STATE_NULL &&
+			    canvasPtr->canvas_state == TK_STATE_HIDDEN)) {
+			continue;
+		    }
+		    newDist = ItemPoint(canvasPtr, itemPtr, coords, halo);
+		    if ((closestPtr == NULL) || (newDist <= closestDist)) {
+			closestPtr = itemPtr;
+			closestDist = newDist;
+		    }
+		}
+		ckfree(recs);
+		if ((closestPtr != NULL)
+			&& (closestDist + halo + 1 <= range)) {
+		    break;
+		}
+		if (all) {
+		    break;
+		}
+		range *= 4;
+	    }
+	    if (closestPtr != NULL) {
+		resultObj = Tcl_NewObj();
+		DoItem(canvasPtr, resultObj, closestPtr, uid);
+		Tcl_SetObjResult(interp, resultObj);
+	    }
+	    return TCL_OK;
+	}
+
 	/*
 	 * Find the item at which to start the search.
 	 */
@@ -4802,7 +6964,7 @@ FindItems(
 		}
 		if (itemPtr == startPtr) {
 		    resultObj = Tcl_NewObj();
-		    DoItem(resultObj, closestPtr, uid);
+		    DoItem(canvasPtr, resultObj, closestPtr, uid);
 		    Tcl_SetObjResult(interp, resultObj);
 		    return TCL_OK;
 		}
@@ -4844,7 +7006,7 @@ FindItems(
 	resultObj = Tcl_NewObj();
 	FOR_EVERY_CANVAS_ITEM_MATCHING(objv[first+1], searchPtrPtr,
 		goto badWithTagSearch) {
-	    DoItem(resultObj, itemPtr, uid);
+	    DoItem(canvasPtr, resultObj, itemPtr, uid);
 	}
 	Tcl_SetObjResult(interp, resultObj);
 	return TCL_OK;
@@ -4893,18 +7055,13 @@ FindArea(
 				 * OK, 1 means only enclosed items are OK. */
 {
     double rect[4], tmp;
-    int x1, y1, x2, y2;
+    int x1, y1, x2, y2, numRecs, i;
     Tk_Item *itemPtr;
+    TkCanvasIndexItem **recs;
     Tcl_Obj *resultObj;
 
-    if ((Tk_CanvasGetCoordFromObj(interp, (Tk_Canvas) canvasPtr, objv[0],
-		&rect[0]) != TCL_OK)
-	    || (Tk_CanvasGetCoordFromObj(interp,(Tk_Canvas)canvasPtr,objv[1],
-		&rect[1]) != TCL_OK)
-	    || (Tk_CanvasGetCoordFromObj(interp,(Tk_Canvas)canvasPtr,objv[2],
-		&rect[2]) != TCL_OK)
-	    || (Tk_CanvasGetCoordFromObj(interp,(Tk_Canvas)canvasPtr,objv[3],
-		&rect[3]) != TCL_OK)) {
+    if (TkCanvasGetCoords(interp, (Tk_Canvas) canvasPtr, 4, objv,
+	    rect) != TCL_OK) {
 	return TCL_ERROR;
     }
     if (rect[0] > rect[2]) {
@@ -4916,7 +7073,10 @@ FindArea(
 
     /*
      * Use an integer bounding box for a quick test, to avoid calling
-     * item-specific code except for items that are close.
+     * item-specific code except for items that are close. The spatial index
+     * narrows the candidate set to items near the search area; each
+     * candidate's actual bounding box is still checked here, since the index
+     * may be slightly stale.
      */
 
     x1 = (int) (rect[0] - 1.0);
@@ -4924,8 +7084,9 @@ FindArea(
     x2 = (int) (rect[2] + 1.0);
     y2 = (int) (rect[3] + 1.0);
     resultObj = Tcl_NewObj();
-    for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
-	    itemPtr = itemPtr->nextPtr) {
+    numRecs = CanvasIndexQuery(canvasPtr, x1, y1, x2, y2, &recs);
+    for (i = 0; i < numRecs; i++) {
+	itemPtr = recs[i]->itemPtr;
 	if (itemPtr->state == TK_STATE_HIDDEN ||
 		(itemPtr->state == TK_STATE_NULL
 		&& canvasPtr->canvas_state == TK_STATE_HIDDEN)) {
@@ -4936,9 +7097,10 @@ FindArea(
 	    continue;
 	}
 	if (ItemOverlap(canvasPtr, itemPtr, rect) >= enclosed) {
-	    DoItem(resultObj, itemPtr, uid);
+	    DoItem(canvasPtr, resultObj, itemPtr, uid);
 	}
     }
+    ckfree(recs);
     Tcl_SetObjResult(interp, resultObj);
     return TCL_OK;
 }
@@ -5045,6 +7207,9 @@ RelinkItems(
     if (canvasPtr->lastItemPtr == prevPtr) {
 	canvasPtr->lastItemPtr = lastMovePtr;
     }
+    canvasPtr->indexOrderValid = 0;
+    canvasPtr->indexBBoxValid = 0;
+    canvasPtr->tagIndexEpoch++;
     return TCL_OK;
 }
 
@@ -5298,6 +7463,7 @@ PickCurrentItem(
                             itemPtr->tagPtr + i + 1,
                             (itemPtr->numTags - (i+1)) * sizeof(Tk_Uid));
 		    itemPtr->numTags--;
+		    canvasPtr->tagIndexEpoch++;
 		    break;
 		}
 	    }
@@ -5331,7 +7497,8 @@ PickCurrentItem(
     if (canvasPtr->currentItemPtr != NULL) {
 	XEvent event;
 
-	DoItem(NULL, canvasPtr->currentItemPtr, searchUids->currentUid);
+	DoItem(canvasPtr, NULL, canvasPtr->currentItemPtr,
+		searchUids->currentUid);
 	if ((canvasPtr->currentItemPtr->redraw_flags & TK_ITEM_STATE_DEPENDANT
 		&& prevItemPtr != canvasPtr->currentItemPtr)) {
 	    ItemConfigure(canvasPtr, canvasPtr->currentItemPtr, 0, NULL);
@@ -5591,7 +7758,7 @@ CanvasFocusProc(
     if (canvasPtr->highlightWidth > 0) {
 	canvasPtr->flags |= REDRAW_BORDERS;
 	if (!(canvasPtr->flags & REDRAW_PENDING)) {
-	    Tcl_DoWhenIdle(DisplayCanvas, canvasPtr);
+	    TkDoWhenIdle(DisplayCanvas, canvasPtr, TK_IDLE_DISPLAY);
 	    canvasPtr->flags |= REDRAW_PENDING;
 	}
     }
@@ -5775,14 +7942,15 @@ GridAlign(
  *----------------------------------------------------------------------
  */
 
-static Tcl_Obj *
-ScrollFractions(
+static void
+ComputeScrollFractions(
     int screen1,		/* Lowest coordinate visible in the window. */
     int screen2,		/* Highest coordinate visible in the window. */
     int object1,		/* Lowest coordinate in the object. */
-    int object2)		/* Highest coordinate in the object. */
+    int object2,		/* Highest coordinate in the object. */
+    double *firstPtr,		/* Filled in with the first fraction. */
+    double *lastPtr)		/* Filled in with the last fraction. */
 {
-    Tcl_Obj *buffer[2];
     double range, f1, f2;
 
     range = object2 - object1;
@@ -5802,6 +7970,21 @@ ScrollFractions(
 	    f2 = f1;
 	}
     }
+    *firstPtr = f1;
+    *lastPtr = f2;
+}
+
+static Tcl_Obj *
+ScrollFractions(
+    int screen1,		/* Lowest coordinate visible in the window. */
+    int screen2,		/* Highest coordinate visible in the window. */
+    int object1,		/* Lowest coordinate in the object. */
+    int object2)		/* Highest coordinate in the object. */
+{
+    Tcl_Obj *buffer[2];
+    double f1, f2;
+
+    ComputeScrollFractions(screen1, screen2, object1, object2, &f1, &f2);
     buffer[0] = Tcl_NewDoubleObj(f1);
     buffer[1] = Tcl_NewDoubleObj(f2);
     return Tcl_NewListObj(2, buffer);
@@ -5864,38 +8047,50 @@ CanvasUpdateScrollbars(
     scrollY2 = canvasPtr->scrollY2;
     canvasPtr->flags &= ~UPDATE_SCROLLBARS;
     if (canvasPtr->xScrollCmd != NULL) {
-	Tcl_Obj *fractions = ScrollFractions(xOrigin + inset,
-		xOrigin + width - inset, scrollX1, scrollX2);
-
-	Tcl_DStringInit(&buf);
-	Tcl_DStringAppend(&buf, xScrollCmd, TCL_INDEX_NONE);
-	Tcl_DStringAppend(&buf, " ", TCL_INDEX_NONE);
-	Tcl_DStringAppend(&buf, Tcl_GetString(fractions), TCL_INDEX_NONE);
-	result = Tcl_EvalEx(interp, Tcl_DStringValue(&buf), TCL_INDEX_NONE, TCL_EVAL_GLOBAL);
-	Tcl_DStringFree(&buf);
-	Tcl_DecrRefCount(fractions);
-	if (result != TCL_OK) {
-	    Tcl_BackgroundException(interp, result);
+	double first, last;
+
+	ComputeScrollFractions(xOrigin + inset, xOrigin + width - inset,
+		scrollX1, scrollX2, &first, &last);
+	if (!TkScrollbarUpdate(interp, xScrollCmd, first, last)) {
+	    Tcl_Obj *fractions = ScrollFractions(xOrigin + inset,
+		    xOrigin + width - inset, scrollX1, scrollX2);
+
+	    Tcl_DStringInit(&buf);
+	    Tcl_DStringAppend(&buf, xScrollCmd, TCL_INDEX_NONE);
+	    Tcl_DStringAppend(&buf, " ", TCL_INDEX_NONE);
+	    Tcl_DStringAppend(&buf, Tcl_GetString(fractions), TCL_INDEX_NONE);
+	    result = Tcl_EvalEx(interp, Tcl_DStringValue(&buf), TCL_INDEX_NONE, TCL_EVAL_GLOBAL);
+	    Tcl_DStringFree(&buf);
+	    Tcl_DecrRefCount(fractions);
+	    if (result != TCL_OK) {
+		Tcl_BackgroundException(interp, result);
+	    }
+	    Tcl_ResetResult(interp);
 	}
-	Tcl_ResetResult(interp);
 	Tcl_Release(xScrollCmd);
     }
 
     if (yScrollCmd != NULL) {
-	Tcl_Obj *fractions = ScrollFractions(yOrigin + inset,
-		yOrigin + height - inset, scrollY1, scrollY2);
-
-	Tcl_DStringInit(&buf);
-	Tcl_DStringAppend(&buf, yScrollCmd, TCL_INDEX_NONE);
-	Tcl_DStringAppend(&buf, " ", TCL_INDEX_NONE);
-	Tcl_DStringAppend(&buf, Tcl_GetString(fractions), TCL_INDEX_NONE);
-	result = Tcl_EvalEx(interp, Tcl_DStringValue(&buf), TCL_INDEX_NONE, TCL_EVAL_GLOBAL);
-	Tcl_DStringFree(&buf);
-	Tcl_DecrRefCount(fractions);
-	if (result != TCL_OK) {
-	    Tcl_BackgroundException(interp, result);
+	double first, last;
+
+	ComputeScrollFractions(yOrigin + inset, yOrigin + height - inset,
+		scrollY1, scrollY2, &first, &last);
+	if (!TkScrollbarUpdate(interp, yScrollCmd, first, last)) {
+	    Tcl_Obj *fractions = ScrollFractions(yOrigin + inset,
+		    yOrigin + height - inset, scrollY1, scrollY2);
+
+	    Tcl_DStringInit(&buf);
+	    Tcl_DStringAppend(&buf, yScrollCmd, TCL_INDEX_NONE);
+	    Tcl_DStringAppend(&buf, " ", TCL_INDEX_NONE);
+	    Tcl_DStringAppend(&buf, Tcl_GetString(fractions), TCL_INDEX_NONE);
+	    result = Tcl_EvalEx(interp, Tcl_DStringValue(&buf), TCL_INDEX_NONE, TCL_EVAL_GLOBAL);
+	    Tcl_DStringFree(&buf);
+	    Tcl_DecrRefCount(fractions);
+	    if (result != TCL_OK) {
+		Tcl_BackgroundException(interp, result);
+	    }
+	    Tcl_ResetResult(interp);
 	}
-	Tcl_ResetResult(interp);
 	Tcl_Release(yScrollCmd);
     }
     Tcl_Release(interp);
@@ -5930,6 +8125,7 @@ CanvasSetOrigin(
 				 * window). */
 {
     int left, right, top, bottom, delta;
+    int dx, dy, innerWidth, innerHeight;
 
     /*
      * If scroll increments have been set, round the window origin to the
@@ -6010,6 +8206,74 @@ CanvasSetOrigin(
 	return;
     }
 
+    /*
+     * When the view moves by less than a window, most of the visible area
+     * survives the scroll.  Blit the surviving region into place and repaint
+     * only the strips coming into view, so a scroll costs in proportion to
+     * the delta rather than to the viewport.  Window items rule this out
+     * (copying pixels does not move child windows), and an unmapped or fully
+     * obscured canvas is repainted from scratch anyway.  Pending damage is
+     * no obstacle: it is recorded in canvas coordinates, which stay valid
+     * across the shift.
+     */
+
+    dx = canvasPtr->xOrigin - xOrigin;
+    dy = canvasPtr->yOrigin - yOrigin;
+    innerWidth = Tk_Width(canvasPtr->tkwin) - 2*canvasPtr->inset;
+    innerHeight = Tk_Height(canvasPtr->tkwin) - 2*canvasPtr->inset;
+    if ((canvasPtr->numWinItems == 0) && Tk_IsMapped(canvasPtr->tkwin)
+	    && !TkWindowObscured((TkWindow *) canvasPtr->tkwin)
+	    && (dx > -innerWidth) && (dx < innerWidth)
+	    && (dy > -innerHeight) && (dy < innerHeight)) {
+	XGCValues gcValues;
+	GC gc;
+	TkRegion damageRgn;
+	XRectangle rect;
+
+	gcValues.graphics_exposures = True;
+	gc = Tk_GetGC(canvasPtr->tkwin, GCGraphicsExposures, &gcValues);
+	damageRgn = TkCreateRegion();
+	if (TkScrollWindow(canvasPtr->tkwin, gc, canvasPtr->inset,
+		canvasPtr->inset, innerWidth, innerHeight, dx, dy, damageRgn)) {
+	    TkClipBox(damageRgn, &rect);
+	    Tk_CanvasEventuallyRedraw((Tk_Canvas) canvasPtr,
+		    rect.x + xOrigin, rect.y + yOrigin,
+		    rect.x + rect.width + xOrigin,
+		    rect.y + rect.height + yOrigin);
+	}
+	TkDestroyRegion(damageRgn);
+	Tk_FreeGC(Tk_Display(canvasPtr->tkwin), gc);
+
+	canvasPtr->xOrigin = xOrigin;
+	canvasPtr->yOrigin = yOrigin;
+	canvasPtr->flags |= UPDATE_SCROLLBARS;
+	if (dx > 0) {
+	    Tk_CanvasEventuallyRedraw((Tk_Canvas) canvasPtr,
+		    xOrigin + canvasPtr->inset, yOrigin + canvasPtr->inset,
+		    xOrigin + canvasPtr->inset + dx,
+		    yOrigin + canvasPtr->inset + innerHeight);
+	} else if (dx < 0) {
+	    Tk_CanvasEventuallyRedraw((Tk_Canvas) canvasPtr,
+		    xOrigin + canvasPtr->inset + innerWidth + dx,
+		    yOrigin + canvasPtr->inset,
+		    xOrigin + canvasPtr->inset + innerWidth,
+		    yOrigin + canvasPtr->inset + innerHeight);
+	}
+	if (dy > 0) {
+	    Tk_CanvasEventuallyRedraw((Tk_Canvas) canvasPtr,
+		    xOrigin + canvasPtr->inset, yOrigin + canvasPtr->inset,
+		    xOrigin + canvasPtr->inset + innerWidth,
+		    yOrigin + canvasPtr->inset + dy);
+	} else if (dy < 0) {
+	    Tk_CanvasEventuallyRedraw((Tk_Canvas) canvasPtr,
+		    xOrigin + canvasPtr->inset,
+		    yOrigin + canvasPtr->inset + innerHeight + dy,
+		    xOrigin + canvasPtr->inset + innerWidth,
+		    yOrigin + canvasPtr->inset + innerHeight);
+	}
+	return;
+    }
+
     /*
      * Tricky point: must redisplay not only everything that's visible in the
      * window's final configuration, but also everything that was visible in
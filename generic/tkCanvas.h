@@ -20,19 +20,10 @@
 
 #ifndef USE_OLD_TAG_SEARCH
 typedef struct TagSearchExpr_s TagSearchExpr;
-
-struct TagSearchExpr_s {
-    TagSearchExpr *next;	/* For linked lists of expressions - used in
-				 * bindings. */
-    Tk_Uid uid;			/* The uid of the whole expression. */
-    Tk_Uid *uids;		/* Expresion compiled to an array of uids. */
-    int allocated;		/* Available space for array of uids. */
-    int length;			/* Length of expression. */
-    int index;			/* Current position in expression
-				 * evaluation. */
-    int match;			/* This expression matches event's item's
-				 * tags. */
-};
+				/* Compiled tag search expression. The struct
+				 * is private to tkCanvas.c, which defines
+				 * it; everything else only passes pointers
+				 * around. */
 #endif /* not USE_OLD_TAG_SEARCH */
 
 /*
@@ -221,6 +212,142 @@ typedef struct TkCanvas {
 				 * Postscript is currently being generated. */
     Tcl_HashTable idTable;	/* Table of integer indices. */
 
+    /*
+     * Spatial index over item bounding boxes, used to speed up area searches
+     * and redraw culling. See the "spatial index" section of tkCanvas.c for
+     * details.
+     */
+
+    Tcl_HashTable indexCellTable;
+				/* Maps grid cell (x,y) to the list of items
+				 * whose bounding boxes overlap that cell. */
+    Tcl_HashTable indexItemTable;
+				/* Maps Tk_Item * to its bookkeeping record in
+				 * the spatial index. */
+    struct TkCanvasIndexItem *indexOversizePtr;
+				/* List of items whose bounding boxes span too
+				 * many cells to be stored per-cell; these are
+				 * always scanned linearly. */
+    unsigned long indexNextOrder;
+				/* Display-list order number to assign to the
+				 * next item appended to the canvas. */
+    unsigned long indexQueryEpoch;
+				/* Bumped on each index query; used to
+				 * de-duplicate candidates that appear in more
+				 * than one cell. */
+    int indexOrderValid;	/* Non-zero means the cached order numbers
+				 * still match the current display list. */
+    int *indexBBoxes;		/* Packed display-order array of bounding
+				 * boxes, four ints (x1,y1,x2,y2) per indexed
+				 * item; NULL until first built. Queries on
+				 * small and medium scenes sweep this array
+				 * linearly instead of probing grid cells. */
+    struct TkCanvasIndexItem **indexBBoxRecs;
+				/* Record pointer parallel to each box in
+				 * indexBBoxes. */
+    int indexNumBBoxes;		/* Number of boxes in the packed arrays. */
+    int indexMaxBBoxes;		/* Allocated capacity of the packed arrays. */
+    int indexBBoxValid;		/* Non-zero means the packed arrays match the
+				 * current boxes and display order. */
+    int indexNumItems;		/* Total number of records in the index. */
+    int indexSuspect;		/* Non-zero means damage was reported through
+				 * Tk_CanvasEventuallyRedraw since the last
+				 * query. An item type outside the canvas
+				 * core (image and window items, third-party
+				 * types) may have recomputed its bounding
+				 * box without the index being told, so the
+				 * next query revalidates every record. */
+
+    /*
+     * Level-of-detail rendering. When lodThreshold is positive, items whose
+     * bounding box is smaller than that many pixels in both dimensions are
+     * drawn as one aggregated batch of points instead of through their
+     * type's displayProc, so zoomed-out overview redraws cost pixels, not
+     * items.
+     */
+
+    int lodThreshold;		/* Pixel size below which items collapse to
+				 * points; 0 disables the mode. */
+    XColor *lodColor;		/* Color the aggregated points are drawn
+				 * in. */
+    GC lodGC;			/* Graphics context for the points; NULL
+				 * until the widget is configured. */
+    int antialias;		/* Non-zero requests antialiased rendering
+				 * of item interiors where the port supports
+				 * it (currently polygon fills through
+				 * RENDER on X11); see TK_RENDER_POLYGONS. */
+
+    /*
+     * Lazily-built index of items by tag, used by single-tag searches. Each
+     * entry maps a tag uid to the list of items carrying the tag, in display
+     * order as of the epoch at which the list was built. Any operation that
+     * may change item tags or the display order bumps tagIndexEpoch, which
+     * invalidates all lists at once; a stale list is rebuilt by one display
+     * list walk the next time its tag is searched for.
+     */
+
+    Tcl_HashTable tagIndexTable;/* Maps tag uid -> TagIndexList. */
+    unsigned long tagIndexEpoch;/* Current tag index generation. */
+
+    /*
+     * Retained layer cache. Items may be assigned to layers 1..7 with the
+     * [layer] widget command; layer 0 (the default) is drawn live on every
+     * display pass. Core X pixmaps carry no alpha channel, so the non-zero
+     * layers are rendered together, in layer order, into one retained pixmap
+     * that is composited beneath the live items. A frame in which only
+     * layer-0 items changed then costs a few XCopyArea calls instead of a
+     * re-rasterization of the static content.
+     */
+
+#define TK_CANVAS_MAX_LAYERS 8
+    Tcl_HashTable layerTable;	/* Maps item ptr -> layer number; items with
+				 * no entry are on layer 0. */
+    int numLayerItems;		/* Number of items on layers > 0. */
+    Pixmap layerPixmap;		/* Retained rendering of all non-zero layers,
+				 * or None. */
+    int layerValid;		/* Non-zero means layerPixmap is current. */
+    int layerXOrigin, layerYOrigin;
+				/* Canvas coordinates of the top-left corner
+				 * of layerPixmap. */
+    int layerWidth, layerHeight;
+				/* Dimensions of layerPixmap. */
+
+    /*
+     * Damage accumulator for incremental redraw. Dirty areas are kept as a
+     * small list of rectangles instead of one all-encompassing bounding box,
+     * so each display pass only rasterizes and copies the areas that really
+     * changed. redrawX1..redrawY2 above still track the union of all damage
+     * for code that needs a single bounding box.
+     */
+
+#define TK_CANVAS_MAX_DAMAGE 8
+    struct {
+	int x1, y1, x2, y2;
+    } damage[TK_CANVAS_MAX_DAMAGE];
+    int numDamage;		/* Number of valid entries in damage. */
+    int numWinItems;		/* Number of window items in the canvas.  While
+				 * non-zero, scrolling cannot blit the retained
+				 * area, because copying pixels does not move
+				 * child windows. */
+
+    /*
+     * Per-canvas memory pool (see tkCanvUtil.c). Item records and small
+     * coordinate arrays are carved out of arena chunks and recycled through
+     * per-size free lists, then released in one shot when the canvas is
+     * destroyed. This avoids heap fragmentation and allocator overhead when
+     * large scenes are loaded or edited.
+     */
+
+#define TK_CANVAS_POOL_GRAIN	16	/* Size-class granularity, bytes. */
+#define TK_CANVAS_POOL_NCLASSES	32	/* Number of size classes; larger
+					 * blocks fall through to ckalloc. */
+    struct TkCanvasPoolChunk *poolChunkPtr;
+				/* Chain of arena chunks, newest first. */
+    char *poolFreeByte;		/* First unused byte in the newest chunk. */
+    size_t poolBytesLeft;	/* Unused bytes in the newest chunk. */
+    void *poolFreeLists[TK_CANVAS_POOL_NCLASSES];
+				/* Recycled blocks, indexed by size class. */
+
     /*
      * Additional information, added by the 'dash'-patch
      */
@@ -285,6 +412,16 @@ typedef struct TkCanvas {
 
 #define FORCE_REDRAW		8
 
+/*
+ * LOD_COLLAPSED -		1 means that the item is currently being
+ *				rendered as a level-of-detail point; kept as
+ *				per-item state so the threshold can apply
+ *				hysteresis and items do not flicker between
+ *				representations at the boundary.
+ */
+
+#define LOD_COLLAPSED		4
+
 /*
  * Canvas-related functions that are shared among Tk modules but not exported
  * to the outside world:
@@ -295,6 +432,13 @@ MODULE_SCOPE int	TkCanvPostscriptObjCmd(TkCanvas *canvasPtr,
 MODULE_SCOPE int 	TkCanvTranslatePath(TkCanvas *canvPtr,
 			    int numVertex, double *coordPtr, int closed,
 			    XPoint *outPtr);
+MODULE_SCOPE int	TkCanvasGetCoords(Tcl_Interp *interp,
+			    Tk_Canvas canvas, Tcl_Size objc,
+			    Tcl_Obj *const objv[], double *coordPtr);
+MODULE_SCOPE void	TkCanvasPoolInit(TkCanvas *canvasPtr);
+MODULE_SCOPE void	TkCanvasPoolDrain(TkCanvas *canvasPtr);
+MODULE_SCOPE void *	TkCanvasPoolAlloc(Tk_Canvas canvas, size_t size);
+MODULE_SCOPE void	TkCanvasPoolFree(Tk_Canvas canvas, void *ptr);
 /*
  * Standard item types provided by Tk:
  */
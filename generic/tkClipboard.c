@@ -21,6 +21,9 @@
 
 static Tcl_Size	ClipboardAppHandler(void *clientData,
 			    Tcl_Size offset, char *buffer, Tcl_Size maxBytes);
+static int		ClipboardAppendObj(Tcl_Interp *interp,
+			    Tk_Window tkwin, Atom type, Atom format,
+			    Tcl_Obj *objPtr);
 static Tcl_Size	ClipboardHandler(void *clientData,
 			    Tcl_Size offset, char *buffer, Tcl_Size maxBytes);
 static Tcl_Size	ClipboardWindowHandler(void *clientData,
@@ -64,10 +67,19 @@ ClipboardHandler(
     Tcl_Size length, freeCount;
 
     /*
-     * Skip to buffer containing offset byte
+     * Skip to the buffer containing the offset byte. Requestors fetch
+     * large selections in chunks of increasing offsets, so resume the
+     * scan where the previous request left off when possible.
      */
 
-    for (cbPtr = targetPtr->firstBufferPtr; ; cbPtr = cbPtr->nextPtr) {
+    if ((targetPtr->reqBufferPtr != NULL)
+	    && (offset >= targetPtr->reqScanned)) {
+	cbPtr = targetPtr->reqBufferPtr;
+	scanned = targetPtr->reqScanned;
+    } else {
+	cbPtr = targetPtr->firstBufferPtr;
+    }
+    for ( ; ; cbPtr = cbPtr->nextPtr) {
 	if (cbPtr == NULL) {
 	    return 0;
 	}
@@ -76,6 +88,8 @@ ClipboardHandler(
 	}
 	scanned += cbPtr->length;
     }
+    targetPtr->reqBufferPtr = cbPtr;
+    targetPtr->reqScanned = scanned;
 
     /*
      * Copy up to maxBytes or end of list, switching buffers as needed.
@@ -266,7 +280,7 @@ Tk_ClipboardClear(
 	    targetPtr = nextTargetPtr) {
 	for (cbPtr = targetPtr->firstBufferPtr; cbPtr != NULL;
 		cbPtr = nextCbPtr) {
-	    ckfree(cbPtr->buffer);
+	    Tcl_DecrRefCount(cbPtr->objPtr);
 	    nextCbPtr = cbPtr->nextPtr;
 	    ckfree(cbPtr);
 	}
@@ -327,6 +341,28 @@ Tk_ClipboardAppend(
 				 * should be returned to the requestor. */
     const char *buffer)		/* NULL terminated string containing the data
 				 * to be added to the clipboard. */
+{
+    Tcl_Obj *objPtr = Tcl_NewStringObj(buffer, TCL_INDEX_NONE);
+    int result;
+
+    Tcl_IncrRefCount(objPtr);
+    result = ClipboardAppendObj(interp, tkwin, type, format, objPtr);
+    Tcl_DecrRefCount(objPtr);
+    return result;
+}
+
+static int
+ClipboardAppendObj(
+    Tcl_Interp *interp,		/* Used for error reporting. */
+    Tk_Window tkwin,		/* Window that selects a display. */
+    Atom type,			/* The desired conversion type for this
+				 * clipboard item, e.g. STRING or LENGTH. */
+    Atom format,		/* Format in which the selection information
+				 * should be returned to the requestor. */
+    Tcl_Obj *objPtr)		/* Object containing the data to be added to
+				 * the clipboard. A reference is kept until
+				 * the clipboard is cleared, so the data is
+				 * stored without copying it. */
 {
     TkWindow *winPtr = (TkWindow *) tkwin;
     TkDisplay *dispPtr = winPtr->dispPtr;
@@ -363,6 +399,8 @@ Tk_ClipboardAppend(
 	targetPtr->type = type;
 	targetPtr->format = format;
 	targetPtr->firstBufferPtr = targetPtr->lastBufferPtr = NULL;
+	targetPtr->reqBufferPtr = NULL;
+	targetPtr->reqScanned = 0;
 	targetPtr->nextPtr = dispPtr->clipTargetPtr;
 	dispPtr->clipTargetPtr = targetPtr;
 	Tk_CreateSelHandler(dispPtr->clipWindow, dispPtr->clipboardAtom,
@@ -390,9 +428,9 @@ Tk_ClipboardAppend(
     }
     targetPtr->lastBufferPtr = cbPtr;
 
-    cbPtr->length = strlen(buffer);
-    cbPtr->buffer = (char *)ckalloc(cbPtr->length + 1);
-    strcpy(cbPtr->buffer, buffer);
+    cbPtr->objPtr = objPtr;
+    Tcl_IncrRefCount(objPtr);
+    cbPtr->buffer = Tcl_GetStringFromObj(objPtr, &cbPtr->length);
 
     TkSelUpdateClipboard((TkWindow *) dispPtr->clipWindow, targetPtr);
 
@@ -515,8 +553,7 @@ Tk_ClipboardObjCmd(
 	} else {
 	    format = XA_STRING;
 	}
-	return Tk_ClipboardAppend(interp, tkwin, target, format,
-		Tcl_GetString(objv[i]));
+	return ClipboardAppendObj(interp, tkwin, target, format, objv[i]);
     }
     case CLIPBOARD_CLEAR: {
 	static const char *const clearOptionStrings[] = { "-displayof", NULL };
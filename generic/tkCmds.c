@@ -38,10 +38,24 @@ static int		AppnameCmd(void *dummy, Tcl_Interp *interp,
 			    Tcl_Size objc, Tcl_Obj *const *objv);
 static int		CaretCmd(void *dummy, Tcl_Interp *interp,
 			    Tcl_Size objc, Tcl_Obj *const *objv);
+static int		EventstatsCmd(void *dummy, Tcl_Interp *interp,
+			    Tcl_Size objc, Tcl_Obj *const *objv);
+static int		FrameclockCmd(void *dummy, Tcl_Interp *interp,
+			    Tcl_Size objc, Tcl_Obj *const *objv);
+static int		GcstatsCmd(void *dummy, Tcl_Interp *interp,
+			    Tcl_Size objc, Tcl_Obj *const *objv);
 static int		InactiveCmd(void *dummy, Tcl_Interp *interp,
 			    Tcl_Size objc, Tcl_Obj *const *objv);
+static int		MemstatsCmd(void *dummy, Tcl_Interp *interp,
+			    Tcl_Size objc, Tcl_Obj *const *objv);
+static int		PaintstatsCmd(void *dummy, Tcl_Interp *interp,
+			    Tcl_Size objc, Tcl_Obj *const *objv);
+static int		PreloadCmd(void *dummy, Tcl_Interp *interp,
+			    Tcl_Size objc, Tcl_Obj *const *objv);
 static int		ScalingCmd(void *dummy, Tcl_Interp *interp,
 			    Tcl_Size objc, Tcl_Obj *const *objv);
+static int		StartupstatsCmd(void *dummy, Tcl_Interp *interp,
+			    Tcl_Size objc, Tcl_Obj *const *objv);
 static int		UseinputmethodsCmd(void *dummy,
 			    Tcl_Interp *interp, Tcl_Size objc,
 			    Tcl_Obj *const *objv);
@@ -64,8 +78,15 @@ static const TkEnsemble tkCmdMap[] = {
     {"appname",		AppnameCmd, NULL },
     {"busy",		Tk_BusyObjCmd, NULL },
     {"caret",		CaretCmd, NULL },
+    {"eventstats",	EventstatsCmd, NULL },
+    {"frameclock",	FrameclockCmd, NULL },
+    {"gcstats",		GcstatsCmd, NULL },
     {"inactive",	InactiveCmd, NULL },
+    {"memstats",	MemstatsCmd, NULL },
+    {"paintstats",	PaintstatsCmd, NULL },
+    {"preload",		PreloadCmd, NULL },
     {"scaling",		ScalingCmd, NULL },
+    {"startupstats",	StartupstatsCmd, NULL },
     {"useinputmethods",	UseinputmethodsCmd, NULL },
     {"windowingsystem",	WindowingsystemCmd, NULL },
     {NULL, NULL, NULL}
@@ -537,32 +558,37 @@ Tk_LowerObjCmd(
 {
     Tk_Window mainwin = (Tk_Window)clientData;
     Tk_Window tkwin, other;
+    int batch = 0, i = 1;
 
-    if ((objc != 2) && (objc != 3)) {
-	Tcl_WrongNumArgs(interp, 1, objv, "window ?belowThis?");
+    if ((objc > 1) && (strcmp(Tcl_GetString(objv[1]), "-batch") == 0)) {
+	batch = 1;
+	i = 2;
+    }
+    if ((objc - i != 1) && (objc - i != 2)) {
+	Tcl_WrongNumArgs(interp, 1, objv, "?-batch? window ?belowThis?");
 	return TCL_ERROR;
     }
 
-    tkwin = Tk_NameToWindow(interp, Tcl_GetString(objv[1]), mainwin);
+    tkwin = Tk_NameToWindow(interp, Tcl_GetString(objv[i]), mainwin);
     if (tkwin == NULL) {
 	return TCL_ERROR;
     }
-    if (objc == 2) {
+    if (objc - i == 1) {
 	other = NULL;
     } else {
-	other = Tk_NameToWindow(interp, Tcl_GetString(objv[2]), mainwin);
+	other = Tk_NameToWindow(interp, Tcl_GetString(objv[i+1]), mainwin);
 	if (other == NULL) {
 	    return TCL_ERROR;
 	}
     }
-    if (Tk_RestackWindow(tkwin, Below, other) != TCL_OK) {
+    if (TkRestackWindow(tkwin, Below, other, batch) != TCL_OK) {
 	if (other) {
 	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
 		    "can't lower \"%s\" below \"%s\"",
-		    Tcl_GetString(objv[1]), Tcl_GetString(objv[2])));
+		    Tcl_GetString(objv[i]), Tcl_GetString(objv[i+1])));
 	} else {
 	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
-		    "can't lower \"%s\" to bottom", Tcl_GetString(objv[1])));
+		    "can't lower \"%s\" to bottom", Tcl_GetString(objv[i])));
 	}
 	Tcl_SetErrorCode(interp, "TK", "RESTACK", "LOWER", NULL);
 	return TCL_ERROR;
@@ -596,32 +622,37 @@ Tk_RaiseObjCmd(
 {
     Tk_Window mainwin = (Tk_Window)clientData;
     Tk_Window tkwin, other;
+    int batch = 0, i = 1;
 
-    if ((objc != 2) && (objc != 3)) {
-	Tcl_WrongNumArgs(interp, 1, objv, "window ?aboveThis?");
+    if ((objc > 1) && (strcmp(Tcl_GetString(objv[1]), "-batch") == 0)) {
+	batch = 1;
+	i = 2;
+    }
+    if ((objc - i != 1) && (objc - i != 2)) {
+	Tcl_WrongNumArgs(interp, 1, objv, "?-batch? window ?aboveThis?");
 	return TCL_ERROR;
     }
 
-    tkwin = Tk_NameToWindow(interp, Tcl_GetString(objv[1]), mainwin);
+    tkwin = Tk_NameToWindow(interp, Tcl_GetString(objv[i]), mainwin);
     if (tkwin == NULL) {
 	return TCL_ERROR;
     }
-    if (objc == 2) {
+    if (objc - i == 1) {
 	other = NULL;
     } else {
-	other = Tk_NameToWindow(interp, Tcl_GetString(objv[2]), mainwin);
+	other = Tk_NameToWindow(interp, Tcl_GetString(objv[i+1]), mainwin);
 	if (other == NULL) {
 	    return TCL_ERROR;
 	}
     }
-    if (Tk_RestackWindow(tkwin, Above, other) != TCL_OK) {
+    if (TkRestackWindow(tkwin, Above, other, batch) != TCL_OK) {
 	if (other) {
 	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
 		    "can't raise \"%s\" above \"%s\"",
-		    Tcl_GetString(objv[1]), Tcl_GetString(objv[2])));
+		    Tcl_GetString(objv[i]), Tcl_GetString(objv[i+1])));
 	} else {
 	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
-		    "can't raise \"%s\" to top", Tcl_GetString(objv[1])));
+		    "can't raise \"%s\" to top", Tcl_GetString(objv[i])));
 	}
 	Tcl_SetErrorCode(interp, "TK", "RESTACK", "RAISE", NULL);
 	return TCL_ERROR;
@@ -664,7 +695,9 @@ TkInitTkCmd(
 /*
  *----------------------------------------------------------------------
  *
- * AppnameCmd, CaretCmd, ScalingCmd, UseinputmethodsCmd,
+ * AppnameCmd, CaretCmd, EventstatsCmd, FrameclockCmd, GcstatsCmd,
+ * MemstatsCmd, PaintstatsCmd, PreloadCmd, ScalingCmd,
+ * StartupstatsCmd, UseinputmethodsCmd,
  * WindowingsystemCmd, InactiveCmd --
  *
  *	These functions are invoked to process the "tk" ensemble subcommands.
@@ -803,6 +836,98 @@ CaretCmd(
     return TCL_OK;
 }
 
+int
+EventstatsCmd(
+    TCL_UNUSED(void *),		/* Main window associated with interpreter. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    Tcl_Size objc,		/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    Tcl_Obj *resultObj;
+
+    if (objc == 2) {
+	const char *arg = Tcl_GetString(objv[1]);
+
+	if (strcmp(arg, "reset") != 0) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "bad option \"%s\": must be reset", arg));
+	    Tcl_SetErrorCode(interp, "TK", "EVENTSTATS", NULL);
+	    return TCL_ERROR;
+	}
+	TkEventResetStats();
+	TkPointerResetStats();
+	return TCL_OK;
+    }
+    if (objc != 1) {
+	Tcl_WrongNumArgs(interp, 1, objv, "?reset?");
+	return TCL_ERROR;
+    }
+    resultObj = TkEventGetStatsObj();
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("pointer", TCL_INDEX_NONE),
+	    TkPointerGetStatsObj());
+    Tcl_SetObjResult(interp, resultObj);
+    return TCL_OK;
+}
+
+int
+FrameclockCmd(
+    TCL_UNUSED(void *),		/* Main window associated with interpreter. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    Tcl_Size objc,		/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    int boolVal;
+
+    if (objc == 1) {
+	Tcl_SetObjResult(interp, Tcl_NewBooleanObj(TkFrameClockGet()));
+	return TCL_OK;
+    }
+    if (strcmp(Tcl_GetString(objv[1]), "callback") == 0) {
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "script");
+	    return TCL_ERROR;
+	}
+	TkFrameClockAddCallback(interp, objv[2]);
+	return TCL_OK;
+    }
+    if (strcmp(Tcl_GetString(objv[1]), "interval") == 0) {
+	if (objc == 3) {
+	    int interval;
+
+	    if (Tcl_GetIntFromObj(interp, objv[2], &interval) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    if (interval <= 0) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj(
+			"frame interval must be a positive integer",
+			TCL_INDEX_NONE));
+		Tcl_SetErrorCode(interp, "TK", "FRAMECLOCK", "INTERVAL",
+			NULL);
+		return TCL_ERROR;
+	    }
+	    TkFrameClockSetInterval(interval);
+	} else if (objc != 2) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "?milliseconds?");
+	    return TCL_ERROR;
+	}
+	Tcl_SetObjResult(interp,
+		Tcl_NewWideIntObj(TkFrameClockGetInterval()));
+	return TCL_OK;
+    }
+    if (objc != 2) {
+	Tcl_WrongNumArgs(interp, 1, objv,
+		"?boolean? ?callback script? ?interval ?milliseconds??");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetBooleanFromObj(interp, objv[1], &boolVal) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    TkFrameClockSet(boolVal);
+    Tcl_SetObjResult(interp, Tcl_NewBooleanObj(TkFrameClockGet()));
+    return TCL_OK;
+}
+
 int
 ScalingCmd(
     void *clientData,		/* Main window associated with interpreter. */
@@ -847,6 +972,7 @@ ScalingCmd(
 	}
 	WidthMMOfScreen(screenPtr) = width;
 	HeightMMOfScreen(screenPtr) = height;
+	TkScalingChanged();
 
 	/*
 	 * Keep the variables ::tk::scalingPct and ::tk::svgFmt
@@ -876,6 +1002,205 @@ ScalingCmd(
     return TCL_OK;
 }
 
+int
+MemstatsCmd(
+    void *clientData,		/* Main window associated with interpreter. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    Tcl_Size objc,		/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    TkDisplay *dispPtr = ((TkWindow *) clientData)->dispPtr;
+    Tcl_Obj *statsObj;
+
+    if (objc == 2) {
+	const char *arg = Tcl_GetString(objv[1]);
+
+	if (strcmp(arg, "reset") != 0) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "bad option \"%s\": must be reset", arg));
+	    Tcl_SetErrorCode(interp, "TK", "MEMSTATS", NULL);
+	    return TCL_ERROR;
+	}
+	TkMemResetStats();
+	dispPtr->bitmapCacheHits = dispPtr->bitmapCacheMisses = 0;
+	dispPtr->cursorCacheHits = dispPtr->cursorCacheMisses = 0;
+	return TCL_OK;
+    }
+    if (objc != 1) {
+	Tcl_WrongNumArgs(interp, 1, objv, "?reset?");
+	return TCL_ERROR;
+    }
+    statsObj = TkMemGetStatsObj();
+    Tcl_DictObjPut(NULL, statsObj,
+	    Tcl_NewStringObj("bitmapCache", TCL_INDEX_NONE),
+	    TkBitmapCacheStatsObj(dispPtr));
+    Tcl_DictObjPut(NULL, statsObj,
+	    Tcl_NewStringObj("cursorCache", TCL_INDEX_NONE),
+	    TkCursorCacheStatsObj(dispPtr));
+    Tcl_SetObjResult(interp, statsObj);
+    return TCL_OK;
+}
+
+int
+PaintstatsCmd(
+    TCL_UNUSED(void *),		/* Main window associated with interpreter. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    Tcl_Size objc,		/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    int boolVal;
+
+    if (objc == 1) {
+	Tcl_SetObjResult(interp, TkPaintGetStatsObj());
+	return TCL_OK;
+    }
+    if (strcmp(Tcl_GetString(objv[1]), "flash") == 0) {
+	if (objc == 3) {
+	    if (Tcl_GetBooleanFromObj(interp, objv[2], &boolVal) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    TkPaintSetFlash(boolVal);
+	} else if (objc != 2) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "?boolean?");
+	    return TCL_ERROR;
+	}
+	Tcl_SetObjResult(interp, Tcl_NewBooleanObj(TkPaintGetFlash()));
+	return TCL_OK;
+    }
+    if (objc != 2) {
+	Tcl_WrongNumArgs(interp, 1, objv,
+		"?reset? ?flash ?boolean?? ?boolean?");
+	return TCL_ERROR;
+    }
+    if (strcmp(Tcl_GetString(objv[1]), "reset") == 0) {
+	TkPaintResetStats();
+	return TCL_OK;
+    }
+    if (Tcl_GetBooleanFromObj(interp, objv[1], &boolVal) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    TkPaintSetRecording(boolVal);
+    Tcl_SetObjResult(interp, Tcl_NewBooleanObj(boolVal));
+    return TCL_OK;
+}
+
+int
+PreloadCmd(
+    void *clientData,		/* Main window associated with interpreter. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    Tcl_Size objc,		/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    Tk_Window tkwin = (Tk_Window)clientData;
+    TkDisplay *dispPtr;
+    Tcl_Size skip, numNames, i;
+    Tcl_Obj **namePtrs;
+    const char *type;
+    int j;
+
+    skip = TkGetDisplayOf(interp, objc - 1, objv + 1, &tkwin);
+    if (skip < 0) {
+	return TCL_ERROR;
+    }
+    if (objc - skip != 3) {
+	Tcl_WrongNumArgs(interp, 1, objv,
+		"?-displayof window? cursors|bitmaps nameList");
+	return TCL_ERROR;
+    }
+    dispPtr = ((TkWindow *) tkwin)->dispPtr;
+    type = Tcl_GetString(objv[1 + skip]);
+    if (Tcl_ListObjGetElements(interp, objv[2 + skip], &numNames,
+	    &namePtrs) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (strcmp(type, "cursors") == 0) {
+	for (i = 0; i < numNames; i++) {
+	    Tk_Cursor cursor = Tk_GetCursor(interp, tkwin,
+		    Tk_GetUid(Tcl_GetString(namePtrs[i])));
+
+	    if (cursor == NULL) {
+		return TCL_ERROR;
+	    }
+
+	    /*
+	     * Keep the reference that warms the cache: releasing it would
+	     * free the cursor again. A name that was already preloaded
+	     * keeps its original reference only.
+	     */
+
+	    for (j = 0; j < dispPtr->numPreloadCursors; j++) {
+		if (dispPtr->preloadCursors[j] == cursor) {
+		    break;
+		}
+	    }
+	    if (j < dispPtr->numPreloadCursors) {
+		Tk_FreeCursor(dispPtr->display, cursor);
+		continue;
+	    }
+	    if (dispPtr->numPreloadCursors == 0) {
+		dispPtr->preloadCursors = (Tk_Cursor *)
+			ckalloc(sizeof(Tk_Cursor));
+	    } else {
+		dispPtr->preloadCursors = (Tk_Cursor *)ckrealloc(
+			dispPtr->preloadCursors,
+			(dispPtr->numPreloadCursors + 1)
+			* sizeof(Tk_Cursor));
+	    }
+	    dispPtr->preloadCursors[dispPtr->numPreloadCursors] = cursor;
+	    dispPtr->numPreloadCursors++;
+	}
+    } else if (strcmp(type, "bitmaps") == 0) {
+	for (i = 0; i < numNames; i++) {
+	    Pixmap bitmap = Tk_GetBitmap(interp, tkwin,
+		    Tcl_GetString(namePtrs[i]));
+
+	    if (bitmap == None) {
+		return TCL_ERROR;
+	    }
+	    for (j = 0; j < dispPtr->numPreloadBitmaps; j++) {
+		if (dispPtr->preloadBitmaps[j] == bitmap) {
+		    break;
+		}
+	    }
+	    if (j < dispPtr->numPreloadBitmaps) {
+		Tk_FreeBitmap(dispPtr->display, bitmap);
+		continue;
+	    }
+	    if (dispPtr->numPreloadBitmaps == 0) {
+		dispPtr->preloadBitmaps = (Pixmap *)ckalloc(sizeof(Pixmap));
+	    } else {
+		dispPtr->preloadBitmaps = (Pixmap *)ckrealloc(
+			dispPtr->preloadBitmaps,
+			(dispPtr->numPreloadBitmaps + 1) * sizeof(Pixmap));
+	    }
+	    dispPtr->preloadBitmaps[dispPtr->numPreloadBitmaps] = bitmap;
+	    dispPtr->numPreloadBitmaps++;
+	}
+    } else {
+	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		"bad resource type \"%s\": must be bitmaps or cursors",
+		type));
+	Tcl_SetErrorCode(interp, "TK", "PRELOAD", "TYPE", NULL);
+	return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+int
+StartupstatsCmd(
+    TCL_UNUSED(void *),		/* Main window associated with interpreter. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    Tcl_Size objc,		/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    if (objc != 1) {
+	Tcl_WrongNumArgs(interp, 1, objv, NULL);
+	return TCL_ERROR;
+    }
+    Tcl_SetObjResult(interp, TkGetStartupPhasesObj());
+    return TCL_OK;
+}
+
 int
 UseinputmethodsCmd(
     void *clientData,		/* Main window associated with interpreter. */
@@ -946,6 +1271,55 @@ WindowingsystemCmd(
     return TCL_OK;
 }
 
+int
+GcstatsCmd(
+    void *clientData,		/* Main window associated with interpreter. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    Tcl_Size objc,		/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    Tk_Window tkwin = (Tk_Window)clientData;
+    TkDisplay *dispPtr;
+    Tcl_Size skip;
+
+    skip = TkGetDisplayOf(interp, objc - 1, objv + 1, &tkwin);
+    if (skip < 0) {
+	return TCL_ERROR;
+    }
+    dispPtr = ((TkWindow *) tkwin)->dispPtr;
+    if (objc == 1 + skip) {
+	Tcl_SetObjResult(interp, TkGCGetStatsObj(dispPtr));
+	return TCL_OK;
+    }
+    if (strcmp(Tcl_GetString(objv[1 + skip]), "limit") == 0) {
+	if (objc == 3 + skip) {
+	    int limit;
+
+	    if (Tcl_GetIntFromObj(interp, objv[2 + skip], &limit) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    if (limit < 0) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj(
+			"GC idle limit must be non-negative",
+			TCL_INDEX_NONE));
+		Tcl_SetErrorCode(interp, "TK", "GCSTATS", "LIMIT", NULL);
+		return TCL_ERROR;
+	    }
+	    TkGCSetIdleLimit(dispPtr, limit);
+	} else if (objc != 2 + skip) {
+	    Tcl_WrongNumArgs(interp, 1, objv,
+		    "?-displayof window? limit ?count?");
+	    return TCL_ERROR;
+	}
+	Tcl_SetObjResult(interp,
+		Tcl_NewWideIntObj(TkGCGetIdleLimit(dispPtr)));
+	return TCL_OK;
+    }
+    Tcl_WrongNumArgs(interp, 1, objv,
+	    "?-displayof window? ?limit ?count??");
+    return TCL_ERROR;
+}
+
 int
 InactiveCmd(
     void *clientData,		/* Main window associated with interpreter. */
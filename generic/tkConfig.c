@@ -48,6 +48,14 @@
 typedef struct {
     int initialized;		/* 0 means table below needs initializing. */
     Tcl_HashTable hashTable;
+    Tcl_HashTable valueObjCache;/* Maps option database value Uids to shared
+				 * Tcl_Objs holding that string, so that
+				 * initializing many widgets from the same
+				 * database entries does not allocate a fresh
+				 * object per widget (see Tk_InitOptions).
+				 * The objects live for the thread's
+				 * lifetime; Uids are immutable so entries
+				 * never need invalidating. */
 } ThreadSpecificData;
 static Tcl_ThreadDataKey dataKey;
 
@@ -119,6 +127,10 @@ typedef struct OptionTable {
 				 * chain. */
     size_t numOptions;		/* The number of items in the options array
 				 * below. */
+    Tcl_HashTable nameTable;	/* Maps full option names (including synonyms)
+				 * to entries in the options array, so that
+				 * exact-name lookups bypass the abbreviation
+				 * scan in GetOption. */
     Option options[1];		/* Information about the individual options in
 				 * the table. This must be the last field in
 				 * the structure: the actual size of the array
@@ -134,6 +146,7 @@ static int		DoObjConfig(Tcl_Interp *interp, void *recordPtr,
 			    Tk_Window tkwin, Tk_SavedOption *savePtr);
 static void		FreeResources(Option *optionPtr, Tcl_Obj *objPtr,
 			    void *internalPtr, Tk_Window tkwin);
+static Tcl_Obj *	GetCachedValueObj(Tk_Uid value);
 static Tcl_Obj *	GetConfigList(void *recordPtr,
 			    Option *optionPtr, Tk_Window tkwin);
 static Tcl_Obj *	GetObjectForOption(void *recordPtr,
@@ -207,6 +220,7 @@ Tk_CreateOptionTable(
 
     if (!tsdPtr->initialized) {
 	Tcl_InitHashTable(&tsdPtr->hashTable, TCL_ONE_WORD_KEYS);
+	Tcl_InitHashTable(&tsdPtr->valueObjCache, TCL_ONE_WORD_KEYS);
 	tsdPtr->initialized = 1;
     }
 
@@ -237,6 +251,7 @@ Tk_CreateOptionTable(
     tablePtr->hashEntryPtr = hashEntryPtr;
     tablePtr->nextPtr = NULL;
     tablePtr->numOptions = numOptions;
+    Tcl_InitHashTable(&tablePtr->nameTable, TCL_STRING_KEYS);
 
     /*
      * Initialize all of the Option structures in the table.
@@ -304,6 +319,15 @@ Tk_CreateOptionTable(
 		|| (specPtr->type == TK_OPTION_CUSTOM)) {
 	    optionPtr->flags |= OPTION_NEEDS_FREEING;
 	}
+
+	/*
+	 * Enter the full option name (synonyms included) in the exact-match
+	 * table. Names are unique within one template, so newEntry isn't
+	 * interesting here.
+	 */
+
+	Tcl_SetHashValue(Tcl_CreateHashEntry(&tablePtr->nameTable,
+		specPtr->optionName, &newEntry), optionPtr);
     }
     tablePtr->hashEntryPtr = hashEntryPtr;
     Tcl_SetHashValue(hashEntryPtr, tablePtr);
@@ -367,10 +391,58 @@ Tk_DeleteOptionTable(
 	    Tcl_DecrRefCount(optionPtr->extra.monoColorPtr);
 	}
     }
+    Tcl_DeleteHashTable(&tablePtr->nameTable);
     Tcl_DeleteHashEntry(tablePtr->hashEntryPtr);
     ckfree(tablePtr);
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * GetCachedValueObj --
+ *
+ *	Return a shared Tcl_Obj holding the given option database value.
+ *	Values are interned Uids, so one object per distinct value is kept
+ *	for the thread's lifetime and handed out to every widget that is
+ *	initialized from the same database entry.
+ *
+ * Results:
+ *	A Tcl_Obj with the value as its string representation. The cache
+ *	holds one reference; callers treat the object as they would any
+ *	shared value (bump the refcount to keep it).
+ *
+ * Side effects:
+ *	May add an entry to the thread's value object cache.
+ *
+ *--------------------------------------------------------------
+ */
+
+static Tcl_Obj *
+GetCachedValueObj(
+    Tk_Uid value)		/* Option database value. */
+{
+    Tcl_HashEntry *hashEntryPtr;
+    int newEntry;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (!tsdPtr->initialized) {
+	Tcl_InitHashTable(&tsdPtr->hashTable, TCL_ONE_WORD_KEYS);
+	Tcl_InitHashTable(&tsdPtr->valueObjCache, TCL_ONE_WORD_KEYS);
+	tsdPtr->initialized = 1;
+    }
+
+    hashEntryPtr = Tcl_CreateHashEntry(&tsdPtr->valueObjCache, value,
+	    &newEntry);
+    if (newEntry) {
+	Tcl_Obj *objPtr = Tcl_NewStringObj(value, TCL_INDEX_NONE);
+
+	Tcl_IncrRefCount(objPtr);
+	Tcl_SetHashValue(hashEntryPtr, objPtr);
+    }
+    return (Tcl_Obj *)Tcl_GetHashValue(hashEntryPtr);
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -460,7 +532,7 @@ Tk_InitOptions(
 	    value = Tk_GetOption(tkwin, optionPtr->dbNameUID,
 		    optionPtr->dbClassUID);
 	    if (value != NULL) {
-		valuePtr = Tcl_NewStringObj(value, TCL_INDEX_NONE);
+		valuePtr = GetCachedValueObj(value);
 		source = OPTION_DATABASE;
 	    }
 	}
@@ -1161,6 +1233,21 @@ GetOption(
      *    careful to distinguish this case from an ambiguous abbreviation.
      */
 
+    /*
+     * Fast path: an exact name match in the first table of the chain that
+     * knows the name. This preserves the rule that the same name appearing
+     * in several tables resolves to the first table's entry.
+     */
+
+    for (tablePtr2 = tablePtr; tablePtr2 != NULL;
+	    tablePtr2 = tablePtr2->nextPtr) {
+	Tcl_HashEntry *hPtr = Tcl_FindHashEntry(&tablePtr2->nameTable, name);
+
+	if (hPtr != NULL) {
+	    return (Option *)Tcl_GetHashValue(hPtr);
+	}
+    }
+
     bestPtr = NULL;
     for (tablePtr2 = tablePtr; tablePtr2 != NULL;
 	    tablePtr2 = tablePtr2->nextPtr) {
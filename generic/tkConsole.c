@@ -25,6 +25,16 @@ typedef struct ConsoleInfo {
     Tcl_Interp *consoleInterp;	/* Interpreter displaying the console. */
     Tcl_Interp *interp;		/* Interpreter controlled by console. */
     size_t refCount;
+    Tcl_Obj *pendingPtr;	/* List of alternating dest/string pairs of
+				 * output not yet handed to the console, or
+				 * NULL.  Holds one reference. */
+    Tcl_Obj *pendingTailPtr;	/* Last string element of pendingPtr, for
+				 * merging consecutive writes to the same
+				 * destination.  No reference held. */
+    int pendingType;		/* TCL_STDOUT or TCL_STDERR: destination of
+				 * pendingTailPtr. */
+    int flushScheduled;		/* Non-zero means ConsoleFlushProc has been
+				 * scheduled for the pending output. */
 } ConsoleInfo;
 
 /*
@@ -47,6 +57,7 @@ static int	ConsoleClose(void *instanceData, Tcl_Interp *interp);
 static int	Console2Close(void *instanceData, Tcl_Interp *interp, int flags);
 static void	ConsoleDeleteProc(void *clientData);
 static void	ConsoleEventProc(void *clientData, XEvent *eventPtr);
+static void	ConsoleFlushProc(void *clientData);
 static int	ConsoleHandle(void *instanceData, int direction,
 		    void **handlePtr);
 static int	ConsoleInput(void *instanceData, char *buf, int toRead,
@@ -260,6 +271,9 @@ Tk_InitConsoleChannels(
     info->consoleInterp = NULL;
     info->interp = NULL;
     info->refCount = 0;
+    info->pendingPtr = NULL;
+    info->pendingTailPtr = NULL;
+    info->flushScheduled = 0;
 
     if (doIn) {
 	ChannelData *data = (ChannelData *)ckalloc(sizeof(ChannelData));
@@ -380,6 +394,9 @@ Tk_CreateConsoleWindow(
 
 	    info = (ConsoleInfo *)ckalloc(sizeof(ConsoleInfo));
 	    info->refCount = 0;
+	    info->pendingPtr = NULL;
+	    info->pendingTailPtr = NULL;
+	    info->flushScheduled = 0;
 
 	    /*
 	     * Update any console channels to make use of the new console.
@@ -410,6 +427,9 @@ Tk_CreateConsoleWindow(
     } else {
 	info = (ConsoleInfo *)ckalloc(sizeof(ConsoleInfo));
 	info->refCount = 0;
+	info->pendingPtr = NULL;
+	info->pendingTailPtr = NULL;
+	info->flushScheduled = 0;
     }
 
     info->consoleInterp = consoleInterp;
@@ -481,12 +501,18 @@ Tk_CreateConsoleWindow(
  *	Writes the given output on the IO channel. Returns count of how many
  *	characters were actually written, and an error indication.
  *
+ *	The output is not displayed here: it is appended to the console's
+ *	pending batch and handed to the console interpreter in a single
+ *	[tk::ConsoleFlush] call once the event loop goes idle.  A loop that
+ *	writes line by line therefore costs one text widget insert per
+ *	event-loop cycle instead of one per write.
+ *
  * Results:
  *	A count of how many characters were written is returned and an error
  *	indication is returned in an output argument.
  *
  * Side effects:
- *	Writes output on the actual channel.
+ *	Accumulates output and may schedule an idle call to display it.
  *
  *----------------------------------------------------------------------
  */
@@ -519,27 +545,92 @@ ConsoleOutput(
 
 	    const char *bytes = Tcl_ExternalToUtfDString(utf8, buf, toWrite, &ds);
 	    Tcl_Size numBytes = Tcl_DStringLength(&ds);
-	    Tcl_Obj *cmd = Tcl_NewStringObj("tk::ConsoleOutput", TCL_INDEX_NONE);
 
 	    Tcl_FreeEncoding(utf8);
 
-	    if (data->type == TCL_STDERR) {
-		Tcl_ListObjAppendElement(NULL, cmd,
-			Tcl_NewStringObj("stderr", TCL_INDEX_NONE));
+	    if ((info->pendingPtr != NULL)
+		    && (info->pendingType == data->type)) {
+		/*
+		 * Same destination as the previous write: extend the last
+		 * string in the batch in place.  The element is owned
+		 * solely by the pending list, which never has a string
+		 * representation before it is flushed.
+		 */
+
+		Tcl_AppendToObj(info->pendingTailPtr, bytes, numBytes);
 	    } else {
-		Tcl_ListObjAppendElement(NULL, cmd,
-			Tcl_NewStringObj("stdout", TCL_INDEX_NONE));
+		if (info->pendingPtr == NULL) {
+		    info->pendingPtr = Tcl_NewListObj(0, NULL);
+		    Tcl_IncrRefCount(info->pendingPtr);
+		}
+		Tcl_ListObjAppendElement(NULL, info->pendingPtr,
+			Tcl_NewStringObj((data->type == TCL_STDERR)
+			? "stderr" : "stdout", TCL_INDEX_NONE));
+		info->pendingTailPtr = Tcl_NewStringObj(bytes, numBytes);
+		Tcl_ListObjAppendElement(NULL, info->pendingPtr,
+			info->pendingTailPtr);
+		info->pendingType = data->type;
 	    }
-	    Tcl_ListObjAppendElement(NULL, cmd,
-		    Tcl_NewStringObj(bytes, numBytes));
 
 	    Tcl_DStringFree(&ds);
+
+	    if (!info->flushScheduled) {
+		info->flushScheduled = 1;
+		info->refCount++;
+		TkDoWhenIdle(ConsoleFlushProc, info, TK_IDLE_LAYOUT);
+	    }
+	}
+    }
+    return toWrite;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ConsoleFlushProc --
+ *
+ *	Idle callback that delivers all of the output accumulated by
+ *	ConsoleOutput since the last flush to the console interpreter as a
+ *	single [tk::ConsoleFlush] call.  Scheduled in the layout tier so
+ *	the batch is inserted before that cycle's redisplay runs.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Evaluates a script in the console interpreter; releases the
+ *	reference on the ConsoleInfo taken when the flush was scheduled.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ConsoleFlushProc(
+    void *clientData)		/* The ConsoleInfo with pending output. */
+{
+    ConsoleInfo *info = (ConsoleInfo *)clientData;
+    Tcl_Interp *consoleInterp = info->consoleInterp;
+    Tcl_Obj *pendingPtr = info->pendingPtr;
+
+    info->pendingPtr = NULL;
+    info->pendingTailPtr = NULL;
+    info->flushScheduled = 0;
+
+    if (pendingPtr) {
+	if (consoleInterp && !Tcl_InterpDeleted(consoleInterp)) {
+	    Tcl_Obj *cmd = Tcl_NewStringObj("tk::ConsoleFlush",
+		    TCL_INDEX_NONE);
+
+	    Tcl_ListObjAppendElement(NULL, cmd, pendingPtr);
 	    Tcl_IncrRefCount(cmd);
 	    Tcl_EvalObjEx(consoleInterp, cmd, TCL_EVAL_GLOBAL);
 	    Tcl_DecrRefCount(cmd);
 	}
+	Tcl_DecrRefCount(pendingPtr);
+    }
+    if (info->refCount-- <= 1) {
+	ckfree(info);
     }
-    return toWrite;
 }
 
 /*
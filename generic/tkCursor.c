@@ -251,6 +251,7 @@ TkcGetCursor(
 	for (cursorPtr = existingCursorPtr; cursorPtr != NULL;
 		cursorPtr = cursorPtr->nextPtr) {
 	    if (Tk_Display(tkwin) == cursorPtr->display) {
+		dispPtr->cursorCacheHits++;
 		cursorPtr->resourceRefCount++;
 		return cursorPtr;
 	    }
@@ -259,6 +260,7 @@ TkcGetCursor(
 	existingCursorPtr = NULL;
     }
 
+    dispPtr->cursorCacheMisses++;
     cursorPtr = TkGetCursorByName(interp, tkwin, string);
 
     if (cursorPtr == NULL) {
@@ -877,6 +879,40 @@ TkDebugCursor(
     return resultPtr;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkCursorCacheStatsObj --
+ *
+ *	Builds the cursor cache part of the value returned by [tk memstats]:
+ *	a dictionary with the keys "hits" and "misses", counting the named
+ *	cursor lookups that were satisfied from cursorNameTable and those
+ *	that had to create the cursor.
+ *
+ * Results:
+ *	A fresh unshared Tcl_Obj.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tcl_Obj *
+TkCursorCacheStatsObj(
+    TkDisplay *dispPtr)		/* Display to report on. */
+{
+    Tcl_Obj *resultObj = Tcl_NewDictObj();
+
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("hits", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dispPtr->cursorCacheHits));
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("misses", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dispPtr->cursorCacheMisses));
+    return resultObj;
+}
+
 /*
  * Local Variables:
  * mode: c
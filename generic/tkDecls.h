@@ -887,6 +887,15 @@ EXTERN void		Tk_Get3DBorderColors(Tk_3DBorder border,
 				XColor *lightColorPtr);
 /* 290 */
 EXTERN Window		Tk_MakeWindow(Tk_Window tkwin, Window parent);
+/* 291 */
+EXTERN void		Tk_CreateGenericHandlerForType(int type,
+				Tk_GenericProc *proc, void *clientData);
+/* 292 */
+EXTERN Tk_TextLayout	Tk_UpdateTextLayout(Tk_TextLayout layout,
+				Tk_Font tkfont, const char *str,
+				Tcl_Size numChars, int wrapLength,
+				Tk_Justify justify, int flags, int *widthPtr,
+				int *heightPtr);
 
 typedef struct {
     const struct TkPlatStubs *tkPlatStubs;
@@ -1190,6 +1199,8 @@ typedef struct TkStubs {
     Tk_Window (*tk_GetOtherWindow) (Tk_Window tkwin); /* 288 */
     void (*tk_Get3DBorderColors) (Tk_3DBorder border, XColor *bgColorPtr, XColor *darkColorPtr, XColor *lightColorPtr); /* 289 */
     Window (*tk_MakeWindow) (Tk_Window tkwin, Window parent); /* 290 */
+    void (*tk_CreateGenericHandlerForType) (int type, Tk_GenericProc *proc, void *clientData); /* 291 */
+    Tk_TextLayout (*tk_UpdateTextLayout) (Tk_TextLayout layout, Tk_Font tkfont, const char *str, Tcl_Size numChars, int wrapLength, Tk_Justify justify, int flags, int *widthPtr, int *heightPtr); /* 292 */
 } TkStubs;
 
 extern const TkStubs *tkStubsPtr;
@@ -1769,6 +1780,10 @@ extern const TkStubs *tkStubsPtr;
 	(tkStubsPtr->tk_Get3DBorderColors) /* 289 */
 #define Tk_MakeWindow \
 	(tkStubsPtr->tk_MakeWindow) /* 290 */
+#define Tk_CreateGenericHandlerForType \
+	(tkStubsPtr->tk_CreateGenericHandlerForType) /* 291 */
+#define Tk_UpdateTextLayout \
+	(tkStubsPtr->tk_UpdateTextLayout) /* 292 */
 
 #endif /* defined(USE_TK_STUBS) */
 
@@ -410,7 +410,8 @@ static int		ConfigureEntry(Tcl_Interp *interp, Entry *entryPtr,
 static int		DeleteChars(Entry *entryPtr, Tcl_Size index, Tcl_Size count);
 static Tcl_FreeProc	DestroyEntry;
 static void		DisplayEntry(void *clientData);
-static void		EntryBlinkProc(void *clientData);
+static void		EntryBlinkProc(void *clientData, int on);
+static void		EntryDisplayCursorOnly(Entry *entryPtr);
 static void		EntryCmdDeletedProc(void *clientData);
 static void		EntryComputeGeometry(Entry *entryPtr);
 static void		EntryEventProc(void *clientData,
@@ -1064,7 +1065,7 @@ DestroyEntry(
     if (entryPtr->selTextGC != NULL) {
 	Tk_FreeGC(entryPtr->display, entryPtr->selTextGC);
     }
-    Tcl_DeleteTimerHandler(entryPtr->insertBlinkHandler);
+    TkBlinkRemove(EntryBlinkProc, entryPtr);
     if (entryPtr->displayString != entryPtr->string) {
 	ckfree((void *)entryPtr->displayString);
     }
@@ -2068,9 +2069,8 @@ EntryComputeGeometry(
 	entryPtr->placeholderX = entryPtr->inset;
     }
 
-    Tk_FreeTextLayout(entryPtr->textLayout);
-    entryPtr->textLayout = Tk_ComputeTextLayout(entryPtr->tkfont,
-	    entryPtr->displayString, entryPtr->numChars, 0,
+    entryPtr->textLayout = Tk_UpdateTextLayout(entryPtr->textLayout,
+	    entryPtr->tkfont, entryPtr->displayString, entryPtr->numChars, 0,
 	    entryPtr->justify, TK_IGNORE_NEWLINES, &totalLength, &height);
 
     entryPtr->layoutY = (Tk_Height(entryPtr->tkwin) - height) / 2;
@@ -3113,6 +3113,10 @@ EntryUpdateScrollbar(
     interp = entryPtr->interp;
     Tcl_Preserve(interp);
     EntryVisibleRange(entryPtr, &first, &last);
+    if (TkScrollbarUpdate(interp, entryPtr->scrollCmd, first, last)) {
+	Tcl_Release(interp);
+	return;
+    }
     Tcl_PrintDouble(NULL, first, firstStr);
     Tcl_PrintDouble(NULL, last, lastStr);
     Tcl_DStringInit(&buf);
@@ -3133,45 +3137,219 @@ EntryUpdateScrollbar(
     Tcl_Release(interp);
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * EntryDisplayCursorOnly --
+ *
+ *	Repaint just the insertion cursor area of an entry.  This is what a
+ *	cursor blink needs: the cached layout is unchanged, so re-rendering
+ *	and copying the whole window (as DisplayEntry does) would be wasted
+ *	work.  The drawing below mirrors the corresponding layers of
+ *	DisplayEntry, shifted and clipped to the cursor rectangle.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The cursor area is redrawn on the screen.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+EntryDisplayCursorOnly(
+    Entry *entryPtr)		/* Entry whose cursor should be repainted. */
+{
+#ifndef TK_NO_DOUBLE_BUFFERING
+    Tk_Window tkwin = entryPtr->tkwin;
+    Tk_FontMetrics fm;
+    Pixmap pixmap;
+    int baseY, cursorX, dstY, width, height, xBound;
+    int selStartX, selEndX;
+
+    if ((entryPtr->flags & (ENTRY_DELETED|REDRAW_PENDING))
+	    || !Tk_IsMapped(tkwin)) {
+	/*
+	 * A full redisplay is already scheduled (or impossible); it will
+	 * paint the cursor in its new state.
+	 */
+
+	return;
+    }
+    if ((entryPtr->state != STATE_NORMAL)
+	    || !(entryPtr->flags & GOT_FOCUS)) {
+	return;
+    }
+
+    Tk_GetFontMetrics(entryPtr->tkfont, &fm);
+    xBound = Tk_Width(tkwin) - entryPtr->inset - entryPtr->xWidth;
+    baseY = (Tk_Height(tkwin) + fm.ascent - fm.descent) / 2;
+    Tk_CharBbox(entryPtr->textLayout, entryPtr->insertPos, &cursorX, NULL,
+	    NULL, NULL);
+    cursorX += entryPtr->layoutX;
+    cursorX -= (entryPtr->insertWidth == 1) ? 1 : (entryPtr->insertWidth)/2;
+    if ((entryPtr->insertPos < entryPtr->leftIndex) || (cursorX >= xBound)) {
+	return;
+    }
+    width = entryPtr->insertWidth;
+    if (cursorX + width > xBound) {
+	width = xBound - cursorX;
+    }
+    if (width <= 0) {
+	return;
+    }
+    height = fm.ascent + fm.descent;
+    dstY = baseY - fm.ascent;
+
+    pixmap = Tk_GetPixmap(entryPtr->display, Tk_WindowId(tkwin),
+	    width, height, Tk_Depth(tkwin));
+    Tk_Fill3DRectangle(tkwin, pixmap, entryPtr->normalBorder, 0, 0,
+	    width, height, 0, TK_RELIEF_FLAT);
+
+    /*
+     * Selection background, as in DisplayEntry (the widget has the focus
+     * here, so the selection is shown).
+     */
+
+    if (entryPtr->selectLast > entryPtr->leftIndex) {
+	if (entryPtr->selectFirst <= entryPtr->leftIndex) {
+	    selStartX = entryPtr->leftX;
+	} else {
+	    Tk_CharBbox(entryPtr->textLayout, entryPtr->selectFirst,
+		    &selStartX, NULL, NULL, NULL);
+	    selStartX += entryPtr->layoutX;
+	}
+	if ((selStartX - entryPtr->selBorderWidth) < xBound) {
+	    Tk_CharBbox(entryPtr->textLayout, entryPtr->selectLast,
+		    &selEndX, NULL, NULL, NULL);
+	    selEndX += entryPtr->layoutX;
+	    Tk_Fill3DRectangle(tkwin, pixmap, entryPtr->selBorder,
+		    selStartX - entryPtr->selBorderWidth - cursorX,
+		    -entryPtr->selBorderWidth,
+		    (selEndX - selStartX) + 2*entryPtr->selBorderWidth,
+		    height + 2*entryPtr->selBorderWidth,
+		    entryPtr->selBorderWidth,
+#ifndef MAC_OSX_TK
+		    TK_RELIEF_RAISED
+#else
+		    MAC_OSX_ENTRY_SELECT_RELIEF
+#endif
+		    );
+	}
+    }
+
+    /*
+     * The cursor background, or the hack that keeps the cursor visible
+     * inside the selection when it shares the selection color (see
+     * DisplayEntry).
+     */
+
+    if (entryPtr->flags & CURSOR_ON) {
+	Tk_Fill3DRectangle(tkwin, pixmap, entryPtr->insertBorder, 0, 0,
+		entryPtr->insertWidth, height, entryPtr->insertBorderWidth,
+		TK_RELIEF_RAISED);
+    } else if (entryPtr->insertBorder == entryPtr->selBorder) {
+	Tk_Fill3DRectangle(tkwin, pixmap, entryPtr->normalBorder, 0, 0,
+		entryPtr->insertWidth, height, 0, TK_RELIEF_FLAT);
+    }
+
+    /*
+     * Redraw the slivers of text the cursor rectangle overlaps.
+     */
+
+    if ((entryPtr->numChars == 0) && (entryPtr->placeholderChars != 0)) {
+	Tk_DrawTextLayout(entryPtr->display, pixmap, entryPtr->placeholderGC,
+		entryPtr->placeholderLayout, entryPtr->placeholderX - cursorX,
+		entryPtr->layoutY - dstY, entryPtr->placeholderLeftIndex,
+		entryPtr->placeholderChars);
+    } else if ((entryPtr->selTextGC != entryPtr->textGC)
+	    && (entryPtr->selectFirst < entryPtr->selectLast)) {
+	Tcl_Size selFirst;
+
+	if (entryPtr->selectFirst < entryPtr->leftIndex) {
+	    selFirst = entryPtr->leftIndex;
+	} else {
+	    selFirst = entryPtr->selectFirst;
+	}
+	if (entryPtr->leftIndex < selFirst) {
+	    Tk_DrawTextLayout(entryPtr->display, pixmap, entryPtr->textGC,
+		    entryPtr->textLayout, entryPtr->layoutX - cursorX,
+		    entryPtr->layoutY - dstY, entryPtr->leftIndex, selFirst);
+	}
+	Tk_DrawTextLayout(entryPtr->display, pixmap, entryPtr->selTextGC,
+		entryPtr->textLayout, entryPtr->layoutX - cursorX,
+		entryPtr->layoutY - dstY, selFirst, entryPtr->selectLast);
+	if (entryPtr->selectLast < entryPtr->numChars) {
+	    Tk_DrawTextLayout(entryPtr->display, pixmap, entryPtr->textGC,
+		    entryPtr->textLayout, entryPtr->layoutX - cursorX,
+		    entryPtr->layoutY - dstY, entryPtr->selectLast,
+		    entryPtr->numChars);
+	}
+    } else {
+	Tk_DrawTextLayout(entryPtr->display, pixmap, entryPtr->textGC,
+		entryPtr->textLayout, entryPtr->layoutX - cursorX,
+		entryPtr->layoutY - dstY, entryPtr->leftIndex,
+		entryPtr->numChars);
+    }
+
+    XCopyArea(entryPtr->display, pixmap, Tk_WindowId(tkwin),
+	    entryPtr->textGC, 0, 0, (unsigned) width, (unsigned) height,
+	    cursorX, dstY);
+    Tk_FreePixmap(entryPtr->display, pixmap);
+#else
+    /*
+     * Without double buffering there is no cheap partial repaint; fall back
+     * to a normal full redisplay.
+     */
+
+    EventuallyRedraw(entryPtr);
+#endif /* TK_NO_DOUBLE_BUFFERING */
+}
+
 /*
  *----------------------------------------------------------------------
  *
  * EntryBlinkProc --
  *
- *	This function is called as a timer handler to blink the insertion
- *	cursor off and on.
+ *	This function is called from the shared blink timer (see tkBlink.c)
+ *	whenever its phase changes, to blink the insertion cursor off and
+ *	on.
  *
  * Results:
  *	None.
  *
  * Side effects:
- *	The cursor gets turned on or off, redisplay gets invoked, and this
- *	function reschedules itself.
+ *	The cursor gets turned on or off and its area gets repainted.
  *
  *----------------------------------------------------------------------
  */
 
 static void
 EntryBlinkProc(
-    void *clientData)	/* Pointer to record describing entry. */
+    void *clientData,		/* Pointer to record describing entry. */
+    int on)			/* New phase of the shared blink timer. */
 {
     Entry *entryPtr = (Entry *)clientData;
 
     if ((entryPtr->state == STATE_DISABLED) ||
 	    (entryPtr->state == STATE_READONLY) ||
 	    !(entryPtr->flags & GOT_FOCUS) || (entryPtr->insertOffTime == 0)) {
+	TkBlinkRemove(EntryBlinkProc, entryPtr);
 	return;
     }
-    if (entryPtr->flags & CURSOR_ON) {
-	entryPtr->flags &= ~CURSOR_ON;
-	entryPtr->insertBlinkHandler = Tcl_CreateTimerHandler(
-		entryPtr->insertOffTime, EntryBlinkProc, entryPtr);
-    } else {
+    if (on) {
 	entryPtr->flags |= CURSOR_ON;
-	entryPtr->insertBlinkHandler = Tcl_CreateTimerHandler(
-		entryPtr->insertOnTime, EntryBlinkProc, entryPtr);
+    } else {
+	entryPtr->flags &= ~CURSOR_ON;
     }
-    EventuallyRedraw(entryPtr);
+
+    /*
+     * The text layout is still valid; only the cursor area needs to be
+     * repainted, not the whole widget.
+     */
+
+    EntryDisplayCursorOnly(entryPtr);
 }
 
 /*
@@ -3198,12 +3376,12 @@ EntryFocusProc(
     int gotFocus)		/* 1 means window is getting focus, 0 means
 				 * it's losing it. */
 {
-    Tcl_DeleteTimerHandler(entryPtr->insertBlinkHandler);
+    TkBlinkRemove(EntryBlinkProc, entryPtr);
     if (gotFocus) {
 	entryPtr->flags |= GOT_FOCUS | CURSOR_ON;
 	if (entryPtr->insertOffTime != 0) {
-	    entryPtr->insertBlinkHandler = Tcl_CreateTimerHandler(
-		    entryPtr->insertOnTime, EntryBlinkProc, entryPtr);
+	    TkBlinkAdd(EntryBlinkProc, entryPtr, entryPtr->insertOnTime,
+		    entryPtr->insertOffTime);
 	}
 	if (entryPtr->validate == VALIDATE_ALL ||
 		entryPtr->validate == VALIDATE_FOCUS ||
@@ -3213,7 +3391,6 @@ EntryFocusProc(
 	}
     } else {
 	entryPtr->flags &= ~(GOT_FOCUS | CURSOR_ON);
-	entryPtr->insertBlinkHandler = NULL;
 	if (entryPtr->validate == VALIDATE_ALL ||
 		entryPtr->validate == VALIDATE_FOCUS ||
 		entryPtr->validate == VALIDATE_FOCUSOUT) {
@@ -168,9 +168,6 @@ typedef struct {
 				 * is drawn (varies depending on justify). */
     Tcl_Size leftIndex;		/* Character index of left-most character
 				 * visible in window. */
-    Tcl_TimerToken insertBlinkHandler;
-				/* Timer handler used to blink cursor on and
-				 * off. */
     GC textGC;			/* For drawing normal text. */
     GC selTextGC;		/* For drawing selected text. */
     GC highlightGC;		/* For drawing traversal highlight. */
@@ -104,10 +104,15 @@ Tk_CreateErrorHandler(
     }
 
     /*
-     * Create the handler record.
+     * Create the handler record, reusing a pooled one if available.
      */
 
-    errorPtr = (TkErrorHandler *)ckalloc(sizeof(TkErrorHandler));
+    if (dispPtr->errorFreePtr != NULL) {
+	errorPtr = dispPtr->errorFreePtr;
+	dispPtr->errorFreePtr = errorPtr->nextPtr;
+    } else {
+	errorPtr = (TkErrorHandler *)ckalloc(sizeof(TkErrorHandler));
+    }
     errorPtr->dispPtr = dispPtr;
     errorPtr->firstRequest = NextRequest(display);
     errorPtr->lastRequest = (unsigned) -1;
@@ -189,7 +194,8 @@ Tk_DeleteErrorHandler(
 		} else {
 		    prevPtr->nextPtr = nextPtr;
 		}
-		ckfree(errorPtr);
+		errorPtr->nextPtr = dispPtr->errorFreePtr;
+		dispPtr->errorFreePtr = errorPtr;
 		continue;
 	    }
 	    prevPtr = errorPtr;
@@ -197,6 +203,134 @@ Tk_DeleteErrorHandler(
     }
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPushErrorGuard --
+ *
+ *	Arrange for all X protocol errors on subsequent requests to be
+ *	ignored, using a handler record supplied by the caller instead of
+ *	allocating one. Equivalent to Tk_CreateErrorHandler(display, -1,
+ *	-1, -1, NULL, NULL) but without any allocation, for hot paths
+ *	(selection transfer, focus and grab changes) that trap errors
+ *	around just a few requests.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The guard's embedded handler record is pushed onto the display's
+ *	handler list. It must stay in scope until TkPopErrorGuard is
+ *	called; guards must be popped in LIFO order with respect to each
+ *	other (interleaving with Tk_CreateErrorHandler is fine).
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkPushErrorGuard(
+    Display *display,		/* Display for which to ignore errors. */
+    TkErrorGuard *guardPtr)	/* Caller-supplied guard record, typically on
+				 * the caller's stack. */
+{
+    TkErrorHandler *errorPtr = &guardPtr->handler;
+    TkDisplay *dispPtr;
+
+    dispPtr = TkGetDisplay(display);
+    if (dispPtr == NULL) {
+	Tcl_Panic("Unknown display passed to TkPushErrorGuard");
+    }
+    if (defaultHandler == NULL) {
+	defaultHandler = XSetErrorHandler(ErrorProc);
+    }
+
+    errorPtr->dispPtr = dispPtr;
+    errorPtr->firstRequest = NextRequest(display);
+    errorPtr->lastRequest = (unsigned) -1;
+    errorPtr->error = -1;
+    errorPtr->request = -1;
+    errorPtr->minorCode = -1;
+    errorPtr->errorProc = NULL;
+    errorPtr->clientData = NULL;
+    errorPtr->nextPtr = dispPtr->errorPtr;
+    dispPtr->errorPtr = errorPtr;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkPopErrorGuard --
+ *
+ *	Stop ignoring errors for the requests bracketed by a guard pushed
+ *	with TkPushErrorGuard.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The guard's handler record is unlinked from the display's handler
+ *	list; the caller may release its storage immediately. If errors
+ *	for bracketed requests may still be in flight, the record is first
+ *	migrated to a (pooled) heap record that keeps matching them until
+ *	the regular garbage collection reclaims it.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkPopErrorGuard(
+    TkErrorGuard *guardPtr)	/* Guard previously passed to
+				 * TkPushErrorGuard. */
+{
+    TkErrorHandler *errorPtr = &guardPtr->handler;
+    TkDisplay *dispPtr = errorPtr->dispPtr;
+    TkErrorHandler **linkPtrPtr;
+
+    errorPtr->lastRequest = NextRequest(dispPtr->display) - 1;
+
+    /*
+     * Find the link pointing at the guard. Guards are short-lived and
+     * popped in LIFO order, so this is normally the head of the list.
+     */
+
+    for (linkPtrPtr = &dispPtr->errorPtr; *linkPtrPtr != errorPtr;
+	    linkPtrPtr = &(*linkPtrPtr)->nextPtr) {
+	if (*linkPtrPtr == NULL) {
+	    Tcl_Panic("TkPopErrorGuard couldn't find guard on handler list");
+	}
+    }
+
+    if (errorPtr->lastRequest
+	    <= LastKnownRequestProcessed(dispPtr->display)) {
+	/*
+	 * Everything issued under the guard has already been processed by
+	 * the server, so no matching errors can arrive anymore: just
+	 * unlink the record.
+	 */
+
+	*linkPtrPtr = errorPtr->nextPtr;
+    } else {
+	/*
+	 * Errors may still be in flight, and the caller's record cannot
+	 * stay on the list the way deleted heap handlers do. Migrate it
+	 * to a heap record and let the usual garbage collection in
+	 * Tk_DeleteErrorHandler reclaim that one.
+	 */
+
+	TkErrorHandler *heapPtr;
+
+	if (dispPtr->errorFreePtr != NULL) {
+	    heapPtr = dispPtr->errorFreePtr;
+	    dispPtr->errorFreePtr = heapPtr->nextPtr;
+	} else {
+	    heapPtr = (TkErrorHandler *)ckalloc(sizeof(TkErrorHandler));
+	}
+	*heapPtr = *errorPtr;
+	*linkPtrPtr = heapPtr;
+	dispPtr->deleteCount++;
+    }
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -54,6 +54,8 @@ typedef struct GenericHandler {
     ClientData clientData;	/* Client data to pass to function. */
     int deleteFlag;		/* Flag to set when this handler is
 				 * deleted. */
+    int type;			/* X event type the handler is interested in,
+				 * or 0 to receive all events. */
     struct GenericHandler *nextPtr;
 				/* Next handler in list of all generic
 				 * handlers, or NULL for end of list. */
@@ -67,6 +69,53 @@ typedef struct GenericHandler {
  * deleting handlers only when it's known that there's no handler active.
  */
 
+/*
+ * For each callback scheduled through TkDoWhenIdle an instance of the
+ * following structure is kept on one of the per-tier queues, so that
+ * layout work can be run before repaints and repaints before deferred
+ * background work, independently of the order in which they were
+ * scheduled.
+ */
+
+typedef struct TieredIdle {
+    Tcl_IdleProc *proc;		/* Function to call. */
+    ClientData clientData;	/* Value to pass to proc. */
+    struct TieredIdle *nextPtr;	/* Next callback in the same tier, or NULL
+				 * for end of queue. */
+} TieredIdle;
+
+/*
+ * Upper bound on how often the layout tier is re-drained within one idle
+ * period. Nested geometry managers ripple: a child manager arranges, issues
+ * a geometry request, and thereby schedules its container's arrange, so the
+ * tier refills once per nesting level. Re-draining until the tier settles
+ * lets a whole burst of size changes resolve before any repaint runs; the
+ * bound only exists to stop a pathological manager that reschedules itself
+ * forever from wedging the event loop.
+ */
+
+#define LAYOUT_SETTLE_ROUNDS	64
+
+/*
+ * For each script registered with "tk frameclock callback" an instance of
+ * the following structure is kept until the next frame tick.
+ */
+
+typedef struct FrameCallback {
+    Tcl_Interp *interp;		/* Interpreter in which to evaluate the
+				 * script. */
+    Tcl_Obj *scriptObj;		/* Script to evaluate. */
+    struct FrameCallback *nextPtr;
+				/* Next callback, or NULL for end of list. */
+} FrameCallback;
+
+/*
+ * Default number of milliseconds between frame ticks when the frame clock
+ * is enabled; approximately a 60 Hz display.
+ */
+
+#define FRAME_INTERVAL_DEFAULT	16
+
 /*
  * The following structure is used for queueing X-style events on the Tcl
  * event queue.
@@ -75,6 +124,9 @@ typedef struct GenericHandler {
 typedef struct TkWindowEvent {
     Tcl_Event header;		/* Standard information for all events. */
     XEvent event;		/* The X event. */
+    Tcl_Time queueTime;		/* Time at which the event was queued; used
+				 * to compute the queue residency reported by
+				 * "tk eventstats". */
 } TkWindowEvent;
 
 /*
@@ -127,6 +179,52 @@ static const unsigned long eventMasks[TK_LASTEVENT] = {
     TouchpadScrollMask			/* TouchpadScroll */
 };
 
+/*
+ * Dispatch statistics kept per X event type and reported by the
+ * "tk eventstats" command. All times are in microseconds.
+ */
+
+typedef struct {
+    Tcl_WideInt count;		/* Number of events dispatched. */
+    Tcl_WideInt handlerTime;	/* Total time spent in Tk_HandleEvent. */
+    Tcl_WideInt maxHandlerTime;	/* Longest single dispatch. */
+    Tcl_WideInt queueTime;	/* Total time events of this type spent on
+				 * the Tcl event queue before dispatch. */
+} EventStats;
+
+/*
+ * Per-window repaint statistics collected by the widget display procedures
+ * when recording has been switched on with "tk paintstats", keyed by window
+ * path name. All times are in microseconds.
+ */
+
+typedef struct {
+    Tcl_WideInt paints;		/* Number of recorded repaints. */
+    Tcl_WideInt paintTime;	/* Total time spent repainting. */
+    Tcl_WideInt maxPaintTime;	/* Longest single repaint. */
+    Tcl_WideInt lastPaintTime;	/* Duration of the most recent repaint. */
+    int lastX, lastY;		/* Damage rectangle of the most recent */
+    int lastWidth, lastHeight;	/* repaint, in window coordinates. */
+} PaintStats;
+
+/*
+ * Names corresponding to each X event type, indexed like eventMasks.
+ */
+
+static const char *const eventStatsNames[TK_LASTEVENT] = {
+    NULL, NULL,
+    "KeyPress", "KeyRelease", "ButtonPress", "ButtonRelease",
+    "MotionNotify", "EnterNotify", "LeaveNotify", "FocusIn", "FocusOut",
+    "KeymapNotify", "Expose", "GraphicsExpose", "NoExpose",
+    "VisibilityNotify", "CreateNotify", "DestroyNotify", "UnmapNotify",
+    "MapNotify", "MapRequest", "ReparentNotify", "ConfigureNotify",
+    "ConfigureRequest", "GravityNotify", "ResizeRequest",
+    "CirculateNotify", "CirculateRequest", "PropertyNotify",
+    "SelectionClear", "SelectionRequest", "SelectionNotify",
+    "ColormapNotify", "ClientMessage", "MappingNotify", "VirtualEvent",
+    "ActivateNotify", "DeactivateNotify", "MouseWheel", "TouchpadScroll"
+};
+
 /*
  * For each exit handler created with a call to TkCreateExitHandler or
  * TkCreateThreadExitHandler there is a structure of the following type:
@@ -180,6 +278,36 @@ typedef struct {
     int inExit;			/* True when this thread is exiting. This is
 				 * used as a hack to decide to close the
 				 * standard channels. */
+    EventStats eventStats[TK_LASTEVENT];
+				/* Dispatch statistics per X event type. */
+    Tcl_HashTable paintTable;	/* Maps window path names to PaintStats
+				 * records; see TkRecordPaint. */
+    int paintTableInit;		/* 0 means paintTable needs initialization. */
+    int paintRecording;		/* Non-zero means the display procedures
+				 * collect repaint statistics. */
+    int paintFlash;		/* Non-zero means each recorded repaint
+				 * inverts its damage rectangle on the screen
+				 * so that repaint activity is visible. */
+    TieredIdle *idleHeads[TK_IDLE_NUM_TIERS];
+    TieredIdle *idleTails[TK_IDLE_NUM_TIERS];
+				/* Queues of idle callbacks scheduled with
+				 * TkDoWhenIdle, one per tier. */
+    int idlePumpPending;	/* Non-zero means TieredIdleProc is already
+				 * registered with Tcl_DoWhenIdle. */
+    int idleFrozen;		/* Number of outstanding TkIdleFreeze calls.
+				 * While non-zero the tiered queues only
+				 * accumulate; nothing is drained. */
+    int frameClockOn;		/* Non-zero means tiered idle callbacks are
+				 * batched and run on frame ticks instead of
+				 * whenever the event loop goes idle. */
+    int frameInterval;		/* Milliseconds between frame ticks; 0 means
+				 * not yet initialized, use the default. */
+    int frameTickPending;	/* Non-zero means FrameTickProc is already
+				 * registered with Tcl_CreateTimerHandler. */
+    Tcl_TimerToken frameTimer;	/* Token for the pending frame tick. */
+    FrameCallback *frameCbHead;	/* First in the list of one-shot scripts to
+				 * run on the next frame tick. */
+    FrameCallback *frameCbTail;	/* Last in the list of frame callbacks. */
 } ThreadSpecificData;
 static Tcl_ThreadDataKey dataKey;
 
@@ -199,6 +327,13 @@ TCL_DECLARE_MUTEX(exitMutex)
 
 static void		CleanUpTkEvent(XEvent *eventPtr);
 static void		DelayedMotionProc(ClientData clientData);
+static void		TieredIdleProc(ClientData clientData);
+static void		DrainIdleTiers(ThreadSpecificData *tsdPtr);
+static void		FrameScheduleTick(ThreadSpecificData *tsdPtr);
+static void		FrameTickProc(ClientData clientData);
+static void		DelayedWheelProc(ClientData clientData);
+static void		DelayedExposeProc(ClientData clientData);
+static void		DelayedConfigureProc(ClientData clientData);
 static unsigned long    GetEventMaskFromXEvent(XEvent *eventPtr);
 static TkWindow *	GetTkWindowFromXEvent(XEvent *eventPtr);
 static void		InvokeClientMessageHandlers(ThreadSpecificData *tsdPtr,
@@ -650,7 +785,7 @@ InvokeGenericHandlers(
 		curPtr = tmpPtr;
 		continue;
 	    }
-	} else {
+	} else if ((curPtr->type == 0) || (curPtr->type == eventPtr->type)) {
 	    int done;
 
 	    tsdPtr->handlersActive++;
@@ -868,6 +1003,7 @@ Tk_CreateGenericHandler(
     handlerPtr->proc		= proc;
     handlerPtr->clientData	= clientData;
     handlerPtr->deleteFlag	= 0;
+    handlerPtr->type		= 0;
     handlerPtr->nextPtr		= NULL;
     if (tsdPtr->genericList == NULL) {
 	tsdPtr->genericList	= handlerPtr;
@@ -877,6 +1013,53 @@ Tk_CreateGenericHandler(
     tsdPtr->lastGenericPtr	= handlerPtr;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * Tk_CreateGenericHandlerForType --
+ *
+ *	Register a function to be called on each X event of the given type,
+ *	regardless of display or window. This behaves exactly like
+ *	Tk_CreateGenericHandler except that events of other types are never
+ *	dispatched to the handler, so registering for a specific type does
+ *	not put the handler on the critical path of every event.
+ *
+ * Results:
+ *	None.
+ *
+ * Side Effects:
+ *	From now on, whenever an X event of the given type is given to
+ *	Tk_HandleEvent, invoke proc, giving it clientData and the event as
+ *	arguments. The handler can be removed with Tk_DeleteGenericHandler.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+Tk_CreateGenericHandlerForType(
+    int type,			/* X event type to call the function on. */
+    Tk_GenericProc *proc,	/* Function to call on matching events. */
+    void *clientData)		/* One-word value to pass to proc. */
+{
+    GenericHandler *handlerPtr;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    handlerPtr = (GenericHandler *)ckalloc(sizeof(GenericHandler));
+
+    handlerPtr->proc		= proc;
+    handlerPtr->clientData	= clientData;
+    handlerPtr->deleteFlag	= 0;
+    handlerPtr->type		= type;
+    handlerPtr->nextPtr		= NULL;
+    if (tsdPtr->genericList == NULL) {
+	tsdPtr->genericList	= handlerPtr;
+    } else {
+	tsdPtr->lastGenericPtr->nextPtr = handlerPtr;
+    }
+    tsdPtr->lastGenericPtr	= handlerPtr;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -947,6 +1130,7 @@ Tk_CreateClientMessageHandler(
     handlerPtr->proc = (Tk_GenericProc *) proc;
     handlerPtr->clientData = NULL;	/* never used */
     handlerPtr->deleteFlag = 0;
+    handlerPtr->type = 0;
     handlerPtr->nextPtr = NULL;
     if (tsdPtr->cmList == NULL) {
 	tsdPtr->cmList = handlerPtr;
@@ -1138,9 +1322,12 @@ Tk_HandleEvent(
     unsigned long mask;
     InProgress ip;
     Tcl_Interp *interp = NULL;
+    Tcl_Time startTime, endTime;
     ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
 	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
 
+    Tcl_GetTime(&startTime);
+
 
 #if !defined(_WIN32) && !defined(MAC_OSX_TK)
     if ((eventPtr->type == ButtonRelease) || (eventPtr->type == ButtonPress)) {
@@ -1257,6 +1444,26 @@ Tk_HandleEvent(
 	winPtr->dispPtr->lastEventTime = eventPtr->xproperty.time;
     }
 
+    /*
+     * Track whether the window is completely hidden behind other windows.
+     * The server delivers VisibilityNotify before the Expose events that
+     * follow a change in visibility, so the flag is always current by the
+     * time exposures are processed.  Display procedures consult it (via
+     * TkWindowObscured) to skip repaints that could never reach the screen;
+     * uncovering the window generates Expose events, which replay the
+     * repaint.
+     */
+
+    if (eventPtr->type == VisibilityNotify) {
+	if (eventPtr->xvisibility.state == VisibilityFullyObscured) {
+	    winPtr->flags |= TK_OBSCURED;
+	} else {
+	    winPtr->flags &= ~TK_OBSCURED;
+	}
+    } else if (eventPtr->type == UnmapNotify) {
+	winPtr->flags &= ~TK_OBSCURED;
+    }
+
     /*
      * There's a potential interaction here with Tk_DeleteEventHandler. Read
      * the documentation for pendingPtr.
@@ -1330,9 +1537,134 @@ Tk_HandleEvent(
      */
 
   releaseEventResources:
+    if ((eventPtr->type >= 0) && (eventPtr->type < TK_LASTEVENT)) {
+	EventStats *statsPtr = &tsdPtr->eventStats[eventPtr->type];
+	Tcl_WideInt micros;
+
+	Tcl_GetTime(&endTime);
+	micros = (Tcl_WideInt) (endTime.sec - startTime.sec) * 1000000
+		+ (endTime.usec - startTime.usec);
+	statsPtr->count++;
+	statsPtr->handlerTime += micros;
+	if (micros > statsPtr->maxHandlerTime) {
+	    statsPtr->maxHandlerTime = micros;
+	}
+    }
     CleanUpTkEvent(eventPtr);
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkWindowObscured --
+ *
+ *	Determine whether a window is currently invisible because it (or an
+ *	enclosing window) is completely covered by other windows.
+ *
+ * Results:
+ *	Returns 1 if the window or one of its ancestors, up to and including
+ *	the nearest window at the top of its physical hierarchy, has the
+ *	TK_OBSCURED flag set.  Returns 0 otherwise.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkWindowObscured(
+    TkWindow *winPtr)		/* Window to check; may be NULL. */
+{
+    while (winPtr != NULL) {
+	if (winPtr->flags & TK_OBSCURED) {
+	    return 1;
+	}
+	if (winPtr->flags & TK_TOP_HIERARCHY) {
+	    break;
+	}
+	winPtr = winPtr->parentPtr;
+    }
+    return 0;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkWindowAreaObscured --
+ *
+ *	Determine whether an area of a window is completely covered by
+ *	mapped child windows that are opaque (TK_WIN_OPAQUE), in which case
+ *	anything the window draws there could never become visible.
+ *
+ * Results:
+ *	Returns 1 if opaque children jointly cover the area given by its
+ *	upper-left corner and its lower-right corner (exclusive), 0
+ *	otherwise.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkWindowAreaObscured(
+    TkWindow *winPtr,		/* Window whose children to check. */
+    int x1, int y1,		/* Upper-left corner of the area. */
+    int x2, int y2)		/* Lower-right corner (exclusive). */
+{
+    TkWindow *childPtr;
+    TkRegion rgn = NULL;
+    XRectangle rect;
+    int result = 0;
+
+    for (childPtr = winPtr->childList; childPtr != NULL;
+	    childPtr = childPtr->nextPtr) {
+	int cx1, cy1, cx2, cy2;
+
+	if (!Tk_IsMapped((Tk_Window) childPtr)
+		|| !(childPtr->flags & TK_WIN_OPAQUE)
+		|| (childPtr->flags & TK_TOP_HIERARCHY)) {
+	    continue;
+	}
+	cx1 = childPtr->changes.x;
+	cy1 = childPtr->changes.y;
+	cx2 = cx1 + childPtr->changes.width;
+	cy2 = cy1 + childPtr->changes.height;
+	if ((cx2 <= x1) || (cy2 <= y1) || (cx1 >= x2) || (cy1 >= y2)) {
+	    continue;
+	}
+	if ((cx1 <= x1) && (cy1 <= y1) && (cx2 >= x2) && (cy2 >= y2)) {
+	    result = 1;
+	    break;
+	}
+
+	/*
+	 * Partial overlap: accumulate the child areas in a region and test
+	 * their union afterwards, so that children tiling the area (the
+	 * usual outcome of pack and grid) are recognized too.
+	 */
+
+	if (rgn == NULL) {
+	    rgn = TkCreateRegion();
+	}
+	rect.x = (short) cx1;
+	rect.y = (short) cy1;
+	rect.width = (unsigned short) childPtr->changes.width;
+	rect.height = (unsigned short) childPtr->changes.height;
+	TkUnionRectWithRegion(&rect, rgn, rgn);
+    }
+    if (!result && (rgn != NULL)) {
+	result = (TkRectInRegion(rgn, x1, y1, (unsigned) (x2 - x1),
+		(unsigned) (y2 - y1)) == RectangleIn);
+    }
+    if (rgn != NULL) {
+	TkDestroyRegion(rgn);
+    }
+    return result;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -1511,7 +1843,7 @@ Tk_CollapseMotionEvents(
  *
  *	Given an X-style window event, this function adds it to the Tcl event
  *	queue at the given position. This function also performs mouse motion
- *	event collapsing if possible.
+ *	and mouse wheel event collapsing if possible.
  *
  * Results:
  *	None.
@@ -1533,6 +1865,33 @@ Tk_QueueWindowEvent(
     TkWindowEvent *wevPtr;
     TkDisplay *dispPtr;
 
+#if !defined(_WIN32) && !defined(MAC_OSX_TK)
+    /*
+     * On X11 the physical mouse wheel arrives as button presses on buttons
+     * 4 through 7. Translate them to MouseWheelEvent here rather than in
+     * Tk_HandleEvent, so that the wheel merging below sees them: otherwise
+     * a fast-spinning wheel on Unix would queue one event per notch and the
+     * coalescing would never fire. The matching releases carry no
+     * information and are dropped, just as Tk_HandleEvent would drop them.
+     */
+
+    if (((eventPtr->type == ButtonPress) || (eventPtr->type == ButtonRelease))
+	    && (eventPtr->xbutton.button >= Button4)
+	    && (eventPtr->xbutton.button < Button8)) {
+	int but = eventPtr->xbutton.button;
+
+	if (eventPtr->type == ButtonRelease) {
+	    return;
+	}
+	eventPtr->type = MouseWheelEvent;
+	eventPtr->xany.send_event = -1;
+	eventPtr->xkey.keycode = (but & 1) ? -120 : 120;
+	if (but > Button5) {
+	    eventPtr->xkey.state |= ShiftMask;
+	}
+    }
+#endif
+
     /*
      * Find our display structure for the event's display.
      */
@@ -1556,10 +1915,45 @@ Tk_QueueWindowEvent(
 	wevPtr = (TkWindowEvent *)ckalloc(sizeof(TkWindowEvent));
 	wevPtr->header.proc = WindowEventProc;
 	wevPtr->event = *eventPtr;
+	Tcl_GetTime(&wevPtr->queueTime);
 	Tcl_QueueEvent(&wevPtr->header, position);
 	return;
     }
 
+    if ((dispPtr->delayedWheelPtr != NULL) && (position == TCL_QUEUE_TAIL)) {
+	if ((eventPtr->type == MouseWheelEvent) && (eventPtr->xkey.window
+		== dispPtr->delayedWheelPtr->event.xkey.window)
+		&& (eventPtr->xkey.state
+		== dispPtr->delayedWheelPtr->event.xkey.state)) {
+	    /*
+	     * The new event is a wheel event for the same window and
+	     * modifier state as the saved wheel event. Merge the two by
+	     * summing their deltas and keeping the newer coordinates, so a
+	     * fast-spinning wheel produces one binding invocation per pass
+	     * through the event loop instead of one per notch.
+	     */
+
+	    int delta = (int) dispPtr->delayedWheelPtr->event.xkey.keycode
+		    + (int) eventPtr->xkey.keycode;
+
+	    dispPtr->delayedWheelPtr->event = *eventPtr;
+	    dispPtr->delayedWheelPtr->event.xkey.keycode = delta;
+	    return;
+	} else if ((eventPtr->type != GraphicsExpose)
+		&& (eventPtr->type != NoExpose)
+		&& (eventPtr->type != Expose)) {
+	    /*
+	     * The new event may conflict with the saved wheel event. Queue
+	     * the saved wheel event now so that it will be processed before
+	     * the new event.
+	     */
+
+	    Tcl_QueueEvent(&dispPtr->delayedWheelPtr->header, position);
+	    dispPtr->delayedWheelPtr = NULL;
+	    Tcl_CancelIdleCall(DelayedWheelProc, dispPtr);
+	}
+    }
+
     if ((dispPtr->delayedMotionPtr != NULL) && (position == TCL_QUEUE_TAIL)) {
 	if ((eventPtr->type == MotionNotify) && (eventPtr->xmotion.window
 		== dispPtr->delayedMotionPtr->event.xmotion.window)) {
@@ -1585,9 +1979,95 @@ Tk_QueueWindowEvent(
 	}
     }
 
+    if ((dispPtr->delayedExposePtr != NULL) && (position == TCL_QUEUE_TAIL)) {
+	if ((eventPtr->type == Expose) && (eventPtr->xexpose.window
+		== dispPtr->delayedExposePtr->event.xexpose.window)) {
+	    /*
+	     * The new event exposes the same window as the saved expose
+	     * event. Merge the two by taking the bounding box of their
+	     * rectangles, so a storm of exposures produces one repaint per
+	     * pass through the event loop instead of one per rectangle.
+	     */
+
+	    XExposeEvent *savedPtr =
+		    &dispPtr->delayedExposePtr->event.xexpose;
+	    int x2 = savedPtr->x + savedPtr->width;
+	    int y2 = savedPtr->y + savedPtr->height;
+
+	    if (eventPtr->xexpose.x < savedPtr->x) {
+		savedPtr->x = eventPtr->xexpose.x;
+	    }
+	    if (eventPtr->xexpose.y < savedPtr->y) {
+		savedPtr->y = eventPtr->xexpose.y;
+	    }
+	    if (eventPtr->xexpose.x + eventPtr->xexpose.width > x2) {
+		x2 = eventPtr->xexpose.x + eventPtr->xexpose.width;
+	    }
+	    if (eventPtr->xexpose.y + eventPtr->xexpose.height > y2) {
+		y2 = eventPtr->xexpose.y + eventPtr->xexpose.height;
+	    }
+	    savedPtr->width = x2 - savedPtr->x;
+	    savedPtr->height = y2 - savedPtr->y;
+	    savedPtr->count = eventPtr->xexpose.count;
+	    return;
+	} else if ((eventPtr->type != MotionNotify)
+		&& (eventPtr->type != MouseWheelEvent)
+		&& (eventPtr->type != ConfigureNotify)) {
+	    /*
+	     * The new event may conflict with the saved expose event. Queue
+	     * the saved expose event now so that it will be processed before
+	     * the new event. ConfigureNotify is exempt: a resize sequence
+	     * interleaves the two, and delivering the exposure after the
+	     * final geometry just avoids one repaint at a stale size.
+	     */
+
+	    Tcl_QueueEvent(&dispPtr->delayedExposePtr->header, position);
+	    dispPtr->delayedExposePtr = NULL;
+	    Tcl_CancelIdleCall(DelayedExposeProc, dispPtr);
+	}
+    }
+
+    if ((dispPtr->delayedConfigurePtr != NULL)
+	    && (position == TCL_QUEUE_TAIL)) {
+	if ((eventPtr->type == ConfigureNotify)
+		&& (eventPtr->xconfigure.event
+		== dispPtr->delayedConfigurePtr->event.xconfigure.event)
+		&& (eventPtr->xconfigure.window
+		== dispPtr->delayedConfigurePtr->event.xconfigure.window)) {
+	    /*
+	     * The new event reconfigures the same window as the saved
+	     * configure event, reported to the same selecting window
+	     * (dispatch keys on xany.window, which for ConfigureNotify is
+	     * the "event" field; the same reconfiguration can be delivered
+	     * separately for StructureNotify on the window itself and for
+	     * SubstructureNotify on its parent, and those must not merge).
+	     * Just replace the saved event with the new one: only the
+	     * final geometry of the sequence matters.
+	     */
+
+	    dispPtr->delayedConfigurePtr->event = *eventPtr;
+	    return;
+	} else if ((eventPtr->type != GraphicsExpose)
+		&& (eventPtr->type != NoExpose)
+		&& (eventPtr->type != Expose)
+		&& (eventPtr->type != MotionNotify)
+		&& (eventPtr->type != MouseWheelEvent)) {
+	    /*
+	     * The new event may conflict with the saved configure event.
+	     * Queue the saved configure event now so that it will be
+	     * processed before the new event.
+	     */
+
+	    Tcl_QueueEvent(&dispPtr->delayedConfigurePtr->header, position);
+	    dispPtr->delayedConfigurePtr = NULL;
+	    Tcl_CancelIdleCall(DelayedConfigureProc, dispPtr);
+	}
+    }
+
     wevPtr = (TkWindowEvent *)ckalloc(sizeof(TkWindowEvent));
     wevPtr->header.proc = WindowEventProc;
     wevPtr->event = *eventPtr;
+    Tcl_GetTime(&wevPtr->queueTime);
     if ((eventPtr->type == MotionNotify) && (position == TCL_QUEUE_TAIL)) {
 	/*
 	 * The new event is a motion event so don't queue it immediately; save
@@ -1600,6 +2080,44 @@ Tk_QueueWindowEvent(
 	}
 	dispPtr->delayedMotionPtr = wevPtr;
 	Tcl_DoWhenIdle(DelayedMotionProc, dispPtr);
+    } else if ((eventPtr->type == MouseWheelEvent)
+	    && (position == TCL_QUEUE_TAIL)) {
+	/*
+	 * The new event is a wheel event so don't queue it immediately; save
+	 * it around in case another wheel event arrives that it can be
+	 * merged with.
+	 */
+
+	if (dispPtr->delayedWheelPtr != NULL) {
+	    Tcl_Panic("Tk_QueueWindowEvent found unexpected delayed wheel event");
+	}
+	dispPtr->delayedWheelPtr = wevPtr;
+	Tcl_DoWhenIdle(DelayedWheelProc, dispPtr);
+    } else if ((eventPtr->type == Expose) && (position == TCL_QUEUE_TAIL)) {
+	/*
+	 * The new event is an expose event so don't queue it immediately;
+	 * save it around in case more exposures arrive whose rectangles can
+	 * be merged with it.
+	 */
+
+	if (dispPtr->delayedExposePtr != NULL) {
+	    Tcl_Panic("Tk_QueueWindowEvent found unexpected delayed expose event");
+	}
+	dispPtr->delayedExposePtr = wevPtr;
+	Tcl_DoWhenIdle(DelayedExposeProc, dispPtr);
+    } else if ((eventPtr->type == ConfigureNotify)
+	    && (position == TCL_QUEUE_TAIL)) {
+	/*
+	 * The new event is a configure event so don't queue it immediately;
+	 * save it around in case another configure event for the same window
+	 * supersedes it.
+	 */
+
+	if (dispPtr->delayedConfigurePtr != NULL) {
+	    Tcl_Panic("Tk_QueueWindowEvent found unexpected delayed configure event");
+	}
+	dispPtr->delayedConfigurePtr = wevPtr;
+	Tcl_DoWhenIdle(DelayedConfigureProc, dispPtr);
     } else {
 	Tcl_QueueEvent(&wevPtr->header, position);
     }
@@ -1738,6 +2256,14 @@ WindowEventProc(
 	    }
 	}
     }
+    if ((wevPtr->event.type >= 0) && (wevPtr->event.type < TK_LASTEVENT)) {
+	Tcl_Time now;
+
+	Tcl_GetTime(&now);
+	tsdPtr->eventStats[wevPtr->event.type].queueTime +=
+		(Tcl_WideInt) (now.sec - wevPtr->queueTime.sec) * 1000000
+		+ (now.usec - wevPtr->queueTime.usec);
+    }
     Tk_HandleEvent(&wevPtr->event);
     CleanUpTkEvent(&wevPtr->event);
     return 1;
@@ -1777,6 +2303,7 @@ CleanUpTkEvent(
 	    kePtr->charValuePtr = NULL;
 	    kePtr->charValueLen = 0;
 	}
+	kePtr->charValueInline = 0;
 #endif
 	break;
     }
@@ -1826,6 +2353,964 @@ DelayedMotionProc(
     dispPtr->delayedMotionPtr = NULL;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * DelayedWheelProc --
+ *
+ *	This function is invoked as an idle handler when a mouse wheel event
+ *	has been delayed. It queues the delayed event so that it will finally
+ *	be serviced.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The delayed mouse wheel event gets added to the Tcl event queue for
+ *	servicing.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DelayedWheelProc(
+    ClientData clientData)	/* Pointer to display containing a delayed
+				 * wheel event to be serviced. */
+{
+    TkDisplay *dispPtr = (TkDisplay *)clientData;
+
+    if (dispPtr->delayedWheelPtr == NULL) {
+	Tcl_Panic("DelayedWheelProc found no delayed mouse wheel event");
+    }
+    Tcl_QueueEvent(&dispPtr->delayedWheelPtr->header, TCL_QUEUE_TAIL);
+    dispPtr->delayedWheelPtr = NULL;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DelayedExposeProc --
+ *
+ *	This function is invoked as an idle handler when an expose event has
+ *	been delayed. It queues the merged event so that the exposed region
+ *	will finally be repainted.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The delayed expose event gets added to the Tcl event queue for
+ *	servicing.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DelayedExposeProc(
+    ClientData clientData)	/* Pointer to display containing a delayed
+				 * expose event to be serviced. */
+{
+    TkDisplay *dispPtr = (TkDisplay *)clientData;
+
+    if (dispPtr->delayedExposePtr == NULL) {
+	Tcl_Panic("DelayedExposeProc found no delayed expose event");
+    }
+    Tcl_QueueEvent(&dispPtr->delayedExposePtr->header, TCL_QUEUE_TAIL);
+    dispPtr->delayedExposePtr = NULL;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DelayedConfigureProc --
+ *
+ *	This function is invoked as an idle handler when a ConfigureNotify
+ *	event has been delayed. It queues the surviving event so that the
+ *	final geometry will finally be processed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The delayed configure event gets added to the Tcl event queue for
+ *	servicing.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DelayedConfigureProc(
+    ClientData clientData)	/* Pointer to display containing a delayed
+				 * configure event to be serviced. */
+{
+    TkDisplay *dispPtr = (TkDisplay *)clientData;
+
+    if (dispPtr->delayedConfigurePtr == NULL) {
+	Tcl_Panic("DelayedConfigureProc found no delayed configure event");
+    }
+    Tcl_QueueEvent(&dispPtr->delayedConfigurePtr->header, TCL_QUEUE_TAIL);
+    dispPtr->delayedConfigurePtr = NULL;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkEventGetStatsObj --
+ *
+ *	Build a report of the event dispatch statistics collected in this
+ *	thread, for the "tk eventstats" command.
+ *
+ * Results:
+ *	A dictionary object keyed by event type name. Each value is a
+ *	dictionary with the keys "count", "queuetime", "handlertime" and
+ *	"maxtime"; the times are cumulative (respectively maximum)
+ *	microseconds. Event types that have not been seen are omitted.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tcl_Obj *
+TkEventGetStatsObj(void)
+{
+    Tcl_Obj *resultObj = Tcl_NewDictObj();
+    int type;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    for (type = 0; type < TK_LASTEVENT; ++type) {
+	const EventStats *statsPtr = &tsdPtr->eventStats[type];
+	Tcl_Obj *entryObj;
+
+	if ((statsPtr->count == 0) || (eventStatsNames[type] == NULL)) {
+	    continue;
+	}
+	entryObj = Tcl_NewDictObj();
+	Tcl_DictObjPut(NULL, entryObj,
+		Tcl_NewStringObj("count", TCL_INDEX_NONE),
+		Tcl_NewWideIntObj(statsPtr->count));
+	Tcl_DictObjPut(NULL, entryObj,
+		Tcl_NewStringObj("queuetime", TCL_INDEX_NONE),
+		Tcl_NewWideIntObj(statsPtr->queueTime));
+	Tcl_DictObjPut(NULL, entryObj,
+		Tcl_NewStringObj("handlertime", TCL_INDEX_NONE),
+		Tcl_NewWideIntObj(statsPtr->handlerTime));
+	Tcl_DictObjPut(NULL, entryObj,
+		Tcl_NewStringObj("maxtime", TCL_INDEX_NONE),
+		Tcl_NewWideIntObj(statsPtr->maxHandlerTime));
+	Tcl_DictObjPut(NULL, resultObj,
+		Tcl_NewStringObj(eventStatsNames[type], TCL_INDEX_NONE),
+		entryObj);
+    }
+    return resultObj;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkEventResetStats --
+ *
+ *	Reset the event dispatch statistics collected in this thread.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	All counters and accumulated times are zeroed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkEventResetStats(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    memset(tsdPtr->eventStats, 0, sizeof(tsdPtr->eventStats));
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkPaintSetRecording, TkPaintRecording, TkPaintSetFlash,
+ * TkPaintGetFlash --
+ *
+ *	Control the repaint instrumentation for the "tk paintstats" command.
+ *	TkPaintRecording is the query the display procedures make before
+ *	collecting timestamps: it is true whenever either statistics
+ *	recording or damage flashing is on, since both need TkRecordPaint to
+ *	be called.
+ *
+ * Results:
+ *	The query functions return the current settings.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkPaintSetRecording(
+    int onOff)			/* 1 to collect repaint statistics, 0 to
+				 * stop. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    tsdPtr->paintRecording = onOff;
+}
+
+int
+TkPaintRecording(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    return tsdPtr->paintRecording || tsdPtr->paintFlash;
+}
+
+void
+TkPaintSetFlash(
+    int onOff)			/* 1 to flash repainted areas, 0 to stop. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    tsdPtr->paintFlash = onOff;
+}
+
+int
+TkPaintGetFlash(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    return tsdPtr->paintFlash;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkRecordPaint --
+ *
+ *	Called by the widget display procedures after they finish repainting
+ *	a window, when TkPaintRecording returned true before the repaint
+ *	began. Accumulates the per-window statistics reported by
+ *	"tk paintstats".
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Updates the paint statistics table. When damage flashing is on, the
+ *	repainted rectangle is inverted on the screen so that repaint
+ *	activity (and its extent) is visible; the inversion stays until the
+ *	area is painted again.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkRecordPaint(
+    Tk_Window tkwin,		/* Window that was just repainted. */
+    const Tcl_Time *startPtr,	/* Time at which the repaint began. */
+    int x, int y,		/* Damage rectangle that was repainted, in */
+    int width, int height)	/* window coordinates. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (tsdPtr->paintRecording) {
+	Tcl_Time now;
+	Tcl_WideInt elapsed;
+	Tcl_HashEntry *hPtr;
+	PaintStats *statsPtr;
+	int isNew;
+
+	Tcl_GetTime(&now);
+	elapsed = (Tcl_WideInt)(now.sec - startPtr->sec) * 1000000
+		+ (now.usec - startPtr->usec);
+	if (!tsdPtr->paintTableInit) {
+	    Tcl_InitHashTable(&tsdPtr->paintTable, TCL_STRING_KEYS);
+	    tsdPtr->paintTableInit = 1;
+	}
+	hPtr = Tcl_CreateHashEntry(&tsdPtr->paintTable, Tk_PathName(tkwin),
+		&isNew);
+	if (isNew) {
+	    statsPtr = (PaintStats *)ckalloc(sizeof(PaintStats));
+	    memset(statsPtr, 0, sizeof(PaintStats));
+	    Tcl_SetHashValue(hPtr, statsPtr);
+	} else {
+	    statsPtr = (PaintStats *)Tcl_GetHashValue(hPtr);
+	}
+	statsPtr->paints++;
+	statsPtr->paintTime += elapsed;
+	if (elapsed > statsPtr->maxPaintTime) {
+	    statsPtr->maxPaintTime = elapsed;
+	}
+	statsPtr->lastPaintTime = elapsed;
+	statsPtr->lastX = x;
+	statsPtr->lastY = y;
+	statsPtr->lastWidth = width;
+	statsPtr->lastHeight = height;
+    }
+    if (tsdPtr->paintFlash && (width > 0) && (height > 0)
+	    && (Tk_WindowId(tkwin) != None)) {
+	XGCValues gcValues;
+	GC gc;
+
+	gcValues.function = GXinvert;
+	gc = Tk_GetGC(tkwin, GCFunction, &gcValues);
+	XFillRectangle(Tk_Display(tkwin), Tk_WindowId(tkwin), gc, x, y,
+		(unsigned) width, (unsigned) height);
+	Tk_FreeGC(Tk_Display(tkwin), gc);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkPaintGetStatsObj --
+ *
+ *	Build a report of the repaint statistics collected in this thread,
+ *	for the "tk paintstats" command.
+ *
+ * Results:
+ *	A dictionary object. The "windows" entry maps window path names to
+ *	dictionaries with the keys "count", "painttime", "maxtime" and
+ *	"lasttime" (cumulative, respectively single-repaint, microseconds)
+ *	and "lastdamage" (the most recent damage rectangle as a list of x, y,
+ *	width and height). The "idledepth" entry reports how many callbacks
+ *	are currently queued on each tier of the idle scheduler, and the
+ *	"recording" and "flash" entries report the instrumentation settings.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tcl_Obj *
+TkPaintGetStatsObj(void)
+{
+    static const char *const tierNames[TK_IDLE_NUM_TIERS] = {
+	"layout", "display", "deferred"
+    };
+    Tcl_Obj *resultObj = Tcl_NewDictObj();
+    Tcl_Obj *windowsObj = Tcl_NewDictObj();
+    Tcl_Obj *idleObj = Tcl_NewDictObj();
+    int tier;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (tsdPtr->paintTableInit) {
+	Tcl_HashEntry *hPtr;
+	Tcl_HashSearch search;
+
+	for (hPtr = Tcl_FirstHashEntry(&tsdPtr->paintTable, &search);
+		hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	    const PaintStats *statsPtr = (const PaintStats *)
+		    Tcl_GetHashValue(hPtr);
+	    Tcl_Obj *entryObj = Tcl_NewDictObj();
+	    Tcl_Obj *damageObj = Tcl_NewObj();
+
+	    Tcl_DictObjPut(NULL, entryObj,
+		    Tcl_NewStringObj("count", TCL_INDEX_NONE),
+		    Tcl_NewWideIntObj(statsPtr->paints));
+	    Tcl_DictObjPut(NULL, entryObj,
+		    Tcl_NewStringObj("painttime", TCL_INDEX_NONE),
+		    Tcl_NewWideIntObj(statsPtr->paintTime));
+	    Tcl_DictObjPut(NULL, entryObj,
+		    Tcl_NewStringObj("maxtime", TCL_INDEX_NONE),
+		    Tcl_NewWideIntObj(statsPtr->maxPaintTime));
+	    Tcl_DictObjPut(NULL, entryObj,
+		    Tcl_NewStringObj("lasttime", TCL_INDEX_NONE),
+		    Tcl_NewWideIntObj(statsPtr->lastPaintTime));
+	    Tcl_ListObjAppendElement(NULL, damageObj,
+		    Tcl_NewWideIntObj(statsPtr->lastX));
+	    Tcl_ListObjAppendElement(NULL, damageObj,
+		    Tcl_NewWideIntObj(statsPtr->lastY));
+	    Tcl_ListObjAppendElement(NULL, damageObj,
+		    Tcl_NewWideIntObj(statsPtr->lastWidth));
+	    Tcl_ListObjAppendElement(NULL, damageObj,
+		    Tcl_NewWideIntObj(statsPtr->lastHeight));
+	    Tcl_DictObjPut(NULL, entryObj,
+		    Tcl_NewStringObj("lastdamage", TCL_INDEX_NONE),
+		    damageObj);
+	    Tcl_DictObjPut(NULL, windowsObj, Tcl_NewStringObj(
+		    (const char *)Tcl_GetHashKey(&tsdPtr->paintTable, hPtr),
+		    TCL_INDEX_NONE), entryObj);
+	}
+    }
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("recording", TCL_INDEX_NONE),
+	    Tcl_NewBooleanObj(tsdPtr->paintRecording));
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("flash", TCL_INDEX_NONE),
+	    Tcl_NewBooleanObj(tsdPtr->paintFlash));
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("windows", TCL_INDEX_NONE), windowsObj);
+    for (tier = 0; tier < TK_IDLE_NUM_TIERS; tier++) {
+	TieredIdle *idlePtr;
+	Tcl_WideInt depth = 0;
+
+	for (idlePtr = tsdPtr->idleHeads[tier]; idlePtr != NULL;
+		idlePtr = idlePtr->nextPtr) {
+	    depth++;
+	}
+	Tcl_DictObjPut(NULL, idleObj,
+		Tcl_NewStringObj(tierNames[tier], TCL_INDEX_NONE),
+		Tcl_NewWideIntObj(depth));
+    }
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("idledepth", TCL_INDEX_NONE), idleObj);
+    return resultObj;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkPaintResetStats --
+ *
+ *	Reset the repaint statistics collected in this thread.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	All per-window records are freed; the recording and flash settings
+ *	are left alone.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkPaintResetStats(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (tsdPtr->paintTableInit) {
+	Tcl_HashEntry *hPtr;
+	Tcl_HashSearch search;
+
+	for (hPtr = Tcl_FirstHashEntry(&tsdPtr->paintTable, &search);
+		hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	    ckfree(Tcl_GetHashValue(hPtr));
+	}
+	Tcl_DeleteHashTable(&tsdPtr->paintTable);
+	tsdPtr->paintTableInit = 0;
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkDoWhenIdle --
+ *
+ *	Arrange for a function to be called the next time the event loop is
+ *	idle, like Tcl_DoWhenIdle, but ordered by tier: all TK_IDLE_LAYOUT
+ *	callbacks run before any TK_IDLE_DISPLAY callback, which in turn run
+ *	before any TK_IDLE_DEFERRED callback, regardless of the order in
+ *	which they were scheduled. Widgets use this so that geometry
+ *	recalculation cannot run after a repaint and force a second repaint.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	proc will be called with clientData during the next idle period.
+ *	Callbacks scheduled this way must be cancelled with
+ *	TkCancelDoWhenIdle, not Tcl_CancelIdleCall.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkDoWhenIdle(
+    Tcl_IdleProc *proc,		/* Function to call. */
+    ClientData clientData,	/* Value to pass to proc. */
+    int tier)			/* One of TK_IDLE_LAYOUT, TK_IDLE_DISPLAY or
+				 * TK_IDLE_DEFERRED. */
+{
+    TieredIdle *idlePtr;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    assert(tier >= 0 && tier < TK_IDLE_NUM_TIERS);
+
+    idlePtr = (TieredIdle *)ckalloc(sizeof(TieredIdle));
+    idlePtr->proc = proc;
+    idlePtr->clientData = clientData;
+    idlePtr->nextPtr = NULL;
+    if (tsdPtr->idleHeads[tier] == NULL) {
+	tsdPtr->idleHeads[tier] = idlePtr;
+    } else {
+	tsdPtr->idleTails[tier]->nextPtr = idlePtr;
+    }
+    tsdPtr->idleTails[tier] = idlePtr;
+
+    if (tsdPtr->idleFrozen) {
+	return;			/* TkIdleThaw re-arms the pump. */
+    }
+    if (tsdPtr->frameClockOn) {
+	FrameScheduleTick(tsdPtr);
+    } else if (!tsdPtr->idlePumpPending) {
+	tsdPtr->idlePumpPending = 1;
+	Tcl_DoWhenIdle(TieredIdleProc, NULL);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkCancelDoWhenIdle --
+ *
+ *	Cancel callbacks scheduled with TkDoWhenIdle. All queued callbacks
+ *	matching both proc and clientData are removed, in any tier.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Matching callbacks will not be invoked.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkCancelDoWhenIdle(
+    Tcl_IdleProc *proc,		/* Function that was scheduled. */
+    ClientData clientData)	/* Value that was passed to TkDoWhenIdle. */
+{
+    int tier;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    for (tier = 0; tier < TK_IDLE_NUM_TIERS; ++tier) {
+	TieredIdle *idlePtr = tsdPtr->idleHeads[tier];
+	TieredIdle *prevPtr = NULL;
+
+	while (idlePtr != NULL) {
+	    TieredIdle *nextPtr = idlePtr->nextPtr;
+
+	    if ((idlePtr->proc == proc)
+		    && (idlePtr->clientData == clientData)) {
+		if (prevPtr == NULL) {
+		    tsdPtr->idleHeads[tier] = nextPtr;
+		} else {
+		    prevPtr->nextPtr = nextPtr;
+		}
+		if (nextPtr == NULL) {
+		    tsdPtr->idleTails[tier] = prevPtr;
+		}
+		ckfree(idlePtr);
+	    } else {
+		prevPtr = idlePtr;
+	    }
+	    idlePtr = nextPtr;
+	}
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkIdleFreeze, TkIdleThaw, TkIdleDrain --
+ *
+ *	Suspend and resume the tiered idle queues. While at least one
+ *	TkIdleFreeze call is outstanding, callbacks scheduled with
+ *	TkDoWhenIdle accumulate but are not run, even if the event loop goes
+ *	idle; this is how a construction transaction (see
+ *	TkWmTransactionBegin) holds layout and repaint work while a dialog
+ *	is being populated. TkIdleThaw lifts one freeze and, once none
+ *	remain, re-arms the idle pump so the held callbacks run. TkIdleDrain
+ *	runs them immediately instead, for callers that need the queues
+ *	settled before continuing; it does nothing while a freeze is in
+ *	effect.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	See above.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkIdleFreeze(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    tsdPtr->idleFrozen++;
+}
+
+void
+TkIdleThaw(void)
+{
+    int tier;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if ((tsdPtr->idleFrozen <= 0) || (--tsdPtr->idleFrozen > 0)) {
+	return;
+    }
+    for (tier = 0; tier < TK_IDLE_NUM_TIERS; ++tier) {
+	if (tsdPtr->idleHeads[tier] != NULL) {
+	    if (tsdPtr->frameClockOn) {
+		FrameScheduleTick(tsdPtr);
+	    } else if (!tsdPtr->idlePumpPending) {
+		tsdPtr->idlePumpPending = 1;
+		Tcl_DoWhenIdle(TieredIdleProc, NULL);
+	    }
+	    break;
+	}
+    }
+}
+
+void
+TkIdleDrain(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (!tsdPtr->idleFrozen) {
+	DrainIdleTiers(tsdPtr);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TieredIdleProc --
+ *
+ *	This function is invoked by Tcl_DoWhenIdle to drain the tiered idle
+ *	queues. Each tier is snapshot just before it is drained, so a layout
+ *	callback that schedules a repaint gets that repaint run in the same
+ *	idle period, while callbacks added to a tier that has already been
+ *	drained wait for the next idle period (matching the semantics of
+ *	Tcl_DoWhenIdle).
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Whatever the queued callbacks do.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+TieredIdleProc(
+    TCL_UNUSED(void *))
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    tsdPtr->idlePumpPending = 0;
+    DrainIdleTiers(tsdPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DrainIdleTiers --
+ *
+ *	Run and empty the tiered idle queues, lowest tier first. Common code
+ *	for TieredIdleProc and FrameTickProc.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Whatever the queued callbacks do. The layout tier is re-drained until
+ *	it settles, so nested geometry manager ripples complete within one
+ *	call; callbacks added to the other tiers while they are being drained
+ *	run in the next idle period or frame.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DrainIdleTiers(
+    ThreadSpecificData *tsdPtr)	/* Thread whose queues to drain. */
+{
+    int tier;
+
+    if (tsdPtr->idleFrozen) {
+	return;
+    }
+
+    for (tier = 0; tier < TK_IDLE_NUM_TIERS; ++tier) {
+	int rounds = 0;
+
+	do {
+	    TieredIdle *idlePtr = tsdPtr->idleHeads[tier];
+
+	    tsdPtr->idleHeads[tier] = NULL;
+	    tsdPtr->idleTails[tier] = NULL;
+	    while (idlePtr != NULL) {
+		TieredIdle *nextPtr = idlePtr->nextPtr;
+
+		idlePtr->proc(idlePtr->clientData);
+		ckfree(idlePtr);
+		idlePtr = nextPtr;
+	    }
+
+	    /*
+	     * Layout callbacks commonly schedule more layout work: a child
+	     * manager's arrange requests a new size for its container,
+	     * which queues the container's arrange. Re-drain the layout
+	     * tier until it settles so the whole ripple resolves in this
+	     * idle period, before any repaint from the display tier.
+	     */
+	} while ((tier == TK_IDLE_LAYOUT)
+		&& (tsdPtr->idleHeads[tier] != NULL)
+		&& (++rounds < LAYOUT_SETTLE_ROUNDS));
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * FrameScheduleTick --
+ *
+ *	Make sure a frame tick is scheduled, without disturbing one that is
+ *	already pending.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	A timer handler may be created.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+FrameScheduleTick(
+    ThreadSpecificData *tsdPtr)	/* Thread in which to schedule the tick. */
+{
+    if (!tsdPtr->frameTickPending) {
+	int interval = (tsdPtr->frameInterval > 0)
+		? tsdPtr->frameInterval : FRAME_INTERVAL_DEFAULT;
+
+	tsdPtr->frameTickPending = 1;
+	tsdPtr->frameTimer = Tcl_CreateTimerHandler(interval, FrameTickProc,
+		NULL);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * FrameTickProc --
+ *
+ *	Timer handler for the frame clock. Runs the one-shot frame callbacks
+ *	registered with "tk frameclock callback" and then drains the tiered
+ *	idle queues, so that repaints requested by the callbacks are flushed
+ *	in the same frame. Work scheduled while the tick is running goes
+ *	through TkDoWhenIdle or TkFrameClockAddCallback again, which arrange
+ *	for the next tick; an idle frame clock therefore costs nothing.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Whatever the callbacks do.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+FrameTickProc(
+    TCL_UNUSED(void *))
+{
+    FrameCallback *cbPtr;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    tsdPtr->frameTickPending = 0;
+
+    cbPtr = tsdPtr->frameCbHead;
+    tsdPtr->frameCbHead = NULL;
+    tsdPtr->frameCbTail = NULL;
+    while (cbPtr != NULL) {
+	FrameCallback *nextPtr = cbPtr->nextPtr;
+	Tcl_Interp *interp = cbPtr->interp;
+
+	if (Tcl_EvalObjEx(interp, cbPtr->scriptObj,
+		TCL_EVAL_GLOBAL) != TCL_OK) {
+	    Tcl_AddErrorInfo(interp, "\n    (frame clock callback)");
+	    Tcl_BackgroundException(interp, TCL_ERROR);
+	}
+	Tcl_Release(interp);
+	Tcl_DecrRefCount(cbPtr->scriptObj);
+	ckfree(cbPtr);
+	cbPtr = nextPtr;
+    }
+
+    DrainIdleTiers(tsdPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkFrameClockSet, TkFrameClockGet --
+ *
+ *	Turn the frame clock on or off for the current thread, or query its
+ *	state. While the frame clock is on, callbacks scheduled with
+ *	TkDoWhenIdle are batched and run on frame ticks instead of whenever
+ *	the event loop goes idle, so that at most one repaint per frame
+ *	reaches the display.
+ *
+ * Results:
+ *	TkFrameClockGet returns non-zero if the frame clock is on.
+ *
+ * Side effects:
+ *	Work already queued for the next idle period is moved onto the frame
+ *	clock, or back again when the clock is turned off.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkFrameClockSet(
+    int onOff)			/* Non-zero to enable the frame clock. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    onOff = (onOff != 0);
+    if (onOff == tsdPtr->frameClockOn) {
+	return;
+    }
+    tsdPtr->frameClockOn = onOff;
+    if (onOff) {
+	if (tsdPtr->idlePumpPending) {
+	    Tcl_CancelIdleCall(TieredIdleProc, NULL);
+	    tsdPtr->idlePumpPending = 0;
+	    FrameScheduleTick(tsdPtr);
+	}
+    } else {
+	/*
+	 * Keep the timer if frame callbacks are waiting on it; they only
+	 * ever run from a tick.
+	 */
+
+	if (tsdPtr->frameTickPending && (tsdPtr->frameCbHead == NULL)) {
+	    Tcl_DeleteTimerHandler(tsdPtr->frameTimer);
+	    tsdPtr->frameTickPending = 0;
+	}
+	if (!tsdPtr->idlePumpPending
+		&& ((tsdPtr->idleHeads[TK_IDLE_LAYOUT] != NULL)
+		|| (tsdPtr->idleHeads[TK_IDLE_DISPLAY] != NULL)
+		|| (tsdPtr->idleHeads[TK_IDLE_DEFERRED] != NULL))) {
+	    tsdPtr->idlePumpPending = 1;
+	    Tcl_DoWhenIdle(TieredIdleProc, NULL);
+	}
+    }
+}
+
+int
+TkFrameClockGet(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    return tsdPtr->frameClockOn;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkFrameClockSetInterval, TkFrameClockGetInterval --
+ *
+ *	Set or query the number of milliseconds between frame ticks. A new
+ *	interval takes effect when the next tick is scheduled; a tick that is
+ *	already pending is not re-armed.
+ *
+ * Results:
+ *	TkFrameClockGetInterval returns the current interval.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkFrameClockSetInterval(
+    int interval)		/* Milliseconds between ticks; must be
+				 * positive. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    tsdPtr->frameInterval = interval;
+}
+
+int
+TkFrameClockGetInterval(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    return (tsdPtr->frameInterval > 0)
+	    ? tsdPtr->frameInterval : FRAME_INTERVAL_DEFAULT;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkFrameClockAddCallback --
+ *
+ *	Register a script to be evaluated once, just before the next frame's
+ *	repaints are flushed. Scripts run in the order they were registered.
+ *	A tick is scheduled even if the frame clock is off, so the script
+ *	always runs.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The interpreter is preserved and the script retained until the tick
+ *	fires.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkFrameClockAddCallback(
+    Tcl_Interp *interp,		/* Interpreter in which to evaluate the
+				 * script. */
+    Tcl_Obj *scriptObj)		/* Script to evaluate on the next tick. */
+{
+    FrameCallback *cbPtr;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    cbPtr = (FrameCallback *)ckalloc(sizeof(FrameCallback));
+    cbPtr->interp = interp;
+    cbPtr->scriptObj = scriptObj;
+    cbPtr->nextPtr = NULL;
+    Tcl_Preserve(interp);
+    Tcl_IncrRefCount(scriptObj);
+    if (tsdPtr->frameCbHead == NULL) {
+	tsdPtr->frameCbHead = cbPtr;
+    } else {
+	tsdPtr->frameCbTail->nextPtr = cbPtr;
+    }
+    tsdPtr->frameCbTail = cbPtr;
+    FrameScheduleTick(tsdPtr);
+}
+
 /*
  *----------------------------------------------------------------------
  *
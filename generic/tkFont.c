@@ -100,11 +100,31 @@ typedef struct TextLayout {
 				 * layout. */
     Tcl_Size numChunks;		/* Number of chunks actually used in following
 				 * array. */
+    int maxChunks;		/* Number of chunks the following array has
+				 * been allocated for; used when the layout is
+				 * recycled through the per-thread pool. */
     LayoutChunk chunks[TKFLEXARRAY];/* Array of chunks. The actual size will be
 				 * maxChunks. THIS FIELD MUST BE THE LAST IN
 				 * THE STRUCTURE. */
 } TextLayout;
 
+/*
+ * Freed text layouts are kept on a small per-thread free list, so that the
+ * compute/free cycle that the simple widgets go through on every geometry
+ * change does not allocate.
+ */
+
+#define LAYOUT_POOL_SIZE 8
+
+typedef struct ThreadSpecificData {
+    TextLayout *layoutPool[LAYOUT_POOL_SIZE];
+				/* Free text layouts available for reuse. */
+    int numPooledLayouts;	/* Number of valid entries in layoutPool. */
+    int poolExitHandlerSet;	/* Non-zero means the thread exit handler that
+				 * empties the pool has been created. */
+} ThreadSpecificData;
+static Tcl_ThreadDataKey dataKey;
+
 /*
  * The following structures are used as two-way maps between the values for
  * the fields in the TkFontAttributes structure and the strings used in Tcl,
@@ -332,16 +352,24 @@ static int		ConfigAttributesObj(Tcl_Interp *interp,
 			    TkFontAttributes *faPtr);
 static void		DupFontObjProc(Tcl_Obj *srcObjPtr, Tcl_Obj *dupObjPtr);
 static int		FieldSpecified(const char *field);
+static const char *	FindSpecialChar(const char *p, const char *end,
+			    int flags);
 static void		FreeFontObj(Tcl_Obj *objPtr);
 static void		FreeFontObjProc(Tcl_Obj *objPtr);
 static int		GetAttributeInfoObj(Tcl_Interp *interp,
 			    const TkFontAttributes *faPtr, Tcl_Obj *objPtr);
+static int		MeasureCharsCached(Tk_Font tkfont,
+			    const char *source, Tcl_Size numBytes,
+			    int maxLength, int flags, int *lengthPtr);
 static LayoutChunk *	NewChunk(TextLayout **layoutPtrPtr, int *maxPtr,
 			    const char *start, Tcl_Size numChars, int curX,
 			    int newX, int y);
+static TextLayout *	PoolAllocLayout(int *maxChunksPtr);
+static void		FreeLayoutPool(void *clientData);
 static int		ParseFontNameObj(Tcl_Interp *interp, Tk_Window tkwin,
 			    Tcl_Obj *objPtr, TkFontAttributes *faPtr);
 static void		RecomputeWidgets(TkWindow *winPtr);
+static void		ResetAdvanceCache(TkFont *fontPtr);
 static int		SetFontFromAny(Tcl_Interp *interp, Tcl_Obj *objPtr);
 static void		TheWorldHasChanged(void *clientData);
 static void		UpdateDependentFonts(TkFontInfo *fiPtr,
@@ -642,9 +670,25 @@ Tk_FontObjCmd(
     	} else if (objc == 4) {
     	    objPtr = objv[3];
     	} else {
+	    TkFontAttributes oldfa = nfPtr->fa;
+
     	    result = ConfigAttributesObj(interp, tkwin, objc - 3, objv + 3,
     		    &nfPtr->fa);
-    	    UpdateDependentFonts(fiPtr, tkwin, namedHashPtr);
+
+	    /*
+	     * Only schedule the world-changed pass when an attribute
+	     * actually changed; reconfiguring a named font to the values it
+	     * already has must not re-lay-out every widget in the tree.
+	     */
+
+	    if (oldfa.family != nfPtr->fa.family
+		    || oldfa.size != nfPtr->fa.size
+		    || oldfa.weight != nfPtr->fa.weight
+		    || oldfa.slant != nfPtr->fa.slant
+		    || oldfa.underline != nfPtr->fa.underline
+		    || oldfa.overstrike != nfPtr->fa.overstrike) {
+		UpdateDependentFonts(fiPtr, tkwin, namedHashPtr);
+	    }
     	    return result;
     	}
     	return GetAttributeInfoObj(interp, &nfPtr->fa, objPtr);
@@ -854,6 +898,7 @@ UpdateDependentFonts(
     Tcl_HashEntry *cacheHashPtr;
     Tcl_HashSearch search;
     TkFont *fontPtr;
+    int anyChanged = 0;
     NamedFont *nfPtr = (NamedFont *)Tcl_GetHashValue(namedHashPtr);
 
     if (nfPtr->refCount == 0) {
@@ -871,14 +916,24 @@ UpdateDependentFonts(
 		fontPtr != NULL; fontPtr = fontPtr->nextPtr) {
 	    if (fontPtr->namedHashPtr == namedHashPtr) {
 		TkpGetFontFromAttributes(fontPtr, tkwin, &nfPtr->fa);
-		if (!fiPtr->updatePending) {
-		    fiPtr->updatePending = 1;
-		    Tcl_DoWhenIdle(TheWorldHasChanged, fiPtr);
-		}
+		ResetAdvanceCache(fontPtr);
+		anyChanged = 1;
 	    }
 	}
 	cacheHashPtr = Tcl_NextHashEntry(&search);
     }
+
+    /*
+     * All dependent notifications funnel into a single idle callback, so a
+     * burst of named font changes (an application-wide zoom touches several
+     * named fonts at once) still costs exactly one recomputation pass over
+     * the widget tree.
+     */
+
+    if (anyChanged && !fiPtr->updatePending) {
+	fiPtr->updatePending = 1;
+	Tcl_DoWhenIdle(TheWorldHasChanged, fiPtr);
+    }
 }
 
 static void
@@ -889,12 +944,14 @@ TheWorldHasChanged(
 
     /*
      * On macOS it is catastrophic to recompute all widgets while the
-     * [NSView drawRect] method is drawing. The best that we can do in
-     * that situation is to abort the recomputation and hope for the best.
-     * This is ignored on other platforms.
+     * [NSView drawRect] method is drawing. Defer the recomputation to the
+     * next idle round instead; updatePending stays set so further font
+     * changes keep coalescing into this one pass. This is a no-op on other
+     * platforms.
      */
 
     if (TkpWillDrawWidget(NULL)) {
+	Tcl_DoWhenIdle(TheWorldHasChanged, fiPtr);
 	return;
     }
 
@@ -1239,6 +1296,9 @@ Tk_AllocFontFromObj(
     fontPtr->nextPtr = firstFontPtr;
     Tcl_SetHashValue(cacheHashPtr, fontPtr);
 
+    fontPtr->ucAdvanceTablePtr = NULL;
+    ResetAdvanceCache(fontPtr);
+
     Tk_MeasureChars((Tk_Font) fontPtr, "0", 1, -1, 0, &fontPtr->tabWidth);
     if (fontPtr->tabWidth == 0) {
 	fontPtr->tabWidth = fontPtr->fm.maxWidth;
@@ -1487,6 +1547,11 @@ Tk_FreeFont(
 	prevPtr->nextPtr = fontPtr->nextPtr;
     }
 
+    if (fontPtr->ucAdvanceTablePtr != NULL) {
+	Tcl_DeleteHashTable(fontPtr->ucAdvanceTablePtr);
+	ckfree(fontPtr->ucAdvanceTablePtr);
+	fontPtr->ucAdvanceTablePtr = NULL;
+    }
     TkpDeleteFont(fontPtr);
     if (fontPtr->objRefCount == 0) {
 	ckfree(fontPtr);
@@ -1860,9 +1925,131 @@ Tk_TextWidth(
     if (numBytes < 0) {
 	numBytes = strlen(string);
     }
-    Tk_MeasureChars(tkfont, string, numBytes, -1, 0, &width);
+    MeasureCharsCached(tkfont, string, numBytes, -1, 0, &width);
     return width;
 }
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * MeasureCharsCached, ResetAdvanceCache --
+ *
+ *	MeasureCharsCached is a fast path in front of Tk_MeasureChars for the
+ *	common case of measuring a whole string without a length limit. Per
+ *	character advances are cached on the TkFont (a direct-mapped array
+ *	for 7-bit characters, a hash table for the rest) and summed, so
+ *	repeated measurement of the same UI strings does not re-enter the
+ *	platform font engine. This relies on the platform measurement being
+ *	additive per character, which holds for the per-character loops used
+ *	by the Tk_MeasureChars implementations. Calls with a length limit, or
+ *	for strings containing control characters (which the platform code
+ *	expands to backslash sequences), are passed through unchanged.
+ *
+ *	ResetAdvanceCache empties the cache; it must be called when the font
+ *	is created and whenever the underlying platform font changes.
+ *
+ * Results:
+ *	MeasureCharsCached returns the number of bytes considered and stores
+ *	the total width in *lengthPtr, like Tk_MeasureChars.
+ *
+ * Side effects:
+ *	Advances for characters measured for the first time are remembered
+ *	on the font.
+ *
+ *---------------------------------------------------------------------------
+ */
+
+static int
+MeasureCharsCached(
+    Tk_Font tkfont,		/* Font in which characters will be drawn. */
+    const char *source,		/* UTF-8 string to be displayed. */
+    Tcl_Size numBytes,		/* Maximum number of bytes to consider from
+				 * source string. */
+    int maxLength,		/* Pixel limit, or < 0 for unlimited. */
+    int flags,			/* Various flag bits OR-ed together, see
+				 * Tk_MeasureChars. */
+    int *lengthPtr)		/* Filled with x-location just after the
+				 * terminating character. */
+{
+    TkFont *fontPtr = (TkFont *) tkfont;
+    const char *p = source;
+    const char *end = source + numBytes;
+    int width = 0;
+
+    if (maxLength >= 0) {
+	/*
+	 * A pixel limit changes which characters are consumed; leave such
+	 * calls to the platform code.
+	 */
+
+	return Tk_MeasureChars(tkfont, source, numBytes, maxLength, flags,
+		lengthPtr);
+    }
+
+    while (p < end) {
+	unsigned char c = UCHAR(*p);
+	int advance;
+
+	if (c < 0x80) {
+	    if ((c < 0x20) || (c == 0x7F)) {
+		/*
+		 * Control characters get special, platform-dependent
+		 * treatment; measure the whole string the slow way.
+		 */
+
+		return Tk_MeasureChars(tkfont, source, numBytes, maxLength,
+			flags, lengthPtr);
+	    }
+	    advance = fontPtr->asciiAdvance[c];
+	    if (advance < 0) {
+		Tk_MeasureChars(tkfont, p, 1, -1, 0, &advance);
+		fontPtr->asciiAdvance[c] = advance;
+	    }
+	    p++;
+	} else {
+	    int uc;
+	    Tcl_Size charBytes = Tcl_UtfToUniChar(p, &uc);
+	    Tcl_HashEntry *hPtr;
+	    int isNew;
+
+	    if (fontPtr->ucAdvanceTablePtr == NULL) {
+		fontPtr->ucAdvanceTablePtr = (Tcl_HashTable *)
+			ckalloc(sizeof(Tcl_HashTable));
+		Tcl_InitHashTable(fontPtr->ucAdvanceTablePtr,
+			TCL_ONE_WORD_KEYS);
+	    }
+	    hPtr = Tcl_CreateHashEntry(fontPtr->ucAdvanceTablePtr,
+		    INT2PTR(uc), &isNew);
+	    if (isNew) {
+		Tk_MeasureChars(tkfont, p, charBytes, -1, 0, &advance);
+		Tcl_SetHashValue(hPtr, INT2PTR(advance));
+	    } else {
+		advance = PTR2INT(Tcl_GetHashValue(hPtr));
+	    }
+	    p += charBytes;
+	}
+	width += advance;
+    }
+
+    *lengthPtr = width;
+    return (int) numBytes;
+}
+
+static void
+ResetAdvanceCache(
+    TkFont *fontPtr)		/* Font whose cached advances to drop. */
+{
+    int i;
+
+    for (i = 0; i < 128; i++) {
+	fontPtr->asciiAdvance[i] = -1;
+    }
+    if (fontPtr->ucAdvanceTablePtr != NULL) {
+	Tcl_DeleteHashTable(fontPtr->ucAdvanceTablePtr);
+	ckfree(fontPtr->ucAdvanceTablePtr);
+	fontPtr->ucAdvanceTablePtr = NULL;
+    }
+}
 
 /*
  *---------------------------------------------------------------------------
@@ -1938,6 +2125,76 @@ TkUnderlineCharsInContext(
 	    (unsigned) fontPtr->underlineHeight);
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FindSpecialChar --
+ *
+ *	Find the next tab or newline character that Tk_ComputeTextLayout has
+ *	to treat specially. The scan proceeds one machine word at a time: all
+ *	characters of interest are control characters (< 0x20), so a word
+ *	containing none can be skipped with a couple of arithmetic
+ *	operations. UTF-8 continuation bytes have the high bit set and never
+ *	match. For the pure text that dominates relayout this replaces the
+ *	old per-character loop with a word-at-a-time classification.
+ *
+ * Results:
+ *	Returns a pointer to the first special character at or after p, or
+ *	end if there is none.
+ *
+ * Side effects:
+ *	None.
+ *
+ *---------------------------------------------------------------------------
+ */
+
+static const char *
+FindSpecialChar(
+    const char *p,		/* Start of the text to scan. */
+    const char *end,		/* First byte after the text. */
+    int flags)			/* TK_IGNORE_TABS means tab characters are
+				 * not special. TK_IGNORE_NEWLINES means
+				 * newline characters are not special. */
+{
+    const unsigned long ones = (unsigned long) -1 / 255;    /* 0x0101...01 */
+    const unsigned long highs = ones << 7;		    /* 0x8080...80 */
+
+    if ((flags & TK_IGNORE_TABS) && (flags & TK_IGNORE_NEWLINES)) {
+	return end;
+    }
+
+    while (p < end) {
+	const char *chunkEnd;
+
+	if ((size_t) (end - p) >= sizeof(unsigned long)) {
+	    unsigned long w;
+
+	    memcpy(&w, p, sizeof(w));
+	    if (((w - ones*0x20) & ~w & highs) == 0) {
+		/*
+		 * No byte of this word is a control character.
+		 */
+
+		p += sizeof(w);
+		continue;
+	    }
+	    chunkEnd = p + sizeof(w);
+	} else {
+	    chunkEnd = end;
+	}
+	for ( ; p < chunkEnd; p++) {
+	    if (!(flags & TK_IGNORE_NEWLINES)
+		    && ((*p == '\n') || (*p == '\r'))) {
+		return p;
+	    }
+	    if (!(flags & TK_IGNORE_TABS) && (*p == '\t')) {
+		return p;
+	    }
+	}
+    }
+    return end;
+}
+
 /*
  *---------------------------------------------------------------------------
  *
@@ -2019,10 +2276,7 @@ Tk_ComputeTextLayout(
 	wrapLength = -1;
     }
 
-    maxChunks = 1;
-
-    layoutPtr = (TextLayout *)ckalloc(offsetof(TextLayout, chunks)
-	    + maxChunks * sizeof(LayoutChunk));
+    layoutPtr = PoolAllocLayout(&maxChunks);
     layoutPtr->tkfont = tkfont;
     layoutPtr->string = string;
     layoutPtr->numChunks = 0;
@@ -2046,24 +2300,13 @@ Tk_ComputeTextLayout(
 	    /*
 	     * Find the next special character in the string.
 	     *
-	     * INTL: Note that it is safe to increment by byte, because we are
+	     * INTL: Note that it is safe to scan by byte, because we are
 	     * looking for 7-bit characters that will appear unchanged in
 	     * UTF-8. At some point we may need to support the full Unicode
 	     * whitespace set.
 	     */
 
-	    for (special = start; special < endp; special++) {
-		if (!(flags & TK_IGNORE_NEWLINES)) {
-		    if ((*special == '\n') || (*special == '\r')) {
-			break;
-		    }
-		}
-		if (!(flags & TK_IGNORE_TABS)) {
-		    if (*special == '\t') {
-			break;
-		    }
-		}
-	    }
+	    special = FindSpecialChar(start, endp, flags);
 	}
 
 	/*
@@ -2073,7 +2316,7 @@ Tk_ComputeTextLayout(
 
 	chunkPtr = NULL;
 	if (start < special) {
-	    bytesThisChunk = Tk_MeasureChars(tkfont, start, special - start,
+	    bytesThisChunk = MeasureCharsCached(tkfont, start, special - start,
 		    wrapLength - curX, flags, &newX);
 	    newX += curX;
 	    flags &= ~TK_AT_LEAST_ONE;
@@ -2150,7 +2393,7 @@ Tk_ComputeTextLayout(
 	    end = chunkPtr->start + chunkPtr->numBytes;
 	    bytesThisChunk = start - end;
 	    if (bytesThisChunk > 0) {
-		bytesThisChunk = Tk_MeasureChars(tkfont, end, bytesThisChunk,
+		bytesThisChunk = MeasureCharsCached(tkfont, end, bytesThisChunk,
 			-1, 0, &chunkPtr->totalWidth);
 		chunkPtr->numBytes += bytesThisChunk;
 		chunkPtr->numChars += Tcl_NumUtfChars(end, bytesThisChunk);
@@ -2243,6 +2486,7 @@ Tk_ComputeTextLayout(
 	}
     }
 
+    layoutPtr->maxChunks = maxChunks;
     if (widthPtr != NULL) {
 	*widthPtr = layoutPtr->width;
     }
@@ -2253,6 +2497,150 @@ Tk_ComputeTextLayout(
 
     return (Tk_TextLayout) layoutPtr;
 }
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Tk_UpdateTextLayout --
+ *
+ *	Update an existing text layout for new text, reusing its storage
+ *	when possible. For the common widget case -- an unwrapped single
+ *	chunk of plain text in the same font, as in an entry being typed
+ *	into -- the chunk is re-measured in place from the per-font advance
+ *	cache and nothing is allocated or freed. In all other cases this is
+ *	equivalent to freeing the old layout and computing a new one (the
+ *	freed storage then goes through the per-thread layout pool).
+ *
+ * Results:
+ *	The return value is a Tk_TextLayout token for the new text; it may
+ *	or may not be the token passed in. The arguments have the same
+ *	meaning as for Tk_ComputeTextLayout.
+ *
+ * Side effects:
+ *	The old layout token becomes invalid and must not be used again.
+ *
+ *---------------------------------------------------------------------------
+ */
+
+Tk_TextLayout
+Tk_UpdateTextLayout(
+    Tk_TextLayout layout,	/* Layout previously computed for the same
+				 * font, or NULL. */
+    Tk_Font tkfont,		/* Font that will be used to display text. */
+    const char *string,		/* New string whose dimensions are to be
+				 * computed. */
+    Tcl_Size numChars,		/* Number of characters to consider from
+				 * string, or TCL_INDEX_NONE for strlen(). */
+    int wrapLength,		/* Longest permissible line length, in
+				 * pixels. */
+    Tk_Justify justify,		/* How to justify lines. */
+    int flags,			/* Flag bits OR-ed together, see
+				 * Tk_ComputeTextLayout. */
+    int *widthPtr,		/* Filled with width of string. */
+    int *heightPtr)		/* Filled with height of string. */
+{
+    TextLayout *layoutPtr = (TextLayout *) layout;
+    TkFont *fontPtr = (TkFont *) tkfont;
+
+    if ((layoutPtr != NULL) && (fontPtr != NULL) && (string != NULL)
+	    && (layoutPtr->tkfont == tkfont) && (wrapLength <= 0)
+	    && (layoutPtr->numChunks == 1)) {
+	const char *endp;
+	Tcl_Size numBytes;
+
+	if (numChars < 0) {
+	    numChars = Tcl_NumUtfChars(string, TCL_INDEX_NONE);
+	}
+	endp = Tcl_UtfAtIndex(string, numChars);
+	numBytes = endp - string;
+	if ((numChars > 0) && (FindSpecialChar(string, endp, 0) == endp)) {
+	    /*
+	     * The new text is again a single line without tabs, so the
+	     * layout keeps its single chunk; re-measure it in place. With a
+	     * single line, justification cannot shift anything.
+	     */
+
+	    LayoutChunk *chunkPtr = layoutPtr->chunks;
+	    int width;
+
+	    MeasureCharsCached(tkfont, string, numBytes, -1, 0, &width);
+	    layoutPtr->string = string;
+	    layoutPtr->width = width;
+	    chunkPtr->start		= string;
+	    chunkPtr->numBytes		= numBytes;
+	    chunkPtr->numChars		= numChars;
+	    chunkPtr->numDisplayChars	= numChars;
+	    chunkPtr->x			= 0;
+	    chunkPtr->y			= fontPtr->fm.ascent;
+	    chunkPtr->totalWidth	= width;
+	    chunkPtr->displayWidth	= width;
+	    if (widthPtr != NULL) {
+		*widthPtr = width;
+	    }
+	    if (heightPtr != NULL) {
+		*heightPtr = fontPtr->fm.ascent + fontPtr->fm.descent;
+	    }
+	    return layout;
+	}
+    }
+
+    Tk_FreeTextLayout(layout);
+    return Tk_ComputeTextLayout(tkfont, string, numChars, wrapLength,
+	    justify, flags, widthPtr, heightPtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * PoolAllocLayout, FreeLayoutPool --
+ *
+ *	PoolAllocLayout hands out a text layout structure, reusing one from
+ *	the per-thread pool when available. FreeLayoutPool empties the pool;
+ *	it runs when the thread exits.
+ *
+ * Results:
+ *	PoolAllocLayout returns a layout with at least one chunk of
+ *	capacity and stores the actual capacity in *maxChunksPtr. Only the
+ *	maxChunks field of the returned layout is initialized.
+ *
+ * Side effects:
+ *	Memory may be allocated or freed.
+ *
+ *---------------------------------------------------------------------------
+ */
+
+static TextLayout *
+PoolAllocLayout(
+    int *maxChunksPtr)		/* Filled with the chunk capacity of the
+				 * returned layout. */
+{
+    TextLayout *layoutPtr;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (tsdPtr->numPooledLayouts > 0) {
+	layoutPtr = tsdPtr->layoutPool[--tsdPtr->numPooledLayouts];
+    } else {
+	layoutPtr = (TextLayout *)TkMemAlloc(TK_MEM_FONT,
+		offsetof(TextLayout, chunks) + sizeof(LayoutChunk));
+	layoutPtr->maxChunks = 1;
+    }
+    *maxChunksPtr = layoutPtr->maxChunks;
+    return layoutPtr;
+}
+
+static void
+FreeLayoutPool(
+    TCL_UNUSED(void *))
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    while (tsdPtr->numPooledLayouts > 0) {
+	TkMemFree(tsdPtr->layoutPool[--tsdPtr->numPooledLayouts]);
+    }
+    tsdPtr->poolExitHandlerSet = 0;
+}
 
 /*
  *---------------------------------------------------------------------------
@@ -2276,10 +2664,21 @@ Tk_FreeTextLayout(
     Tk_TextLayout textLayout)	/* The text layout to be released. */
 {
     TextLayout *layoutPtr = (TextLayout *) textLayout;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
 
-    if (layoutPtr != NULL) {
-	ckfree(layoutPtr);
+    if (layoutPtr == NULL) {
+	return;
+    }
+    if (tsdPtr->numPooledLayouts < LAYOUT_POOL_SIZE) {
+	if (!tsdPtr->poolExitHandlerSet) {
+	    tsdPtr->poolExitHandlerSet = 1;
+	    TkCreateThreadExitHandler(FreeLayoutPool, NULL);
+	}
+	tsdPtr->layoutPool[tsdPtr->numPooledLayouts++] = layoutPtr;
+	return;
     }
+    TkMemFree(layoutPtr);
 }
 
 /*
@@ -3854,7 +4253,7 @@ NewChunk(
     if (layoutPtr->numChunks == maxChunks) {
 	maxChunks *= 2;
 	s = offsetof(TextLayout, chunks) + (maxChunks * sizeof(LayoutChunk));
-	layoutPtr = (TextLayout *)ckrealloc(layoutPtr, s);
+	layoutPtr = (TextLayout *)TkMemRealloc(TK_MEM_FONT, layoutPtr, s);
 
 	*layoutPtrPtr = layoutPtr;
 	*maxPtr = maxChunks;
@@ -4285,6 +4684,82 @@ TkFontGetSymbolClass(void)
     return symbolClass;
 }
 
+/*
+ *-------------------------------------------------------------------------
+ *
+ * TkFontFallbackLookup, TkFontFallbackRemember --
+ *
+ *	Process-wide cache that remembers, per block of 256 codepoints,
+ *	which fallback face name was able to display a character in that
+ *	block.  Resolving a fallback means probing font after font, which
+ *	is expensive; the answer depends only on what fonts are installed,
+ *	not on the font object doing the asking, so once one font instance
+ *	has found a usable family every later instance can try that family
+ *	first.
+ *
+ * Results:
+ *	TkFontFallbackLookup returns the remembered face name for the
+ *	block containing ch, or NULL if no fallback has been resolved for
+ *	that block yet.  The returned string is valid for the lifetime of
+ *	the process.
+ *
+ * Side effects:
+ *	TkFontFallbackRemember records faceName for the block containing
+ *	ch.  The first recorded name for a block wins; entries are never
+ *	removed.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#define FALLBACK_BLOCK_SHIFT	8
+
+static Tcl_HashTable fallbackCache;
+static int fallbackCacheInit = 0;
+TCL_DECLARE_MUTEX(fallbackCacheMutex)
+
+const char *
+TkFontFallbackLookup(
+    int ch)			/* Character that lacked a glyph. */
+{
+    Tcl_HashEntry *hPtr;
+    const char *faceName = NULL;
+
+    Tcl_MutexLock(&fallbackCacheMutex);
+    if (fallbackCacheInit) {
+	hPtr = Tcl_FindHashEntry(&fallbackCache,
+		INT2PTR(ch >> FALLBACK_BLOCK_SHIFT));
+	if (hPtr != NULL) {
+	    faceName = (const char *)Tcl_GetHashValue(hPtr);
+	}
+    }
+    Tcl_MutexUnlock(&fallbackCacheMutex);
+    return faceName;
+}
+
+void
+TkFontFallbackRemember(
+    int ch,			/* Character that lacked a glyph. */
+    const char *faceName)	/* Face name that was able to display it. */
+{
+    Tcl_HashEntry *hPtr;
+    int isNew;
+    char *copy;
+
+    Tcl_MutexLock(&fallbackCacheMutex);
+    if (!fallbackCacheInit) {
+	Tcl_InitHashTable(&fallbackCache, TCL_ONE_WORD_KEYS);
+	fallbackCacheInit = 1;
+    }
+    hPtr = Tcl_CreateHashEntry(&fallbackCache,
+	    INT2PTR(ch >> FALLBACK_BLOCK_SHIFT), &isNew);
+    if (isNew) {
+	copy = (char *)ckalloc(strlen(faceName) + 1);
+	strcpy(copy, faceName);
+	Tcl_SetHashValue(hPtr, copy);
+    }
+    Tcl_MutexUnlock(&fallbackCacheMutex);
+}
+
 /*
  *----------------------------------------------------------------------
  *
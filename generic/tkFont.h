@@ -114,6 +114,17 @@ typedef struct TkFont {
 				 * non-underlined font). */
     int underlineHeight;	/* Height of underline bar (used for drawing
 				 * underlines on a non-underlined font). */
+    int asciiAdvance[128];	/* Cached pixel advances for 7-bit characters,
+				 * or -1 if the character has not been
+				 * measured yet. Consulted by the measurement
+				 * fast path in tkFont.c so repeated
+				 * measurement of UI strings becomes memory
+				 * reads. */
+    Tcl_HashTable *ucAdvanceTablePtr;
+				/* Lazily created map from Unicode code point
+				 * to cached pixel advance for characters
+				 * outside the 7-bit range, or NULL if no such
+				 * character has been measured yet. */
 
     /*
      * Fields used in the generic code that are filled in by
@@ -200,6 +211,8 @@ typedef struct TkXLFDAttributes {
 
 MODULE_SCOPE int	TkFontParseXLFD(const char *string,
 			    TkFontAttributes *faPtr, TkXLFDAttributes *xaPtr);
+MODULE_SCOPE const char *TkFontFallbackLookup(int ch);
+MODULE_SCOPE void	TkFontFallbackRemember(int ch, const char *faceName);
 MODULE_SCOPE const char *const * TkFontGetAliasList(const char *faceName);
 MODULE_SCOPE const char *const *const * TkFontGetFallbacks(void);
 MODULE_SCOPE double	TkFontGetPixels(Tk_Window tkwin, double size);
@@ -86,6 +86,14 @@ typedef struct {
 				 * windows this is NULL. */
     int flags;			/* Various flags; see below for
 				 * definitions. */
+    int damageX1, damageY1;	/* Upper-left corner of the area that needs
+				 * to be redrawn, accumulated from Expose
+				 * events since the last redisplay. */
+    int damageX2, damageY2;	/* Lower-right corner (exclusive) of the area
+				 * that needs to be redrawn. damageX2 <=
+				 * damageX1 means no specific area has been
+				 * recorded and the whole window is
+				 * redrawn. */
     Tcl_Obj *padXPtr;		/* Value of -padx option: specifies how many
 				 * pixels of extra space to leave on left and
 				 * right of child area. */
@@ -339,6 +347,8 @@ static void		FrameBgImageProc(void *clientData,
 			    int x, int y, int width, int height,
 			    int imgWidth, int imgHeight);
 static void		FrameCmdDeletedProc(void *clientData);
+static void		FrameDamage(Frame *framePtr, int x1, int y1,
+			    int x2, int y2);
 static void		FrameEventProc(void *clientData,
 			    XEvent *eventPtr);
 static void		FrameLostContentProc(void *clientData,
@@ -1247,6 +1257,7 @@ FrameWorldChanged(
     }
 
     if (Tk_IsMapped(tkwin)) {
+	FrameDamage(framePtr, 0, 0, INT_MAX, INT_MAX);
 	if (!(framePtr->flags & REDRAW_PENDING)) {
 	    Tcl_DoWhenIdle(DisplayFrame, framePtr);
 	}
@@ -1403,6 +1414,53 @@ ComputeFrameGeometry(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * FrameDamage --
+ *
+ *	Adds an area to the region that DisplayFrame will redraw, given as
+ *	its upper-left corner and its lower-right corner (exclusive). The
+ *	area need not lie within the window; it is clipped at display time.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The recorded damage grows to the bounding box of the old and the new
+ *	area.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+FrameDamage(
+    Frame *framePtr,		/* Frame to mark. */
+    int x1, int y1,		/* Upper-left corner of damaged area. */
+    int x2, int y2)		/* Lower-right corner (exclusive). */
+{
+    if ((framePtr->damageX2 <= framePtr->damageX1)
+	    || (framePtr->damageY2 <= framePtr->damageY1)) {
+	framePtr->damageX1 = x1;
+	framePtr->damageY1 = y1;
+	framePtr->damageX2 = x2;
+	framePtr->damageY2 = y2;
+	return;
+    }
+    if (x1 < framePtr->damageX1) {
+	framePtr->damageX1 = x1;
+    }
+    if (y1 < framePtr->damageY1) {
+	framePtr->damageY1 = y1;
+    }
+    if (x2 > framePtr->damageX2) {
+	framePtr->damageX2 = x2;
+    }
+    if (y2 > framePtr->damageY2) {
+	framePtr->damageY2 = y2;
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -1426,21 +1484,56 @@ DisplayFrame(
     Frame *framePtr = (Frame *)clientData;
     Tk_Window tkwin = framePtr->tkwin;
     int bdX1, bdY1, bdX2, bdY2, hlWidth;
+    int dmgX1, dmgY1, dmgX2, dmgY2, inset;
     Pixmap pixmap;
     Bool useClipping = False;
 
     framePtr->flags &= ~REDRAW_PENDING;
-    if ((framePtr->tkwin == NULL) || !Tk_IsMapped(tkwin)) {
+    if ((framePtr->tkwin == NULL) || !Tk_IsMapped(tkwin)
+	    || TkWindowObscured((TkWindow *) tkwin)) {
 	return;
     }
 
     /*
-     * Highlight shall always be drawn if it exists, so do that first.
+     * Capture and reset the accumulated damage, clipped to the window. An
+     * empty result means no specific area was recorded, so the whole window
+     * is redrawn.
+     */
+
+    dmgX1 = framePtr->damageX1;
+    dmgY1 = framePtr->damageY1;
+    dmgX2 = framePtr->damageX2;
+    dmgY2 = framePtr->damageY2;
+    framePtr->damageX1 = framePtr->damageY1 = 0;
+    framePtr->damageX2 = framePtr->damageY2 = 0;
+    if (dmgX1 < 0) {
+	dmgX1 = 0;
+    }
+    if (dmgY1 < 0) {
+	dmgY1 = 0;
+    }
+    if (dmgX2 > Tk_Width(tkwin)) {
+	dmgX2 = Tk_Width(tkwin);
+    }
+    if (dmgY2 > Tk_Height(tkwin)) {
+	dmgY2 = Tk_Height(tkwin);
+    }
+    if ((dmgX2 <= dmgX1) || (dmgY2 <= dmgY1)) {
+	dmgX1 = dmgY1 = 0;
+	dmgX2 = Tk_Width(tkwin);
+	dmgY2 = Tk_Height(tkwin);
+    }
+
+    /*
+     * Highlight shall always be drawn if it exists and the damaged area
+     * touches it, so do that first.
      */
 
     hlWidth = framePtr->highlightWidth;
 
-    if (hlWidth != 0) {
+    if ((hlWidth != 0) && ((dmgX1 < hlWidth) || (dmgY1 < hlWidth)
+	    || (dmgX2 > Tk_Width(tkwin) - hlWidth)
+	    || (dmgY2 > Tk_Height(tkwin) - hlWidth))) {
 	GC fgGC, bgGC;
 
 	bgGC = Tk_GCForColor(framePtr->highlightBgColorPtr,
@@ -1464,6 +1557,44 @@ DisplayFrame(
 	return;
     }
 
+    /*
+     * When the damaged area lies entirely within the flat interior of the
+     * frame (inside the highlight ring and the 3-D bevel), the bevel and
+     * highlight are untouched and only the background needs filling; skip
+     * even that when mapped opaque children completely cover the damaged
+     * area, as the fill could never become visible. Frames with a
+     * background image and labelframes with a label keep the full redraw
+     * path.
+     */
+
+    inset = hlWidth + framePtr->borderWidth;
+    if ((framePtr->bgimg == NULL)
+	    && ((framePtr->type != TYPE_LABELFRAME)
+		|| ((((Labelframe *) framePtr)->textPtr == NULL)
+		    && (((Labelframe *) framePtr)->labelWin == NULL)))
+	    && (dmgX1 >= inset) && (dmgY1 >= inset)
+	    && (dmgX2 <= Tk_Width(tkwin) - inset)
+	    && (dmgY2 <= Tk_Height(tkwin) - inset)) {
+	if (TkWindowAreaObscured((TkWindow *) tkwin,
+		dmgX1, dmgY1, dmgX2, dmgY2)) {
+	    return;
+	}
+#ifndef TK_NO_DOUBLE_BUFFERING
+	pixmap = TkGetPaintBuffer(tkwin, dmgX2 - dmgX1, dmgY2 - dmgY1);
+	Tk_Fill3DRectangle(tkwin, pixmap, framePtr->border, 0, 0,
+		dmgX2 - dmgX1, dmgY2 - dmgY1, 0, TK_RELIEF_FLAT);
+	XCopyArea(framePtr->display, pixmap, Tk_WindowId(tkwin),
+		framePtr->copyGC, 0, 0, (unsigned) (dmgX2 - dmgX1),
+		(unsigned) (dmgY2 - dmgY1), dmgX1, dmgY1);
+	TkReleasePaintBuffer(tkwin, pixmap);
+#else
+	Tk_Fill3DRectangle(tkwin, Tk_WindowId(tkwin), framePtr->border,
+		dmgX1, dmgY1, dmgX2 - dmgX1, dmgY2 - dmgY1, 0,
+		TK_RELIEF_FLAT);
+#endif /* TK_NO_DOUBLE_BUFFERING */
+	return;
+    }
+
 #ifndef TK_NO_DOUBLE_BUFFERING
     /*
      * In order to avoid screen flashes, this function redraws the frame into
@@ -1472,8 +1603,7 @@ DisplayFrame(
      * cleared.
      */
 
-    pixmap = Tk_GetPixmap(framePtr->display, Tk_WindowId(tkwin),
-	    Tk_Width(tkwin), Tk_Height(tkwin), Tk_Depth(tkwin));
+    pixmap = TkGetPaintBuffer(tkwin, Tk_Width(tkwin), Tk_Height(tkwin));
 #else
     pixmap = Tk_WindowId(tkwin);
 #endif /* TK_NO_DOUBLE_BUFFERING */
@@ -1612,7 +1742,7 @@ DisplayFrame(
 #ifndef TK_NO_DOUBLE_BUFFERING
     /*
      * Everything's been redisplayed; now copy the pixmap onto the screen and
-     * free up the pixmap.
+     * release the pixmap for reuse.
      */
 
     XCopyArea(framePtr->display, pixmap, Tk_WindowId(tkwin),
@@ -1620,7 +1750,7 @@ DisplayFrame(
 	    (unsigned) (Tk_Width(tkwin) - 2 * hlWidth),
 	    (unsigned) (Tk_Height(tkwin) - 2 * hlWidth),
 	    hlWidth, hlWidth);
-    Tk_FreePixmap(framePtr->display, pixmap);
+    TkReleasePaintBuffer(tkwin, pixmap);
 #endif /* TK_NO_DOUBLE_BUFFERING */
 }
 
@@ -1683,10 +1813,16 @@ FrameEventProc(
 {
     Frame *framePtr = (Frame *)clientData;
 
-    if ((eventPtr->type == Expose) && (eventPtr->xexpose.count == 0)) {
-	goto redraw;
+    if (eventPtr->type == Expose) {
+	FrameDamage(framePtr, eventPtr->xexpose.x, eventPtr->xexpose.y,
+		eventPtr->xexpose.x + eventPtr->xexpose.width,
+		eventPtr->xexpose.y + eventPtr->xexpose.height);
+	if (eventPtr->xexpose.count == 0) {
+	    goto redraw;
+	}
     } else if (eventPtr->type == ConfigureNotify) {
 	ComputeFrameGeometry(framePtr);
+	FrameDamage(framePtr, 0, 0, INT_MAX, INT_MAX);
 	goto redraw;
     } else if (eventPtr->type == DestroyNotify) {
 	if (framePtr->menuName != NULL) {
@@ -1728,6 +1864,7 @@ FrameEventProc(
 	if (eventPtr->xfocus.detail != NotifyInferior) {
 	    framePtr->flags |= GOT_FOCUS;
 	    if (framePtr->highlightWidth > 0) {
+		FrameDamage(framePtr, 0, 0, INT_MAX, INT_MAX);
 		goto redraw;
 	    }
 	}
@@ -1735,6 +1872,7 @@ FrameEventProc(
 	if (eventPtr->xfocus.detail != NotifyInferior) {
 	    framePtr->flags &= ~GOT_FOCUS;
 	    if (framePtr->highlightWidth > 0) {
+		FrameDamage(framePtr, 0, 0, INT_MAX, INT_MAX);
 		goto redraw;
 	    }
 	}
@@ -2107,10 +2245,12 @@ FrameBgImageProc(
      * Changing the background image never alters the dimensions of the frame.
      */
 
-    if (framePtr->tkwin && Tk_IsMapped(framePtr->tkwin) &&
-	    !(framePtr->flags & REDRAW_PENDING)) {
-	Tcl_DoWhenIdle(DisplayFrame, framePtr);
-	framePtr->flags |= REDRAW_PENDING;
+    if (framePtr->tkwin && Tk_IsMapped(framePtr->tkwin)) {
+	FrameDamage(framePtr, 0, 0, INT_MAX, INT_MAX);
+	if (!(framePtr->flags & REDRAW_PENDING)) {
+	    Tcl_DoWhenIdle(DisplayFrame, framePtr);
+	    framePtr->flags |= REDRAW_PENDING;
+	}
     }
 }
 
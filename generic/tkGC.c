@@ -20,12 +20,27 @@
  * identifier.
  */
 
-typedef struct {
+typedef struct TkGC {
     GC gc;			/* Graphics context. */
     Display *display;		/* Display to which gc belongs. */
     size_t refCount;		/* Number of active uses of gc. */
     Tcl_HashEntry *valueHashPtr;/* Entry in valueTable (needed when deleting
 				 * this structure). */
+    Tcl_HashEntry *idHashPtr;	/* Entry in idTable (ditto). */
+    struct TkGC *nextIdlePtr;	/* Next GC on the display's idle list, or
+				 * NULL; meaningful only while refCount is
+				 * 0. */
+    struct TkGC *prevIdlePtr;	/* Previous GC on the idle list, or NULL. */
+    unsigned long valueMask;	/* Mask with which the GC was created; used
+				 * to decide whether it may be parked on the
+				 * idle list when its last reference goes
+				 * away. */
+    char *dashList;		/* Malloc'ed copy of the dash list most
+				 * recently programmed on the GC through
+				 * TkSetDashes, or NULL if the GC still has
+				 * its creation-time dashes. */
+    int dashNumber;		/* Number of bytes in dashList. */
+    int dashOffset;		/* Dash offset programmed with dashList. */
 } TkGC;
 
 typedef struct {
@@ -35,11 +50,20 @@ typedef struct {
     int depth;			/* and depth for which GC is valid. */
 } ValueKey;
 
+/*
+ * Number of unreferenced GCs to keep cached per display, unless changed with
+ * [tk gcstats limit].
+ */
+
+#define DEFAULT_IDLE_GC_LIMIT 32
+
 /*
  * Forward declarations for functions defined in this file:
  */
 
+static void		DiscardGC(TkDisplay *dispPtr, TkGC *gcPtr);
 static void		GCInit(TkDisplay *dispPtr);
+static void		TrimIdleGCs(TkDisplay *dispPtr);
 
 /*
  *----------------------------------------------------------------------
@@ -219,9 +243,29 @@ Tk_GetGC(
 	    (char *) &valueKey, &isNew);
     if (!isNew) {
 	gcPtr = (TkGC *)Tcl_GetHashValue(valueHashPtr);
+	if (gcPtr->refCount == 0) {
+	    /*
+	     * The GC was sitting on the idle list; take it back off.
+	     */
+
+	    if (gcPtr->prevIdlePtr != NULL) {
+		gcPtr->prevIdlePtr->nextIdlePtr = gcPtr->nextIdlePtr;
+	    } else {
+		dispPtr->gcIdleHeadPtr = gcPtr->nextIdlePtr;
+	    }
+	    if (gcPtr->nextIdlePtr != NULL) {
+		gcPtr->nextIdlePtr->prevIdlePtr = gcPtr->prevIdlePtr;
+	    } else {
+		dispPtr->gcIdleTailPtr = gcPtr->prevIdlePtr;
+	    }
+	    gcPtr->nextIdlePtr = gcPtr->prevIdlePtr = NULL;
+	    dispPtr->gcIdleCount--;
+	}
 	gcPtr->refCount++;
+	dispPtr->gcHits++;
 	return gcPtr->gc;
     }
+    dispPtr->gcMisses++;
 
     /*
      * No GC is currently available for this set of values. Allocate a new GC
@@ -249,15 +293,37 @@ Tk_GetGC(
 	freeDrawable = d;
     }
 
-    gcPtr->gc = XCreateGC(valueKey.display, d, valueMask, &valueKey.values);
+    /*
+     * Create the GC with every canonicalized value set explicitly, so the
+     * server-side GC matches the hash key exactly no matter which subset of
+     * bits the caller passed in.  GCTile, GCStipple and GCFont are only
+     * included when the caller supplied them: None is not a valid pixmap or
+     * font over the wire.
+     */
+
+    gcPtr->gc = XCreateGC(valueKey.display, d,
+	    (((GCFunction|GCPlaneMask|GCForeground|GCBackground|GCLineWidth
+	    |GCLineStyle|GCCapStyle|GCJoinStyle|GCFillStyle|GCFillRule
+	    |GCArcMode|GCTileStipXOrigin|GCTileStipYOrigin|GCSubwindowMode
+	    |GCGraphicsExposures|GCClipXOrigin|GCClipYOrigin|GCClipMask
+	    |GCDashOffset|GCDashList)
+	    | (valueMask & (GCTile|GCStipple|GCFont)))),
+	    &valueKey.values);
     gcPtr->display = valueKey.display;
     gcPtr->refCount = 1;
+    gcPtr->valueMask = valueMask;
     gcPtr->valueHashPtr = valueHashPtr;
+    gcPtr->nextIdlePtr = gcPtr->prevIdlePtr = NULL;
+    gcPtr->dashList = NULL;
+    gcPtr->dashNumber = 0;
+    gcPtr->dashOffset = 0;
     idHashPtr = Tcl_CreateHashEntry(&dispPtr->gcIdTable,
 	    (char *) gcPtr->gc, &isNew);
     if (!isNew) {
 	Tcl_Panic("GC already registered in Tk_GetGC");
     }
+    gcPtr->idHashPtr = idHashPtr;
+    dispPtr->gcCount++;
     Tcl_SetHashValue(valueHashPtr, gcPtr);
     Tcl_SetHashValue(idHashPtr, gcPtr);
     if (freeDrawable != None) {
@@ -313,11 +379,270 @@ Tk_FreeGC(
     }
     gcPtr = (TkGC *)Tcl_GetHashValue(idHashPtr);
     if (gcPtr->refCount-- <= 1) {
-	XFreeGC(gcPtr->display, gcPtr->gc);
-	Tcl_DeleteHashEntry(gcPtr->valueHashPtr);
-	Tcl_DeleteHashEntry(idHashPtr);
-	ckfree(gcPtr);
+	/*
+	 * Never park a GC that references other server-side resources: the
+	 * value key records only their XIDs, and once the client frees such
+	 * a resource the server may recycle the XID. A later Tk_GetGC
+	 * naming the recycled XID would then revive a GC still bound
+	 * server-side to the old resource and silently draw with it.
+	 */
+
+	if ((dispPtr->gcIdleLimit <= 0) || (gcPtr->valueMask
+		& (GCTile|GCStipple|GCFont|GCClipMask))) {
+	    DiscardGC(dispPtr, gcPtr);
+	    return;
+	}
+
+	/*
+	 * Park the GC at the head of the idle list rather than freeing it;
+	 * the next Tk_GetGC with the same values revives it without a server
+	 * round trip.
+	 */
+
+	gcPtr->refCount = 0;
+	gcPtr->prevIdlePtr = NULL;
+	gcPtr->nextIdlePtr = dispPtr->gcIdleHeadPtr;
+	if (dispPtr->gcIdleHeadPtr != NULL) {
+	    dispPtr->gcIdleHeadPtr->prevIdlePtr = gcPtr;
+	} else {
+	    dispPtr->gcIdleTailPtr = gcPtr;
+	}
+	dispPtr->gcIdleHeadPtr = gcPtr;
+	dispPtr->gcIdleCount++;
+	TrimIdleGCs(dispPtr);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkSetDashes --
+ *
+ *	Program a dash list on a GC, skipping the server round trip when the
+ *	GC already carries exactly that list. Dashed canvas items declare
+ *	their dash state through this function before every draw, so a run
+ *	of items sharing the same outline costs one XSetDashes for the whole
+ *	run instead of one (plus a reset) per item.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May issue an XSetDashes request; the list programmed is remembered
+ *	with the GC's cache entry. GCs that did not come from Tk_GetGC are
+ *	programmed unconditionally.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkSetDashes(
+    Display *display,		/* Display the GC belongs to. */
+    GC gc,			/* Graphics context to program. */
+    int dashOffset,		/* Desired dash offset. */
+    const char *dashList,	/* Desired dash list. */
+    int number)			/* Number of bytes in dashList. */
+{
+    TkDisplay *dispPtr = TkGetDisplay(display);
+    Tcl_HashEntry *idHashPtr;
+    TkGC *gcPtr;
+
+    if ((dispPtr == NULL) || (dispPtr->gcInit <= 0)) {
+	XSetDashes(display, gc, dashOffset, dashList, number);
+	return;
+    }
+    idHashPtr = Tcl_FindHashEntry(&dispPtr->gcIdTable, gc);
+    if (idHashPtr == NULL) {
+	XSetDashes(display, gc, dashOffset, dashList, number);
+	return;
+    }
+    gcPtr = (TkGC *)Tcl_GetHashValue(idHashPtr);
+    if (gcPtr->dashList == NULL) {
+	/*
+	 * The GC still has its creation-time dashes; those are a repeating
+	 * single-element pattern given by the hashed GC values.
+	 */
+
+	ValueKey *keyPtr = (ValueKey *)Tcl_GetHashKey(
+		&dispPtr->gcValueTable, gcPtr->valueHashPtr);
+
+	if ((number == 1) && (dashList[0] == keyPtr->values.dashes)
+		&& (dashOffset == keyPtr->values.dash_offset)) {
+	    return;
+	}
+    } else if ((number == gcPtr->dashNumber)
+	    && (dashOffset == gcPtr->dashOffset)
+	    && (memcmp(dashList, gcPtr->dashList, number) == 0)) {
+	return;
+    }
+    XSetDashes(display, gc, dashOffset, dashList, number);
+    if (gcPtr->dashList == NULL || gcPtr->dashNumber < number) {
+	if (gcPtr->dashList != NULL) {
+	    ckfree(gcPtr->dashList);
+	}
+	gcPtr->dashList = (char *)ckalloc(number);
+    }
+    memcpy(gcPtr->dashList, dashList, number);
+    gcPtr->dashNumber = number;
+    gcPtr->dashOffset = dashOffset;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DiscardGC --
+ *
+ *	Removes a GC from the cache entirely and releases its server
+ *	resources.  The GC must not be on the idle list.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The GC is freed on the server and its cache entries go away.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DiscardGC(
+    TkDisplay *dispPtr,		/* Display whose cache holds the GC. */
+    TkGC *gcPtr)		/* Cache entry to destroy. */
+{
+    XFreeGC(gcPtr->display, gcPtr->gc);
+    Tcl_DeleteHashEntry(gcPtr->valueHashPtr);
+    Tcl_DeleteHashEntry(gcPtr->idHashPtr);
+    if (gcPtr->dashList != NULL) {
+	ckfree(gcPtr->dashList);
+    }
+    dispPtr->gcCount--;
+    ckfree(gcPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TrimIdleGCs --
+ *
+ *	Evicts least recently used idle GCs until the idle list fits within
+ *	the display's budget again.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May free GCs on the server.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+TrimIdleGCs(
+    TkDisplay *dispPtr)		/* Display whose idle list to trim. */
+{
+    while (dispPtr->gcIdleCount > dispPtr->gcIdleLimit) {
+	TkGC *gcPtr = dispPtr->gcIdleTailPtr;
+
+	dispPtr->gcIdleTailPtr = gcPtr->prevIdlePtr;
+	if (dispPtr->gcIdleTailPtr != NULL) {
+	    dispPtr->gcIdleTailPtr->nextIdlePtr = NULL;
+	} else {
+	    dispPtr->gcIdleHeadPtr = NULL;
+	}
+	dispPtr->gcIdleCount--;
+	dispPtr->gcEvictions++;
+	DiscardGC(dispPtr, gcPtr);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkGCGetStatsObj --
+ *
+ *	Builds the value returned by [tk gcstats]: a dictionary with the
+ *	keys "hits", "misses", "evictions" (counters since the display was
+ *	opened), "active" (GCs currently referenced), "idle" (unreferenced
+ *	GCs being retained) and "limit" (the idle retention budget).
+ *
+ * Results:
+ *	A fresh unshared Tcl_Obj.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tcl_Obj *
+TkGCGetStatsObj(
+    TkDisplay *dispPtr)		/* Display to report on. */
+{
+    Tcl_Obj *resultObj = Tcl_NewDictObj();
+
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("hits", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dispPtr->gcHits));
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("misses", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dispPtr->gcMisses));
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("evictions", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dispPtr->gcEvictions));
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("active", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dispPtr->gcCount - dispPtr->gcIdleCount));
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("idle", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dispPtr->gcIdleCount));
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("limit", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(TkGCGetIdleLimit(dispPtr)));
+    return resultObj;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkGCGetIdleLimit, TkGCSetIdleLimit --
+ *
+ *	Query or set the number of unreferenced GCs retained per display.
+ *	Setting a smaller limit evicts immediately; a limit of 0 restores
+ *	the historical behavior of freeing GCs as soon as their reference
+ *	count drops to zero.
+ *
+ * Results:
+ *	TkGCGetIdleLimit returns the limit that is in effect.
+ *
+ * Side effects:
+ *	TkGCSetIdleLimit may free GCs on the server.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkGCGetIdleLimit(
+    TkDisplay *dispPtr)		/* Display to query. */
+{
+    if (dispPtr->gcInit <= 0) {
+	return DEFAULT_IDLE_GC_LIMIT;
+    }
+    return dispPtr->gcIdleLimit;
+}
+
+void
+TkGCSetIdleLimit(
+    TkDisplay *dispPtr,		/* Display to adjust. */
+    int limit)			/* New budget; must be >= 0. */
+{
+    if (dispPtr->gcInit < 0) {
+	return;
+    }
+    if (dispPtr->gcInit == 0) {
+	GCInit(dispPtr);
     }
+    dispPtr->gcIdleLimit = limit;
+    TrimIdleGCs(dispPtr);
 }
 
 /*
@@ -356,6 +681,9 @@ TkGCCleanup(
     }
     Tcl_DeleteHashTable(&dispPtr->gcValueTable);
     Tcl_DeleteHashTable(&dispPtr->gcIdTable);
+    dispPtr->gcIdleHeadPtr = dispPtr->gcIdleTailPtr = NULL;
+    dispPtr->gcIdleCount = 0;
+    dispPtr->gcCount = 0;
     dispPtr->gcInit = -1;
 }
 
@@ -383,6 +711,7 @@ GCInit(
 	Tcl_Panic("called GCInit after GCCleanup");
     }
     dispPtr->gcInit = 1;
+    dispPtr->gcIdleLimit = DEFAULT_IDLE_GC_LIMIT;
     Tcl_InitHashTable(&dispPtr->gcValueTable, sizeof(ValueKey)/sizeof(int));
     Tcl_InitHashTable(&dispPtr->gcIdTable, TCL_ONE_WORD_KEYS);
 }
@@ -624,7 +624,7 @@ Tk_UnmaintainGeometry(
 	    }
 	}
 	if (containerPtr->checkScheduled) {
-	    Tcl_CancelIdleCall(MaintainCheckProc, containerPtr);
+	    TkCancelDoWhenIdle(MaintainCheckProc, containerPtr);
 	}
 	Tcl_DeleteHashEntry(hPtr);
 	ckfree(containerPtr);
@@ -667,7 +667,7 @@ MaintainContainerProc(
 	    || (eventPtr->type == UnmapNotify)) {
 	if (!containerPtr->checkScheduled) {
 	    containerPtr->checkScheduled = 1;
-	    Tcl_DoWhenIdle(MaintainCheckProc, containerPtr);
+	    TkDoWhenIdle(MaintainCheckProc, containerPtr, TK_IDLE_LAYOUT);
 	}
     } else if (eventPtr->type == DestroyNotify) {
 	/*
@@ -136,6 +136,12 @@ typedef struct NewGrabWinEvent {
 
 #define GENERATED_GRAB_EVENT_MAGIC ((Bool) 0x147321ac)
 
+/*
+ * Profiling counters for the pointer-event path (see [tk eventstats]).
+ */
+
+TkPointerStats tkPointerStats;
+
 /*
  * Forward declarations for functions declared later in this file:
  */
@@ -751,10 +757,12 @@ TkPointerEvent(
 	if (dispPtr->grabWinPtr != NULL) {
 	    if (outsideGrabTree && appGrabbed) {
 		if (!ancestorOfGrab) {
+		    tkPointerStats.filtered++;
 		    return 0;
 		}
 		switch (eventPtr->xcrossing.detail) {
 		case NotifyInferior:
+		    tkPointerStats.filtered++;
 		    return 0;
 		case NotifyAncestor:
 		    eventPtr->xcrossing.detail = NotifyVirtual;
@@ -773,6 +781,7 @@ TkPointerEvent(
 
 	    if ((dispPtr->buttonWinPtr != NULL)
 		    && (winPtr != dispPtr->buttonWinPtr)) {
+		tkPointerStats.filtered++;
 		return 0;
 	    }
 	}
@@ -815,6 +824,7 @@ TkPointerEvent(
 	    winPtr2 = dispPtr->grabWinPtr;
 	}
 	if (winPtr2 != winPtr) {
+	    tkPointerStats.retargeted++;
 	    TkChangeEventWindow(eventPtr, winPtr2);
 	    Tk_QueueWindowEvent(eventPtr, TCL_QUEUE_HEAD);
 	    return 0;
@@ -871,6 +881,7 @@ TkPointerEvent(
 	if (eventPtr->type == ButtonPress) {
 	    if (!(eventPtr->xbutton.state & ALL_BUTTONS)) {
 		if (outsideGrabTree) {
+		    tkPointerStats.retargeted++;
 		    TkChangeEventWindow(eventPtr, dispPtr->grabWinPtr);
 		    Tk_QueueWindowEvent(eventPtr, TCL_QUEUE_HEAD);
 		    return 0;					/* Note 2. */
@@ -903,6 +914,7 @@ TkPointerEvent(
 	    }
 	}
 	if (winPtr2 != winPtr) {
+	    tkPointerStats.retargeted++;
 	    TkChangeEventWindow(eventPtr, winPtr2);
 	    Tk_QueueWindowEvent(eventPtr, TCL_QUEUE_HEAD);
 	    return 0;						/* Note 3. */
@@ -1044,6 +1056,7 @@ TkInOutEvents(
     if (sourcePtr == destPtr) {
 	return;
     }
+    tkPointerStats.transfers++;
     if ((leaveType == FocusOut) || (enterType == FocusIn)) {
 	focus = 1;
     } else {
@@ -1057,6 +1070,7 @@ TkInOutEvents(
 
 #define QUEUE(w, t, d)					\
     if (w->window != None) {				\
+	tkPointerStats.synthesized++;			\
 	eventPtr->type = t;				\
 	if (focus) {					\
 	    eventPtr->xfocus.window = w->window;	\
@@ -1597,6 +1611,69 @@ TkGrabState(
     return TkPositionInTree(winPtr, grabWinPtr);
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkPointerGetStatsObj --
+ *
+ *	Build a report of the pointer-event path counters, for the
+ *	"pointer" entry of the "tk eventstats" command.
+ *
+ * Results:
+ *	A dictionary object with the keys "filtered", "retargeted",
+ *	"transfers", "synthesized" and "skipped".
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tcl_Obj *
+TkPointerGetStatsObj(void)
+{
+    Tcl_Obj *resultObj = Tcl_NewDictObj();
+
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("filtered", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(tkPointerStats.filtered));
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("retargeted", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(tkPointerStats.retargeted));
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("transfers", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(tkPointerStats.transfers));
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("synthesized", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(tkPointerStats.synthesized));
+    Tcl_DictObjPut(NULL, resultObj,
+	    Tcl_NewStringObj("skipped", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(tkPointerStats.skipped));
+    return resultObj;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkPointerResetStats --
+ *
+ *	Reset the pointer-event path counters.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	All counters are zeroed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkPointerResetStats(void)
+{
+    memset(&tkPointerStats, 0, sizeof(tkPointerStats));
+}
+
 /*
  * Local Variables:
  * mode: c
@@ -37,7 +37,7 @@
 #define PREALLOC	10	/* Extra slots to allocate. */
 
 /*
- * Pre-allocate room for uniform groups during layout.
+ * Uniform group arrays grow in chunks of this many entries.
  */
 
 #define UNIFORM_PREALLOC 10
@@ -84,10 +84,18 @@ typedef struct SlotInfo {
     Tk_Uid uniform;		/* Value of -uniform option. It is used to
 				 * group slots that should have the same
 				 * size. */
+    int uniformIndex;		/* One plus the index of this slot's group in
+				 * the container's per-axis uniform group
+				 * array; 0 means the slot is in no group.
+				 * Maintained by SetSlotUniform. */
     int offset;			/* This is a cached value used for
 				 * introspection. It is the pixel offset of
 				 * the right or bottom edge of this slot from
 				 * the beginning of the layout. */
+    int natural;		/* Offset of this slot's right or bottom
+				 * edge in the natural (unadjusted) layout.
+				 * Only meaningful while the container's
+				 * layoutValid mask includes this axis. */
     int temp;			/* This is a temporary value used for
 				 * calculating adjusted weights when shrinking
 				 * the layout below its nominal size. */
@@ -110,9 +118,9 @@ typedef struct GridLayout {
     				 * size or padding. */
     int pad;			/* Padding needed for this slot */
     int weight;			/* Slot weight, controls resizing. */
-    Tk_Uid uniform;		/* Value of -uniform option. It is used to
-				 * group slots that should have the same
-				 * size. */
+    int uniformIndex;		/* One plus the index of the slot's uniform
+				 * group for this axis, or 0 for none;
+				 * copied from the SlotInfo. */
     int minOffset;		/* The minimum offset, in pixels, from the
     				 * beginning of the layout to the bottom/right
     				 * edge of the slot calculated from top/left
@@ -123,6 +131,23 @@ typedef struct GridLayout {
     				 * bottom/right to top/left. */
 } GridLayout;
 
+/*
+ * Uniform groups are kept as persistent per-axis structures on the
+ * container, so the constraint solver doesn't have to rediscover group
+ * membership by scanning the slots on every call. Membership is
+ * maintained by SetSlotUniform as -uniform options are configured; the
+ * equalized size is scratch storage for ResolveConstraints.
+ */
+
+typedef struct UniformGroup {
+    Tk_Uid group;		/* The -uniform group name. */
+    int refCount;		/* Number of slots in the group; an entry
+				 * with refCount 0 may be reused for a new
+				 * group. */
+    int minSize;		/* Equalized base size (per unit of weight),
+				 * computed by ResolveConstraints. */
+} UniformGroup;
+
 /*
  * Keep one of these for each geometry container.
  */
@@ -142,6 +167,16 @@ typedef struct {
     				 * container. */
     int startY;			/* Pixel offset of this layout within its
     				 * container. */
+    int layoutValid;		/* Bit mask of COLUMN and ROW: axes whose
+				 * cached natural offsets and sizes are
+				 * still valid, so ResolveConstraints can
+				 * skip re-solving them. */
+    int naturalSize[3];		/* Natural layout size per axis, indexed by
+				 * COLUMN and ROW. */
+    UniformGroup *uniformPtr[3];/* Per-axis arrays of uniform groups,
+				 * indexed by COLUMN and ROW. */
+    int uniformCount[3];	/* Number of entries in each array. */
+    int uniformSpace[3];	/* Allocated size of each array. */
     Tk_Anchor anchor;		/* Value of anchor option: specifies where a
 				 * grid without weight should be placed. */
 } GridContainer;
@@ -162,6 +197,9 @@ typedef struct Gridder {
 				 * managed by the gridder). */
     struct Gridder *nextPtr;	/* Next window managed within same container.
 				 * List order doesn't matter. */
+    struct Gridder *prevPtr;	/* Previous window managed within same
+				 * container, or NULL for the head of the
+				 * list. Makes unlinking constant-time. */
     struct Gridder *contentPtr;	/* First in list of content managed inside this
 				 * window (NULL means no grid content). */
     GridContainer *containerDataPtr;	/* Additional data for geometry container. */
@@ -222,15 +260,6 @@ typedef struct Gridder {
 #define STICK_WEST		8
 
 
-/*
- * Structure to gather information about uniform groups during layout.
- */
-
-typedef struct UniformGroup {
-    Tk_Uid group;
-    int minSize;
-} UniformGroup;
-
 /*
  * Flag values for Grid structures:
  *
@@ -292,6 +321,8 @@ static void		GridLostContentProc(void *clientData,
 			    Tk_Window tkwin);
 static void		GridReqProc(void *clientData, Tk_Window tkwin);
 static void		InitContainerData(Gridder *containerPtr);
+static void		InvalidateConstraintCache(Gridder *containerPtr,
+			    int mask);
 static Tcl_Obj *	NewPairObj(Tcl_WideInt, Tcl_WideInt);
 static Tcl_Obj *	NewQuadObj(Tcl_WideInt, Tcl_WideInt, Tcl_WideInt, Tcl_WideInt);
 static int		ResolveConstraints(Gridder *gridPtr, int rowOrColumn,
@@ -301,6 +332,8 @@ static int		SetContentColumn(Tcl_Interp *interp, Gridder *contentPtr,
 			    int column, int numCols);
 static int		SetContentRow(Tcl_Interp *interp, Gridder *contentPtr,
 			    int row, int numRows);
+static void		SetSlotUniform(Gridder *containerPtr, int slotType,
+			    int slot, Tk_Uid uniform);
 static Tcl_Obj *	StickyToObj(int flags);
 static int		StringToSticky(const char *string);
 static void		Unlink(Gridder *gridPtr);
@@ -485,7 +518,7 @@ GridAnchorCommand(
 	}
 	if (!(containerPtr->flags & REQUESTED_RELAYOUT)) {
 	    containerPtr->flags |= REQUESTED_RELAYOUT;
-	    Tcl_DoWhenIdle(ArrangeGrid, containerPtr);
+	    TkDoWhenIdle(ArrangeGrid, containerPtr, TK_IDLE_LAYOUT);
 	}
     }
     return TCL_OK;
@@ -678,7 +711,7 @@ GridForgetRemoveCommand(
 		}
 		contentPtr->doubleBw = 2*Tk_Changes(tkwin)->border_width;
 		if (contentPtr->flags & REQUESTED_RELAYOUT) {
-		    Tcl_CancelIdleCall(ArrangeGrid, contentPtr);
+		    TkCancelDoWhenIdle(ArrangeGrid, contentPtr);
 		}
 		contentPtr->flags = 0;
 		contentPtr->sticky = 0;
@@ -834,7 +867,7 @@ GridLocationCommand(
      */
 
     while (containerPtr->flags & REQUESTED_RELAYOUT) {
-	Tcl_CancelIdleCall(ArrangeGrid, containerPtr);
+	TkCancelDoWhenIdle(ArrangeGrid, containerPtr);
 	ArrangeGrid(containerPtr);
     }
     SetGridSize(containerPtr);
@@ -947,7 +980,7 @@ GridPropagateCommand(
 	}
 	if (!(containerPtr->flags & REQUESTED_RELAYOUT)) {
 	    containerPtr->flags |= REQUESTED_RELAYOUT;
-	    Tcl_DoWhenIdle(ArrangeGrid, containerPtr);
+	    TkDoWhenIdle(ArrangeGrid, containerPtr, TK_IDLE_LAYOUT);
 	}
     }
     return TCL_OK;
@@ -1216,12 +1249,12 @@ GridRowColumnConfigureCommand(
 			    slotPtr[slot].weight = wt;
 			}
 		    } else if (index == ROWCOL_UNIFORM) {
-			slotPtr[slot].uniform =
-				Tk_GetUid(Tcl_GetString(objv[i+1]));
-			if (slotPtr[slot].uniform != NULL &&
-				slotPtr[slot].uniform[0] == 0) {
-			    slotPtr[slot].uniform = NULL;
+			Tk_Uid uniform = Tk_GetUid(Tcl_GetString(objv[i+1]));
+
+			if (uniform != NULL && uniform[0] == 0) {
+			    uniform = NULL;
 			}
+			SetSlotUniform(containerPtr, slotType, slot, uniform);
 		    } else if (index == ROWCOL_PAD) {
 			if (Tk_GetPixelsFromObj(interp, container, objv[i+1],
 				&size) != TCL_OK) {
@@ -1270,12 +1303,13 @@ GridRowColumnConfigureCommand(
 	}
     }
 
+    InvalidateConstraintCache(containerPtr, slotType);
     if (containerPtr->abortPtr != NULL) {
 	*containerPtr->abortPtr = 1;
     }
     if (!(containerPtr->flags & REQUESTED_RELAYOUT)) {
 	containerPtr->flags |= REQUESTED_RELAYOUT;
-	Tcl_DoWhenIdle(ArrangeGrid, containerPtr);
+	TkDoWhenIdle(ArrangeGrid, containerPtr, TK_IDLE_LAYOUT);
     }
     return TCL_OK;
 
@@ -1449,9 +1483,10 @@ GridReqProc(
     Gridder *gridPtr = (Gridder *)clientData;
 
     gridPtr = gridPtr->containerPtr;
+    InvalidateConstraintCache(gridPtr, COLUMN|ROW);
     if (gridPtr && !(gridPtr->flags & REQUESTED_RELAYOUT)) {
 	gridPtr->flags |= REQUESTED_RELAYOUT;
-	Tcl_DoWhenIdle(ArrangeGrid, gridPtr);
+	TkDoWhenIdle(ArrangeGrid, gridPtr, TK_IDLE_LAYOUT);
     }
 }
 
@@ -1798,7 +1833,7 @@ ArrangeGrid(
 	Tk_GeometryRequest(containerPtr->tkwin, width, height);
 	if (width>1 && height>1) {
 	    containerPtr->flags |= REQUESTED_RELAYOUT;
-	    Tcl_DoWhenIdle(ArrangeGrid, containerPtr);
+	    TkDoWhenIdle(ArrangeGrid, containerPtr, TK_IDLE_LAYOUT);
 	}
 	containerPtr->abortPtr = NULL;
 	Tcl_Release(containerPtr);
@@ -1936,13 +1971,10 @@ ResolveConstraints(
 				 * constraints are not yet fully resolved. */
     int end;			/* The Last slot of a contiguous set whose
 				 * constraints are not yet fully resolved. */
-    UniformGroup uniformPre[UNIFORM_PREALLOC];
-				/* Pre-allocated space for uniform groups. */
     UniformGroup *uniformGroupPtr;
-				/* Uniform groups data. */
-    int uniformGroups;		/* Number of currently used uniform groups. */
-    int uniformGroupsAlloced;	/* Size of allocated space for uniform
-				 * groups. */
+				/* The container's uniform groups for this
+				 * axis. */
+    int uniformGroups;		/* Number of uniform groups for this axis. */
     int minSize;
     int prevGrow, accWeight, grow;
 
@@ -1968,6 +2000,22 @@ ResolveConstraints(
      */
 
     gridCount = MAX(constraintCount, slotCount);
+
+    /*
+     * If nothing that feeds this axis has changed since the last solve,
+     * restore the cached natural offsets instead of re-solving from
+     * scratch. AdjustOffsets may have rewritten the offsets to fit the
+     * actual container size, so they have to be restored even on a hit.
+     */
+
+    if ((maxOffset == 0)
+	    && (containerPtr->containerDataPtr->layoutValid & slotType)) {
+	for (slot = 0; slot < gridCount; slot++) {
+	    slotPtr[slot].offset = slotPtr[slot].natural;
+	}
+	return containerPtr->containerDataPtr->naturalSize[slotType];
+    }
+
     if (gridCount >= TYPICAL_SIZE) {
 	layoutPtr = (GridLayout *)ckalloc(sizeof(GridLayout) * (1+gridCount));
     } else {
@@ -1996,14 +2044,14 @@ ResolveConstraints(
     for (slot=0; slot < constraintCount; slot++) {
 	layoutPtr[slot].minSize = slotPtr[slot].minSize;
 	layoutPtr[slot].weight = slotPtr[slot].weight;
-	layoutPtr[slot].uniform = slotPtr[slot].uniform;
+	layoutPtr[slot].uniformIndex = slotPtr[slot].uniformIndex;
 	layoutPtr[slot].pad = slotPtr[slot].pad;
 	layoutPtr[slot].binNextPtr = NULL;
     }
     for (; slot<gridCount; slot++) {
 	layoutPtr[slot].minSize = 0;
 	layoutPtr[slot].weight = 0;
-	layoutPtr[slot].uniform = NULL;
+	layoutPtr[slot].uniformIndex = 0;
 	layoutPtr[slot].pad = 0;
 	layoutPtr[slot].binNextPtr = NULL;
     }
@@ -2063,81 +2111,42 @@ ResolveConstraints(
 
     /*
      * Step 2b.
-     * Consider demands on uniform sizes.
+     * Consider demands on uniform sizes. Group membership is maintained
+     * persistently on the container (see SetSlotUniform), so there is no
+     * group discovery to do here: one pass gathers the equalized sizes,
+     * a second pass applies them.
      */
 
-    uniformGroupPtr = uniformPre;
-    uniformGroupsAlloced = UNIFORM_PREALLOC;
-    uniformGroups = 0;
-
-    for (slot = 0; slot < gridCount; slot++) {
-	if (layoutPtr[slot].uniform != NULL) {
-		int weight;
-	    for (start = 0; start < uniformGroups; start++) {
-		if (uniformGroupPtr[start].group == layoutPtr[slot].uniform) {
-		    break;
-		}
-	    }
-	    if (start >= uniformGroups) {
-		/*
-		 * Have not seen that group before, set up data for it.
-		 */
-
-		if (uniformGroups >= uniformGroupsAlloced) {
-		    /*
-		     * We need to allocate more space.
-		     */
-
-		    size_t oldSize = uniformGroupsAlloced
-			    * sizeof(UniformGroup);
-		    size_t newSize = (uniformGroupsAlloced + UNIFORM_PREALLOC)
-			    * sizeof(UniformGroup);
-		    UniformGroup *newUG = (UniformGroup *)ckalloc(newSize);
-		    UniformGroup *oldUG = uniformGroupPtr;
-
-		    memcpy(newUG, oldUG, oldSize);
-		    if (oldUG != uniformPre) {
-			ckfree(oldUG);
-		    }
-		    uniformGroupPtr = newUG;
-		    uniformGroupsAlloced += UNIFORM_PREALLOC;
-		}
-		uniformGroups++;
-		uniformGroupPtr[start].group = layoutPtr[slot].uniform;
-		uniformGroupPtr[start].minSize = 0;
-	    }
-	    weight = layoutPtr[slot].weight;
-	    weight = weight > 0 ? weight : 1;
-	    minSize = (layoutPtr[slot].minSize + weight - 1) / weight;
-	    if (minSize > uniformGroupPtr[start].minSize) {
-		uniformGroupPtr[start].minSize = minSize;
-	    }
-	}
-    }
-
-    /*
-     * Data has been gathered about uniform groups. Now relayout accordingly.
-     */
+    uniformGroupPtr = containerPtr->containerDataPtr->uniformPtr[slotType];
+    uniformGroups = containerPtr->containerDataPtr->uniformCount[slotType];
 
     if (uniformGroups > 0) {
+	for (start = 0; start < uniformGroups; start++) {
+	    uniformGroupPtr[start].minSize = 0;
+	}
 	for (slot = 0; slot < gridCount; slot++) {
-	    if (layoutPtr[slot].uniform != NULL) {
-		for (start = 0; start < uniformGroups; start++) {
-		    if (uniformGroupPtr[start].group ==
-			    layoutPtr[slot].uniform) {
-			int weight = layoutPtr[slot].weight;
-			weight = weight > 0 ? weight : 1;
-			layoutPtr[slot].minSize =
-				uniformGroupPtr[start].minSize * weight;
-			break;
-		    }
+	    if (layoutPtr[slot].uniformIndex > 0) {
+		int weight = layoutPtr[slot].weight;
+
+		weight = weight > 0 ? weight : 1;
+		minSize = (layoutPtr[slot].minSize + weight - 1) / weight;
+		if (minSize > uniformGroupPtr[layoutPtr[slot].uniformIndex
+			- 1].minSize) {
+		    uniformGroupPtr[layoutPtr[slot].uniformIndex - 1].minSize
+			    = minSize;
 		}
 	    }
 	}
-    }
+	for (slot = 0; slot < gridCount; slot++) {
+	    if (layoutPtr[slot].uniformIndex > 0) {
+		int weight = layoutPtr[slot].weight;
 
-    if (uniformGroupPtr != uniformPre) {
-	ckfree(uniformGroupPtr);
+		weight = weight > 0 ? weight : 1;
+		layoutPtr[slot].minSize =
+			uniformGroupPtr[layoutPtr[slot].uniformIndex - 1]
+			.minSize * weight;
+	    }
+	}
     }
 
     /*
@@ -2403,6 +2412,11 @@ ResolveConstraints(
 
     for (slot=0; slot < gridCount; slot++) {
 	slotPtr[slot].offset = layoutPtr[slot].minOffset;
+	slotPtr[slot].natural = layoutPtr[slot].minOffset;
+    }
+    if (maxOffset == 0) {
+	containerPtr->containerDataPtr->naturalSize[slotType] = requiredSize;
+	containerPtr->containerDataPtr->layoutValid |= slotType;
     }
 
     --layoutPtr;
@@ -2460,6 +2474,7 @@ GetGrid(
     gridPtr->containerPtr = NULL;
     gridPtr->containerDataPtr = NULL;
     gridPtr->nextPtr = NULL;
+    gridPtr->prevPtr = NULL;
     gridPtr->contentPtr = NULL;
     gridPtr->binNextPtr = NULL;
 
@@ -2729,13 +2744,129 @@ InitContainerData(
 	gridPtr->rowSpace = TYPICAL_SIZE;
 	gridPtr->startX = 0;
 	gridPtr->startY = 0;
+	gridPtr->layoutValid = 0;
+	gridPtr->naturalSize[COLUMN] = 0;
+	gridPtr->naturalSize[ROW] = 0;
+	gridPtr->uniformPtr[COLUMN] = NULL;
+	gridPtr->uniformPtr[ROW] = NULL;
+	gridPtr->uniformCount[COLUMN] = gridPtr->uniformCount[ROW] = 0;
+	gridPtr->uniformSpace[COLUMN] = gridPtr->uniformSpace[ROW] = 0;
 	gridPtr->anchor = GRID_DEFAULT_ANCHOR;
 
 	memset(gridPtr->columnPtr, 0, size);
 	memset(gridPtr->rowPtr, 0, size);
     }
 }
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * InvalidateConstraintCache --
+ *
+ *	Called whenever something that feeds the constraint solver changes:
+ *	a content window's requested size, border width, position, span or
+ *	padding, the content list itself, or a row/column constraint. Marks
+ *	the cached natural offsets of the given axes stale so the next
+ *	ArrangeGrid re-solves them. Container resizes deliberately do not
+ *	come through here; the natural layout is independent of the actual
+ *	container size, which lets interactive resizing reuse the cache.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	ResolveConstraints will re-solve the given axes on its next call.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+InvalidateConstraintCache(
+    Gridder *containerPtr,	/* Geometry container, or NULL. */
+    int mask)			/* COLUMN, ROW, or both OR-ed together. */
+{
+    if ((containerPtr != NULL) && (containerPtr->containerDataPtr != NULL)) {
+	containerPtr->containerDataPtr->layoutValid &= ~mask;
+    }
+}
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * SetSlotUniform --
+ *
+ *	Set the -uniform group of a row or column, keeping the container's
+ *	persistent per-axis group array up to date. The slot leaves its old
+ *	group (if any); an empty group's entry is kept and reused for the
+ *	next new group name, so the array cannot grow beyond the number of
+ *	distinct groups in simultaneous use.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Group membership counts change; the group array may grow.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+SetSlotUniform(
+    Gridder *containerPtr,	/* The geometry container for this grid. */
+    int slotType,		/* ROW or COLUMN. */
+    int slot,			/* Which slot to modify. */
+    Tk_Uid uniform)		/* New group name, or NULL for none. */
+{
+    GridContainer *gridPtr = containerPtr->containerDataPtr;
+    SlotInfo *slotPtr = (slotType == COLUMN)
+	    ? gridPtr->columnPtr : gridPtr->rowPtr;
+    UniformGroup *groupPtr = gridPtr->uniformPtr[slotType];
+    int i, empty = -1;
+
+    if (slotPtr[slot].uniform == uniform) {
+	return;
+    }
+    if (slotPtr[slot].uniformIndex > 0) {
+	groupPtr[slotPtr[slot].uniformIndex - 1].refCount--;
+    }
+    slotPtr[slot].uniform = uniform;
+    slotPtr[slot].uniformIndex = 0;
+    if (uniform == NULL) {
+	return;
+    }
+
+    for (i = 0; i < gridPtr->uniformCount[slotType]; i++) {
+	if (groupPtr[i].group == uniform) {
+	    groupPtr[i].refCount++;
+	    slotPtr[slot].uniformIndex = i + 1;
+	    return;
+	}
+	if ((empty < 0) && (groupPtr[i].refCount == 0)) {
+	    empty = i;
+	}
+    }
+    if (empty < 0) {
+	if (gridPtr->uniformCount[slotType] >= gridPtr->uniformSpace[slotType]) {
+	    int newSpace = gridPtr->uniformSpace[slotType] + UNIFORM_PREALLOC;
+	    UniformGroup *newPtr = (UniformGroup *)
+		    ckalloc(newSpace * sizeof(UniformGroup));
+
+	    memcpy(newPtr, groupPtr,
+		    gridPtr->uniformCount[slotType] * sizeof(UniformGroup));
+	    if (groupPtr != NULL) {
+		ckfree(groupPtr);
+	    }
+	    gridPtr->uniformPtr[slotType] = groupPtr = newPtr;
+	    gridPtr->uniformSpace[slotType] = newSpace;
+	}
+	empty = gridPtr->uniformCount[slotType]++;
+    }
+    groupPtr[empty].group = uniform;
+    groupPtr[empty].refCount = 1;
+    groupPtr[empty].minSize = 0;
+    slotPtr[slot].uniformIndex = empty + 1;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -2757,29 +2888,29 @@ static void
 Unlink(
     Gridder *contentPtr)	/* Window to unlink. */
 {
-    Gridder *containerPtr, *contentPtr2;
+    Gridder *containerPtr;
 
     containerPtr = contentPtr->containerPtr;
     if (containerPtr == NULL) {
 	return;
     }
 
-    if (containerPtr->contentPtr == contentPtr) {
+    if (contentPtr->prevPtr == NULL) {
+	if (containerPtr->contentPtr != contentPtr) {
+	    Tcl_Panic("Unlink couldn't find previous window");
+	}
 	containerPtr->contentPtr = contentPtr->nextPtr;
     } else {
-	for (contentPtr2=containerPtr->contentPtr ; ; contentPtr2=contentPtr2->nextPtr) {
-	    if (contentPtr2 == NULL) {
-		Tcl_Panic("Unlink couldn't find previous window");
-	    }
-	    if (contentPtr2->nextPtr == contentPtr) {
-		contentPtr2->nextPtr = contentPtr->nextPtr;
-		break;
-	    }
-	}
+	contentPtr->prevPtr->nextPtr = contentPtr->nextPtr;
+    }
+    if (contentPtr->nextPtr != NULL) {
+	contentPtr->nextPtr->prevPtr = contentPtr->prevPtr;
     }
+    contentPtr->prevPtr = NULL;
+    InvalidateConstraintCache(containerPtr, COLUMN|ROW);
     if (!(containerPtr->flags & REQUESTED_RELAYOUT)) {
 	containerPtr->flags |= REQUESTED_RELAYOUT;
-	Tcl_DoWhenIdle(ArrangeGrid, containerPtr);
+	TkDoWhenIdle(ArrangeGrid, containerPtr, TK_IDLE_LAYOUT);
     }
     if (containerPtr->abortPtr != NULL) {
 	*containerPtr->abortPtr = 1;
@@ -2834,7 +2965,7 @@ DestroyGrid(
     Gridder *gridPtr = (Gridder *)memPtr;
 
     if (gridPtr->flags & REQUESTED_RELAYOUT) {
-	Tcl_CancelIdleCall(ArrangeGrid, gridPtr);
+	TkCancelDoWhenIdle(ArrangeGrid, gridPtr);
     }
     if (gridPtr->containerDataPtr != NULL) {
 	if (gridPtr->containerDataPtr->rowPtr != NULL) {
@@ -2843,6 +2974,12 @@ DestroyGrid(
 	if (gridPtr->containerDataPtr->columnPtr != NULL) {
 	    ckfree(gridPtr->containerDataPtr -> columnPtr);
 	}
+	if (gridPtr->containerDataPtr->uniformPtr[ROW] != NULL) {
+	    ckfree(gridPtr->containerDataPtr->uniformPtr[ROW]);
+	}
+	if (gridPtr->containerDataPtr->uniformPtr[COLUMN] != NULL) {
+	    ckfree(gridPtr->containerDataPtr->uniformPtr[COLUMN]);
+	}
 	ckfree(gridPtr->containerDataPtr);
     }
     if (gridPtr->in != NULL) {
@@ -2882,14 +3019,15 @@ GridStructureProc(
 	if ((gridPtr->contentPtr != NULL)
 		&& !(gridPtr->flags & REQUESTED_RELAYOUT)) {
 	    gridPtr->flags |= REQUESTED_RELAYOUT;
-	    Tcl_DoWhenIdle(ArrangeGrid, gridPtr);
+	    TkDoWhenIdle(ArrangeGrid, gridPtr, TK_IDLE_LAYOUT);
 	}
 	if ((gridPtr->containerPtr != NULL) &&
 		(gridPtr->doubleBw != 2*Tk_Changes(gridPtr->tkwin)->border_width)) {
+	    InvalidateConstraintCache(gridPtr->containerPtr, COLUMN|ROW);
 	    if (!(gridPtr->containerPtr->flags & REQUESTED_RELAYOUT)) {
 		gridPtr->doubleBw = 2*Tk_Changes(gridPtr->tkwin)->border_width;
 		gridPtr->containerPtr->flags |= REQUESTED_RELAYOUT;
-		Tcl_DoWhenIdle(ArrangeGrid, gridPtr->containerPtr);
+		TkDoWhenIdle(ArrangeGrid, gridPtr->containerPtr, TK_IDLE_LAYOUT);
 	    }
 	}
     } else if (eventPtr->type == DestroyNotify) {
@@ -2905,11 +3043,12 @@ GridStructureProc(
 	    contentPtr->containerPtr = NULL;
 	    nextPtr = contentPtr->nextPtr;
 	    contentPtr->nextPtr = NULL;
+	    contentPtr->prevPtr = NULL;
 	}
 	Tcl_DeleteHashEntry(Tcl_FindHashEntry(&dispPtr->gridHashTable,
 		gridPtr->tkwin));
 	if (gridPtr->flags & REQUESTED_RELAYOUT) {
-	    Tcl_CancelIdleCall(ArrangeGrid, gridPtr);
+	    TkCancelDoWhenIdle(ArrangeGrid, gridPtr);
 	}
 	gridPtr->tkwin = NULL;
 	Tcl_EventuallyFree(gridPtr, DestroyGrid);
@@ -2917,7 +3056,7 @@ GridStructureProc(
 	if ((gridPtr->contentPtr != NULL)
 		&& !(gridPtr->flags & REQUESTED_RELAYOUT)) {
 	    gridPtr->flags |= REQUESTED_RELAYOUT;
-	    Tcl_DoWhenIdle(ArrangeGrid, gridPtr);
+	    TkDoWhenIdle(ArrangeGrid, gridPtr, TK_IDLE_LAYOUT);
 	}
     } else if (eventPtr->type == UnmapNotify) {
 	Gridder *contentPtr;
@@ -3355,6 +3494,10 @@ ConfigureContent(
 	    contentPtr->containerPtr = containerPtr;
 	    containerPtr->contentPtr = contentPtr;
 	    contentPtr->nextPtr = tempPtr;
+	    contentPtr->prevPtr = NULL;
+	    if (tempPtr != NULL) {
+		tempPtr->prevPtr = contentPtr;
+	    }
 	}
 
 	/*
@@ -3434,12 +3577,13 @@ ConfigureContent(
 	 */
 
     scheduleLayout:
+	InvalidateConstraintCache(containerPtr, COLUMN|ROW);
 	if (containerPtr->abortPtr != NULL) {
 	    *containerPtr->abortPtr = 1;
 	}
 	if (!(containerPtr->flags & REQUESTED_RELAYOUT)) {
 	    containerPtr->flags |= REQUESTED_RELAYOUT;
-	    Tcl_DoWhenIdle(ArrangeGrid, containerPtr);
+	    TkDoWhenIdle(ArrangeGrid, containerPtr, TK_IDLE_LAYOUT);
 	}
     }
 
@@ -3514,6 +3658,7 @@ ConfigureContent(
 			    contentPtr->numRows + 1) != TCL_OK) {
 			return TCL_ERROR;
 		    }
+		    InvalidateConstraintCache(containerPtr, ROW);
 		    match++;
 		    j += contentPtr->numCols - 1;
 		    lastWindow = Tk_PathName(contentPtr->tkwin);
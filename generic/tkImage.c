@@ -67,6 +67,12 @@ typedef struct ImageModel {
 				 * entry). */
     Image *instancePtr;		/* Pointer to first in list of instances
 				 * derived from this name. */
+    int changePending;		/* Non-zero means DeliverImageChanges is
+				 * scheduled to fan the accumulated change
+				 * out to the instances. */
+    int dirtyX, dirtyY;		/* Bounding box of the regions passed to */
+    int dirtyWidth;		/* Tk_ImageChanged since the last delivery; */
+    int dirtyHeight;		/* dirtyWidth <= 0 means empty. */
     int deleted;		/* Flag set when image is being deleted. */
     TkWindow *winPtr;		/* Main window of interpreter (used to detect
 				 * when the world is falling apart.) */
@@ -89,6 +95,7 @@ static Tcl_ThreadDataKey dataKey;
 
 static void		ImageTypeThreadExitProc(void *clientData);
 static Tcl_FreeProc	DeleteImage;
+static void		DeliverImageChanges(void *clientData);
 static void		EventuallyDeleteImage(ImageModel *modelPtr,
 			    int forgetImageHashNow);
 
@@ -310,6 +317,9 @@ Tk_ImageObjCmd(
 	    modelPtr->tablePtr = &winPtr->mainPtr->imageTable;
 	    modelPtr->hPtr = hPtr;
 	    modelPtr->instancePtr = NULL;
+	    modelPtr->changePending = 0;
+	    modelPtr->dirtyX = modelPtr->dirtyY = 0;
+	    modelPtr->dirtyWidth = modelPtr->dirtyHeight = 0;
 	    modelPtr->deleted = 0;
 	    modelPtr->winPtr = winPtr->mainPtr->winPtr;
 	    Tcl_Preserve(modelPtr->winPtr);
@@ -527,14 +537,97 @@ Tk_ImageChanged(
 				/* New dimensions of image. */
 {
     ImageModel *modelPtr = (ImageModel *) imageModel;
-    Image *imagePtr;
 
     modelPtr->width = imageWidth;
     modelPtr->height = imageHeight;
+    if (modelPtr->instancePtr == NULL) {
+	return;
+    }
+
+    /*
+     * Don't fan the change out to the instances right away: an animation
+     * or a script touching an image several times per cycle would make
+     * every displaying widget invalidate itself once per touch.
+     * Accumulate the changed region instead and deliver it once, before
+     * the widgets repaint (layout tier; see TkDoWhenIdle).
+     */
+
+    if ((width > 0) && (height > 0)) {
+	if (modelPtr->dirtyWidth > 0) {
+	    int x2 = modelPtr->dirtyX + modelPtr->dirtyWidth;
+	    int y2 = modelPtr->dirtyY + modelPtr->dirtyHeight;
+
+	    if (x + width > x2) {
+		x2 = x + width;
+	    }
+	    if (y + height > y2) {
+		y2 = y + height;
+	    }
+	    if (x < modelPtr->dirtyX) {
+		modelPtr->dirtyX = x;
+	    }
+	    if (y < modelPtr->dirtyY) {
+		modelPtr->dirtyY = y;
+	    }
+	    modelPtr->dirtyWidth = x2 - modelPtr->dirtyX;
+	    modelPtr->dirtyHeight = y2 - modelPtr->dirtyY;
+	} else {
+	    modelPtr->dirtyX = x;
+	    modelPtr->dirtyY = y;
+	    modelPtr->dirtyWidth = width;
+	    modelPtr->dirtyHeight = height;
+	}
+    }
+    if (!modelPtr->changePending) {
+	modelPtr->changePending = 1;
+	TkDoWhenIdle(DeliverImageChanges, modelPtr, TK_IDLE_LAYOUT);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DeliverImageChanges --
+ *
+ *	Idle callback that fans the changes accumulated by Tk_ImageChanged
+ *	out to every instance of the image, invoking each widget's
+ *	changeProc once with the bounding box of all changed regions and
+ *	the latest image dimensions.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Whatever the widgets' changeProcs do; typically they record damage
+ *	and schedule a redisplay.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DeliverImageChanges(
+    void *clientData)		/* Pointer to ImageModel. */
+{
+    ImageModel *modelPtr = (ImageModel *)clientData;
+    Image *imagePtr;
+    int x = modelPtr->dirtyX;
+    int y = modelPtr->dirtyY;
+    int width = modelPtr->dirtyWidth;
+    int height = modelPtr->dirtyHeight;
+
+    modelPtr->changePending = 0;
+    modelPtr->dirtyX = modelPtr->dirtyY = 0;
+    modelPtr->dirtyWidth = modelPtr->dirtyHeight = 0;
+    if (width < 0) {
+	width = 0;
+    }
+    if (height < 0) {
+	height = 0;
+    }
     for (imagePtr = modelPtr->instancePtr; imagePtr != NULL;
 	    imagePtr = imagePtr->nextPtr) {
 	imagePtr->changeProc(imagePtr->widgetClientData, x, y, width, height,
-		imageWidth, imageHeight);
+		modelPtr->width, modelPtr->height);
     }
 }
 
@@ -694,6 +787,9 @@ Tk_FreeImage(
      */
 
     if ((modelPtr->typePtr == NULL) && (modelPtr->instancePtr == NULL)) {
+	if (modelPtr->changePending) {
+	    TkCancelDoWhenIdle(DeliverImageChanges, modelPtr);
+	}
 	if (modelPtr->hPtr != NULL) {
 	    Tcl_DeleteHashEntry(modelPtr->hPtr);
 	}
@@ -963,6 +1059,11 @@ DeleteImage(
     Tk_ImageType *typePtr;
     ImageModel *modelPtr = (ImageModel *)blockPtr;
 
+    if (modelPtr->changePending) {
+	modelPtr->changePending = 0;
+	modelPtr->dirtyWidth = modelPtr->dirtyHeight = 0;
+	TkCancelDoWhenIdle(DeliverImageChanges, modelPtr);
+    }
     typePtr = modelPtr->typePtr;
     modelPtr->typePtr = NULL;
     if (typePtr != NULL) {
@@ -197,6 +197,8 @@ static int		GetCode(Tcl_Channel chan, int code_size, int flag,
 			    GIFImageConfig *gifConfPtr);
 static int		GetDataBlock(GIFImageConfig *gifConfPtr,
 			    Tcl_Channel chan, unsigned char *buf);
+static int		SkipImageData(GIFImageConfig *gifConfPtr,
+			    Tcl_Interp *interp, Tcl_Channel chan);
 static int		ReadColorMap(GIFImageConfig *gifConfPtr,
 			    Tcl_Channel chan, int number,
 			    unsigned char buffer[MAXCOLORMAPSIZE][4]);
@@ -427,7 +429,6 @@ FileReadGIF(
     Tcl_Size argc = 0, i;
     Tcl_Obj **objv;
     unsigned char buf[100];
-    unsigned char *trashBuffer = NULL;
     int bitPixel;
     int gifLabel;
     unsigned char colorMap[MAXCOLORMAPSIZE][4];
@@ -616,39 +617,16 @@ FileReadGIF(
 	    }
 
 	    /*
-	     * If we've not yet allocated a trash buffer, do so now.
+	     * Step over the compressed data for this frame. The LZW data
+	     * is stored as a minimum-code-size byte followed by a chain of
+	     * length-prefixed sub-blocks, so it can be skipped without
+	     * running the decoder at all. This keeps advancing through an
+	     * animation with "-format {gif -index N}" proportional to the
+	     * compressed size of the skipped frames instead of their
+	     * decoded pixel count.
 	     */
 
-	    if (trashBuffer == NULL) {
-		if (fileWidth > (int)((UINT_MAX/3)/fileHeight)) {
-		    goto error;
-		}
-		nBytes = fileWidth * fileHeight * 3;
-		trashBuffer = (unsigned char *)ckalloc(nBytes);
-		if (trashBuffer) {
-		    memset(trashBuffer, 0, nBytes);
-		}
-	    }
-
-	    /*
-	     * Slurp! Process the data for this image and stuff it in a trash
-	     * buffer.
-	     *
-	     * Yes, it might be more efficient here to *not* store the data
-	     * (we're just going to throw it away later). However, I elected
-	     * to implement it this way for good reasons. First, I wanted to
-	     * avoid duplicating the (fairly complex) LWZ decoder in
-	     * ReadImage. Fine, you say, why didn't you just modify it to
-	     * allow the use of a NULL specifier for the output buffer? I
-	     * tried that, but it negatively impacted the performance of what
-	     * I think will be the common case: reading the first image in the
-	     * file. Rather than marginally improve the speed of the less
-	     * frequent case, I chose to maintain high performance for the
-	     * common case.
-	     */
-
-	    if (ReadImage(gifConfPtr, interp, trashBuffer, chan, imageWidth,
-		    imageHeight, colorMap, 0, 0, 0, -1) != TCL_OK) {
+	    if (SkipImageData(gifConfPtr, interp, chan) != TCL_OK) {
 		goto error;
 	    }
 
@@ -875,14 +853,6 @@ FileReadGIF(
     result = TCL_OK;
 
 error:
-
-    /*
-     * If a trash buffer has been allocated, free it now.
-     */
-
-    if (trashBuffer != NULL) {
-	ckfree(trashBuffer);
-    }
     return result;
 }
 
@@ -1027,33 +997,39 @@ StringReadGIF(
 {
     MFile handle, *hdlPtr = &handle;
     Tcl_Size length;
-    const char *xferFormat;
+    int result;
+    unsigned char *decoded = NULL;
     unsigned char *data = Tcl_GetByteArrayFromObj(dataObj, &length);
 
-    mInit(data, hdlPtr, length);
-
     /*
      * Check whether the data is Base64 encoded by doing a character-by-
      * charcter comparison with the binary-format headers; BASE64-encoded
      * never matches (matching the other way is harder because of potential
-     * padding of the BASE64 data).
+     * padding of the BASE64 data). Base64 data is decoded in full up front,
+     * so the GIF parser below always pulls plain binary bytes instead of
+     * paying for a character-at-a-time decode on every read.
      */
 
     if (strncmp(GIF87a, (char *) data, 6)
 	    && strncmp(GIF89a, (char *) data, 6)) {
-	xferFormat = INLINE_DATA_BASE64;
-    } else {
-	xferFormat = INLINE_DATA_BINARY;
+	decoded = (unsigned char *)ckalloc(3 * (length / 4) + 2);
+	length = TkBase64Decode(data, length, decoded);
+	data = decoded;
     }
+    mInit(data, hdlPtr, length);
 
     /*
      * Fall through to the file reader now that we have a correctly-configured
      * pseudo-channel to pull the data from.
      */
 
-    return FileReadGIF(interp, (Tcl_Channel) hdlPtr, xferFormat, format,
-	    metadataInObj, imageHandle, destX, destY, width, height, srcX, srcY,
-	    metadataOutObj);
+    result = FileReadGIF(interp, (Tcl_Channel) hdlPtr, INLINE_DATA_BINARY,
+	    format, metadataInObj, imageHandle, destX, destY, width, height,
+	    srcX, srcY, metadataOutObj);
+    if (decoded) {
+	ckfree(decoded);
+    }
+    return result;
 }
 
 /*
@@ -1249,6 +1225,39 @@ DoExtension(
     return count; /* this may be -1 for error or 0 */
 }
 
+static int
+SkipImageData(
+    GIFImageConfig *gifConfPtr,
+    Tcl_Interp *interp,
+    Tcl_Channel chan)
+{
+    unsigned char initialCodeSize;
+    int count;
+
+    if (Fread(gifConfPtr, &initialCodeSize, 1, 1, chan) <= 0) {
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		"error reading GIF image: unexpected end of data",
+		TCL_INDEX_NONE));
+	Tcl_SetErrorCode(interp, "TK", "IMAGE", "GIF", "UNEXPECTED_EOF",
+		NULL);
+	return TCL_ERROR;
+    }
+
+    do {
+	count = GetDataBlock(gifConfPtr, chan, gifConfPtr->workingBuffer);
+	if (count < 0) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "error reading GIF image: unexpected end of data",
+		    TCL_INDEX_NONE));
+	    Tcl_SetErrorCode(interp, "TK", "IMAGE", "GIF", "UNEXPECTED_EOF",
+		    NULL);
+	    return TCL_ERROR;
+	}
+    } while (count > 0);
+
+    return TCL_OK;
+}
+
 static int
 GetDataBlock(
     GIFImageConfig *gifConfPtr,
@@ -0,0 +1,878 @@
+/*
+ * tkImgGradient.c --
+ *
+ *	This procedure implements images of type "gradient" for Tk. A
+ *	gradient image is a rectangle filled with a smooth linear blend
+ *	between two colors. The blend is rendered once per instance into a
+ *	server-side pixmap (via the X RENDER extension where available, and
+ *	with banded solid fills elsewhere), so displaying the image is a
+ *	single copy on the server no matter how often or how large it is
+ *	drawn.
+ *
+ * Copyright © 2026 Tcl Core Team.
+ *
+ * See the file "license.terms" for information on usage and redistribution
+ * of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#include "tkInt.h"
+
+/*
+ * Maximum number of solid bands used to approximate the blend when the
+ * server cannot render gradients itself. Each band costs one fill request
+ * and (on colormapped displays) one color cell.
+ */
+
+#define GRADIENT_MAX_BANDS 64
+
+/*
+ * The following data structure represents the model for a gradient
+ * image:
+ */
+
+typedef struct {
+    Tk_ImageModel tkModel;	/* Tk's token for image model. NULL means the
+				 * image is being deleted. */
+    Tcl_Interp *interp;		/* Interpreter for application that is using
+				 * image. */
+    Tcl_Command imageCmd;	/* Token for image command (used to delete it
+				 * when the image goes away). NULL means the
+				 * image command has already been deleted. */
+    int width, height;		/* Dimensions of image. */
+    Tk_Uid startUid;		/* Value of -start option (malloc'ed). */
+    Tk_Uid endUid;		/* Value of -end option (malloc'ed). */
+    Tk_Uid orientUid;		/* Value of -orient option (malloc'ed). */
+    int vertical;		/* 1 means the blend runs from top to bottom,
+				 * 0 means from left to right. Derived from
+				 * orientUid. */
+    struct GradientInstance *instancePtr;
+				/* First in list of all instances associated
+				 * with this model. */
+} GradientModel;
+
+/*
+ * The following data structure represents all of the instances of an image
+ * that lie within a particular window:
+ */
+
+typedef struct GradientInstance {
+    size_t refCount;		/* Number of instances that share this data
+				 * structure. */
+    GradientModel *modelPtr;	/* Pointer to model for image. */
+    Tk_Window tkwin;		/* Window in which the instances will be
+				 * displayed. */
+    XColor *start;		/* Start color for the blend. */
+    XColor *end;		/* End color for the blend. */
+    Pixmap pixmap;		/* Server-side pixmap holding the rendered
+				 * gradient, or None if the instance could
+				 * not be set up. */
+    GC gc;			/* Graphics context for copying the pixmap to
+				 * the screen. NULL means there was an error
+				 * while setting up the instance, so it
+				 * cannot be displayed. */
+    XColor *bandColors[GRADIENT_MAX_BANDS];
+				/* Colors allocated for the banded fallback
+				 * rendering. They must stay allocated as
+				 * long as the pixmap may be copied, since on
+				 * colormapped displays freeing them could
+				 * redefine the pixels already drawn. */
+    int numBandColors;		/* Number of valid entries in bandColors; 0
+				 * when the server rendered the blend
+				 * itself. */
+    struct GradientInstance *nextPtr;
+				/* Next in list of all instance structures
+				 * associated with modelPtr (NULL means end
+				 * of list). */
+} GradientInstance;
+
+/*
+ * The type record for gradient images:
+ */
+
+static int		ImgGradCreate(Tcl_Interp *interp,
+			    const char *name, Tcl_Size objc, Tcl_Obj *const objv[],
+			    const Tk_ImageType *typePtr, Tk_ImageModel model,
+			    void **clientDataPtr);
+static void	*ImgGradGet(Tk_Window tkwin, void *clientData);
+static void		ImgGradDisplay(void *clientData,
+			    Display *display, Drawable drawable,
+			    int imageX, int imageY, int width, int height,
+			    int drawableX, int drawableY);
+static void		ImgGradFree(void *clientData, Display *display);
+static void		ImgGradDelete(void *clientData);
+static int		ImgGradPostscript(void *clientData,
+			    Tcl_Interp *interp, Tk_Window tkwin,
+			    Tk_PostscriptInfo psinfo, int x, int y,
+			    int width, int height, int prepass);
+
+Tk_ImageType tkGradientImageType = {
+    "gradient",			/* name */
+    ImgGradCreate,		/* createProc */
+    ImgGradGet,			/* getProc */
+    ImgGradDisplay,		/* displayProc */
+    ImgGradFree,		/* freeProc */
+    ImgGradDelete,		/* deleteProc */
+    ImgGradPostscript,		/* postscriptProc */
+    NULL,			/* nextPtr */
+    NULL
+};
+
+/*
+ * Information used for parsing configuration specs:
+ */
+
+static const Tk_ConfigSpec configSpecs[] = {
+    {TK_CONFIG_UID, "-end", NULL, NULL,
+	"#ffffff", offsetof(GradientModel, endUid), 0, NULL},
+    {TK_CONFIG_INT, "-height", NULL, NULL,
+	"0", offsetof(GradientModel, height), 0, NULL},
+    {TK_CONFIG_UID, "-orient", NULL, NULL,
+	"vertical", offsetof(GradientModel, orientUid), 0, NULL},
+    {TK_CONFIG_UID, "-start", NULL, NULL,
+	"#000000", offsetof(GradientModel, startUid), 0, NULL},
+    {TK_CONFIG_INT, "-width", NULL, NULL,
+	"0", offsetof(GradientModel, width), 0, NULL},
+    {TK_CONFIG_END, NULL, NULL, NULL, NULL, 0, 0, NULL}
+};
+
+/*
+ * Prototypes for procedures used only locally in this file:
+ */
+
+static int		ImgGradCmd(void *clientData, Tcl_Interp *interp,
+			    int objc, Tcl_Obj *const objv[]);
+static void		ImgGradCmdDeletedProc(void *clientData);
+static void		ImgGradConfigureInstance(GradientInstance *instancePtr);
+static int		ImgGradConfigureModel(GradientModel *modelPtr,
+			    Tcl_Size objc, Tcl_Obj *const objv[], int flags);
+static void		ImgGradBandColor(GradientModel *modelPtr,
+			    XColor *startPtr, XColor *endPtr, int band,
+			    int numBands, XColor *resultPtr);
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgGradCreate --
+ *
+ *	This procedure is called by the Tk image code to create "gradient"
+ *	images.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	The data structure for a new image is allocated.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ImgGradCreate(
+    Tcl_Interp *interp,		/* Interpreter for application containing
+				 * image. */
+    const char *name,			/* Name to use for image. */
+    Tcl_Size objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[],	/* Argument objects for options (doesn't
+				 * include image name or type). */
+    TCL_UNUSED(const Tk_ImageType *),/* Pointer to our type record (not used). */
+    Tk_ImageModel model,	/* Token for image, to be used by us in later
+				 * callbacks. */
+    void **clientDataPtr)	/* Store manager's token for image here; it
+				 * will be returned in later callbacks. */
+{
+    GradientModel *modelPtr = (GradientModel *)ckalloc(sizeof(GradientModel));
+
+    modelPtr->tkModel = model;
+    modelPtr->interp = interp;
+    modelPtr->imageCmd = Tcl_CreateObjCommand(interp, name, ImgGradCmd,
+	    modelPtr, ImgGradCmdDeletedProc);
+    modelPtr->width = modelPtr->height = 0;
+    modelPtr->startUid = NULL;
+    modelPtr->endUid = NULL;
+    modelPtr->orientUid = NULL;
+    modelPtr->vertical = 1;
+    modelPtr->instancePtr = NULL;
+    if (ImgGradConfigureModel(modelPtr, objc, objv, 0) != TCL_OK) {
+	ImgGradDelete(modelPtr);
+	return TCL_ERROR;
+    }
+    *clientDataPtr = modelPtr;
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgGradConfigureModel --
+ *
+ *	This procedure is called when a gradient image is created or
+ *	reconfigured. It processes configuration options and resets any
+ *	instances of the image.
+ *
+ * Results:
+ *	A standard Tcl return value. If TCL_ERROR is returned then an error
+ *	message is left in the modelPtr->interp's result.
+ *
+ * Side effects:
+ *	Existing instances of the image will be redisplayed to match the new
+ *	configuration options.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ImgGradConfigureModel(
+    GradientModel *modelPtr,	/* Pointer to data structure describing
+				 * overall gradient image to (re)configure. */
+    Tcl_Size objc,			/* Number of entries in objv. */
+    Tcl_Obj *const objv[],	/* Pairs of configuration options for image. */
+    int flags)			/* Flags to pass to Tk_ConfigureWidget, such
+				 * as TK_CONFIG_ARGV_ONLY. */
+{
+    GradientInstance *instancePtr;
+
+    if (Tk_ConfigureWidget(modelPtr->interp, Tk_MainWindow(modelPtr->interp),
+	    configSpecs, objc, objv, modelPtr, flags) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    if ((modelPtr->width <= 0) || (modelPtr->height <= 0)) {
+	Tcl_SetObjResult(modelPtr->interp, Tcl_NewStringObj(
+		"-width and -height must be specified and positive",
+		TCL_INDEX_NONE));
+	Tcl_SetErrorCode(modelPtr->interp, "TK", "IMAGE", "GRADIENT",
+		"DIMENSIONS", NULL);
+	return TCL_ERROR;
+    }
+
+    if (strcmp(modelPtr->orientUid, "vertical") == 0) {
+	modelPtr->vertical = 1;
+    } else if (strcmp(modelPtr->orientUid, "horizontal") == 0) {
+	modelPtr->vertical = 0;
+    } else {
+	Tcl_SetObjResult(modelPtr->interp, Tcl_ObjPrintf(
+		"bad orientation \"%s\": must be vertical or horizontal",
+		modelPtr->orientUid));
+	Tcl_SetErrorCode(modelPtr->interp, "TK", "IMAGE", "GRADIENT",
+		"ORIENT", NULL);
+	return TCL_ERROR;
+    }
+
+    /*
+     * Cycle through all of the instances of this image, regenerating the
+     * information for each instance. Then force the image to be redisplayed
+     * everywhere that it is used.
+     */
+
+    for (instancePtr = modelPtr->instancePtr; instancePtr != NULL;
+	    instancePtr = instancePtr->nextPtr) {
+	ImgGradConfigureInstance(instancePtr);
+    }
+    Tk_ImageChanged(modelPtr->tkModel, 0, 0, modelPtr->width,
+	    modelPtr->height, modelPtr->width, modelPtr->height);
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgGradBandColor --
+ *
+ *	Computes the color of one band of the banded approximation of a
+ *	gradient, by linear interpolation between the start and end colors
+ *	at the band's midpoint.
+ *
+ * Results:
+ *	Fills in the red, green and blue fields of *resultPtr.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ImgGradBandColor(
+    TCL_UNUSED(GradientModel *),
+    XColor *startPtr,		/* Color at the start of the blend. */
+    XColor *endPtr,		/* Color at the end of the blend. */
+    int band,			/* Index of the band, counting from the
+				 * start. */
+    int numBands,		/* Total number of bands. */
+    XColor *resultPtr)		/* Interpolated color is stored here. */
+{
+    double frac = (band + 0.5) / numBands;
+
+    resultPtr->red = (unsigned short) (startPtr->red
+	    + frac * ((double) endPtr->red - startPtr->red));
+    resultPtr->green = (unsigned short) (startPtr->green
+	    + frac * ((double) endPtr->green - startPtr->green));
+    resultPtr->blue = (unsigned short) (startPtr->blue
+	    + frac * ((double) endPtr->blue - startPtr->blue));
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgGradConfigureInstance --
+ *
+ *	This procedure is called to create displaying information for a
+ *	gradient image instance based on the configuration information in
+ *	the model. It is invoked both when new instances are created and
+ *	when the model is reconfigured. The blend is rendered here, once,
+ *	into a server-side pixmap; displaying the instance later is just a
+ *	copy.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Generates errors via Tcl_BackgroundException if there are problems in
+ *	setting up the instance.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ImgGradConfigureInstance(
+    GradientInstance *instancePtr)/* Instance to reconfigure. */
+{
+    GradientModel *modelPtr = instancePtr->modelPtr;
+    Display *display = Tk_Display(instancePtr->tkwin);
+    XColor *colorPtr;
+    XGCValues gcValues;
+    GC gc;
+    int i, rendered;
+
+    /*
+     * For each of the options in modelPtr, translate the string form into an
+     * internal form appropriate for instancePtr.
+     */
+
+    colorPtr = Tk_GetColor(modelPtr->interp, instancePtr->tkwin,
+	    modelPtr->startUid);
+    if (colorPtr == NULL) {
+	goto error;
+    }
+    if (instancePtr->start != NULL) {
+	Tk_FreeColor(instancePtr->start);
+    }
+    instancePtr->start = colorPtr;
+
+    colorPtr = Tk_GetColor(modelPtr->interp, instancePtr->tkwin,
+	    modelPtr->endUid);
+    if (colorPtr == NULL) {
+	goto error;
+    }
+    if (instancePtr->end != NULL) {
+	Tk_FreeColor(instancePtr->end);
+    }
+    instancePtr->end = colorPtr;
+
+    /*
+     * Discard any previously rendered pixmap, along with the band colors
+     * that were allocated for it, then render the blend afresh.
+     */
+
+    if (instancePtr->pixmap != None) {
+	Tk_FreePixmap(display, instancePtr->pixmap);
+	instancePtr->pixmap = None;
+    }
+    for (i = 0; i < instancePtr->numBandColors; i++) {
+	Tk_FreeColor(instancePtr->bandColors[i]);
+    }
+    instancePtr->numBandColors = 0;
+
+    instancePtr->pixmap = Tk_GetPixmap(display,
+	    RootWindowOfScreen(Tk_Screen(instancePtr->tkwin)),
+	    modelPtr->width, modelPtr->height,
+	    Tk_Depth(instancePtr->tkwin));
+
+    rendered = 0;
+#ifdef TK_RENDER_GRADIENTS
+    rendered = TkpRenderGradient(display, Tk_Visual(instancePtr->tkwin),
+	    instancePtr->pixmap, (unsigned) modelPtr->width,
+	    (unsigned) modelPtr->height, instancePtr->start,
+	    instancePtr->end, modelPtr->vertical);
+#endif
+    if (!rendered) {
+	/*
+	 * The server cannot render the blend itself: approximate it with
+	 * solid bands, one fill request per band. The band colors must stay
+	 * allocated for the lifetime of the pixmap.
+	 */
+
+	int len = modelPtr->vertical ? modelPtr->height : modelPtr->width;
+	int numBands = (len < GRADIENT_MAX_BANDS) ? len : GRADIENT_MAX_BANDS;
+	GC fillGC = XCreateGC(display, instancePtr->pixmap, 0, NULL);
+
+	for (i = 0; i < numBands; i++) {
+	    XColor band;
+	    int p1 = i * len / numBands;
+	    int p2 = (i + 1) * len / numBands;
+
+	    ImgGradBandColor(modelPtr, instancePtr->start, instancePtr->end,
+		    i, numBands, &band);
+	    colorPtr = Tk_GetColorByValue(instancePtr->tkwin, &band);
+	    instancePtr->bandColors[instancePtr->numBandColors++] = colorPtr;
+	    XSetForeground(display, fillGC, colorPtr->pixel);
+	    if (modelPtr->vertical) {
+		XFillRectangle(display, instancePtr->pixmap, fillGC,
+			0, p1, (unsigned) modelPtr->width,
+			(unsigned) (p2 - p1));
+	    } else {
+		XFillRectangle(display, instancePtr->pixmap, fillGC,
+			p1, 0, (unsigned) (p2 - p1),
+			(unsigned) modelPtr->height);
+	    }
+	}
+	XFreeGC(display, fillGC);
+    }
+
+    gcValues.graphics_exposures = False;
+    gc = Tk_GetGC(instancePtr->tkwin, GCGraphicsExposures, &gcValues);
+    if (instancePtr->gc != NULL) {
+	Tk_FreeGC(display, instancePtr->gc);
+    }
+    instancePtr->gc = gc;
+    return;
+
+  error:
+    /*
+     * An error occurred: clear the graphics context in the instance to make
+     * it clear that this instance cannot be displayed. Then report the error.
+     */
+
+    if (instancePtr->gc != NULL) {
+	Tk_FreeGC(display, instancePtr->gc);
+    }
+    instancePtr->gc = NULL;
+    Tcl_AppendObjToErrorInfo(modelPtr->interp, Tcl_ObjPrintf(
+	    "\n    (while configuring image \"%s\")", Tk_NameOfImage(
+	    modelPtr->tkModel)));
+    Tcl_BackgroundException(modelPtr->interp, TCL_ERROR);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * ImgGradCmd --
+ *
+ *	This procedure is invoked to process the Tcl command that corresponds
+ *	to an image managed by this module. See the user documentation for
+ *	details on what it does.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	See the user documentation.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+ImgGradCmd(
+    void *clientData,	/* Information about the image model. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    static const char *const gradOptions[] = {"cget", "configure", NULL};
+    GradientModel *modelPtr = (GradientModel *)clientData;
+    int index;
+
+    if (objc < 2) {
+	Tcl_WrongNumArgs(interp, 1, objv, "option ?arg ...?");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObjStruct(interp, objv[1], gradOptions,
+	    sizeof(char *), "option", 0, &index) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    switch (index) {
+    case 0: /* cget */
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "option");
+	    return TCL_ERROR;
+	}
+	return Tk_ConfigureValue(interp, Tk_MainWindow(interp), configSpecs,
+		modelPtr, Tcl_GetString(objv[2]), 0);
+    case 1: /* configure */
+	if (objc == 2) {
+	    return Tk_ConfigureInfo(interp, Tk_MainWindow(interp),
+		    configSpecs, modelPtr, NULL, 0);
+	} else if (objc == 3) {
+	    return Tk_ConfigureInfo(interp, Tk_MainWindow(interp),
+		    configSpecs, modelPtr,
+		    Tcl_GetString(objv[2]), 0);
+	} else {
+	    return ImgGradConfigureModel(modelPtr, objc-2, objv+2,
+		    TK_CONFIG_ARGV_ONLY);
+	}
+    default:
+	Tcl_Panic("bad const entries to gradOptions in ImgGradCmd");
+	return TCL_OK;
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgGradGet --
+ *
+ *	This procedure is called for each use of a gradient image in a
+ *	widget.
+ *
+ * Results:
+ *	The return value is a token for the instance, which is passed back to
+ *	us in calls to ImgGradDisplay and ImgGradFree.
+ *
+ * Side effects:
+ *	A data structure is set up for the instance (or, an existing instance
+ *	is re-used for the new one).
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void *
+ImgGradGet(
+    Tk_Window tkwin,		/* Window in which the instance will be
+				 * used. */
+    void *modelData)	/* Pointer to our model structure for the
+				 * image. */
+{
+    GradientModel *modelPtr = (GradientModel *)modelData;
+    GradientInstance *instancePtr;
+
+    /*
+     * See if there is already an instance for this window. If so then just
+     * re-use it.
+     */
+
+    for (instancePtr = modelPtr->instancePtr; instancePtr != NULL;
+	    instancePtr = instancePtr->nextPtr) {
+	if (instancePtr->tkwin == tkwin) {
+	    instancePtr->refCount++;
+	    return instancePtr;
+	}
+    }
+
+    /*
+     * The image isn't already in use in this window. Make a new instance of
+     * the image.
+     */
+
+    instancePtr = (GradientInstance *)ckalloc(sizeof(GradientInstance));
+    instancePtr->refCount = 1;
+    instancePtr->modelPtr = modelPtr;
+    instancePtr->tkwin = tkwin;
+    instancePtr->start = NULL;
+    instancePtr->end = NULL;
+    instancePtr->pixmap = None;
+    instancePtr->gc = NULL;
+    instancePtr->numBandColors = 0;
+    instancePtr->nextPtr = modelPtr->instancePtr;
+    modelPtr->instancePtr = instancePtr;
+    ImgGradConfigureInstance(instancePtr);
+
+    /*
+     * If this is the first instance, must set the size of the image.
+     */
+
+    if (instancePtr->nextPtr == NULL) {
+	Tk_ImageChanged(modelPtr->tkModel, 0, 0, 0, 0, modelPtr->width,
+		modelPtr->height);
+    }
+
+    return instancePtr;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgGradDisplay --
+ *
+ *	This procedure is invoked to draw a gradient image.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	A portion of the image gets rendered in a pixmap or window.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ImgGradDisplay(
+    void *clientData,	/* Pointer to GradientInstance structure for
+				 * instance to be displayed. */
+    Display *display,		/* Display on which to draw image. */
+    Drawable drawable,		/* Pixmap or window in which to draw image. */
+    int imageX, int imageY,	/* Upper-left corner of region within image to
+				 * draw. */
+    int width, int height,	/* Dimensions of region within image to draw. */
+    int drawableX, int drawableY)
+				/* Coordinates within drawable that correspond
+				 * to imageX and imageY. */
+{
+    GradientInstance *instancePtr = (GradientInstance *)clientData;
+
+    /*
+     * If there's no graphics context, it means that an error occurred while
+     * creating the image instance so it can't be displayed.
+     */
+
+    if (instancePtr->gc == NULL) {
+	return;
+    }
+    XCopyArea(display, instancePtr->pixmap, drawable, instancePtr->gc,
+	    imageX, imageY, (unsigned) width, (unsigned) height,
+	    drawableX, drawableY);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgGradFree --
+ *
+ *	This procedure is called when a widget ceases to use a particular
+ *	instance of an image.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Internal data structures get cleaned up.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ImgGradFree(
+    void *clientData,	/* Pointer to GradientInstance structure for
+				 * instance to be displayed. */
+    Display *display)		/* Display containing window that used image. */
+{
+    GradientInstance *instancePtr = (GradientInstance *)clientData;
+    GradientInstance *prevPtr;
+    int i;
+
+    if (instancePtr->refCount-- > 1) {
+	return;
+    }
+
+    /*
+     * There are no more uses of the image within this widget. Free the
+     * instance structure.
+     */
+
+    if (instancePtr->start != NULL) {
+	Tk_FreeColor(instancePtr->start);
+    }
+    if (instancePtr->end != NULL) {
+	Tk_FreeColor(instancePtr->end);
+    }
+    for (i = 0; i < instancePtr->numBandColors; i++) {
+	Tk_FreeColor(instancePtr->bandColors[i]);
+    }
+    if (instancePtr->pixmap != None) {
+	Tk_FreePixmap(display, instancePtr->pixmap);
+    }
+    if (instancePtr->gc != NULL) {
+	Tk_FreeGC(display, instancePtr->gc);
+    }
+    if (instancePtr->modelPtr->instancePtr == instancePtr) {
+	instancePtr->modelPtr->instancePtr = instancePtr->nextPtr;
+    } else {
+	for (prevPtr = instancePtr->modelPtr->instancePtr;
+		prevPtr->nextPtr != instancePtr; prevPtr = prevPtr->nextPtr) {
+	    /* Empty loop body */
+	}
+	prevPtr->nextPtr = instancePtr->nextPtr;
+    }
+    ckfree(instancePtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgGradDelete --
+ *
+ *	This procedure is called by the image code to delete the model
+ *	structure for an image.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Resources associated with the image get freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ImgGradDelete(
+    void *modelData)	/* Pointer to GradientModel structure for
+				 * image. Must not have any more instances. */
+{
+    GradientModel *modelPtr = (GradientModel *)modelData;
+
+    if (modelPtr->instancePtr != NULL) {
+	Tcl_Panic("tried to delete gradient image when instances still exist");
+    }
+    modelPtr->tkModel = NULL;
+    if (modelPtr->imageCmd != NULL) {
+	Tcl_DeleteCommandFromToken(modelPtr->interp, modelPtr->imageCmd);
+    }
+    Tk_FreeOptions(configSpecs, modelPtr, NULL, 0);
+    ckfree(modelPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgGradCmdDeletedProc --
+ *
+ *	This procedure is invoked when the image command for an image is
+ *	deleted. It deletes the image.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The image is deleted.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ImgGradCmdDeletedProc(
+    void *clientData)	/* Pointer to GradientModel structure for
+				 * image. */
+{
+    GradientModel *modelPtr = (GradientModel *)clientData;
+
+    modelPtr->imageCmd = NULL;
+    if (modelPtr->tkModel != NULL) {
+	Tk_DeleteImage(modelPtr->interp, Tk_NameOfImage(modelPtr->tkModel));
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgGradPostscript --
+ *
+ *	This procedure generates postscript for a gradient image, as a
+ *	sequence of solid bands interpolated between the start and end
+ *	colors.
+ *
+ * Results:
+ *	A standard Tcl result. If an error occurs then an error message is
+ *	left in the interp's result.
+ *
+ * Side effects:
+ *	Postscript code is appended to the interp's result.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ImgGradPostscript(
+    void *clientData,	/* Pointer to GradientModel structure for
+				 * image. */
+    Tcl_Interp *interp,		/* Interpreter to return generated postscript
+				 * in. */
+    Tk_Window tkwin,		/* Window for the image (used to parse the
+				 * model's colors). */
+    Tk_PostscriptInfo psinfo,	/* Postscript configuration information. */
+    int x, int y,		/* First pixel to output. */
+    int width, int height,	/* Width and height of area. */
+    int prepass)		/* 1 means this is a prepass to collect font
+				 * information; 0 means final postscript is
+				 * being created. */
+{
+    GradientModel *modelPtr = (GradientModel *)clientData;
+    XColor start, end, band;
+    Tcl_Obj *psObj;
+    Tcl_InterpState interpState;
+    int i, len, numBands;
+
+    if (prepass) {
+	return TCL_OK;
+    }
+    if (width <= 0 || height <= 0
+	    || modelPtr->width <= 0 || modelPtr->height <= 0) {
+	return TCL_OK;
+    }
+
+    TkParseColor(Tk_Display(tkwin), Tk_Colormap(tkwin), modelPtr->startUid,
+	    &start);
+    TkParseColor(Tk_Display(tkwin), Tk_Colormap(tkwin), modelPtr->endUid,
+	    &end);
+
+    /*
+     * Translate the origin of the coordinate system to be the lower-left
+     * corner of the image and adjust the scale of the coordinate system so
+     * that the entire image covers one square unit of the page. The calling
+     * function put a "gsave" into the postscript and will add a "grestore"
+     * after this routine returns, so it is safe to make whatever changes are
+     * necessary here.
+     */
+
+    psObj = Tcl_NewObj();
+    interpState = Tcl_SaveInterpState(interp, TCL_OK);
+
+    if (x != 0 || y != 0) {
+	Tcl_AppendPrintfToObj(psObj, "%d %d moveto\n", x, y);
+    }
+    if (width != 1 || height != 1) {
+	Tcl_AppendPrintfToObj(psObj, "%d %d scale\n", width, height);
+    }
+
+    len = modelPtr->vertical ? modelPtr->height : modelPtr->width;
+    numBands = (len < GRADIENT_MAX_BANDS) ? len : GRADIENT_MAX_BANDS;
+    for (i = 0; i < numBands; i++) {
+	double p1 = (double) i / numBands;
+	double p2 = (double) (i + 1) / numBands;
+
+	ImgGradBandColor(modelPtr, &start, &end, i, numBands, &band);
+	Tcl_ResetResult(interp);
+	if (Tk_PostscriptColor(interp, psinfo, &band) != TCL_OK) {
+	    Tcl_DiscardInterpState(interpState);
+	    Tcl_DecrRefCount(psObj);
+	    return TCL_ERROR;
+	}
+	Tcl_AppendObjToObj(psObj, Tcl_GetObjResult(interp));
+	if (modelPtr->vertical) {
+	    /*
+	     * Postscript's y axis points up, so band 0 (the top of the
+	     * image) occupies the highest strip of the unit square.
+	     */
+
+	    Tcl_AppendPrintfToObj(psObj,
+		    "0 %.6g moveto 1 0 rlineto 0 %.6g rlineto "
+		    "-1 0 rlineto closepath fill\n", 1.0 - p2, p2 - p1);
+	} else {
+	    Tcl_AppendPrintfToObj(psObj,
+		    "%.6g 0 moveto %.6g 0 rlineto 0 1 rlineto "
+		    "%.6g 0 rlineto closepath fill\n", p1, p2 - p1,
+		    -(p2 - p1));
+	}
+    }
+
+    (void) Tcl_RestoreInterpState(interp, interpState);
+    Tcl_AppendObjToObj(Tcl_GetObjResult(interp), psObj);
+    Tcl_DecrRefCount(psObj);
+    return TCL_OK;
+}
+
+/*
+ * Local Variables:
+ * mode: c
+ * c-basic-offset: 4
+ * fill-column: 78
+ * End:
+ */
@@ -149,6 +149,18 @@ static int      ParseColorAsStandard(Tcl_Interp *interp,
                     Display *display, Colormap colormap,
                     unsigned char *redPtr, unsigned char *greenPtr,
                     unsigned char *bluePtr, unsigned char *alphaPtr);
+static int      ParseColorFast(const char *colorString, Tcl_Size colorStrLen,
+                    unsigned char *pixelPtr);
+static int      RawHeaderParse(const unsigned char *bytes, Tcl_Size length,
+                    int *widthPtr, int *heightPtr);
+static int      StringMatchRaw(Tcl_Obj *data, Tcl_Obj *formatString,
+                    int *widthPtr, int *heightPtr, Tcl_Interp *interp);
+static int      StringReadRaw(Tcl_Interp *interp, Tcl_Obj *data,
+                    Tcl_Obj *formatString, Tk_PhotoHandle imageHandle,
+                    int destX, int destY, int width, int height,
+                    int srcX, int srcY);
+static int      StringWriteRaw(Tcl_Interp *interp, Tcl_Obj *formatString,
+                    Tk_PhotoImageBlock *blockPtr);
 
 /*
  * The format record for the default image handler
@@ -164,6 +176,31 @@ Tk_PhotoImageFormat tkImgFmtDefault = {
     StringWriteDef, /* stringWriteProc */
     NULL            /* nextPtr */
 };
+
+/*
+ * The format record for the raw image handler
+ */
+
+Tk_PhotoImageFormat tkImgFmtRaw = {
+    "raw",          /* name */
+    NULL,           /* fileMatchProc: format doesn't support file ops */
+    StringMatchRaw, /* stringMatchProc */
+    NULL,           /* fileReadProc: format doesn't support file read */
+    StringReadRaw,  /* stringReadProc */
+    NULL,           /* fileWriteProc: format doesn't support file write */
+    StringWriteRaw, /* stringWriteProc */
+    NULL            /* nextPtr */
+};
+
+/*
+ * Layout of a raw format image string: the magic tag below, then the image
+ * width and height as little-endian 32-bit unsigned integers, then
+ * width*height packed 4-byte RGBA pixels in left-to-right, top-to-bottom
+ * order.
+ */
+
+#define RAW_MAGIC       "TkRw"
+#define RAW_HEADER_SIZE 12
 
 /*
  *----------------------------------------------------------------------
@@ -574,7 +611,18 @@ StringReadDef(
             goto errorExit;
         }
         for (x = srcX; x < colCount; x++) {
-            if (ParseColor(interp, colListPtr[x], display, colormap,
+            Tcl_Size colorStrLen;
+            const char *colorStr = Tcl_GetStringFromObj(colListPtr[x],
+                    &colorStrLen);
+
+            /*
+             * Decode the overwhelmingly common #RRGGBB and #RRGGBBAA pixel
+             * forms inline; everything else takes the generic (and, for
+             * plain #RRGGBB values, much slower) ParseColor() route.
+             */
+
+            if (!ParseColorFast(colorStr, colorStrLen, curPixelPtr)
+                    && ParseColor(interp, colListPtr[x], display, colormap,
                     curPixelPtr, curPixelPtr + 1, curPixelPtr + 2,
                     curPixelPtr + 3) != TCL_OK) {
                 goto errorExit;
@@ -744,6 +792,63 @@ StringWriteDef(
     return TCL_OK;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * ParseColorFast --
+ *
+ *      Decode a pixel in the #RRGGBB or #RRGGBBAA form, which makes up
+ *      virtually all data fed through "<img> put" in bulk. Everything the
+ *      generic ParseColor() accepts beyond these two forms (short hex
+ *      forms, color names, lists, alpha suffixes) is rejected here and
+ *      left to the generic code.
+ *
+ * Results:
+ *      If the string is a plain 6 or 8 digit hex color, writes the four
+ *      RGBA bytes to pixelPtr and returns 1. Returns 0 otherwise, leaving
+ *      pixelPtr untouched.
+ *
+ * Side effects:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+static int
+ParseColorFast(
+    const char *colorString,    /* the color data to parse */
+    Tcl_Size colorStrLen,       /* length of the color string */
+    unsigned char *pixelPtr)    /* write the RGBA bytes here */
+{
+    unsigned int value = 0;
+    int i;
+
+    if ((colorStrLen != 7 && colorStrLen != 9) || colorString[0] != '#') {
+        return 0;
+    }
+    for (i = 1; i < colorStrLen; i++) {
+        int c = UCHAR(colorString[i]);
+
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value += c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            value += c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            value += c - 'A' + 10;
+        } else {
+            return 0;
+        }
+    }
+    if (colorStrLen == 7) {
+        value = (value << 8) | 0xff;
+    }
+    pixelPtr[0] = (unsigned char) (value >> 24);
+    pixelPtr[1] = (unsigned char) ((value >> 16) & 0xff);
+    pixelPtr[2] = (unsigned char) ((value >> 8) & 0xff);
+    pixelPtr[3] = (unsigned char) (value & 0xff);
+    return 1;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -1101,6 +1206,207 @@ ParseColorAsStandard(
     return TCL_OK;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * RawHeaderParse --
+ *
+ *      Validate the header of a raw format image string and extract the
+ *      image dimensions from it.
+ *
+ * Results:
+ *      If bytes holds a well-formed raw image (magic tag, dimensions and
+ *      exactly matching data length), writes the dimensions to widthPtr
+ *      and heightPtr and returns 1; returns 0 otherwise.
+ *
+ * Side effects:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+static int
+RawHeaderParse(
+    const unsigned char *bytes, /* the data to check, may be NULL */
+    Tcl_Size length,            /* number of bytes in the data */
+    int *widthPtr,              /* Width of image is written to this location */
+    int *heightPtr)             /* Height of image is written to this location */
+{
+    unsigned int width, height;
+
+    if (bytes == NULL || length < RAW_HEADER_SIZE
+            || memcmp(bytes, RAW_MAGIC, 4) != 0) {
+        return 0;
+    }
+    width = (unsigned int) bytes[4] | ((unsigned int) bytes[5] << 8)
+            | ((unsigned int) bytes[6] << 16) | ((unsigned int) bytes[7] << 24);
+    height = (unsigned int) bytes[8] | ((unsigned int) bytes[9] << 8)
+            | ((unsigned int) bytes[10] << 16)
+            | ((unsigned int) bytes[11] << 24);
+    if (width > INT_MAX || height > INT_MAX
+            || (Tcl_WideInt) length - RAW_HEADER_SIZE
+            != (Tcl_WideInt) width * height * 4) {
+        return 0;
+    }
+    *widthPtr = (int) width;
+    *heightPtr = (int) height;
+    return 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * StringMatchRaw --
+ *
+ *      String match function for the raw format. (see manpage for details
+ *      on the format).
+ *
+ * Results:
+ *      If the data is in the raw format, writes the size of the image to
+ *      widthPtr and heightPtr and returns 1. Returns 0 otherwise.
+ *
+ * Side effects:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+static int
+StringMatchRaw(
+    Tcl_Obj *data,          /* The data to check */
+    TCL_UNUSED(Tcl_Obj *),  /* Value of the -format option, not used here */
+    int *widthPtr,          /* Width of image is written to this location */
+    int *heightPtr,         /* Height of image is written to this location */
+    TCL_UNUSED(Tcl_Interp *))	/* Error messages are left in this interpreter */
+{
+    unsigned char *bytes;
+    Tcl_Size length;
+
+    bytes = Tcl_GetByteArrayFromObj(data, &length);
+    return RawHeaderParse(bytes, length, widthPtr, heightPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * StringReadRaw --
+ *
+ *      String read function for the raw format. The pixel data is handed
+ *      to Tk_PhotoPutBlock straight out of the byte array, without any
+ *      per-pixel parsing or staging buffer.
+ *
+ * Results:
+ *      A standard Tcl result.
+ *
+ * Side effects:
+ *      If the data has valid format, write it to the image identified by
+ *      imageHandle. Otherwise an error message is left in interp.
+ *
+ *----------------------------------------------------------------------
+ */
+static int
+StringReadRaw(
+    Tcl_Interp *interp,         /* leave error messages here */
+    Tcl_Obj *data,              /* the data to parse */
+    TCL_UNUSED(Tcl_Obj *),      /* value of the -format option, not used */
+    Tk_PhotoHandle imageHandle, /* write data to this image */
+    int destX, int destY,       /* start writing data at this point
+                                 * in destination image*/
+    int width, int height,      /* dimensions of area to write to */
+    int srcX, int srcY)         /* start reading source data at these
+                                 * coordinates */
+{
+    unsigned char *bytes;
+    Tcl_Size length;
+    int imgWidth, imgHeight;
+    Tk_PhotoImageBlock srcBlock;
+
+    bytes = Tcl_GetByteArrayFromObj(data, &length);
+    if (!RawHeaderParse(bytes, length, &imgWidth, &imgHeight)) {
+        Tcl_SetObjResult(interp, Tcl_ObjPrintf("invalid raw image data"));
+        Tcl_SetErrorCode(interp, "TK", "IMAGE", "PHOTO", "INVALID_DATA",
+                NULL);
+        return TCL_ERROR;
+    }
+    if (srcX + width > imgWidth) {
+        width = imgWidth - srcX;
+    }
+    if (srcY + height > imgHeight) {
+        height = imgHeight - srcY;
+    }
+    if (width <= 0 || height <= 0 || srcX < 0 || srcY < 0
+            || srcX >= imgWidth || srcY >= imgHeight) {
+        return TCL_OK;
+    }
+
+    srcBlock.width = width;
+    srcBlock.height = height;
+    srcBlock.pixelSize = 4;
+    srcBlock.pitch = imgWidth * 4;
+    srcBlock.offset[0] = 0;
+    srcBlock.offset[1] = 1;
+    srcBlock.offset[2] = 2;
+    srcBlock.offset[3] = 3;
+    srcBlock.pixelPtr = bytes + RAW_HEADER_SIZE
+            + ((size_t) srcY * imgWidth + srcX) * 4;
+    return Tk_PhotoPutBlock(interp, imageHandle, &srcBlock, destX, destY,
+            width, height, TK_PHOTO_COMPOSITE_SET);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * StringWriteRaw --
+ *
+ *      String write function for the raw image data format. See the user
+ *      documentation for details.
+ *
+ * Results:
+ *      The converted data is set as the result of interp. Returns a
+ *      standard Tcl result.
+ *
+ * Side effects:
+ *      None.
+ *
+ *----------------------------------------------------------------------
+ */
+static int
+StringWriteRaw(
+    Tcl_Interp *interp,         /* For the result and errors */
+    TCL_UNUSED(Tcl_Obj *),      /* value of the -format option, not used */
+    Tk_PhotoImageBlock *blockPtr)
+                                /* The image data to convert */
+{
+    Tcl_Obj *resultObj;
+    unsigned char *dataPtr;
+    unsigned char *pixelPtr;
+    int x, y;
+
+    resultObj = Tcl_NewByteArrayObj(NULL, 0);
+    dataPtr = Tcl_SetByteArrayLength(resultObj, RAW_HEADER_SIZE
+            + (Tcl_Size) blockPtr->width * blockPtr->height * 4);
+    memcpy(dataPtr, RAW_MAGIC, 4);
+    dataPtr[4] = (unsigned char) (blockPtr->width & 0xff);
+    dataPtr[5] = (unsigned char) ((blockPtr->width >> 8) & 0xff);
+    dataPtr[6] = (unsigned char) ((blockPtr->width >> 16) & 0xff);
+    dataPtr[7] = (unsigned char) ((blockPtr->width >> 24) & 0xff);
+    dataPtr[8] = (unsigned char) (blockPtr->height & 0xff);
+    dataPtr[9] = (unsigned char) ((blockPtr->height >> 8) & 0xff);
+    dataPtr[10] = (unsigned char) ((blockPtr->height >> 16) & 0xff);
+    dataPtr[11] = (unsigned char) ((blockPtr->height >> 24) & 0xff);
+    dataPtr += RAW_HEADER_SIZE;
+    for (y = 0; y < blockPtr->height; y++) {
+        pixelPtr = blockPtr->pixelPtr + y * blockPtr->pitch;
+        for (x = 0; x < blockPtr->width; x++) {
+            *dataPtr++ = pixelPtr[blockPtr->offset[0]];
+            *dataPtr++ = pixelPtr[blockPtr->offset[1]];
+            *dataPtr++ = pixelPtr[blockPtr->offset[2]];
+            *dataPtr++ = pixelPtr[blockPtr->offset[3]];
+            pixelPtr += blockPtr->pixelSize;
+        }
+    }
+    Tcl_SetObjResult(interp, resultObj);
+    return TCL_OK;
+}
+
 /*
  *----------------------------------------------------------------------
  *
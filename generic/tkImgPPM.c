@@ -18,6 +18,9 @@
 
 #ifdef _WIN32
 #include "tkWinInt.h"
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 
 /*
@@ -204,6 +207,52 @@ FileReadPPM(
 	return TCL_ERROR;
     }
 
+#ifndef _WIN32
+    /*
+     * Fast path for 8-bit rasters read from a plain seekable file: map the
+     * raster pages and hand them to Tk_PhotoPutBlock directly, so the
+     * pixels make a single trip from the page cache into the photo image
+     * instead of passing through the channel buffer and a staging buffer
+     * first. The photo image always stores its own 32-bit RGBA block, so
+     * the final conversion copy cannot be avoided by adopting the pages
+     * outright. Rasters that need intensity rescaling (maxIntensity other
+     * than 255) are modified in place by the loop below and take the
+     * buffered path.
+     */
+
+    if (maxIntensity == 0x00ff) {
+	void *handle;
+	long long pos = Tcl_Tell(chan);
+
+	if ((pos >= 0) && (Tcl_GetChannelHandle(chan, TCL_READABLE,
+		&handle) == TCL_OK)) {
+	    int fd = (int) PTR2INT(handle);
+	    struct stat statBuf;
+	    long long rasterStart = pos + (long long) srcY * block.pitch;
+	    long long rasterEnd = rasterStart + (long long) height * block.pitch;
+
+	    if ((fstat(fd, &statBuf) == 0)
+		    && ((long long) statBuf.st_size >= rasterEnd)) {
+		void *mapPtr = mmap(NULL, (size_t) rasterEnd, PROT_READ,
+			MAP_SHARED, fd, 0);
+
+		if (mapPtr != MAP_FAILED) {
+		    int code;
+
+		    block.pixelPtr = (unsigned char *) mapPtr + rasterStart
+			    + srcX * block.pixelSize;
+		    block.height = height;
+		    code = Tk_PhotoPutBlock(interp, imageHandle, &block,
+			    destX, destY, width, height,
+			    TK_PHOTO_COMPOSITE_SET);
+		    munmap(mapPtr, (size_t) rasterEnd);
+		    return code;
+		}
+	    }
+	}
+    }
+#endif /* !_WIN32 */
+
     if (srcY > 0) {
 	Tcl_Seek(chan, (long long)srcY * block.pitch, SEEK_CUR);
     }
@@ -171,6 +171,10 @@ static const Tk_ConfigSpec configSpecs[] = {
 	 DEF_PHOTO_GAMMA, offsetof(PhotoModel, gamma), 0, NULL},
     {TK_CONFIG_INT, "-height", NULL, NULL,
 	 DEF_PHOTO_HEIGHT, offsetof(PhotoModel, userHeight), 0, NULL},
+    {TK_CONFIG_BOOLEAN, "-loadasync", NULL, NULL,
+	 "0", offsetof(PhotoModel, loadAsync), 0, NULL},
+    {TK_CONFIG_STRING, "-loadcommand", NULL, NULL,
+	 NULL, offsetof(PhotoModel, loadCommand), TK_CONFIG_NULL_OK, NULL},
     {TK_CONFIG_STRING, "-metadata", NULL, NULL,
 	 NULL, TCL_INDEX_NONE, TK_CONFIG_NULL_OK, NULL},
     {TK_CONFIG_UID, "-palette", NULL, NULL,
@@ -195,6 +199,12 @@ static void		ImgPhotoCmdDeletedProc(void *clientData);
 static int		ImgPhotoConfigureModel(Tcl_Interp *interp,
 			    PhotoModel *modelPtr, Tcl_Size objc,
 			    Tcl_Obj *const objv[], int flags);
+static int		ImgPhotoReadFile(Tcl_Interp *interp,
+			    PhotoModel *modelPtr,
+			    Tcl_Obj **metadataOutObjPtr);
+static int		ImgPhotoMergeMetadata(Tcl_Interp *interp,
+			    PhotoModel *modelPtr, Tcl_Obj *metadataOutObj);
+static void		ImgPhotoLoadIdle(void *clientData);
 static int		ToggleComplexAlphaIfNeeded(PhotoModel *mPtr);
 static int		ImgPhotoSetSize(PhotoModel *modelPtr, int width,
 			    int height);
@@ -1059,6 +1069,15 @@ ImgPhotoCmd(
 	    return TCL_ERROR;
 	}
 
+	/*
+	 * Use a large channel buffer: several format parsers (GIF, the
+	 * PPM header scanner) read the file a few bytes at a time, and
+	 * the default 4K buffer makes the buffer refills the dominant
+	 * cost when reading big images.
+	 */
+
+	Tcl_SetChannelOption(NULL, chan, "-buffersize", "65536");
+
 	if (MatchFileFormat(interp, chan,
 		Tcl_GetString(options.name), options.format,
 		options.metadata, NULL, &imageFormat,
@@ -1899,9 +1918,8 @@ ImgPhotoConfigureModel(
 	    *metadataInObj = NULL, *metadataOutObj = NULL;
     Tcl_Obj *tempdata, *tempformat;
     Tcl_Size i, length;
-    int result, imageWidth, imageHeight, oldformat;
+    int imageWidth, imageHeight, oldformat;
     double oldGamma;
-    Tcl_Channel chan;
     Tk_PhotoImageFormat *imageFormat;
     Tk_PhotoImageFormatVersion3 *imageFormatVersion3;
 
@@ -2080,63 +2098,20 @@ ImgPhotoConfigureModel(
 	    goto errorExit;
 	}
 
-	chan = Tcl_OpenFileChannel(interp, modelPtr->fileString, "r", 0);
-	if (chan == NULL) {
-	    goto errorExit;
-	}
-
-	/*
-	 * Flag that we want the metadata result dict
-	 */
-
-	metadataOutObj = Tcl_NewDictObj();
-	Tcl_IncrRefCount(metadataOutObj);
-
-	/*
-	 * -translation binary also sets -encoding binary
-	 */
-
-	if ((Tcl_SetChannelOption(interp, chan,
-		"-translation", "binary") != TCL_OK) ||
-		(MatchFileFormat(interp, chan, modelPtr->fileString,
-			modelPtr->format, modelPtr->metadata, metadataOutObj,
-			&imageFormat, &imageFormatVersion3,
-			&imageWidth, &imageHeight, &oldformat) != TCL_OK)) {
-	    Tcl_Close(NULL, chan);
-	    goto errorExit;
-	}
-	result = ImgPhotoSetSize(modelPtr, imageWidth, imageHeight);
-	if (result != TCL_OK) {
-	    Tcl_Close(NULL, chan);
-	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
-		    TK_PHOTO_ALLOC_FAILURE_MESSAGE, TCL_INDEX_NONE));
-	    Tcl_SetErrorCode(interp, "TK", "MALLOC", NULL);
-	    goto errorExit;
-	}
-	tempformat = modelPtr->format;
-	if (oldformat && tempformat) {
-	    tempformat = (Tcl_Obj *) Tcl_GetString(tempformat);
-	}
-	if (imageFormat != NULL) {
-	    result = imageFormat->fileReadProc(interp, chan,
-		    modelPtr->fileString, tempformat,
-		    (Tk_PhotoHandle) modelPtr,
-		    0, 0, imageWidth, imageHeight, 0, 0);
-	} else {
-	    result = imageFormatVersion3->fileReadProc(interp, chan,
-		    modelPtr->fileString, tempformat, modelPtr->metadata,
-		    (Tk_PhotoHandle) modelPtr,
-		    0, 0, imageWidth, imageHeight, 0, 0,
-		    metadataOutObj);
-	}
+	if (modelPtr->loadAsync) {
+	    /*
+	     * Read the file from an idle callback instead of blocking
+	     * here for the whole decode; see ImgPhotoLoadIdle().
+	     */
 
-	Tcl_Close(NULL, chan);
-	if (result != TCL_OK) {
+	    if (!modelPtr->loadPending) {
+		modelPtr->loadPending = 1;
+		Tcl_DoWhenIdle(ImgPhotoLoadIdle, modelPtr);
+	    }
+	} else if (ImgPhotoReadFile(interp, modelPtr, &metadataOutObj)
+		!= TCL_OK) {
 	    goto errorExit;
 	}
-
-	Tcl_ResetResult(interp);
-	modelPtr->flags |= IMAGE_CHANGED;
     }
 
     if ((modelPtr->fileString == NULL) && (modelPtr->dataString != NULL)
@@ -2191,44 +2166,8 @@ ImgPhotoConfigureModel(
     /*
      * Merge driver returned metadata and master metadata
      */
-    if (metadataOutObj != NULL) {
-	Tcl_Size dictSize;
-	if (TCL_OK != Tcl_DictObjSize(interp,metadataOutObj, &dictSize)) {
-	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
-		    "driver metadata not a dict", TCL_INDEX_NONE));
-	    Tcl_SetErrorCode(interp, "TK", "IMAGE", "PHOTO",
-		    "UNRECOGNIZED_DATA", NULL);
-	    goto errorExit;
-	}
-	if (dictSize > 0) {
-
-	    /*
-	     * We have driver return metadata
-	     */
-
-	    if (modelPtr->metadata == NULL) {
-		modelPtr->metadata = metadataOutObj;
-		metadataOutObj = NULL;
-	    } else {
-		Tcl_DictSearch search;
-		Tcl_Obj *key, *value;
-		int done;
-
-		if (Tcl_IsShared(modelPtr->metadata)) {
-		    Tcl_DecrRefCount(modelPtr->metadata);
-		    modelPtr->metadata = Tcl_DuplicateObj(modelPtr->metadata);
-		    Tcl_IncrRefCount(modelPtr->metadata);
-		}
-
-		if (Tcl_DictObjFirst(interp, metadataOutObj, &search, &key,
-			&value, &done) != TCL_OK) {
-		    goto errorExit;
-		}
-		for (; !done ; Tcl_DictObjNext(&search, &key, &value, &done)) {
-		    Tcl_DictObjPut(interp, modelPtr->metadata, key, value);
-		}
-	    }
-	}
+    if (ImgPhotoMergeMetadata(interp, modelPtr, metadataOutObj) != TCL_OK) {
+	goto errorExit;
     }
 
     /*
@@ -2290,6 +2229,245 @@ ImgPhotoConfigureModel(
     return TCL_ERROR;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgPhotoReadFile --
+ *
+ *	Read the file named by the -file option of a photo model into the
+ *	image, using the appropriate file format handler.
+ *
+ * Results:
+ *	A standard TCL completion code. If TCL_ERROR is returned then an
+ *	error message is left in the interp's result. On success a dict
+ *	holding the metadata reported by the driver is stored in
+ *	*metadataOutObjPtr with a reference owned by the caller.
+ *
+ * Side effects:
+ *	The size and contents of the image are updated.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ImgPhotoReadFile(
+    Tcl_Interp *interp,		/* Interpreter to use for reporting errors. */
+    PhotoModel *modelPtr,	/* Photo model whose -file is to be read. */
+    Tcl_Obj **metadataOutObjPtr)
+				/* Returns the driver metadata dict. */
+{
+    Tk_PhotoImageFormat *imageFormat;
+    Tk_PhotoImageFormatVersion3 *imageFormatVersion3;
+    Tcl_Obj *metadataOutObj, *tempformat;
+    int imageWidth, imageHeight, oldformat, result;
+    Tcl_Channel chan;
+
+    chan = Tcl_OpenFileChannel(interp, modelPtr->fileString, "r", 0);
+    if (chan == NULL) {
+	return TCL_ERROR;
+    }
+
+    /*
+     * Flag that we want the metadata result dict
+     */
+
+    metadataOutObj = Tcl_NewDictObj();
+    Tcl_IncrRefCount(metadataOutObj);
+
+    /*
+     * -translation binary also sets -encoding binary
+     */
+
+    Tcl_SetChannelOption(NULL, chan, "-buffersize", "65536");
+
+    if ((Tcl_SetChannelOption(interp, chan,
+	    "-translation", "binary") != TCL_OK) ||
+	    (MatchFileFormat(interp, chan, modelPtr->fileString,
+		    modelPtr->format, modelPtr->metadata, metadataOutObj,
+		    &imageFormat, &imageFormatVersion3,
+		    &imageWidth, &imageHeight, &oldformat) != TCL_OK)) {
+	Tcl_Close(NULL, chan);
+	goto errorExit;
+    }
+    result = ImgPhotoSetSize(modelPtr, imageWidth, imageHeight);
+    if (result != TCL_OK) {
+	Tcl_Close(NULL, chan);
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		TK_PHOTO_ALLOC_FAILURE_MESSAGE, TCL_INDEX_NONE));
+	Tcl_SetErrorCode(interp, "TK", "MALLOC", NULL);
+	goto errorExit;
+    }
+    tempformat = modelPtr->format;
+    if (oldformat && tempformat) {
+	tempformat = (Tcl_Obj *) Tcl_GetString(tempformat);
+    }
+    if (imageFormat != NULL) {
+	result = imageFormat->fileReadProc(interp, chan,
+		modelPtr->fileString, tempformat,
+		(Tk_PhotoHandle) modelPtr,
+		0, 0, imageWidth, imageHeight, 0, 0);
+    } else {
+	result = imageFormatVersion3->fileReadProc(interp, chan,
+		modelPtr->fileString, tempformat, modelPtr->metadata,
+		(Tk_PhotoHandle) modelPtr,
+		0, 0, imageWidth, imageHeight, 0, 0,
+		metadataOutObj);
+    }
+
+    Tcl_Close(NULL, chan);
+    if (result != TCL_OK) {
+	goto errorExit;
+    }
+
+    Tcl_ResetResult(interp);
+    modelPtr->flags |= IMAGE_CHANGED;
+    *metadataOutObjPtr = metadataOutObj;
+    return TCL_OK;
+
+  errorExit:
+    Tcl_DecrRefCount(metadataOutObj);
+    *metadataOutObjPtr = NULL;
+    return TCL_ERROR;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgPhotoMergeMetadata --
+ *
+ *	Merge the metadata dict returned by an image driver into the
+ *	metadata dict of the photo model.
+ *
+ * Results:
+ *	A standard TCL completion code. If TCL_ERROR is returned then an
+ *	error message is left in the interp's result.
+ *
+ * Side effects:
+ *	The model's metadata dict may be replaced by an unshared copy.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ImgPhotoMergeMetadata(
+    Tcl_Interp *interp,		/* Interpreter to use for reporting errors. */
+    PhotoModel *modelPtr,	/* Photo model to merge into. */
+    Tcl_Obj *metadataOutObj)	/* Driver metadata dict, or NULL. */
+{
+    Tcl_Size dictSize;
+
+    if (metadataOutObj == NULL) {
+	return TCL_OK;
+    }
+    if (TCL_OK != Tcl_DictObjSize(interp, metadataOutObj, &dictSize)) {
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		"driver metadata not a dict", TCL_INDEX_NONE));
+	Tcl_SetErrorCode(interp, "TK", "IMAGE", "PHOTO",
+		"UNRECOGNIZED_DATA", NULL);
+	return TCL_ERROR;
+    }
+    if (dictSize > 0) {
+
+	/*
+	 * We have driver return metadata
+	 */
+
+	if (modelPtr->metadata == NULL) {
+	    modelPtr->metadata = metadataOutObj;
+	    Tcl_IncrRefCount(modelPtr->metadata);
+	} else {
+	    Tcl_DictSearch search;
+	    Tcl_Obj *key, *value;
+	    int done;
+
+	    if (Tcl_IsShared(modelPtr->metadata)) {
+		Tcl_DecrRefCount(modelPtr->metadata);
+		modelPtr->metadata = Tcl_DuplicateObj(modelPtr->metadata);
+		Tcl_IncrRefCount(modelPtr->metadata);
+	    }
+
+	    if (Tcl_DictObjFirst(interp, metadataOutObj, &search, &key,
+		    &value, &done) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    for (; !done ; Tcl_DictObjNext(&search, &key, &value, &done)) {
+		Tcl_DictObjPut(interp, modelPtr->metadata, key, value);
+	    }
+	}
+    }
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgPhotoLoadIdle --
+ *
+ *	Idle callback that performs a file read deferred by -loadasync.
+ *	When the read finishes, the script given with -loadcommand is
+ *	evaluated at global level with two extra arguments: the image name
+ *	and an empty string on success or the error message on failure.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The image is read and all of its instances are updated; arbitrary
+ *	effects from the -loadcommand script.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ImgPhotoLoadIdle(
+    void *clientData)		/* Pointer to PhotoModel structure. */
+{
+    PhotoModel *modelPtr = (PhotoModel *)clientData;
+    Tcl_Interp *interp = modelPtr->interp;
+    Tcl_Obj *metadataOutObj = NULL;
+    PhotoInstance *instancePtr;
+    int result;
+
+    modelPtr->loadPending = 0;
+    result = ImgPhotoReadFile(interp, modelPtr, &metadataOutObj);
+    if (result == TCL_OK) {
+	result = ImgPhotoMergeMetadata(interp, modelPtr, metadataOutObj);
+    }
+    if (metadataOutObj != NULL) {
+	Tcl_DecrRefCount(metadataOutObj);
+    }
+    if (result == TCL_OK) {
+	Tcl_ResetResult(interp);
+	for (instancePtr = modelPtr->instancePtr; instancePtr != NULL;
+		instancePtr = instancePtr->nextPtr) {
+	    TkImgPhotoConfigureInstance(instancePtr);
+	}
+	Tk_ImageChanged(modelPtr->tkModel, 0, 0, modelPtr->width,
+		modelPtr->height, modelPtr->width, modelPtr->height);
+	modelPtr->flags &= ~IMAGE_CHANGED;
+	ToggleComplexAlphaIfNeeded(modelPtr);
+    }
+
+    if (modelPtr->loadCommand != NULL) {
+	Tcl_DString script;
+
+	Tcl_DStringInit(&script);
+	Tcl_DStringAppend(&script, modelPtr->loadCommand, TCL_INDEX_NONE);
+	Tcl_DStringAppendElement(&script, Tk_NameOfImage(modelPtr->tkModel));
+	Tcl_DStringAppendElement(&script, (result == TCL_OK) ? ""
+		: Tcl_GetString(Tcl_GetObjResult(interp)));
+	Tcl_Preserve(interp);
+	if (Tcl_EvalEx(interp, Tcl_DStringValue(&script),
+		Tcl_DStringLength(&script), TCL_EVAL_GLOBAL) != TCL_OK) {
+	    Tcl_BackgroundException(interp, TCL_ERROR);
+	}
+	Tcl_Release(interp);
+	Tcl_DStringFree(&script);
+    } else if (result != TCL_OK) {
+	Tcl_BackgroundException(interp, result);
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -2370,6 +2548,10 @@ ImgPhotoDelete(
 	TkImgDisposeInstance(instancePtr);
     }
     modelPtr->tkModel = NULL;
+    if (modelPtr->loadPending) {
+	Tcl_CancelIdleCall(ImgPhotoLoadIdle, modelPtr);
+	modelPtr->loadPending = 0;
+    }
     if (modelPtr->imageCmd != NULL) {
 	Tcl_DeleteCommandFromToken(modelPtr->interp, modelPtr->imageCmd);
     }
@@ -3078,6 +3260,7 @@ Tk_PhotoPutBlock(
     int wLeft, hLeft, wCopy, hCopy, pitch;
     unsigned char *srcPtr, *srcLinePtr, *destPtr, *destLinePtr;
     int sourceIsSimplePhoto = compRule & SOURCE_IS_SIMPLE_ALPHA_PHOTO;
+    int adoptBuffer = compRule & TK_PHOTO_ADOPT;
     XRectangle rect;
 
     /*
@@ -3085,10 +3268,13 @@ Tk_PhotoPutBlock(
      */
 
     if (blockPtr->height == 0 || blockPtr->width == 0) {
+	if (adoptBuffer && blockPtr->pixelPtr) {
+	    ckfree(blockPtr->pixelPtr);
+	}
 	return TCL_OK;
     }
 
-    compRule &= ~SOURCE_IS_SIMPLE_ALPHA_PHOTO;
+    compRule &= ~(SOURCE_IS_SIMPLE_ALPHA_PHOTO | TK_PHOTO_ADOPT);
 
     if ((modelPtr->userWidth != 0) && ((x + width) > modelPtr->userWidth)) {
 	width = modelPtr->userWidth - x;
@@ -3098,6 +3284,9 @@ Tk_PhotoPutBlock(
 	height = modelPtr->userHeight - y;
     }
     if ((width <= 0) || (height <= 0)) {
+	if (adoptBuffer && blockPtr->pixelPtr) {
+	    ckfree(blockPtr->pixelPtr);
+	}
 	return TCL_OK;
     }
 
@@ -3197,6 +3386,27 @@ Tk_PhotoPutBlock(
     destLinePtr = modelPtr->pix32 + (y * modelPtr->width + x) * 4;
     pitch = modelPtr->width * 4;
 
+    /*
+     * If the caller has handed its buffer over and that buffer already has
+     * exactly the layout of our 32-bit block, install it as the image's
+     * pixel storage in place of the old one rather than copying it. This
+     * is the zero-copy path for renderers that feed whole frames.
+     */
+
+    if (adoptBuffer && (memToFree == NULL)
+	    && (x == 0) && (y == 0)
+	    && (width == modelPtr->width) && (height == modelPtr->height)
+	    && (sourceBlock.width == width) && (sourceBlock.height == height)
+	    && (sourceBlock.pixelSize == 4) && (sourceBlock.offset[0] == 0)
+	    && (greenOffset == 1) && (blueOffset == 2) && (alphaOffset == 3)
+	    && (sourceBlock.pitch == pitch)
+	    && (compRule == TK_PHOTO_COMPOSITE_SET)) {
+	ckfree(modelPtr->pix32);
+	modelPtr->pix32 = sourceBlock.pixelPtr;
+	adoptBuffer = 0;
+	goto recalculateValidRegion;
+    }
+
     /*
      * Test to see if we can do the whole write in a single copy. This test is
      * probably too restrictive. We should also be able to do a memmove if
@@ -3463,10 +3673,24 @@ Tk_PhotoPutBlock(
 
     if (memToFree) ckfree(memToFree);
 
+    /*
+     * An adopted buffer that could not be installed directly has been
+     * copied above; we still own it, so release it now. When the source
+     * aliased our own storage (memToFree != NULL) the pointer was never
+     * the caller's to give away, so leave it alone.
+     */
+
+    if (adoptBuffer && (memToFree == NULL)) {
+	ckfree(blockPtr->pixelPtr);
+    }
+
     return TCL_OK;
 
   errorExit:
     if (memToFree) ckfree(memToFree);
+    if (adoptBuffer && (memToFree == NULL)) {
+	ckfree(blockPtr->pixelPtr);
+    }
 
     return TCL_ERROR;
 }
@@ -3676,57 +3900,85 @@ Tk_PhotoPutZoomedBlock(
 	yRepeat = zoomY;
 	srcLinePtr = srcOrigPtr;
 	for (; hCopy > 0; --hCopy) {
-	    destPtr = destLinePtr;
-	    for (wLeft = width; wLeft > 0;) {
-		wCopy = MIN(wLeft, blockWid);
-		wLeft -= wCopy;
-		srcPtr = srcLinePtr;
-		for (; wCopy > 0; wCopy -= zoomX) {
-		    for (xRepeat = MIN(wCopy, zoomX); xRepeat > 0; xRepeat--) {
-			int alpha = srcPtr[alphaOffset];/* Source alpha. */
+	    if ((yRepeat < zoomY)
+		    && ((compRule == TK_PHOTO_COMPOSITE_SET) || !alphaOffset)) {
+		/*
+		 * A row repeated by -zoom is identical to the row just
+		 * written whenever the existing destination cannot show
+		 * through (SET rule, or an opaque source), so copy it
+		 * wholesale instead of recomputing it.
+		 */
 
+		memcpy(destLinePtr, destLinePtr - pitch, (size_t) width * 4);
+	    } else {
+		destPtr = destLinePtr;
+		for (wLeft = width; wLeft > 0;) {
+		    wCopy = MIN(wLeft, blockWid);
+		    wLeft -= wCopy;
+		    srcPtr = srcLinePtr;
+		    if ((zoomX == 1) && (greenOffset == 1) && (blueOffset == 2)
+			    && (alphaOffset == 3)
+			    && (compRule == TK_PHOTO_COMPOSITE_SET)) {
 			/*
-			 * Common case (solid pixels) first
+			 * Subsampling a 32-bit RGBA source with the SET rule
+			 * stores the four source bytes unchanged, so gather them
+			 * without the per-pixel compositing branches.
 			 */
 
-			if (!alphaOffset || (alpha == 255)) {
-			    *destPtr++ = srcPtr[0];
-			    *destPtr++ = srcPtr[greenOffset];
-			    *destPtr++ = srcPtr[blueOffset];
-			    *destPtr++ = 255;
-			    continue;
- 			}
+			for (; wCopy > 0; wCopy--) {
+			    memcpy(destPtr, srcPtr, 4);
+			    destPtr += 4;
+			    srcPtr += blockXSkip;
+			}
+			continue;
+		    }
+		    for (; wCopy > 0; wCopy -= zoomX) {
+			for (xRepeat = MIN(wCopy, zoomX); xRepeat > 0; xRepeat--) {
+			    int alpha = srcPtr[alphaOffset];/* Source alpha. */
 
-			if (compRule==TK_PHOTO_COMPOSITE_SET || !destPtr[3]) {
 			    /*
-			     * Either this is the SET rule (we overwrite
-			     * whatever is there) or the destination is
-			     * entirely blank. In both cases, we just set the
-			     * destination to the source.
+			     * Common case (solid pixels) first
 			     */
 
-			    *destPtr++ = srcPtr[0];
-			    *destPtr++ = srcPtr[greenOffset];
-			    *destPtr++ = srcPtr[blueOffset];
-			    *destPtr++ = alpha;
-			} else if (alpha) {
-			    int Alpha = destPtr[3];	/* Destination
-							 * alpha. */
-
-			    destPtr[0] = PD_SRC_OVER(srcPtr[0], alpha,
-				    destPtr[0], Alpha);
-			    destPtr[1] = PD_SRC_OVER(srcPtr[greenOffset],alpha,
-				    destPtr[1], Alpha);
-			    destPtr[2] = PD_SRC_OVER(srcPtr[blueOffset], alpha,
-				    destPtr[2], Alpha);
-			    destPtr[3] = PD_SRC_OVER_ALPHA(alpha, Alpha);
-
-			    destPtr += 4;
-			} else {
-			    destPtr += 4;
+			    if (!alphaOffset || (alpha == 255)) {
+				*destPtr++ = srcPtr[0];
+				*destPtr++ = srcPtr[greenOffset];
+				*destPtr++ = srcPtr[blueOffset];
+				*destPtr++ = 255;
+				continue;
+			    }
+
+			    if (compRule==TK_PHOTO_COMPOSITE_SET || !destPtr[3]) {
+				/*
+				 * Either this is the SET rule (we overwrite
+				 * whatever is there) or the destination is
+				 * entirely blank. In both cases, we just set the
+				 * destination to the source.
+				 */
+
+				*destPtr++ = srcPtr[0];
+				*destPtr++ = srcPtr[greenOffset];
+				*destPtr++ = srcPtr[blueOffset];
+				*destPtr++ = alpha;
+			    } else if (alpha) {
+				int Alpha = destPtr[3];	/* Destination
+							     * alpha. */
+
+				destPtr[0] = PD_SRC_OVER(srcPtr[0], alpha,
+					destPtr[0], Alpha);
+				destPtr[1] = PD_SRC_OVER(srcPtr[greenOffset],alpha,
+					destPtr[1], Alpha);
+				destPtr[2] = PD_SRC_OVER(srcPtr[blueOffset], alpha,
+					destPtr[2], Alpha);
+				destPtr[3] = PD_SRC_OVER_ALPHA(alpha, Alpha);
+
+				destPtr += 4;
+			    } else {
+				destPtr += 4;
+			    }
 			}
+			srcPtr += blockXSkip;
 		    }
-		    srcPtr += blockXSkip;
 		}
 	    }
 	    destLinePtr += pitch;
@@ -3832,16 +4084,20 @@ Tk_PhotoPutZoomedBlock(
  *
  * Tk_DitherPhoto --
  *
- *	This function is called to update an area of each instance's pixmap by
- *	dithering the corresponding area of the image model.
+ *	This function is called when an area of the image model has changed
+ *	and the corresponding area of each instance's pixmap needs to be
+ *	redithered. The actual dithering is deferred: the area is recorded in
+ *	each instance's dirty region and rendered tile by tile when the
+ *	instance is next displayed, so a model written many times between
+ *	exposures is only dithered once.
  *
  * Results:
  *	None.
  *
  * Side effects:
- *	The pixmap of each instance of this image gets updated. The fields in
- *	*modelPtr indicating which area of the image is correctly dithered
- *	get updated.
+ *	The dirty region of each instance of this image gets extended. The
+ *	fields in *modelPtr indicating which area of the image is correctly
+ *	dithered get updated.
  *
  *----------------------------------------------------------------------
  */
@@ -3856,14 +4112,20 @@ Tk_DitherPhoto(
 {
     PhotoModel *modelPtr = (PhotoModel *) photo;
     PhotoInstance *instancePtr;
+    XRectangle rect;
 
     if ((width <= 0) || (height <= 0)) {
 	return;
     }
 
+    rect.x = x;
+    rect.y = y;
+    rect.width = width;
+    rect.height = height;
     for (instancePtr = modelPtr->instancePtr; instancePtr != NULL;
 	    instancePtr = instancePtr->nextPtr) {
-	TkImgDitherInstance(instancePtr, x, y, width, height);
+	TkUnionRectWithRegion(&rect, instancePtr->dirtyRegion,
+		instancePtr->dirtyRegion);
     }
 
     /*
@@ -161,6 +161,13 @@ struct PhotoModel {
 				 * or string value. */
     Tcl_Obj *metadata;		/* User-specified metadata dict or read from
 				 * image file */
+    int loadAsync;		/* Non-zero means a file given with -file is
+				 * read in an idle callback instead of
+				 * synchronously at configure time. */
+    char *loadCommand;		/* Script to evaluate when a deferred file
+				 * read completes, or NULL. Malloc'ed. */
+    int loadPending;		/* Non-zero means an idle file read is
+				 * currently scheduled. */
     unsigned char *pix32;	/* Local storage for 32-bit image. */
     int ditherX, ditherY;	/* Location of first incorrectly dithered
 				 * pixel in image. */
@@ -219,7 +226,16 @@ struct PhotoInstance {
     Pixmap pixels;		/* X pixmap containing dithered image. */
     int width, height;		/* Dimensions of the pixmap. */
     schar *error;		/* Error image, used in dithering. */
+    TkRegion dirtyRegion;	/* Area of the model's 32-bit data that has
+				 * changed since it was last dithered into
+				 * the pixmap; brought up to date tile by
+				 * tile when the instance is displayed. */
     XImage *imagePtr;		/* Image structure for converted pixels. */
+    XImage *shmImagePtr;	/* Shared-memory image used to transfer
+				 * dithered blocks to the server, or NULL
+				 * when MIT-SHM is not in use for this
+				 * instance.  Always NULL on platforms
+				 * without TK_SHM_IMAGES. */
     XVisualInfo visualInfo;	/* Information about the visual that these
 				 * windows are using. */
     GC gc;			/* Graphics context for writing images to the
@@ -249,6 +265,8 @@ MODULE_SCOPE void	TkImgPhotoConfigureInstance(
 			    PhotoInstance *instancePtr);
 MODULE_SCOPE void	TkImgDisposeInstance(void *clientData);
 MODULE_SCOPE void	TkImgPhotoInstanceSetSize(PhotoInstance *instancePtr);
+MODULE_SCOPE void	TkImgPhotoValidateInstance(PhotoInstance *instancePtr,
+			    int x, int y, int width, int height);
 MODULE_SCOPE void *TkImgPhotoGet(Tk_Window tkwin, void *clientData);
 MODULE_SCOPE void	TkImgDitherInstance(PhotoInstance *instancePtr, int x,
 			    int y, int width, int height);
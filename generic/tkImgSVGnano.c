@@ -38,9 +38,26 @@ typedef struct {
 /*
  * Per interp cache of last NSVGimage which was matched to
  * be immediately rasterized after the match. This helps to
- * eliminate double parsing of the SVG file/string.
+ * eliminate double parsing of the SVG file/string. In addition the
+ * most recently parsed document is retained together with a small
+ * set of its rasterized outputs, so that repeated reads of the same
+ * SVG source (for example after a -scale change, or from several
+ * photo images created from identical -data strings) do not parse
+ * or rasterize again.
  */
 
+#define NSVG_RASTER_CACHE_SLOTS		8
+#define NSVG_RASTER_CACHE_MAX_BYTES	(8 * 1024 * 1024)
+
+typedef struct {
+    unsigned char *pixels;	/* RGBA output of nsvgRasterize(), or NULL
+				 * when the slot is unused. */
+    int width, height;		/* Dimensions of the raster. */
+    double scale;		/* Scale it was rendered at. */
+    unsigned lastUse;		/* Serial of the last lookup, for LRU
+				 * eviction. */
+} NSVGraster;
+
 typedef struct {
     /* A poiner to remember if it is the same svn image (data)
      * It is a Tcl_Channel if image created by -file option
@@ -50,6 +67,17 @@ typedef struct {
     Tcl_DString formatString;
     NSVGimage *nsvgImage;
     RastOpts ropts;
+
+    /*
+     * Retained copy of the most recently parsed document and the
+     * rasterizations produced from it.
+     */
+
+    Tcl_DString docData;	/* Source text of docImage. */
+    double docDpi;		/* -dpi value docImage was parsed with. */
+    NSVGimage *docImage;	/* Parsed document, or NULL. */
+    NSVGraster rasters[NSVG_RASTER_CACHE_SLOTS];
+    unsigned rasterSerial;	/* Increments on every raster access. */
 } NSVGcache;
 
 static const void *	MemMem(const void *haystack, size_t haysize,
@@ -70,6 +98,12 @@ static int		StringReadSVG(Tcl_Interp *interp, Tcl_Obj *dataObj,
 static NSVGimage *	ParseSVGWithOptions(Tcl_Interp *interp,
 			    const char *input, Tcl_Size length, Tcl_Obj *format,
 			    RastOpts *ropts);
+static int		ParseFormatOptions(Tcl_Interp *interp,
+			    Tcl_Obj *formatObj, RastOpts *ropts,
+			    double *dpiPtr);
+static NSVGimage *	GetParsedSVG(Tcl_Interp *interp, void *dataOrChan,
+			    const char *data, Tcl_Size length,
+			    Tcl_Obj *formatObj, RastOpts *ropts);
 static int		RasterizeSVG(Tcl_Interp *interp,
 			    Tk_PhotoHandle imageHandle, NSVGimage *nsvgImage,
 			    int destX, int destY, int width, int height,
@@ -82,6 +116,9 @@ static int		CacheSVG(Tcl_Interp *interp, void *dataOrChan,
 			    RastOpts *ropts);
 static NSVGimage *	GetCachedSVG(Tcl_Interp *interp, void *dataOrChan,
 			    Tcl_Obj *formatObj, RastOpts *ropts);
+static int		StoreRaster(NSVGcache *cachePtr, double scale,
+			    int width, int height, unsigned char *pixels);
+static void		FlushRasterCache(NSVGcache *cachePtr);
 static void		CleanCache(Tcl_Interp *interp);
 static void		FreeCache(void *clientData, Tcl_Interp *interp);
 
@@ -242,7 +279,13 @@ FileReadSVG(
     RastOpts ropts;
     NSVGimage *nsvgImage = GetCachedSVG(interp, chan, formatObj, &ropts);
 
-    if (nsvgImage == NULL) {
+    if (nsvgImage != NULL) {
+	int code = RasterizeSVG(interp, imageHandle, nsvgImage, destX, destY,
+		width, height, srcX, srcY, &ropts);
+
+	nsvgDelete(nsvgImage);
+	return code;
+    } else {
         Tcl_Obj *dataObj = Tcl_NewObj();
 
 	if (Tcl_ReadChars(chan, dataObj, TCL_INDEX_NONE, 0) == TCL_IO_FAILURE) {
@@ -253,7 +296,7 @@ FileReadSVG(
 	    return TCL_ERROR;
 	}
 	data = Tcl_GetStringFromObj(dataObj, &length);
-	nsvgImage = ParseSVGWithOptions(interp, data, length, formatObj,
+	nsvgImage = GetParsedSVG(interp, chan, data, length, formatObj,
 			    &ropts);
 	Tcl_DecrRefCount(dataObj);
 	if (nsvgImage == NULL) {
@@ -348,13 +391,11 @@ StringReadSVG(
     Tcl_Size length;
     const char *data;
     RastOpts ropts;
-    NSVGimage *nsvgImage = GetCachedSVG(interp, dataObj, formatObj, &ropts);
+    NSVGimage *nsvgImage;
 
-    if (nsvgImage == NULL) {
-	data = Tcl_GetStringFromObj(dataObj, &length);
-	nsvgImage = ParseSVGWithOptions(interp, data, length, formatObj,
-			    &ropts);
-    }
+    data = Tcl_GetStringFromObj(dataObj, &length);
+    nsvgImage = GetParsedSVG(interp, dataObj, data, length, formatObj,
+			&ropts);
     if (nsvgImage == NULL) {
 	return TCL_ERROR;
     }
@@ -385,18 +426,13 @@ ParseSVGWithOptions(
     Tcl_Obj *formatObj,
     RastOpts *ropts)
 {
-    Tcl_Obj **objv = NULL;
-    Tcl_Size objc = 0;
-    double dpi = 96.0;
-    char *inputCopy = NULL;
+    double dpi;
+    char *inputCopy;
     NSVGimage *nsvgImage;
-    int parameterScaleSeen = 0;
-    static const char *const fmtOptions[] = {
-        "-dpi", "-scale", "-scaletoheight", "-scaletowidth", NULL
-    };
-    enum fmtOptionsEnum {
-	OPT_DPI, OPT_SCALE, OPT_SCALE_TO_HEIGHT, OPT_SCALE_TO_WIDTH
-    };
+
+    if (ParseFormatOptions(interp, formatObj, ropts, &dpi) != TCL_OK) {
+	return NULL;
+    }
 
     /*
      * The parser destroys the original input string,
@@ -407,21 +443,63 @@ ParseSVGWithOptions(
     if (inputCopy == NULL) {
 	Tcl_SetObjResult(interp, Tcl_NewStringObj("cannot alloc data buffer", TCL_INDEX_NONE));
 	Tcl_SetErrorCode(interp, "TK", "IMAGE", "SVG", "OUT_OF_MEMORY", NULL);
-	goto error;
+	return NULL;
     }
     memcpy(inputCopy, input, length);
     inputCopy[length] = '\0';
 
-    /*
-     * Process elements of format specification as a list.
-     */
+    nsvgImage = nsvgParse(inputCopy, "px", (float) dpi);
+    if (nsvgImage == NULL) {
+	Tcl_SetObjResult(interp, Tcl_NewStringObj("cannot parse SVG image", TCL_INDEX_NONE));
+	Tcl_SetErrorCode(interp, "TK", "IMAGE", "SVG", "PARSE_ERROR", NULL);
+	ckfree(inputCopy);
+	return NULL;
+    }
+    ckfree(inputCopy);
+    return nsvgImage;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ParseFormatOptions --
+ *
+ *	Process the elements of a format specification as a list and
+ *	fill in the rasterization options and the -dpi value.
+ *
+ * Results:
+ *	A standard TCL completion code. If TCL_ERROR is returned then an
+ *	error message is left in the interp's result.
+ *
+ * Side effects:
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ParseFormatOptions(
+    Tcl_Interp *interp,
+    Tcl_Obj *formatObj,
+    RastOpts *ropts,
+    double *dpiPtr)
+{
+    Tcl_Obj **objv = NULL;
+    Tcl_Size objc = 0;
+    double dpi = 96.0;
+    int parameterScaleSeen = 0;
+    static const char *const fmtOptions[] = {
+        "-dpi", "-scale", "-scaletoheight", "-scaletowidth", NULL
+    };
+    enum fmtOptionsEnum {
+	OPT_DPI, OPT_SCALE, OPT_SCALE_TO_HEIGHT, OPT_SCALE_TO_WIDTH
+    };
 
     ropts->scale = 1.0;
     ropts->scaleToHeight = 0;
     ropts->scaleToWidth = 0;
     if ((formatObj != NULL) &&
 	    Tcl_ListObjGetElements(interp, formatObj, &objc, &objv) != TCL_OK) {
-        goto error;
+        return TCL_ERROR;
     }
     for (; objc > 0 ; objc--, objv++) {
 	int optIndex;
@@ -436,14 +514,12 @@ ParseSVGWithOptions(
 
 	if (Tcl_GetIndexFromObjStruct(interp, objv[0], fmtOptions,
 		sizeof(char *), "option", 0, &optIndex) == TCL_ERROR) {
-	    goto error;
+	    return TCL_ERROR;
 	}
 
 	if (objc < 2) {
-	    ckfree(inputCopy);
-	    inputCopy = NULL;
 	    Tcl_WrongNumArgs(interp, 1, objv, "value");
-	    goto error;
+	    return TCL_ERROR;
 	}
 
 	objc--;
@@ -461,7 +537,7 @@ ParseSVGWithOptions(
 			"only one of -scale, -scaletoheight, -scaletowidth may be given", TCL_INDEX_NONE));
 		Tcl_SetErrorCode(interp, "TK", "IMAGE", "SVG", "BAD_SCALE",
 			NULL);
-		goto error;
+		return TCL_ERROR;
 	    }
 	    parameterScaleSeen = 1;
 	    break;
@@ -475,72 +551,134 @@ ParseSVGWithOptions(
 	switch ((enum fmtOptionsEnum) optIndex) {
 	case OPT_DPI:
 	    if (Tcl_GetDoubleFromObj(interp, objv[0], &dpi) == TCL_ERROR) {
-	        goto error;
+	        return TCL_ERROR;
 	    }
 	    if (dpi < 0.0) {
 		Tcl_SetObjResult(interp, Tcl_NewStringObj(
 			"-dpi value must be positive", TCL_INDEX_NONE));
 		Tcl_SetErrorCode(interp, "TK", "IMAGE", "SVG", "BAD_DPI",
 			NULL);
-		goto error;
+		return TCL_ERROR;
 	    }
 	    break;
 	case OPT_SCALE:
 	    if (Tcl_GetDoubleFromObj(interp, objv[0], &ropts->scale) ==
 		TCL_ERROR) {
-	        goto error;
+	        return TCL_ERROR;
 	    }
 	    if (ropts->scale <= 0.0) {
 		Tcl_SetObjResult(interp, Tcl_NewStringObj(
 			"-scale value must be positive", TCL_INDEX_NONE));
 		Tcl_SetErrorCode(interp, "TK", "IMAGE", "SVG", "BAD_SCALE",
 			NULL);
-		goto error;
+		return TCL_ERROR;
 	    }
 	    break;
 	case OPT_SCALE_TO_HEIGHT:
 	    if (Tcl_GetIntFromObj(interp, objv[0], &ropts->scaleToHeight) ==
 		TCL_ERROR) {
-	        goto error;
+	        return TCL_ERROR;
 	    }
 	    if (ropts->scaleToHeight <= 0) {
 		Tcl_SetObjResult(interp, Tcl_NewStringObj(
 			"-scaletoheight value must be positive", TCL_INDEX_NONE));
 		Tcl_SetErrorCode(interp, "TK", "IMAGE", "SVG", "BAD_SCALE",
 			NULL);
-		goto error;
+		return TCL_ERROR;
 	    }
 	    break;
 	case OPT_SCALE_TO_WIDTH:
 	    if (Tcl_GetIntFromObj(interp, objv[0], &ropts->scaleToWidth) ==
 		TCL_ERROR) {
-	        goto error;
+	        return TCL_ERROR;
 	    }
 	    if (ropts->scaleToWidth <= 0) {
 		Tcl_SetObjResult(interp, Tcl_NewStringObj(
 			"-scaletowidth value must be positive", TCL_INDEX_NONE));
 		Tcl_SetErrorCode(interp, "TK", "IMAGE", "SVG", "BAD_SCALE",
 			NULL);
-		goto error;
+		return TCL_ERROR;
 	    }
 	    break;
 	}
     }
+    *dpiPtr = dpi;
+    return TCL_OK;
+}
 
-    nsvgImage = nsvgParse(inputCopy, "px", (float) dpi);
-    if (nsvgImage == NULL) {
-	Tcl_SetObjResult(interp, Tcl_NewStringObj("cannot parse SVG image", TCL_INDEX_NONE));
-	Tcl_SetErrorCode(interp, "TK", "IMAGE", "SVG", "PARSE_ERROR", NULL);
-	goto error;
+/*
+ *----------------------------------------------------------------------
+ *
+ * GetParsedSVG --
+ *
+ *	Return the parsed document for the given SVG source, parsing it
+ *	only when the per interp cache does not already hold a document
+ *	for identical source text and -dpi value.
+ *
+ * Results:
+ *	Return the parsed NSVGimage on success, and NULL otherwise. The
+ *	returned image is owned by the cache and stays valid until the
+ *	next call.
+ *
+ * Side effects:
+ *	The previously retained document and its cached rasterizations
+ *	are deleted when a different document is parsed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static NSVGimage *
+GetParsedSVG(
+    Tcl_Interp *interp,
+    void *dataOrChan,
+    const char *data,
+    Tcl_Size length,
+    Tcl_Obj *formatObj,
+    RastOpts *ropts)
+{
+    NSVGcache *cachePtr = GetCachePtr(interp);
+    NSVGimage *nsvgImage;
+    double dpi;
+
+    if (ParseFormatOptions(interp, formatObj, ropts, &dpi) != TCL_OK) {
+	CleanCache(interp);
+	return NULL;
     }
-    ckfree(inputCopy);
-    return nsvgImage;
+    if ((cachePtr->docImage != NULL) && (cachePtr->docDpi == dpi)
+	    && ((Tcl_Size) Tcl_DStringLength(&cachePtr->docData) == length)
+	    && (memcmp(Tcl_DStringValue(&cachePtr->docData), data,
+		    (size_t) length) == 0)) {
+	/*
+	 * Drop any image still parked by the match procedure; the
+	 * retained document makes it redundant.
+	 */
 
-error:
-    if (inputCopy != NULL) {
-        ckfree(inputCopy);
+	CleanCache(interp);
+	return cachePtr->docImage;
     }
-    return NULL;
+
+    /*
+     * Adopt the image parsed by the match procedure when present,
+     * otherwise parse the source text.
+     */
+
+    nsvgImage = GetCachedSVG(interp, dataOrChan, formatObj, ropts);
+    if (nsvgImage == NULL) {
+	nsvgImage = ParseSVGWithOptions(interp, data, length, formatObj,
+		ropts);
+	if (nsvgImage == NULL) {
+	    return NULL;
+	}
+    }
+    if (cachePtr->docImage != NULL) {
+	nsvgDelete(cachePtr->docImage);
+    }
+    FlushRasterCache(cachePtr);
+    Tcl_DStringSetLength(&cachePtr->docData, 0);
+    Tcl_DStringAppend(&cachePtr->docData, data, length);
+    cachePtr->docDpi = dpi;
+    cachePtr->docImage = nsvgImage;
+    return nsvgImage;
 }
 
 /*
@@ -557,7 +695,9 @@ error:
  *
  *
  * Side effects:
- *	On error the given nsvgImage will be deleted.
+ *	The rasterization may be stored in the per interp cache. The
+ *	given nsvgImage is not deleted; it is owned by the caller or by
+ *	the cache.
  *
  *----------------------------------------------------------------------
  */
@@ -573,39 +713,67 @@ RasterizeSVG(
     TCL_UNUSED(int),
     RastOpts *ropts)
 {
-    int w, h, c;
+    int w, h, c, cached = 0;
     NSVGrasterizer *rast;
-    unsigned char *imgData;
+    unsigned char *imgData = NULL;
     Tk_PhotoImageBlock svgblock;
     double scale;
     Tcl_WideUInt wh;
+    NSVGcache *cachePtr = GetCachePtr(interp);
 
     scale = GetScaleFromParameters(nsvgImage, ropts, &w, &h);
 
-    rast = nsvgCreateRasterizer();
-    if (rast == NULL) {
-	Tcl_SetObjResult(interp, Tcl_NewStringObj("cannot initialize rasterizer", TCL_INDEX_NONE));
-	Tcl_SetErrorCode(interp, "TK", "IMAGE", "SVG", "RASTERIZER_ERROR",
-		NULL);
-	goto cleanAST;
-    }
-
     /* Tk Ticket [822330269b] Check potential int overflow in following ckalloc */
     wh = (Tcl_WideUInt)w * (Tcl_WideUInt)h;
     if ( w < 0 || h < 0 || wh > INT_MAX / 4) {
 	Tcl_SetObjResult(interp, Tcl_NewStringObj("image size overflow", TCL_INDEX_NONE));
 	Tcl_SetErrorCode(interp, "TK", "IMAGE", "SVG", "IMAGE_SIZE_OVERFLOW", NULL);
-	goto cleanRAST;
+	return TCL_ERROR;
+    }
+
+    /*
+     * Reuse a cached rasterization of the retained document when one
+     * matches the requested scale and size.
+     */
+
+    if (nsvgImage == cachePtr->docImage) {
+	for (c = 0; c < NSVG_RASTER_CACHE_SLOTS; c++) {
+	    NSVGraster *rasterPtr = &cachePtr->rasters[c];
+
+	    if ((rasterPtr->pixels != NULL) && (rasterPtr->width == w)
+		    && (rasterPtr->height == h)
+		    && (rasterPtr->scale == scale)) {
+		rasterPtr->lastUse = ++cachePtr->rasterSerial;
+		imgData = rasterPtr->pixels;
+		cached = 1;
+		break;
+	    }
+	}
     }
 
-    imgData = (unsigned char *)attemptckalloc(wh * 4);
     if (imgData == NULL) {
-	Tcl_SetObjResult(interp, Tcl_NewStringObj("cannot alloc image buffer", TCL_INDEX_NONE));
-	Tcl_SetErrorCode(interp, "TK", "IMAGE", "SVG", "OUT_OF_MEMORY", NULL);
-	goto cleanRAST;
+	rast = nsvgCreateRasterizer();
+	if (rast == NULL) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj("cannot initialize rasterizer", TCL_INDEX_NONE));
+	    Tcl_SetErrorCode(interp, "TK", "IMAGE", "SVG", "RASTERIZER_ERROR",
+		    NULL);
+	    return TCL_ERROR;
+	}
+	imgData = (unsigned char *)attemptckalloc(wh * 4);
+	if (imgData == NULL) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj("cannot alloc image buffer", TCL_INDEX_NONE));
+	    Tcl_SetErrorCode(interp, "TK", "IMAGE", "SVG", "OUT_OF_MEMORY", NULL);
+	    nsvgDeleteRasterizer(rast);
+	    return TCL_ERROR;
+	}
+	nsvgRasterize(rast, nsvgImage, 0, 0,
+		(float) scale, imgData, w, h, w * 4);
+	nsvgDeleteRasterizer(rast);
+	if (nsvgImage == cachePtr->docImage) {
+	    cached = StoreRaster(cachePtr, scale, w, h, imgData);
+	}
     }
-    nsvgRasterize(rast, nsvgImage, 0, 0,
-	    (float) scale, imgData, w, h, w * 4);
+
     /* transfer the data to a photo block */
     svgblock.pixelPtr = imgData;
     svgblock.width = w;
@@ -617,26 +785,129 @@ RasterizeSVG(
     }
     if (Tk_PhotoExpand(interp, imageHandle,
 		destX + width, destY + height) != TCL_OK) {
-	goto cleanRAST;
+	goto cleanimg;
     }
     if (Tk_PhotoPutBlock(interp, imageHandle, &svgblock, destX, destY,
 		width, height, TK_PHOTO_COMPOSITE_SET) != TCL_OK) {
 	goto cleanimg;
     }
-    ckfree(imgData);
-    nsvgDeleteRasterizer(rast);
-    nsvgDelete(nsvgImage);
+    if (!cached) {
+	ckfree(imgData);
+    }
     return TCL_OK;
 
 cleanimg:
-    ckfree(imgData);
+    if (!cached) {
+	ckfree(imgData);
+    }
+    return TCL_ERROR;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * StoreRaster --
+ *
+ *	Store a rasterization of the retained document in the per interp
+ *	cache, taking ownership of the pixel buffer. The least recently
+ *	used entries are evicted until the cache fits its memory budget.
+ *
+ * Results:
+ *	Return 1 when the buffer was stored (the cache now owns it), and
+ *	0 otherwise.
+ *
+ * Side effects:
+ *	May free older cached rasterizations.
+ *
+ *----------------------------------------------------------------------
+ */
 
-cleanRAST:
-    nsvgDeleteRasterizer(rast);
+static int
+StoreRaster(
+    NSVGcache *cachePtr,
+    double scale,
+    int width, int height,
+    unsigned char *pixels)
+{
+    NSVGraster *slotPtr = NULL;
+    Tcl_WideUInt total;
+    int i;
 
-cleanAST:
-    nsvgDelete(nsvgImage);
-    return TCL_ERROR;
+    if ((Tcl_WideUInt)width * height * 4 > NSVG_RASTER_CACHE_MAX_BYTES) {
+	return 0;
+    }
+    for (i = 0; i < NSVG_RASTER_CACHE_SLOTS; i++) {
+	NSVGraster *rasterPtr = &cachePtr->rasters[i];
+
+	if (rasterPtr->pixels == NULL) {
+	    slotPtr = rasterPtr;
+	    break;
+	}
+	if ((slotPtr == NULL) || (rasterPtr->lastUse < slotPtr->lastUse)) {
+	    slotPtr = rasterPtr;
+	}
+    }
+    if (slotPtr->pixels != NULL) {
+	ckfree(slotPtr->pixels);
+    }
+    slotPtr->pixels = pixels;
+    slotPtr->width = width;
+    slotPtr->height = height;
+    slotPtr->scale = scale;
+    slotPtr->lastUse = ++cachePtr->rasterSerial;
+
+    for (;;) {
+	NSVGraster *oldestPtr = NULL;
+
+	total = 0;
+	for (i = 0; i < NSVG_RASTER_CACHE_SLOTS; i++) {
+	    NSVGraster *rasterPtr = &cachePtr->rasters[i];
+
+	    if (rasterPtr->pixels == NULL) {
+		continue;
+	    }
+	    total += (Tcl_WideUInt)rasterPtr->width * rasterPtr->height * 4;
+	    if ((rasterPtr != slotPtr) && ((oldestPtr == NULL)
+		    || (rasterPtr->lastUse < oldestPtr->lastUse))) {
+		oldestPtr = rasterPtr;
+	    }
+	}
+	if ((total <= NSVG_RASTER_CACHE_MAX_BYTES) || (oldestPtr == NULL)) {
+	    break;
+	}
+	ckfree(oldestPtr->pixels);
+	oldestPtr->pixels = NULL;
+    }
+    return 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * FlushRasterCache --
+ *
+ *	Delete all cached rasterizations.
+ *
+ * Results:
+ *
+ * Side effects:
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+FlushRasterCache(
+    NSVGcache *cachePtr)
+{
+    int i;
+
+    for (i = 0; i < NSVG_RASTER_CACHE_SLOTS; i++) {
+	if (cachePtr->rasters[i].pixels != NULL) {
+	    ckfree(cachePtr->rasters[i].pixels);
+	    cachePtr->rasters[i].pixels = NULL;
+	}
+    }
+    cachePtr->rasterSerial = 0;
 }
 
 /*
@@ -726,6 +997,11 @@ GetCachePtr(
 	cachePtr->dataOrChan = NULL;
 	Tcl_DStringInit(&cachePtr->formatString);
 	cachePtr->nsvgImage = NULL;
+	Tcl_DStringInit(&cachePtr->docData);
+	cachePtr->docDpi = 0.0;
+	cachePtr->docImage = NULL;
+	memset(cachePtr->rasters, 0, sizeof(cachePtr->rasters));
+	cachePtr->rasterSerial = 0;
 	Tcl_SetAssocData(interp, "tksvgnano", FreeCache, cachePtr);
     }
     return cachePtr;
@@ -871,6 +1147,11 @@ FreeCache(void *clientData, TCL_UNUSED(Tcl_Interp *))
     if (cachePtr->nsvgImage != NULL) {
         nsvgDelete(cachePtr->nsvgImage);
     }
+    Tcl_DStringFree(&cachePtr->docData);
+    if (cachePtr->docImage != NULL) {
+	nsvgDelete(cachePtr->docImage);
+    }
+    FlushRasterCache(cachePtr);
     ckfree(cachePtr);
 }
 
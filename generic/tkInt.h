@@ -269,6 +269,15 @@ typedef struct TkDisplay {
 				 * collection of in-core data about a bitmap
 				 * to a reference giving an automatically-
 				 * generated name for the bitmap. */
+    Tcl_WideInt bitmapCacheHits;/* Number of named bitmap lookups satisfied
+				 * from bitmapNameTable. */
+    Tcl_WideInt bitmapCacheMisses;
+				/* Number of named bitmap lookups that had to
+				 * create the bitmap. */
+    Pixmap *preloadBitmaps;	/* Bitmaps retained by [tk preload] for the
+				 * life of the display. Malloc'ed, may be
+				 * NULL. */
+    int numPreloadBitmaps;	/* Number of entries in preloadBitmaps. */
 
     /*
      * Information used by tkCanvas.c only:
@@ -309,6 +318,15 @@ typedef struct TkDisplay {
     char cursorString[20];	/* Used to store a cursor id string. */
     Font cursorFont;		/* Font to use for standard cursors. None
 				 * means font not loaded yet. */
+    Tcl_WideInt cursorCacheHits;/* Number of named cursor lookups satisfied
+				 * from cursorNameTable. */
+    Tcl_WideInt cursorCacheMisses;
+				/* Number of named cursor lookups that had to
+				 * create the cursor. */
+    Tk_Cursor *preloadCursors;	/* Cursors retained by [tk preload] for the
+				 * life of the display. Malloc'ed, may be
+				 * NULL. */
+    int numPreloadCursors;	/* Number of entries in preloadCursors. */
 
     /*
      * Information used by tkError.c only:
@@ -322,6 +340,11 @@ typedef struct TkDisplay {
 				 * time inactive handlers were garbage-
 				 * collected. When this number gets big,
 				 * handlers get cleaned up. */
+    struct TkErrorHandler *errorFreePtr;
+				/* First in list of handler records available
+				 * for reuse. Handlers come and go at high
+				 * frequency on some paths, so dead records
+				 * are pooled instead of freed. */
 
     /*
      * Used by tkEvent.c only:
@@ -334,6 +357,28 @@ typedef struct TkDisplay {
 				 * right away and we can merge the two of them
 				 * together. NULL means that there is no
 				 * delayed motion event. */
+    struct TkWindowEvent *delayedWheelPtr;
+				/* Points to a malloc-ed mouse wheel event
+				 * whose processing has been delayed so that
+				 * the deltas of immediately following wheel
+				 * events can be merged into it. NULL means
+				 * that there is no delayed wheel event. */
+    struct TkWindowEvent *delayedExposePtr;
+				/* Points to a malloc-ed expose event whose
+				 * processing has been delayed so that the
+				 * rectangles of other expose events for the
+				 * same window can be merged into it, giving
+				 * one repaint per pass through the event
+				 * loop. NULL means that there is no delayed
+				 * expose event. */
+    struct TkWindowEvent *delayedConfigurePtr;
+				/* Points to a malloc-ed ConfigureNotify
+				 * event whose processing has been delayed so
+				 * that a later configure event for the same
+				 * window can supersede it, leaving only the
+				 * final geometry of a resize sequence to be
+				 * processed. NULL means that there is no
+				 * delayed configure event. */
 
     /*
      * Information used by tkFocus.c only:
@@ -364,6 +409,36 @@ typedef struct TkDisplay {
     Tcl_HashTable gcIdTable;    /* Maps from a GC to a TkGC. */
     int gcInit;			/* 0 means the tables below need
 				 * initializing. */
+    struct TkGC *gcIdleHeadPtr;	/* Most recently released GC with no
+				 * references, or NULL.  Idle GCs are kept
+				 * alive so a widget reconfigure that
+				 * recreates the same GC becomes a cache hit
+				 * instead of an XFreeGC/XCreateGC pair. */
+    struct TkGC *gcIdleTailPtr;	/* Least recently released idle GC; evicted
+				 * first when gcIdleCount exceeds
+				 * gcIdleLimit. */
+    int gcIdleCount;		/* Number of GCs on the idle list. */
+    int gcIdleLimit;		/* Maximum number of idle GCs to retain; 0
+				 * means free unreferenced GCs immediately.
+				 * Set via [tk gcstats limit]. */
+    int gcCount;		/* Total number of GCs in the cache,
+				 * including idle ones. */
+    Tcl_WideInt gcHits;		/* Number of Tk_GetGC calls satisfied from
+				 * the cache. */
+    Tcl_WideInt gcMisses;	/* Number of Tk_GetGC calls that had to
+				 * create a GC. */
+    Tcl_WideInt gcEvictions;	/* Number of idle GCs evicted to stay within
+				 * gcIdleLimit. */
+
+    /*
+     * Information used by tkWindow.c for reusing double-buffer pixmaps:
+     */
+
+    struct TkPaintBuffer *paintBufferPtr;
+				/* First in list of off-screen pixmaps retained
+				 * for reuse by display procedures, most
+				 * recently used first, or NULL. */
+    int paintBufferCount;	/* Number of entries on that list. */
 
     /*
      * Information used by tkGeometry.c only:
@@ -528,6 +603,27 @@ typedef struct TkDisplay {
 
     TkColormap *cmapPtr;	/* First in list of all non-default colormaps
 				 * allocated for this display. */
+    Tcl_HashTable visualTable;	/* Maps from visual specifications (screen
+				 * number followed by the -visual string) to
+				 * cached Tk_GetVisual results, so repeated
+				 * use of the same specification doesn't
+				 * query the server every time. */
+    int visualTableInit;	/* 0 means visualTable needs initialization. */
+
+    /*
+     * Information used by tkWindow.c to batch sibling restack requests (see
+     * TkRestackWindow):
+     */
+
+    struct TkWindow **restackPtr;
+				/* Array of windows with a deferred restack
+				 * request pending (each has
+				 * TK_RESTACK_PENDING set). Malloc'd, may be
+				 * NULL. */
+    int numRestack;		/* Number of windows in restackPtr. */
+    int maxRestack;		/* Number of slots allocated in restackPtr. */
+    int restackIdle;		/* 1 means an idle handler is scheduled to
+				 * flush the pending restacks. */
 
     /*
      * Miscellaneous information:
@@ -578,11 +674,25 @@ typedef struct TkDisplay {
  *	Whether to use input methods for this display
  *  TK_DISPLAY_WM_TRACING:		(default off)
  *	Whether we should do wm tracing on this display.
+ *  TK_DISPLAY_XSHM:			(default off)
+ *	Whether the MIT-SHM extension may be used for image transfers to
+ *	this display.  Negotiated when the display is opened (unix only;
+ *	see tkUnixShm.c).
+ *  TK_DISPLAY_XRENDER:			(default off)
+ *	Whether the RENDER extension may be used to paint gradients on
+ *	this display.  Negotiated when the display is opened (unix only;
+ *	see tkUnixGradient.c).
+ *  TK_DISPLAY_IM_INITIALIZED:		(default off)
+ *	Whether the deferred input method setup has run for this display
+ *	(unix only; see tkUnixEvent.c).
  */
 
 #define TK_DISPLAY_COLLAPSE_MOTION_EVENTS	(1 << 0)
 #define TK_DISPLAY_USE_IM			(1 << 1)
 #define TK_DISPLAY_WM_TRACING			(1 << 3)
+#define TK_DISPLAY_XSHM				(1 << 4)
+#define TK_DISPLAY_XRENDER			(1 << 5)
+#define TK_DISPLAY_IM_INITIALIZED		(1 << 6)
 
 /*
  * One of the following structures exists for each error handler created by a
@@ -613,6 +723,20 @@ typedef struct TkErrorHandler {
 				 * display, or NULL for end of list. */
 } TkErrorHandler;
 
+/*
+ * A lightweight ignore-all error trap whose handler record is supplied by
+ * the caller (normally on the stack), so that bracketing a few X requests
+ * with an error trap involves no memory allocation at all. Pushed and
+ * popped in LIFO order by TkPushErrorGuard and TkPopErrorGuard; managed by
+ * tkError.c.
+ */
+
+typedef struct TkErrorGuard {
+    TkErrorHandler handler;	/* Embedded handler record; linked into the
+				 * display's handler list while the guard is
+				 * pushed. */
+} TkErrorGuard;
+
 /*
  * One of the following structures exists for each event handler created by
  * calling Tk_CreateEventHandler. This information is used by tkEvent.c only.
@@ -919,13 +1043,24 @@ typedef struct {
                             /* translated characters */
     unsigned char nbytes;
 #elif !defined(MAC_OSX_TK)
+#   define TK_KEY_VALUE_SPACE 16
     char *charValuePtr;		/* A pointer to a string that holds the key's
 				 * %A substitution text (before backslash
 				 * adding), or NULL if that has not been
-				 * computed yet. If non-NULL, this string was
-				 * allocated with ckalloc(). */
-    Tcl_Size charValueLen;	/* Length of string in charValuePtr when that
-				 * is non-NULL. */
+				 * computed yet or the text is short enough to
+				 * live in charValueBuf. If non-NULL, this
+				 * string was allocated with ckalloc(). */
+    Tcl_Size charValueLen;	/* Length of the substitution text when it has
+				 * been computed. */
+    int charValueInline;	/* 1 means the substitution text has been
+				 * computed and lives in charValueBuf rather
+				 * than in heap memory; keystrokes almost
+				 * always produce only a few bytes, and the
+				 * inline copy survives the structure copies
+				 * that queued events undergo. */
+    char charValueBuf[TK_KEY_VALUE_SPACE];
+				/* Inline storage for short substitution
+				 * text. */
     KeySym keysym;		/* Key symbol computed after input methods
 				 * have been invoked */
 #endif
@@ -1087,11 +1222,13 @@ MODULE_SCOPE const TkObjType tkTextIndexType;
 
 MODULE_SCOPE const Tk_SmoothMethod tkBezierSmoothMethod;
 MODULE_SCOPE Tk_ImageType	tkBitmapImageType;
+MODULE_SCOPE Tk_ImageType	tkGradientImageType;
 MODULE_SCOPE Tk_PhotoImageFormatVersion3 tkImgFmtGIF;
 MODULE_SCOPE void		(*tkHandleEventProc) (XEvent* eventPtr);
 MODULE_SCOPE Tk_PhotoImageFormat tkImgFmtDefault;
 MODULE_SCOPE Tk_PhotoImageFormatVersion3 tkImgFmtPNG;
 MODULE_SCOPE Tk_PhotoImageFormat tkImgFmtPPM;
+MODULE_SCOPE Tk_PhotoImageFormat tkImgFmtRaw;
 MODULE_SCOPE Tk_PhotoImageFormat tkImgFmtSVGnano;
 MODULE_SCOPE TkMainInfo		*tkMainWindowList;
 MODULE_SCOPE Tk_ImageType	tkPhotoImageType;
@@ -1209,8 +1346,113 @@ MODULE_SCOPE int	TkSetGeometryContainer(Tcl_Interp *interp,
 			    Tk_Window tkwin, const char *name);
 MODULE_SCOPE void	TkFreeGeometryContainer(Tk_Window tkwin,
 			    const char *name);
+MODULE_SCOPE int	TkScrollbarUpdate(Tcl_Interp *interp,
+			    const char *cmdPrefix, double first, double last);
+
+/*
+ * Tiers for idle callbacks scheduled with TkDoWhenIdle. Lower tiers run
+ * first: geometry recalculation, then widget repaints, then deferred
+ * background work.
+ */
+
+#define TK_IDLE_LAYOUT		0
+#define TK_IDLE_DISPLAY		1
+#define TK_IDLE_DEFERRED	2
+#define TK_IDLE_NUM_TIERS	3
 
 MODULE_SCOPE void	TkEventInit(void);
+MODULE_SCOPE Tcl_Obj *	TkEventGetStatsObj(void);
+MODULE_SCOPE void	TkDoWhenIdle(Tcl_IdleProc *proc,
+			    ClientData clientData, int tier);
+MODULE_SCOPE void	TkCancelDoWhenIdle(Tcl_IdleProc *proc,
+			    ClientData clientData);
+MODULE_SCOPE void	TkIdleFreeze(void);
+MODULE_SCOPE void	TkIdleThaw(void);
+MODULE_SCOPE void	TkIdleDrain(void);
+MODULE_SCOPE void	TkEventResetStats(void);
+
+/*
+ * Counters for grab filtering and synthetic crossing-event generation on
+ * the pointer-event path, reported under the "pointer" key of
+ * [tk eventstats]. Plain increments on the hot paths; maintained by
+ * tkGrab.c and tkPointer.c.
+ */
+
+typedef struct {
+    Tcl_WideInt filtered;	/* Pointer events dropped by grab
+				 * filtering. */
+    Tcl_WideInt retargeted;	/* Pointer events rewritten to another
+				 * window and requeued. */
+    Tcl_WideInt transfers;	/* Synthetic crossing/focus transfers
+				 * performed by TkInOutEvents. */
+    Tcl_WideInt synthesized;	/* Individual synthetic events queued. */
+    Tcl_WideInt skipped;	/* Crossing checks resolved without
+				 * generating events, using the cached
+				 * grab-subtree position. */
+} TkPointerStats;
+
+MODULE_SCOPE TkPointerStats tkPointerStats;
+MODULE_SCOPE Tcl_Obj *	TkPointerGetStatsObj(void);
+MODULE_SCOPE void	TkPointerResetStats(void);
+MODULE_SCOPE void	TkFrameClockAddCallback(Tcl_Interp *interp,
+			    Tcl_Obj *scriptObj);
+MODULE_SCOPE int	TkFrameClockGet(void);
+MODULE_SCOPE int	TkFrameClockGetInterval(void);
+MODULE_SCOPE void	TkFrameClockSet(int onOff);
+MODULE_SCOPE void	TkFrameClockSetInterval(int interval);
+MODULE_SCOPE Tcl_Obj *	TkGCGetStatsObj(TkDisplay *dispPtr);
+MODULE_SCOPE int	TkPaintGetFlash(void);
+MODULE_SCOPE Tcl_Obj *	TkPaintGetStatsObj(void);
+MODULE_SCOPE int	TkPaintRecording(void);
+MODULE_SCOPE void	TkPaintResetStats(void);
+MODULE_SCOPE void	TkPaintSetFlash(int onOff);
+MODULE_SCOPE void	TkPaintSetRecording(int onOff);
+MODULE_SCOPE void	TkRecordPaint(Tk_Window tkwin,
+			    const Tcl_Time *startPtr, int x, int y,
+			    int width, int height);
+MODULE_SCOPE void	TkPushErrorGuard(Display *display,
+			    TkErrorGuard *guardPtr);
+MODULE_SCOPE void	TkPopErrorGuard(TkErrorGuard *guardPtr);
+MODULE_SCOPE void	TkSetDashes(Display *display, GC gc, int dashOffset,
+			    const char *dashList, int number);
+MODULE_SCOPE int	TkGCGetIdleLimit(TkDisplay *dispPtr);
+MODULE_SCOPE void	TkGCSetIdleLimit(TkDisplay *dispPtr, int limit);
+MODULE_SCOPE Tcl_Obj *	TkGetStartupPhasesObj(void);
+MODULE_SCOPE void	TkRecordStartupPhase(const char *name);
+MODULE_SCOPE void	TkReportStartupPhases(void);
+MODULE_SCOPE void	TkRestackDeadWindow(TkWindow *winPtr);
+MODULE_SCOPE void	TkRestackFlush(TkDisplay *dispPtr);
+MODULE_SCOPE int	TkRestackWindow(Tk_Window tkwin, int aboveBelow,
+			    Tk_Window other, int defer);
+MODULE_SCOPE int	TkWindowObscured(TkWindow *winPtr);
+MODULE_SCOPE int	TkWindowAreaObscured(TkWindow *winPtr, int x1,
+			    int y1, int x2, int y2);
+MODULE_SCOPE int	TkWmTransactionBegin(Tcl_Interp *interp,
+			    TkWindow *winPtr);
+MODULE_SCOPE int	TkWmTransactionCommit(Tcl_Interp *interp,
+			    TkWindow *winPtr);
+MODULE_SCOPE Pixmap	TkGetPaintBuffer(Tk_Window tkwin, int width,
+			    int height);
+MODULE_SCOPE void	TkReleasePaintBuffer(Tk_Window tkwin, Pixmap pixmap);
+
+/*
+ * Subsystem tags for the opt-in allocation accounting layer in tkUtil.c;
+ * see TkMemAlloc.
+ */
+
+#define TK_MEM_CANVAS	0
+#define TK_MEM_TEXT	1
+#define TK_MEM_FONT	2
+#define TK_MEM_IMAGE	3
+#define TK_MEM_TTK	4
+#define TK_MEM_OTHER	5
+#define TK_MEM_NTAGS	6
+
+MODULE_SCOPE void *	TkMemAlloc(int tag, size_t size);
+MODULE_SCOPE void *	TkMemRealloc(int tag, void *ptr, size_t size);
+MODULE_SCOPE void	TkMemFree(void *ptr);
+MODULE_SCOPE Tcl_Obj *	TkMemGetStatsObj(void);
+MODULE_SCOPE void	TkMemResetStats(void);
 MODULE_SCOPE void	TkRegisterObjTypes(void);
 MODULE_SCOPE Tcl_ObjCmdProc TkDeadAppObjCmd;
 MODULE_SCOPE int	TkCanvasGetCoordObj(Tcl_Interp *interp,
@@ -1270,6 +1512,15 @@ MODULE_SCOPE void	TkpCreateBusy(Tk_FakeWin *winPtr, Tk_Window tkRef,
 			    TkBusy busy);
 MODULE_SCOPE int	TkBackgroundEvalObjv(Tcl_Interp *interp,
 			    Tcl_Size objc, Tcl_Obj *const *objv, int flags);
+MODULE_SCOPE Tcl_Size	TkBase64Decode(const unsigned char *src,
+			    Tcl_Size length, unsigned char *dst);
+MODULE_SCOPE Tcl_Obj *	TkBitmapCacheStatsObj(TkDisplay *dispPtr);
+typedef void (TkBlinkProc)(void *clientData, int on);
+MODULE_SCOPE void	TkBlinkAdd(TkBlinkProc *proc, void *clientData,
+			    int onTime, int offTime);
+MODULE_SCOPE void	TkBlinkRemove(TkBlinkProc *proc, void *clientData);
+MODULE_SCOPE Tcl_Obj *	TkCursorCacheStatsObj(TkDisplay *dispPtr);
+MODULE_SCOPE void	TkScalingChanged(void);
 MODULE_SCOPE Tcl_Command TkMakeEnsemble(Tcl_Interp *interp,
 			    const char *nsname, const char *name,
 			    void *clientData, const TkEnsemble *map);
@@ -51,9 +51,30 @@ typedef struct {
     char *listVarName;		/* List variable name */
     Tcl_Obj *listObj;		/* Pointer to the list object being used */
     Tcl_Size nElements;		/* Holds the current count of elements */
+    char *dataCmd;		/* In virtual mode, script evaluated to fetch
+				 * ranges of elements on demand.  Malloc-ed.
+				 * NULL means the listbox is not virtual. */
+    int dataSize;		/* Number of virtual elements announced by
+				 * the -datasize option. */
+    Tcl_Obj *fetchedObj;	/* Most recently fetched range of virtual
+				 * elements (a list object), or NULL. */
+    int fetchedFirst;		/* Index of the first element held in
+				 * fetchedObj. */
+    int fetchedLast;		/* Index of the last element held in
+				 * fetchedObj; less than fetchedFirst when
+				 * nothing is cached. */
     Tcl_HashTable *selection;	/* Tracks selection */
     Tcl_HashTable *itemAttrTable;
 				/* Tracks item attributes */
+    Tcl_HashTable *widthTable;	/* Histogram of element pixel widths (width
+				 * -> number of elements with that width),
+				 * used to maintain maxWidth incrementally
+				 * across inserts and deletes. */
+    int widthTableValid;	/* Non-zero means widthTable is in sync with
+				 * the current elements and font.  Zero in
+				 * virtual mode and after bulk changes, in
+				 * which case maxWidth is recomputed by a
+				 * full scan. */
 
     /*
      * Information used when displaying widget:
@@ -90,6 +111,10 @@ typedef struct {
 				 * display. */
     int topIndex;		/* Index of top-most element visible in
 				 * window. */
+    int redrawFirst;		/* Index of first element that may need to be
+				 * redrawn, or -1 if no damage is recorded.
+				 * Maintained by EventuallyRedrawRange. */
+    int redrawLast;		/* Index of last such element. */
     int fullLines;		/* Number of lines that are completely
 				 * visible in window. There may be one
 				 * additional line at the bottom that is
@@ -201,6 +226,10 @@ typedef struct {
  *				input focus.
  * MAXWIDTH_IS_STALE:		Stored maxWidth may be out-of-date.
  * LISTBOX_DELETED:		This listbox has been effectively destroyed.
+ * REDRAW_FULL:			Non-zero means the next redraw must repaint the
+ *				whole window (borders, highlight and all), not
+ *				just the elements recorded in redrawFirst and
+ *				redrawLast.
  */
 
 #define REDRAW_PENDING		1
@@ -209,6 +238,23 @@ typedef struct {
 #define GOT_FOCUS		8
 #define MAXWIDTH_IS_STALE	16
 #define LISTBOX_DELETED		32
+#define REDRAW_FULL		64
+
+/*
+ * A listbox operates in virtual mode when a -datacommand has been set;
+ * elements are then supplied by the callback instead of being stored in the
+ * internal list object.
+ */
+
+#define LISTBOX_IS_VIRTUAL(listPtr)	((listPtr)->dataCmd != NULL)
+
+/*
+ * The number of elements requested from the -datacommand callback in one
+ * call.  Fetching a band starting at the first element needed keeps the
+ * callback overhead low while scrolling line by line.
+ */
+
+#define LISTBOX_FETCH_CHUNK	256
 
 /*
  * The following enum is used to define a type for the -state option of the
@@ -250,6 +296,12 @@ static const Tk_OptionSpec optionSpecs[] = {
     {TK_OPTION_CURSOR, "-cursor", "cursor", "Cursor",
 	 DEF_LISTBOX_CURSOR, TCL_INDEX_NONE, offsetof(Listbox, cursor),
 	 TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_STRING, "-datacommand", "dataCommand", "DataCommand",
+	 DEF_LISTBOX_DATA_COMMAND, TCL_INDEX_NONE, offsetof(Listbox, dataCmd),
+	 TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_INT, "-datasize", "dataSize", "DataSize",
+	 DEF_LISTBOX_DATA_SIZE, TCL_INDEX_NONE, offsetof(Listbox, dataSize),
+	 0, 0, 0},
     {TK_OPTION_COLOR, "-disabledforeground", "disabledForeground",
 	 "DisabledForeground", DEF_LISTBOX_DISABLED_FG, TCL_INDEX_NONE,
 	 offsetof(Listbox, dfgColorPtr), TK_OPTION_NULL_OK, 0, 0},
@@ -393,6 +445,9 @@ static Tcl_FreeProc	DestroyListbox;
 static void		DestroyListboxOptionTables(void *clientData,
 			    Tcl_Interp *interp);
 static void		DisplayListbox(void *clientData);
+static Tcl_Obj *	ListboxElement(Listbox *listPtr, int index);
+static void		ListboxFetchRange(Listbox *listPtr, int first,
+			    int last);
 static int		GetListboxIndex(Tcl_Interp *interp, Listbox *listPtr,
 			    Tcl_Obj *index, int endIsSize, int *indexPtr);
 static int		ListboxInsertSubCmd(Listbox *listPtr,
@@ -406,6 +461,7 @@ static Tcl_Size	ListboxFetchSelection(void *clientData,
 			    Tcl_Size offset, char *buffer, Tcl_Size maxBytes);
 static void		ListboxLostSelection(void *clientData);
 static void		GenerateListboxSelectEvent(Listbox *listPtr);
+static void		EventuallyRedrawAll(Listbox *listPtr);
 static void		EventuallyRedrawRange(Listbox *listPtr,
 			    Tcl_Size first, Tcl_Size last);
 static void		ListboxScanTo(Listbox *listPtr, int x, int y);
@@ -413,6 +469,8 @@ static int		ListboxSelect(Listbox *listPtr,
 			    int first, int last, int select);
 static void		ListboxUpdateHScrollbar(Listbox *listPtr);
 static void		ListboxUpdateVScrollbar(Listbox *listPtr);
+static void		ListboxWidthAdd(Listbox *listPtr, int pixelWidth);
+static void		ListboxWidthRemove(Listbox *listPtr, int pixelWidth);
 static int		ListboxWidgetObjCmd(void *clientData,
 			    Tcl_Interp *interp, int objc,
 			    Tcl_Obj *const objv[]);
@@ -522,6 +580,8 @@ Tk_ListboxObjCmd(
     listPtr			 = (Listbox *)ckalloc(sizeof(Listbox));
     memset(listPtr, 0, sizeof(Listbox));
 
+    listPtr->redrawFirst	 = -1;
+    listPtr->redrawLast		 = -1;
     listPtr->tkwin		 = tkwin;
     listPtr->display		 = Tk_Display(tkwin);
     listPtr->interp		 = interp;
@@ -534,6 +594,8 @@ Tk_ListboxObjCmd(
     Tcl_InitHashTable(listPtr->selection, TCL_ONE_WORD_KEYS);
     listPtr->itemAttrTable	 = (Tcl_HashTable *)ckalloc(sizeof(Tcl_HashTable));
     Tcl_InitHashTable(listPtr->itemAttrTable, TCL_ONE_WORD_KEYS);
+    listPtr->widthTable		 = (Tcl_HashTable *)ckalloc(sizeof(Tcl_HashTable));
+    Tcl_InitHashTable(listPtr->widthTable, TCL_ONE_WORD_KEYS);
     listPtr->relief		 = TK_RELIEF_RAISED;
     listPtr->textGC		 = NULL;
     listPtr->selFgColorPtr	 = NULL;
@@ -545,6 +607,8 @@ Tk_ListboxObjCmd(
     listPtr->state		 = STATE_NORMAL;
     listPtr->gray		 = None;
     listPtr->justify             = TK_JUSTIFY_LEFT;
+    listPtr->fetchedFirst	 = 0;
+    listPtr->fetchedLast	 = -1;
 
     /*
      * Keep a hold of the associated tkwin until we destroy the listbox,
@@ -738,6 +802,15 @@ ListboxWidgetObjCmd(
 	    break;
 	}
 
+	if (LISTBOX_IS_VIRTUAL(listPtr)) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "cannot delete from a listbox with a -datacommand",
+		    TCL_INDEX_NONE));
+	    Tcl_SetErrorCode(interp, "TK", "LISTBOX", "VIRTUAL", (char *)NULL);
+	    result = TCL_ERROR;
+	    break;
+	}
+
 	result = GetListboxIndex(interp, listPtr, objv[2], 0, &first);
 	if (result != TCL_OK) {
 	    break;
@@ -806,6 +879,37 @@ ListboxWidgetObjCmd(
 	    result = TCL_OK;
 	    break;
 	}
+	if (LISTBOX_IS_VIRTUAL(listPtr)) {
+	    /*
+	     * Virtual mode: fetch the requested elements through the
+	     * -datacommand callback.  Elements the callback did not supply
+	     * are reported as empty strings.
+	     */
+
+	    Tcl_Obj *el;
+
+	    if (objc == 3) {
+		el = ListboxElement(listPtr, first);
+		if (!(listPtr->flags & LISTBOX_DELETED)) {
+		    Tcl_SetObjResult(interp, (el != NULL) ? el : Tcl_NewObj());
+		}
+	    } else {
+		Tcl_Obj *resultObj = Tcl_NewListObj(0, NULL);
+		int idx;
+
+		for (idx = first; idx <= last; idx++) {
+		    el = ListboxElement(listPtr, idx);
+		    if (listPtr->flags & LISTBOX_DELETED) {
+			break;
+		    }
+		    Tcl_ListObjAppendElement(NULL, resultObj,
+			    (el != NULL) ? el : Tcl_NewObj());
+		}
+		Tcl_SetObjResult(interp, resultObj);
+	    }
+	    result = TCL_OK;
+	    break;
+	}
 	result = Tcl_ListObjGetElements(interp, listPtr->listObj, &listLen,
 		&elemPtrs);
 	if (result != TCL_OK) {
@@ -846,6 +950,15 @@ ListboxWidgetObjCmd(
 	    break;
 	}
 
+	if (LISTBOX_IS_VIRTUAL(listPtr)) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "cannot insert into a listbox with a -datacommand",
+		    TCL_INDEX_NONE));
+	    Tcl_SetErrorCode(interp, "TK", "LISTBOX", "VIRTUAL", (char *)NULL);
+	    result = TCL_ERROR;
+	    break;
+	}
+
 	result = GetListboxIndex(interp, listPtr, objv[2], 1, &index);
 	if (result != TCL_OK) {
 	    break;
@@ -1096,7 +1209,7 @@ ListboxBboxSubCmd(
     if ((listPtr->topIndex <= index) && (index < lastVisibleIndex)) {
 	Tcl_Obj *el, *results[4];
 	const char *stringRep;
-	int pixelWidth, x, y, result;
+	int pixelWidth, x, y;
 	Tcl_Size stringLen;
 	Tk_FontMetrics fm;
 
@@ -1104,12 +1217,16 @@ ListboxBboxSubCmd(
 	 * Compute the pixel width of the requested element.
 	 */
 
-	result = Tcl_ListObjIndex(interp, listPtr->listObj, index, &el);
-	if (result != TCL_OK) {
-	    return result;
+	el = ListboxElement(listPtr, index);
+	if (listPtr->flags & LISTBOX_DELETED) {
+	    return TCL_OK;
+	}
+	if (el != NULL) {
+	    stringRep = Tcl_GetStringFromObj(el, &stringLen);
+	} else {
+	    stringRep = "";
+	    stringLen = 0;
 	}
-
-	stringRep = Tcl_GetStringFromObj(el, &stringLen);
 	Tk_GetFontMetrics(listPtr->tkfont, &fm);
 	pixelWidth = Tk_TextWidth(listPtr->tkfont, stringRep, stringLen);
 
@@ -1457,6 +1574,11 @@ DestroyListbox(
 	listPtr->listObj = NULL;
     }
 
+    if (listPtr->fetchedObj != NULL) {
+	Tcl_DecrRefCount(listPtr->fetchedObj);
+	listPtr->fetchedObj = NULL;
+    }
+
     if (listPtr->listVarName != NULL) {
 	Tcl_UntraceVar2(listPtr->interp, listPtr->listVarName, NULL,
 		TCL_GLOBAL_ONLY|TCL_TRACE_WRITES|TCL_TRACE_UNSETS,
@@ -1470,6 +1592,13 @@ DestroyListbox(
     Tcl_DeleteHashTable(listPtr->selection);
     ckfree(listPtr->selection);
 
+    /*
+     * Free the element width histogram.
+     */
+
+    Tcl_DeleteHashTable(listPtr->widthTable);
+    ckfree(listPtr->widthTable);
+
     /*
      * Free the item attribute hash table.
      */
@@ -1603,6 +1732,19 @@ ConfigureListbox(
 	}
 	listPtr->inset = listPtr->highlightWidth + listPtr->borderWidth;
 
+	/*
+	 * The -datacommand and -listvariable options are mutually
+	 * exclusive: a virtual listbox has no stored list to mirror.
+	 */
+
+	if ((listPtr->dataCmd != NULL) && (listPtr->listVarName != NULL)) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "cannot set -listvariable and -datacommand at the same time",
+		    TCL_INDEX_NONE));
+	    Tcl_SetErrorCode(interp, "TK", "LISTBOX", "VIRTUAL", (char *)NULL);
+	    continue;
+	}
+
 	/*
 	 * Claim the selection if we've suddenly started exporting it and
 	 * there is a selection to export and this interp is unsafe.
@@ -1676,10 +1818,23 @@ ConfigureListbox(
     }
 
     /*
-     * Make sure that the list length is correct.
+     * Make sure that the list length is correct.  In virtual mode the
+     * -datasize option announces the element count, and any cached range is
+     * dropped since the data source may have changed.
      */
 
-    Tcl_ListObjLength(listPtr->interp, listPtr->listObj, &listPtr->nElements);
+    if (LISTBOX_IS_VIRTUAL(listPtr)) {
+	listPtr->nElements = (listPtr->dataSize > 0) ? listPtr->dataSize : 0;
+    } else {
+	Tcl_ListObjLength(listPtr->interp, listPtr->listObj,
+		&listPtr->nElements);
+    }
+    if (listPtr->fetchedObj != NULL) {
+	Tcl_DecrRefCount(listPtr->fetchedObj);
+	listPtr->fetchedObj = NULL;
+	listPtr->fetchedFirst = 0;
+	listPtr->fetchedLast = -1;
+    }
 
     if (error) {
 	Tcl_SetObjResult(interp, errorResult);
@@ -1812,9 +1967,153 @@ ListboxWorldChanged(
 
     ListboxComputeGeometry(listPtr, 1, 1, 1);
     listPtr->flags |= UPDATE_V_SCROLLBAR|UPDATE_H_SCROLLBAR;
-    EventuallyRedrawRange(listPtr, 0, listPtr->nElements-1);
+    EventuallyRedrawAll(listPtr);
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * ListboxFetchRange --
+ *
+ *	Evaluates the -datacommand callback of a virtual listbox to obtain
+ *	the elements with indices first through last, and caches the result
+ *	in the fetchedObj field.  Errors in the callback are reported via
+ *	Tcl_BackgroundException and leave an empty cache for the requested
+ *	range, so that the callback is not re-run for every element of a
+ *	range that already failed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Evaluates a Tcl script, which may do anything, including destroying
+ *	the listbox; callers must check the LISTBOX_DELETED flag afterwards.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ListboxFetchRange(
+    Listbox *listPtr,		/* Virtual listbox of interest. */
+    int first,			/* Index of first element to fetch. */
+    int last)			/* Index of last element to fetch. */
+{
+    Tcl_Interp *interp = listPtr->interp;
+    Tcl_Obj *cmdObj, *resultObj;
+    Tcl_Size length;
+    int code;
+
+    if (first < 0) {
+	first = 0;
+    }
+    if (last >= (int)listPtr->nElements) {
+	last = listPtr->nElements - 1;
+    }
+    if (listPtr->fetchedObj != NULL) {
+	Tcl_DecrRefCount(listPtr->fetchedObj);
+	listPtr->fetchedObj = NULL;
+    }
+    listPtr->fetchedFirst = first;
+    listPtr->fetchedLast = first - 1;
+    if (last < first) {
+	return;
+    }
+
+    cmdObj = Tcl_NewStringObj(listPtr->dataCmd, TCL_INDEX_NONE);
+    Tcl_ListObjAppendElement(NULL, cmdObj, TkNewIndexObj(first));
+    Tcl_ListObjAppendElement(NULL, cmdObj, TkNewIndexObj(last));
+    Tcl_IncrRefCount(cmdObj);
+    Tcl_Preserve(listPtr);
+    code = Tcl_EvalObjEx(interp, cmdObj, TCL_EVAL_GLOBAL);
+    Tcl_DecrRefCount(cmdObj);
+    if (listPtr->flags & LISTBOX_DELETED) {
+	Tcl_Release(listPtr);
+	return;
+    }
+    Tcl_Release(listPtr);
+
+    resultObj = Tcl_GetObjResult(interp);
+    Tcl_IncrRefCount(resultObj);
+    Tcl_ResetResult(interp);
+    if ((code != TCL_OK)
+	    || (Tcl_ListObjLength(interp, resultObj, &length) != TCL_OK)) {
+	Tcl_AddErrorInfo(interp, "\n    (-datacommand callback)");
+	Tcl_BackgroundException(interp, TCL_ERROR);
+	Tcl_DecrRefCount(resultObj);
+
+	/*
+	 * Cache an empty list for the whole range, so that the failing
+	 * callback is not retried once per element.
+	 */
+
+	resultObj = Tcl_NewObj();
+	Tcl_IncrRefCount(resultObj);
+	listPtr->fetchedObj = resultObj;
+	listPtr->fetchedLast = last;
+	return;
+    }
+    listPtr->fetchedObj = resultObj;
+    listPtr->fetchedLast = first + (int)length - 1;
+    if (listPtr->fetchedLast < last) {
+	/*
+	 * The callback returned fewer elements than requested; remember the
+	 * whole range anyway so that missing elements read as empty strings
+	 * rather than causing another fetch.
+	 */
+
+	listPtr->fetchedLast = last;
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ListboxElement --
+ *
+ *	Returns the element of the listbox with the given index.  For an
+ *	ordinary listbox this is a plain lookup in the internal list object;
+ *	for a virtual listbox the element is taken from the cached fetched
+ *	range, running the -datacommand callback if the index is not
+ *	currently cached.
+ *
+ * Results:
+ *	The element, or NULL if it is not available (out of range, or not
+ *	supplied by the callback).  Callers in virtual mode must check the
+ *	LISTBOX_DELETED flag after calling, since the callback may have
+ *	destroyed the widget.
+ *
+ * Side effects:
+ *	May evaluate the -datacommand callback.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static Tcl_Obj *
+ListboxElement(
+    Listbox *listPtr,		/* Listbox of interest. */
+    int index)			/* Index of desired element. */
+{
+    Tcl_Obj *el = NULL;
+
+    if (!LISTBOX_IS_VIRTUAL(listPtr)) {
+	Tcl_ListObjIndex(NULL, listPtr->listObj, index, &el);
+	return el;
+    }
+    if ((listPtr->fetchedObj == NULL) || (index < listPtr->fetchedFirst)
+	    || (index > listPtr->fetchedLast)) {
+	ListboxFetchRange(listPtr, index, index + LISTBOX_FETCH_CHUNK - 1);
+	if (listPtr->flags & LISTBOX_DELETED) {
+	    return NULL;
+	}
+    }
+    if ((listPtr->fetchedObj != NULL) && (index >= listPtr->fetchedFirst)
+	    && (index <= listPtr->fetchedLast)) {
+	Tcl_ListObjIndex(NULL, listPtr->fetchedObj,
+		index - listPtr->fetchedFirst, &el);
+    }
+    return el;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -1853,9 +2152,11 @@ DisplayListbox(
 				 * off-screen. */
     Pixmap pixmap;
     int textWidth;
+    int drawFirst, drawLast, stripY, stripHeight, fullRedraw;
 
     listPtr->flags &= ~REDRAW_PENDING;
-    if (listPtr->flags & LISTBOX_DELETED) {
+    if ((listPtr->flags & LISTBOX_DELETED)
+	    || TkWindowObscured((TkWindow *) tkwin)) {
 	return;
     }
 
@@ -1880,34 +2181,118 @@ DisplayListbox(
 	    return;
 	}
     }
-    listPtr->flags &= ~(REDRAW_PENDING|UPDATE_V_SCROLLBAR|UPDATE_H_SCROLLBAR);
-    Tcl_Release(listPtr);
+    if (LISTBOX_IS_VIRTUAL(listPtr)) {
+	/*
+	 * Fetch the visible range up front, so that the -datacommand
+	 * callback normally does not run in the middle of drawing.
+	 */
+
+	limit = listPtr->topIndex + listPtr->fullLines + listPtr->partialLine
+		- 1;
+	if (limit >= (int)listPtr->nElements) {
+	    limit = listPtr->nElements - 1;
+	}
+	if ((listPtr->fetchedObj == NULL)
+		|| (listPtr->topIndex < listPtr->fetchedFirst)
+		|| (limit > listPtr->fetchedLast)) {
+	    ListboxFetchRange(listPtr, listPtr->topIndex,
+		    listPtr->topIndex + LISTBOX_FETCH_CHUNK - 1);
+	}
+	if ((listPtr->flags & LISTBOX_DELETED) || !Tk_IsMapped(tkwin)) {
+	    Tcl_Release(listPtr);
+	    return;
+	}
+    }
+    /*
+     * Snapshot and reset the damage range up front: the scrollbar and
+     * -datacommand callbacks above may already have recorded new damage, and
+     * anything recorded while we draw belongs to the next repaint.
+     */
+
+    fullRedraw = ((listPtr->flags & REDRAW_FULL)
+	    || (listPtr->redrawFirst < 0));
+    drawFirst = listPtr->redrawFirst;
+    drawLast = listPtr->redrawLast;
+    listPtr->redrawFirst = -1;
+    listPtr->redrawLast = -1;
+    listPtr->flags &= ~(REDRAW_PENDING|UPDATE_V_SCROLLBAR|UPDATE_H_SCROLLBAR
+	    |REDRAW_FULL);
+
+    limit = listPtr->topIndex + listPtr->fullLines + listPtr->partialLine - 1;
+    if (limit >= (int)listPtr->nElements) {
+	limit = listPtr->nElements-1;
+    }
+    if (fullRedraw) {
+	drawFirst = listPtr->topIndex;
+	drawLast = limit;
+	stripY = 0;
+	stripHeight = Tk_Height(tkwin);
+    } else {
+	/*
+	 * Grow the range by one element on each side, because the selection
+	 * bevels of an element depend on whether its neighbors are selected.
+	 */
+
+	if (drawFirst - 1 > listPtr->topIndex) {
+	    drawFirst -= 1;
+	} else {
+	    drawFirst = listPtr->topIndex;
+	}
+	if (drawLast + 1 < limit) {
+	    drawLast += 1;
+	} else {
+	    drawLast = limit;
+	}
+	if (drawFirst > drawLast) {
+	    /*
+	     * Nothing in the damaged range is visible.
+	     */
+
+	    Tcl_Release(listPtr);
+	    return;
+	}
+	stripY = ((drawFirst - listPtr->topIndex) * listPtr->lineHeight)
+		+ listPtr->inset;
+	if (drawLast == limit) {
+	    /*
+	     * The strip reaches the last visible element; extend it to the
+	     * bottom of the window so that a partial line, or rows vacated by
+	     * a deletion, are repainted too.
+	     */
+
+	    stripHeight = Tk_Height(tkwin) - stripY;
+	} else {
+	    stripHeight = (drawLast - drawFirst + 1) * listPtr->lineHeight;
+	    if (stripY + stripHeight > Tk_Height(tkwin)) {
+		stripHeight = Tk_Height(tkwin) - stripY;
+	    }
+	}
+	if (stripHeight <= 0) {
+	    Tcl_Release(listPtr);
+	    return;
+	}
+    }
 
 #ifndef TK_NO_DOUBLE_BUFFERING
     /*
-     * Redrawing is done in a temporary pixmap that is allocated here and
-     * freed at the end of the procedure. All drawing is done to the pixmap,
-     * and the pixmap is copied to the screen at the end of the procedure.
-     * This provides the smoothest possible visual effects (no flashing on the
-     * screen).
+     * Redrawing is done in a temporary pixmap that is obtained here and
+     * released at the end of the procedure. All drawing is done to the
+     * pixmap, and the pixmap is copied to the screen at the end of the
+     * procedure. This provides the smoothest possible visual effects (no
+     * flashing on the screen).
      */
 
-    pixmap = Tk_GetPixmap(listPtr->display, Tk_WindowId(tkwin),
-	    Tk_Width(tkwin), Tk_Height(tkwin), Tk_Depth(tkwin));
+    pixmap = TkGetPaintBuffer(tkwin, Tk_Width(tkwin), Tk_Height(tkwin));
 #else
     pixmap = Tk_WindowId(tkwin);
 #endif /* TK_NO_DOUBLE_BUFFERING */
-    Tk_Fill3DRectangle(tkwin, pixmap, listPtr->normalBorder, 0, 0,
-	    Tk_Width(tkwin), Tk_Height(tkwin), 0, TK_RELIEF_FLAT);
+    Tk_Fill3DRectangle(tkwin, pixmap, listPtr->normalBorder, 0, stripY,
+	    Tk_Width(tkwin), stripHeight, 0, TK_RELIEF_FLAT);
 
     /*
-     * Display each item in the listbox.
+     * Display each damaged item in the listbox.
      */
 
-    limit = listPtr->topIndex + listPtr->fullLines + listPtr->partialLine - 1;
-    if (limit >= (int)listPtr->nElements) {
-	limit = listPtr->nElements-1;
-    }
     left = right = 0;
     if (listPtr->xOffset > 0) {
 	left = listPtr->selBorderWidth+1;
@@ -1917,8 +2302,12 @@ DisplayListbox(
 	right = listPtr->selBorderWidth+1;
     }
     prevSelected = 0;
+    if ((drawFirst > listPtr->topIndex) && (listPtr->state & STATE_NORMAL)
+	    && Tcl_FindHashEntry(listPtr->selection, KEY(drawFirst - 1))) {
+	prevSelected = 1;
+    }
 
-    for (i = listPtr->topIndex; i <= limit; i++) {
+    for (i = drawFirst; i <= drawLast; i++) {
 	int width = Tk_Width(tkwin);	/* zeroth approx to silence warning */
 
 	x = listPtr->inset;
@@ -2072,9 +2461,39 @@ DisplayListbox(
 	 * Draw the actual text of this item.
 	 */
 
-        Tcl_ListObjIndex(listPtr->interp, listPtr->listObj, i, &curElement);
-        stringRep = Tcl_GetStringFromObj(curElement, &stringLen);
-        textWidth = Tk_TextWidth(listPtr->tkfont, stringRep, stringLen);
+	curElement = ListboxElement(listPtr, i);
+	if (listPtr->flags & LISTBOX_DELETED) {
+	    /*
+	     * The -datacommand callback destroyed the listbox; there is
+	     * nothing left to draw.
+	     */
+
+	    if (freeGC) {
+		Tk_FreeGC(listPtr->display, gc);
+	    }
+#ifndef TK_NO_DOUBLE_BUFFERING
+	    TkReleasePaintBuffer(tkwin, pixmap);
+#endif /* TK_NO_DOUBLE_BUFFERING */
+	    Tcl_Release(listPtr);
+	    return;
+	}
+	if (curElement != NULL) {
+	    stringRep = Tcl_GetStringFromObj(curElement, &stringLen);
+	} else {
+	    stringRep = "";
+	    stringLen = 0;
+	}
+	textWidth = Tk_TextWidth(listPtr->tkfont, stringRep, stringLen);
+	if (LISTBOX_IS_VIRTUAL(listPtr) && (textWidth > listPtr->maxWidth)) {
+	    /*
+	     * Virtual mode only samples element widths up front; grow the
+	     * horizontal scrolling range as wider elements come into view.
+	     */
+
+	    listPtr->maxWidth = textWidth;
+	    listPtr->flags |= UPDATE_H_SCROLLBAR;
+	    EventuallyRedrawRange(listPtr, i, i);
+	}
 
 	Tk_GetFontMetrics(listPtr->tkfont, &fm);
 	y += fm.ascent + listPtr->selBorderWidth;
@@ -2195,10 +2614,11 @@ DisplayListbox(
     }
 #ifndef TK_NO_DOUBLE_BUFFERING
     XCopyArea(listPtr->display, pixmap, Tk_WindowId(tkwin),
-	    listPtr->textGC, 0, 0, (unsigned) Tk_Width(tkwin),
-	    (unsigned) Tk_Height(tkwin), 0, 0);
-    Tk_FreePixmap(listPtr->display, pixmap);
+	    listPtr->textGC, 0, stripY, (unsigned) Tk_Width(tkwin),
+	    (unsigned) stripHeight, 0, stripY);
+    TkReleasePaintBuffer(tkwin, pixmap);
 #endif /* TK_NO_DOUBLE_BUFFERING */
+    Tcl_Release(listPtr);
 }
 
 /*
@@ -2235,7 +2655,7 @@ ListboxComputeGeometry(
 				 * Tk_UnsetGrid to update gridding for the
 				 * window. */
 {
-    int width, height, pixelWidth, pixelHeight, i, result;
+    int width, height, pixelWidth, pixelHeight, i, scanLimit;
     Tcl_Size textLength;
     Tk_FontMetrics fm;
     Tcl_Obj *element;
@@ -2247,14 +2667,30 @@ ListboxComputeGeometry(
 	    listPtr->xScrollUnit = 1;
 	}
 	listPtr->maxWidth = 0;
-	for (i = 0; i < (int)listPtr->nElements; i++) {
+	Tcl_DeleteHashTable(listPtr->widthTable);
+	Tcl_InitHashTable(listPtr->widthTable, TCL_ONE_WORD_KEYS);
+	listPtr->widthTableValid = !LISTBOX_IS_VIRTUAL(listPtr);
+	scanLimit = listPtr->nElements;
+	if (LISTBOX_IS_VIRTUAL(listPtr)
+		&& (scanLimit > LISTBOX_FETCH_CHUNK)) {
+	    /*
+	     * Measuring every element would defeat the purpose of virtual
+	     * mode.  Sample the first fetch chunk here; DisplayListbox
+	     * grows maxWidth further as wider elements come into view.
+	     */
+
+	    scanLimit = LISTBOX_FETCH_CHUNK;
+	}
+	for (i = 0; i < scanLimit; i++) {
 	    /*
 	     * Compute the pixel width of the current element.
 	     */
 
-	    result = Tcl_ListObjIndex(listPtr->interp, listPtr->listObj, i,
-		    &element);
-	    if (result != TCL_OK) {
+	    element = ListboxElement(listPtr, i);
+	    if (listPtr->flags & LISTBOX_DELETED) {
+		return;
+	    }
+	    if (element == NULL) {
 		continue;
 	    }
 	    text = Tcl_GetStringFromObj(element, &textLength);
@@ -2263,6 +2699,9 @@ ListboxComputeGeometry(
 	    if (pixelWidth > listPtr->maxWidth) {
 		listPtr->maxWidth = pixelWidth;
 	    }
+	    if (listPtr->widthTableValid) {
+		ListboxWidthAdd(listPtr, pixelWidth);
+	    }
 	}
     }
 
@@ -2298,6 +2737,95 @@ ListboxComputeGeometry(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * ListboxWidthAdd --
+ *
+ *	Records one more element with the given pixel width in the width
+ *	histogram of the listbox.  The caller is responsible for growing
+ *	maxWidth if appropriate.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Updates the width histogram.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ListboxWidthAdd(
+    Listbox *listPtr,		/* Listbox of interest. */
+    int pixelWidth)		/* Width of the added element. */
+{
+    Tcl_HashEntry *entry;
+    int isNew;
+    size_t refCount;
+
+    entry = Tcl_CreateHashEntry(listPtr->widthTable, KEY(pixelWidth), &isNew);
+    refCount = isNew ? 1 : (size_t)Tcl_GetHashValue(entry) + 1;
+    Tcl_SetHashValue(entry, INT2PTR(refCount));
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ListboxWidthRemove --
+ *
+ *	Records the removal of one element with the given pixel width from
+ *	the width histogram of the listbox.  When the last element of the
+ *	current maximum width disappears, the new maxWidth is found by
+ *	scanning the remaining histogram buckets, which avoids re-measuring
+ *	every element.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Updates the width histogram and possibly maxWidth.  If the histogram
+ *	turns out to be out of sync, it is invalidated and a full
+ *	recomputation is scheduled instead.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ListboxWidthRemove(
+    Listbox *listPtr,		/* Listbox of interest. */
+    int pixelWidth)		/* Width of the removed element. */
+{
+    Tcl_HashEntry *entry;
+    Tcl_HashSearch search;
+    size_t refCount;
+    int width, newMax;
+
+    entry = Tcl_FindHashEntry(listPtr->widthTable, KEY(pixelWidth));
+    if (entry == NULL) {
+	listPtr->widthTableValid = 0;
+	listPtr->flags |= MAXWIDTH_IS_STALE;
+	return;
+    }
+    refCount = (size_t)Tcl_GetHashValue(entry) - 1;
+    if (refCount > 0) {
+	Tcl_SetHashValue(entry, INT2PTR(refCount));
+	return;
+    }
+    Tcl_DeleteHashEntry(entry);
+    if (pixelWidth == listPtr->maxWidth) {
+	newMax = 0;
+	for (entry = Tcl_FirstHashEntry(listPtr->widthTable, &search);
+		entry != NULL; entry = Tcl_NextHashEntry(&search)) {
+	    width = (int)PTR2INT(Tcl_GetHashKey(listPtr->widthTable, entry));
+	    if (width > newMax) {
+		newMax = width;
+	    }
+	}
+	listPtr->maxWidth = newMax;
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -2340,6 +2868,9 @@ ListboxInsertSubCmd(
 	if (pixelWidth > listPtr->maxWidth) {
 	    listPtr->maxWidth = pixelWidth;
 	}
+	if (listPtr->widthTableValid) {
+	    ListboxWidthAdd(listPtr, pixelWidth);
+	}
     }
 
     /*
@@ -2438,7 +2969,7 @@ ListboxDeleteSubCmd(
     int first,			/* Index of first element to delete. */
     int last)			/* Index of last element to delete. */
 {
-    int count, i, widthChanged, result, pixelWidth;
+    int count, i, widthChanged, result, pixelWidth, oldMaxWidth;
     Tcl_Size length;
     Tcl_Obj *newListObj, *element;
     const char *stringRep;
@@ -2469,6 +3000,7 @@ ListboxDeleteSubCmd(
      */
 
     widthChanged = 0;
+    oldMaxWidth = listPtr->maxWidth;
     for (i = first; i <= last; i++) {
 	/*
 	 * Remove selection information.
@@ -2487,12 +3019,20 @@ ListboxDeleteSubCmd(
 	}
 
 	/*
-	 * Check width of the element. We only have to check if widthChanged
-	 * has not already been set to 1, because we only need one maxWidth
-	 * element to disappear for us to have to recompute the width.
+	 * Check width of the element.  With a valid width histogram the
+	 * element is removed from its bucket, which recomputes maxWidth
+	 * without re-measuring the surviving elements.  Otherwise we only
+	 * have to check if widthChanged has not already been set to 1,
+	 * because we only need one maxWidth element to disappear for us to
+	 * have to recompute the width.
 	 */
 
-	if (widthChanged == 0) {
+	if (listPtr->widthTableValid) {
+	    Tcl_ListObjIndex(listPtr->interp, listPtr->listObj, i, &element);
+	    stringRep = Tcl_GetStringFromObj(element, &length);
+	    pixelWidth = Tk_TextWidth(listPtr->tkfont, stringRep, length);
+	    ListboxWidthRemove(listPtr, pixelWidth);
+	} else if (widthChanged == 0) {
 	    Tcl_ListObjIndex(listPtr->interp, listPtr->listObj, i, &element);
 	    stringRep = Tcl_GetStringFromObj(element, &length);
 	    pixelWidth = Tk_TextWidth(listPtr->tkfont, stringRep, length);
@@ -2570,6 +3110,13 @@ ListboxDeleteSubCmd(
 	if (listPtr->topIndex < 0) {
 	    listPtr->topIndex = 0;
 	}
+
+	/*
+	 * Clamping scrolled the view, so the damage range below no longer
+	 * describes everything that moved on screen.
+	 */
+
+	EventuallyRedrawAll(listPtr);
     }
     if (listPtr->active > last) {
 	listPtr->active -= count;
@@ -2581,7 +3128,17 @@ ListboxDeleteSubCmd(
 	}
     }
     listPtr->flags |= UPDATE_V_SCROLLBAR;
-    ListboxComputeGeometry(listPtr, 0, widthChanged, 0);
+    if (listPtr->widthTableValid) {
+	/*
+	 * maxWidth has already been maintained incrementally; no rescan of
+	 * the surviving elements is needed.
+	 */
+
+	widthChanged = (listPtr->maxWidth != oldMaxWidth);
+	ListboxComputeGeometry(listPtr, 0, 0, 0);
+    } else {
+	ListboxComputeGeometry(listPtr, 0, widthChanged, 0);
+    }
     if (widthChanged) {
 	listPtr->flags |= UPDATE_H_SCROLLBAR;
     }
@@ -2627,7 +3184,7 @@ ListboxEventProc(
 		Tk_UnsetGrid(listPtr->tkwin);
 	    }
 	    if (listPtr->flags & REDRAW_PENDING) {
-		Tcl_CancelIdleCall(DisplayListbox, clientData);
+		TkCancelDoWhenIdle(DisplayListbox, clientData);
 	    }
 	    Tcl_EventuallyFree(clientData, DestroyListbox);
 	}
@@ -2651,16 +3208,16 @@ ListboxEventProc(
 	 * redraw the borders), so just redraw everything for safety.
 	 */
 
-	EventuallyRedrawRange(listPtr, 0, listPtr->nElements-1);
+	EventuallyRedrawAll(listPtr);
     } else if (eventPtr->type == FocusIn) {
 	if (eventPtr->xfocus.detail != NotifyInferior) {
 	    listPtr->flags |= GOT_FOCUS;
-	    EventuallyRedrawRange(listPtr, 0, listPtr->nElements-1);
+	    EventuallyRedrawAll(listPtr);
 	}
     } else if (eventPtr->type == FocusOut) {
 	if (eventPtr->xfocus.detail != NotifyInferior) {
 	    listPtr->flags &= ~GOT_FOCUS;
-	    EventuallyRedrawRange(listPtr, 0, listPtr->nElements-1);
+	    EventuallyRedrawAll(listPtr);
 	}
     }
 }
@@ -2840,8 +3397,58 @@ ChangeListboxView(
 	index = 0;
     }
     if (listPtr->topIndex != index) {
-	listPtr->topIndex = index;
-	EventuallyRedrawRange(listPtr, 0, listPtr->nElements-1);
+	int delta = index - listPtr->topIndex;
+	int innerHeight = Tk_Height(listPtr->tkwin) - 2*listPtr->inset;
+
+	/*
+	 * When the view moves by less than a windowful, blit the rows that
+	 * stay visible into place and repaint only the rows coming into view,
+	 * so scrolling costs in proportion to the delta rather than to the
+	 * window.  Pending partial damage is recorded by element index and
+	 * stays valid across the shift; a pending full redraw makes the blit
+	 * pointless.
+	 */
+
+	if (Tk_IsMapped(listPtr->tkwin)
+		&& !TkWindowObscured((TkWindow *) listPtr->tkwin)
+		&& !(listPtr->flags & REDRAW_FULL)
+		&& (listPtr->lineHeight > 0)
+		&& (delta*listPtr->lineHeight > -innerHeight)
+		&& (delta*listPtr->lineHeight < innerHeight)) {
+	    XGCValues gcValues;
+	    GC gc;
+	    TkRegion damageRgn;
+	    XRectangle rect;
+
+	    gcValues.graphics_exposures = True;
+	    gc = Tk_GetGC(listPtr->tkwin, GCGraphicsExposures, &gcValues);
+	    damageRgn = TkCreateRegion();
+	    if (TkScrollWindow(listPtr->tkwin, gc, listPtr->inset,
+		    listPtr->inset,
+		    Tk_Width(listPtr->tkwin) - 2*listPtr->inset, innerHeight,
+		    0, -delta*listPtr->lineHeight, damageRgn)) {
+		TkClipBox(damageRgn, &rect);
+		EventuallyRedrawRange(listPtr,
+			index + (rect.y - listPtr->inset)/listPtr->lineHeight,
+			index + (rect.y + rect.height - 1 - listPtr->inset)
+			/ listPtr->lineHeight);
+	    }
+	    TkDestroyRegion(damageRgn);
+	    Tk_FreeGC(listPtr->display, gc);
+
+	    listPtr->topIndex = index;
+	    if (delta > 0) {
+		EventuallyRedrawRange(listPtr,
+			index + (innerHeight - delta*listPtr->lineHeight)
+			/ listPtr->lineHeight,
+			index + listPtr->fullLines + listPtr->partialLine - 1);
+	    } else {
+		EventuallyRedrawRange(listPtr, index, index - delta - 1);
+	    }
+	} else {
+	    listPtr->topIndex = index;
+	    EventuallyRedrawAll(listPtr);
+	}
 	listPtr->flags |= UPDATE_V_SCROLLBAR;
     }
 }
@@ -2889,7 +3496,7 @@ ChangeListboxOffset(
     if (offset != listPtr->xOffset) {
 	listPtr->xOffset = offset;
 	listPtr->flags |= UPDATE_H_SCROLLBAR;
-	EventuallyRedrawRange(listPtr, 0, listPtr->nElements-1);
+	EventuallyRedrawAll(listPtr);
     }
 }
 
@@ -3142,13 +3749,17 @@ ListboxFetchSelection(
     for (i = 0; i < (int)listPtr->nElements; i++) {
 	entry = Tcl_FindHashEntry(listPtr->selection, KEY(i));
 	if (entry != NULL) {
+	    curElement = ListboxElement(listPtr, i);
+	    if (listPtr->flags & LISTBOX_DELETED) {
+		break;
+	    }
 	    if (needNewline) {
 		Tcl_DStringAppend(&selection, "\n", 1);
 	    }
-	    Tcl_ListObjIndex(listPtr->interp, listPtr->listObj, i,
-		    &curElement);
-	    stringRep = Tcl_GetStringFromObj(curElement, &stringLen);
-	    Tcl_DStringAppend(&selection, stringRep, stringLen);
+	    if (curElement != NULL) {
+		stringRep = Tcl_GetStringFromObj(curElement, &stringLen);
+		Tcl_DStringAppend(&selection, stringRep, stringLen);
+	    }
 	    needNewline = 1;
 	}
     }
@@ -3251,12 +3862,28 @@ GenerateListboxSelectEvent(
 static void
 EventuallyRedrawRange(
     Listbox *listPtr,	/* Information about widget. */
-    TCL_UNUSED(Tcl_Size),			/* Index of first element in list that needs
+    Tcl_Size first,		/* Index of first element in list that needs
 				 * to be redrawn. */
-    TCL_UNUSED(Tcl_Size))			/* Index of last element in list that needs to
+    Tcl_Size last)		/* Index of last element in list that needs to
 				 * be redrawn. May be less than first; these
 				 * just bracket a range. */
 {
+    if (last < first) {
+	Tcl_Size tmp = first;
+
+	first = last;
+	last = tmp;
+    }
+    if (first < 0) {
+	first = 0;
+    }
+    if ((listPtr->redrawFirst < 0) || ((int)first < listPtr->redrawFirst)) {
+	listPtr->redrawFirst = (int)first;
+    }
+    if ((int)last > listPtr->redrawLast) {
+	listPtr->redrawLast = (int)last;
+    }
+
     /*
      * We don't have to register a redraw callback if one is already pending,
      * or if the window doesn't exist, or if the window isn't mapped.
@@ -3268,7 +3895,32 @@ EventuallyRedrawRange(
 	return;
     }
     listPtr->flags |= REDRAW_PENDING;
-    Tcl_DoWhenIdle(DisplayListbox, listPtr);
+    TkDoWhenIdle(DisplayListbox, listPtr, TK_IDLE_DISPLAY);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * EventuallyRedrawAll --
+ *
+ *	Ensure that the entire listbox window, including its borders and
+ *	focus highlight, is redrawn at the next idle point.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Information gets redisplayed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+EventuallyRedrawAll(
+    Listbox *listPtr)	/* Information about widget. */
+{
+    listPtr->flags |= REDRAW_FULL;
+    EventuallyRedrawRange(listPtr, 0, listPtr->nElements - 1);
 }
 
 /*
@@ -3315,6 +3967,10 @@ ListboxUpdateVScrollbar(
 	    last = 1.0;
 	}
     }
+    if (TkScrollbarUpdate(listPtr->interp, listPtr->yScrollCmd, first,
+	    last)) {
+	return;
+    }
     Tcl_PrintDouble(NULL, first, firstStr);
     Tcl_PrintDouble(NULL, last, lastStr);
 
@@ -3387,6 +4043,10 @@ ListboxUpdateHScrollbar(
 	    last = 1.0;
 	}
     }
+    if (TkScrollbarUpdate(listPtr->interp, listPtr->xScrollCmd, first,
+	    last)) {
+	return;
+    }
     Tcl_PrintDouble(NULL, first, firstStr);
     Tcl_PrintDouble(NULL, last, lastStr);
 
@@ -3558,8 +4218,9 @@ ListboxListVarProc(
      */
 
     listPtr->flags |= MAXWIDTH_IS_STALE;
+    listPtr->widthTableValid = 0;
 
-    EventuallyRedrawRange(listPtr, 0, listPtr->nElements-1);
+    EventuallyRedrawAll(listPtr);
     return NULL;
 }
 
@@ -222,6 +222,8 @@ Tk_MainEx(
 
     Tcl_InitMemory(interp);
 
+    TkRecordStartupPhase("main");
+
     is.interp = interp;
     is.gotPartial = 0;
     Tcl_Preserve(interp);
@@ -314,6 +316,7 @@ Tk_MainEx(
      * Invoke application-specific initialization.
      */
 
+    TkRecordStartupPhase("appinit");
     if (appInitProc(interp) != TCL_OK) {
 	TkpDisplayWarning(Tcl_GetString(Tcl_GetObjResult(interp)),
 		"application-specific initialization failed");
@@ -327,6 +330,7 @@ Tk_MainEx(
     path = Tcl_GetStartupScript(&encodingName);
     if (path != NULL) {
 	Tcl_ResetResult(interp);
+	TkRecordStartupPhase("script");
 	code = Tcl_FSEvalFileEx(interp, path, encodingName);
 	if (code != TCL_OK) {
 	    /*
@@ -375,6 +379,9 @@ Tk_MainEx(
      * windows left, Tk_MainLoop returns and we exit.
      */
 
+    TkRecordStartupPhase("mainloop");
+    TkReportStartupPhases();
+
     Tk_MainLoop();
     Tcl_DeleteInterp(interp);
     Tcl_Release(interp);
@@ -1225,6 +1225,7 @@ DestroyMenuInstance(
     if (menuPtr->entries != NULL) {
 	ckfree(menuPtr->entries);
 	menuPtr->entries = NULL;
+	menuPtr->entriesSpace = 0;
     }
     Tcl_DeleteHashTable(&menuPtr->items);
     TkMenuFreeDrawOptions(menuPtr);
@@ -1676,6 +1677,7 @@ ConfigureMenu(
 	    if (--menuListPtr->numEntries == 0) {
 		ckfree(menuListPtr->entries);
 		menuListPtr->entries = NULL;
+		menuListPtr->entriesSpace = 0;
 	    }
 	}
 
@@ -2291,27 +2293,33 @@ MenuNewEntry(
     int type)			/* The type of the new entry. */
 {
     TkMenuEntry *mePtr;
-    TkMenuEntry **newEntries;
     Tcl_Size i;
     ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
 	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
 
     /*
-     * Create a new array of entries with an empty slot for the new entry.
+     * Open up a slot for the new entry, growing the entry array
+     * geometrically when it is full so that building a menu entry by entry
+     * does not copy the array each time.
      */
 
-    newEntries = (TkMenuEntry **)ckalloc((menuPtr->numEntries+1) * sizeof(TkMenuEntry *));
-    for (i = 0; i < index; i++) {
-	newEntries[i] = menuPtr->entries[i];
-    }
-    for (; i < menuPtr->numEntries; i++) {
-	newEntries[i+1] = menuPtr->entries[i];
-	newEntries[i+1]->index = i + 1;
+    if (menuPtr->numEntries >= menuPtr->entriesSpace) {
+	Tcl_Size newSpace = (menuPtr->entriesSpace == 0)
+		? 8 : 2*menuPtr->entriesSpace;
+
+	if (menuPtr->entries == NULL) {
+	    menuPtr->entries = (TkMenuEntry **)ckalloc(
+		    newSpace * sizeof(TkMenuEntry *));
+	} else {
+	    menuPtr->entries = (TkMenuEntry **)ckrealloc(menuPtr->entries,
+		    newSpace * sizeof(TkMenuEntry *));
+	}
+	menuPtr->entriesSpace = newSpace;
     }
-    if (menuPtr->numEntries != 0) {
-	ckfree(menuPtr->entries);
+    for (i = menuPtr->numEntries; i > index; i--) {
+	menuPtr->entries[i] = menuPtr->entries[i-1];
+	menuPtr->entries[i]->index = i;
     }
-    menuPtr->entries = newEntries;
     menuPtr->numEntries++;
     mePtr = (TkMenuEntry *)ckalloc(sizeof(TkMenuEntry));
     menuPtr->entries[index] = mePtr;
@@ -2467,6 +2475,7 @@ MenuAddOrInsert(
 		if (--errorMenuPtr->numEntries == 0) {
 		    ckfree(errorMenuPtr->entries);
 		    errorMenuPtr->entries = NULL;
+		    errorMenuPtr->entriesSpace = 0;
 		}
 		if (errorMenuPtr == menuListPtr) {
 		    break;
@@ -3625,6 +3634,7 @@ DeleteMenuCloneEntries(
 	if (menuListPtr->numEntries == 0) {
 	    ckfree(menuListPtr->entries);
 	    menuListPtr->entries = NULL;
+	    menuListPtr->entriesSpace = 0;
 	}
 	if (((int)menuListPtr->active >= first)
 		&& ((int)menuListPtr->active <= last)) {
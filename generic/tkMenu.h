@@ -265,6 +265,10 @@ typedef struct TkMenu {
     TkMenuEntry **entries;	/* Array of pointers to all the entries in the
 				 * menu. NULL means no entries. */
     Tcl_Size numEntries;		/* Number of elements in entries. */
+    Tcl_Size entriesSpace;	/* Number of slots allocated in entries; the
+				 * array grows geometrically so that
+				 * rebuilding a large menu (and its clones)
+				 * entry by entry stays linear. */
     Tcl_Size active;			/* Index of active entry. TCL_INDEX_NONE means
 				 * nothing active. */
     int menuType;		/* MAIN_MENU, TEAROFF_MENU, or MENUBAR. See
@@ -168,6 +168,26 @@ static const Tk_OptionSpec optionSpecs[] = {
     {TK_OPTION_END, NULL, NULL, NULL, NULL, 0, 0, 0, 0, 0}
 };
 
+/*
+ * ComputeMessageGeometry searches iteratively for a wrap width that
+ * yields the requested aspect ratio, computing a full text layout per
+ * probe.  Tooltip-style uses create and destroy messages with the same
+ * text, font and aspect over and over, so the width that ended the
+ * search is memoized process-wide, keyed by a hash of the inputs.  A
+ * stale or colliding entry is harmless: the cached width is verified
+ * against the aspect bounds and the search simply runs again if it no
+ * longer satisfies them.
+ */
+
+#define WRAP_CACHE_SIZE 32	/* Must be a power of 2. */
+
+typedef struct {
+    unsigned int hash;		/* Hash of the layout inputs; 0 = empty. */
+    int width;			/* Wrap width that satisfied the search. */
+} WrapCacheEntry;
+
+static WrapCacheEntry wrapCache[WRAP_CACHE_SIZE];
+
 /*
  * Forward declarations for functions defined later in this file:
  */
@@ -182,6 +202,7 @@ static int		MessageWidgetObjCmd(void *clientData,
 			    Tcl_Interp *interp, int objc,
 			    Tcl_Obj *const objv[]);
 static void		MessageWorldChanged(void *instanceData);
+static unsigned int	WrapCacheHash(Message *msgPtr, int inset);
 static void		ComputeMessageGeometry(Message *msgPtr);
 static int		ConfigureMessage(Tcl_Interp *interp, Message *msgPtr,
 			    int objc, Tcl_Obj *const objv[], int flags);
@@ -593,6 +614,29 @@ MessageWorldChanged(
  *--------------------------------------------------------------
  */
 
+static unsigned int
+WrapCacheHash(
+    Message *msgPtr,		/* Information about window. */
+    int inset)			/* Border and highlight inset, in pixels. */
+{
+    unsigned int hash;
+    const char *p;
+
+    hash = (unsigned int) msgPtr->aspect;
+    hash = hash*31 + (unsigned int) msgPtr->padX;
+    hash = hash*31 + (unsigned int) msgPtr->padY;
+    hash = hash*31 + (unsigned int) inset;
+    hash = hash*31 + (unsigned int) msgPtr->justify;
+    hash = hash*31 + (unsigned int) WidthOfScreen(Tk_Screen(msgPtr->tkwin));
+    for (p = Tk_NameOfFont(msgPtr->tkfont); *p != 0; p++) {
+	hash = hash*31 + UCHAR(*p);
+    }
+    for (p = msgPtr->string; *p != 0; p++) {
+	hash = hash*31 + UCHAR(*p);
+    }
+    return hash ? hash : 1;
+}
+
 static void
 ComputeMessageGeometry(
     Message *msgPtr)	/* Information about window. */
@@ -600,6 +644,8 @@ ComputeMessageGeometry(
     int width, inc, height;
     int thisWidth, thisHeight, maxWidth;
     int aspect, lowerBound, upperBound, inset;
+    unsigned int hash = 0;
+    WrapCacheEntry *entryPtr;
 
     Tk_FreeTextLayout(msgPtr->textLayout);
 
@@ -628,6 +674,25 @@ ComputeMessageGeometry(
 	width = msgPtr->width;
 	inc = 0;
     } else {
+	/*
+	 * Check whether a previous search with the same inputs already
+	 * found a satisfactory width.
+	 */
+
+	hash = WrapCacheHash(msgPtr, inset);
+	entryPtr = &wrapCache[hash & (WRAP_CACHE_SIZE - 1)];
+	if (entryPtr->hash == hash) {
+	    msgPtr->textLayout = Tk_ComputeTextLayout(msgPtr->tkfont,
+		    msgPtr->string, msgPtr->numChars, entryPtr->width,
+		    msgPtr->justify, 0, &thisWidth, &thisHeight);
+	    maxWidth = thisWidth + 2 * (inset + msgPtr->padX);
+	    height = thisHeight + 2 * (inset + msgPtr->padY);
+	    aspect = (height > 0) ? (100 * maxWidth) / height : 0;
+	    if (aspect >= lowerBound && aspect <= upperBound) {
+		goto gotLayout;
+	    }
+	    Tk_FreeTextLayout(msgPtr->textLayout);
+	}
 	width = WidthOfScreen(Tk_Screen(msgPtr->tkwin))/2;
 	inc = width/2;
     }
@@ -653,6 +718,13 @@ ComputeMessageGeometry(
 	}
 	Tk_FreeTextLayout(msgPtr->textLayout);
     }
+    if (hash != 0) {
+	entryPtr = &wrapCache[hash & (WRAP_CACHE_SIZE - 1)];
+	entryPtr->hash = hash;
+	entryPtr->width = width;
+    }
+
+  gotLayout:
     msgPtr->msgWidth = thisWidth;
     msgPtr->msgHeight = thisHeight;
     Tk_GeometryRequest(msgPtr->tkwin, maxWidth, height);
@@ -18,7 +18,13 @@
 typedef struct PixelRep {
     double value;
     int units;
-    Tk_Window tkwin;
+    Screen *screen;		/* Screen the cached conversion below was
+				 * computed for; conversions depend only on
+				 * the screen, so one cached value serves
+				 * every window on it. */
+    size_t epoch;		/* Value of the scaling epoch when the cached
+				 * conversion was computed; see
+				 * TkScalingChanged. */
     int returnValue;
 } PixelRep;
 
@@ -59,7 +65,10 @@ static Tcl_ThreadDataKey dataKey;
 typedef struct MMRep {
     double value;
     int units;
-    Tk_Window tkwin;
+    Screen *screen;		/* As in PixelRep: the screen the cached
+				 * conversion was computed for. */
+    size_t epoch;		/* As in PixelRep: the scaling epoch of the
+				 * cached conversion. */
     double returnValue;
 } MMRep;
 
@@ -143,6 +152,42 @@ static const TkObjType windowObjType = {
     0
 };
 
+/*
+ * Epoch counter validating the cached conversions above. [tk scaling]
+ * changes the effective resolution of a screen in place, so a cached
+ * conversion cannot be validated by its Screen pointer alone; every scaling
+ * change bumps the epoch, and a cached value computed under an older epoch
+ * is recomputed on its next use. The recomputation starts from the parsed
+ * value and units, so a scaling change rescales distance options with one
+ * multiplication each instead of re-parsing their string forms.
+ */
+
+static size_t scalingEpoch = 0;
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkScalingChanged --
+ *
+ *	Called when the effective resolution of a screen has been changed in
+ *	place (currently by [tk scaling]), invalidating every cached
+ *	distance conversion.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Cached pixel and mm conversions are recomputed on next use.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkScalingChanged(void)
+{
+    scalingEpoch++;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -278,23 +323,29 @@ GetPixelsFromObjEx(
 	}
     } else {
 	pixelPtr = GET_COMPLEXPIXEL(objPtr);
-	if ((!fresh) && (pixelPtr->tkwin != tkwin)) {
+	if ((!fresh) && (pixelPtr->units < 0)
+		&& (pixelPtr->screen != Tk_Screen(tkwin))) {
 	    /*
-	     * In the case of exo-screen conversions of non-pixels, we force a
-	     * recomputation from the string.
+	     * For exo-screen conversions of values without stored units
+	     * (e.g. after Tk_GetDoublePixelsFromObj shimmered the rep to
+	     * plain pixels), we force a recomputation from the string.
+	     * Values with units are simply rescaled for the new screen
+	     * below.
 	     */
 
 	    FreePixelInternalRep(objPtr);
 	    goto retry;
 	}
-	if ((pixelPtr->tkwin != tkwin) || dblPtr) {
+	if ((pixelPtr->screen != Tk_Screen(tkwin))
+		|| (pixelPtr->epoch != scalingEpoch) || dblPtr) {
 	    d = pixelPtr->value;
 	    if (pixelPtr->units >= 0) {
 		d *= bias[pixelPtr->units] * WidthOfScreen(Tk_Screen(tkwin));
 		d /= WidthMMOfScreen(Tk_Screen(tkwin));
 	    }
 	    pixelPtr->returnValue = (int) (d<0 ? d-0.5 : d+0.5);
-	    pixelPtr->tkwin = tkwin;
+	    pixelPtr->screen = Tk_Screen(tkwin);
+	    pixelPtr->epoch = scalingEpoch;
 	    if (dblPtr) {
 		*dblPtr = d;
 	    }
@@ -451,7 +502,8 @@ DupPixelInternalRep(
 	newPtr = (PixelRep *)ckalloc(sizeof(PixelRep));
 	newPtr->value = oldPtr->value;
 	newPtr->units = oldPtr->units;
-	newPtr->tkwin = oldPtr->tkwin;
+	newPtr->screen = oldPtr->screen;
+	newPtr->epoch = oldPtr->epoch;
 	newPtr->returnValue = oldPtr->returnValue;
 	SET_COMPLEXPIXEL(copyPtr, newPtr);
     }
@@ -567,7 +619,8 @@ SetPixelFromAny(
 
 	pixelPtr->value = d;
 	pixelPtr->units = units;
-	pixelPtr->tkwin = NULL;
+	pixelPtr->screen = NULL;
+	pixelPtr->epoch = scalingEpoch;
 	pixelPtr->returnValue = i;
 	SET_COMPLEXPIXEL(objPtr, pixelPtr);
     }
@@ -617,7 +670,8 @@ Tk_GetMMFromObj(
     }
 
     mmPtr = (MMRep *)objPtr->internalRep.twoPtrValue.ptr1;
-    if (mmPtr->tkwin != tkwin) {
+    if ((mmPtr->screen != Tk_Screen(tkwin))
+	    || (mmPtr->epoch != scalingEpoch)) {
 	d = mmPtr->value;
 	if (mmPtr->units == -1) {
 	    d /= WidthOfScreen(Tk_Screen(tkwin));
@@ -625,7 +679,8 @@ Tk_GetMMFromObj(
 	} else {
 	    d *= bias[mmPtr->units];
 	}
-	mmPtr->tkwin = tkwin;
+	mmPtr->screen = Tk_Screen(tkwin);
+	mmPtr->epoch = scalingEpoch;
 	mmPtr->returnValue = d;
     }
     *doublePtr = mmPtr->returnValue;
@@ -690,7 +745,8 @@ DupMMInternalRep(
     newPtr = (MMRep *)ckalloc(sizeof(MMRep));
     newPtr->value = oldPtr->value;
     newPtr->units = oldPtr->units;
-    newPtr->tkwin = oldPtr->tkwin;
+    newPtr->screen = oldPtr->screen;
+    newPtr->epoch = oldPtr->epoch;
     newPtr->returnValue = oldPtr->returnValue;
     copyPtr->internalRep.twoPtrValue.ptr1 = newPtr;
 }
@@ -844,7 +900,8 @@ SetMMFromAny(
     mmPtr = (MMRep *)ckalloc(sizeof(MMRep));
     mmPtr->value = d;
     mmPtr->units = units;
-    mmPtr->tkwin = NULL;
+    mmPtr->screen = NULL;
+    mmPtr->epoch = scalingEpoch;
     mmPtr->returnValue	= d;
 
     objPtr->internalRep.twoPtrValue.ptr1 = mmPtr;
@@ -204,6 +204,21 @@ typedef struct {
 				 * priority level. */
     Element defaultMatch;	/* Special "no match" Element to use as
 				 * default for searches.*/
+
+    /*
+     * Index over the four leaf stacks, so that Tk_GetOption probes are a
+     * hash lookup instead of a scan over every cached leaf element (the
+     * wildcard stacks hold every wildcard pattern in the database).  Built
+     * lazily on the first probe after the stacks change.
+     */
+
+    Tcl_HashTable nameLeafIndex;/* KEY: option name Uid; VALUE: Element * of
+				 * highest priority in the EXACT_LEAF_NAME
+				 * and WILDCARD_LEAF_NAME stacks. */
+    Tcl_HashTable classLeafIndex;
+				/* Same, for the *_LEAF_CLASS stacks. */
+    int leafIndexValid;		/* Zero means the stacks have changed and the
+				 * indexes must be rebuilt before use. */
 } ThreadSpecificData;
 static Tcl_ThreadDataKey dataKey;
 
@@ -218,6 +233,7 @@ static ElArray *	ExtendArray(ElArray *arrayPtr, Element *elPtr);
 static void		ExtendStacks(ElArray *arrayPtr, int leaf);
 static int		GetDefaultOptions(Tcl_Interp *interp,
 			    TkWindow *winPtr);
+static void		BuildLeafIndexes(ThreadSpecificData *tsdPtr);
 static ElArray *	NewArray(int numEls);
 static void		OptionThreadExitProc(void *clientData);
 static void		OptionInit(TkMainInfo *mainPtr);
@@ -471,44 +487,71 @@ Tk_GetOption(
     }
 
     /*
-     * Probe the stacks for matches.
+     * Probe the stacks for matches. Masquerading lookups only consider the
+     * stacks up to the parent's depth, so they scan; ordinary lookups cover
+     * the full stacks and can use the leaf indexes.
      */
 
-    for (elPtr = tsdPtr->stacks[EXACT_LEAF_NAME]->els,
-	    count = stackDepth[EXACT_LEAF_NAME]; count > 0;
-	    elPtr++, count--) {
-	if ((elPtr->nameUid == nameId)
-		&& (elPtr->priority > bestPtr->priority)) {
-	    bestPtr = elPtr;
-	}
-    }
-    for (elPtr = tsdPtr->stacks[WILDCARD_LEAF_NAME]->els,
-	    count = stackDepth[WILDCARD_LEAF_NAME]; count > 0;
-	    elPtr++, count--) {
-	if ((elPtr->nameUid == nameId)
-		&& (elPtr->priority > bestPtr->priority)) {
-	    bestPtr = elPtr;
-	}
-    }
-
-    if (className != NULL) {
-	classId = Tk_GetUid(className);
-	for (elPtr = tsdPtr->stacks[EXACT_LEAF_CLASS]->els,
-		count = stackDepth[EXACT_LEAF_CLASS]; count > 0;
+    if (masqName != NULL) {
+	for (elPtr = tsdPtr->stacks[EXACT_LEAF_NAME]->els,
+		count = stackDepth[EXACT_LEAF_NAME]; count > 0;
 		elPtr++, count--) {
-	    if ((elPtr->nameUid == classId)
+	    if ((elPtr->nameUid == nameId)
 		    && (elPtr->priority > bestPtr->priority)) {
 		bestPtr = elPtr;
 	    }
 	}
-	for (elPtr = tsdPtr->stacks[WILDCARD_LEAF_CLASS]->els,
-		count = stackDepth[WILDCARD_LEAF_CLASS]; count > 0;
+	for (elPtr = tsdPtr->stacks[WILDCARD_LEAF_NAME]->els,
+		count = stackDepth[WILDCARD_LEAF_NAME]; count > 0;
 		elPtr++, count--) {
-	    if ((elPtr->nameUid == classId)
+	    if ((elPtr->nameUid == nameId)
 		    && (elPtr->priority > bestPtr->priority)) {
 		bestPtr = elPtr;
 	    }
 	}
+
+	if (className != NULL) {
+	    classId = Tk_GetUid(className);
+	    for (elPtr = tsdPtr->stacks[EXACT_LEAF_CLASS]->els,
+		    count = stackDepth[EXACT_LEAF_CLASS]; count > 0;
+		    elPtr++, count--) {
+		if ((elPtr->nameUid == classId)
+			&& (elPtr->priority > bestPtr->priority)) {
+		    bestPtr = elPtr;
+		}
+	    }
+	    for (elPtr = tsdPtr->stacks[WILDCARD_LEAF_CLASS]->els,
+		    count = stackDepth[WILDCARD_LEAF_CLASS]; count > 0;
+		    elPtr++, count--) {
+		if ((elPtr->nameUid == classId)
+			&& (elPtr->priority > bestPtr->priority)) {
+		    bestPtr = elPtr;
+		}
+	    }
+	}
+    } else {
+	Tcl_HashEntry *hPtr;
+
+	if (!tsdPtr->leafIndexValid) {
+	    BuildLeafIndexes(tsdPtr);
+	}
+	hPtr = Tcl_FindHashEntry(&tsdPtr->nameLeafIndex, nameId);
+	if (hPtr != NULL) {
+	    elPtr = (Element *)Tcl_GetHashValue(hPtr);
+	    if (elPtr->priority > bestPtr->priority) {
+		bestPtr = elPtr;
+	    }
+	}
+	if (className != NULL) {
+	    classId = Tk_GetUid(className);
+	    hPtr = Tcl_FindHashEntry(&tsdPtr->classLeafIndex, classId);
+	    if (hPtr != NULL) {
+		elPtr = (Element *)Tcl_GetHashValue(hPtr);
+		if (elPtr->priority > bestPtr->priority) {
+		    bestPtr = elPtr;
+		}
+	    }
+	}
     }
 
     /*
@@ -825,6 +868,7 @@ TkOptionClassChanged(
 	    } else {
 		tsdPtr->cachedWindow = tsdPtr->levels[tsdPtr->curLevel].winPtr;
 	    }
+	    tsdPtr->leafIndexValid = 0;
 	    break;
 	}
     }
@@ -1362,8 +1406,63 @@ SetupStacks(
 	}
     }
     tsdPtr->cachedWindow = winPtr;
+    tsdPtr->leafIndexValid = 0;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * BuildLeafIndexes --
+ *
+ *	Rebuild the hash indexes over the four leaf stacks, keeping for
+ *	each name/class Uid the element with the highest priority.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	tsdPtr->nameLeafIndex and tsdPtr->classLeafIndex are rebuilt and
+ *	leafIndexValid is set.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+BuildLeafIndexes(
+    ThreadSpecificData *tsdPtr)	/* Thread's option state. */
+{
+    static const int leafStacks[] = {
+	EXACT_LEAF_NAME, WILDCARD_LEAF_NAME,
+	EXACT_LEAF_CLASS, WILDCARD_LEAF_CLASS, -1
+    };
+    const int *iPtr;
+
+    Tcl_DeleteHashTable(&tsdPtr->nameLeafIndex);
+    Tcl_DeleteHashTable(&tsdPtr->classLeafIndex);
+    Tcl_InitHashTable(&tsdPtr->nameLeafIndex, TCL_ONE_WORD_KEYS);
+    Tcl_InitHashTable(&tsdPtr->classLeafIndex, TCL_ONE_WORD_KEYS);
+
+    for (iPtr = leafStacks; *iPtr != -1; iPtr++) {
+	Tcl_HashTable *indexPtr = (*iPtr & CLASS)
+		? &tsdPtr->classLeafIndex : &tsdPtr->nameLeafIndex;
+	ElArray *arrayPtr = tsdPtr->stacks[*iPtr];
+	Element *elPtr;
+	int count, newEntry;
+
+	for (elPtr = arrayPtr->els, count = arrayPtr->numUsed;
+		count > 0; elPtr++, count--) {
+	    Tcl_HashEntry *hPtr = Tcl_CreateHashEntry(
+		    indexPtr, elPtr->nameUid, &newEntry);
+
+	    if (newEntry || (elPtr->priority >
+		    ((Element *)Tcl_GetHashValue(hPtr))->priority)) {
+		Tcl_SetHashValue(hPtr, elPtr);
+	    }
+	}
+    }
+    tsdPtr->leafIndexValid = 1;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -1431,6 +1530,8 @@ OptionThreadExitProc(
 	for (i = 0; i < NUM_STACKS; i++) {
 	    ckfree(tsdPtr->stacks[i]);
 	}
+	Tcl_DeleteHashTable(&tsdPtr->nameLeafIndex);
+	Tcl_DeleteHashTable(&tsdPtr->classLeafIndex);
 	ckfree(tsdPtr->levels);
 	tsdPtr->initialized = 0;
     }
@@ -1480,6 +1581,9 @@ OptionInit(
 	    tsdPtr->stacks[i] = NewArray(10);
 	    tsdPtr->levels[0].bases[i] = 0;
 	}
+	Tcl_InitHashTable(&tsdPtr->nameLeafIndex, TCL_ONE_WORD_KEYS);
+	Tcl_InitHashTable(&tsdPtr->classLeafIndex, TCL_ONE_WORD_KEYS);
+	tsdPtr->leafIndexValid = 0;
 
 	defaultMatchPtr->nameUid = NULL;
 	defaultMatchPtr->child.valueUid = NULL;
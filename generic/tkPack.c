@@ -35,8 +35,15 @@ typedef struct Packer {
     struct Packer *nextPtr;	/* Next window packed within same container. List
 				 * is priority-ordered: first on list gets
 				 * packed first. */
+    struct Packer *prevPtr;	/* Previous window packed within same
+				 * container, or NULL for the head of the
+				 * list. Makes unlinking and insertion
+				 * before a sibling constant-time. */
     struct Packer *contentPtr;	/* First in list of content packed inside this
 				 * window (NULL means no packed content). */
+    struct Packer *lastContentPtr;
+				/* Last in list of content packed inside this
+				 * window, for constant-time appends. */
     Side side;			/* Side of container against which this window is
 				 * packed. */
     Tk_Anchor anchor;		/* If frame allocated for window is larger
@@ -357,7 +364,7 @@ Tk_PackObjCmd(
 	    }
 	    if (!(containerPtr->flags & REQUESTED_REPACK)) {
 		containerPtr->flags |= REQUESTED_REPACK;
-		Tcl_DoWhenIdle(ArrangePacking, containerPtr);
+		TkDoWhenIdle(ArrangePacking, containerPtr, TK_IDLE_LAYOUT);
 	    }
 	} else {
 	    if (containerPtr->flags & ALLOCED_CONTAINER) {
@@ -426,7 +433,7 @@ PackReqProc(
     packPtr = packPtr->containerPtr;
     if (!(packPtr->flags & REQUESTED_REPACK)) {
 	packPtr->flags |= REQUESTED_REPACK;
-	Tcl_DoWhenIdle(ArrangePacking, packPtr);
+	TkDoWhenIdle(ArrangePacking, packPtr, TK_IDLE_LAYOUT);
     }
 }
 
@@ -596,7 +603,7 @@ ArrangePacking(
 	    && !(containerPtr->flags & DONT_PROPAGATE)) {
 	Tk_GeometryRequest(containerPtr->tkwin, maxWidth, maxHeight);
 	containerPtr->flags |= REQUESTED_REPACK;
-	Tcl_DoWhenIdle(ArrangePacking, containerPtr);
+	TkDoWhenIdle(ArrangePacking, containerPtr, TK_IDLE_LAYOUT);
 	goto done;
     }
 
@@ -961,7 +968,9 @@ GetPacker(
     packPtr->tkwin = tkwin;
     packPtr->containerPtr = NULL;
     packPtr->nextPtr = NULL;
+    packPtr->prevPtr = NULL;
     packPtr->contentPtr = NULL;
+    packPtr->lastContentPtr = NULL;
     packPtr->side = TOP;
     packPtr->anchor = TK_ANCHOR_CENTER;
     packPtr->padX = packPtr->padY = 0;
@@ -996,28 +1005,29 @@ static void
 Unlink(
     Packer *packPtr)	/* Window to unlink. */
 {
-    Packer *containerPtr, *packPtr2;
+    Packer *containerPtr;
 
     containerPtr = packPtr->containerPtr;
     if (containerPtr == NULL) {
 	return;
     }
-    if (containerPtr->contentPtr == packPtr) {
+    if (packPtr->prevPtr == NULL) {
+	if (containerPtr->contentPtr != packPtr) {
+	    Tcl_Panic("Unlink couldn't find previous window");
+	}
 	containerPtr->contentPtr = packPtr->nextPtr;
     } else {
-	for (packPtr2 = containerPtr->contentPtr; ; packPtr2 = packPtr2->nextPtr) {
-	    if (packPtr2 == NULL) {
-		Tcl_Panic("Unlink couldn't find previous window");
-	    }
-	    if (packPtr2->nextPtr == packPtr) {
-		packPtr2->nextPtr = packPtr->nextPtr;
-		break;
-	    }
-	}
+	packPtr->prevPtr->nextPtr = packPtr->nextPtr;
+    }
+    if (packPtr->nextPtr == NULL) {
+	containerPtr->lastContentPtr = packPtr->prevPtr;
+    } else {
+	packPtr->nextPtr->prevPtr = packPtr->prevPtr;
     }
+    packPtr->prevPtr = NULL;
     if (!(containerPtr->flags & REQUESTED_REPACK)) {
 	containerPtr->flags |= REQUESTED_REPACK;
-	Tcl_DoWhenIdle(ArrangePacking, containerPtr);
+	TkDoWhenIdle(ArrangePacking, containerPtr, TK_IDLE_LAYOUT);
     }
     if (containerPtr->abortPtr != NULL) {
 	*containerPtr->abortPtr = 1;
@@ -1070,7 +1080,7 @@ DestroyPacker(
     Packer *packPtr = (Packer *)memPtr;
 
     if (packPtr->flags & REQUESTED_REPACK) {
-	Tcl_CancelIdleCall(ArrangePacking, packPtr);
+	TkCancelDoWhenIdle(ArrangePacking, packPtr);
     }
     ckfree(packPtr);
 }
@@ -1105,14 +1115,14 @@ PackStructureProc(
 	if ((packPtr->contentPtr != NULL)
 		&& !(packPtr->flags & REQUESTED_REPACK)) {
 	    packPtr->flags |= REQUESTED_REPACK;
-	    Tcl_DoWhenIdle(ArrangePacking, packPtr);
+	    TkDoWhenIdle(ArrangePacking, packPtr, TK_IDLE_LAYOUT);
 	}
 	if ((packPtr->containerPtr != NULL)
 	        && (packPtr->doubleBw != 2*Tk_Changes(packPtr->tkwin)->border_width)) {
 	    if (!(packPtr->containerPtr->flags & REQUESTED_REPACK)) {
 		packPtr->doubleBw = 2*Tk_Changes(packPtr->tkwin)->border_width;
 		packPtr->containerPtr->flags |= REQUESTED_REPACK;
-		Tcl_DoWhenIdle(ArrangePacking, packPtr->containerPtr);
+		TkDoWhenIdle(ArrangePacking, packPtr->containerPtr, TK_IDLE_LAYOUT);
 	    }
 	}
     } else if (eventPtr->type == DestroyNotify) {
@@ -1129,6 +1139,7 @@ PackStructureProc(
 	    contentPtr->containerPtr = NULL;
 	    nextPtr = contentPtr->nextPtr;
 	    contentPtr->nextPtr = NULL;
+	    contentPtr->prevPtr = NULL;
 	}
 
 	if (packPtr->tkwin != NULL) {
@@ -1138,7 +1149,7 @@ PackStructureProc(
 	}
 
 	if (packPtr->flags & REQUESTED_REPACK) {
-	    Tcl_CancelIdleCall(ArrangePacking, packPtr);
+	    TkCancelDoWhenIdle(ArrangePacking, packPtr);
 	}
 	packPtr->tkwin = NULL;
 	Tcl_EventuallyFree(packPtr, DestroyPacker);
@@ -1151,7 +1162,7 @@ PackStructureProc(
 	if ((packPtr->contentPtr != NULL)
 		&& !(packPtr->flags & REQUESTED_REPACK)) {
 	    packPtr->flags |= REQUESTED_REPACK;
-	    Tcl_DoWhenIdle(ArrangePacking, packPtr);
+	    TkDoWhenIdle(ArrangePacking, packPtr, TK_IDLE_LAYOUT);
 	}
     } else if (eventPtr->type == UnmapNotify) {
 	Packer *packPtr2;
@@ -1315,14 +1326,7 @@ ConfigureContent(
 			goto notPacked;
 		    }
 		    containerPtr = otherPtr->containerPtr;
-		    prevPtr = containerPtr->contentPtr;
-		    if (prevPtr == otherPtr) {
-			prevPtr = NULL;
-		    } else {
-			while (prevPtr->nextPtr != otherPtr) {
-			    prevPtr = prevPtr->nextPtr;
-			}
-		    }
+		    prevPtr = otherPtr->prevPtr;
 		    positionGiven = 1;
 		}
 		break;
@@ -1360,12 +1364,7 @@ ConfigureContent(
 			return TCL_ERROR;
 		    }
 		    containerPtr = GetPacker(other);
-		    prevPtr = containerPtr->contentPtr;
-		    if (prevPtr != NULL) {
-			while (prevPtr->nextPtr != NULL) {
-			    prevPtr = prevPtr->nextPtr;
-			}
-		    }
+		    prevPtr = containerPtr->lastContentPtr;
 		    positionGiven = 1;
 		}
 		break;
@@ -1443,12 +1442,7 @@ ConfigureContent(
 
 	if (!positionGiven) {
 	    containerPtr = GetPacker(Tk_Parent(content));
-	    prevPtr = containerPtr->contentPtr;
-	    if (prevPtr != NULL) {
-		while (prevPtr->nextPtr != NULL) {
-		    prevPtr = prevPtr->nextPtr;
-		}
-	    }
+	    prevPtr = containerPtr->lastContentPtr;
 	}
 
 	/*
@@ -1518,6 +1512,12 @@ ConfigureContent(
 	    contentPtr->nextPtr = prevPtr->nextPtr;
 	    prevPtr->nextPtr = contentPtr;
 	}
+	contentPtr->prevPtr = prevPtr;
+	if (contentPtr->nextPtr == NULL) {
+	    containerPtr->lastContentPtr = contentPtr;
+	} else {
+	    contentPtr->nextPtr->prevPtr = contentPtr;
+	}
 	Tk_ManageGeometry(content, &packerType, contentPtr);
 	prevPtr = contentPtr;
 
@@ -1541,7 +1541,7 @@ ConfigureContent(
 	}
 	if (!(containerPtr->flags & REQUESTED_REPACK)) {
 	    containerPtr->flags |= REQUESTED_REPACK;
-	    Tcl_DoWhenIdle(ArrangePacking, containerPtr);
+	    TkDoWhenIdle(ArrangePacking, containerPtr, TK_IDLE_LAYOUT);
 	}
     }
     return TCL_OK;
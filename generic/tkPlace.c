@@ -133,6 +133,20 @@ typedef struct Container {
 
 #define PARENT_RECONFIG_PENDING	1
 
+/*
+ * RecomputePlacement computes the geometry of every content window of a
+ * container into a packed array of the following records, then applies
+ * them in a second pass.  Keeping the computation free of side effects
+ * lets it run over all the content in one tight loop, and confines the
+ * window-system traffic to the apply pass.
+ */
+
+typedef struct {
+    Content *contentPtr;	/* Window being placed. */
+    int x, y;			/* Computed position in the container. */
+    int width, height;		/* Computed inside dimensions. */
+} Placement;
+
 /*
  * The following structure is the official type record for the placer:
  */
@@ -162,6 +176,8 @@ static Content *		CreateContent(Tk_Window tkwin, Tk_OptionTable table);
 static void		FreeContent(Content *contentPtr);
 static Content *		FindContent(Tk_Window tkwin);
 static Container *		CreateContainer(Tk_Window tkwin);
+static void		ComputePlacement(Container *containerPtr,
+			    Content *contentPtr, Placement *placePtr);
 static Container *		FindContainer(Tk_Window tkwin);
 static void		PlaceStructureProc(void *clientData,
 			    XEvent *eventPtr);
@@ -198,12 +214,12 @@ Tk_PlaceObjCmd(
     TkDisplay *dispPtr;
     Tk_OptionTable optionTable;
     static const char *const optionStrings[] = {
-	"configure", "content", "forget", "info", "slaves", NULL
+	"batch", "configure", "content", "forget", "info", "slaves", NULL
     };
     static const char *const optionStringsNoDep[] = {
-	"configure", "content", "forget", "info", NULL
+	"batch", "configure", "content", "forget", "info", NULL
     };
-    enum options { PLACE_CONFIGURE, PLACE_CONTENT, PLACE_FORGET, PLACE_INFO, PLACE_SLAVES };
+    enum options { PLACE_BATCH, PLACE_CONFIGURE, PLACE_CONTENT, PLACE_FORGET, PLACE_INFO, PLACE_SLAVES };
     int index;
 
     if (objc < 3) {
@@ -247,6 +263,63 @@ Tk_PlaceObjCmd(
      * possible additional arguments.
      */
 
+    if (Tcl_GetIndexFromObj(NULL, objv[1], optionStrings,
+	    "option", 0, &index) != TCL_OK) {
+	/*
+	 * Call it again without the deprecated ones to get a proper error
+	 * message. This works well since there can't be any ambiguity between
+	 * deprecated and new options.
+	 */
+
+	Tcl_GetIndexFromObjStruct(interp, objv[1], optionStringsNoDep,
+		sizeof(char *), "option", 0, &index);
+	return TCL_ERROR;
+    }
+
+    if (index == PLACE_BATCH) {
+	/*
+	 * Each argument is a list {pathName ?option value ...?}.  All of
+	 * the placements are configured before any container is laid out
+	 * again (the relayouts are idle handlers), so moving many windows
+	 * with one [place batch] is atomic as far as the display goes.
+	 */
+
+	Tcl_Size specc, i;
+	Tcl_Obj **specv;
+
+	for (i = 2; i < objc; i++) {
+	    if (Tcl_ListObjGetElements(interp, objv[i], &specc,
+		    &specv) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    if (specc < 1) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj(
+			"placement spec must be a list"
+			" {pathName ?option value ...?}", TCL_INDEX_NONE));
+		Tcl_SetErrorCode(interp, "TK", "GEOMETRY", "SPEC", NULL);
+		return TCL_ERROR;
+	    }
+	    if (TkGetWindowFromObj(interp, main_win, specv[0],
+		    &tkwin) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    dispPtr = ((TkWindow *) tkwin)->dispPtr;
+	    if (!dispPtr->placeInit) {
+		Tcl_InitHashTable(&dispPtr->containerTable, TCL_ONE_WORD_KEYS);
+		Tcl_InitHashTable(&dispPtr->contentTable, TCL_ONE_WORD_KEYS);
+		dispPtr->placeInit = 1;
+	    }
+	    if (ConfigureContent(interp, tkwin, optionTable,
+		    specc - 1, specv + 1) != TCL_OK) {
+		Tcl_AppendObjToErrorInfo(interp, Tcl_ObjPrintf(
+			"\n    (processing placement spec for \"%s\")",
+			Tcl_GetString(specv[0])));
+		return TCL_ERROR;
+	    }
+	}
+	return TCL_OK;
+    }
+
     if (TkGetWindowFromObj(interp, main_win, objv[2],
 	    &tkwin) != TCL_OK) {
 	return TCL_ERROR;
@@ -263,19 +336,6 @@ Tk_PlaceObjCmd(
 	dispPtr->placeInit = 1;
     }
 
-    if (Tcl_GetIndexFromObj(NULL, objv[1], optionStrings,
-	    "option", 0, &index) != TCL_OK) {
-	/*
-	 * Call it again without the deprecated ones to get a proper error
-	 * message. This works well since there can't be any ambiguity between
-	 * deprecated and new options.
-	 */
-
-	Tcl_GetIndexFromObjStruct(interp, objv[1], optionStringsNoDep,
-		sizeof(char *), "option", 0, &index);
-	return TCL_ERROR;
-    }
-
     switch ((enum options) index) {
     case PLACE_CONFIGURE:
 	if (objc == 3 || objc == 4) {
@@ -325,6 +385,7 @@ Tk_PlaceObjCmd(
 	}
 	return PlaceInfoCommand(interp, tkwin);
 
+    case PLACE_BATCH:		/* Handled above. */
     case PLACE_SLAVES:
     case PLACE_CONTENT: {
 	Container *containerPtr;
@@ -824,13 +885,177 @@ PlaceInfoCommand(
     return TCL_OK;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * ComputePlacement --
+ *
+ *	Compute the geometry of a single content window within its
+ *	container, filling in *placePtr. Pure computation: no windows are
+ *	touched and no callbacks can fire, so it is safe to run over all
+ *	the content of a container in one uninterrupted pass.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ComputePlacement(
+    Container *containerPtr,	/* Container the window is placed in. */
+    Content *contentPtr,	/* Window to compute the placement of. */
+    Placement *placePtr)	/* Filled in with the computed geometry. */
+{
+    int x, y, width, height, tmp;
+    int containerWidth, containerHeight, containerX, containerY;
+    double x1, y1, x2, y2;
+
+    /*
+     * Step 1: compute size and borderwidth of container, taking into account
+     * desired border mode.
+     */
+
+    containerX = containerY = 0;
+    containerWidth = Tk_Width(containerPtr->tkwin);
+    containerHeight = Tk_Height(containerPtr->tkwin);
+    if (contentPtr->borderMode == BM_INSIDE) {
+	containerX = Tk_InternalBorderLeft(containerPtr->tkwin);
+	containerY = Tk_InternalBorderTop(containerPtr->tkwin);
+	containerWidth -= containerX + Tk_InternalBorderRight(containerPtr->tkwin);
+	containerHeight -= containerY +
+		Tk_InternalBorderBottom(containerPtr->tkwin);
+    } else if (contentPtr->borderMode == BM_OUTSIDE) {
+	containerX = containerY = -Tk_Changes(containerPtr->tkwin)->border_width;
+	containerWidth -= 2 * containerX;
+	containerHeight -= 2 * containerY;
+    }
+
+    /*
+     * Step 2: compute size of content (outside dimensions including border)
+     * and location of anchor point within container.
+     */
+
+    x1 = contentPtr->x + containerX + (contentPtr->relX*containerWidth);
+    x = (int) (x1 + ((x1 > 0) ? 0.5 : -0.5));
+    y1 = contentPtr->y + containerY + (contentPtr->relY*containerHeight);
+    y = (int) (y1 + ((y1 > 0) ? 0.5 : -0.5));
+    if ((contentPtr->widthPtr) || contentPtr->relWidthPtr) {
+	width = 0;
+	if (contentPtr->widthPtr) {
+	    width += contentPtr->width;
+	}
+	if (contentPtr->relWidthPtr) {
+	    /*
+	     * The code below is a bit tricky. In order to round correctly
+	     * when both relX and relWidth are specified, compute the
+	     * location of the right edge and round that, then compute
+	     * width. If we compute the width and round it, rounding
+	     * errors in relX and relWidth accumulate.
+	     */
+
+	    x2 = x1 + (contentPtr->relWidth*containerWidth);
+	    tmp = (int) (x2 + ((x2 > 0) ? 0.5 : -0.5));
+	    width += tmp - x;
+	}
+    } else {
+	width = Tk_ReqWidth(contentPtr->tkwin)
+		+ 2*Tk_Changes(contentPtr->tkwin)->border_width;
+    }
+    if (contentPtr->heightPtr || contentPtr->relHeightPtr) {
+	height = 0;
+	if (contentPtr->heightPtr) {
+	    height += contentPtr->height;
+	}
+	if (contentPtr->relHeightPtr) {
+	    /*
+	     * See note above for rounding errors in width computation.
+	     */
+
+	    y2 = y1 + (contentPtr->relHeight*containerHeight);
+	    tmp = (int) (y2 + ((y2 > 0) ? 0.5 : -0.5));
+	    height += tmp - y;
+	}
+    } else {
+	height = Tk_ReqHeight(contentPtr->tkwin)
+		+ 2*Tk_Changes(contentPtr->tkwin)->border_width;
+    }
+
+    /*
+     * Step 3: adjust the x and y positions so that the desired anchor
+     * point on the content appears at that position. Also adjust for the
+     * border mode and container's border.
+     */
+
+    switch (contentPtr->anchor) {
+    case TK_ANCHOR_N:
+	x -= width/2;
+	break;
+    case TK_ANCHOR_NE:
+	x -= width;
+	break;
+    case TK_ANCHOR_E:
+	x -= width;
+	y -= height/2;
+	break;
+    case TK_ANCHOR_SE:
+	x -= width;
+	y -= height;
+	break;
+    case TK_ANCHOR_S:
+	x -= width/2;
+	y -= height;
+	break;
+    case TK_ANCHOR_SW:
+	y -= height;
+	break;
+    case TK_ANCHOR_W:
+	y -= height/2;
+	break;
+    case TK_ANCHOR_NW:
+	break;
+    default:
+	x -= width/2;
+	y -= height/2;
+	break;
+    }
+
+    /*
+     * Step 4: adjust width and height again to reflect inside dimensions
+     * of window rather than outside. Also make sure that the width and
+     * height aren't zero.
+     */
+
+    width -= 2*Tk_Changes(contentPtr->tkwin)->border_width;
+    height -= 2*Tk_Changes(contentPtr->tkwin)->border_width;
+    if (width <= 0) {
+	width = 1;
+    }
+    if (height <= 0) {
+	height = 1;
+    }
+
+    placePtr->contentPtr = contentPtr;
+    placePtr->x = x;
+    placePtr->y = y;
+    placePtr->width = width;
+    placePtr->height = height;
+}
+
 /*
  *----------------------------------------------------------------------
  *
  * RecomputePlacement --
  *
  *	This function is called as a when-idle handler. It recomputes the
- *	geometries of all the content of a given container.
+ *	geometries of all the content of a given container: one pass
+ *	computes every placement into a packed array, a second pass issues
+ *	the geometry updates. Splitting the passes means window-system
+ *	callbacks triggered by the updates cannot perturb placements that
+ *	are still being computed.
  *
  * Results:
  *	None.
@@ -847,9 +1072,8 @@ RecomputePlacement(
 {
     Container *containerPtr = (Container *)clientData;
     Content *contentPtr;
-    int x, y, width, height, tmp;
-    int containerWidth, containerHeight, containerX, containerY;
-    double x1, y1, x2, y2;
+    Placement *placements, *placePtr;
+    int nPlacements, i;
     int abort;			/* May get set to non-zero to abort this
 				 * placement operation. */
 
@@ -869,151 +1093,48 @@ RecomputePlacement(
     Tcl_Preserve(containerPtr);
 
     /*
-     * Iterate over all the content windows for the container. Each content's geometry can
-     * be computed independently of the other content. Changes to the window's
-     * structure could cause almost anything to happen, including deleting the
-     * parent or child. If this happens, we'll be told to abort.
+     * Pass 1: compute the geometry of every content window. Each content's
+     * geometry can be computed independently of the other content, and
+     * nothing here can trigger callbacks, so the pass cannot be aborted.
      */
 
-    for (contentPtr = containerPtr->contentPtr; contentPtr != NULL && !abort;
+    nPlacements = 0;
+    for (contentPtr = containerPtr->contentPtr; contentPtr != NULL;
 	    contentPtr = contentPtr->nextPtr) {
-	/*
-	 * Step 1: compute size and borderwidth of container, taking into account
-	 * desired border mode.
-	 */
-
-	containerX = containerY = 0;
-	containerWidth = Tk_Width(containerPtr->tkwin);
-	containerHeight = Tk_Height(containerPtr->tkwin);
-	if (contentPtr->borderMode == BM_INSIDE) {
-	    containerX = Tk_InternalBorderLeft(containerPtr->tkwin);
-	    containerY = Tk_InternalBorderTop(containerPtr->tkwin);
-	    containerWidth -= containerX + Tk_InternalBorderRight(containerPtr->tkwin);
-	    containerHeight -= containerY +
-		    Tk_InternalBorderBottom(containerPtr->tkwin);
-	} else if (contentPtr->borderMode == BM_OUTSIDE) {
-	    containerX = containerY = -Tk_Changes(containerPtr->tkwin)->border_width;
-	    containerWidth -= 2 * containerX;
-	    containerHeight -= 2 * containerY;
-	}
-
-	/*
-	 * Step 2: compute size of content (outside dimensions including border)
-	 * and location of anchor point within container.
-	 */
-
-	x1 = contentPtr->x + containerX + (contentPtr->relX*containerWidth);
-	x = (int) (x1 + ((x1 > 0) ? 0.5 : -0.5));
-	y1 = contentPtr->y + containerY + (contentPtr->relY*containerHeight);
-	y = (int) (y1 + ((y1 > 0) ? 0.5 : -0.5));
-	if ((contentPtr->widthPtr) || contentPtr->relWidthPtr) {
-	    width = 0;
-	    if (contentPtr->widthPtr) {
-		width += contentPtr->width;
-	    }
-	    if (contentPtr->relWidthPtr) {
-		/*
-		 * The code below is a bit tricky. In order to round correctly
-		 * when both relX and relWidth are specified, compute the
-		 * location of the right edge and round that, then compute
-		 * width. If we compute the width and round it, rounding
-		 * errors in relX and relWidth accumulate.
-		 */
-
-		x2 = x1 + (contentPtr->relWidth*containerWidth);
-		tmp = (int) (x2 + ((x2 > 0) ? 0.5 : -0.5));
-		width += tmp - x;
-	    }
-	} else {
-	    width = Tk_ReqWidth(contentPtr->tkwin)
-		    + 2*Tk_Changes(contentPtr->tkwin)->border_width;
-	}
-	if (contentPtr->heightPtr || contentPtr->relHeightPtr) {
-	    height = 0;
-	    if (contentPtr->heightPtr) {
-		height += contentPtr->height;
-	    }
-	    if (contentPtr->relHeightPtr) {
-		/*
-		 * See note above for rounding errors in width computation.
-		 */
-
-		y2 = y1 + (contentPtr->relHeight*containerHeight);
-		tmp = (int) (y2 + ((y2 > 0) ? 0.5 : -0.5));
-		height += tmp - y;
-	    }
-	} else {
-	    height = Tk_ReqHeight(contentPtr->tkwin)
-		    + 2*Tk_Changes(contentPtr->tkwin)->border_width;
-	}
-
-	/*
-	 * Step 3: adjust the x and y positions so that the desired anchor
-	 * point on the content appears at that position. Also adjust for the
-	 * border mode and container's border.
-	 */
-
-	switch (contentPtr->anchor) {
-	case TK_ANCHOR_N:
-	    x -= width/2;
-	    break;
-	case TK_ANCHOR_NE:
-	    x -= width;
-	    break;
-	case TK_ANCHOR_E:
-	    x -= width;
-	    y -= height/2;
-	    break;
-	case TK_ANCHOR_SE:
-	    x -= width;
-	    y -= height;
-	    break;
-	case TK_ANCHOR_S:
-	    x -= width/2;
-	    y -= height;
-	    break;
-	case TK_ANCHOR_SW:
-	    y -= height;
-	    break;
-	case TK_ANCHOR_W:
-	    y -= height/2;
-	    break;
-	case TK_ANCHOR_NW:
-	    break;
-	default:
-	    x -= width/2;
-	    y -= height/2;
-	    break;
-	}
-
-	/*
-	 * Step 4: adjust width and height again to reflect inside dimensions
-	 * of window rather than outside. Also make sure that the width and
-	 * height aren't zero.
-	 */
-
-	width -= 2*Tk_Changes(contentPtr->tkwin)->border_width;
-	height -= 2*Tk_Changes(contentPtr->tkwin)->border_width;
-	if (width <= 0) {
-	    width = 1;
-	}
-	if (height <= 0) {
-	    height = 1;
-	}
+	nPlacements++;
+    }
+    if (nPlacements == 0) {
+	containerPtr->abortPtr = NULL;
+	Tcl_Release(containerPtr);
+	return;
+    }
+    placements = (Placement *)ckalloc(nPlacements * sizeof(Placement));
+    for (contentPtr = containerPtr->contentPtr, placePtr = placements;
+	    contentPtr != NULL;
+	    contentPtr = contentPtr->nextPtr, placePtr++) {
+	ComputePlacement(containerPtr, contentPtr, placePtr);
+    }
 
-	/*
-	 * Step 5: reconfigure the window and map it if needed. If the content
-	 * is a child of the container, we do this ourselves. If the content isn't
-	 * a child of the container, let Tk_MaintainGeometry do the work (it will
-	 * re-adjust things as relevant windows map, unmap, and move).
-	 */
+    /*
+     * Pass 2: reconfigure the windows and map them if needed. If a content
+     * is a child of the container, we do this ourselves. If it isn't a
+     * child of the container, let Tk_MaintainGeometry do the work (it will
+     * re-adjust things as relevant windows map, unmap, and move). Changes
+     * to the window's structure could cause almost anything to happen,
+     * including deleting the parent or child. If this happens, we'll be
+     * told to abort.
+     */
 
+    for (i = 0; i < nPlacements && !abort; i++) {
+	placePtr = &placements[i];
+	contentPtr = placePtr->contentPtr;
 	if (containerPtr->tkwin == Tk_Parent(contentPtr->tkwin)) {
-	    if ((x != Tk_X(contentPtr->tkwin))
-		    || (y != Tk_Y(contentPtr->tkwin))
-		    || (width != Tk_Width(contentPtr->tkwin))
-		    || (height != Tk_Height(contentPtr->tkwin))) {
-		Tk_MoveResizeWindow(contentPtr->tkwin, x, y, width, height);
+	    if ((placePtr->x != Tk_X(contentPtr->tkwin))
+		    || (placePtr->y != Tk_Y(contentPtr->tkwin))
+		    || (placePtr->width != Tk_Width(contentPtr->tkwin))
+		    || (placePtr->height != Tk_Height(contentPtr->tkwin))) {
+		Tk_MoveResizeWindow(contentPtr->tkwin, placePtr->x,
+			placePtr->y, placePtr->width, placePtr->height);
 	    }
             if (abort) {
                 break;
@@ -1028,16 +1149,13 @@ RecomputePlacement(
 		Tk_MapWindow(contentPtr->tkwin);
 	    }
 	} else {
-	    if ((width <= 0) || (height <= 0)) {
-		Tk_UnmaintainGeometry(contentPtr->tkwin, containerPtr->tkwin);
-		Tk_UnmapWindow(contentPtr->tkwin);
-	    } else {
-		Tk_MaintainGeometry(contentPtr->tkwin, containerPtr->tkwin,
-			x, y, width, height);
-	    }
+	    Tk_MaintainGeometry(contentPtr->tkwin, containerPtr->tkwin,
+		    placePtr->x, placePtr->y, placePtr->width,
+		    placePtr->height);
 	}
     }
 
+    ckfree(placements);
     containerPtr->abortPtr = NULL;
     Tcl_Release(containerPtr);
 }
@@ -30,6 +30,13 @@ typedef struct {
     TkWindow *lastWinPtr;	/* Last reported mouse window. */
     TkWindow *restrictWinPtr;	/* Window to which all mouse events will be
 				 * reported. */
+    TkWindow *lastPosWinPtr;	/* Window that lastWinPos was computed for,
+				 * or NULL if the cache is invalid. */
+    TkWindow *lastPosRestrictPtr;
+				/* Restrict window that lastWinPos was
+				 * computed against. */
+    int lastWinPos;		/* Cached TkPositionInTree result for the
+				 * pair of windows above. */
     TkWindow *cursorWinPtr;	/* Window that is currently controlling the
 				 * global cursor. */
 } ThreadSpecificData;
@@ -134,8 +141,24 @@ GenerateEnterLeave(
 	if (restrictWinPtr) {
 	    int newPos, oldPos;
 
+	    /*
+	     * During a drag the pointer wanders across window boundaries
+	     * constantly, and this check runs for every motion event. The
+	     * position of the previous window relative to the restrict
+	     * window was already computed last time around, so reuse it
+	     * when possible and walk the tree only for the new window.
+	     */
+
 	    newPos = TkPositionInTree(winPtr, restrictWinPtr);
-	    oldPos = TkPositionInTree(lastWinPtr, restrictWinPtr);
+	    if ((lastWinPtr == tsdPtr->lastPosWinPtr)
+		    && (restrictWinPtr == tsdPtr->lastPosRestrictPtr)) {
+		oldPos = tsdPtr->lastWinPos;
+	    } else {
+		oldPos = TkPositionInTree(lastWinPtr, restrictWinPtr);
+	    }
+	    tsdPtr->lastPosWinPtr = winPtr;
+	    tsdPtr->lastPosRestrictPtr = restrictWinPtr;
+	    tsdPtr->lastWinPos = newPos;
 
 	    /*
 	     * Check if the mouse crossed into or out of the restrict window.
@@ -161,6 +184,9 @@ GenerateEnterLeave(
 		InitializeEvent(&event, restrictWinPtr, type, x, y,
 			state, detail);
 		Tk_QueueWindowEvent(&event, TCL_QUEUE_TAIL);
+		tkPointerStats.synthesized++;
+	    } else {
+		tkPointerStats.skipped++;
 	    }
 
 	} else {
@@ -504,6 +530,9 @@ TkPointerDeadWindow(
     if (winPtr == tsdPtr->lastWinPtr) {
 	tsdPtr->lastWinPtr = TkGetContainer(winPtr);
     }
+    if (winPtr == tsdPtr->lastPosWinPtr) {
+	tsdPtr->lastPosWinPtr = NULL;
+    }
     if (winPtr == tsdPtr->grabWinPtr) {
 	tsdPtr->grabWinPtr = NULL;
     }
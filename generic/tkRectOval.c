@@ -361,14 +361,8 @@ RectOvalCoords(
      * Parse the coordinates and update our bounding box.
      */
 
-    if ((Tk_CanvasGetCoordFromObj(interp, canvas, objv[0],
-		&rectOvalPtr->bbox[0]) != TCL_OK)
-	    || (Tk_CanvasGetCoordFromObj(interp, canvas, objv[1],
-		&rectOvalPtr->bbox[1]) != TCL_OK)
-	    || (Tk_CanvasGetCoordFromObj(interp, canvas, objv[2],
-		&rectOvalPtr->bbox[2]) != TCL_OK)
-	    || (Tk_CanvasGetCoordFromObj(interp, canvas, objv[3],
-		&rectOvalPtr->bbox[3]) != TCL_OK)) {
+    if (TkCanvasGetCoords(interp, canvas, 4, objv,
+	    rectOvalPtr->bbox) != TCL_OK) {
 	return TCL_ERROR;
     }
     ComputeRectOvalBbox(canvas, rectOvalPtr);
@@ -539,7 +539,7 @@ DestroyScale(
 
     Tcl_DeleteCommandFromToken(scalePtr->interp, scalePtr->widgetCmd);
     if (scalePtr->flags & REDRAW_PENDING) {
-	Tcl_CancelIdleCall(TkpDisplayScale, scalePtr);
+	TkCancelDoWhenIdle(TkpDisplayScale, scalePtr);
     }
 
     /*
@@ -1247,7 +1247,7 @@ TkEventuallyRedrawScale(
     }
     if (!(scalePtr->flags & REDRAW_PENDING)) {
 	scalePtr->flags |= REDRAW_PENDING;
-	Tcl_DoWhenIdle(TkpDisplayScale, scalePtr);
+	TkDoWhenIdle(TkpDisplayScale, scalePtr, TK_IDLE_DISPLAY);
     }
     scalePtr->flags |= what;
 }
@@ -639,6 +639,115 @@ TkScrollbarEventuallyRedraw(
     }
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * TkScrollbarUpdate --
+ *
+ *	Give new scroll fractions to the scrollbar named by a widget's
+ *	-xscrollcommand or -yscrollcommand option without going through the
+ *	interpreter.  If the command prefix has the canonical form ".sb set",
+ *	naming a scrollbar widget, the fractions are stored directly and a
+ *	redisplay is scheduled through the usual idle handler, so repeated
+ *	scroll steps cost no script evaluation and at most one repaint.
+ *
+ * Results:
+ *	Returns 1 if the update was delivered to a scrollbar directly.
+ *	Returns 0 if the command prefix is anything other than a plain
+ *	scrollbar "set" prefix; the caller must then evaluate the command as
+ *	before.
+ *
+ * Side effects:
+ *	The scrollbar's fractions and geometry may be updated and a redraw
+ *	scheduled.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkScrollbarUpdate(
+    Tcl_Interp *interp,		/* Interpreter in which the command prefix
+				 * would have been evaluated. */
+    const char *cmdPrefix,	/* Value of the widget's -xscrollcommand or
+				 * -yscrollcommand option. */
+    double first,		/* Fraction of content that is off the top or
+				 * left edge of the window. */
+    double last)		/* Fraction of content at the bottom or right
+				 * edge of the window. */
+{
+    TkScrollbar *scrollPtr;
+    Tcl_CmdInfo info;
+    Tcl_DString name;
+    const char *p, *space = NULL;
+    int found;
+
+    if (cmdPrefix == NULL || cmdPrefix[0] != '.') {
+	return 0;
+    }
+
+    /*
+     * The prefix must consist of a window path name, one space and the word
+     * "set".  Anything containing a character that is special to the Tcl
+     * parser is left to the script path.
+     */
+
+    for (p = cmdPrefix; *p != '\0'; p++) {
+	switch (*p) {
+	case ' ':
+	    if (space != NULL) {
+		return 0;
+	    }
+	    space = p;
+	    break;
+	case '\t': case '\n': case ';': case '[': case ']':
+	case '$': case '\\': case '"': case '{': case '}':
+	    return 0;
+	default:
+	    break;
+	}
+    }
+    if (space == NULL || strcmp(space + 1, "set") != 0) {
+	return 0;
+    }
+
+    Tcl_DStringInit(&name);
+    Tcl_DStringAppend(&name, cmdPrefix, (Tcl_Size)(space - cmdPrefix));
+    found = Tcl_GetCommandInfo(interp, Tcl_DStringValue(&name), &info);
+    Tcl_DStringFree(&name);
+    if (!found || !info.isNativeObjectProc
+	    || info.objProc != ScrollbarWidgetObjCmd) {
+	return 0;
+    }
+    scrollPtr = (TkScrollbar *)info.objClientData;
+    if (scrollPtr->tkwin == NULL) {
+	return 0;
+    }
+
+    /*
+     * Clamp exactly as the "set" widget command does, then skip the
+     * recomputation entirely when nothing changed.
+     */
+
+    if (first < 0) {
+	first = 0;
+    } else if (first > 1.0) {
+	first = 1.0;
+    }
+    if (last < first) {
+	last = first;
+    } else if (last > 1.0) {
+	last = 1.0;
+    }
+    if ((first != scrollPtr->firstFraction)
+	    || (last != scrollPtr->lastFraction)) {
+	scrollPtr->firstFraction = first;
+	scrollPtr->lastFraction = last;
+	TkpComputeScrollbarGeometry(scrollPtr);
+	TkScrollbarEventuallyRedraw(scrollPtr);
+    }
+    return 1;
+}
+
 /*
  * Local Variables:
  * mode: c
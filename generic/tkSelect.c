@@ -66,6 +66,8 @@ static Tcl_ThreadDataKey dataKey;
 static Tcl_Size	HandleTclCommand(void *clientData,
 			    Tcl_Size offset, char *buffer, Tcl_Size maxBytes);
 static void		LostSelection(void *clientData);
+static int		SelGetChanProc(void *clientData,
+			    Tcl_Interp *interp, const char *portion);
 static int		SelGetProc(void *clientData,
 			    Tcl_Interp *interp, const char *portion);
 
@@ -758,12 +760,15 @@ Tk_SelectionObjCmd(
     case SELECTION_GET: {
 	Atom target;
 	const char *targetName = NULL;
+	const char *chanName = NULL;
 	Tcl_DString selBytes;
 	int result;
 	static const char *const getOptionStrings[] = {
-	    "-displayof", "-selection", "-type", NULL
+	    "-channel", "-displayof", "-selection", "-type", NULL
+	};
+	enum getOptions {
+	    GET_CHANNEL, GET_DISPLAYOF, GET_SELECTION, GET_TYPE
 	};
-	enum getOptions { GET_DISPLAYOF, GET_SELECTION, GET_TYPE };
 	int getIndex;
 
 	for (count = objc-2, objs = ((Tcl_Obj **)objv)+2; count>0;
@@ -785,6 +790,9 @@ Tk_SelectionObjCmd(
 	    }
 
 	    switch ((enum getOptions) getIndex) {
+	    case GET_CHANNEL:
+		chanName = Tcl_GetString(objs[1]);
+		break;
 	    case GET_DISPLAYOF:
 		path = Tcl_GetString(objs[1]);
 		break;
@@ -819,6 +827,35 @@ Tk_SelectionObjCmd(
 	    target = XA_STRING;
 	}
 
+	if (chanName != NULL) {
+	    Tcl_Channel chan;
+	    int mode;
+
+	    /*
+	     * Stream the selection to the channel as its pieces arrive,
+	     * rather than assembling it in memory first: retrieving a huge
+	     * selection from another application then needs only one INCR
+	     * chunk's worth of memory at a time, and the consumer's I/O
+	     * overlaps with the transfer. Check that the channel is found
+	     * in this interpreter and that it is open for writing.
+	     */
+
+	    chan = Tcl_GetChannel(interp, chanName, &mode);
+	    if (chan == NULL) {
+		return TCL_ERROR;
+	    }
+	    if (!(mode & TCL_WRITABLE)) {
+		Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+			"channel \"%s\" wasn't opened for writing",
+			chanName));
+		Tcl_SetErrorCode(interp, "TK", "SELECTION", "UNWRITABLE",
+			NULL);
+		return TCL_ERROR;
+	    }
+	    return Tk_GetSelection(interp, tkwin, selection, target,
+		    SelGetChanProc, chan);
+	}
+
 	Tcl_DStringInit(&selBytes);
 	result = Tk_GetSelection(interp, tkwin, selection, target,
 		SelGetProc, &selBytes);
@@ -1301,6 +1338,41 @@ SelGetProc(
     return TCL_OK;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * SelGetChanProc --
+ *
+ *	This function is invoked to process pieces of the selection as they
+ *	arrive during "selection get -channel" commands.
+ *
+ * Results:
+ *	Returns TCL_OK, or TCL_ERROR with an error message in the
+ *	interpreter's result if writing to the channel failed.
+ *
+ * Side effects:
+ *	Bytes get written to the channel given by the clientData argument.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+SelGetChanProc(
+    void *clientData,	/* Channel to write the selection to. */
+    Tcl_Interp *interp,		/* Interpreter used for error reporting. */
+    const char *portion)	/* New information to be written. */
+{
+    Tcl_Channel chan = (Tcl_Channel)clientData;
+
+    if (Tcl_WriteChars(chan, portion, TCL_INDEX_NONE) < 0) {
+	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		"error writing selection to channel: %s",
+		Tcl_PosixError(interp)));
+	return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
 /*
  *----------------------------------------------------------------------
  *
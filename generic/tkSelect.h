@@ -106,7 +106,11 @@ typedef struct TkSelRetrievalInfo {
  */
 
 typedef struct TkClipboardBuffer {
-    char *buffer;		/* Null terminated data buffer. */
+    Tcl_Obj *objPtr;		/* Object holding the data. The buffer keeps
+				 * a reference, so large appends are stored
+				 * without copying. */
+    char *buffer;		/* Null terminated data buffer; points into
+				 * objPtr's string representation. */
     Tcl_Size length;		/* Length of string in buffer. */
     struct TkClipboardBuffer *nextPtr;
 				/* Next in list of buffers. NULL means end of
@@ -121,6 +125,15 @@ typedef struct TkClipboardTarget {
     TkClipboardBuffer *lastBufferPtr;
 				/* Last in list of clipboard buffers. Used to
 				 * speed up appends. */
+    TkClipboardBuffer *reqBufferPtr;
+				/* Buffer the last selection request ended
+				 * in, or NULL. Requestors retrieve large
+				 * selections as a sequence of increasing
+				 * offsets; resuming the scan here makes
+				 * such transfers linear instead of
+				 * quadratic in the number of buffers. */
+    Tcl_Size reqScanned;	/* Offset of reqBufferPtr's first byte from
+				 * the start of the buffer chain. */
     struct TkClipboardTarget *nextPtr;
 				/* Next in list of targets on clipboard. NULL
 				 * means end of list. */
@@ -1242,6 +1242,8 @@ const TkStubs tkStubs = {
     Tk_GetOtherWindow, /* 288 */
     Tk_Get3DBorderColors, /* 289 */
     Tk_MakeWindow, /* 290 */
+    Tk_CreateGenericHandlerForType, /* 291 */
+    Tk_UpdateTextLayout, /* 292 */
 };
 
 /* !END!: Do not edit above this line. */
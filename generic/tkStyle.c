@@ -30,6 +30,22 @@ typedef struct StyledWidgetSpec {
 				 * registration. Malloc'd. */
 } StyledWidgetSpec;
 
+/*
+ * Widget specs are small, fixed-size, and live until the style package is
+ * torn down, so they are carved out of the following blocks instead of being
+ * allocated individually. This also keeps the Tk_StyledElement tokens
+ * returned to widgets stable: a spec is never moved by a reallocation once
+ * it has been handed out.
+ */
+
+#define SPECS_PER_BLOCK	32
+
+typedef struct SpecBlock {
+    struct SpecBlock *nextPtr;	/* Next in list of all allocated blocks. */
+    StyledWidgetSpec specs[SPECS_PER_BLOCK];
+				/* Storage for the widget specs. */
+} SpecBlock;
+
 /*
  * Elements are declared using static templates. But static information must
  * be completed by dynamic information only accessible at runtime. For each
@@ -43,13 +59,25 @@ typedef struct StyledElement {
 				/* Filled with template provided during
 				 * registration. NULL means no implementation
 				 * is available for the current engine. */
-    int nbWidgetSpecs;		/* Size of the array below. Number of distinct
-				 * widget classes (actually, distinct option
-				 * tables) that used the element so far. */
-    StyledWidgetSpec *widgetSpecs;
+    int nbWidgetSpecs;		/* Number of widget specs in the array below.
+				 * Number of distinct widget classes
+				 * (actually, distinct option tables) that
+				 * used the element so far. */
+    int maxWidgetSpecs;		/* Number of entries allocated for the array
+				 * below. */
+    StyledWidgetSpec **widgetSpecs;
 				/* See above for the structure definition.
-				 * Table grows dynamically as new widgets use
-				 * the element. Malloc'd. */
+				 * Table of pointers to block-allocated
+				 * specs; grows dynamically as new widgets
+				 * use the element. Malloc'd. */
+    struct StyledElement *resolvedPtr;
+				/* Cached result of resolving this element
+				 * through the engine chain and the generic
+				 * elements. May be NULL if no implementation
+				 * was found. Only valid when resolvedEpoch
+				 * matches the registry epoch. */
+    size_t resolvedEpoch;	/* Value of the registry epoch when
+				 * resolvedPtr was cached. */
 } StyledElement;
 
 /*
@@ -112,6 +140,14 @@ typedef struct {
     Tcl_HashTable elementTable;	/* Map a name to an element Id. Keys are
 				 * strings, values are integer element IDs. */
     Element *elements;		/* Array of Elements. */
+    size_t stylesEpoch;		/* Incremented each time an element or an
+				 * element implementation is registered.
+				 * Used to validate the resolution caches
+				 * kept in StyledElement structures. */
+    SpecBlock *specBlockPtr;	/* First in list of widget spec blocks. Only
+				 * the first block in the list may have free
+				 * slots. */
+    int numUsedSpecs;		/* Number of slots used in the first block. */
 } ThreadSpecificData;
 
 static Tcl_ThreadDataKey dataKey;
@@ -120,6 +156,7 @@ static Tcl_ThreadDataKey dataKey;
  * Forward declarations for functions defined later in this file:
  */
 
+static StyledWidgetSpec *AllocWidgetSpec(ThreadSpecificData *tsdPtr);
 static int		CreateElement(const char *name, int create);
 static void		DupStyleObjProc(Tcl_Obj *srcObjPtr,
 			    Tcl_Obj *dupObjPtr);
@@ -198,6 +235,9 @@ TkStylePkgInit(
     Tcl_InitHashTable(&tsdPtr->elementTable, TCL_STRING_KEYS);
     tsdPtr->nbElements = 0;
     tsdPtr->elements = NULL;
+    tsdPtr->stylesEpoch = 1;
+    tsdPtr->specBlockPtr = NULL;
+    tsdPtr->numUsedSpecs = 0;
 
     /*
      * Create the default system engine.
@@ -282,6 +322,19 @@ TkStylePkgFree(
     }
     Tcl_DeleteHashTable(&tsdPtr->elementTable);
     ckfree(tsdPtr->elements);
+
+    /*
+     * Free the widget spec blocks. The option arrays inside the specs were
+     * freed along with the engines above.
+     */
+
+    while (tsdPtr->specBlockPtr != NULL) {
+	SpecBlock *blockPtr = tsdPtr->specBlockPtr;
+
+	tsdPtr->specBlockPtr = blockPtr->nextPtr;
+	ckfree(blockPtr);
+    }
+    tsdPtr->numUsedSpecs = 0;
 }
 
 /*
@@ -578,7 +631,7 @@ FreeStyledElement(
      */
 
     for (i = 0; i < elementPtr->nbWidgetSpecs; i++) {
-	FreeWidgetSpec(elementPtr->widgetSpecs+i);
+	FreeWidgetSpec(elementPtr->widgetSpecs[i]);
     }
     ckfree(elementPtr->widgetSpecs);
 }
@@ -640,6 +693,13 @@ CreateElement(
     elementId = tsdPtr->nbElements++;
     Tcl_SetHashValue(entryPtr, INT2PTR(elementId));
 
+    /*
+     * The engines' element tables are about to be reallocated, which moves
+     * the targets of any cached resolution results, so invalidate them all.
+     */
+
+    tsdPtr->stylesEpoch++;
+
     /*
      * Reallocate element table.
      */
@@ -762,6 +822,7 @@ Tk_RegisterStyledElement(
     Tk_ElementSpec *specPtr;
     int nbOptions;
     Tk_ElementOptionSpec *srcOptions, *dstOptions;
+    ThreadSpecificData *tsdPtr;
 
     if (templatePtr->version != TK_STYLE_VERSION_1) {
 	/*
@@ -817,8 +878,18 @@ Tk_RegisterStyledElement(
 
     elementPtr->specPtr = specPtr;
     elementPtr->nbWidgetSpecs = 0;
+    elementPtr->maxWidgetSpecs = 0;
     elementPtr->widgetSpecs = NULL;
 
+    /*
+     * The new implementation may change how this element resolves for
+     * engines that inherit from this one, so invalidate the caches.
+     */
+
+    tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    tsdPtr->stylesEpoch++;
+
     return elementId;
 }
 
@@ -845,7 +916,7 @@ GetStyledElement(
 				 * NULL means the default system engine. */
     Tcl_Size elementId)		/* Unique element ID */
 {
-    StyledElement *elementPtr;
+    StyledElement *elementPtr, *cachePtr, *resolvedPtr = NULL;
     ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
 	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
     StyleEngine *enginePtr2;
@@ -854,6 +925,24 @@ GetStyledElement(
 	enginePtr = tsdPtr->defaultEnginePtr;
     }
 
+    /*
+     * The result of the resolution below only changes when an element or an
+     * element implementation is registered, which bumps the registry epoch,
+     * so a previous result cached under the current epoch is still valid.
+     * The cache lives in the starting engine's slot for the original
+     * element ID; the resolved element may belong to a parent engine or be
+     * a generic element.
+     */
+
+    if (elementId >= 0 && elementId < tsdPtr->nbElements) {
+	cachePtr = enginePtr->elements+elementId;
+	if (cachePtr->resolvedEpoch == tsdPtr->stylesEpoch) {
+	    return cachePtr->resolvedPtr;
+	}
+    } else {
+	cachePtr = NULL;
+    }
+
     while (elementId != TCL_INDEX_NONE && elementId < tsdPtr->nbElements) {
 	/*
 	 * Look for an implemented element through the engine chain.
@@ -863,10 +952,14 @@ GetStyledElement(
 	do {
 	    elementPtr = enginePtr2->elements+elementId;
 	    if (elementPtr->specPtr != NULL) {
-		return elementPtr;
+		resolvedPtr = elementPtr;
+		break;
 	    }
 	    enginePtr2 = enginePtr2->parentPtr;
 	} while (enginePtr2 != NULL);
+	if (resolvedPtr != NULL) {
+	    break;
+	}
 
 	/*
 	 * None found, try with the generic element.
@@ -875,11 +968,16 @@ GetStyledElement(
 	elementId = tsdPtr->elements[elementId].genericId;
     }
 
+    if (cachePtr != NULL) {
+	cachePtr->resolvedPtr = resolvedPtr;
+	cachePtr->resolvedEpoch = tsdPtr->stylesEpoch;
+    }
+
     /*
-     * No matching element found.
+     * NULL if no matching element was found.
      */
 
-    return NULL;
+    return resolvedPtr;
 }
 
 /*
@@ -969,6 +1067,39 @@ FreeWidgetSpec(
     ckfree(widgetSpecPtr->optionsPtr);
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * AllocWidgetSpec --
+ *
+ *	Return storage for a new widget spec, carving it out of the current
+ *	spec block or allocating a fresh block when the current one is full.
+ *
+ * Results:
+ *	A pointer to an uninitialized widget spec. The storage stays at the
+ *	same address until the style package is torn down.
+ *
+ * Side effects:
+ *	Memory may be allocated.
+ *
+ *---------------------------------------------------------------------------
+ */
+
+static StyledWidgetSpec *
+AllocWidgetSpec(
+    ThreadSpecificData *tsdPtr)	/* Thread-local style package data. */
+{
+    SpecBlock *blockPtr = tsdPtr->specBlockPtr;
+
+    if (blockPtr == NULL || tsdPtr->numUsedSpecs >= SPECS_PER_BLOCK) {
+	blockPtr = (SpecBlock *)ckalloc(sizeof(SpecBlock));
+	blockPtr->nextPtr = tsdPtr->specBlockPtr;
+	tsdPtr->specBlockPtr = blockPtr;
+	tsdPtr->numUsedSpecs = 0;
+    }
+    return blockPtr->specs + tsdPtr->numUsedSpecs++;
+}
+
 /*
  *---------------------------------------------------------------------------
  *
@@ -993,26 +1124,35 @@ GetWidgetSpec(
 {
     StyledWidgetSpec *widgetSpecPtr;
     int i;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
 
     /*
      * Try to find an existing widget spec.
      */
 
     for (i = 0; i < elementPtr->nbWidgetSpecs; i++) {
-	widgetSpecPtr = elementPtr->widgetSpecs+i;
+	widgetSpecPtr = elementPtr->widgetSpecs[i];
 	if (widgetSpecPtr->optionTable == optionTable) {
 	    return widgetSpecPtr;
 	}
     }
 
     /*
-     * Create and initialize a new widget spec.
+     * Create and initialize a new widget spec, growing the pointer table
+     * geometrically so that repeated use of an element by new widget
+     * classes doesn't reallocate on every addition.
      */
 
-    i = elementPtr->nbWidgetSpecs++;
-    elementPtr->widgetSpecs = (StyledWidgetSpec *)ckrealloc(elementPtr->widgetSpecs,
-	    sizeof(StyledWidgetSpec) * elementPtr->nbWidgetSpecs);
-    widgetSpecPtr = elementPtr->widgetSpecs+i;
+    if (elementPtr->nbWidgetSpecs >= elementPtr->maxWidgetSpecs) {
+	elementPtr->maxWidgetSpecs = (elementPtr->maxWidgetSpecs == 0 ?
+		4 : 2*elementPtr->maxWidgetSpecs);
+	elementPtr->widgetSpecs = (StyledWidgetSpec **)ckrealloc(
+		elementPtr->widgetSpecs,
+		sizeof(StyledWidgetSpec *) * elementPtr->maxWidgetSpecs);
+    }
+    widgetSpecPtr = AllocWidgetSpec(tsdPtr);
+    elementPtr->widgetSpecs[elementPtr->nbWidgetSpecs++] = widgetSpecPtr;
     InitWidgetSpec(widgetSpecPtr, elementPtr, optionTable);
 
     return widgetSpecPtr;
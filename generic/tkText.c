@@ -180,6 +180,9 @@ static const Tk_OptionSpec optionSpecs[] = {
     {TK_OPTION_INT, "-maxundo", "maxUndo", "MaxUndo",
 	DEF_TEXT_MAX_UNDO, TCL_INDEX_NONE, offsetof(TkText, maxUndo),
 	TK_OPTION_DONT_SET_DEFAULT, 0, 0},
+    {TK_OPTION_INT, "-maxundosize", "maxUndoSize", "MaxUndoSize",
+	DEF_TEXT_MAX_UNDO_SIZE, TCL_INDEX_NONE, offsetof(TkText, maxUndoSize),
+	TK_OPTION_DONT_SET_DEFAULT, 0, 0},
     {TK_OPTION_PIXELS, "-padx", "padX", "Pad",
 	DEF_TEXT_PADX, TCL_INDEX_NONE, offsetof(TkText, padX), 0, 0,
 	TK_TEXT_LINE_GEOMETRY},
@@ -294,6 +297,13 @@ typedef struct SearchSpec {
     Tcl_Obj *countPtr;		/* Keeps track of currently found lengths. */
     Tcl_Obj *resPtr;		/* Keeps track of currently found locations */
     int searchElide;		/* Search in hidden text as well. */
+    int indexed;		/* Use the shared per-line content cache
+				 * instead of walking B-tree segments for
+				 * every line examined. */
+    Tcl_Size indexOffset;	/* Offset to add to this widget's line
+				 * numbers to get line numbers in the shared
+				 * cache (non-zero for peers with
+				 * -startline). */
     SearchAddLineProc *addLineProc;
 				/* Function to call when we need to add
 				 * another line to the search string so far */
@@ -307,6 +317,25 @@ typedef struct SearchSpec {
 				 * in this case a text widget. */
 } SearchSpec;
 
+/*
+ * The data structure below is the per-line content cache behind the widget's
+ * "search -indexed" mode: one Tcl_Obj per logical line holding the
+ * concatenated character segments of that line. It is built on demand by
+ * TextSearchIndexUpdate, shared by all peers, and considered stale as soon
+ * as the shared stateEpoch no longer matches the stamp taken when it was
+ * built.
+ */
+
+typedef struct TkTextSearchIndex {
+    Tcl_Size numLines;		/* Number of entries in the arrays below. */
+    Tcl_Size epoch;		/* Value of the shared stateEpoch when this
+				 * index was built. */
+    TkTextLine **linePtrs;	/* B-tree line of each logical line; only
+				 * valid while epoch matches. */
+    Tcl_Obj **lineObjs;		/* Character content of each logical line,
+				 * including the trailing newline. */
+} TkTextSearchIndex;
+
 /*
  * The text-widget-independent functions which actually perform the search,
  * handling both regexp and exact searches.
@@ -342,11 +371,14 @@ static void		DestroyText(TkText *textPtr);
 static int		InsertChars(TkSharedText *sharedTextPtr,
 			    TkText *textPtr, TkTextIndex *indexPtr,
 			    Tcl_Obj *stringPtr, int viewUpdate);
-static void		TextBlinkProc(void *clientData);
+static void		TextBlinkProc(void *clientData, int on);
+static void		TextBlinkReset(TkText *textPtr);
+static void		TextRedrawInsert(TkText *textPtr);
 static Tcl_CmdDeleteProc TextCmdDeletedProc;
 static int		CreateWidget(TkSharedText *sharedPtr, Tk_Window tkwin,
 			    Tcl_Interp *interp, const TkText *parent,
 			    Tcl_Size objc, Tcl_Obj *const objv[]);
+static int		WidthChangeAffectsLineHeights(TkText *textPtr);
 static void		TextEventProc(void *clientData,
 			    XEvent *eventPtr);
 static Tcl_Size	TextFetchSelection(void *clientData, Tcl_Size offset,
@@ -361,6 +393,8 @@ static int		TextReplaceCmd(TkText *textPtr, Tcl_Interp *interp,
 			    const TkTextIndex *indexFromPtr,
 			    const TkTextIndex *indexToPtr,
 			    Tcl_Size objc, Tcl_Obj *const objv[], int viewUpdate);
+static void		TextSearchIndexFree(TkSharedText *sharedTextPtr);
+static void		TextSearchIndexUpdate(TkText *textPtr);
 static int		TextSearchCmd(TkText *textPtr, Tcl_Interp *interp,
 			    Tcl_Size objc, Tcl_Obj *const objv[]);
 static int		TextEditCmd(TkText *textPtr, Tcl_Interp *interp,
@@ -378,6 +412,16 @@ static int		DumpSegment(TkText *textPtr, Tcl_Interp *interp,
 			    const char *key, const char *value,
 			    Tcl_Obj *command, const TkTextIndex *index,
 			    int what);
+static int		TextSerializeCmd(TkText *textPtr, Tcl_Interp *interp,
+			    Tcl_Size objc, Tcl_Obj *const objv[]);
+static int		TextDeserializeCmd(TkText *textPtr,
+			    Tcl_Interp *interp, Tcl_Size objc,
+			    Tcl_Obj *const objv[]);
+static void		SerializeUint32(Tcl_DString *dsPtr,
+			    unsigned int value);
+static int		DeserializeUint32(const unsigned char **pPtr,
+			    const unsigned char *end,
+			    unsigned int *valuePtr);
 static int		TextEditUndo(TkText *textPtr);
 static int		TextEditRedo(TkText *textPtr);
 static Tcl_Obj *	TextGetText(const TkText *textPtr,
@@ -525,14 +569,21 @@ CreateWidget(
 	Tcl_InitHashTable(&sharedPtr->markTable, TCL_STRING_KEYS);
 	Tcl_InitHashTable(&sharedPtr->windowTable, TCL_STRING_KEYS);
 	Tcl_InitHashTable(&sharedPtr->imageTable, TCL_STRING_KEYS);
+	Tcl_InitHashTable(&sharedPtr->imageInstanceTable, TCL_STRING_KEYS);
 	sharedPtr->undoStack = TkUndoInitStack(interp,0);
 	sharedPtr->undo = 0;
+	sharedPtr->maxUndoSize = 0;
 	sharedPtr->isDirty = 0;
 	sharedPtr->dirtyMode = TK_TEXT_DIRTY_NORMAL;
 	sharedPtr->autoSeparators = 1;
 	sharedPtr->lastEditMode = TK_TEXT_EDIT_OTHER;
 	sharedPtr->stateEpoch = 0;
 	sharedPtr->imageCount = 0;
+	sharedPtr->numElideTags = 0;
+	sharedPtr->tagScanEpoch = 0;
+	sharedPtr->searchIndexPtr = NULL;
+	sharedPtr->elideTablePtr = NULL;
+	sharedPtr->markIndexPtr = NULL;
     }
 
     /*
@@ -594,6 +645,7 @@ CreateWidget(
     textPtr->pickEvent.type = LeaveNotify;
     textPtr->undo = textPtr->sharedTextPtr->undo;
     textPtr->maxUndo = textPtr->sharedTextPtr->maxUndo;
+    textPtr->maxUndoSize = textPtr->sharedTextPtr->maxUndoSize;
     textPtr->autoSeparators = textPtr->sharedTextPtr->autoSeparators;
     textPtr->tabOptionPtr = NULL;
 
@@ -683,17 +735,18 @@ TextWidgetObjCmd(
 
     static const char *const optionStrings[] = {
 	"bbox", "cget", "compare", "configure", "count", "debug", "delete",
-	"dlineinfo", "dump", "edit", "get", "image", "index", "insert",
-	"mark", "peer", "pendingsync", "replace", "scan", "search",
-	"see", "sync", "tag", "window", "xview", "yview", NULL
+	"deserialize", "dlineinfo", "dump", "edit", "get", "image", "index",
+	"insert", "load", "mark", "peer", "pendingsync", "replace", "scan",
+	"search", "see", "serialize", "sync", "tag", "window", "xview",
+	"yview", NULL
     };
     enum options {
 	TEXT_BBOX, TEXT_CGET, TEXT_COMPARE, TEXT_CONFIGURE, TEXT_COUNT,
-	TEXT_DEBUG, TEXT_DELETE, TEXT_DLINEINFO, TEXT_DUMP, TEXT_EDIT,
-	TEXT_GET, TEXT_IMAGE, TEXT_INDEX, TEXT_INSERT, TEXT_MARK,
-	TEXT_PEER, TEXT_PENDINGSYNC, TEXT_REPLACE, TEXT_SCAN,
-	TEXT_SEARCH, TEXT_SEE, TEXT_SYNC, TEXT_TAG, TEXT_WINDOW,
-	TEXT_XVIEW, TEXT_YVIEW
+	TEXT_DEBUG, TEXT_DELETE, TEXT_DESERIALIZE, TEXT_DLINEINFO, TEXT_DUMP,
+	TEXT_EDIT, TEXT_GET, TEXT_IMAGE, TEXT_INDEX, TEXT_INSERT, TEXT_LOAD,
+	TEXT_MARK, TEXT_PEER, TEXT_PENDINGSYNC, TEXT_REPLACE, TEXT_SCAN,
+	TEXT_SEARCH, TEXT_SEE, TEXT_SERIALIZE, TEXT_SYNC, TEXT_TAG,
+	TEXT_WINDOW, TEXT_XVIEW, TEXT_YVIEW
     };
 
     if (objc < 2) {
@@ -1039,12 +1092,21 @@ TextWidgetObjCmd(
     }
     case TEXT_DEBUG:
 	if (objc > 3) {
-	    Tcl_WrongNumArgs(interp, 2, objv, "boolean");
+	    Tcl_WrongNumArgs(interp, 2, objv, "?boolean|stats|reset?");
 	    result = TCL_ERROR;
 	    goto done;
 	}
 	if (objc == 2) {
 	    Tcl_SetObjResult(interp, Tcl_NewBooleanObj(tkBTreeDebug));
+	} else if (strcmp(Tcl_GetString(objv[2]), "stats") == 0) {
+	    /*
+	     * Report the display performance counters kept by
+	     * tkTextDisp.c.
+	     */
+
+	    Tcl_SetObjResult(interp, TkTextStatsObj(textPtr));
+	} else if (strcmp(Tcl_GetString(objv[2]), "reset") == 0) {
+	    TkTextStatsReset(textPtr);
 	} else {
 	    if (Tcl_GetBooleanFromObj(interp, objv[2],
 		    &tkBTreeDebug) != TCL_OK) {
@@ -1200,6 +1262,9 @@ TextWidgetObjCmd(
 	    }
 	}
 	break;
+    case TEXT_DESERIALIZE:
+	result = TextDeserializeCmd(textPtr, interp, objc, objv);
+	break;
     case TEXT_DLINEINFO: {
 	int x, y, width, height, base;
 	const TkTextIndex *indexPtr;
@@ -1369,6 +1434,72 @@ TextWidgetObjCmd(
 	}
 	break;
     }
+    case TEXT_LOAD: {
+	Tcl_Channel chan;
+	int mode, savedUndo;
+	Tcl_Obj *chunkObj;
+	TkTextIndex index;
+	Tcl_Size count;
+
+	/*
+	 * Streaming bulk append: read the channel in large chunks and
+	 * insert each at "end" with undo recording suppressed, so loading
+	 * a huge file neither materializes it as one Tcl string nor pays
+	 * per-line insertion bookkeeping. The chunk size is large enough
+	 * that B-tree insertion and display invalidation costs are
+	 * amortized to noise.
+	 */
+
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "channel");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	chan = Tcl_GetChannel(interp, Tcl_GetString(objv[2]), &mode);
+	if (chan == NULL) {
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if (!(mode & TCL_READABLE)) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "channel \"%s\" wasn't opened for reading",
+		    Tcl_GetString(objv[2])));
+	    Tcl_SetErrorCode(interp, "TK", "TEXT", "LOAD", (char *)NULL);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if (textPtr->state == TK_TEXT_STATE_DISABLED) {
+	    break;
+	}
+	savedUndo = textPtr->sharedTextPtr->undo;
+	textPtr->sharedTextPtr->undo = 0;
+	chunkObj = Tcl_NewObj();
+	Tcl_IncrRefCount(chunkObj);
+	while (1) {
+	    count = Tcl_ReadChars(chan, chunkObj, 262144, 0);
+	    if (count == TCL_IO_FAILURE) {
+		Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+			"error reading from channel \"%s\": %s",
+			Tcl_GetString(objv[2]), Tcl_PosixError(interp)));
+		Tcl_SetErrorCode(interp, "TK", "TEXT", "LOAD", (char *)NULL);
+		result = TCL_ERROR;
+		break;
+	    }
+	    if (count == 0) {
+		break;
+	    }
+	    TkTextMakeByteIndex(textPtr->sharedTextPtr->tree, textPtr,
+		    TkBTreeNumLines(textPtr->sharedTextPtr->tree, textPtr),
+		    0, &index);
+	    InsertChars(textPtr->sharedTextPtr, textPtr, &index, chunkObj, 0);
+	    if (!Tcl_Eof(chan) && Tcl_InputBlocked(chan)) {
+		break;
+	    }
+	}
+	textPtr->sharedTextPtr->undo = savedUndo;
+	Tcl_DecrRefCount(chunkObj);
+	break;
+    }
     case TEXT_MARK:
 	result = TkTextMarkCmd(textPtr, interp, objc, objv);
 	break;
@@ -1479,9 +1610,13 @@ TextWidgetObjCmd(
                             indexFromByteOffset, &indexTmp);
                     TkTextIndexForwChars(NULL, &indexTmp,
 			    deleteInsertOffset, &index, COUNT_INDICES);
+		    TkTextMarkIndexRemove(textPtr->sharedTextPtr,
+			    textPtr->insertMarkPtr);
 		    TkBTreeUnlinkSegment(textPtr->insertMarkPtr,
 			    textPtr->insertMarkPtr->body.mark.linePtr);
 		    TkBTreeLinkSegment(textPtr->insertMarkPtr, &index);
+		    TkTextMarkIndexAdd(textPtr->sharedTextPtr,
+			    textPtr->insertMarkPtr);
 		}
 	    } else {
 		result = TextReplaceCmd(textPtr, interp, indexFromPtr,
@@ -1508,6 +1643,9 @@ TextWidgetObjCmd(
     case TEXT_SEE:
 	result = TkTextSeeCmd(textPtr, interp, objc, objv);
 	break;
+    case TEXT_SERIALIZE:
+	result = TextSerializeCmd(textPtr, interp, objc, objv);
+	break;
     case TEXT_SYNC: {
 	if (objc == 4) {
 	    Tcl_Obj *cmd = objv[3];
@@ -1525,7 +1663,7 @@ TextWidgetObjCmd(
 		textPtr->afterSyncCmd = cmd;
 	    } else {
 		textPtr->afterSyncCmd = cmd;
-		Tcl_DoWhenIdle(TkTextRunAfterSyncCmd, textPtr);
+		TkDoWhenIdle(TkTextRunAfterSyncCmd, textPtr, TK_IDLE_DEFERRED);
 	    }
 	    break;
 	} else if (objc != 2) {
@@ -1934,9 +2072,11 @@ DestroyText(
      */
 
     TkTextDeleteTag(textPtr, textPtr->selTagPtr);
+    TkTextMarkIndexRemove(sharedTextPtr, textPtr->insertMarkPtr);
     TkBTreeUnlinkSegment(textPtr->insertMarkPtr,
 	    textPtr->insertMarkPtr->body.mark.linePtr);
     ckfree(textPtr->insertMarkPtr);
+    TkTextMarkIndexRemove(sharedTextPtr, textPtr->currentMarkPtr);
     TkBTreeUnlinkSegment(textPtr->currentMarkPtr,
 	    textPtr->currentMarkPtr->body.mark.linePtr);
     ckfree(textPtr->currentMarkPtr);
@@ -2006,23 +2146,25 @@ DestroyText(
 	    ckfree(Tcl_GetHashValue(hPtr));
 	}
 	Tcl_DeleteHashTable(&sharedTextPtr->markTable);
+	TkTextFreeMarkIndex(sharedTextPtr);
 	TkUndoFreeStack(sharedTextPtr->undoStack);
 
 	Tcl_DeleteHashTable(&sharedTextPtr->windowTable);
 	Tcl_DeleteHashTable(&sharedTextPtr->imageTable);
+	Tcl_DeleteHashTable(&sharedTextPtr->imageInstanceTable);
 
 	if (sharedTextPtr->bindingTable != NULL) {
 	    Tk_DeleteBindingTable(sharedTextPtr->bindingTable);
 	}
+	TextSearchIndexFree(sharedTextPtr);
+	TkTextFreeElideTable(sharedTextPtr);
 	ckfree(sharedTextPtr);
     }
 
     if (textPtr->tabArrayPtr != NULL) {
 	ckfree(textPtr->tabArrayPtr);
     }
-    if (textPtr->insertBlinkHandler != NULL) {
-	Tcl_DeleteTimerHandler(textPtr->insertBlinkHandler);
-    }
+    TkBlinkRemove(TextBlinkProc, textPtr);
 
     textPtr->tkwin = NULL;
     Tcl_DeleteCommandFromToken(textPtr->interp, textPtr->widgetCmd);
@@ -2077,10 +2219,14 @@ ConfigureText(
 
     textPtr->sharedTextPtr->undo = textPtr->undo;
     textPtr->sharedTextPtr->maxUndo = textPtr->maxUndo;
+    textPtr->sharedTextPtr->maxUndoSize = textPtr->maxUndoSize;
     textPtr->sharedTextPtr->autoSeparators = textPtr->autoSeparators;
 
     TkUndoSetMaxDepth(textPtr->sharedTextPtr->undoStack,
 	    textPtr->sharedTextPtr->maxUndo);
+    TkUndoSetMaxSize(textPtr->sharedTextPtr->undoStack,
+	    (textPtr->sharedTextPtr->maxUndoSize > 0)
+	    ? (size_t)textPtr->sharedTextPtr->maxUndoSize : 0);
 
     /*
      * A few other options also need special processing, such as parsing the
@@ -2317,9 +2463,7 @@ ConfigureText(
      */
 
     if (textPtr->flags & GOT_FOCUS) {
-	Tcl_DeleteTimerHandler(textPtr->insertBlinkHandler);
-	textPtr->insertBlinkHandler = NULL;
-	TextBlinkProc(textPtr);
+	TextBlinkReset(textPtr);
     }
 
     /*
@@ -2429,6 +2573,51 @@ TextWorldChanged(
     TkTextRelayoutWindow(textPtr, mask);
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * WidthChangeAffectsLineHeights --
+ *
+ *	Determine whether a change in the window width of a text widget can
+ *	change the pixel height of any line, i.e. whether any text in the
+ *	widget may wrap.
+ *
+ * Results:
+ *	Returns 0 if neither the widget's -wrap option nor any tag's -wrap
+ *	option can make text wrap, 1 otherwise.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+WidthChangeAffectsLineHeights(
+    TkText *textPtr)		/* Information about text widget. */
+{
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
+
+    if (textPtr->wrapMode != TEXT_WRAPMODE_NONE) {
+	return 1;
+    }
+    if (textPtr->selTagPtr->wrapMode == TEXT_WRAPMODE_CHAR
+	    || textPtr->selTagPtr->wrapMode == TEXT_WRAPMODE_WORD) {
+	return 1;
+    }
+    for (hPtr = Tcl_FirstHashEntry(&textPtr->sharedTextPtr->tagTable,
+	    &search); hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	TkTextTag *tagPtr = (TkTextTag *)Tcl_GetHashValue(hPtr);
+
+	if (tagPtr->wrapMode == TEXT_WRAPMODE_CHAR
+		|| tagPtr->wrapMode == TEXT_WRAPMODE_WORD) {
+	    return 1;
+	}
+    }
+    return 0;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -2465,7 +2654,17 @@ TextEventProc(
 		|| (textPtr->prevHeight != Tk_Height(textPtr->tkwin))) {
 	    int mask = 0;
 
-	    if (textPtr->prevWidth != Tk_Width(textPtr->tkwin)) {
+	    if ((textPtr->prevWidth != Tk_Width(textPtr->tkwin))
+		    && WidthChangeAffectsLineHeights(textPtr)) {
+		/*
+		 * A width change can only alter line heights when text
+		 * wraps. When nothing in the widget wraps, every logical
+		 * line occupies one display line whose height is
+		 * independent of the window width, so skipping the metric
+		 * invalidation avoids an asynchronous re-measurement of
+		 * the whole document on every horizontal resize.
+		 */
+
 		mask = TK_TEXT_LINE_GEOMETRY;
 	    }
 	    TkTextRelayoutWindow(textPtr, mask);
@@ -2508,16 +2707,15 @@ TextEventProc(
 	if (eventPtr->xfocus.detail == NotifyInferior
 		|| eventPtr->xfocus.detail == NotifyAncestor
 		|| eventPtr->xfocus.detail == NotifyNonlinear) {
-	    Tcl_DeleteTimerHandler(textPtr->insertBlinkHandler);
 	    if (eventPtr->type == FocusIn) {
 		textPtr->flags |= GOT_FOCUS | INSERT_ON;
 		if (textPtr->insertOffTime != 0) {
-		    textPtr->insertBlinkHandler = Tcl_CreateTimerHandler(
-			    textPtr->insertOnTime, TextBlinkProc, textPtr);
+		    TkBlinkAdd(TextBlinkProc, textPtr,
+			    textPtr->insertOnTime, textPtr->insertOffTime);
 		}
 	    } else {
 		textPtr->flags &= ~(GOT_FOCUS | INSERT_ON);
-		textPtr->insertBlinkHandler = NULL;
+		TkBlinkRemove(TextBlinkProc, textPtr);
 	    }
 	    if (textPtr->inactiveSelBorder != textPtr->selBorder) {
 		TkTextRedrawTag(NULL, textPtr, NULL, NULL, textPtr->selTagPtr,
@@ -3600,29 +3798,65 @@ TkTextSelectionEvent(
  *
  * TextBlinkProc --
  *
- *	This function is called as a timer handler to blink the insertion
- *	cursor off and on.
+ *	This function is called from the shared blink timer (see tkBlink.c)
+ *	whenever its phase changes, to blink the insertion cursor off and
+ *	on.
  *
  * Results:
  *	None.
  *
  * Side effects:
- *	The cursor gets turned on or off, redisplay gets invoked, and this
- *	function reschedules itself.
+ *	The cursor gets turned on or off and its area gets redisplayed.
  *
  *----------------------------------------------------------------------
  */
 
 static void
 TextBlinkProc(
-    void *clientData)	/* Pointer to record describing text. */
+    void *clientData,		/* Pointer to record describing text. */
+    int on)			/* New phase of the shared blink timer. */
 {
     TkText *textPtr = (TkText *)clientData;
-    TkTextIndex index;
-    int x, y, w, h, charWidth;
 
     if ((textPtr->state == TK_TEXT_STATE_DISABLED) ||
 	    !(textPtr->flags & GOT_FOCUS) || (textPtr->insertOffTime == 0)) {
+	TkBlinkRemove(TextBlinkProc, textPtr);
+	return;
+    }
+    if (on) {
+	textPtr->flags |= INSERT_ON;
+    } else {
+	textPtr->flags &= ~INSERT_ON;
+    }
+    TextRedrawInsert(textPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TextBlinkReset --
+ *
+ *	Brings the blinking of the insertion cursor into line with the
+ *	current widget options and state. Called after reconfiguration while
+ *	the widget has the focus.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The widget is subscribed to or removed from the shared blink timer,
+ *	and the cursor may be displayed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+TextBlinkReset(
+    TkText *textPtr)		/* Text widget to update. */
+{
+    if ((textPtr->state == TK_TEXT_STATE_DISABLED) ||
+	    !(textPtr->flags & GOT_FOCUS) || (textPtr->insertOffTime == 0)) {
+	TkBlinkRemove(TextBlinkProc, textPtr);
 	if (!(textPtr->flags & GOT_FOCUS) &&
 		(textPtr->insertUnfocussed != TK_TEXT_INSERT_NOFOCUS_NONE)) {
 	    /*
@@ -3631,29 +3865,47 @@ TextBlinkProc(
 	     */
 
 	    textPtr->flags |= INSERT_ON;
-	    goto redrawInsert;
-	}
-	if ((textPtr->insertOffTime == 0) && !(textPtr->flags & INSERT_ON)) {
+	    TextRedrawInsert(textPtr);
+	} else if ((textPtr->insertOffTime == 0)
+		&& !(textPtr->flags & INSERT_ON)) {
 	    /*
 	     * The widget was configured to have zero offtime while the
 	     * insertion point was not displayed. We have to display it once.
 	     */
 
 	    textPtr->flags |= INSERT_ON;
-	    goto redrawInsert;
+	    TextRedrawInsert(textPtr);
 	}
 	return;
     }
-    if (textPtr->flags & INSERT_ON) {
-	textPtr->flags &= ~INSERT_ON;
-	textPtr->insertBlinkHandler = Tcl_CreateTimerHandler(
-		textPtr->insertOffTime, TextBlinkProc, textPtr);
-    } else {
-	textPtr->flags |= INSERT_ON;
-	textPtr->insertBlinkHandler = Tcl_CreateTimerHandler(
-		textPtr->insertOnTime, TextBlinkProc, textPtr);
-    }
-  redrawInsert:
+    TkBlinkAdd(TextBlinkProc, textPtr, textPtr->insertOnTime,
+	    textPtr->insertOffTime);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TextRedrawInsert --
+ *
+ *	Arranges for the area of the insertion cursor to be redisplayed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Redisplay gets invoked.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+TextRedrawInsert(
+    TkText *textPtr)		/* Text widget whose cursor area to
+				 * redraw. */
+{
+    TkTextIndex index;
+    int x, y, w, h, charWidth;
+
     TkTextMarkSegToIndex(textPtr, textPtr->insertMarkPtr, &index);
     if (TkTextIndexBbox(textPtr, &index, &x, &y, &w, &h, &charWidth) == 0) {
 	if (textPtr->insertCursorType) {
@@ -3782,12 +4034,14 @@ TextSearchCmd(
     static const char *const switchStrings[] = {
 	"-hidden",
 	"--", "-all", "-backwards", "-count", "-elide", "-exact", "-forwards",
-	"-nocase", "-nolinestop", "-overlap", "-regexp", "-strictlimits", NULL
+	"-indexed", "-nocase", "-nolinestop", "-overlap", "-regexp",
+	"-strictlimits", NULL
     };
     enum SearchSwitches {
 	TK_TEXT_SEARCH_HIDDEN,
 	TK_TEXT_SEARCH_END, TK_TEXT_SEARCH_ALL, TK_TEXT_SEARCH_BACK, TK_TEXT_SEARCH_COUNT, TK_TEXT_SEARCH_ELIDE,
-	TK_TEXT_SEARCH_EXACT, TK_TEXT_SEARCH_FWD, TK_TEXT_SEARCH_NOCASE,
+	TK_TEXT_SEARCH_EXACT, TK_TEXT_SEARCH_FWD, TK_TEXT_SEARCH_INDEXED,
+	TK_TEXT_SEARCH_NOCASE,
 	TK_TEXT_SEARCH_NOLINESTOP, TK_TEXT_SEARCH_OVERLAP, TK_TEXT_SEARCH_REGEXP, TK_TEXT_SEARCH_STRICTLIMITS
     };
 
@@ -3804,6 +4058,8 @@ TextSearchCmd(
     searchSpec.countPtr = NULL;
     searchSpec.resPtr = NULL;
     searchSpec.searchElide = 0;
+    searchSpec.indexed = 0;
+    searchSpec.indexOffset = 0;
     searchSpec.noLineStop = 0;
     searchSpec.overlap = 0;
     searchSpec.strictLimits = 0;
@@ -3873,6 +4129,9 @@ TextSearchCmd(
 	case TK_TEXT_SEARCH_FWD:
 	    searchSpec.backwards = 0;
 	    break;
+	case TK_TEXT_SEARCH_INDEXED:
+	    searchSpec.indexed = 1;
+	    break;
 	case TK_TEXT_SEARCH_NOCASE:
 	    searchSpec.noCase = 1;
 	    break;
@@ -3917,6 +4176,24 @@ TextSearchCmd(
 	return TCL_ERROR;
     }
 
+    /*
+     * The per-line content cache knows nothing about per-tag elision, so an
+     * indexed search silently falls back to the plain B-tree scan when
+     * hidden text would have to be skipped.
+     */
+
+    if (searchSpec.indexed) {
+	if (!searchSpec.searchElide
+		&& (textPtr->sharedTextPtr->numElideTags > 0)) {
+	    searchSpec.indexed = 0;
+	} else {
+	    TextSearchIndexUpdate(textPtr);
+	    if (textPtr->start != NULL) {
+		searchSpec.indexOffset = TkBTreeLinesTo(NULL, textPtr->start);
+	    }
+	}
+    }
+
     /*
      * Scan through all of the lines of the text circularly, starting at the
      * given index. 'objv[i]' is the pattern which may be an exact string or a
@@ -4092,6 +4369,89 @@ TextSearchIndexInLine(
     return index;
 }
 
+/*
+
+ *----------------------------------------------------------------------
+ *
+ * TextSearchIndexFree, TextSearchIndexUpdate --
+ *
+ *	Maintenance of the shared per-line content cache used by the widget's
+ *	"search -indexed" mode. TextSearchIndexUpdate makes sure the cache
+ *	exists and reflects the current contents of the B-tree: if it is
+ *	stale (any edit bumps the shared stateEpoch) it is discarded and
+ *	rebuilt in one linear pass over the tree, so repeated searches - the
+ *	find-as-you-type case - pay the collection cost once instead of once
+ *	per search per line.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory is allocated for the cache; a stale cache is freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+TextSearchIndexFree(
+    TkSharedText *sharedTextPtr)/* Shared section whose cache is freed. */
+{
+    TkTextSearchIndex *indexPtr = sharedTextPtr->searchIndexPtr;
+    Tcl_Size i;
+
+    if (indexPtr == NULL) {
+	return;
+    }
+    for (i = 0; i < indexPtr->numLines; i++) {
+	Tcl_DecrRefCount(indexPtr->lineObjs[i]);
+    }
+    ckfree(indexPtr->lineObjs);
+    ckfree(indexPtr->linePtrs);
+    ckfree(indexPtr);
+    sharedTextPtr->searchIndexPtr = NULL;
+}
+
+static void
+TextSearchIndexUpdate(
+    TkText *textPtr)		/* Information about text widget. */
+{
+    TkSharedText *sharedTextPtr = textPtr->sharedTextPtr;
+    TkTextSearchIndex *indexPtr = sharedTextPtr->searchIndexPtr;
+    TkTextLine *linePtr;
+    TkTextSegment *segPtr;
+    Tcl_Size i, numLines;
+
+    if ((indexPtr != NULL) && (indexPtr->epoch == sharedTextPtr->stateEpoch)) {
+	return;
+    }
+    TextSearchIndexFree(sharedTextPtr);
+
+    numLines = TkBTreeNumLines(sharedTextPtr->tree, NULL);
+    indexPtr = (TkTextSearchIndex *)ckalloc(sizeof(TkTextSearchIndex));
+    indexPtr->numLines = numLines;
+    indexPtr->epoch = sharedTextPtr->stateEpoch;
+    indexPtr->linePtrs = (TkTextLine **)
+	    ckalloc(numLines * sizeof(TkTextLine *));
+    indexPtr->lineObjs = (Tcl_Obj **)ckalloc(numLines * sizeof(Tcl_Obj *));
+
+    linePtr = TkBTreeFindLine(sharedTextPtr->tree, NULL, 0);
+    for (i = 0; i < numLines; i++) {
+	Tcl_Obj *objPtr = Tcl_NewObj();
+
+	for (segPtr = linePtr->segPtr; segPtr != NULL;
+		segPtr = segPtr->nextPtr) {
+	    if (segPtr->typePtr == &tkTextCharType) {
+		Tcl_AppendToObj(objPtr, segPtr->body.chars, segPtr->size);
+	    }
+	}
+	Tcl_IncrRefCount(objPtr);
+	indexPtr->linePtrs[i] = linePtr;
+	indexPtr->lineObjs[i] = objPtr;
+	linePtr = TkBTreeNextLine(NULL, linePtr);
+    }
+    sharedTextPtr->searchIndexPtr = indexPtr;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -4137,6 +4497,23 @@ TextSearchAddNextLine(
     TkText *textPtr = (TkText *)searchSpecPtr->clientData;
     int nothingYet = 1;
 
+    /*
+     * For indexed searches the content of every line has already been
+     * collected, so the B-tree lookup and segment walk below can be skipped
+     * entirely.
+     */
+
+    if (searchSpecPtr->indexed) {
+	TkTextSearchIndex *indexPtr = textPtr->sharedTextPtr->searchIndexPtr;
+	Tcl_Size sharedLine = lineNum + searchSpecPtr->indexOffset;
+
+	if ((indexPtr != NULL) && (sharedLine < indexPtr->numLines)) {
+	    Tcl_AppendObjToObj(theLine, indexPtr->lineObjs[sharedLine]);
+	    linePtr = indexPtr->linePtrs[sharedLine];
+	    goto lineComplete;
+	}
+    }
+
     /*
      * Extract the text from the line.
      */
@@ -4200,6 +4577,7 @@ TextSearchAddNextLine(
      * purpose.
      */
 
+  lineComplete:
     if (searchSpecPtr->exact && searchSpecPtr->noCase) {
 	Tcl_SetObjLength(theLine, Tcl_UtfToLower(Tcl_GetString(theLine)));
     }
@@ -5059,6 +5437,433 @@ DumpSegment(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * SerializeUint32 --
+ *
+ *	Append a 32-bit unsigned integer to a dynamic string in the fixed
+ *	little-endian layout used by the binary text serialization format.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Four bytes are appended to dsPtr.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+SerializeUint32(
+    Tcl_DString *dsPtr,		/* Buffer being assembled. */
+    unsigned int value)		/* Value to append. */
+{
+    char buf[4];
+
+    buf[0] = (char) (value & 0xff);
+    buf[1] = (char) ((value >> 8) & 0xff);
+    buf[2] = (char) ((value >> 16) & 0xff);
+    buf[3] = (char) ((value >> 24) & 0xff);
+    Tcl_DStringAppend(dsPtr, buf, 4);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DeserializeUint32 --
+ *
+ *	Read a 32-bit unsigned integer in the serialization format's
+ *	little-endian layout, advancing the cursor past it.
+ *
+ * Results:
+ *	Returns 1 and stores the value at valuePtr if four bytes were
+ *	available, 0 if the data is truncated.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+DeserializeUint32(
+    const unsigned char **pPtr,	/* Cursor into the serialized data;
+				 * advanced past the value read. */
+    const unsigned char *end,	/* First byte past the serialized data. */
+    unsigned int *valuePtr)	/* Where to store the value read. */
+{
+    const unsigned char *p = *pPtr;
+
+    if (end - p < 4) {
+	return 0;
+    }
+    *valuePtr = (unsigned int) p[0] | ((unsigned int) p[1] << 8)
+	    | ((unsigned int) p[2] << 16) | ((unsigned int) p[3] << 24);
+    *pPtr = p + 4;
+    return 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TextSerializeCmd --
+ *
+ *	Snapshot the entire content of a text widget - the characters, the
+ *	runs covered by each tag and the named marks - into a compact
+ *	binary string that TextDeserializeCmd can rebuild in bulk. Unlike
+ *	"dump", the snapshot is taken directly from the B-tree structures
+ *	(one pass over the segments, one tag search per tag), so
+ *	serializing a large tagged document costs I/O, not script time.
+ *
+ * Results:
+ *	A standard Tcl result; on success the interpreter result is a byte
+ *	array holding the snapshot.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+TextSerializeCmd(
+    TkText *textPtr,		/* Information about text widget. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    Tcl_Size objc,		/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    TkSharedText *sharedTextPtr = textPtr->sharedTextPtr;
+    TkTextBTree tree = sharedTextPtr->tree;
+    Tcl_DString ds, body;
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
+    TkTextLine *linePtr;
+    TkTextSegment *segPtr;
+    int numLines, lineNo;
+    unsigned int count;
+
+    if (objc != 2) {
+	Tcl_WrongNumArgs(interp, 2, objv, NULL);
+	return TCL_ERROR;
+    }
+
+    Tcl_DStringInit(&ds);
+    Tcl_DStringAppend(&ds, "TkTx", 4);
+    SerializeUint32(&ds, 1);
+
+    /*
+     * Content: every line of the underlying B-tree in order, minus the
+     * automatic final newline, so that inserting the content into an empty
+     * widget rebuilds the identical line structure. Embedded windows and
+     * images are not serialized; each is written as a single space so that
+     * the byte offsets of the tag runs and marks that follow stay valid.
+     */
+
+    numLines = TkBTreeNumLines(tree, NULL);
+    Tcl_DStringInit(&body);
+    for (lineNo = 0; lineNo < numLines; lineNo++) {
+	linePtr = TkBTreeFindLine(tree, NULL, lineNo);
+	for (segPtr = linePtr->segPtr; segPtr != NULL;
+		segPtr = segPtr->nextPtr) {
+	    if (segPtr->typePtr == &tkTextCharType) {
+		Tcl_DStringAppend(&body, segPtr->body.chars, segPtr->size);
+	    } else {
+		Tcl_Size i;
+
+		for (i = 0; i < segPtr->size; i++) {
+		    Tcl_DStringAppend(&body, " ", 1);
+		}
+	    }
+	}
+    }
+    SerializeUint32(&ds, (unsigned int) (Tcl_DStringLength(&body) - 1));
+    Tcl_DStringAppend(&ds, Tcl_DStringValue(&body),
+	    Tcl_DStringLength(&body) - 1);
+    Tcl_DStringFree(&body);
+
+    /*
+     * Tag runs: for each tag in the shared table (the per-widget "sel" tags
+     * are deliberately absent from it), the transition indices found by one
+     * tag search over the whole document, as (line, byte) pairs. Tags with
+     * no ranges are omitted.
+     */
+
+    count = 0;
+    Tcl_DStringInit(&body);
+    for (hPtr = Tcl_FirstHashEntry(&sharedTextPtr->tagTable, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	TkTextTag *tagPtr = (TkTextTag *) Tcl_GetHashValue(hPtr);
+	TkTextIndex first, last;
+	TkTextSearch tSearch;
+	Tcl_DString runs;
+	unsigned int numIndices = 0;
+
+	TkTextMakeByteIndex(tree, NULL, 0, 0, &first);
+	TkTextMakeByteIndex(tree, NULL, numLines, 0, &last);
+	TkBTreeStartSearch(&first, &last, tagPtr, &tSearch);
+	Tcl_DStringInit(&runs);
+	if (TkBTreeCharTagged(&first, tagPtr)) {
+	    SerializeUint32(&runs, 0);
+	    SerializeUint32(&runs, 0);
+	    numIndices++;
+	}
+	while (TkBTreeNextTag(&tSearch)) {
+	    SerializeUint32(&runs, (unsigned int) TkBTreeLinesTo(NULL,
+		    tSearch.curIndex.linePtr));
+	    SerializeUint32(&runs, (unsigned int) tSearch.curIndex.byteIndex);
+	    numIndices++;
+	}
+	if (numIndices & 1) {
+	    /*
+	     * A range left open by the search ends at the end of the text.
+	     */
+
+	    SerializeUint32(&runs, (unsigned int) numLines);
+	    SerializeUint32(&runs, 0);
+	    numIndices++;
+	}
+	if (numIndices > 0) {
+	    SerializeUint32(&body, (unsigned int) strlen(tagPtr->name));
+	    Tcl_DStringAppend(&body, tagPtr->name, TCL_INDEX_NONE);
+	    SerializeUint32(&body, numIndices);
+	    Tcl_DStringAppend(&body, Tcl_DStringValue(&runs),
+		    Tcl_DStringLength(&runs));
+	    count++;
+	}
+	Tcl_DStringFree(&runs);
+    }
+    SerializeUint32(&ds, count);
+    Tcl_DStringAppend(&ds, Tcl_DStringValue(&body), Tcl_DStringLength(&body));
+    Tcl_DStringFree(&body);
+
+    /*
+     * Named marks. The per-widget "insert" and "current" marks are not part
+     * of the document and are not serialized.
+     */
+
+    count = 0;
+    Tcl_DStringInit(&body);
+    for (hPtr = Tcl_FirstHashEntry(&sharedTextPtr->markTable, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	TkTextSegment *markPtr = (TkTextSegment *) Tcl_GetHashValue(hPtr);
+	const char *name = (const char *)
+		Tcl_GetHashKey(&sharedTextPtr->markTable, hPtr);
+	char gravity = (markPtr->typePtr == &tkTextLeftMarkType);
+	TkTextIndex index;
+
+	TkTextMarkSegToIndex(textPtr, markPtr, &index);
+	SerializeUint32(&body, (unsigned int) strlen(name));
+	Tcl_DStringAppend(&body, name, TCL_INDEX_NONE);
+	Tcl_DStringAppend(&body, &gravity, 1);
+	SerializeUint32(&body, (unsigned int) TkBTreeLinesTo(NULL,
+		index.linePtr));
+	SerializeUint32(&body, (unsigned int) index.byteIndex);
+	count++;
+    }
+    SerializeUint32(&ds, count);
+    Tcl_DStringAppend(&ds, Tcl_DStringValue(&body), Tcl_DStringLength(&body));
+    Tcl_DStringFree(&body);
+
+    Tcl_SetObjResult(interp, Tcl_NewByteArrayObj(
+	    (unsigned char *) Tcl_DStringValue(&ds), Tcl_DStringLength(&ds)));
+    Tcl_DStringFree(&ds);
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TextDeserializeCmd --
+ *
+ *	Rebuild the content of an empty text widget from a snapshot made by
+ *	TextSerializeCmd: the text is inserted with a single bulk B-tree
+ *	insertion, each tag's runs with one TkBTreeTag call per run, and
+ *	the marks are then set back. Undo recording is suppressed for the
+ *	whole restore.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	The widget acquires the serialized content, tag ranges and marks.
+ *	Tags named in the snapshot are created if they do not exist yet.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+TextDeserializeCmd(
+    TkText *textPtr,		/* Information about text widget. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    Tcl_Size objc,		/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    TkSharedText *sharedTextPtr = textPtr->sharedTextPtr;
+    TkTextBTree tree = sharedTextPtr->tree;
+    const unsigned char *data, *p, *end;
+    Tcl_Size length, byteCount;
+    unsigned int version, contentLen, numTags, numMarks, i;
+    int savedUndo;
+    TkTextLine *linePtr;
+    TkTextSegment *segPtr;
+    TkTextIndex index;
+    Tcl_DString nameBuf;
+
+    if (objc != 3) {
+	Tcl_WrongNumArgs(interp, 2, objv, "data");
+	return TCL_ERROR;
+    }
+    data = Tcl_GetByteArrayFromObj(objv[2], &length);
+    p = data;
+    end = data + length;
+
+    /*
+     * The widget must be empty: the restore rebuilds the document from
+     * line 0 and cannot merge with existing content.
+     */
+
+    byteCount = 0;
+    linePtr = TkBTreeFindLine(tree, NULL, 0);
+    for (segPtr = linePtr->segPtr; segPtr != NULL; segPtr = segPtr->nextPtr) {
+	byteCount += segPtr->size;
+    }
+    if (TkBTreeNumLines(tree, NULL) != 1 || byteCount != 1) {
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		"text widget is not empty", TCL_INDEX_NONE));
+	Tcl_SetErrorCode(interp, "TK", "TEXT", "DESERIALIZE", (char *)NULL);
+	return TCL_ERROR;
+    }
+
+    if (length < 12 || memcmp(data, "TkTx", 4) != 0) {
+	goto corrupt;
+    }
+    p += 4;
+    if (!DeserializeUint32(&p, end, &version) || version != 1) {
+	goto corrupt;
+    }
+    if (!DeserializeUint32(&p, end, &contentLen)
+	    || (Tcl_Size) contentLen > end - p) {
+	goto corrupt;
+    }
+    if (textPtr->state == TK_TEXT_STATE_DISABLED) {
+	return TCL_OK;
+    }
+
+    savedUndo = sharedTextPtr->undo;
+    sharedTextPtr->undo = 0;
+    Tcl_DStringInit(&nameBuf);
+
+    if (contentLen > 0) {
+	Tcl_Obj *contentObj = Tcl_NewStringObj((const char *) p,
+		(Tcl_Size) contentLen);
+
+	Tcl_IncrRefCount(contentObj);
+	TkTextMakeByteIndex(tree, textPtr, 0, 0, &index);
+	InsertChars(sharedTextPtr, textPtr, &index, contentObj, 1);
+	Tcl_DecrRefCount(contentObj);
+    }
+    p += contentLen;
+
+    /*
+     * Tag runs. Positions beyond the restored content are clamped by
+     * TkTextMakeByteIndex, so a damaged index cannot corrupt the B-tree;
+     * structurally truncated data aborts the restore.
+     */
+
+    if (!DeserializeUint32(&p, end, &numTags)) {
+	goto corruptCleanup;
+    }
+    for (i = 0; i < numTags; i++) {
+	unsigned int nameLen, numIndices, j;
+	TkTextTag *tagPtr;
+	TkTextIndex index2;
+
+	if (!DeserializeUint32(&p, end, &nameLen)
+		|| (Tcl_Size) nameLen > end - p) {
+	    goto corruptCleanup;
+	}
+	Tcl_DStringSetLength(&nameBuf, 0);
+	Tcl_DStringAppend(&nameBuf, (const char *) p, (Tcl_Size) nameLen);
+	p += nameLen;
+	tagPtr = TkTextCreateTag(textPtr, Tcl_DStringValue(&nameBuf), NULL);
+	if (tagPtr->elide > 0) {
+	    sharedTextPtr->stateEpoch++;
+	}
+	if (!DeserializeUint32(&p, end, &numIndices) || (numIndices & 1)) {
+	    goto corruptCleanup;
+	}
+	for (j = 0; j + 1 < numIndices; j += 2) {
+	    unsigned int line1, byte1, line2, byte2;
+
+	    if (!DeserializeUint32(&p, end, &line1)
+		    || !DeserializeUint32(&p, end, &byte1)
+		    || !DeserializeUint32(&p, end, &line2)
+		    || !DeserializeUint32(&p, end, &byte2)) {
+		goto corruptCleanup;
+	    }
+	    TkTextMakeByteIndex(tree, NULL, (int) line1, (Tcl_Size) byte1,
+		    &index);
+	    TkTextMakeByteIndex(tree, NULL, (int) line2, (Tcl_Size) byte2,
+		    &index2);
+	    if (TkTextIndexCmp(&index, &index2) < 0) {
+		TkBTreeTag(&index, &index2, tagPtr, 1);
+	    }
+	}
+    }
+
+    /*
+     * Marks.
+     */
+
+    if (!DeserializeUint32(&p, end, &numMarks)) {
+	goto corruptCleanup;
+    }
+    for (i = 0; i < numMarks; i++) {
+	unsigned int nameLen, line, byte;
+	int leftGravity;
+	TkTextSegment *markPtr;
+
+	if (!DeserializeUint32(&p, end, &nameLen)
+		|| (Tcl_Size) nameLen + 1 > end - p) {
+	    goto corruptCleanup;
+	}
+	Tcl_DStringSetLength(&nameBuf, 0);
+	Tcl_DStringAppend(&nameBuf, (const char *) p, (Tcl_Size) nameLen);
+	p += nameLen;
+	leftGravity = (*p++ != 0);
+	if (!DeserializeUint32(&p, end, &line)
+		|| !DeserializeUint32(&p, end, &byte)) {
+	    goto corruptCleanup;
+	}
+	TkTextMakeByteIndex(tree, NULL, (int) line, (Tcl_Size) byte, &index);
+	markPtr = TkTextSetMark(textPtr, Tcl_DStringValue(&nameBuf), &index);
+	if (markPtr != NULL && leftGravity
+		&& markPtr->typePtr == &tkTextRightMarkType) {
+	    TkTextMarkSegToIndex(textPtr, markPtr, &index);
+	    TkTextMarkIndexRemove(sharedTextPtr, markPtr);
+	    TkBTreeUnlinkSegment(markPtr, markPtr->body.mark.linePtr);
+	    markPtr->typePtr = &tkTextLeftMarkType;
+	    TkBTreeLinkSegment(markPtr, &index);
+	    TkTextMarkIndexAdd(sharedTextPtr, markPtr);
+	}
+    }
+
+    sharedTextPtr->undo = savedUndo;
+    Tcl_DStringFree(&nameBuf);
+    TkTextEventuallyRepick(textPtr);
+    return TCL_OK;
+
+  corruptCleanup:
+    sharedTextPtr->undo = savedUndo;
+    Tcl_DStringFree(&nameBuf);
+  corrupt:
+    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+	    "serialized text data is corrupt or truncated", TCL_INDEX_NONE));
+    Tcl_SetErrorCode(interp, "TK", "TEXT", "DESERIALIZE", (char *)NULL);
+    return TCL_ERROR;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -95,6 +95,15 @@ typedef struct TkTextEmbWindowClient {
 				 * window. */
     int displayed;		/* Non-zero means that the window has been
 				 * displayed on the screen recently. */
+    int winX, winY;		/* Position actually given to the window the
+				 * last time it was placed, so redundant
+				 * geometry requests can be skipped on
+				 * subsequent display passes. */
+    int winWidth, winHeight;	/* Size actually given to the window the last
+				 * time it was placed. winWidth is -1 while no
+				 * placement is in effect (the window has
+				 * never been placed, or has been unmapped
+				 * since). */
     struct TkTextSegment *parent;
     struct TkTextEmbWindowClient *next;
 } TkTextEmbWindowClient;
@@ -147,7 +156,19 @@ typedef struct TkTextEmbImage {
 				 * "image names" to identify this instance of
 				 * the image. */
     Tk_Image image;		/* Image for this segment. NULL means that the
-				 * image hasn't been created yet. */
+				 * image hasn't been created yet. Segments
+				 * embedding the same image share one
+				 * instance; see sharedImagePtr. */
+    struct TkTextSharedImage *sharedImagePtr;
+				/* Record through which the image instance is
+				 * shared with the other segments embedding
+				 * the same image, or NULL. Owned by
+				 * tkTextImage.c. */
+    struct TkTextSegment *nextUsePtr, *prevUsePtr;
+				/* Links in the shared image's list of
+				 * embedding segments, so image-change
+				 * notifications can find every occurrence
+				 * from the single shared instance. */
     TkAlignMode align;		/* How to align image in vertical space. See
 				 * definitions in tkTextImage.c. */
     int padX, padY;		/* Padding to leave around each side of image,
@@ -329,6 +350,12 @@ typedef struct TkTextTag {
 				 * or more children of the node do contain
 				 * information about the tag. */
     Tcl_Size toggleCount;	/* Total number of tag toggles. */
+    Tcl_Size scanIndex;		/* Slot assigned to this tag by the current
+				 * tag-gathering scan; only meaningful while
+				 * scanEpoch matches the shared widget's
+				 * tagScanEpoch. */
+    unsigned long scanEpoch;	/* Identifies the scan during which scanIndex
+				 * was assigned. */
 
     /*
      * Information for displaying text with this tag. The information belows
@@ -590,15 +617,49 @@ typedef struct TkSharedText {
     Tcl_Size numTags;		/* Number of tags currently defined for
 				 * widget; needed to keep track of
 				 * priorities. */
+    Tcl_Size numElideTags;	/* Number of tags with -elide configured.
+				 * Lets elide queries short-circuit when no
+				 * tag can elide anything. */
+    unsigned long tagScanEpoch;	/* Bumped at the start of each tag-gathering
+				 * scan, so tags can memoize their slot in
+				 * the scan's arrays (see IncCount). */
+    struct TkTextSearchIndex *searchIndexPtr;
+				/* Lazily built cache of the character content
+				 * of every logical line, used by the widget's
+				 * "search -indexed" mode, or NULL. Stamped
+				 * with stateEpoch so it is rebuilt after any
+				 * modification. Owned by tkText.c. */
+    struct TkTextElideTable *elideTablePtr;
+				/* Lazily built, sorted table of the elided
+				 * ranges in the widget, so elide queries can
+				 * binary search instead of scanning toggle
+				 * segments, or NULL. Stamped with both the
+				 * B-tree epoch and stateEpoch. Owned by
+				 * tkTextBTree.c. */
     Tcl_HashTable markTable;	/* Hash table that maps from mark names to
 				 * pointers to mark segments. The special
 				 * "insert" and "current" marks are not stored
 				 * in this table, but directly accessed as
 				 * fields of textPtr. */
+    struct TkTextMarkIndex *markIndexPtr;
+				/* Skip list of all mark segments in the
+				 * B-tree, ordered by document position, so
+				 * "mark next" and "mark previous" need not
+				 * scan every line between the starting index
+				 * and the nearest mark. Created when the
+				 * first mark is indexed, or NULL. Owned by
+				 * tkTextMark.c. */
     Tcl_HashTable windowTable;	/* Hash table that maps from window names to
 				 * pointers to window segments. If a window
 				 * segment doesn't yet have an associated
 				 * window, there is no entry for it here. */
+    Tcl_HashTable imageInstanceTable;
+				/* Hash table that maps from image names (as
+				 * given to -image) to TkTextSharedImage
+				 * records, so all segments embedding the
+				 * same image share one image instance
+				 * instead of creating one per occurrence.
+				 * Owned by tkTextImage.c. */
     Tcl_HashTable imageTable;	/* Hash table that maps from image names to
 				 * pointers to image segments. If an image
 				 * segment doesn't yet have an associated
@@ -626,6 +687,9 @@ typedef struct TkSharedText {
     int maxUndo;		/* The maximum depth of the undo stack
 				 * expressed as the maximum number of compound
 				 * statements. */
+    int maxUndoSize;		/* The approximate maximum amount of memory
+				 * the undo stack may retain, in bytes. Zero
+				 * or negative means no limit. */
     int autoSeparators;		/* Non-zero means the separators will be
 				 * inserted automatically. */
     int isDirty;		/* Flag indicating the 'dirtyness' of the
@@ -799,7 +863,6 @@ typedef struct TkText {
 				 * in "on" state for each blink. */
     int insertOffTime;		/* Number of milliseconds cursor should spend
 				 * in "off" state for each blink. */
-    Tcl_TimerToken insertBlinkHandler;
 				/* Timer handler used to blink cursor on and
 				 * off. */
 
@@ -854,6 +917,9 @@ typedef struct TkText {
     int maxUndo;		/* The maximum depth of the undo stack
 				 * expressed as the maximum number of compound
 				 * statements. */
+    int maxUndoSize;		/* The approximate maximum amount of memory
+				 * the undo stack may retain, in bytes. Zero
+				 * or negative means no limit. */
     int autoSeparators;		/* Non-zero means the separators will be
 				 * inserted automatically. */
     Tcl_Obj *afterSyncCmd;	/* Command to be executed when lines are up to
@@ -1077,6 +1143,7 @@ MODULE_SCOPE TkTextTag **TkBTreeGetTags(const TkTextIndex *indexPtr,
 			    const TkText *textPtr, Tcl_Size *numTagsPtr);
 MODULE_SCOPE void	TkBTreeInsertChars(TkTextBTree tree,
 			    TkTextIndex *indexPtr, const char *string);
+MODULE_SCOPE void	TkTextIndexCacheClear(TkTextBTree tree);
 MODULE_SCOPE int	TkBTreeLinesTo(const TkText *textPtr,
 			    TkTextLine *linePtr);
 MODULE_SCOPE int	TkBTreePixelsTo(const TkText *textPtr,
@@ -1163,7 +1230,12 @@ MODULE_SCOPE TkTextIndex *TkTextMakeCharIndex(TkTextBTree tree, TkText *textPtr,
 			    TkTextIndex *indexPtr);
 MODULE_SCOPE int	TkTextMeasureDown(TkText *textPtr,
 			    TkTextIndex *srcPtr, int distance);
+MODULE_SCOPE Tcl_Obj *	TkTextStatsObj(TkText *textPtr);
+MODULE_SCOPE void	TkTextStatsReset(TkText *textPtr);
+MODULE_SCOPE int	TkTextElidedLineSpan(const TkText *textPtr,
+			    TkTextLine *linePtr, int *byteCountPtr);
 MODULE_SCOPE void	TkTextFreeElideInfo(TkTextElideInfo *infoPtr);
+MODULE_SCOPE void	TkTextFreeElideTable(TkSharedText *sharedTextPtr);
 MODULE_SCOPE int	TkTextIsElided(const TkText *textPtr,
 			    const TkTextIndex *indexPtr,
 			    TkTextElideInfo *infoPtr);
@@ -1183,6 +1255,11 @@ MODULE_SCOPE int	TkTextMarkNameToIndex(TkText *textPtr,
 			    const char *name, TkTextIndex *indexPtr);
 MODULE_SCOPE void	TkTextMarkSegToIndex(TkText *textPtr,
 			    TkTextSegment *markPtr, TkTextIndex *indexPtr);
+MODULE_SCOPE void	TkTextMarkIndexAdd(TkSharedText *sharedTextPtr,
+			    TkTextSegment *markPtr);
+MODULE_SCOPE void	TkTextMarkIndexRemove(TkSharedText *sharedTextPtr,
+			    TkTextSegment *markPtr);
+MODULE_SCOPE void	TkTextFreeMarkIndex(TkSharedText *sharedTextPtr);
 MODULE_SCOPE void	TkTextEventuallyRepick(TkText *textPtr);
 MODULE_SCOPE Bool	TkTextPendingsync(TkText *textPtr);
 MODULE_SCOPE void	TkTextPickCurrent(TkText *textPtr, XEvent *eventPtr);
@@ -56,6 +56,10 @@ typedef struct Summary {
  */
 
 typedef struct Node {
+    struct BTree *treePtr;	/* B-tree containing this node. Lets code
+				 * that only has a node in hand (e.g. segment
+				 * delete procs adjusting toggle counts)
+				 * reach the tree's structure pools. */
     struct Node *parentPtr;	/* Pointer to parent node, or NULL if this is
 				 * the root. */
     struct Node *nextPtr;	/* Next in list of siblings with the same
@@ -102,6 +106,14 @@ typedef struct Node {
 
 typedef struct BTree {
     Node *rootPtr;		/* Pointer to root of B-tree. */
+    Summary *summaryPoolPtr;	/* Free list of recycled tag Summary records,
+				 * chained through their nextPtr fields. The
+				 * pools below avoid a heap round trip for
+				 * the fixed-size structures that editing
+				 * churns constantly; everything left in them
+				 * is released when the tree is destroyed. */
+    Node *nodePoolPtr;		/* Free list of recycled Nodes. */
+    TkTextLine *linePoolPtr;	/* Free list of recycled lines. */
     int clients;		/* Number of clients of this B-tree. */
     int pixelReferences;	/* Number of clients of this B-tree which care
 				 * about pixel heights. */
@@ -128,6 +140,9 @@ typedef struct TagInfo {
     TkTextTag **tagPtrs;	/* Array of tags seen so far. Malloc-ed. */
     int *counts;		/* Toggle count (so far) for each entry in
 				 * tags. Malloc-ed. */
+    unsigned long epoch;	/* Scan identifier; tags stamped with this
+				 * epoch have their entry index memoized in
+				 * their scanIndex field. */
 } TagInfo;
 
 /*
@@ -166,6 +181,14 @@ static void		CheckNodeConsistency(Node *nodePtr, int references);
 static void		CleanupLine(TkTextLine *linePtr);
 static void		DeleteSummaries(Summary *tagPtr);
 static void		DestroyNode(Node *nodePtr);
+static Summary *	AllocSummary(BTree *treePtr);
+static void		FreeSummary(BTree *treePtr, Summary *summaryPtr);
+static void		FreeSummaryList(BTree *treePtr, Summary *summaryPtr);
+static Node *		AllocNode(BTree *treePtr);
+static void		FreeNode(BTree *treePtr, Node *nodePtr);
+static TkTextLine *	AllocLine(BTree *treePtr);
+static void		FreeLine(BTree *treePtr, TkTextLine *linePtr);
+static void		DrainStructPools(BTree *treePtr);
 static TkTextSegment *	FindTagEnd(TkTextBTree tree, TkTextTag *tagPtr,
 			    TkTextIndex *indexPtr);
 static void		IncCount(TkTextTag *tagPtr, int inc,
@@ -273,9 +296,13 @@ TkBTreeCreate(
      * of the tree.
      */
 
-    rootPtr = (Node *)ckalloc(sizeof(Node));
-    linePtr = (TkTextLine *)ckalloc(sizeof(TkTextLine));
-    linePtr2 = (TkTextLine *)ckalloc(sizeof(TkTextLine));
+    treePtr = (BTree *)ckalloc(sizeof(BTree));
+    treePtr->summaryPoolPtr = NULL;
+    treePtr->nodePoolPtr = NULL;
+    treePtr->linePoolPtr = NULL;
+    rootPtr = AllocNode(treePtr);
+    linePtr = AllocLine(treePtr);
+    linePtr2 = AllocLine(treePtr);
 
     rootPtr->parentPtr = NULL;
     rootPtr->nextPtr = NULL;
@@ -314,7 +341,6 @@ TkBTreeCreate(
     segPtr->body.chars[0] = '\n';
     segPtr->body.chars[1] = 0;
 
-    treePtr = (BTree *)ckalloc(sizeof(BTree));
     treePtr->sharedTextPtr = sharedTextPtr;
     treePtr->rootPtr = rootPtr;
     treePtr->clients = 0;
@@ -476,7 +502,9 @@ TkBTreeDestroy(
      * itself.
      */
 
+    TkTextIndexCacheClear(tree);
     DestroyNode(treePtr->rootPtr);
+    DrainStructPools(treePtr);
     if (treePtr->startEnd != NULL) {
 	ckfree(treePtr->startEnd);
 	ckfree(treePtr->startEndRef);
@@ -542,7 +570,9 @@ TkBTreeRemoveClient(
 	 * The last reference to the tree.
 	 */
 
+	TkTextIndexCacheClear(tree);
 	DestroyNode(treePtr->rootPtr);
+	DrainStructPools(treePtr);
 	ckfree(treePtr);
 	return;
     } else if (pixelReference == -1) {
@@ -920,6 +950,135 @@ DeleteSummaries(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * AllocSummary, FreeSummary, AllocNode, etc. --
+ *
+ *	Structure pools for the fixed-size records that editing churns
+ *	constantly: tag summaries, tree nodes and lines. Freed records are
+ *	pushed onto per-tree free lists (chained through their nextPtr
+ *	fields) and handed back by the next allocation, so steady-state
+ *	editing of a large document stops hammering the heap allocator and
+ *	fragmenting it with millions of small blocks. DrainStructPools
+ *	returns everything to the heap when the tree is destroyed.
+ *
+ * Results:
+ *	The Alloc functions return an uninitialized record (except that
+ *	AllocNode fills in the node's treePtr back-pointer).
+ *
+ * Side effects:
+ *	Memory may be allocated or recycled.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static Summary *
+AllocSummary(
+    BTree *treePtr)		/* Tree whose pool should be used. */
+{
+    Summary *summaryPtr = treePtr->summaryPoolPtr;
+
+    if (summaryPtr != NULL) {
+	treePtr->summaryPoolPtr = summaryPtr->nextPtr;
+	return summaryPtr;
+    }
+    return (Summary *)ckalloc(sizeof(Summary));
+}
+
+static void
+FreeSummary(
+    BTree *treePtr,		/* Tree whose pool should be used. */
+    Summary *summaryPtr)	/* Record to recycle. */
+{
+    summaryPtr->nextPtr = treePtr->summaryPoolPtr;
+    treePtr->summaryPoolPtr = summaryPtr;
+}
+
+static void
+FreeSummaryList(
+    BTree *treePtr,		/* Tree whose pool should be used. */
+    Summary *summaryPtr)	/* First in list of records to recycle. */
+{
+    Summary *nextPtr;
+
+    while (summaryPtr != NULL) {
+	nextPtr = summaryPtr->nextPtr;
+	FreeSummary(treePtr, summaryPtr);
+	summaryPtr = nextPtr;
+    }
+}
+
+static Node *
+AllocNode(
+    BTree *treePtr)		/* Tree whose pool should be used. */
+{
+    Node *nodePtr = treePtr->nodePoolPtr;
+
+    if (nodePtr != NULL) {
+	treePtr->nodePoolPtr = nodePtr->nextPtr;
+    } else {
+	nodePtr = (Node *)ckalloc(sizeof(Node));
+    }
+    nodePtr->treePtr = treePtr;
+    return nodePtr;
+}
+
+static void
+FreeNode(
+    BTree *treePtr,		/* Tree whose pool should be used. */
+    Node *nodePtr)		/* Node to recycle; its numPixels array and
+				 * summaries must already be released. */
+{
+    nodePtr->nextPtr = treePtr->nodePoolPtr;
+    treePtr->nodePoolPtr = nodePtr;
+}
+
+static TkTextLine *
+AllocLine(
+    BTree *treePtr)		/* Tree whose pool should be used. */
+{
+    TkTextLine *linePtr = treePtr->linePoolPtr;
+
+    if (linePtr != NULL) {
+	treePtr->linePoolPtr = linePtr->nextPtr;
+	return linePtr;
+    }
+    return (TkTextLine *)ckalloc(sizeof(TkTextLine));
+}
+
+static void
+FreeLine(
+    BTree *treePtr,		/* Tree whose pool should be used. */
+    TkTextLine *linePtr)	/* Line to recycle; its pixels array and
+				 * segments must already be released. */
+{
+    linePtr->nextPtr = treePtr->linePoolPtr;
+    treePtr->linePoolPtr = linePtr;
+}
+
+static void
+DrainStructPools(
+    BTree *treePtr)		/* Tree being destroyed. */
+{
+    Summary *summaryPtr;
+    Node *nodePtr;
+    TkTextLine *linePtr;
+
+    while ((summaryPtr = treePtr->summaryPoolPtr) != NULL) {
+	treePtr->summaryPoolPtr = summaryPtr->nextPtr;
+	ckfree(summaryPtr);
+    }
+    while ((nodePtr = treePtr->nodePoolPtr) != NULL) {
+	treePtr->nodePoolPtr = nodePtr->nextPtr;
+	ckfree(nodePtr);
+    }
+    while ((linePtr = treePtr->linePoolPtr) != NULL) {
+	treePtr->linePoolPtr = linePtr->nextPtr;
+	ckfree(linePtr);
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -1090,7 +1249,7 @@ TkBTreeInsertChars(
 	 * the remainder of the old line to it.
 	 */
 
-	newLinePtr = (TkTextLine *)ckalloc(sizeof(TkTextLine));
+	newLinePtr = AllocLine(treePtr);
 	newLinePtr->pixels = (int *)
 		ckalloc(sizeof(int) * 2 * treePtr->pixelReferences);
 
@@ -1424,7 +1583,7 @@ TkBTreeDeleteIndexRange(
 		    }
 		}
 		ckfree(curLinePtr->pixels);
-		ckfree(curLinePtr);
+		FreeLine(treePtr, curLinePtr);
 	    }
 	    curLinePtr = nextLinePtr;
 	    segPtr = curLinePtr->segPtr;
@@ -1448,9 +1607,9 @@ TkBTreeDeleteIndexRange(
 		    prevNodePtr->nextPtr = curNodePtr->nextPtr;
 		}
 		parentPtr->numChildren--;
-		DeleteSummaries(curNodePtr->summaryPtr);
+		FreeSummaryList(treePtr, curNodePtr->summaryPtr);
 		ckfree(curNodePtr->numPixels);
-		ckfree(curNodePtr);
+		FreeNode(treePtr, curNodePtr);
 		curNodePtr = parentPtr;
 	    }
 	    curNodePtr = curLinePtr->parentPtr;
@@ -1546,7 +1705,7 @@ TkBTreeDeleteIndexRange(
 	    }
 	}
 	ckfree(index2Ptr->linePtr->pixels);
-	ckfree(index2Ptr->linePtr);
+	FreeLine(treePtr, index2Ptr->linePtr);
 
 	Rebalance((BTree *) index2Ptr->tree, curNodePtr);
     }
@@ -2134,8 +2293,34 @@ TkBTreeUnlinkSegment(
 	prevPtr->nextPtr = segPtr->nextPtr;
     }
     CleanupLine(linePtr);
+
+    /*
+     * Unlinking (and the segment merging CleanupLine may do) changes the
+     * line's segment chain, so cached segment positions must be dropped.
+     */
+
+    linePtr->parentPtr->treePtr->stateEpoch++;
 }
 
+/*
+ * When TkBTreeTag sweeps the internal toggles out of a range it batches
+ * the node toggle-count updates instead of applying them one toggle at a
+ * time: ChangeNodeToggleCount can move the tag's root node, which
+ * invalidates the search in progress and used to force a restart from
+ * the beginning of the range for every counted toggle -- quadratic in
+ * the number of toggles removed, which is what made whole-buffer retags
+ * of heavily tagged documents crawl. Consecutive toggles usually live in
+ * the same level-0 node, so the deferred updates compress into runs of
+ * one record per node.
+ */
+
+typedef struct ToggleRun {
+    Node *nodePtr;		/* Level-0 node the toggles were in. */
+    Tcl_Size count;		/* Number of counted toggles removed. */
+} ToggleRun;
+
+#define TOGGLE_RUN_PREALLOC 32
+
 /*
  *----------------------------------------------------------------------
  *
@@ -2174,7 +2359,14 @@ TkBTreeTag(
     TkTextSegment *segPtr, *prevPtr;
     TkTextSearch search;
     TkTextLine *cleanupLinePtr;
-    int oldState, changed, anyChanges = 0;
+    int oldState, anyChanges = 0;
+    ToggleRun runPre[TOGGLE_RUN_PREALLOC];
+				/* Pre-allocated space for toggle runs. */
+    ToggleRun *runPtr = runPre;	/* Deferred toggle-count updates. */
+    int numRuns = 0;		/* Number of runs currently used. */
+    int runsAlloced = TOGGLE_RUN_PREALLOC;
+				/* Size of allocated space for runs. */
+    int i;
 
     /*
      * See whether the tag is present at the start of the range. If the state
@@ -2221,12 +2413,34 @@ TkBTreeTag(
 	    prevPtr->nextPtr = segPtr->nextPtr;
 	}
 	if (segPtr->body.toggle.inNodeCounts) {
-	    ChangeNodeToggleCount(search.curIndex.linePtr->parentPtr,
-		    segPtr->body.toggle.tagPtr, -1);
+	    /*
+	     * Don't update the node toggle counts yet (see ToggleRun
+	     * above); just remember how many counted toggles were removed
+	     * from which node.
+	     */
+
+	    Node *nodePtr = search.curIndex.linePtr->parentPtr;
+
+	    if ((numRuns > 0) && (runPtr[numRuns-1].nodePtr == nodePtr)) {
+		runPtr[numRuns-1].count++;
+	    } else {
+		if (numRuns >= runsAlloced) {
+		    size_t oldSize = runsAlloced * sizeof(ToggleRun);
+		    ToggleRun *newRuns = (ToggleRun *)
+			    ckalloc(2 * oldSize);
+
+		    memcpy(newRuns, runPtr, oldSize);
+		    if (runPtr != runPre) {
+			ckfree(runPtr);
+		    }
+		    runPtr = newRuns;
+		    runsAlloced *= 2;
+		}
+		runPtr[numRuns].nodePtr = nodePtr;
+		runPtr[numRuns].count = 1;
+		numRuns++;
+	    }
 	    segPtr->body.toggle.inNodeCounts = 0;
-	    changed = 1;
-	} else {
-	    changed = 0;
 	}
 	ckfree(segPtr);
 
@@ -2243,16 +2457,20 @@ TkBTreeTag(
 	    CleanupLine(cleanupLinePtr);
 	    cleanupLinePtr = search.curIndex.linePtr;
 	}
+    }
 
-	/*
-	 * Quick hack. ChangeNodeToggleCount may move the tag's root location
-	 * around and leave the search in the void. This resets the search.
-	 */
+    /*
+     * The sweep is over; now apply the deferred toggle-count updates, one
+     * ChangeNodeToggleCount call per node run.
+     */
 
-	if (changed) {
-	    TkBTreeStartSearch(index1Ptr, index2Ptr, tagPtr, &search);
-	}
+    for (i = 0; i < numRuns; i++) {
+	ChangeNodeToggleCount(runPtr[i].nodePtr, tagPtr, -runPtr[i].count);
     }
+    if (runPtr != runPre) {
+	ckfree(runPtr);
+    }
+
     if ((add != 0) ^ oldState) {
 	segPtr = (TkTextSegment *)ckalloc(TSEG_SIZE);
 	segPtr->typePtr = (add) ? &tkTextToggleOffType : &tkTextToggleOnType;
@@ -2280,9 +2498,16 @@ TkBTreeTag(
 	if (cleanupLinePtr != index2Ptr->linePtr) {
 	    CleanupLine(index2Ptr->linePtr);
 	}
-	((BTree *)index1Ptr->tree)->stateEpoch++;
     }
 
+    /*
+     * Even when no toggle changed, the SplitSeg calls above may have
+     * replaced segments, so cached segment positions must be dropped
+     * unconditionally.
+     */
+
+    ((BTree *)index1Ptr->tree)->stateEpoch++;
+
     if (tkBTreeDebug) {
 	TkBTreeCheck(index1Ptr->tree);
     }
@@ -2379,7 +2604,7 @@ ChangeNodeToggleCount(
 	    } else {
 		prevPtr->nextPtr = summaryPtr->nextPtr;
 	    }
-	    ckfree(summaryPtr);
+	    FreeSummary(nodePtr->treePtr, summaryPtr);
 	} else {
 	    /*
 	     * This tag isn't currently in the summary information list.
@@ -2398,7 +2623,7 @@ ChangeNodeToggleCount(
 
 		Node *rootNodePtr = tagPtr->tagRootPtr;
 
-		summaryPtr = (Summary *)ckalloc(sizeof(Summary));
+		summaryPtr = AllocSummary(nodePtr->treePtr);
 		summaryPtr->tagPtr = tagPtr;
 		summaryPtr->toggleCount = tagPtr->toggleCount - delta;
 		summaryPtr->nextPtr = rootNodePtr->summaryPtr;
@@ -2407,7 +2632,7 @@ ChangeNodeToggleCount(
 		rootLevel = rootNodePtr->level;
 		tagPtr->tagRootPtr = rootNodePtr;
 	    }
-	    summaryPtr = (Summary *)ckalloc(sizeof(Summary));
+	    summaryPtr = AllocSummary(nodePtr->treePtr);
 	    summaryPtr->tagPtr = tagPtr;
 	    summaryPtr->toggleCount = delta;
 	    summaryPtr->nextPtr = nodePtr->summaryPtr;
@@ -2464,7 +2689,7 @@ ChangeNodeToggleCount(
 	    } else {
 		prevPtr->nextPtr = summaryPtr->nextPtr;
 	    }
-	    ckfree(summaryPtr);
+	    FreeSummary(node2Ptr->treePtr, summaryPtr);
 	    tagPtr->tagRootPtr = node2Ptr;
 	    break;
 	}
@@ -3384,6 +3609,7 @@ TkBTreeGetTags(
     tagInfo.arraySize = NUM_TAG_INFOS;
     tagInfo.tagPtrs = (TkTextTag **)ckalloc(NUM_TAG_INFOS * sizeof(TkTextTag *));
     tagInfo.counts = (int *)ckalloc(NUM_TAG_INFOS * sizeof(int));
+    tagInfo.epoch = ++((BTree *) indexPtr->tree)->sharedTextPtr->tagScanEpoch;
 
     /*
      * Record tag toggles within the line of indexPtr but preceding indexPtr.
@@ -3476,6 +3702,300 @@ TkBTreeGetTags(
     return tagInfo.tagPtrs;
 }
 
+/*
+ * The structures below form a cache of the elided ranges in a shared text
+ * widget. The table is a sorted array of non-overlapping ranges, rebuilt
+ * lazily from the tag toggle segments whenever the B-tree epoch or the
+ * shared stateEpoch has moved on (edits, tag add/remove, changes to a
+ * tag's -elide or priority). With the table current, an elide query is a
+ * binary search instead of a scan over toggle segments and node
+ * summaries, which matters when many ranges are elided (e.g. code
+ * folding).
+ */
+
+typedef struct TkTextElideRange {
+    Tcl_Size startLine;		/* Line containing the first elided byte. */
+    Tcl_Size startByte;		/* Byte index of the first elided byte. */
+    Tcl_Size endLine;		/* Line containing the first byte after the
+				 * range. */
+    Tcl_Size endByte;		/* Byte index of the first byte after the
+				 * range. */
+} TkTextElideRange;
+
+typedef struct TkTextElideTable {
+    Tcl_Size treeEpoch;		/* B-tree stateEpoch when the table was
+				 * built. */
+    Tcl_Size sharedEpoch;	/* Shared stateEpoch when the table was
+				 * built. */
+    Tcl_Size numRanges;		/* Number of entries in ranges. */
+    Tcl_Size maxRanges;		/* Allocated size of ranges. */
+    TkTextElideRange *ranges;	/* Sorted array of elided ranges. */
+} TkTextElideTable;
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ElideTableUpdate --
+ *
+ *	Bring the shared elide-range table up to date, rebuilding it from
+ *	the tag toggle segments if any epoch has changed since it was last
+ *	built. The rebuild makes a single pass over all segments,
+ *	recording a range boundary wherever the priority-resolved elide
+ *	state flips.
+ *
+ * Results:
+ *	Returns the up-to-date table.
+ *
+ * Side effects:
+ *	Memory may be allocated and the table stored in the shared text
+ *	structure.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static TkTextElideTable *
+ElideTableUpdate(
+    const TkText *textPtr)	/* Overall information about text widget. */
+{
+    TkSharedText *sharedTextPtr = textPtr->sharedTextPtr;
+    TkTextElideTable *tablePtr = sharedTextPtr->elideTablePtr;
+    BTree *treePtr = (BTree *) sharedTextPtr->tree;
+    TkTextLine *linePtr;
+    TkTextSegment *segPtr;
+    TkTextElideRange *rangePtr;
+    TkTextTag **tagPtrs;
+    int *tagCnts;
+    Tcl_Size numTags = sharedTextPtr->numTags;
+    Tcl_Size lineNo, byteIndex, i;
+    int state;
+
+    if (tablePtr != NULL) {
+	if ((tablePtr->treeEpoch == treePtr->stateEpoch)
+		&& (tablePtr->sharedEpoch == sharedTextPtr->stateEpoch)) {
+	    return tablePtr;
+	}
+	tablePtr->numRanges = 0;
+    } else {
+	tablePtr = (TkTextElideTable *)ckalloc(sizeof(TkTextElideTable));
+	tablePtr->numRanges = 0;
+	tablePtr->maxRanges = 16;
+	tablePtr->ranges = (TkTextElideRange *)
+		ckalloc(sizeof(TkTextElideRange) * tablePtr->maxRanges);
+	sharedTextPtr->elideTablePtr = tablePtr;
+    }
+
+    tagCnts = (int *)ckalloc(sizeof(int) * numTags);
+    tagPtrs = (TkTextTag **)ckalloc(sizeof(TkTextTag *) * numTags);
+    for (i = 0; i < numTags; i++) {
+	tagCnts[i] = 0;
+    }
+
+    state = 0;
+    lineNo = 0;
+    for (linePtr = TkBTreeFindLine(sharedTextPtr->tree, NULL, 0);
+	    linePtr != NULL;
+	    linePtr = TkBTreeNextLine(NULL, linePtr), lineNo++) {
+	byteIndex = 0;
+	for (segPtr = linePtr->segPtr; segPtr != NULL;
+		segPtr = segPtr->nextPtr) {
+	    if ((segPtr->typePtr == &tkTextToggleOnType)
+		    || (segPtr->typePtr == &tkTextToggleOffType)) {
+		TkTextTag *tagPtr = segPtr->body.toggle.tagPtr;
+
+		if (tagPtr->elide >= 0) {
+		    int newState = 0;
+
+		    tagPtrs[tagPtr->priority] = tagPtr;
+		    tagCnts[tagPtr->priority]++;
+		    for (i = numTags - 1; i >= 0; i--) {
+			if (tagCnts[i] & 1) {
+			    newState = tagPtrs[i]->elide > 0;
+			    break;
+			}
+		    }
+		    if (newState != state) {
+			if (newState) {
+			    if (tablePtr->numRanges == tablePtr->maxRanges) {
+				tablePtr->maxRanges *= 2;
+				tablePtr->ranges = (TkTextElideRange *)
+					ckrealloc(tablePtr->ranges,
+					sizeof(TkTextElideRange)
+					* tablePtr->maxRanges);
+			    }
+			    rangePtr = &tablePtr->ranges[tablePtr->numRanges++];
+			    rangePtr->startLine = lineNo;
+			    rangePtr->startByte = byteIndex;
+			} else {
+			    rangePtr = &tablePtr->ranges[tablePtr->numRanges-1];
+			    if ((rangePtr->startLine == lineNo)
+				    && (rangePtr->startByte == byteIndex)) {
+				/*
+				 * Toggles at a single spot cancelled out;
+				 * drop the empty range.
+				 */
+
+				tablePtr->numRanges--;
+			    } else {
+				rangePtr->endLine = lineNo;
+				rangePtr->endByte = byteIndex;
+			    }
+			}
+			state = newState;
+		    }
+		}
+	    }
+	    byteIndex += segPtr->size;
+	}
+    }
+
+    /*
+     * Toggles always balance over the whole tree, but close any range
+     * left open rather than leave its end uninitialized.
+     */
+
+    if (state && (tablePtr->numRanges > 0)) {
+	rangePtr = &tablePtr->ranges[tablePtr->numRanges - 1];
+	rangePtr->endLine = lineNo;
+	rangePtr->endByte = 0;
+    }
+
+    ckfree(tagCnts);
+    ckfree(tagPtrs);
+    tablePtr->treeEpoch = treePtr->stateEpoch;
+    tablePtr->sharedEpoch = sharedTextPtr->stateEpoch;
+    return tablePtr;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ElideTableFind --
+ *
+ *	Look up the elided range containing the given position, if any.
+ *
+ * Results:
+ *	Returns the range containing the position, or NULL if the
+ *	position is not elided.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static TkTextElideRange *
+ElideTableFind(
+    TkTextElideTable *tablePtr,	/* Up-to-date elide-range table. */
+    Tcl_Size lineNo,		/* Line number of the position. */
+    Tcl_Size byteIndex)		/* Byte index within that line. */
+{
+    Tcl_Size low = 0, high = tablePtr->numRanges;
+    TkTextElideRange *rangePtr;
+
+    /*
+     * Find the first range starting after the position, then check
+     * whether the position falls inside its predecessor.
+     */
+
+    while (low < high) {
+	Tcl_Size mid = (low + high) / 2;
+
+	rangePtr = &tablePtr->ranges[mid];
+	if ((rangePtr->startLine > lineNo) || ((rangePtr->startLine == lineNo)
+		&& (rangePtr->startByte > byteIndex))) {
+	    high = mid;
+	} else {
+	    low = mid + 1;
+	}
+    }
+    if (low == 0) {
+	return NULL;
+    }
+    rangePtr = &tablePtr->ranges[low - 1];
+    if ((rangePtr->endLine > lineNo) || ((rangePtr->endLine == lineNo)
+	    && (rangePtr->endByte > byteIndex))) {
+	return rangePtr;
+    }
+    return NULL;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkTextFreeElideTable --
+ *
+ *	Release the elide-range table of a shared text widget, if one has
+ *	been built.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory may be freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkTextFreeElideTable(
+    TkSharedText *sharedTextPtr)/* Shared widget section. */
+{
+    TkTextElideTable *tablePtr = sharedTextPtr->elideTablePtr;
+
+    if (tablePtr != NULL) {
+	ckfree(tablePtr->ranges);
+	ckfree(tablePtr);
+	sharedTextPtr->elideTablePtr = NULL;
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkTextElidedLineSpan --
+ *
+ *	Determine whether an entire logical line, including its final
+ *	newline, lies inside a single elided range, so callers laying out
+ *	display lines can skip it without walking its toggle segments.
+ *
+ * Results:
+ *	Returns 1 if the whole line is elided, in which case *byteCountPtr
+ *	is set to the number of bytes in the line; returns 0 otherwise.
+ *
+ * Side effects:
+ *	The elide-range table may be (re)built.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkTextElidedLineSpan(
+    const TkText *textPtr,	/* Overall information about text widget. */
+    TkTextLine *linePtr,	/* The logical line of interest. */
+    int *byteCountPtr)		/* Filled in with the number of bytes in the
+				 * line when it is entirely elided. */
+{
+    TkTextElideRange *rangePtr;
+    TkTextSegment *segPtr;
+    Tcl_Size lineNo;
+    int byteCount;
+
+    if (textPtr->sharedTextPtr->numElideTags == 0) {
+	return 0;
+    }
+    lineNo = TkBTreeLinesTo(NULL, linePtr);
+    rangePtr = ElideTableFind(ElideTableUpdate(textPtr), lineNo, 0);
+    if ((rangePtr == NULL) || (rangePtr->endLine <= lineNo)) {
+	return 0;
+    }
+    byteCount = 0;
+    for (segPtr = linePtr->segPtr; segPtr != NULL; segPtr = segPtr->nextPtr) {
+	byteCount += segPtr->size;
+    }
+    *byteCountPtr = byteCount;
+    return 1;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -3523,13 +4043,41 @@ TkTextIsElided(
     Tcl_Size i;
     TkTextElideInfo *infoPtr;
     TkTextLine *linePtr;
-    int elide, index;
+    int index;
+
+    /*
+     * If no tag in the widget has -elide configured, nothing can possibly
+     * be elided; skip gathering toggle counts altogether. This is the
+     * normal case for widgets with many tags (e.g. syntax highlighting),
+     * where the full scan over per-node tag summaries would otherwise be
+     * run for every layout and index operation.
+     */
+
+    if (textPtr->sharedTextPtr->numElideTags == 0) {
+	if (elideInfo != NULL) {
+	    elideInfo->elide = 0;
+	    elideInfo->numTags = 0;
+	    elideInfo->elidePriority = -1;
+	    elideInfo->tagCnts = elideInfo->deftagCnts;
+	    elideInfo->tagPtrs = elideInfo->deftagPtrs;
+	    elideInfo->segPtr = indexPtr->linePtr->segPtr;
+	    elideInfo->segOffset = 0;
+	}
+	return 0;
+    }
+
+    /*
+     * When only the yes/no answer is needed, binary search the shared
+     * elide-range table instead of scanning toggle segments and node
+     * summaries.
+     */
 
     if (elideInfo == NULL) {
-	infoPtr = (TkTextElideInfo *)ckalloc(sizeof(TkTextElideInfo));
-    } else {
-	infoPtr = elideInfo;
+	return ElideTableFind(ElideTableUpdate(textPtr),
+		TkBTreeLinesTo(NULL, indexPtr->linePtr),
+		indexPtr->byteIndex) != NULL;
     }
+    infoPtr = elideInfo;
 
     infoPtr->elide = 0;		/* If nobody says otherwise, it's visible. */
     infoPtr->tagCnts = infoPtr->deftagCnts;
@@ -3653,18 +4201,7 @@ TkTextIsElided(
 	}
     }
 
-    elide = infoPtr->elide;
-
-    if (elideInfo == NULL) {
-	if (LOTSA_TAGS < infoPtr->numTags) {
-	    ckfree(infoPtr->tagCnts);
-	    ckfree(infoPtr->tagPtrs);
-	}
-
-	ckfree(infoPtr);
-    }
-
-    return elide;
+    return infoPtr->elide;
 }
 
 /*
@@ -3721,15 +4258,17 @@ IncCount(
     TagInfo *tagInfoPtr)	/* Holds cumulative information about tags;
 				 * increment count here. */
 {
-    TkTextTag **tagPtrPtr;
-    int count;
+    /*
+     * Each tag memoizes its slot in the scan's arrays, stamped with the
+     * scan's epoch, so repeated toggles of the same tag cost a couple of
+     * word operations. The old linear lookup made gathering toggles
+     * quadratic in the number of distinct tags, which dominated redisplay
+     * once a syntax highlighter had created a few hundred of them.
+     */
 
-    for (tagPtrPtr = tagInfoPtr->tagPtrs, count = tagInfoPtr->numTags;
-	    count > 0; tagPtrPtr++, count--) {
-	if (*tagPtrPtr == tagPtr) {
-	    tagInfoPtr->counts[tagInfoPtr->numTags-count] += inc;
-	    return;
-	}
+    if (tagPtr->scanEpoch == tagInfoPtr->epoch) {
+	tagInfoPtr->counts[tagPtr->scanIndex] += inc;
+	return;
     }
 
     /*
@@ -3755,6 +4294,8 @@ IncCount(
 	tagInfoPtr->arraySize = newSize;
     }
 
+    tagPtr->scanEpoch = tagInfoPtr->epoch;
+    tagPtr->scanIndex = tagInfoPtr->numTags;
     tagInfoPtr->tagPtrs[tagInfoPtr->numTags] = tagPtr;
     tagInfoPtr->counts[tagInfoPtr->numTags] = inc;
     tagInfoPtr->numTags++;
@@ -4139,7 +4680,7 @@ Rebalance(
 		 */
 
 		if (nodePtr->parentPtr == NULL) {
-		    newPtr = (Node *)ckalloc(sizeof(Node));
+		    newPtr = AllocNode(treePtr);
 		    newPtr->parentPtr = NULL;
 		    newPtr->nextPtr = NULL;
 		    newPtr->summaryPtr = NULL;
@@ -4155,7 +4696,7 @@ Rebalance(
 		    RecomputeNodeCounts(treePtr, newPtr);
 		    treePtr->rootPtr = newPtr;
 		}
-		newPtr = (Node *)ckalloc(sizeof(Node));
+		newPtr = AllocNode(treePtr);
 		newPtr->numPixels = (int *)
 			ckalloc(sizeof(int) * treePtr->pixelReferences);
 		for (i=0; i<treePtr->pixelReferences; i++) {
@@ -4212,9 +4753,9 @@ Rebalance(
 		if ((nodePtr->numChildren == 1) && (nodePtr->level > 0)) {
 		    treePtr->rootPtr = nodePtr->children.nodePtr;
 		    treePtr->rootPtr->parentPtr = NULL;
-		    DeleteSummaries(nodePtr->summaryPtr);
+		    FreeSummaryList(treePtr, nodePtr->summaryPtr);
 		    ckfree(nodePtr->numPixels);
-		    ckfree(nodePtr);
+		    FreeNode(treePtr, nodePtr);
 		}
 		return;
 	    }
@@ -4298,9 +4839,9 @@ Rebalance(
 		RecomputeNodeCounts(treePtr, nodePtr);
 		nodePtr->nextPtr = otherPtr->nextPtr;
 		nodePtr->parentPtr->numChildren--;
-		DeleteSummaries(otherPtr->summaryPtr);
+		FreeSummaryList(treePtr, otherPtr->summaryPtr);
 		ckfree(otherPtr->numPixels);
-		ckfree(otherPtr);
+		FreeNode(treePtr, otherPtr);
 		continue;
 	    }
 
@@ -4398,7 +4939,7 @@ RecomputeNodeCounts(
 		for (summaryPtr = nodePtr->summaryPtr; ;
 			summaryPtr = summaryPtr->nextPtr) {
 		    if (summaryPtr == NULL) {
-			summaryPtr = (Summary *)ckalloc(sizeof(Summary));
+			summaryPtr = AllocSummary(treePtr);
 			summaryPtr->tagPtr = tagPtr;
 			summaryPtr->toggleCount = 1;
 			summaryPtr->nextPtr = nodePtr->summaryPtr;
@@ -4426,7 +4967,7 @@ RecomputeNodeCounts(
 		for (summaryPtr = nodePtr->summaryPtr; ;
 			summaryPtr = summaryPtr->nextPtr) {
 		    if (summaryPtr == NULL) {
-			summaryPtr = (Summary *)ckalloc(sizeof(Summary));
+			summaryPtr = AllocSummary(treePtr);
 			summaryPtr->tagPtr = summaryPtr2->tagPtr;
 			summaryPtr->toggleCount = summaryPtr2->toggleCount;
 			summaryPtr->nextPtr = nodePtr->summaryPtr;
@@ -4475,11 +5016,11 @@ RecomputeNodeCounts(
 	}
 	if (summaryPtr2 != NULL) {
 	    summaryPtr2->nextPtr = summaryPtr->nextPtr;
-	    ckfree(summaryPtr);
+	    FreeSummary(treePtr, summaryPtr);
 	    summaryPtr = summaryPtr2->nextPtr;
 	} else {
 	    nodePtr->summaryPtr = summaryPtr->nextPtr;
-	    ckfree(summaryPtr);
+	    FreeSummary(treePtr, summaryPtr);
 	    summaryPtr = nodePtr->summaryPtr;
 	}
     }
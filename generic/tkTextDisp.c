@@ -261,6 +261,13 @@ typedef struct DLine {
     int rMarginWidth;           /* Pixel width of the area corresponding to
                                  * the right margin. */
     int length;			/* Total length of line, in pixels. */
+    Tcl_Size cacheEpoch;	/* Value of the B-tree's modification epoch
+				 * when this line was put in the layout reuse
+				 * cache. The cached layout is only reused
+				 * while the epoch is unchanged. */
+    int cacheMaxX;		/* Value of dInfoPtr->maxX when this line was
+				 * cached, i.e. the wrap width it was laid
+				 * out for. */
     TkTextDispChunk *chunkPtr;	/* Pointer to first chunk in list of all of
 				 * those that are displayed on this line of
 				 * the screen. */
@@ -320,6 +327,38 @@ typedef struct TextDInfo {
 				 * TextStyles for this widget. */
     DLine *dLinePtr;		/* First in list of all display lines for this
 				 * widget, in order from top to bottom. */
+    DLine *cachedDLinePtr;	/* Most-recently-cached first in a list of
+				 * fully laid-out display lines that have
+				 * scrolled out of view but whose layout is
+				 * still valid, linked through their nextPtr
+				 * fields. LayoutDLine reuses these instead
+				 * of re-measuring unchanged lines, which is
+				 * what makes scrolling through a large
+				 * unmodified document cheap. */
+    int numCachedDLines;	/* Number of lines in cachedDLinePtr. */
+    TkTextDispChunk *chunkFreePtr;
+				/* Free list of display chunk records, linked
+				 * through their nextPtr fields. Every
+				 * relayout of a display line frees its
+				 * chunks and allocates fresh ones, so
+				 * recycling the records here avoids a pair
+				 * of heap calls per chunk. */
+    int numFreeChunks;		/* Number of chunks in chunkFreePtr. */
+
+    /*
+     * Performance counters reported by "pathName debug stats".
+     */
+
+    Tcl_WideInt statNumLayouts;	/* Number of calls to LayoutDLine. */
+    Tcl_WideInt statNumChunks;	/* Number of display chunks allocated. */
+    Tcl_WideInt statNumMeasures;/* Number of text measurement calls made
+				 * while laying out character chunks. */
+    Tcl_WideInt statLinesRemeasured;
+				/* Number of logical lines whose pixel height
+				 * was recalculated. */
+    Tcl_WideInt statNumPasses;	/* Number of complete display passes. */
+    Tcl_WideInt statDisplayTime;/* Total microseconds spent in display
+				 * passes. */
     int topPixelOffset;		/* Identifies first pixel in top display line
 				 * to display in window. */
     int newTopPixelOffset;	/* Desired first pixel in top display line to
@@ -516,6 +555,21 @@ static TkTextDispChunk *baseCharChunkPtr = NULL;
 #define DLINE_UNLINK	  1
 #define DLINE_FREE_TEMP	  2
 
+/*
+ * Maximum number of display lines kept in the per-widget layout reuse cache.
+ * A few screenfuls is enough to make short scrolls in either direction free
+ * while bounding the memory kept alive per peer.
+ */
+
+#define DLINE_CACHE_SIZE  128
+
+/*
+ * Maximum number of display chunk records kept on the per-widget free list.
+ * Enough for several display lines of richly tagged text.
+ */
+
+#define CHUNK_FREE_LIST_SIZE  256
+
 /*
  * The following counters keep statistics about redisplay that can be checked
  * to see how clever this code is at reducing redisplays.
@@ -574,6 +628,14 @@ static void		DisplayLineBackground(TkText *textPtr, DLine *dlPtr,
 static void		DisplayText(void *clientData);
 static DLine *		FindDLine(TkText *textPtr, DLine *dlPtr,
                             const TkTextIndex *indexPtr);
+static TkTextDispChunk *AllocDispChunk(TkText *textPtr);
+static int		CacheDLine(TkText *textPtr, DLine *dlPtr);
+static void		DestroyDLine(TkText *textPtr, DLine *dlPtr);
+static void		FreeDispChunk(TkText *textPtr,
+			    TkTextDispChunk *chunkPtr);
+static DLine *		FetchCachedDLine(TkText *textPtr,
+			    const TkTextIndex *indexPtr);
+static void		FlushDLineCache(TkText *textPtr);
 static void		FreeDLines(TkText *textPtr, DLine *firstPtr,
 			    DLine *lastPtr, int action);
 static void		FreeStyle(TkText *textPtr, TextStyle *stylePtr);
@@ -592,6 +654,8 @@ static void		MeasureUp(TkText *textPtr,
 			    const TkTextIndex *srcPtr, int distance,
 			    TkTextIndex *dstPtr, int *overlap);
 static int		NextTabStop(Tk_Font tkfont, int x, int tabOrigin);
+static void		RestyleDLines(TkText *textPtr, DLine *firstPtr,
+			    DLine *lastPtr);
 static void		UpdateDisplayInfo(TkText *textPtr);
 static void		YScrollByLines(TkText *textPtr, int offset);
 static void		YScrollByPixels(TkText *textPtr, int offset);
@@ -662,6 +726,16 @@ TkTextCreateDInfo(
     dInfoPtr = (TextDInfo *)ckalloc(sizeof(TextDInfo));
     Tcl_InitHashTable(&dInfoPtr->styleTable, sizeof(StyleValues)/sizeof(int));
     dInfoPtr->dLinePtr = NULL;
+    dInfoPtr->cachedDLinePtr = NULL;
+    dInfoPtr->numCachedDLines = 0;
+    dInfoPtr->chunkFreePtr = NULL;
+    dInfoPtr->numFreeChunks = 0;
+    dInfoPtr->statNumLayouts = 0;
+    dInfoPtr->statNumChunks = 0;
+    dInfoPtr->statNumMeasures = 0;
+    dInfoPtr->statLinesRemeasured = 0;
+    dInfoPtr->statNumPasses = 0;
+    dInfoPtr->statDisplayTime = 0;
     dInfoPtr->copyGC = NULL;
     gcValues.graphics_exposures = True;
     dInfoPtr->scrollGC = Tk_GetGC(textPtr->tkwin, GCGraphicsExposures,
@@ -725,13 +799,20 @@ TkTextFreeDInfo(
      */
 
     FreeDLines(textPtr, dInfoPtr->dLinePtr, NULL, DLINE_UNLINK);
+    FlushDLineCache(textPtr);
+    while (dInfoPtr->chunkFreePtr != NULL) {
+	TkTextDispChunk *chunkPtr = dInfoPtr->chunkFreePtr;
+
+	dInfoPtr->chunkFreePtr = chunkPtr->nextPtr;
+	ckfree(chunkPtr);
+    }
     Tcl_DeleteHashTable(&dInfoPtr->styleTable);
     if (dInfoPtr->copyGC != NULL) {
 	Tk_FreeGC(textPtr->display, dInfoPtr->copyGC);
     }
     Tk_FreeGC(textPtr->display, dInfoPtr->scrollGC);
     if (dInfoPtr->flags & REDRAW_PENDING) {
-	Tcl_CancelIdleCall(DisplayText, textPtr);
+	TkCancelDoWhenIdle(DisplayText, textPtr);
     }
     if (dInfoPtr->lineUpdateTimer != NULL) {
 	Tcl_DeleteTimerHandler(dInfoPtr->lineUpdateTimer);
@@ -746,6 +827,82 @@ TkTextFreeDInfo(
     ckfree(dInfoPtr);
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkTextStatsObj --
+ *
+ *	Build a dictionary describing the widget's display performance
+ *	counters, for the "pathName debug stats" widget command.
+ *
+ * Results:
+ *	Returns a new Tcl object holding the dictionary.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tcl_Obj *
+TkTextStatsObj(
+    TkText *textPtr)		/* Overall information for text widget. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    Tcl_Obj *dictPtr = Tcl_NewDictObj();
+
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("layouts", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dInfoPtr->statNumLayouts));
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("chunks", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dInfoPtr->statNumChunks));
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("measurechars", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dInfoPtr->statNumMeasures));
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("linesremeasured", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dInfoPtr->statLinesRemeasured));
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("displaypasses", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dInfoPtr->statNumPasses));
+    Tcl_DictObjPut(NULL, dictPtr,
+	    Tcl_NewStringObj("displaytime", TCL_INDEX_NONE),
+	    Tcl_NewWideIntObj(dInfoPtr->statDisplayTime));
+    return dictPtr;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkTextStatsReset --
+ *
+ *	Reset the widget's display performance counters to zero, for the
+ *	"pathName debug reset" widget command.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkTextStatsReset(
+    TkText *textPtr)		/* Overall information for text widget. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+
+    dInfoPtr->statNumLayouts = 0;
+    dInfoPtr->statNumChunks = 0;
+    dInfoPtr->statNumMeasures = 0;
+    dInfoPtr->statLinesRemeasured = 0;
+    dInfoPtr->statNumPasses = 0;
+    dInfoPtr->statDisplayTime = 0;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -1183,11 +1340,24 @@ LayoutDLine(
     StyleValues *sValuePtr;
     TkTextElideInfo info;	/* Keep track of elide state. */
 
+    textPtr->dInfoPtr->statNumLayouts++;
+
+    /*
+     * If an identical line was laid out earlier and has scrolled out of view
+     * with its layout still valid, reuse it outright: this skips all of the
+     * font measurement and chunk construction below.
+     */
+
+    dlPtr = FetchCachedDLine(textPtr, indexPtr);
+    if (dlPtr != NULL) {
+	return dlPtr;
+    }
+
     /*
      * Create and initialize a new DLine structure.
      */
 
-    dlPtr = (DLine *)ckalloc(sizeof(DLine));
+    dlPtr = (DLine *)TkMemAlloc(TK_MEM_TEXT, sizeof(DLine));
     dlPtr->index = *indexPtr;
     dlPtr->byteCount = 0;
     dlPtr->y = 0;
@@ -1212,9 +1382,31 @@ LayoutDLine(
     paragraphStart = (indexPtr->byteIndex == 0);
 
     /*
-     * Special case entirely elide line as there may be 1000s or more.
+     * Special case entirely elide line as there may be 1000s or more. If
+     * the shared elide-range table shows that this logical line lies
+     * wholly inside one elided range, skip the toggle walk below
+     * altogether.
      */
 
+    if (paragraphStart
+	    && TkTextElidedLineSpan(textPtr, indexPtr->linePtr, &maxBytes)) {
+	dlPtr->byteCount = maxBytes;
+	dlPtr->spaceAbove = dlPtr->spaceBelow = dlPtr->length = 0;
+
+	/*
+	 * The elided state covers the entire logical line, so we can
+	 * bring its pixel calculation up to date here, as in the
+	 * equivalent case below.
+	 */
+
+	TkBTreeLinePixelEpoch(textPtr, dlPtr->index.linePtr)
+		= textPtr->dInfoPtr->lineMetricUpdateEpoch;
+	if (TkBTreeLinePixelCount(textPtr, dlPtr->index.linePtr) != 0) {
+	    TkBTreeAdjustPixelHeight(textPtr, dlPtr->index.linePtr, 0, 0);
+	}
+	return dlPtr;
+    }
+
     elide = TkTextIsElided(textPtr, indexPtr, &info);
     if (elide && indexPtr->byteIndex == 0) {
 	maxBytes = 0;
@@ -1436,9 +1628,7 @@ LayoutDLine(
 	    continue;
 	}
 	if (chunkPtr == NULL) {
-	    chunkPtr = (TkTextDispChunk *)ckalloc(sizeof(TkTextDispChunk));
-	    chunkPtr->nextPtr = NULL;
-	    chunkPtr->clientData = NULL;
+	    chunkPtr = AllocDispChunk(textPtr);
 	}
 	chunkPtr->stylePtr = GetStyle(textPtr, &curIndex);
 	elide = chunkPtr->stylePtr->sValuePtr->elide;
@@ -1569,7 +1759,7 @@ LayoutDLine(
 	     */
 
 	    if (chunkPtr != NULL) {
-		ckfree(chunkPtr);
+		FreeDispChunk(textPtr, chunkPtr);
 	    }
 	    break;
 	}
@@ -1700,7 +1890,7 @@ LayoutDLine(
 	    if (chunkPtr->undisplayProc != NULL) {
 		chunkPtr->undisplayProc(textPtr, chunkPtr);
 	    }
-	    ckfree(chunkPtr);
+	    FreeDispChunk(textPtr, chunkPtr);
 	}
 	if (breakByteOffset != breakChunkPtr->numBytes) {
 	    if (breakChunkPtr->undisplayProc != NULL) {
@@ -2365,7 +2555,6 @@ FreeDLines(
 				 * we shouldn't invalidate anything for the
 				 * overall widget. */
 {
-    TkTextDispChunk *chunkPtr, *nextChunkPtr;
     DLine *nextDLinePtr;
 
     if (action == DLINE_FREE_TEMP) {
@@ -2396,16 +2585,9 @@ FreeDLines(
     }
     while (firstPtr != lastPtr) {
 	nextDLinePtr = firstPtr->nextPtr;
-	for (chunkPtr = firstPtr->chunkPtr; chunkPtr != NULL;
-		chunkPtr = nextChunkPtr) {
-	    if (chunkPtr->undisplayProc != NULL) {
-		chunkPtr->undisplayProc(textPtr, chunkPtr);
-	    }
-	    FreeStyle(textPtr, chunkPtr->stylePtr);
-	    nextChunkPtr = chunkPtr->nextPtr;
-	    ckfree(chunkPtr);
+	if ((action == DLINE_FREE_TEMP) || !CacheDLine(textPtr, firstPtr)) {
+	    DestroyDLine(textPtr, firstPtr);
 	}
-	ckfree(firstPtr);
 	firstPtr = nextDLinePtr;
     }
     if (action != DLINE_FREE_TEMP) {
@@ -2413,6 +2595,242 @@ FreeDLines(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * DestroyDLine --
+ *
+ *	Release all resources of a single display line that is linked neither
+ *	into the display list nor into the layout reuse cache.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Chunk undisplay procedures are run, styles are released and the
+ *	memory of the line and its chunks is freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DestroyDLine(
+    TkText *textPtr,		/* Information about overall text widget. */
+    DLine *dlPtr)		/* Display line to free up. */
+{
+    TkTextDispChunk *chunkPtr, *nextChunkPtr;
+
+    for (chunkPtr = dlPtr->chunkPtr; chunkPtr != NULL;
+	    chunkPtr = nextChunkPtr) {
+	if (chunkPtr->undisplayProc != NULL) {
+	    chunkPtr->undisplayProc(textPtr, chunkPtr);
+	}
+	FreeStyle(textPtr, chunkPtr->stylePtr);
+	nextChunkPtr = chunkPtr->nextPtr;
+	FreeDispChunk(textPtr, chunkPtr);
+    }
+    TkMemFree(dlPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * AllocDispChunk, FreeDispChunk --
+ *
+ *	Allocate and release display chunk records through a per-widget
+ *	free list. Every relayout of a display line frees its chunks and
+ *	allocates fresh ones, so during editing and scrolling the same
+ *	handful of records is recycled continuously instead of going
+ *	through the heap allocator each time.
+ *
+ * Results:
+ *	AllocDispChunk returns a chunk with its nextPtr and clientData
+ *	fields reset; the other fields are uninitialized.
+ *
+ * Side effects:
+ *	Memory is allocated, or kept on the free list for reuse;
+ *	FreeDispChunk frees the chunk outright once the free list is full.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static TkTextDispChunk *
+AllocDispChunk(
+    TkText *textPtr)		/* Widget the chunk will belong to. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    TkTextDispChunk *chunkPtr = dInfoPtr->chunkFreePtr;
+
+    if (chunkPtr != NULL) {
+	dInfoPtr->chunkFreePtr = chunkPtr->nextPtr;
+	dInfoPtr->numFreeChunks--;
+    } else {
+	chunkPtr = (TkTextDispChunk *)ckalloc(sizeof(TkTextDispChunk));
+    }
+    chunkPtr->nextPtr = NULL;
+    chunkPtr->clientData = NULL;
+    dInfoPtr->statNumChunks++;
+    return chunkPtr;
+}
+
+static void
+FreeDispChunk(
+    TkText *textPtr,		/* Widget the chunk belonged to. */
+    TkTextDispChunk *chunkPtr)	/* Chunk to release; must already have been
+				 * undisplayed. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+
+    if (dInfoPtr->numFreeChunks >= CHUNK_FREE_LIST_SIZE) {
+	ckfree(chunkPtr);
+	return;
+    }
+    chunkPtr->nextPtr = dInfoPtr->chunkFreePtr;
+    dInfoPtr->chunkFreePtr = chunkPtr;
+    dInfoPtr->numFreeChunks++;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CacheDLine --
+ *
+ *	Try to move a display line that is leaving the display into the
+ *	widget's layout reuse cache instead of destroying it.
+ *
+ *	Only lines made up exclusively of character (and elided) chunks are
+ *	cached: chunks of embedded windows, embedded images and the insertion
+ *	cursor have undisplay procedures with side effects that must not be
+ *	deferred, and their appearance can change without any B-tree
+ *	modification.
+ *
+ * Results:
+ *	Returns 1 if the line was taken over by the cache, 0 if the caller
+ *	must destroy it.
+ *
+ * Side effects:
+ *	The least recently cached line may be destroyed to make room.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+CacheDLine(
+    TkText *textPtr,		/* Information about overall text widget. */
+    DLine *dlPtr)		/* Display line leaving the display. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    TkTextDispChunk *chunkPtr;
+
+    for (chunkPtr = dlPtr->chunkPtr; chunkPtr != NULL;
+	    chunkPtr = chunkPtr->nextPtr) {
+	if ((chunkPtr->displayProc != CharDisplayProc)
+		&& (chunkPtr->displayProc != NULL)) {
+	    return 0;
+	}
+    }
+    if (dInfoPtr->numCachedDLines >= DLINE_CACHE_SIZE) {
+	DLine *prevPtr = dInfoPtr->cachedDLinePtr;
+
+	while (prevPtr->nextPtr->nextPtr != NULL) {
+	    prevPtr = prevPtr->nextPtr;
+	}
+	DestroyDLine(textPtr, prevPtr->nextPtr);
+	prevPtr->nextPtr = NULL;
+	dInfoPtr->numCachedDLines--;
+    }
+    dlPtr->cacheEpoch = TkBTreeEpoch(textPtr->sharedTextPtr->tree);
+    dlPtr->cacheMaxX = dInfoPtr->maxX;
+    dlPtr->nextPtr = dInfoPtr->cachedDLinePtr;
+    dInfoPtr->cachedDLinePtr = dlPtr;
+    dInfoPtr->numCachedDLines++;
+    return 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * FetchCachedDLine --
+ *
+ *	Look in the layout reuse cache for a line starting at the given index
+ *	that was laid out for the current wrap width and whose content has
+ *	not changed since it was cached.
+ *
+ * Results:
+ *	A display line ready to be relinked into the display (unlinked from
+ *	the cache, flags reset as for a fresh layout), or NULL if there is no
+ *	reusable entry.
+ *
+ * Side effects:
+ *	A matching line is removed from the cache.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static DLine *
+FetchCachedDLine(
+    TkText *textPtr,		/* Information about overall text widget. */
+    const TkTextIndex *indexPtr)/* Index of first character the line is to
+				 * display. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    Tcl_Size epoch = TkBTreeEpoch(textPtr->sharedTextPtr->tree);
+    DLine *dlPtr, *prevPtr;
+
+    for (prevPtr = NULL, dlPtr = dInfoPtr->cachedDLinePtr; dlPtr != NULL;
+	    prevPtr = dlPtr, dlPtr = dlPtr->nextPtr) {
+	if ((dlPtr->cacheEpoch == epoch)
+		&& (dlPtr->cacheMaxX == dInfoPtr->maxX)
+		&& (dlPtr->index.linePtr == indexPtr->linePtr)
+		&& (dlPtr->index.byteIndex == indexPtr->byteIndex)) {
+	    if (prevPtr == NULL) {
+		dInfoPtr->cachedDLinePtr = dlPtr->nextPtr;
+	    } else {
+		prevPtr->nextPtr = dlPtr->nextPtr;
+	    }
+	    dInfoPtr->numCachedDLines--;
+	    dlPtr->index = *indexPtr;
+	    dlPtr->nextPtr = NULL;
+	    dlPtr->flags = NEW_LAYOUT | OLD_Y_INVALID;
+	    return dlPtr;
+	}
+    }
+    return NULL;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * FlushDLineCache --
+ *
+ *	Empty the widget's layout reuse cache. Called whenever the widget's
+ *	content, styling or geometry changes in a way that could invalidate
+ *	cached layouts, and when the display information is torn down.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	All cached display lines are destroyed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+FlushDLineCache(
+    TkText *textPtr)		/* Information about overall text widget. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    DLine *dlPtr, *nextPtr;
+
+    for (dlPtr = dInfoPtr->cachedDLinePtr; dlPtr != NULL; dlPtr = nextPtr) {
+	nextPtr = dlPtr->nextPtr;
+	DestroyDLine(textPtr, dlPtr);
+    }
+    dInfoPtr->cachedDLinePtr = NULL;
+    dInfoPtr->numCachedDLines = 0;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -3018,6 +3436,7 @@ AsyncUpdateLineMetrics(
     TkText *textPtr = (TkText *)clientData;
     TextDInfo *dInfoPtr = textPtr->dInfoPtr;
     int lineNum;
+    Tcl_Time start, now;
 
     dInfoPtr->lineUpdateTimer = NULL;
 
@@ -3051,12 +3470,33 @@ AsyncUpdateLineMetrics(
     }
 
     /*
-     * Update the lines in blocks of about 24 recalculations, or 250+ lines
-     * examined, so we pass in 256 for 'doThisMuch'.
+     * Update lines in blocks of about 24 recalculations (or 250+ lines
+     * examined, so we pass in 256 for 'doThisMuch'), and keep going for up
+     * to a couple of milliseconds of wall-clock time per timer tick. The
+     * old fixed single block per tick converged far too slowly on huge
+     * documents (a multi-hundred-MB log file took minutes to give correct
+     * scrollbar proportions); a time budget measures as many lines as the
+     * machine manages in the slice while still yielding to the event loop
+     * between ticks. Moving the layout work to a worker thread instead is
+     * not an option: line layout reads the live B-tree and measures through
+     * the font and display machinery, none of which may be touched off the
+     * widget's thread.
      */
 
-    lineNum = TkTextUpdateLineMetrics(textPtr, lineNum,
-	    dInfoPtr->lastMetricUpdateLine, 256);
+    Tcl_GetTime(&start);
+    while (1) {
+	lineNum = TkTextUpdateLineMetrics(textPtr, lineNum,
+		dInfoPtr->lastMetricUpdateLine, 256);
+	if ((dInfoPtr->metricEpoch == -1)
+		&& (lineNum == dInfoPtr->lastMetricUpdateLine)) {
+	    break;
+	}
+	Tcl_GetTime(&now);
+	if ((now.sec - start.sec) * 1000000 + (now.usec - start.usec)
+		>= 2000) {
+	    break;
+	}
+    }
 
     dInfoPtr->currentMetricUpdateLine = lineNum;
 
@@ -3084,7 +3524,7 @@ AsyncUpdateLineMetrics(
 
         if (textPtr->afterSyncCmd) {
             int code;
-	    Tcl_CancelIdleCall(TkTextRunAfterSyncCmd, textPtr);
+	    TkCancelDoWhenIdle(TkTextRunAfterSyncCmd, textPtr);
             Tcl_Preserve(textPtr->interp);
             code = Tcl_EvalObjEx(textPtr->interp, textPtr->afterSyncCmd,
                     TCL_EVAL_GLOBAL);
@@ -3974,6 +4414,8 @@ TkTextUpdateOneLine(
     int displayLines;
     int mergedLines;
 
+    textPtr->dInfoPtr->statLinesRemeasured++;
+
     if (indexPtr == NULL) {
 	index.tree = textPtr->sharedTextPtr->tree;
 	index.linePtr = linePtr;
@@ -4182,6 +4624,7 @@ DisplayText(
     int bottomY = 0;		/* Initialization needed only to stop compiler
 				 * warnings. */
     Tcl_Interp *interp;
+    Tcl_Time start, now;
 
 
     if ((textPtr->tkwin == NULL) || (textPtr->flags & DESTROYED)) {
@@ -4210,12 +4653,15 @@ DisplayText(
 
     interp = textPtr->interp;
     Tcl_Preserve(interp);
+    Tcl_GetTime(&start);
 
     if (tkTextDebug) {
 	CLEAR("tk_textRelayout");
     }
 
-    if (!Tk_IsMapped(textPtr->tkwin) || (dInfoPtr->maxX <= dInfoPtr->x)
+    if (!Tk_IsMapped(textPtr->tkwin)
+	    || TkWindowObscured((TkWindow *) textPtr->tkwin)
+	    || (dInfoPtr->maxX <= dInfoPtr->x)
 	    || (dInfoPtr->maxY <= dInfoPtr->y)) {
 	UpdateDisplayInfo(textPtr);
 	dInfoPtr->flags &= ~REDRAW_PENDING;
@@ -4487,9 +4933,8 @@ DisplayText(
 
     if (maxHeight > 0) {
 #ifndef TK_NO_DOUBLE_BUFFERING
-	pixmap = Tk_GetPixmap(Tk_Display(textPtr->tkwin),
-		Tk_WindowId(textPtr->tkwin), Tk_Width(textPtr->tkwin),
-		maxHeight, Tk_Depth(textPtr->tkwin));
+	pixmap = TkGetPaintBuffer(textPtr->tkwin, Tk_Width(textPtr->tkwin),
+		maxHeight);
 #else
 	pixmap = Tk_WindowId(textPtr->tkwin);
 #endif /* TK_NO_DOUBLE_BUFFERING */
@@ -4516,7 +4961,7 @@ DisplayText(
 		}
 		if (dInfoPtr->dLinesInvalidated) {
 #ifndef TK_NO_DOUBLE_BUFFERING
-		    Tk_FreePixmap(Tk_Display(textPtr->tkwin), pixmap);
+		    TkReleasePaintBuffer(textPtr->tkwin, pixmap);
 #endif /* TK_NO_DOUBLE_BUFFERING */
 		    goto end;
 		}
@@ -4606,7 +5051,7 @@ DisplayText(
 	    }
 	}
 #ifndef TK_NO_DOUBLE_BUFFERING
-	Tk_FreePixmap(Tk_Display(textPtr->tkwin), pixmap);
+	TkReleasePaintBuffer(textPtr->tkwin, pixmap);
 #endif /* TK_NO_DOUBLE_BUFFERING */
     }
 
@@ -4671,6 +5116,18 @@ DisplayText(
     }
 
   end:
+    if (!(textPtr->flags & DESTROYED)) {
+	Tcl_GetTime(&now);
+	textPtr->dInfoPtr->statNumPasses++;
+	textPtr->dInfoPtr->statDisplayTime +=
+		(Tcl_WideInt)(now.sec - start.sec) * 1000000
+		+ (now.usec - start.usec);
+	if (TkPaintRecording() && Tk_IsMapped(textPtr->tkwin)) {
+	    TkRecordPaint(textPtr->tkwin, &start, dInfoPtr->x, dInfoPtr->y,
+		    dInfoPtr->maxX - dInfoPtr->x,
+		    dInfoPtr->maxY - dInfoPtr->y);
+	}
+    }
     Tcl_Release(interp);
 }
 
@@ -4700,7 +5157,7 @@ TkTextEventuallyRepick(
     dInfoPtr->flags |= REPICK_NEEDED;
     if (!(dInfoPtr->flags & REDRAW_PENDING)) {
 	dInfoPtr->flags |= REDRAW_PENDING;
-	Tcl_DoWhenIdle(DisplayText, textPtr);
+	TkDoWhenIdle(DisplayText, textPtr, TK_IDLE_DISPLAY);
     }
 }
 
@@ -4750,7 +5207,7 @@ TkTextRedrawRegion(
 
     if (!(dInfoPtr->flags & REDRAW_PENDING)) {
 	dInfoPtr->flags |= REDRAW_PENDING;
-	Tcl_DoWhenIdle(DisplayText, textPtr);
+	TkDoWhenIdle(DisplayText, textPtr, TK_IDLE_DISPLAY);
     }
 }
 
@@ -4867,6 +5324,13 @@ TextChanged(
     TkTextLine *linePtr;
     int notBegin;
 
+    /*
+     * The content is about to change, so cached layouts (which may refer to
+     * lines that are about to disappear) cannot be trusted any more.
+     */
+
+    FlushDLineCache(textPtr);
+
     /*
      * Schedule both a redisplay and a recomputation of display information.
      * It's done here rather than the end of the function for two reasons:
@@ -4884,7 +5348,7 @@ TextChanged(
      */
 
     if (!(dInfoPtr->flags & REDRAW_PENDING)) {
-	Tcl_DoWhenIdle(DisplayText, textPtr);
+	TkDoWhenIdle(DisplayText, textPtr, TK_IDLE_DISPLAY);
     }
     dInfoPtr->flags |= REDRAW_PENDING|DINFO_OUT_OF_DATE|REPICK_NEEDED;
 
@@ -4972,6 +5436,67 @@ TextChanged(
     FreeDLines(textPtr, firstPtr, lastPtr, DLINE_UNLINK);
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * RestyleDLines --
+ *
+ *	Re-resolve the style of every chunk of a range of display lines in
+ *	place, without re-laying them out. This is only valid when whatever
+ *	changed cannot affect geometry (no font, spacing, margin, wrap,
+ *	justify or elide change): the chunk boundaries, widths and heights
+ *	all stay as they are, only the colors and similar drawing
+ *	attributes are refreshed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The chunks of the lines from firstPtr up to but not including
+ *	lastPtr get new styles, and the lines are marked for redrawing.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+RestyleDLines(
+    TkText *textPtr,		/* Widget record for text widget. */
+    DLine *firstPtr,		/* First display line to restyle. */
+    DLine *lastPtr)		/* Restyle up to but not including this
+				 * line; NULL means restyle through the end
+				 * of the display list. */
+{
+    DLine *dlPtr;
+    TkTextDispChunk *chunkPtr;
+    TkTextIndex index;
+    TextStyle *stylePtr;
+    const StyleValues *sValuePtr;
+
+    for (dlPtr = firstPtr; dlPtr != lastPtr; dlPtr = dlPtr->nextPtr) {
+	dlPtr->flags &= ~HAS_3D_BORDER;
+	index = dlPtr->index;
+	for (chunkPtr = dlPtr->chunkPtr; chunkPtr != NULL;
+		chunkPtr = chunkPtr->nextPtr) {
+	    stylePtr = GetStyle(textPtr, &index);
+	    FreeStyle(textPtr, chunkPtr->stylePtr);
+	    chunkPtr->stylePtr = stylePtr;
+	    sValuePtr = stylePtr->sValuePtr;
+	    if ((sValuePtr->borderWidth > 0)
+		    && (sValuePtr->relief != TK_RELIEF_FLAT)) {
+		dlPtr->flags |= HAS_3D_BORDER;
+	    }
+	    TkTextIndexForwBytes(textPtr, &index, chunkPtr->numBytes,
+		    &index);
+	}
+	if (dlPtr->chunkPtr != NULL) {
+	    sValuePtr = dlPtr->chunkPtr->stylePtr->sValuePtr;
+	    dlPtr->lMarginColor = sValuePtr->lMarginColor;
+	    dlPtr->rMarginColor = sValuePtr->rMarginColor;
+	}
+	dlPtr->flags |= OLD_Y_INVALID;
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -5037,6 +5562,13 @@ TextRedrawTag(
     TkTextIndex *curIndexPtr;
     TkTextIndex endOfText, *endIndexPtr;
 
+    /*
+     * Tag changes can alter the appearance of any cached layout, not just
+     * the lines currently displayed.
+     */
+
+    FlushDLineCache(textPtr);
+
     /*
      * Invalidate the pixel calculation of all lines in the given range. This
      * may be a bit over-aggressive, so we could consider more subtle
@@ -5121,7 +5653,7 @@ TextRedrawTag(
      */
 
     if (!(dInfoPtr->flags & REDRAW_PENDING)) {
-	Tcl_DoWhenIdle(DisplayText, textPtr);
+	TkDoWhenIdle(DisplayText, textPtr, TK_IDLE_DISPLAY);
     }
     dInfoPtr->flags |= REDRAW_PENDING|DINFO_OUT_OF_DATE|REPICK_NEEDED;
 
@@ -5171,11 +5703,18 @@ TextRedrawTag(
 	}
 
 	/*
-	 * Delete all of the display lines in the range, so that they'll be
-	 * re-layed out and redrawn.
+	 * If the change cannot affect geometry, just swap the styles of
+	 * the affected display lines in place and mark them for
+	 * redrawing; re-coloring must never trigger re-measurement.
+	 * Otherwise delete the display lines so that they'll be re-layed
+	 * out and redrawn.
 	 */
 
-	FreeDLines(textPtr, dlPtr, endPtr, DLINE_UNLINK);
+	if (tagPtr->affectsDisplayGeometry) {
+	    FreeDLines(textPtr, dlPtr, endPtr, DLINE_UNLINK);
+	} else {
+	    RestyleDLines(textPtr, dlPtr, endPtr);
+	}
 	dlPtr = endPtr;
 
 	/*
@@ -5220,13 +5759,20 @@ TkTextRelayoutWindow(
     XGCValues gcValues;
     Bool inSync = 1;
 
+    /*
+     * Geometry or option changes invalidate the wrap width that cached
+     * layouts were computed for.
+     */
+
+    FlushDLineCache(textPtr);
+
     /*
      * Schedule the window redisplay. See TkTextChanged for the reason why
      * this has to be done before any calls to FreeDLines.
      */
 
     if (!(dInfoPtr->flags & REDRAW_PENDING)) {
-	Tcl_DoWhenIdle(DisplayText, textPtr);
+	TkDoWhenIdle(DisplayText, textPtr, TK_IDLE_DISPLAY);
 	inSync = 0;
     }
     dInfoPtr->flags |= REDRAW_PENDING|REDRAW_BORDERS|DINFO_OUT_OF_DATE
@@ -5525,7 +6071,7 @@ TkTextSetYView(
 
   scheduleUpdate:
     if (!(dInfoPtr->flags & REDRAW_PENDING)) {
-	Tcl_DoWhenIdle(DisplayText, textPtr);
+	TkDoWhenIdle(DisplayText, textPtr, TK_IDLE_DISPLAY);
     }
     dInfoPtr->flags |= REDRAW_PENDING|DINFO_OUT_OF_DATE|REPICK_NEEDED;
 }
@@ -5842,7 +6388,7 @@ TkTextSeeCmd(
     dInfoPtr->flags |= DINFO_OUT_OF_DATE;
     if (!(dInfoPtr->flags & REDRAW_PENDING)) {
 	dInfoPtr->flags |= REDRAW_PENDING;
-	Tcl_DoWhenIdle(DisplayText, textPtr);
+	TkDoWhenIdle(DisplayText, textPtr, TK_IDLE_DISPLAY);
     }
     return TCL_OK;
 }
@@ -5923,7 +6469,7 @@ TkTextXviewCmd(
     dInfoPtr->flags |= DINFO_OUT_OF_DATE;
     if (!(dInfoPtr->flags & REDRAW_PENDING)) {
 	dInfoPtr->flags |= REDRAW_PENDING;
-	Tcl_DoWhenIdle(DisplayText, textPtr);
+	TkDoWhenIdle(DisplayText, textPtr, TK_IDLE_DISPLAY);
     }
     return TCL_OK;
 }
@@ -6008,7 +6554,7 @@ YScrollByPixels(
 	return;
     }
     if (!(dInfoPtr->flags & REDRAW_PENDING)) {
-	Tcl_DoWhenIdle(DisplayText, textPtr);
+	TkDoWhenIdle(DisplayText, textPtr, TK_IDLE_DISPLAY);
     }
     dInfoPtr->flags |= REDRAW_PENDING|DINFO_OUT_OF_DATE|REPICK_NEEDED;
 }
@@ -6143,7 +6689,7 @@ YScrollByLines(
 
   scheduleUpdate:
     if (!(dInfoPtr->flags & REDRAW_PENDING)) {
-	Tcl_DoWhenIdle(DisplayText, textPtr);
+	TkDoWhenIdle(DisplayText, textPtr, TK_IDLE_DISPLAY);
     }
     dInfoPtr->flags |= REDRAW_PENDING|DINFO_OUT_OF_DATE|REPICK_NEEDED;
 }
@@ -6448,7 +6994,7 @@ TkTextScanCmd(
 	dInfoPtr->flags |= DINFO_OUT_OF_DATE;
 	if (!(dInfoPtr->flags & REDRAW_PENDING)) {
 	    dInfoPtr->flags |= REDRAW_PENDING;
-	    Tcl_DoWhenIdle(DisplayText, textPtr);
+	    TkDoWhenIdle(DisplayText, textPtr, TK_IDLE_DISPLAY);
 	}
     } else if (c=='m' && strncmp(Tcl_GetString(objv[2]), "mark", length)==0) {
 	dInfoPtr->scanMarkXPixel = dInfoPtr->newXPixelOffset;
@@ -6535,6 +7081,10 @@ GetXView(
 	char buf2[TCL_DOUBLE_SPACE+1];
 	Tcl_DString buf;
 
+	if (TkScrollbarUpdate(interp, Tcl_GetString(textPtr->xScrollCmdObj),
+		first, last)) {
+	    return;
+	}
 	buf1[0] = ' ';
 	buf2[0] = ' ';
 	Tcl_PrintDouble(NULL, first, buf1+1);
@@ -6820,6 +7370,10 @@ GetYView(
 	char buf2[TCL_DOUBLE_SPACE+1];
 	Tcl_DString buf;
 
+	if (TkScrollbarUpdate(interp, Tcl_GetString(textPtr->yScrollCmdObj),
+		first, last)) {
+	    return;
+	}
 	buf1[0] = ' ';
 	buf2[0] = ' ';
 	Tcl_PrintDouble(NULL, first, buf1+1);
@@ -7616,7 +8170,7 @@ ElideMeasureProc(
 
 int
 TkTextCharLayoutProc(
-    TCL_UNUSED(TkText *),	/* Text widget being layed out. */
+    TkText *textPtr,		/* Text widget being layed out. */
     TCL_UNUSED(TkTextIndex *),	/* Index of first character to lay out
 				 * (corresponds to segPtr and offset). */
     TkTextSegment *segPtr,	/* Segment being layed out. */
@@ -7667,6 +8221,7 @@ TkTextCharLayoutProc(
 
     p = segPtr->body.chars + byteOffset;
     tkfont = chunkPtr->stylePtr->sValuePtr->tkfont;
+    textPtr->dInfoPtr->statNumMeasures++;
 
 #ifdef TK_LAYOUT_WITH_BASE_CHUNKS
     if (baseCharChunkPtr == NULL) {
@@ -7705,6 +8260,7 @@ TkTextCharLayoutProc(
 	    int ch;
 	    int chLen = Tcl_UtfToUniChar(p, &ch);
 
+	    textPtr->dInfoPtr->statNumMeasures++;
 #ifdef TK_LAYOUT_WITH_BASE_CHUNKS
 	    bytesThatFit = CharChunkMeasureChars(chunkPtr, line,
 		    lineOffset+chLen, lineOffset, -1, chunkPtr->x, -1, 0,
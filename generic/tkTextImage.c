@@ -24,6 +24,29 @@
 #define EI_SEG_SIZE \
 	(offsetof(TkTextSegment, body) + sizeof(TkTextEmbImage))
 
+/*
+ * Segments embedding the same image share a single image instance through a
+ * record of the following type, looked up by image name in
+ * sharedTextPtr->imageInstanceTable.  The image code then notifies each
+ * distinct image once per change instead of once per occurrence, and memory
+ * scales with the number of distinct images rather than with how often they
+ * are embedded.
+ */
+
+typedef struct TkTextSharedImage {
+    Tk_Image image;		/* Instance shared by all embedding
+				 * segments. */
+    TkSharedText *sharedTextPtr;/* Shared widget section the record belongs
+				 * to. */
+    Tcl_HashEntry *hPtr;	/* Entry in imageInstanceTable (the key is the
+				 * image name given to -image). */
+    TkTextSegment *usePtr;	/* First segment in the doubly-linked list of
+				 * segments embedding this image. */
+    int refCount;		/* Number of segments in that list; the record
+				 * and the instance are freed when it drops to
+				 * zero. */
+} TkTextSharedImage;
+
 /*
  * Prototypes for functions defined in this file:
  */
@@ -53,6 +76,10 @@ static int		EmbImageLayoutProc(TkText *textPtr,
 static void		EmbImageProc(void *clientData, int x, int y,
 			    int width, int height, int imageWidth,
 			    int imageHeight);
+static TkTextSharedImage *GetSharedImage(TkText *textPtr, const char *name);
+static void		AttachSharedImage(TkTextSegment *eiPtr,
+			    TkTextSharedImage *sharedImagePtr);
+static void		ReleaseSharedImage(TkTextSegment *eiPtr);
 
 /*
  * The following structure declares the "embedded image" segment type.
@@ -251,6 +278,9 @@ TkTextImageCmd(
 	eiPtr->body.ei.imageString = NULL;
 	eiPtr->body.ei.name = NULL;
 	eiPtr->body.ei.image = NULL;
+	eiPtr->body.ei.sharedImagePtr = NULL;
+	eiPtr->body.ei.nextUsePtr = NULL;
+	eiPtr->body.ei.prevUsePtr = NULL;
 	eiPtr->body.ei.align = TK_ALIGN_CENTER;
 	eiPtr->body.ei.padX = eiPtr->body.ei.padY = 0;
 	eiPtr->body.ei.chunkCount = 0;
@@ -331,7 +361,6 @@ EmbImageConfigure(
     Tcl_Obj *const objv[])	/* Array of strings describing configuration
 				 * options. */
 {
-    Tk_Image image;
     Tcl_DString newName;
     Tcl_HashEntry *hPtr;
     char *name;
@@ -344,25 +373,26 @@ EmbImageConfigure(
     }
 
     /*
-     * Create the image. Save the old image around and don't free it until
-     * after the new one is allocated. This keeps the reference count from
-     * going to zero so the image doesn't have to be recreated if it hasn't
-     * changed.
+     * Attach the segment to the shared instance for the image, creating the
+     * instance if this is the first occurrence.  The old attachment, if any,
+     * is only released after the new one is in place, so an unchanged image
+     * doesn't have its instance torn down and recreated.
      */
 
     if (eiPtr->body.ei.imageString != NULL) {
-	image = Tk_GetImage(textPtr->interp, textPtr->tkwin,
-		eiPtr->body.ei.imageString, EmbImageProc, eiPtr);
-	if (image == NULL) {
+	TkTextSharedImage *sharedImagePtr =
+		GetSharedImage(textPtr, eiPtr->body.ei.imageString);
+
+	if (sharedImagePtr == NULL) {
 	    return TCL_ERROR;
 	}
+	if (sharedImagePtr != eiPtr->body.ei.sharedImagePtr) {
+	    ReleaseSharedImage(eiPtr);
+	    AttachSharedImage(eiPtr, sharedImagePtr);
+	}
     } else {
-	image = NULL;
+	ReleaseSharedImage(eiPtr);
     }
-    if (eiPtr->body.ei.image != NULL) {
-	Tk_FreeImage(eiPtr->body.ei.image);
-    }
-    eiPtr->body.ei.image = image;
 
     if (eiPtr->body.ei.name != NULL) {
     	return TCL_OK;
@@ -449,7 +479,7 @@ EmbImageDeleteProc(
 
 	    Tcl_DeleteHashEntry(hPtr);
 	}
-	Tk_FreeImage(eiPtr->body.ei.image);
+	ReleaseSharedImage(eiPtr);
     }
 
     /*
@@ -812,7 +842,7 @@ TkTextImageIndex(
 
 static void
 EmbImageProc(
-    void *clientData,	/* Pointer to widget record. */
+    void *clientData,	/* Pointer to shared image record. */
     TCL_UNUSED(int),		/* Upper left pixel (within image) that must
 				 * be redisplayed. */
     TCL_UNUSED(int),
@@ -823,24 +853,167 @@ EmbImageProc(
     TCL_UNUSED(int))
 
 {
-    TkTextSegment *eiPtr = (TkTextSegment *)clientData;
+    TkTextSharedImage *sharedImagePtr = (TkTextSharedImage *)clientData;
+    TkTextSegment *eiPtr;
     TkTextIndex index;
 
-    index.tree = eiPtr->body.ei.sharedTextPtr->tree;
-    index.linePtr = eiPtr->body.ei.linePtr;
-    index.byteIndex = TkTextSegToOffset(eiPtr, eiPtr->body.ei.linePtr);
-    TkTextChanged(eiPtr->body.ei.sharedTextPtr, NULL, &index, &index);
-
     /*
-     * It's probably not true that all image changes can change the line
-     * height, so we could be more efficient here and only call this when
-     * necessary.
+     * One notification arrives per distinct image; invalidate every
+     * occurrence.
      */
 
-    TkTextInvalidateLineMetrics(eiPtr->body.ei.sharedTextPtr, NULL,
-	    index.linePtr, 0, TK_TEXT_INVALIDATE_ONLY);
+    for (eiPtr = sharedImagePtr->usePtr; eiPtr != NULL;
+	    eiPtr = eiPtr->body.ei.nextUsePtr) {
+	index.tree = eiPtr->body.ei.sharedTextPtr->tree;
+	index.linePtr = eiPtr->body.ei.linePtr;
+	index.byteIndex = TkTextSegToOffset(eiPtr, eiPtr->body.ei.linePtr);
+	TkTextChanged(eiPtr->body.ei.sharedTextPtr, NULL, &index, &index);
+
+	/*
+	 * It's probably not true that all image changes can change the line
+	 * height, so we could be more efficient here and only call this when
+	 * necessary.
+	 */
+
+	TkTextInvalidateLineMetrics(eiPtr->body.ei.sharedTextPtr, NULL,
+		index.linePtr, 0, TK_TEXT_INVALIDATE_ONLY);
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * GetSharedImage --
+ *
+ *	Find or create the shared instance record for the named image.
+ *
+ * Results:
+ *	Returns the record, or NULL (with an error in the interp's result)
+ *	if the image could not be created.  The reference count is not
+ *	changed; callers attach segments with AttachSharedImage.
+ *
+ * Side effects:
+ *	A new image instance may be created.
+ *
+ *--------------------------------------------------------------
+ */
+
+static TkTextSharedImage *
+GetSharedImage(
+    TkText *textPtr,		/* Widget in whose window the image will be
+				 * displayed. */
+    const char *name)		/* Name of the image, as given to -image. */
+{
+    TkTextSharedImage *sharedImagePtr;
+    Tcl_HashEntry *hPtr;
+    int isNew;
+
+    hPtr = Tcl_CreateHashEntry(&textPtr->sharedTextPtr->imageInstanceTable,
+	    name, &isNew);
+    if (!isNew) {
+	return (TkTextSharedImage *)Tcl_GetHashValue(hPtr);
+    }
+
+    sharedImagePtr = (TkTextSharedImage *)ckalloc(sizeof(TkTextSharedImage));
+    sharedImagePtr->sharedTextPtr = textPtr->sharedTextPtr;
+    sharedImagePtr->hPtr = hPtr;
+    sharedImagePtr->usePtr = NULL;
+    sharedImagePtr->refCount = 0;
+    sharedImagePtr->image = Tk_GetImage(textPtr->interp, textPtr->tkwin,
+	    name, EmbImageProc, sharedImagePtr);
+    if (sharedImagePtr->image == NULL) {
+	Tcl_DeleteHashEntry(hPtr);
+	ckfree(sharedImagePtr);
+	return NULL;
+    }
+    Tcl_SetHashValue(hPtr, sharedImagePtr);
+    return sharedImagePtr;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * AttachSharedImage --
+ *
+ *	Make an embedded image segment use a shared instance record.  The
+ *	segment must not currently be attached to any record.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The segment is added to the record's use list and its image field is
+ *	pointed at the shared instance.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+AttachSharedImage(
+    TkTextSegment *eiPtr,	/* Embedded image segment. */
+    TkTextSharedImage *sharedImagePtr)
+				/* Record to attach it to. */
+{
+    eiPtr->body.ei.sharedImagePtr = sharedImagePtr;
+    eiPtr->body.ei.image = sharedImagePtr->image;
+    eiPtr->body.ei.prevUsePtr = NULL;
+    eiPtr->body.ei.nextUsePtr = sharedImagePtr->usePtr;
+    if (sharedImagePtr->usePtr != NULL) {
+	sharedImagePtr->usePtr->body.ei.prevUsePtr = eiPtr;
+    }
+    sharedImagePtr->usePtr = eiPtr;
+    sharedImagePtr->refCount++;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * ReleaseSharedImage --
+ *
+ *	Detach an embedded image segment from its shared instance record, if
+ *	any.  When the last segment detaches, the instance and the record
+ *	are freed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	See above.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+ReleaseSharedImage(
+    TkTextSegment *eiPtr)	/* Embedded image segment. */
+{
+    TkTextSharedImage *sharedImagePtr = eiPtr->body.ei.sharedImagePtr;
+
+    if (sharedImagePtr == NULL) {
+	return;
+    }
+    if (eiPtr->body.ei.prevUsePtr != NULL) {
+	eiPtr->body.ei.prevUsePtr->body.ei.nextUsePtr =
+		eiPtr->body.ei.nextUsePtr;
+    } else {
+	sharedImagePtr->usePtr = eiPtr->body.ei.nextUsePtr;
+    }
+    if (eiPtr->body.ei.nextUsePtr != NULL) {
+	eiPtr->body.ei.nextUsePtr->body.ei.prevUsePtr =
+		eiPtr->body.ei.prevUsePtr;
+    }
+    eiPtr->body.ei.sharedImagePtr = NULL;
+    eiPtr->body.ei.image = NULL;
+    eiPtr->body.ei.nextUsePtr = NULL;
+    eiPtr->body.ei.prevUsePtr = NULL;
+
+    if (--sharedImagePtr->refCount <= 0) {
+	Tk_FreeImage(sharedImagePtr->image);
+	Tcl_DeleteHashEntry(sharedImagePtr->hPtr);
+	ckfree(sharedImagePtr);
+    }
+}
+
 /*
  * Local Variables:
  * mode: c
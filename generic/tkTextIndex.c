@@ -33,10 +33,49 @@
 #define TKINDEX_DISPLAY	1
 #define TKINDEX_ANY	2
 
+/*
+ * Cache of the most recently resolved segment positions. Converting a
+ * (line, byte index) pair into a segment requires walking the line's segment
+ * chain from the start, and commands that take many indices (tag ranges,
+ * dump, peer sync) tend to resolve positions on the same few lines over and
+ * over. Each entry remembers where a previous walk on a line ended so a
+ * later walk can resume there instead of starting from the first segment.
+ * Entries are validated against the B-tree's modification epoch, which is
+ * bumped by every operation that changes a segment chain. The cache is kept
+ * in thread-specific data because text widgets are confined to the thread
+ * that created them.
+ */
+
+#define INDEX_CACHE_SIZE 8
+
+typedef struct IndexCacheEntry {
+    TkTextBTree tree;		/* Tree this entry refers to. Compared, never
+				 * dereferenced. */
+    TkTextLine *linePtr;	/* Line within that tree. */
+    Tcl_Size epoch;		/* Value of the tree's modification epoch when
+				 * the entry was stored. */
+    Tcl_Size byteOffset;	/* Byte offset of segPtr from the start of the
+				 * line. */
+    TkTextSegment *segPtr;	/* Segment starting at byteOffset. */
+} IndexCacheEntry;
+
+typedef struct ThreadSpecificData {
+    IndexCacheEntry cache[INDEX_CACHE_SIZE];
+    int nextEntry;		/* Round-robin replacement index. */
+} ThreadSpecificData;
+static Tcl_ThreadDataKey dataKey;
+
 /*
  * Forward declarations for functions defined later in this file:
  */
 
+static TkTextSegment *	IndexCacheStart(TkTextBTree tree,
+			    TkTextLine *linePtr, Tcl_Size byteIndex,
+			    Tcl_Size *startPtr);
+static void		IndexCacheStore(TkTextBTree tree,
+			    TkTextLine *linePtr, Tcl_Size byteOffset,
+			    TkTextSegment *segPtr);
+
 static const char *	ForwBack(TkText *textPtr, const char *string,
 			    TkTextIndex *indexPtr);
 static const char *	StartEnd(TkText *textPtr, const char *string,
@@ -360,6 +399,116 @@ TkTextMakePixelIndex(
     return TkTextMeasureDown(textPtr, indexPtr, pixelOffset);
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * IndexCacheStart, IndexCacheStore, TkTextIndexCacheClear --
+ *
+ *	Maintenance of the segment position cache described above.
+ *	IndexCacheStart returns the segment from which a walk towards
+ *	byteIndex on the given line should start, along with that segment's
+ *	byte offset within the line: either a cached position at or before
+ *	byteIndex, or the first segment of the line. IndexCacheStore records
+ *	where a walk ended. TkTextIndexCacheClear drops all entries for a
+ *	tree that is about to be destroyed, so a later tree allocated at the
+ *	same address cannot produce a false match.
+ *
+ * Results:
+ *	See above.
+ *
+ * Side effects:
+ *	None, beyond updating the thread's cache.
+ *
+ *---------------------------------------------------------------------------
+ */
+
+static TkTextSegment *
+IndexCacheStart(
+    TkTextBTree tree,		/* Tree containing the line. */
+    TkTextLine *linePtr,	/* Line about to be walked. */
+    Tcl_Size byteIndex,		/* Target byte index within the line. */
+    Tcl_Size *startPtr)		/* Where to store the byte offset of the
+				 * returned segment. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    Tcl_Size epoch = TkBTreeEpoch(tree);
+    IndexCacheEntry *bestPtr = NULL;
+    int i;
+
+    for (i = 0; i < INDEX_CACHE_SIZE; i++) {
+	IndexCacheEntry *entryPtr = &tsdPtr->cache[i];
+
+	if ((entryPtr->tree == tree) && (entryPtr->linePtr == linePtr)
+		&& (entryPtr->epoch == epoch)
+		&& (entryPtr->byteOffset <= byteIndex)
+		&& ((bestPtr == NULL)
+		    || (entryPtr->byteOffset > bestPtr->byteOffset))) {
+	    bestPtr = entryPtr;
+	}
+    }
+    if (bestPtr != NULL) {
+	*startPtr = bestPtr->byteOffset;
+	return bestPtr->segPtr;
+    }
+    *startPtr = 0;
+    return linePtr->segPtr;
+}
+
+static void
+IndexCacheStore(
+    TkTextBTree tree,		/* Tree containing the line. */
+    TkTextLine *linePtr,	/* Line that was walked. */
+    Tcl_Size byteOffset,	/* Byte offset of segPtr within the line. */
+    TkTextSegment *segPtr)	/* Segment where the walk ended. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    Tcl_Size epoch = TkBTreeEpoch(tree);
+    IndexCacheEntry *entryPtr;
+    int i;
+
+    /*
+     * Overwrite an existing entry for the same line if there is one, so the
+     * cache does not fill up with stale positions of a single line.
+     */
+
+    entryPtr = NULL;
+    for (i = 0; i < INDEX_CACHE_SIZE; i++) {
+	if ((tsdPtr->cache[i].tree == tree)
+		&& (tsdPtr->cache[i].linePtr == linePtr)) {
+	    entryPtr = &tsdPtr->cache[i];
+	    break;
+	}
+    }
+    if (entryPtr == NULL) {
+	entryPtr = &tsdPtr->cache[tsdPtr->nextEntry];
+	tsdPtr->nextEntry = (tsdPtr->nextEntry + 1) % INDEX_CACHE_SIZE;
+    }
+    entryPtr->tree = tree;
+    entryPtr->linePtr = linePtr;
+    entryPtr->epoch = epoch;
+    entryPtr->byteOffset = byteOffset;
+    entryPtr->segPtr = segPtr;
+}
+
+void
+TkTextIndexCacheClear(
+    TkTextBTree tree)		/* Tree about to be destroyed. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    int i;
+
+    for (i = 0; i < INDEX_CACHE_SIZE; i++) {
+	if (tsdPtr->cache[i].tree == tree) {
+	    tsdPtr->cache[i].tree = NULL;
+	    tsdPtr->cache[i].linePtr = NULL;
+	    tsdPtr->cache[i].segPtr = NULL;
+	}
+    }
+}
+
 /*
  *---------------------------------------------------------------------------
  *
@@ -419,8 +568,13 @@ TkTextMakeByteIndex(
      * valid character boundary.
      */
 
-    index = 0;
-    for (segPtr = indexPtr->linePtr->segPtr; ; segPtr = segPtr->nextPtr) {
+    {
+	Tcl_Size start;
+
+	segPtr = IndexCacheStart(tree, indexPtr->linePtr, byteIndex, &start);
+	index = (int)start;
+    }
+    for ( ; ; segPtr = segPtr->nextPtr) {
 	if (segPtr == NULL) {
 	    /*
 	     * Use the index of the last character in the line. Since the last
@@ -432,6 +586,7 @@ TkTextMakeByteIndex(
 	    break;
 	}
 	if (index + (int)segPtr->size > byteIndex) {
+	    IndexCacheStore(tree, indexPtr->linePtr, index, segPtr);
 	    indexPtr->byteIndex = byteIndex;
 	    if ((byteIndex > index) && (segPtr->typePtr == &tkTextCharType)) {
 		/*
@@ -575,13 +730,16 @@ TkTextIndexToSeg(
 				 * NULL if offset isn't wanted. */
 {
     TkTextSegment *segPtr;
-    Tcl_Size offset;
+    Tcl_Size offset, start;
 
-    for (offset = indexPtr->byteIndex, segPtr = indexPtr->linePtr->segPtr;
-	    offset >= segPtr->size;
+    segPtr = IndexCacheStart(indexPtr->tree, indexPtr->linePtr,
+	    indexPtr->byteIndex, &start);
+    for (offset = indexPtr->byteIndex - start; offset >= segPtr->size;
 	    offset -= segPtr->size, segPtr = segPtr->nextPtr) {
 	/* Empty loop body. */
     }
+    IndexCacheStore(indexPtr->tree, indexPtr->linePtr,
+	    indexPtr->byteIndex - offset, segPtr);
     if (offsetPtr != NULL) {
 	*offsetPtr = offset;
     }
@@ -22,6 +22,38 @@
 #define MSEG_SIZE (offsetof(TkTextSegment, body) \
 	+ sizeof(TkTextMark))
 
+/*
+ * All mark segments in the shared B-tree (including the "insert" and
+ * "current" marks of every peer) are kept in a skip list ordered by document
+ * position, so that "mark next" and "mark previous" can locate their result
+ * in a logarithmic number of steps instead of scanning every line between
+ * the starting index and the nearest mark.  Ordinary editing moves mark
+ * segments around but never changes their relative order, so the list only
+ * needs maintenance when a mark is linked into or unlinked from the tree;
+ * positions are compared lazily through the B-tree whenever the list is
+ * searched.
+ */
+
+#define MARK_INDEX_MAX_LEVEL 16	/* Ample headroom: level i is populated with
+				 * probability 2^-i per mark. */
+
+typedef struct MarkIndexNode {
+    TkTextSegment *markPtr;	/* Mark segment this node stands for. */
+    struct MarkIndexNode *nextPtr[1];
+				/* Forward pointers; the node is actually
+				 * allocated with one pointer per level. */
+} MarkIndexNode;
+
+typedef struct TkTextMarkIndex {
+    int level;			/* Highest level currently in use. */
+    unsigned int randomSeed;	/* State for the level generator. */
+    MarkIndexNode *headPtr;	/* Dummy header node carrying
+				 * MARK_INDEX_MAX_LEVEL forward pointers. */
+} TkTextMarkIndex;
+
+#define MINDEX_NODE_SIZE(level) (offsetof(MarkIndexNode, nextPtr) \
+	+ ((level) + 1) * sizeof(MarkIndexNode *))
+
 /*
  * Forward references for functions defined in this file:
  */
@@ -43,6 +75,19 @@ static int		MarkFindNext(Tcl_Interp *interp,
 			    TkText *textPtr, Tcl_Obj *markName);
 static int		MarkFindPrev(Tcl_Interp *interp,
 			    TkText *textPtr, Tcl_Obj *markName);
+static int		CompareMarks(TkTextSegment *markPtr,
+			    TkTextSegment *mark2Ptr);
+static int		MarkPrecedesIndex(TkTextSegment *markPtr,
+			    const TkTextIndex *indexPtr);
+static MarkIndexNode *	MarkIndexFindNode(TkTextMarkIndex *idxPtr,
+			    TkTextSegment *markPtr);
+static MarkIndexNode *	MarkIndexSuccessor(TkTextMarkIndex *idxPtr,
+			    TkTextSegment *markPtr);
+static MarkIndexNode *	MarkIndexPredecessor(TkTextMarkIndex *idxPtr,
+			    TkTextSegment *markPtr);
+static MarkIndexNode *	MarkIndexFirstAtIndex(TkTextMarkIndex *idxPtr,
+			    const TkTextIndex *indexPtr,
+			    MarkIndexNode **prevNodePtrPtr);
 
 
 /*
@@ -174,9 +219,11 @@ TkTextMarkCmd(
 	    return TCL_ERROR;
 	}
 	TkTextMarkSegToIndex(textPtr, markPtr, &index);
+	TkTextMarkIndexRemove(textPtr->sharedTextPtr, markPtr);
 	TkBTreeUnlinkSegment(markPtr, markPtr->body.mark.linePtr);
 	markPtr->typePtr = newTypePtr;
 	TkBTreeLinkSegment(markPtr, &index);
+	TkTextMarkIndexAdd(textPtr->sharedTextPtr, markPtr);
 	break;
     }
     case MARK_NAMES: {
@@ -239,6 +286,7 @@ TkTextMarkCmd(
 			|| (markPtr == textPtr->currentMarkPtr)) {
 		    continue;
 		}
+		TkTextMarkIndexRemove(textPtr->sharedTextPtr, markPtr);
 		TkBTreeUnlinkSegment(markPtr, markPtr->body.mark.linePtr);
 		Tcl_DeleteHashEntry(hPtr);
 		ckfree(markPtr);
@@ -328,6 +376,7 @@ TkTextSetMark(
 		indexPtr = &insertIndex;
 	    }
 	}
+	TkTextMarkIndexRemove(textPtr->sharedTextPtr, markPtr);
 	TkBTreeUnlinkSegment(markPtr, markPtr->body.mark.linePtr);
     } else {
 	markPtr = (TkTextSegment *)ckalloc(MSEG_SIZE);
@@ -345,6 +394,7 @@ TkTextSetMark(
 	}
     }
     TkBTreeLinkSegment(markPtr, indexPtr);
+    TkTextMarkIndexAdd(textPtr->sharedTextPtr, markPtr);
 
     /*
      * If the mark is the insertion cursor, then update the screen at the
@@ -468,6 +518,366 @@ TkTextMarkNameToIndex(
     return TCL_OK;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * CompareMarks --
+ *
+ *	Compare the document positions of two mark segments, which must both
+ *	be linked into the B-tree.  Marks on different lines are ordered by
+ *	line number; marks on the same line by their order in the line's
+ *	segment chain, so the ordering is total (zero is only returned for
+ *	the identical segment).
+ *
+ * Results:
+ *	Returns -1, 0 or 1 if markPtr is before, identical to or after
+ *	mark2Ptr.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+CompareMarks(
+    TkTextSegment *markPtr,	/* First mark. */
+    TkTextSegment *mark2Ptr)	/* Second mark. */
+{
+    TkTextSegment *segPtr;
+    int line, line2;
+
+    if (markPtr == mark2Ptr) {
+	return 0;
+    }
+    if (markPtr->body.mark.linePtr == mark2Ptr->body.mark.linePtr) {
+	for (segPtr = markPtr->body.mark.linePtr->segPtr; segPtr != NULL;
+		segPtr = segPtr->nextPtr) {
+	    if (segPtr == markPtr) {
+		return -1;
+	    }
+	    if (segPtr == mark2Ptr) {
+		return 1;
+	    }
+	}
+	Tcl_Panic("CompareMarks: marks not on the line they point to");
+    }
+    line = TkBTreeLinesTo(NULL, markPtr->body.mark.linePtr);
+    line2 = TkBTreeLinesTo(NULL, mark2Ptr->body.mark.linePtr);
+    return (line < line2) ? -1 : 1;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * MarkPrecedesIndex --
+ *
+ *	Determine whether a mark segment lies strictly before the position
+ *	given by an index.  A mark sitting exactly at the index does not
+ *	precede it.
+ *
+ * Results:
+ *	Returns 1 if the mark is strictly before the index, 0 otherwise.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+MarkPrecedesIndex(
+    TkTextSegment *markPtr,	/* Mark to locate. */
+    const TkTextIndex *indexPtr)/* Position to compare against. */
+{
+    TkTextSegment *segPtr;
+    Tcl_Size offset;
+    int line, line2;
+
+    if (markPtr->body.mark.linePtr != indexPtr->linePtr) {
+	line = TkBTreeLinesTo(NULL, markPtr->body.mark.linePtr);
+	line2 = TkBTreeLinesTo(NULL, indexPtr->linePtr);
+	return line < line2;
+    }
+    offset = 0;
+    for (segPtr = indexPtr->linePtr->segPtr; segPtr != markPtr;
+	    segPtr = segPtr->nextPtr) {
+	offset += segPtr->size;
+    }
+    return offset < indexPtr->byteIndex;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkTextMarkIndexAdd --
+ *
+ *	Enter a mark segment into the position index.  The segment must
+ *	already be linked into the B-tree, since its position is found by
+ *	comparing it against the marks already indexed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	A node is added to the skip list; the list itself is created if this
+ *	is the first mark.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkTextMarkIndexAdd(
+    TkSharedText *sharedTextPtr,/* Shared widget section. */
+    TkTextSegment *markPtr)	/* Newly linked mark segment. */
+{
+    TkTextMarkIndex *idxPtr = sharedTextPtr->markIndexPtr;
+    MarkIndexNode *update[MARK_INDEX_MAX_LEVEL];
+    MarkIndexNode *nodePtr;
+    int i, level;
+
+    if (idxPtr == NULL) {
+	idxPtr = (TkTextMarkIndex *)ckalloc(sizeof(TkTextMarkIndex));
+	idxPtr->level = 0;
+	idxPtr->randomSeed = 1;
+	idxPtr->headPtr = (MarkIndexNode *)ckalloc(
+		MINDEX_NODE_SIZE(MARK_INDEX_MAX_LEVEL - 1));
+	idxPtr->headPtr->markPtr = NULL;
+	for (i = 0; i < MARK_INDEX_MAX_LEVEL; i++) {
+	    idxPtr->headPtr->nextPtr[i] = NULL;
+	}
+	sharedTextPtr->markIndexPtr = idxPtr;
+    }
+
+    nodePtr = idxPtr->headPtr;
+    for (i = idxPtr->level; i >= 0; i--) {
+	while (nodePtr->nextPtr[i] != NULL
+		&& CompareMarks(nodePtr->nextPtr[i]->markPtr, markPtr) < 0) {
+	    nodePtr = nodePtr->nextPtr[i];
+	}
+	update[i] = nodePtr;
+    }
+
+    /*
+     * Pick the node's level: flip coins, so level i carries about 2^-i of
+     * the marks.
+     */
+
+    level = 0;
+    while (level < MARK_INDEX_MAX_LEVEL - 1) {
+	idxPtr->randomSeed = idxPtr->randomSeed*1103515245 + 12345;
+	if (idxPtr->randomSeed & 0x10000) {
+	    break;
+	}
+	level++;
+    }
+    while (idxPtr->level < level) {
+	update[++idxPtr->level] = idxPtr->headPtr;
+    }
+
+    nodePtr = (MarkIndexNode *)ckalloc(MINDEX_NODE_SIZE(level));
+    nodePtr->markPtr = markPtr;
+    for (i = 0; i <= level; i++) {
+	nodePtr->nextPtr[i] = update[i]->nextPtr[i];
+	update[i]->nextPtr[i] = nodePtr;
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkTextMarkIndexRemove --
+ *
+ *	Remove a mark segment from the position index.  Must be called while
+ *	the segment is still linked into the B-tree (i.e. before
+ *	TkBTreeUnlinkSegment), since the search compares positions.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The mark's node, if present, is unlinked and freed.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkTextMarkIndexRemove(
+    TkSharedText *sharedTextPtr,/* Shared widget section. */
+    TkTextSegment *markPtr)	/* Mark segment about to be unlinked. */
+{
+    TkTextMarkIndex *idxPtr = sharedTextPtr->markIndexPtr;
+    MarkIndexNode *update[MARK_INDEX_MAX_LEVEL];
+    MarkIndexNode *nodePtr;
+    int i;
+
+    if (idxPtr == NULL) {
+	return;
+    }
+    nodePtr = idxPtr->headPtr;
+    for (i = idxPtr->level; i >= 0; i--) {
+	while (nodePtr->nextPtr[i] != NULL
+		&& CompareMarks(nodePtr->nextPtr[i]->markPtr, markPtr) < 0) {
+	    nodePtr = nodePtr->nextPtr[i];
+	}
+	update[i] = nodePtr;
+    }
+    nodePtr = update[0]->nextPtr[0];
+    if (nodePtr == NULL || nodePtr->markPtr != markPtr) {
+	return;
+    }
+    for (i = 0; i <= idxPtr->level; i++) {
+	if (update[i]->nextPtr[i] != nodePtr) {
+	    break;
+	}
+	update[i]->nextPtr[i] = nodePtr->nextPtr[i];
+    }
+    ckfree(nodePtr);
+    while (idxPtr->level > 0
+	    && idxPtr->headPtr->nextPtr[idxPtr->level] == NULL) {
+	idxPtr->level--;
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkTextFreeMarkIndex --
+ *
+ *	Release the position index of a shared text structure, if any.  The
+ *	mark segments themselves are not touched; they are freed separately
+ *	when the mark table is torn down.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory is freed and sharedTextPtr->markIndexPtr is reset to NULL.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkTextFreeMarkIndex(
+    TkSharedText *sharedTextPtr)/* Shared widget section being freed. */
+{
+    TkTextMarkIndex *idxPtr = sharedTextPtr->markIndexPtr;
+    MarkIndexNode *nodePtr, *nextPtr;
+
+    if (idxPtr == NULL) {
+	return;
+    }
+    for (nodePtr = idxPtr->headPtr->nextPtr[0]; nodePtr != NULL;
+	    nodePtr = nextPtr) {
+	nextPtr = nodePtr->nextPtr[0];
+	ckfree(nodePtr);
+    }
+    ckfree(idxPtr->headPtr);
+    ckfree(idxPtr);
+    sharedTextPtr->markIndexPtr = NULL;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * MarkIndexFindNode, MarkIndexSuccessor, MarkIndexPredecessor,
+ * MarkIndexFirstAtIndex --
+ *
+ *	Search primitives on the position index.  MarkIndexFindNode returns
+ *	the node standing for a given mark, or NULL.  MarkIndexSuccessor and
+ *	MarkIndexPredecessor return the node for the mark immediately after
+ *	or before the given mark in document order, or NULL.
+ *	MarkIndexFirstAtIndex returns the first node at or after the given
+ *	index position, or NULL; if prevNodePtrPtr is non-NULL it is set to
+ *	the last node strictly before the index, or NULL.
+ *
+ * Results:
+ *	See above.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static MarkIndexNode *
+MarkIndexFindNode(
+    TkTextMarkIndex *idxPtr,	/* Position index to search. */
+    TkTextSegment *markPtr)	/* Mark to find. */
+{
+    MarkIndexNode *nodePtr = idxPtr->headPtr;
+    int i;
+
+    for (i = idxPtr->level; i >= 0; i--) {
+	while (nodePtr->nextPtr[i] != NULL
+		&& CompareMarks(nodePtr->nextPtr[i]->markPtr, markPtr) < 0) {
+	    nodePtr = nodePtr->nextPtr[i];
+	}
+    }
+    nodePtr = nodePtr->nextPtr[0];
+    if (nodePtr != NULL && nodePtr->markPtr == markPtr) {
+	return nodePtr;
+    }
+    return NULL;
+}
+
+static MarkIndexNode *
+MarkIndexSuccessor(
+    TkTextMarkIndex *idxPtr,	/* Position index to search. */
+    TkTextSegment *markPtr)	/* Search after this mark. */
+{
+    MarkIndexNode *nodePtr = idxPtr->headPtr;
+    int i;
+
+    for (i = idxPtr->level; i >= 0; i--) {
+	while (nodePtr->nextPtr[i] != NULL
+		&& CompareMarks(nodePtr->nextPtr[i]->markPtr, markPtr) <= 0) {
+	    nodePtr = nodePtr->nextPtr[i];
+	}
+    }
+    return nodePtr->nextPtr[0];
+}
+
+static MarkIndexNode *
+MarkIndexPredecessor(
+    TkTextMarkIndex *idxPtr,	/* Position index to search. */
+    TkTextSegment *markPtr)	/* Search before this mark. */
+{
+    MarkIndexNode *nodePtr = idxPtr->headPtr;
+    int i;
+
+    for (i = idxPtr->level; i >= 0; i--) {
+	while (nodePtr->nextPtr[i] != NULL
+		&& CompareMarks(nodePtr->nextPtr[i]->markPtr, markPtr) < 0) {
+	    nodePtr = nodePtr->nextPtr[i];
+	}
+    }
+    return (nodePtr == idxPtr->headPtr) ? NULL : nodePtr;
+}
+
+static MarkIndexNode *
+MarkIndexFirstAtIndex(
+    TkTextMarkIndex *idxPtr,	/* Position index to search. */
+    const TkTextIndex *indexPtr,/* Position to search for. */
+    MarkIndexNode **prevNodePtrPtr)
+				/* If non-NULL, filled in with the last node
+				 * strictly before the index, or NULL. */
+{
+    MarkIndexNode *nodePtr = idxPtr->headPtr;
+    int i;
+
+    for (i = idxPtr->level; i >= 0; i--) {
+	while (nodePtr->nextPtr[i] != NULL
+		&& MarkPrecedesIndex(nodePtr->nextPtr[i]->markPtr, indexPtr)) {
+	    nodePtr = nodePtr->nextPtr[i];
+	}
+    }
+    if (prevNodePtrPtr != NULL) {
+	*prevNodePtrPtr = (nodePtr == idxPtr->headPtr) ? NULL : nodePtr;
+    }
+    return nodePtr->nextPtr[0];
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -739,11 +1149,23 @@ MarkCheckProc(
 {
     Tcl_HashSearch search;
     Tcl_HashEntry *hPtr;
+    TkSharedText *sharedTextPtr;
 
     if (markPtr->body.mark.linePtr != linePtr) {
 	Tcl_Panic("MarkCheckProc: markPtr->body.mark.linePtr bogus");
     }
 
+    /*
+     * Every mark must be present in the position index.
+     */
+
+    sharedTextPtr = markPtr->body.mark.textPtr->sharedTextPtr;
+    if ((sharedTextPtr->markIndexPtr == NULL)
+	    || (MarkIndexFindNode(sharedTextPtr->markIndexPtr,
+		    markPtr) == NULL)) {
+	Tcl_Panic("MarkCheckProc: mark is missing from the position index");
+    }
+
     /*
      * These two marks are not in the hash table
      */
@@ -794,70 +1216,62 @@ MarkFindNext(
     TkTextIndex index;
     Tcl_HashEntry *hPtr;
     TkTextSegment *segPtr;
-    int offset;
+    TkTextMarkIndex *idxPtr = textPtr->sharedTextPtr->markIndexPtr;
+    MarkIndexNode *nodePtr;
     const char *string = Tcl_GetString(obj);
 
     if (!strcmp(string, "insert")) {
 	segPtr = textPtr->insertMarkPtr;
-	TkTextMarkSegToIndex(textPtr, segPtr, &index);
-	segPtr = segPtr->nextPtr;
     } else if (!strcmp(string, "current")) {
 	segPtr = textPtr->currentMarkPtr;
-	TkTextMarkSegToIndex(textPtr, segPtr, &index);
-	segPtr = segPtr->nextPtr;
     } else {
 	hPtr = Tcl_FindHashEntry(&textPtr->sharedTextPtr->markTable, string);
 	if (hPtr != NULL) {
-	    /*
-	     * If given a mark name, return the next mark in the list of
-	     * segments, even if it happens to be at the same character
-	     * position.
-	     */
-
 	    segPtr = (TkTextSegment *)Tcl_GetHashValue(hPtr);
-	    TkTextMarkSegToIndex(textPtr, segPtr, &index);
-	    segPtr = segPtr->nextPtr;
 	} else {
-	    /*
-	     * For non-mark name indices we want to return any marks that are
-	     * right at the index.
-	     */
-
+	    segPtr = NULL;
 	    if (TkTextGetObjIndex(interp, textPtr, obj, &index) != TCL_OK) {
 		return TCL_ERROR;
 	    }
-	    for (offset = 0, segPtr = index.linePtr->segPtr;
-		    segPtr != NULL && offset < index.byteIndex;
-		    offset += segPtr->size, segPtr = segPtr->nextPtr) {
-		/* Empty loop body */ ;
-	    }
 	}
     }
+    if (idxPtr == NULL) {
+	return TCL_OK;
+    }
+    if (segPtr != NULL) {
+	/*
+	 * If given a mark name, return the next mark in document order, even
+	 * if it happens to be at the same character position.
+	 */
 
-    while (1) {
+	nodePtr = MarkIndexSuccessor(idxPtr, segPtr);
+    } else {
 	/*
-	 * segPtr points at the first possible candidate, or NULL if we ran
-	 * off the end of the line.
+	 * For non-mark name indices we want to return any marks that are
+	 * right at the index.
 	 */
 
-	for ( ; segPtr != NULL ; segPtr = segPtr->nextPtr) {
-	    if (segPtr->typePtr == &tkTextRightMarkType ||
-		    segPtr->typePtr == &tkTextLeftMarkType) {
-		Tcl_Obj *markName = GetMarkName(textPtr, segPtr);
+	nodePtr = MarkIndexFirstAtIndex(idxPtr, &index, NULL);
+    }
+    for ( ; nodePtr != NULL; nodePtr = nodePtr->nextPtr[0]) {
+	Tcl_Obj *markName;
 
-		if (markName != NULL) {
-		    Tcl_SetObjResult(interp, markName);
-		    return TCL_OK;
-		}
-	    }
+	/*
+	 * Stop as soon as a candidate falls outside the -startline/-endline
+	 * range of this widget: all following marks do too.
+	 */
+
+	TkTextMarkSegToIndex(textPtr, nodePtr->markPtr, &index);
+	if (TkTextIndexAdjustToStartEnd(textPtr, &index, 1) == TCL_ERROR) {
+	    break;
 	}
-	index.linePtr = TkBTreeNextLine(textPtr, index.linePtr);
-	if (index.linePtr == NULL) {
-	    return TCL_OK;
+	markName = GetMarkName(textPtr, nodePtr->markPtr);
+	if (markName != NULL) {
+	    Tcl_SetObjResult(interp, markName);
+	    break;
 	}
-	index.byteIndex = 0;
-	segPtr = index.linePtr->segPtr;
     }
+    return TCL_OK;
 }
 
 /*
@@ -884,82 +1298,64 @@ MarkFindPrev(
 {
     TkTextIndex index;
     Tcl_HashEntry *hPtr;
-    TkTextSegment *segPtr, *seg2Ptr, *prevPtr;
-    int offset;
+    TkTextSegment *segPtr;
+    TkTextMarkIndex *idxPtr = textPtr->sharedTextPtr->markIndexPtr;
+    MarkIndexNode *nodePtr;
     const char *string = Tcl_GetString(obj);
 
     if (!strcmp(string, "insert")) {
 	segPtr = textPtr->insertMarkPtr;
-	TkTextMarkSegToIndex(textPtr, segPtr, &index);
     } else if (!strcmp(string, "current")) {
 	segPtr = textPtr->currentMarkPtr;
-	TkTextMarkSegToIndex(textPtr, segPtr, &index);
     } else {
 	hPtr = Tcl_FindHashEntry(&textPtr->sharedTextPtr->markTable, string);
 	if (hPtr != NULL) {
-	    /*
-	     * If given a mark name, return the previous mark in the list of
-	     * segments, even if it happens to be at the same character
-	     * position.
-	     */
-
 	    segPtr = (TkTextSegment *)Tcl_GetHashValue(hPtr);
-	    TkTextMarkSegToIndex(textPtr, segPtr, &index);
 	} else {
-	    /*
-	     * For non-mark name indices we do not return any marks that are
-	     * right at the index.
-	     */
-
+	    segPtr = NULL;
 	    if (TkTextGetObjIndex(interp, textPtr, obj, &index) != TCL_OK) {
 		return TCL_ERROR;
 	    }
-	    for (offset = 0, segPtr = index.linePtr->segPtr;
-		    segPtr != NULL && offset < index.byteIndex;
-		    offset += segPtr->size, segPtr = segPtr->nextPtr) {
-		/* Empty loop body */
-	    }
 	}
     }
+    if (idxPtr == NULL) {
+	return TCL_OK;
+    }
+    if (segPtr != NULL) {
+	/*
+	 * If given a mark name, return the previous mark in document order,
+	 * even if it happens to be at the same character position.
+	 */
 
-    while (1) {
+	nodePtr = MarkIndexPredecessor(idxPtr, segPtr);
+    } else {
 	/*
-	 * segPtr points just past the first possible candidate, or at the
-	 * beginning of the line.
+	 * For non-mark name indices we do not return any marks that are
+	 * right at the index.
 	 */
 
-	for (prevPtr = NULL, seg2Ptr = index.linePtr->segPtr;
-		seg2Ptr != NULL && seg2Ptr != segPtr;
-		seg2Ptr = seg2Ptr->nextPtr) {
-	    if (seg2Ptr->typePtr == &tkTextRightMarkType ||
-		    seg2Ptr->typePtr == &tkTextLeftMarkType) {
-	        if (seg2Ptr->body.mark.hPtr == NULL) {
-                    if (seg2Ptr != textPtr->currentMarkPtr &&
-                            seg2Ptr != textPtr->insertMarkPtr) {
-	                /*
-                         * This is an insert or current mark from a
-                         * peer of textPtr.
-                         */
-                        continue;
-                    }
-	        }
-		prevPtr = seg2Ptr;
-	    }
-	}
-	if (prevPtr != NULL) {
-	    Tcl_Obj *markName = GetMarkName(textPtr, prevPtr);
+	(void) MarkIndexFirstAtIndex(idxPtr, &index, &nodePtr);
+    }
+    while (nodePtr != NULL) {
+	Tcl_Obj *markName;
 
-	    if (markName != NULL) {
-		Tcl_SetObjResult(interp, markName);
-		return TCL_OK;
-	    }
+	/*
+	 * Stop as soon as a candidate falls outside the -startline/-endline
+	 * range of this widget: all preceding marks do too.
+	 */
+
+	TkTextMarkSegToIndex(textPtr, nodePtr->markPtr, &index);
+	if (TkTextIndexAdjustToStartEnd(textPtr, &index, 1) == TCL_ERROR) {
+	    break;
 	}
-	index.linePtr = TkBTreePreviousLine(textPtr, index.linePtr);
-	if (index.linePtr == NULL) {
-	    return TCL_OK;
+	markName = GetMarkName(textPtr, nodePtr->markPtr);
+	if (markName != NULL) {
+	    Tcl_SetObjResult(interp, markName);
+	    break;
 	}
-	segPtr = NULL;
+	nodePtr = MarkIndexPredecessor(idxPtr, nodePtr->markPtr);
     }
+    return TCL_OK;
 }
 
 /*
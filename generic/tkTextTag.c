@@ -332,7 +332,7 @@ TkTextTagCmd(
 	}
 	break;
     case TAG_CONFIGURE: {
-	int newTag;
+	int newTag, oldElide;
 
 	if (objc < 4) {
 	    Tcl_WrongNumArgs(interp, 3, objv,
@@ -340,6 +340,7 @@ TkTextTagCmd(
 	    return TCL_ERROR;
 	}
 	tagPtr = TkTextCreateTag(textPtr, Tcl_GetString(objv[3]), &newTag);
+	oldElide = tagPtr->elide;
 	if (objc <= 5) {
 	    Tcl_Obj *objPtr = Tk_GetOptionInfo(interp, tagPtr,
 		    tagPtr->optionTable,
@@ -392,11 +393,16 @@ TkTextTagCmd(
 		    return TCL_ERROR;
 		}
 	    }
-	    if (tagPtr->elide >= 0) {
+	    if ((oldElide >= 0) != (tagPtr->elide >= 0)) {
+		textPtr->sharedTextPtr->numElideTags +=
+			(tagPtr->elide >= 0) ? 1 : -1;
+	    }
+	    if ((tagPtr->elide >= 0) || (oldElide >= 0)) {
 		/*
 		 * Indices are potentially obsolete after changing -elide,
 		 * especially those computed with "display" or "any"
-		 * submodifier, therefore increase the epoch.
+		 * submodifier, therefore increase the epoch. The same
+		 * applies when -elide is removed from a tag.
 		 */
 
 		textPtr->sharedTextPtr->stateEpoch++;
@@ -973,6 +979,8 @@ TkTextCreateTag(
     tagPtr->underline = -1;
     tagPtr->underlineColor = NULL;
     tagPtr->elide = -1;
+    tagPtr->scanIndex = 0;
+    tagPtr->scanEpoch = 0;
     tagPtr->wrapMode = TEXT_WRAPMODE_NULL;
     tagPtr->affectsDisplay = 0;
     tagPtr->affectsDisplayGeometry = 0;
@@ -1132,6 +1140,11 @@ TkTextFreeTag(
      * Let Tk do most of the hard work for us.
      */
 
+    if (tagPtr->elide >= 0) {
+	textPtr->sharedTextPtr->numElideTags--;
+	textPtr->sharedTextPtr->stateEpoch++;
+    }
+
     Tk_FreeConfigOptions(tagPtr, tagPtr->optionTable,
 	    textPtr->tkwin);
 
@@ -1300,6 +1313,16 @@ ChangeTagPriority(
     if (prio == tagPtr->priority) {
 	return;
     }
+
+    /*
+     * Reordering tags can change which -elide value wins where elide
+     * tags overlap, so cached elide state keyed on the epoch must be
+     * rebuilt.
+     */
+
+    if (textPtr->sharedTextPtr->numElideTags > 0) {
+	textPtr->sharedTextPtr->stateEpoch++;
+    }
     if (prio < tagPtr->priority) {
 	low = prio;
 	high = tagPtr->priority-1;
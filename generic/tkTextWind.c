@@ -302,6 +302,8 @@ TkTextWindowCmd(
 	client->tkwin = NULL;
 	client->chunkCount = 0;
 	client->displayed = 0;
+	client->winX = client->winY = 0;
+	client->winWidth = client->winHeight = -1;
 	client->parent = ewPtr;
 	ewPtr->body.ew.clients = client;
 
@@ -467,10 +469,13 @@ EmbWinConfigure(
 		client->tkwin = NULL;
 		client->chunkCount = 0;
 		client->displayed = 0;
+		client->winX = client->winY = 0;
+		client->winWidth = client->winHeight = -1;
 		client->parent = ewPtr;
 		ewPtr->body.ew.clients = client;
 	    }
 	    client->tkwin = ewPtr->body.ew.tkwin;
+	    client->winWidth = -1;
 
 	    /*
 	     * Take over geometry management for the window, plus create an
@@ -958,6 +963,8 @@ EmbWinLayoutProc(
 	    client->tkwin = NULL;
 	    client->chunkCount = 0;
 	    client->displayed = 0;
+	    client->winX = client->winY = 0;
+	    client->winWidth = client->winHeight = -1;
 	    client->parent = ewPtr;
 	    ewPtr->body.ew.clients = client;
 	}
@@ -1105,15 +1112,22 @@ TkTextEmbWinDisplayProc(
 	return;
     }
 
-    if ((x + chunkPtr->width) <= 0) {
+    if (((x + chunkPtr->width) <= 0) || (x >= Tk_Width(textPtr->tkwin))) {
 	/*
-	 * The window is off-screen; just unmap it.
+	 * The window is entirely off-screen horizontally; just unmap it (it
+	 * will be placed and mapped again once it scrolls back into view).
+	 * Skip the unmap calls when the window was never placed, or has
+	 * already been taken down.
 	 */
 
-	if (textPtr->tkwin != Tk_Parent(tkwin)) {
-	    Tk_UnmaintainGeometry(tkwin, textPtr->tkwin);
-	} else {
-	    Tk_UnmapWindow(tkwin);
+	if (client->displayed || (client->winWidth >= 0)) {
+	    if (textPtr->tkwin != Tk_Parent(tkwin)) {
+		Tk_UnmaintainGeometry(tkwin, textPtr->tkwin);
+	    } else {
+		Tk_UnmapWindow(tkwin);
+	    }
+	    client->displayed = 0;
+	    client->winWidth = -1;
 	}
 	return;
     }
@@ -1137,6 +1151,24 @@ TkTextEmbWinDisplayProc(
 
     client->displayed = 1;
 
+    /*
+     * Skip the geometry calls entirely when the window is already placed
+     * where this pass wants it; with many embedded windows this is the
+     * common case on every redisplay that doesn't move them.
+     */
+
+    if ((client->winWidth >= 0) && (windowX == client->winX)
+	    && (windowY == client->winY) && (width == client->winWidth)
+	    && (height == client->winHeight)) {
+	if ((textPtr->tkwin != Tk_Parent(tkwin)) || Tk_IsMapped(tkwin)) {
+	    return;
+	}
+    }
+    client->winX = windowX;
+    client->winY = windowY;
+    client->winWidth = width;
+    client->winHeight = height;
+
     if (textPtr->tkwin == Tk_Parent(tkwin)) {
 	if ((windowX != Tk_X(tkwin)) || (windowY != Tk_Y(tkwin))
 		|| (Tk_ReqWidth(tkwin) != Tk_Width(tkwin))
@@ -1306,6 +1338,7 @@ EmbWinDelayedUnmap(
 	} else {
 	    Tk_UnmapWindow(client->tkwin);
 	}
+	client->winWidth = -1;
     }
 }
 
@@ -919,22 +919,47 @@ TkBezierScreenPoints(
     XPoint *xPointPtr)	/* Where to put new points. */
 {
     int i;
-    double u, u2, u3, t, t2, t3;
-
-    for (i = 1; i <= numSteps; i++, xPointPtr++) {
-	t = ((double) i)/((double) numSteps);
-	t2 = t*t;
-	t3 = t2*t;
-	u = 1.0 - t;
-	u2 = u*u;
-	u3 = u2*u;
-	Tk_CanvasDrawableCoords(canvas,
-		(control[0]*u3 + 3.0 * (control[2]*t*u2 + control[4]*t2*u)
-		    + control[6]*t3),
-		(control[1]*u3 + 3.0 * (control[3]*t*u2 + control[5]*t2*u)
-		    + control[7]*t3),
-		&xPointPtr->x, &xPointPtr->y);
+    double h, h2, h3;
+    double bx, cx, dx, by, cy, dy;
+    double x, y, dx1, dx2, dx3, dy1, dy2, dy3;
+
+    /*
+     * Instead of evaluating the full cubic polynomial at every step, convert
+     * the control points to power-basis coefficients once and walk the curve
+     * with forward differences: three additions per coordinate per point.
+     */
+
+    h = 1.0 / (double) numSteps;
+    h2 = h*h;
+    h3 = h2*h;
+    bx = 3.0*(control[2] - control[0]);
+    cx = 3.0*(control[0] - 2.0*control[2] + control[4]);
+    dx = control[6] - control[0] + 3.0*(control[2] - control[4]);
+    by = 3.0*(control[3] - control[1]);
+    cy = 3.0*(control[1] - 2.0*control[3] + control[5]);
+    dy = control[7] - control[1] + 3.0*(control[3] - control[5]);
+    x = control[0];
+    y = control[1];
+    dx1 = bx*h + cx*h2 + dx*h3;
+    dx2 = 2.0*cx*h2 + 6.0*dx*h3;
+    dx3 = 6.0*dx*h3;
+    dy1 = by*h + cy*h2 + dy*h3;
+    dy2 = 2.0*cy*h2 + 6.0*dy*h3;
+    dy3 = 6.0*dy*h3;
+
+    for (i = 1; i < numSteps; i++, xPointPtr++) {
+	x += dx1; dx1 += dx2; dx2 += dx3;
+	y += dy1; dy1 += dy2; dy2 += dy3;
+	Tk_CanvasDrawableCoords(canvas, x, y, &xPointPtr->x, &xPointPtr->y);
     }
+
+    /*
+     * Emit the final control point exactly, so accumulated rounding in the
+     * differences can never move the end of the curve.
+     */
+
+    Tk_CanvasDrawableCoords(canvas, control[6], control[7],
+	    &xPointPtr->x, &xPointPtr->y);
 }
 
 /*
@@ -965,20 +990,48 @@ TkBezierPoints(
     double *coordPtr)	/* Where to put new points. */
 {
     int i;
-    double u, u2, u3, t, t2, t3;
-
-    for (i = 1; i <= numSteps; i++, coordPtr += 2) {
-	t = ((double) i)/((double) numSteps);
-	t2 = t*t;
-	t3 = t2*t;
-	u = 1.0 - t;
-	u2 = u*u;
-	u3 = u2*u;
-	coordPtr[0] = control[0]*u3
-		+ 3.0 * (control[2]*t*u2 + control[4]*t2*u) + control[6]*t3;
-	coordPtr[1] = control[1]*u3
-		+ 3.0 * (control[3]*t*u2 + control[5]*t2*u) + control[7]*t3;
+    double h, h2, h3;
+    double bx, cx, dx, by, cy, dy;
+    double x, y, dx1, dx2, dx3, dy1, dy2, dy3;
+
+    /*
+     * Forward-difference evaluation; see TkBezierScreenPoints above for the
+     * derivation. This replaces the per-point polynomial evaluation with
+     * three additions per coordinate.
+     */
+
+    h = 1.0 / (double) numSteps;
+    h2 = h*h;
+    h3 = h2*h;
+    bx = 3.0*(control[2] - control[0]);
+    cx = 3.0*(control[0] - 2.0*control[2] + control[4]);
+    dx = control[6] - control[0] + 3.0*(control[2] - control[4]);
+    by = 3.0*(control[3] - control[1]);
+    cy = 3.0*(control[1] - 2.0*control[3] + control[5]);
+    dy = control[7] - control[1] + 3.0*(control[3] - control[5]);
+    x = control[0];
+    y = control[1];
+    dx1 = bx*h + cx*h2 + dx*h3;
+    dx2 = 2.0*cx*h2 + 6.0*dx*h3;
+    dx3 = 6.0*dx*h3;
+    dy1 = by*h + cy*h2 + dy*h3;
+    dy2 = 2.0*cy*h2 + 6.0*dy*h3;
+    dy3 = 6.0*dy*h3;
+
+    for (i = 1; i < numSteps; i++, coordPtr += 2) {
+	x += dx1; dx1 += dx2; dx2 += dx3;
+	y += dy1; dy1 += dy2; dy2 += dy3;
+	coordPtr[0] = x;
+	coordPtr[1] = y;
     }
+
+    /*
+     * Emit the final control point exactly, so accumulated rounding in the
+     * differences can never move the end of the curve.
+     */
+
+    coordPtr[0] = control[6];
+    coordPtr[1] = control[7];
 }
 
 /*
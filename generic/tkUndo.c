@@ -15,6 +15,8 @@
 
 static int		EvaluateActionList(Tcl_Interp *interp,
 			    TkUndoSubAtom *action);
+static size_t		UndoSubAtomListSize(TkUndoSubAtom *subAtomPtr);
+static void		UndoEnforceBudget(TkUndoRedoStack *stack);
 
 /*
  *----------------------------------------------------------------------
@@ -96,6 +98,7 @@ TkUndoInsertSeparator(
     if (*stack!=NULL && (*stack)->type!=TK_UNDO_SEPARATOR) {
 	separator = (TkUndoAtom *)ckalloc(sizeof(TkUndoAtom));
 	separator->type = TK_UNDO_SEPARATOR;
+	separator->size = sizeof(TkUndoAtom);
 	TkUndoPushStack(stack,separator);
 	return 1;
     }
@@ -179,15 +182,44 @@ TkUndoPushAction(
     TkUndoSubAtom *apply,
     TkUndoSubAtom *revert)
 {
-    TkUndoAtom *atom;
+    TkUndoAtom *atom = stack->undoStack;
+    size_t size = UndoSubAtomListSize(apply) + UndoSubAtomListSize(revert);
 
-    atom = (TkUndoAtom *)ckalloc(sizeof(TkUndoAtom));
-    atom->type = TK_UNDO_ACTION;
-    atom->apply = apply;
-    atom->revert = revert;
+    if ((atom != NULL) && (atom->type == TK_UNDO_ACTION)) {
+	/*
+	 * The top of the stack is an action belonging to the same compound
+	 * chunk (no separator has been pushed since), so coalesce the new
+	 * edit into it instead of growing the stack: the new apply steps run
+	 * after the existing ones, the new revert steps before. The replayed
+	 * sequence is identical to two separate atoms.
+	 */
 
-    TkUndoPushStack(&stack->undoStack, atom);
+	TkUndoSubAtom *subPtr = atom->apply;
+
+	while (subPtr->next != NULL) {
+	    subPtr = subPtr->next;
+	}
+	subPtr->next = apply;
+
+	subPtr = revert;
+	while (subPtr->next != NULL) {
+	    subPtr = subPtr->next;
+	}
+	subPtr->next = atom->revert;
+	atom->revert = revert;
+    } else {
+	atom = (TkUndoAtom *)ckalloc(sizeof(TkUndoAtom));
+	atom->type = TK_UNDO_ACTION;
+	atom->apply = apply;
+	atom->revert = revert;
+	atom->size = sizeof(TkUndoAtom);
+	stack->size += sizeof(TkUndoAtom);
+	TkUndoPushStack(&stack->undoStack, atom);
+    }
+    atom->size += size;
+    stack->size += size;
     TkUndoClearStack(&stack->redoStack);
+    UndoEnforceBudget(stack);
 }
 
 /*
@@ -347,6 +379,8 @@ TkUndoInitStack(
     stack->interp = interp;
     stack->maxdepth = maxdepth;
     stack->depth = 0;
+    stack->maxsize = 0;
+    stack->size = 0;
     return stack;
 }
 
@@ -396,6 +430,7 @@ TkUndoSetMaxDepth(
 	prevelem->next = NULL;
 	while (elem != NULL) {
 	    prevelem = elem;
+	    stack->size -= elem->size;
 	    if (elem->type != TK_UNDO_SEPARATOR) {
 		TkUndoSubAtom *sub = elem->apply;
 		while (sub != NULL) {
@@ -425,6 +460,164 @@ TkUndoSetMaxDepth(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkUndoSetMaxSize --
+ *
+ *	Set the approximate maximum number of bytes the undo stack may
+ *	retain, or 0 for no limit.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May evict the oldest compound chunks from the undo stack if they no
+ *	longer fit in the new budget.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkUndoSetMaxSize(
+    TkUndoRedoStack *stack,	/* An Undo/Redo stack */
+    size_t maxsize)		/* The maximum number of retained bytes */
+{
+    stack->maxsize = maxsize;
+    UndoEnforceBudget(stack);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * UndoSubAtomListSize --
+ *
+ *	Compute the approximate number of bytes retained by a list of
+ *	sub-atoms: the structures themselves plus the string lengths of the
+ *	action payloads. For list-valued actions the elements are measured
+ *	individually so that no string representation of the list as a whole
+ *	needs to be generated.
+ *
+ * Results:
+ *	The approximate size in bytes.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static size_t
+UndoSubAtomListSize(
+    TkUndoSubAtom *subAtomPtr)	/* Head of a list of sub-atoms. */
+{
+    size_t size = 0;
+
+    for ( ; subAtomPtr != NULL; subAtomPtr = subAtomPtr->next) {
+	Tcl_Obj **objv;
+	Tcl_Size objc, i;
+
+	size += sizeof(TkUndoSubAtom);
+	if (subAtomPtr->action == NULL) {
+	    continue;
+	}
+	if (Tcl_ListObjGetElements(NULL, subAtomPtr->action, &objv,
+		&objc) == TCL_OK) {
+	    for (i = 0; i < objc; i++) {
+		(void) Tcl_GetString(objv[i]);
+		size += objv[i]->length;
+	    }
+	} else {
+	    (void) Tcl_GetString(subAtomPtr->action);
+	    size += subAtomPtr->action->length;
+	}
+    }
+    return size;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * UndoEnforceBudget --
+ *
+ *	If the stack has a memory budget and the undo stack exceeds it, throw
+ *	away the oldest compound chunks until it fits again. The most recent
+ *	chunk is never evicted, so a single operation larger than the budget
+ *	still remains undoable.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory of evicted atoms is freed and the stack depth is reduced.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+UndoEnforceBudget(
+    TkUndoRedoStack *stack)	/* An Undo/Redo stack */
+{
+    if (stack->maxsize == 0) {
+	return;
+    }
+    while (stack->size > stack->maxsize) {
+	TkUndoAtom *elem, *prevPtr, *sepPtr, *sepPrevPtr;
+
+	/*
+	 * Find the last separator on the stack that still has atoms below
+	 * it; everything from there to the bottom is the oldest chunk.
+	 */
+
+	sepPtr = NULL;
+	sepPrevPtr = NULL;
+	prevPtr = NULL;
+	for (elem = stack->undoStack; elem != NULL;
+		prevPtr = elem, elem = elem->next) {
+	    if ((elem->type == TK_UNDO_SEPARATOR) && (elem->next != NULL)
+		    && (prevPtr != NULL)) {
+		sepPtr = elem;
+		sepPrevPtr = prevPtr;
+	    }
+	}
+	if (sepPtr == NULL) {
+	    return;
+	}
+	sepPrevPtr->next = NULL;
+	for (elem = sepPtr; elem != NULL; elem = sepPtr) {
+	    sepPtr = elem->next;
+	    stack->size -= elem->size;
+	    if (elem->type != TK_UNDO_SEPARATOR) {
+		TkUndoSubAtom *sub = elem->apply;
+
+		while (sub != NULL) {
+		    TkUndoSubAtom *next = sub->next;
+
+		    if (sub->action != NULL) {
+			Tcl_DecrRefCount(sub->action);
+		    }
+		    ckfree(sub);
+		    sub = next;
+		}
+		sub = elem->revert;
+		while (sub != NULL) {
+		    TkUndoSubAtom *next = sub->next;
+
+		    if (sub->action != NULL) {
+			Tcl_DecrRefCount(sub->action);
+		    }
+		    ckfree(sub);
+		    sub = next;
+		}
+	    }
+	    ckfree(elem);
+	}
+	if (stack->depth > 0) {
+	    stack->depth--;
+	}
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -448,6 +641,7 @@ TkUndoClearStacks(
     TkUndoClearStack(&stack->undoStack);
     TkUndoClearStack(&stack->redoStack);
     stack->depth = 0;
+    stack->size = 0;
 }
 
 /*
@@ -598,6 +792,7 @@ TkUndoRevert(
 
 	EvaluateActionList(stack->interp, elem->revert);
 
+	stack->size -= elem->size;
 	TkUndoPushStack(&stack->redoStack, elem);
 	elem = TkUndoPopStack(&stack->undoStack);
     }
@@ -660,6 +855,7 @@ TkUndoApply(
 
 	EvaluateActionList(stack->interp, elem->apply);
 
+	stack->size += elem->size;
 	TkUndoPushStack(&stack->undoStack, elem);
 	elem = TkUndoPopStack(&stack->redoStack);
     }
@@ -65,6 +65,10 @@ typedef struct TkUndoAtom {
 				 * for this operation. */
     TkUndoSubAtom *revert;	/* Linked list of 'revert' actions to perform
 				 * for this operation. */
+    size_t size;		/* Approximate number of bytes this atom
+				 * retains (headers plus action payloads);
+				 * maintained for the stack's memory
+				 * budget. */
     struct TkUndoAtom *next;	/* Pointer to the next element in the
 				 * stack. */
 } TkUndoAtom;
@@ -80,6 +84,11 @@ typedef struct TkUndoRedoStack {
 				 * revert and apply scripts. */
     int maxdepth;
     int depth;
+    size_t maxsize;		/* Maximum approximate number of bytes the
+				 * undo stack may retain, or 0 for no
+				 * limit. */
+    size_t size;		/* Approximate number of bytes currently
+				 * retained by the undo stack. */
 } TkUndoRedoStack;
 
 /*
@@ -97,6 +106,8 @@ MODULE_SCOPE void	TkUndoClearStack(TkUndoAtom **stack);
 
 MODULE_SCOPE TkUndoRedoStack *TkUndoInitStack(Tcl_Interp *interp, int maxdepth);
 MODULE_SCOPE void	TkUndoSetMaxDepth(TkUndoRedoStack *stack, int maxdepth);
+MODULE_SCOPE void	TkUndoSetMaxSize(TkUndoRedoStack *stack,
+			    size_t maxsize);
 MODULE_SCOPE void	TkUndoClearStacks(TkUndoRedoStack *stack);
 MODULE_SCOPE void	TkUndoFreeStack(TkUndoRedoStack *stack);
 MODULE_SCOPE int	TkUndoCanRedo(TkUndoRedoStack *stack);
@@ -1087,6 +1087,95 @@ TkBackgroundEvalObjv(
     return r;
 }
 
+/*
+ * ----------------------------------------------------------------------
+ *
+ * TkBase64Decode --
+ *
+ *	Decode a complete base64 encoded buffer in one pass. This exists for
+ *	the photo image data paths, where decoding the whole "-data" value
+ *	up front and reading binary from the result is far cheaper than
+ *	running a character-at-a-time decoder inside the format parser.
+ *	Whitespace is skipped; decoding stops at a '=' pad character, a NUL,
+ *	or any other character outside the base64 alphabet, matching the
+ *	tolerant behavior the image readers have always had.
+ *
+ * Results:
+ *	The number of bytes stored at dst, which must have room for at least
+ *	3 * (length / 4) + 2 bytes.
+ *
+ * Side Effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------
+ */
+
+Tcl_Size
+TkBase64Decode(
+    const unsigned char *src,	/* Base64 encoded input characters. */
+    Tcl_Size length,		/* Number of bytes at src. */
+    unsigned char *dst)		/* Where to store the decoded bytes. */
+{
+    /*
+     * Value of each base64 symbol, 64 for whitespace that may legally be
+     * interspersed, 65 for everything else (including '=' and NUL), so a
+     * single table lookup classifies each input character.
+     */
+
+    static const unsigned char table[256] = {
+	65, 65, 65, 65, 65, 65, 65, 65, 65, 64, 64, 65, 64, 64, 65, 65,
+	65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65,
+	64, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 62, 65, 65, 65, 63,
+	52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 65, 65, 65, 65, 65, 65,
+	65,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+	15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 65, 65, 65, 65, 65,
+	65, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+	41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 65, 65, 65, 65, 65,
+	65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65,
+	65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65,
+	65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65,
+	65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65,
+	65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65,
+	65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65,
+	65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65,
+	65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65, 65
+    };
+    const unsigned char *end = src + length;
+    unsigned char *origDst = dst;
+    unsigned int window = 0;
+    int bits = 0;
+
+    while (src < end) {
+	unsigned char value = table[*src++];
+
+	if (value < 64) {
+	    window = (window << 6) | value;
+	    bits += 6;
+	    if (bits >= 24) {
+		dst[0] = (unsigned char) (window >> 16);
+		dst[1] = (unsigned char) (window >> 8);
+		dst[2] = (unsigned char) window;
+		dst += 3;
+		window = 0;
+		bits = 0;
+	    }
+	} else if (value > 64) {
+	    break;
+	}
+    }
+
+    /*
+     * Flush whatever whole bytes remain in a partial final group.
+     */
+
+    while (bits >= 8) {
+	bits -= 2;
+	*dst++ = (unsigned char) (window >> (bits - 6));
+	bits -= 6;
+    }
+    return dst - origDst;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -1246,6 +1335,250 @@ Tk_SendVirtualEvent(
     Tk_QueueWindowEvent(&event.general, TCL_QUEUE_TAIL);
 }
 
+/*
+ * The functions below form an opt-in allocation accounting layer that
+ * attributes heap usage to Tk subsystems.  Converted call sites allocate
+ * through TkMemAlloc, which prefixes each block with a small tagged header
+ * so TkMemFree can charge the release back to the right subsystem;
+ * everything else continues to use ckalloc unchanged.  The counters are
+ * kept per thread and reported by [tk memstats].
+ */
+
+typedef union TkMemHeader {
+    struct {
+	size_t size;		/* Size of the payload, in bytes. */
+	int tag;		/* TK_MEM_* subsystem the block belongs to. */
+    } info;
+    double align;		/* Forces worst-case alignment of the
+				 * payload. */
+} TkMemHeader;
+
+typedef struct {
+    Tcl_WideInt live;		/* Bytes currently allocated. */
+    Tcl_WideInt peak;		/* High-water mark of live. */
+    Tcl_WideInt total;		/* Bytes ever allocated. */
+    Tcl_WideInt allocs;		/* Number of allocations. */
+    Tcl_WideInt frees;		/* Number of releases. */
+} TkMemCounters;
+
+typedef struct {
+    TkMemCounters mem[TK_MEM_NTAGS];
+} ThreadSpecificData;
+static Tcl_ThreadDataKey dataKey;
+
+static const char *const memTagNames[TK_MEM_NTAGS] = {
+    "canvas", "text", "font", "image", "ttk", "other"
+};
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkMemAlloc --
+ *
+ *	Allocate a block of memory and charge it to the given subsystem.
+ *
+ * Results:
+ *	Returns a pointer to a block of at least size bytes, suitably
+ *	aligned for any use.  The block must be released with TkMemFree or
+ *	resized with TkMemRealloc, never with ckfree or ckrealloc.
+ *
+ * Side effects:
+ *	The subsystem's counters are updated.  Panics on allocation failure,
+ *	like ckalloc.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void *
+TkMemAlloc(
+    int tag,			/* TK_MEM_* subsystem to charge. */
+    size_t size)		/* Number of bytes needed. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    TkMemCounters *countersPtr = &tsdPtr->mem[tag];
+    TkMemHeader *headerPtr;
+
+    headerPtr = (TkMemHeader *)ckalloc(sizeof(TkMemHeader) + size);
+    headerPtr->info.size = size;
+    headerPtr->info.tag = tag;
+    countersPtr->live += (Tcl_WideInt)size;
+    if (countersPtr->live > countersPtr->peak) {
+	countersPtr->peak = countersPtr->live;
+    }
+    countersPtr->total += (Tcl_WideInt)size;
+    countersPtr->allocs++;
+    return headerPtr + 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkMemRealloc --
+ *
+ *	Resize a block obtained from TkMemAlloc, keeping the accounting
+ *	straight.
+ *
+ * Results:
+ *	Returns a pointer to the resized block, which may have moved.
+ *
+ * Side effects:
+ *	The subsystem's counters are updated.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void *
+TkMemRealloc(
+    int tag,			/* TK_MEM_* subsystem to charge. */
+    void *ptr,			/* Block obtained from TkMemAlloc, or NULL. */
+    size_t size)		/* New size of the block, in bytes. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    TkMemCounters *countersPtr = &tsdPtr->mem[tag];
+    TkMemHeader *headerPtr;
+    size_t oldSize;
+
+    if (ptr == NULL) {
+	return TkMemAlloc(tag, size);
+    }
+    headerPtr = (TkMemHeader *)ptr - 1;
+    oldSize = headerPtr->info.size;
+    headerPtr = (TkMemHeader *)ckrealloc(headerPtr,
+	    sizeof(TkMemHeader) + size);
+    headerPtr->info.size = size;
+    headerPtr->info.tag = tag;
+    countersPtr->live += (Tcl_WideInt)size - (Tcl_WideInt)oldSize;
+    if (countersPtr->live > countersPtr->peak) {
+	countersPtr->peak = countersPtr->live;
+    }
+    if (size > oldSize) {
+	countersPtr->total += (Tcl_WideInt)(size - oldSize);
+    }
+    return headerPtr + 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkMemFree --
+ *
+ *	Release a block obtained from TkMemAlloc.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The memory is freed and the owning subsystem's counters are updated.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkMemFree(
+    void *ptr)			/* Block obtained from TkMemAlloc, or NULL. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    TkMemHeader *headerPtr;
+    TkMemCounters *countersPtr;
+
+    if (ptr == NULL) {
+	return;
+    }
+    headerPtr = (TkMemHeader *)ptr - 1;
+    countersPtr = &tsdPtr->mem[headerPtr->info.tag];
+    countersPtr->live -= (Tcl_WideInt)headerPtr->info.size;
+    countersPtr->frees++;
+    ckfree(headerPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkMemGetStatsObj --
+ *
+ *	Build the [tk memstats] result for the current thread.
+ *
+ * Results:
+ *	Returns a dictionary mapping each subsystem with recorded activity to
+ *	a dictionary with the keys live, peak, total, allocs and frees.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tcl_Obj *
+TkMemGetStatsObj(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    Tcl_Obj *dictObj = Tcl_NewDictObj();
+    int tag;
+
+    for (tag = 0; tag < TK_MEM_NTAGS; tag++) {
+	TkMemCounters *countersPtr = &tsdPtr->mem[tag];
+	Tcl_Obj *entryObj;
+
+	if ((countersPtr->allocs == 0) && (countersPtr->frees == 0)) {
+	    continue;
+	}
+	entryObj = Tcl_NewDictObj();
+	Tcl_DictObjPut(NULL, entryObj, Tcl_NewStringObj("live", TCL_INDEX_NONE),
+		Tcl_NewWideIntObj(countersPtr->live));
+	Tcl_DictObjPut(NULL, entryObj, Tcl_NewStringObj("peak", TCL_INDEX_NONE),
+		Tcl_NewWideIntObj(countersPtr->peak));
+	Tcl_DictObjPut(NULL, entryObj, Tcl_NewStringObj("total", TCL_INDEX_NONE),
+		Tcl_NewWideIntObj(countersPtr->total));
+	Tcl_DictObjPut(NULL, entryObj, Tcl_NewStringObj("allocs", TCL_INDEX_NONE),
+		Tcl_NewWideIntObj(countersPtr->allocs));
+	Tcl_DictObjPut(NULL, entryObj, Tcl_NewStringObj("frees", TCL_INDEX_NONE),
+		Tcl_NewWideIntObj(countersPtr->frees));
+	Tcl_DictObjPut(NULL, dictObj,
+		Tcl_NewStringObj(memTagNames[tag], TCL_INDEX_NONE), entryObj);
+    }
+    return dictObj;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkMemResetStats --
+ *
+ *	Reset the allocation counters for the current thread.  The live byte
+ *	counts are kept (the memory is still allocated); the cumulative
+ *	counters are zeroed and the peaks restart from the current live
+ *	values.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Counters are reset.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkMemResetStats(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    int tag;
+
+    for (tag = 0; tag < TK_MEM_NTAGS; tag++) {
+	TkMemCounters *countersPtr = &tsdPtr->mem[tag];
+
+	countersPtr->peak = countersPtr->live;
+	countersPtr->total = 0;
+	countersPtr->allocs = 0;
+	countersPtr->frees = 0;
+    }
+}
+
 /*
  * Local Variables:
  * mode: c
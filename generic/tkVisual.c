@@ -58,6 +58,17 @@ struct TkColormap {
     struct TkColormap *nextPtr;	/* Next in list of colormaps for this display,
 				 * or NULL for end of list. */
 };
+
+/*
+ * One of the following structures is stored in a display's visualTable for
+ * each visual specification that has been resolved, so that creating more
+ * windows with the same -visual option doesn't go back to the server.
+ */
+
+typedef struct VisualCacheEntry {
+    Visual *visual;		/* The matching visual. */
+    int depth;			/* Depth of that visual. */
+} VisualCacheEntry;
 
 /*
  *----------------------------------------------------------------------
@@ -105,6 +116,9 @@ Tk_GetVisual(
     const VisualDictionary *dictPtr;
     TkColormap *cmapPtr;
     TkDisplay *dispPtr = ((TkWindow *) tkwin)->dispPtr;
+    Tcl_HashEntry *hPtr;
+    Tcl_DString keyDs;
+    int isNew, canCache = 0;
 
     /*
      * Parse string and set up a template for use in searching for an
@@ -228,6 +242,39 @@ Tk_GetVisual(
 	}
     }
 
+    /*
+     * The result for an ID or class/depth specification depends only on the
+     * display and screen, and a server's visuals never change while it is
+     * running, so consult the per-display cache before asking the server.
+     * Window-name specifications (handled above) are not cached: they
+     * depend on the named window.
+     */
+
+    if (c != '.') {
+	char screenBuf[TCL_INTEGER_SPACE + 1];
+
+	snprintf(screenBuf, sizeof(screenBuf), "%d ", Tk_ScreenNumber(tkwin));
+	Tcl_DStringInit(&keyDs);
+	Tcl_DStringAppend(&keyDs, screenBuf, TCL_INDEX_NONE);
+	Tcl_DStringAppend(&keyDs, string, TCL_INDEX_NONE);
+	canCache = 1;
+	if (!dispPtr->visualTableInit) {
+	    Tcl_InitHashTable(&dispPtr->visualTable, TCL_STRING_KEYS);
+	    dispPtr->visualTableInit = 1;
+	}
+	hPtr = Tcl_FindHashEntry(&dispPtr->visualTable,
+		Tcl_DStringValue(&keyDs));
+	if (hPtr != NULL) {
+	    VisualCacheEntry *entryPtr = (VisualCacheEntry *)
+		    Tcl_GetHashValue(hPtr);
+
+	    *depthPtr = entryPtr->depth;
+	    visual = entryPtr->visual;
+	    Tcl_DStringFree(&keyDs);
+	    goto gotVisual;
+	}
+    }
+
     /*
      * Find all visuals that match the template we've just created, and return
      * an error if there are none that match.
@@ -238,6 +285,9 @@ Tk_GetVisual(
     visInfoList = XGetVisualInfo(Tk_Display(tkwin), mask, &templ,
 	    &numVisuals);
     if (visInfoList == NULL) {
+	if (canCache) {
+	    Tcl_DStringFree(&keyDs);
+	}
 	Tcl_SetObjResult(interp, Tcl_NewStringObj(
 		"couldn't find an appropriate visual", TCL_INDEX_NONE));
 	Tcl_SetErrorCode(interp, "TK", "VISUAL", "INAPPROPRIATE", NULL);
@@ -308,6 +358,19 @@ Tk_GetVisual(
     visual = bestPtr->visual;
     XFree(visInfoList);
 
+    if (canCache) {
+	VisualCacheEntry *entryPtr = (VisualCacheEntry *)
+		ckalloc(sizeof(VisualCacheEntry));
+
+	entryPtr->visual = visual;
+	entryPtr->depth = *depthPtr;
+	hPtr = Tcl_CreateHashEntry(&dispPtr->visualTable,
+		Tcl_DStringValue(&keyDs), &isNew);
+	Tcl_SetHashValue(hPtr, entryPtr);
+	Tcl_DStringFree(&keyDs);
+    }
+
+  gotVisual:
     /*
      * If we need to find a colormap for this visual, do it now. If the visual
      * is the default visual for the screen, then use the default colormap.
@@ -38,6 +38,42 @@ typedef struct TkHalfdeadWindow {
     struct TkHalfdeadWindow *nextPtr;
 } TkHalfdeadWindow;
 
+/*
+ * The following structure records one entry in the per-thread startup phase
+ * log; see TkRecordStartupPhase.
+ */
+
+#define TK_MAX_STARTUP_PHASES 16
+
+typedef struct {
+    const char *name;		/* Name of the phase (a string literal; the
+				 * pointer is stored, not copied). */
+    Tcl_Time time;		/* Time at which the phase was entered. */
+} StartupPhase;
+
+/*
+ * One off-screen pixmap retained for reuse by display procedures; see
+ * TkGetPaintBuffer.  Sizes are rounded up to multiples of
+ * PAINT_BUFFER_GRAIN so that a window growing interactively settles on a
+ * reusable bucket, and at most PAINT_BUFFER_LIMIT idle buffers are kept per
+ * display.
+ */
+
+typedef struct TkPaintBuffer {
+    Pixmap pixmap;		/* The off-screen buffer. */
+    int width, height;		/* Size of the pixmap; already rounded up to
+				 * PAINT_BUFFER_GRAIN. */
+    int depth;			/* Depth of the pixmap. */
+    Screen *screen;		/* Screen the pixmap was created for. */
+    int busy;			/* 1 while checked out to a display
+				 * procedure. */
+    struct TkPaintBuffer *nextPtr;
+				/* Next in the display's list. */
+} TkPaintBuffer;
+
+#define PAINT_BUFFER_GRAIN 64
+#define PAINT_BUFFER_LIMIT 4
+
 typedef struct {
     int numMainWindows;		/* Count of numver of main windows currently
 				 * open in this thread. */
@@ -51,6 +87,10 @@ typedef struct {
 				 * the current thread. */
     int initialized;		/* 0 means the structures above need
 				 * initializing. */
+    int numStartupPhases;	/* Number of entries used in startupPhases. */
+    StartupPhase startupPhases[TK_MAX_STARTUP_PHASES];
+				/* Timestamped log of initialization phases,
+				 * reported by [tk startupstats]. */
 } ThreadSpecificData;
 static Tcl_ThreadDataKey dataKey;
 
@@ -209,13 +249,186 @@ static Tk_Window	CreateTopLevelWindow(Tcl_Interp *interp,
 			    Tk_Window parent, const char *name,
 			    const char *screenName, unsigned int flags);
 static void		DeleteWindowsExitProc(void *clientData);
+static void		FreePaintBuffers(TkDisplay *dispPtr);
 static TkDisplay *	GetScreen(Tcl_Interp *interp, const char *screenName,
 			    int *screenPtr);
+static Tcl_WideInt	StartupPhaseUsec(const Tcl_Time *fromPtr,
+			    const Tcl_Time *toPtr);
 static int		Initialize(Tcl_Interp *interp);
+static void		IssueRestack(TkWindow *winPtr);
 static int		NameWindow(Tcl_Interp *interp, TkWindow *winPtr,
 			    TkWindow *parentPtr, const char *name);
+static void		RestackIdleProc(void *clientData);
 static void		UnlinkWindow(TkWindow *winPtr);
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkGetPaintBuffer --
+ *
+ *	Return an off-screen pixmap at least width by height pixels in size
+ *	for a display procedure to draw into before copying the result to the
+ *	screen.  Buffers are retained per display and reused across repaints,
+ *	so steady-state redisplay does not create and destroy a pixmap on
+ *	every frame (round trips that dominate small-update latency on remote
+ *	connections).
+ *
+ * Results:
+ *	Returns a pixmap with the depth and screen of tkwin.  The pixmap may
+ *	be larger than requested and its contents are undefined.  The caller
+ *	must hand it back with TkReleasePaintBuffer when done drawing.
+ *
+ * Side effects:
+ *	May create a pixmap.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Pixmap
+TkGetPaintBuffer(
+    Tk_Window tkwin,		/* Window the buffer will be copied to. */
+    int width,			/* Required width, in pixels. */
+    int height)			/* Required height, in pixels. */
+{
+    TkDisplay *dispPtr = ((TkWindow *) tkwin)->dispPtr;
+    TkPaintBuffer *bufPtr, *bestPtr = NULL;
+    int depth = Tk_Depth(tkwin);
+    Screen *screen = Tk_Screen(tkwin);
+
+    if (width < 1) {
+	width = 1;
+    }
+    if (height < 1) {
+	height = 1;
+    }
+    width = (width + PAINT_BUFFER_GRAIN - 1) & ~(PAINT_BUFFER_GRAIN - 1);
+    height = (height + PAINT_BUFFER_GRAIN - 1) & ~(PAINT_BUFFER_GRAIN - 1);
+
+    /*
+     * Reuse the smallest retained buffer that is large enough and
+     * compatible with the window.
+     */
+
+    for (bufPtr = dispPtr->paintBufferPtr; bufPtr != NULL;
+	    bufPtr = bufPtr->nextPtr) {
+	if (bufPtr->busy || (bufPtr->depth != depth)
+		|| (bufPtr->screen != screen)
+		|| (bufPtr->width < width) || (bufPtr->height < height)) {
+	    continue;
+	}
+	if ((bestPtr == NULL) || (bufPtr->width * bufPtr->height
+		< bestPtr->width * bestPtr->height)) {
+	    bestPtr = bufPtr;
+	}
+    }
+    if (bestPtr == NULL) {
+	bestPtr = (TkPaintBuffer *)ckalloc(sizeof(TkPaintBuffer));
+	bestPtr->pixmap = Tk_GetPixmap(dispPtr->display, Tk_WindowId(tkwin),
+		width, height, depth);
+	bestPtr->width = width;
+	bestPtr->height = height;
+	bestPtr->depth = depth;
+	bestPtr->screen = screen;
+	bestPtr->nextPtr = dispPtr->paintBufferPtr;
+	dispPtr->paintBufferPtr = bestPtr;
+	dispPtr->paintBufferCount++;
+    }
+    bestPtr->busy = 1;
+    return bestPtr->pixmap;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkReleasePaintBuffer --
+ *
+ *	Hand a pixmap obtained from TkGetPaintBuffer back for reuse.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The pixmap becomes available to later TkGetPaintBuffer calls.  The
+ *	least recently used idle buffers beyond the retention budget are
+ *	freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkReleasePaintBuffer(
+    Tk_Window tkwin,		/* Window the buffer was obtained for. */
+    Pixmap pixmap)		/* Return value of TkGetPaintBuffer. */
+{
+    TkDisplay *dispPtr = ((TkWindow *) tkwin)->dispPtr;
+    TkPaintBuffer *bufPtr, **bufPtrPtr;
+    int idle = 0;
+
+    for (bufPtrPtr = &dispPtr->paintBufferPtr; (bufPtr = *bufPtrPtr) != NULL;
+	    bufPtrPtr = &bufPtr->nextPtr) {
+	if (bufPtr->pixmap == pixmap) {
+	    break;
+	}
+    }
+    if (bufPtr == NULL) {
+	Tk_FreePixmap(dispPtr->display, pixmap);
+	return;
+    }
+
+    /*
+     * Move the buffer to the head of the list so that reuse and trimming
+     * both favor the most recently used buffers.
+     */
+
+    *bufPtrPtr = bufPtr->nextPtr;
+    bufPtr->busy = 0;
+    bufPtr->nextPtr = dispPtr->paintBufferPtr;
+    dispPtr->paintBufferPtr = bufPtr;
+
+    for (bufPtrPtr = &dispPtr->paintBufferPtr;
+	    (bufPtr = *bufPtrPtr) != NULL; ) {
+	if (!bufPtr->busy && (++idle > PAINT_BUFFER_LIMIT)) {
+	    *bufPtrPtr = bufPtr->nextPtr;
+	    Tk_FreePixmap(dispPtr->display, bufPtr->pixmap);
+	    ckfree(bufPtr);
+	    dispPtr->paintBufferCount--;
+	} else {
+	    bufPtrPtr = &bufPtr->nextPtr;
+	}
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * FreePaintBuffers --
+ *
+ *	Release all pixmaps retained for a display.  Called when the display
+ *	is closed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Frees memory and X resources.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+FreePaintBuffers(
+    TkDisplay *dispPtr)		/* Display being closed. */
+{
+    TkPaintBuffer *bufPtr;
+
+    while ((bufPtr = dispPtr->paintBufferPtr) != NULL) {
+	dispPtr->paintBufferPtr = bufPtr->nextPtr;
+	Tk_FreePixmap(dispPtr->display, bufPtr->pixmap);
+	ckfree(bufPtr);
+    }
+    dispPtr->paintBufferCount = 0;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -251,6 +464,28 @@ TkCloseDisplay(
 	dispPtr->atomInit = 0;
     }
 
+    if (dispPtr->visualTableInit) {
+	Tcl_HashEntry *hPtr;
+	Tcl_HashSearch search;
+
+	for (hPtr = Tcl_FirstHashEntry(&dispPtr->visualTable, &search);
+		hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	    ckfree(Tcl_GetHashValue(hPtr));
+	}
+	Tcl_DeleteHashTable(&dispPtr->visualTable);
+	dispPtr->visualTableInit = 0;
+    }
+
+    if (dispPtr->restackIdle) {
+	TkCancelDoWhenIdle(RestackIdleProc, dispPtr);
+	dispPtr->restackIdle = 0;
+    }
+    if (dispPtr->restackPtr != NULL) {
+	ckfree(dispPtr->restackPtr);
+	dispPtr->restackPtr = NULL;
+	dispPtr->numRestack = dispPtr->maxRestack = 0;
+    }
+
     if (dispPtr->errorPtr != NULL) {
 	TkErrorHandler *errorPtr;
 
@@ -261,8 +496,40 @@ TkCloseDisplay(
 	    ckfree(errorPtr);
 	}
     }
+    if (dispPtr->errorFreePtr != NULL) {
+	TkErrorHandler *errorPtr;
+
+	for (errorPtr = dispPtr->errorFreePtr;
+		errorPtr != NULL;
+		errorPtr = dispPtr->errorFreePtr) {
+	    dispPtr->errorFreePtr = errorPtr->nextPtr;
+	    ckfree(errorPtr);
+	}
+    }
 
     TkGCCleanup(dispPtr);
+    FreePaintBuffers(dispPtr);
+
+    if (dispPtr->preloadCursors != NULL) {
+	int i;
+
+	for (i = 0; i < dispPtr->numPreloadCursors; i++) {
+	    Tk_FreeCursor(dispPtr->display, dispPtr->preloadCursors[i]);
+	}
+	ckfree(dispPtr->preloadCursors);
+	dispPtr->preloadCursors = NULL;
+	dispPtr->numPreloadCursors = 0;
+    }
+    if (dispPtr->preloadBitmaps != NULL) {
+	int i;
+
+	for (i = 0; i < dispPtr->numPreloadBitmaps; i++) {
+	    Tk_FreeBitmap(dispPtr->display, dispPtr->preloadBitmaps[i]);
+	}
+	ckfree(dispPtr->preloadBitmaps);
+	dispPtr->preloadBitmaps = NULL;
+	dispPtr->numPreloadBitmaps = 0;
+    }
 
     TkpCloseDisplay(dispPtr);
 
@@ -330,6 +597,7 @@ CreateTopLevelWindow(
 	 */
 
 	Tk_CreateImageType(&tkBitmapImageType);
+	Tk_CreateImageType(&tkGradientImageType);
 	Tk_CreateImageType(&tkPhotoImageType);
 
 	/*
@@ -340,6 +608,7 @@ CreateTopLevelWindow(
 	Tk_CreatePhotoImageFormatVersion3(&tkImgFmtGIF);
 	Tk_CreatePhotoImageFormatVersion3(&tkImgFmtPNG);
 	Tk_CreatePhotoImageFormat(&tkImgFmtPPM);
+	Tk_CreatePhotoImageFormat(&tkImgFmtRaw);
 	Tk_CreatePhotoImageFormat(&tkImgFmtSVGnano);
     }
 
@@ -842,6 +1111,7 @@ TkCreateMainWindow(
     Tcl_CmdInfo info;
     ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
 	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    int firstWindow = (tsdPtr->numMainWindows == 0);
 
     /*
      * Panic if someone updated the TkWindow structure without also updating
@@ -856,6 +1126,9 @@ TkCreateMainWindow(
      * Create the basic TkWindow structure.
      */
 
+    if (firstWindow) {
+	TkRecordStartupPhase("display");
+    }
     tkwin = CreateTopLevelWindow(interp, NULL, baseName,
 	    screenName, /* flags */ 0);
     if (tkwin == NULL) {
@@ -876,6 +1149,9 @@ TkCreateMainWindow(
     mainPtr->deletionEpoch = 0l;
     TkEventInit();
     TkBindInit(mainPtr);
+    if (firstWindow) {
+	TkRecordStartupPhase("fonts");
+    }
     TkFontPkgInit(mainPtr);
     TkStylePkgInit(mainPtr);
     mainPtr->tlFocusPtr = NULL;
@@ -925,6 +1201,9 @@ TkCreateMainWindow(
      * Bind in Tk's commands.
      */
 
+    if (firstWindow) {
+	TkRecordStartupPhase("commands");
+    }
     isSafe = Tcl_IsSafe(interp);
     for (cmdPtr = commands; cmdPtr->name != NULL; cmdPtr++) {
 	Tcl_CmdInfo cmdInfo;
@@ -1358,6 +1637,16 @@ Tk_DestroyWindow(
     }
     winPtr->flags |= TK_ALREADY_DEAD;
 
+    if (winPtr->flags & TK_WM_TRANSACTION) {
+	/*
+	 * The window is going away with a construction transaction still
+	 * open; release the idle hold it was keeping.
+	 */
+
+	winPtr->flags &= ~TK_WM_TRANSACTION;
+	TkIdleThaw();
+    }
+
     /*
      * Unless we are cleaning up a half dead window from
      * DeleteWindowsExitProc, add this window to the half dead list.
@@ -1564,6 +1853,7 @@ Tk_DestroyWindow(
     TkOptionDeadWindow(winPtr);
     TkSelDeadWindow(winPtr);
     TkGrabDeadWindow(winPtr);
+    TkRestackDeadWindow(winPtr);
     if (winPtr->geomMgrName != NULL) {
 	ckfree(winPtr->geomMgrName);
 	winPtr->geomMgrName = NULL;
@@ -1753,6 +2043,15 @@ Tk_MapWindow(
     if (winPtr->flags & TK_ALREADY_DEAD) {
 	return;
     }
+    if (winPtr->flags & TK_WM_TRANSACTION) {
+	/*
+	 * A construction transaction is open on this toplevel; remember
+	 * that a map was requested and perform it at commit time.
+	 */
+
+	winPtr->flags |= TK_DEFERRED_MAP;
+	return;
+    }
     if (winPtr->flags & TK_WIN_MANAGED) {
 	/*
 	 * Lots of special processing has to be done for top-level windows.
@@ -1774,6 +2073,94 @@ Tk_MapWindow(
     Tk_HandleEvent(&event);
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkWmTransactionBegin --
+ *
+ *	This function starts a construction transaction on a top-level
+ *	window, normally via "wm transaction begin". While the transaction
+ *	is open, tiered idle callbacks (geometry recalculation and repaints)
+ *	are held and mapping the toplevel is deferred, so a dialog can be
+ *	populated widget by widget without paying for any intermediate
+ *	layout or paint passes - even if the event loop runs in between.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Layout and repaint idle callbacks queue up until the matching
+ *	TkWmTransactionCommit call.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkWmTransactionBegin(
+    Tcl_Interp *interp,		/* Interpreter to report errors in. */
+    TkWindow *winPtr)		/* Top-level window of interest. */
+{
+    if (winPtr->flags & TK_WM_TRANSACTION) {
+	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		"a transaction is already open on window \"%s\"",
+		winPtr->pathName));
+	Tcl_SetErrorCode(interp, "TK", "WM", "TRANSACTION", NULL);
+	return TCL_ERROR;
+    }
+    winPtr->flags |= TK_WM_TRANSACTION;
+    TkIdleFreeze();
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkWmTransactionCommit --
+ *
+ *	This function ends a construction transaction started by
+ *	TkWmTransactionBegin. The geometry and repaint work that was held
+ *	while the transaction was open runs as one settled pass, and if a
+ *	map of the toplevel was requested during the transaction it is
+ *	performed now, so the window comes up with its final layout in a
+ *	single map.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Pending layout and repaint callbacks run; the window may be mapped.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkWmTransactionCommit(
+    Tcl_Interp *interp,		/* Interpreter to report errors in. */
+    TkWindow *winPtr)		/* Top-level window of interest. */
+{
+    if (!(winPtr->flags & TK_WM_TRANSACTION)) {
+	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		"no transaction is open on window \"%s\"",
+		winPtr->pathName));
+	Tcl_SetErrorCode(interp, "TK", "WM", "TRANSACTION", NULL);
+	return TCL_ERROR;
+    }
+    winPtr->flags &= ~TK_WM_TRANSACTION;
+    TkIdleThaw();
+
+    /*
+     * Run the held work now rather than at the next idle moment, so the
+     * toplevel's requested size is final before the map below.
+     */
+
+    TkIdleDrain();
+    if (winPtr->flags & TK_DEFERRED_MAP) {
+	winPtr->flags &= ~TK_DEFERRED_MAP;
+	Tk_MapWindow((Tk_Window)winPtr);
+    }
+    return TCL_OK;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -2126,6 +2513,7 @@ Tk_SetWindowBackground(
     TkWindow *winPtr = (TkWindow *) tkwin;
 
     winPtr->atts.background_pixel = pixel;
+    winPtr->flags |= TK_WIN_OPAQUE;
 
     if (winPtr->window != None) {
 	XSetWindowBackground(winPtr->display, winPtr->window, pixel);
@@ -2143,6 +2531,11 @@ Tk_SetWindowBackgroundPixmap(
     TkWindow *winPtr = (TkWindow *) tkwin;
 
     winPtr->atts.background_pixmap = pixmap;
+    if ((pixmap == None) || (pixmap == ParentRelative)) {
+	winPtr->flags &= ~TK_WIN_OPAQUE;
+    } else {
+	winPtr->flags |= TK_WIN_OPAQUE;
+    }
 
     if (winPtr->window != None) {
 	XSetWindowBackgroundPixmap(winPtr->display,
@@ -2610,6 +3003,45 @@ Tk_RestackWindow(
 				 * it just above or below this window. If NULL
 				 * then tkwin goes above or below all windows
 				 * in the same parent. */
+{
+    return TkRestackWindow(tkwin, aboveBelow, other, 0);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkRestackWindow --
+ *
+ *	Change a window's position in the stacking order, like
+ *	Tk_RestackWindow, but optionally deferring the server request. With
+ *	defer non-zero the window is merely recorded on its display's
+ *	restack list; the requests for all recorded windows are issued
+ *	together just before the next round of redisplays, so a window that
+ *	is restacked several times per frame costs a single request and the
+ *	intermediate orders never reach the server.
+ *
+ * Results:
+ *	TCL_OK is normally returned. If other is not a descendant of tkwin's
+ *	parent then TCL_ERROR is returned and tkwin is not repositioned.
+ *
+ * Side effects:
+ *	Tkwin is repositioned in the stacking order.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkRestackWindow(
+    Tk_Window tkwin,		/* Token for window whose position in the
+				 * stacking order is to change. */
+    int aboveBelow,		/* Indicates new position of tkwin relative to
+				 * other; must be Above or Below. */
+    Tk_Window other,		/* Tkwin will be moved to a position that puts
+				 * it just above or below this window. If NULL
+				 * then tkwin goes above or below all windows
+				 * in the same parent. */
+    int defer)			/* Non-zero means batch the server request as
+				 * described above. */
 {
     TkWindow *winPtr = (TkWindow *) tkwin;
     TkWindow *otherPtr = (TkWindow *) other;
@@ -2690,23 +3122,197 @@ Tk_RestackWindow(
      */
 
     if (winPtr->window != None) {
-	XWindowChanges changes;
-	unsigned int mask = CWStackMode;
+	TkDisplay *dispPtr = winPtr->dispPtr;
+
+	if (defer) {
+	    if (!(winPtr->flags & TK_RESTACK_PENDING)) {
+		winPtr->flags |= TK_RESTACK_PENDING;
+		if (dispPtr->numRestack >= dispPtr->maxRestack) {
+		    dispPtr->maxRestack = (dispPtr->maxRestack == 0) ? 16
+			    : 2*dispPtr->maxRestack;
+		    dispPtr->restackPtr = (TkWindow **)ckrealloc(
+			    dispPtr->restackPtr,
+			    sizeof(TkWindow *) * dispPtr->maxRestack);
+		}
+		dispPtr->restackPtr[dispPtr->numRestack++] = winPtr;
+	    }
+	    if (!dispPtr->restackIdle) {
+		dispPtr->restackIdle = 1;
+		TkDoWhenIdle(RestackIdleProc, dispPtr, TK_IDLE_LAYOUT);
+	    }
+	    return TCL_OK;
+	}
+
+	/*
+	 * Flush any batched restacks first so this immediate request lands
+	 * on top of the order they establish.
+	 */
 
+	if (dispPtr->numRestack > 0) {
+	    TkRestackFlush(dispPtr);
+	}
+	IssueRestack(winPtr);
+    }
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * IssueRestack --
+ *
+ *	Send the server request that moves a window to its position in the
+ *	client-side stacking order, expressed relative to the nearest lower
+ *	sibling that has a server window. The lower neighbour is used (not
+ *	the upper one) so that a flush of several pending siblings can walk
+ *	bottom-to-top: by the time a window is issued, its reference sibling
+ *	is already in its final server position, either because it was never
+ *	pending or because it was issued earlier in the same flush. A window
+ *	with no lower neighbour is placed at the bottom of the stack.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	A ConfigureWindow request is issued.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+IssueRestack(
+    TkWindow *winPtr)		/* Window to position on the server; must
+				 * have a server window. */
+{
+    XWindowChanges changes;
+    unsigned int mask = CWStackMode;
+    TkWindow *otherPtr, *lowerPtr = NULL;
+
+    for (otherPtr = winPtr->parentPtr->childList; otherPtr != winPtr;
+	    otherPtr = otherPtr->nextPtr) {
+	if ((otherPtr->window != None)
+		&& !(otherPtr->flags & (TK_TOP_HIERARCHY|TK_REPARENTED))){
+	    lowerPtr = otherPtr;
+	}
+    }
+    if (lowerPtr != NULL) {
+	changes.sibling = lowerPtr->window;
 	changes.stack_mode = Above;
-	for (otherPtr = winPtr->nextPtr; otherPtr != NULL;
-		otherPtr = otherPtr->nextPtr) {
-	    if ((otherPtr->window != None)
-		    && !(otherPtr->flags & (TK_TOP_HIERARCHY|TK_REPARENTED))){
-		changes.sibling = otherPtr->window;
-		changes.stack_mode = Below;
-		mask = CWStackMode|CWSibling;
-		break;
+	mask = CWStackMode|CWSibling;
+    } else {
+	changes.stack_mode = Below;
+    }
+    XConfigureWindow(winPtr->display, winPtr->window, mask, &changes);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkRestackFlush --
+ *
+ *	Issue the server requests for all windows recorded on the display's
+ *	restack list. The pending siblings of each containing window are
+ *	handled bottom-to-top, so every request can name the window's final
+ *	lower neighbour and each window costs exactly one request no matter
+ *	how often it was restacked since the last flush.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	ConfigureWindow requests are issued; the restack list is emptied.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkRestackFlush(
+    TkDisplay *dispPtr)		/* Display whose pending restacks to issue. */
+{
+    TkWindow *winPtr, *childPtr;
+    int i;
+
+    for (i = 0; i < dispPtr->numRestack; i++) {
+	winPtr = dispPtr->restackPtr[i];
+	if (!(winPtr->flags & TK_RESTACK_PENDING)) {
+	    continue;
+	}
+	for (childPtr = winPtr->parentPtr->childList; childPtr != NULL;
+		childPtr = childPtr->nextPtr) {
+	    if (childPtr->flags & TK_RESTACK_PENDING) {
+		childPtr->flags &= ~TK_RESTACK_PENDING;
+		if (childPtr->window != None) {
+		    IssueRestack(childPtr);
+		}
 	    }
 	}
-	XConfigureWindow(winPtr->display, winPtr->window, mask, &changes);
     }
-    return TCL_OK;
+    dispPtr->numRestack = 0;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * RestackIdleProc --
+ *
+ *	Idle handler that flushes the display's restack list; scheduled on
+ *	the layout tier so the final stacking order is in place before this
+ *	cycle's redisplays run.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	See TkRestackFlush.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+RestackIdleProc(
+    void *clientData)		/* Display with pending restacks. */
+{
+    TkDisplay *dispPtr = (TkDisplay *)clientData;
+
+    dispPtr->restackIdle = 0;
+    TkRestackFlush(dispPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkRestackDeadWindow --
+ *
+ *	Remove a window that is being destroyed from its display's restack
+ *	list, so the flush never touches a dead window.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkRestackDeadWindow(
+    TkWindow *winPtr)		/* Window that is being deleted. */
+{
+    TkDisplay *dispPtr = winPtr->dispPtr;
+    int i;
+
+    if (!(winPtr->flags & TK_RESTACK_PENDING)) {
+	return;
+    }
+    winPtr->flags &= ~TK_RESTACK_PENDING;
+    for (i = 0; i < dispPtr->numRestack; i++) {
+	if (dispPtr->restackPtr[i] == winPtr) {
+	    dispPtr->restackPtr[i] =
+		    dispPtr->restackPtr[--dispPtr->numRestack];
+	    break;
+	}
+    }
 }
 
 /*
@@ -2995,6 +3601,163 @@ TkCygwinMainEx(
 }
 #endif /* _WIN32 */
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * StartupPhaseUsec --
+ *
+ *	Computes the number of microseconds between two timestamps taken
+ *	with Tcl_GetTime.
+ *
+ * Results:
+ *	The elapsed time in microseconds.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static Tcl_WideInt
+StartupPhaseUsec(
+    const Tcl_Time *fromPtr,	/* Earlier timestamp. */
+    const Tcl_Time *toPtr)	/* Later timestamp. */
+{
+    return ((Tcl_WideInt) toPtr->sec - fromPtr->sec) * 1000000
+	    + (toPtr->usec - fromPtr->usec);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkRecordStartupPhase --
+ *
+ *	Appends a timestamped entry to this thread's startup phase log.
+ *	Called at the points of interest in Tk_MainEx, Initialize and
+ *	TkCreateMainWindow so that [tk startupstats] can report where
+ *	initialization time went.  The name must be a string literal; it is
+ *	stored, not copied.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Consumes one slot of the phase log.  Entries beyond
+ *	TK_MAX_STARTUP_PHASES are silently dropped.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkRecordStartupPhase(
+    const char *name)		/* Name of the phase being entered. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    StartupPhase *phasePtr;
+
+    if (tsdPtr->numStartupPhases >= TK_MAX_STARTUP_PHASES) {
+	return;
+    }
+    phasePtr = &tsdPtr->startupPhases[tsdPtr->numStartupPhases++];
+    phasePtr->name = name;
+    Tcl_GetTime(&phasePtr->time);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkGetStartupPhasesObj --
+ *
+ *	Builds the value returned by [tk startupstats]: a dictionary mapping
+ *	each recorded phase name to a dictionary with the keys "start" (the
+ *	microseconds from the first recorded phase to the start of this one)
+ *	and "elapsed" (the microseconds until the next phase was entered, or
+ *	0 for the last entry).
+ *
+ * Results:
+ *	A fresh unshared Tcl_Obj.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tcl_Obj *
+TkGetStartupPhasesObj(void)
+{
+    Tcl_Obj *resultObj = Tcl_NewDictObj();
+    int i;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    for (i = 0; i < tsdPtr->numStartupPhases; i++) {
+	const StartupPhase *phasePtr = &tsdPtr->startupPhases[i];
+	Tcl_Obj *entryObj = Tcl_NewDictObj();
+
+	Tcl_DictObjPut(NULL, entryObj,
+		Tcl_NewStringObj("start", TCL_INDEX_NONE),
+		Tcl_NewWideIntObj(StartupPhaseUsec(
+			&tsdPtr->startupPhases[0].time, &phasePtr->time)));
+	Tcl_DictObjPut(NULL, entryObj,
+		Tcl_NewStringObj("elapsed", TCL_INDEX_NONE),
+		Tcl_NewWideIntObj((i + 1 < tsdPtr->numStartupPhases)
+			? StartupPhaseUsec(&phasePtr->time,
+				&tsdPtr->startupPhases[i + 1].time)
+			: 0));
+	Tcl_DictObjPut(NULL, resultObj,
+		Tcl_NewStringObj(phasePtr->name, TCL_INDEX_NONE), entryObj);
+    }
+    return resultObj;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkReportStartupPhases --
+ *
+ *	Writes the startup phase log to stderr, one line per phase, if the
+ *	TK_STARTUP_STATS environment variable is set.  Called from Tk_MainEx
+ *	just before entering the main loop, so that deployments can report
+ *	where initialization time goes without an instrumented build or any
+ *	script changes.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May write to stderr.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkReportStartupPhases(void)
+{
+    int i;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if ((getenv("TK_STARTUP_STATS") == NULL)
+	    || (tsdPtr->numStartupPhases == 0)) {
+	return;
+    }
+    for (i = 0; i < tsdPtr->numStartupPhases; i++) {
+	const StartupPhase *phasePtr = &tsdPtr->startupPhases[i];
+
+	fprintf(stderr, "tk startup: %-12s at %8ld us", phasePtr->name,
+		(long) StartupPhaseUsec(&tsdPtr->startupPhases[0].time,
+			&phasePtr->time));
+	if (i + 1 < tsdPtr->numStartupPhases) {
+	    fprintf(stderr, ", took %ld us",
+		    (long) StartupPhaseUsec(&phasePtr->time,
+			    &tsdPtr->startupPhases[i + 1].time));
+	}
+	fputc('\n', stderr);
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -3199,6 +3962,8 @@ Initialize(
 
     tsdPtr = (ThreadSpecificData *)Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
 
+    TkRecordStartupPhase("argv");
+
     /*
      * We start by resetting the result because it might not be clean.
      */
@@ -3387,6 +4152,7 @@ Initialize(
     if (TCL_OK != Tcl_ListObjGetElements(interp, cmd, &objc, &objv)) {
 	return TCL_ERROR;
     }
+    TkRecordStartupPhase("mainwindow");
     code = TkCreateFrame(NULL, interp, objc, objv,
 	    1, nameObj ? Tcl_GetString(nameObj) : NULL);
 
@@ -3447,6 +4213,7 @@ Initialize(
      * Initialized the themed widget set
      */
 
+    TkRecordStartupPhase("ttk");
     code = Ttk_Init(interp);
     if (code != TCL_OK) {
 	goto done;
@@ -3458,6 +4225,7 @@ Initialize(
      * console window interpreter.
      */
 
+    TkRecordStartupPhase("platform");
     code = TkpInit(interp);
     if (code == TCL_OK) {
 
@@ -3471,6 +4239,7 @@ Initialize(
 	 * an alternate [tkInit] command before calling Tk_Init().
 	 */
 
+	TkRecordStartupPhase("library");
 	code = Tcl_EvalEx(interp,
 "if {[namespace which -command tkInit] eq \"\"} {\n\
   proc tkInit {} {\n\
@@ -3488,6 +4257,7 @@ tkInit", TCL_INDEX_NONE, TCL_EVAL_GLOBAL);
 	 * specific cleanups take place to avoid panics in finalization.
 	 */
 
+	TkRecordStartupPhase("initdone");
 	TkCreateThreadExitHandler(DeleteWindowsExitProc, tsdPtr);
     }
   done:
@@ -24,11 +24,12 @@
 typedef struct
 {
     WidgetCore		*owner; 	/* Widget that currently has cursor */
-    Tcl_TimerToken	timer;		/* Blink timer */
     int 		onTime;		/* #milliseconds to blink cursor on */
     int 		offTime;	/* #milliseconds to blink cursor off */
 } CursorManager;
 
+static void CursorBlinkProc(void *clientData, int on);
+
 /* CursorManagerDeleteProc --
  * 	InterpDeleteProc for cursor manager.
  */
@@ -38,9 +39,7 @@ static void CursorManagerDeleteProc(
 {
     CursorManager *cm = (CursorManager*)clientData;
 
-    if (cm->timer) {
-	Tcl_DeleteTimerHandler(cm->timer);
-    }
+    TkBlinkRemove(CursorBlinkProc, cm);
     ckfree(clientData);
 }
 
@@ -57,7 +56,6 @@ static CursorManager *GetCursorManager(Tcl_Interp *interp)
 
     if (!cm) {
 	cm = (CursorManager *)ckalloc(sizeof(*cm));
-	cm->timer = 0;
 	cm->owner = 0;
 	cm->onTime = DEF_CURSOR_ON_TIME;
 	cm->offTime = DEF_CURSOR_OFF_TIME;
@@ -88,22 +86,23 @@ static CursorManager *GetCursorManager(Tcl_Interp *interp)
 }
 
 /* CursorBlinkProc --
- *	Timer handler to blink the insert cursor on and off.
+ *	Callback from the shared blink timer (see tkBlink.c) to blink
+ *	the insert cursor on and off.
  */
 static void
-CursorBlinkProc(void *clientData)
+CursorBlinkProc(void *clientData, int on)
 {
     CursorManager *cm = (CursorManager *)clientData;
-    int blinkTime;
 
-    if (cm->owner->flags & CURSOR_ON) {
-	cm->owner->flags &= ~CURSOR_ON;
-	blinkTime = cm->offTime;
-    } else {
+    if (!cm->owner) {
+	TkBlinkRemove(CursorBlinkProc, cm);
+	return;
+    }
+    if (on) {
 	cm->owner->flags |= CURSOR_ON;
-	blinkTime = cm->onTime;
+    } else {
+	cm->owner->flags &= ~CURSOR_ON;
     }
-    cm->timer = Tcl_CreateTimerHandler(blinkTime, CursorBlinkProc, clientData);
     TtkRedisplayWidget(cm->owner);
 }
 
@@ -119,10 +118,7 @@ static void LoseCursor(CursorManager *cm, WidgetCore *corePtr)
     if (cm->owner == corePtr) {
 	cm->owner = NULL;
     }
-    if (cm->timer) {
-	Tcl_DeleteTimerHandler(cm->timer);
-	cm->timer = 0;
-    }
+    TkBlinkRemove(CursorBlinkProc, cm);
 }
 
 /* ClaimCursor --
@@ -139,7 +135,7 @@ static void ClaimCursor(CursorManager *cm, WidgetCore *corePtr)
     TtkRedisplayWidget(corePtr);
 
     cm->owner = corePtr;
-    cm->timer = Tcl_CreateTimerHandler(cm->onTime, CursorBlinkProc, cm);
+    TkBlinkAdd(CursorBlinkProc, cm, cm->onTime, cm->offTime);
 }
 
 /*
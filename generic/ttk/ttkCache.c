@@ -26,6 +26,16 @@
  *
  * @@@ Colormap flashing on PseudoColor visuals is still possible,
  * but this will be a transient effect.
+ *
+ * Eviction: entries are stamped with a generation counter each time
+ * they are requested.  A sweep (Ttk_EvictCache) releases every entry
+ * not used since the previous sweep and starts a new generation;
+ * sweeps run on theme/style changes and when the entry count exceeds
+ * a budget, so switching themes releases the old theme's resources
+ * instead of pinning them until interp teardown.  Tk's own caches
+ * (tkFont.c, tkColor.c) keep doing the refcounting and sharing; each
+ * entry here holds exactly one pinning reference, so nothing is
+ * cached twice.
  */
 
 #include "tkInt.h"
@@ -35,15 +45,39 @@
 #include "tkWinInt.h"
 #endif
 
+/*
+ * Cache entry: one pinned resource plus the generation in which it was
+ * last requested.  'obj' is NULL for images and for entries recording
+ * a failed allocation (kept so the failure is reported only once).
+ */
+typedef struct {
+    Tcl_Obj	*obj;		/* Pinned font/color/border spec, or NULL */
+    Tk_Image	image;		/* Pinned image (image table only), or NULL */
+    unsigned	lastUsed;	/* cache->generation at the last request */
+} CacheEntry;
+
+enum CacheKind {
+    CACHE_FONT, CACHE_COLOR, CACHE_BORDER, CACHE_IMAGE
+};
+
+#define CACHE_BUDGET 512	/* #entries that triggers an early sweep */
+
 struct Ttk_ResourceCache_ {
     Tcl_Interp	  *interp;	/* Interpreter for error reporting */
     Tk_Window	  tkwin;	/* Cache window. */
-    Tcl_HashTable fontTable;	/* Entries: Tcl_Obj* holding FontObjs */
-    Tcl_HashTable colorTable;	/* Entries: Tcl_Obj* holding ColorObjs */
-    Tcl_HashTable borderTable;	/* Entries: Tcl_Obj* holding BorderObjs */
-    Tcl_HashTable imageTable;	/* Entries: Tk_Images */
+    Tcl_HashTable fontTable;	/* Entries: CacheEntry* (fonts) */
+    Tcl_HashTable colorTable;	/* Entries: CacheEntry* (colors) */
+    Tcl_HashTable borderTable;	/* Entries: CacheEntry* (borders) */
+    Tcl_HashTable imageTable;	/* Entries: CacheEntry* (images) */
 
     Tcl_HashTable namedColors;	/* Entries: RGB values as Tcl_StringObjs */
+
+    unsigned	generation;	/* Current eviction generation */
+    Tcl_Size	nEntries;	/* Total entries in the four tables */
+    Tcl_Size	budget;		/* Entry count that triggers a sweep */
+    size_t	hits;		/* Statistics: requests served from */
+    size_t	misses;		/* the cache / newly allocated / */
+    size_t	evictions;	/* released by sweeps */
 };
 
 /*
@@ -62,78 +96,142 @@ Ttk_ResourceCache Ttk_CreateResourceCache(Tcl_Interp *interp)
     Tcl_InitHashTable(&cache->imageTable, TCL_STRING_KEYS);
     Tcl_InitHashTable(&cache->namedColors, TCL_STRING_KEYS);
 
+    cache->generation = 1;
+    cache->nEntries = 0;
+    cache->budget = CACHE_BUDGET;
+    cache->hits = cache->misses = cache->evictions = 0;
+
     return cache;
 }
 
 /*
- * Ttk_ClearCache --
- * 	Release references to all cached resources.
+ * CacheTable --
+ * 	Map a CacheKind to the corresponding hash table.
  */
-static void Ttk_ClearCache(Ttk_ResourceCache cache)
+static Tcl_HashTable *CacheTable(Ttk_ResourceCache cache, int kind)
+{
+    switch (kind) {
+	case CACHE_FONT:	return &cache->fontTable;
+	case CACHE_COLOR:	return &cache->colorTable;
+	case CACHE_BORDER:	return &cache->borderTable;
+	default:		return &cache->imageTable;
+    }
+}
+
+/*
+ * FreeCacheResource --
+ * 	Release the pinning reference held by one cache entry.
+ */
+static void FreeCacheResource(
+    Ttk_ResourceCache cache, int kind, CacheEntry *entry)
 {
+    switch (kind) {
+	case CACHE_FONT:
+	    if (entry->obj) {
+		Tk_FreeFontFromObj(cache->tkwin, entry->obj);
+		Tcl_DecrRefCount(entry->obj);
+	    }
+	    break;
+	case CACHE_COLOR:
+	    if (entry->obj) {
+		Tk_FreeColorFromObj(cache->tkwin, entry->obj);
+		Tcl_DecrRefCount(entry->obj);
+	    }
+	    break;
+	case CACHE_BORDER:
+	    if (entry->obj) {
+		Tk_Free3DBorderFromObj(cache->tkwin, entry->obj);
+		Tcl_DecrRefCount(entry->obj);
+	    }
+	    break;
+	default:
+	    if (entry->image) {
+		Tk_FreeImage(entry->image);
+	    }
+	    break;
+    }
+}
+
+/*
+ * SweepTable --
+ * 	Release every entry of one table (all != 0), or just the entries
+ * 	not requested in the current generation (all == 0).
+ */
+static void SweepTable(Ttk_ResourceCache cache, int kind, int all)
+{
+    Tcl_HashTable *table = CacheTable(cache, kind);
     Tcl_HashSearch search;
     Tcl_HashEntry *entryPtr;
 
-    /*
-     * Free fonts:
-     */
-    entryPtr = Tcl_FirstHashEntry(&cache->fontTable, &search);
+    entryPtr = Tcl_FirstHashEntry(table, &search);
     while (entryPtr != NULL) {
-	Tcl_Obj *fontObj = (Tcl_Obj *)Tcl_GetHashValue(entryPtr);
-	if (fontObj) {
-	    Tk_FreeFontFromObj(cache->tkwin, fontObj);
-	    Tcl_DecrRefCount(fontObj);
+	CacheEntry *entry = (CacheEntry *)Tcl_GetHashValue(entryPtr);
+
+	if (all || entry->lastUsed != cache->generation) {
+	    FreeCacheResource(cache, kind, entry);
+	    ckfree(entry);
+	    Tcl_DeleteHashEntry(entryPtr);
+	    --cache->nEntries;
+	    if (!all) {
+		++cache->evictions;
+	    }
 	}
 	entryPtr = Tcl_NextHashEntry(&search);
     }
-    Tcl_DeleteHashTable(&cache->fontTable);
-    Tcl_InitHashTable(&cache->fontTable, TCL_STRING_KEYS);
+}
 
-    /*
-     * Free colors:
-     */
-    entryPtr = Tcl_FirstHashEntry(&cache->colorTable, &search);
-    while (entryPtr != NULL) {
-	Tcl_Obj *colorObj = (Tcl_Obj *)Tcl_GetHashValue(entryPtr);
-	if (colorObj) {
-	    Tk_FreeColorFromObj(cache->tkwin, colorObj);
-	    Tcl_DecrRefCount(colorObj);
-	}
-	entryPtr = Tcl_NextHashEntry(&search);
-    }
-    Tcl_DeleteHashTable(&cache->colorTable);
-    Tcl_InitHashTable(&cache->colorTable, TCL_STRING_KEYS);
+/*
+ * Ttk_ClearCache --
+ * 	Release references to all cached resources.
+ */
+static void Ttk_ClearCache(Ttk_ResourceCache cache)
+{
+    int kind;
 
-    /*
-     * Free borders:
-     */
-    entryPtr = Tcl_FirstHashEntry(&cache->borderTable, &search);
-    while (entryPtr != NULL) {
-	Tcl_Obj *borderObj = (Tcl_Obj *)Tcl_GetHashValue(entryPtr);
-	if (borderObj) {
-	    Tk_Free3DBorderFromObj(cache->tkwin, borderObj);
-	    Tcl_DecrRefCount(borderObj);
-	}
-	entryPtr = Tcl_NextHashEntry(&search);
+    for (kind = CACHE_FONT; kind <= CACHE_IMAGE; ++kind) {
+	SweepTable(cache, kind, 1);
     }
-    Tcl_DeleteHashTable(&cache->borderTable);
-    Tcl_InitHashTable(&cache->borderTable, TCL_STRING_KEYS);
+}
 
-    /*
-     * Free images:
-     */
-    entryPtr = Tcl_FirstHashEntry(&cache->imageTable, &search);
-    while (entryPtr != NULL) {
-	Tk_Image image = (Tk_Image)Tcl_GetHashValue(entryPtr);
-	if (image) {
-	    Tk_FreeImage(image);
-	}
-	entryPtr = Tcl_NextHashEntry(&search);
+/*
+ * Ttk_EvictCache --
+ * 	Release the cache entries that have not been requested since the
+ * 	previous sweep, and start a new generation.  Called on theme and
+ * 	style changes, and from the allocation path when the entry count
+ * 	exceeds the budget, so the cache stays bounded on long-running
+ * 	applications that switch themes.
+ */
+void Ttk_EvictCache(Ttk_ResourceCache cache)
+{
+    int kind;
+
+    for (kind = CACHE_FONT; kind <= CACHE_IMAGE; ++kind) {
+	SweepTable(cache, kind, 0);
     }
-    Tcl_DeleteHashTable(&cache->imageTable);
-    Tcl_InitHashTable(&cache->imageTable, TCL_STRING_KEYS);
+    ++cache->generation;
+}
 
-    return;
+/*
+ * Ttk_CacheStatsObj --
+ * 	Return cache statistics as a list of name/value pairs
+ * 	(for [ttk::style cachestats]).
+ */
+Tcl_Obj *Ttk_CacheStatsObj(Ttk_ResourceCache cache)
+{
+    Tcl_Obj *result = Tcl_NewListObj(0, NULL);
+#define REPORT(name, value)     Tcl_ListObjAppendElement(NULL, result, Tcl_NewStringObj(name, -1));     Tcl_ListObjAppendElement(NULL, result, Tcl_NewWideIntObj(value))
+
+    REPORT("fonts", cache->fontTable.numEntries);
+    REPORT("colors", cache->colorTable.numEntries);
+    REPORT("borders", cache->borderTable.numEntries);
+    REPORT("images", cache->imageTable.numEntries);
+    REPORT("budget", cache->budget);
+    REPORT("generation", cache->generation);
+    REPORT("hits", (Tcl_WideInt)cache->hits);
+    REPORT("misses", (Tcl_WideInt)cache->misses);
+    REPORT("evictions", (Tcl_WideInt)cache->evictions);
+#undef REPORT
+    return result;
 }
 
 /*
@@ -150,6 +248,7 @@ void Ttk_FreeResourceCache(Ttk_ResourceCache cache)
 
     Tcl_DeleteHashTable(&cache->colorTable);
     Tcl_DeleteHashTable(&cache->fontTable);
+    Tcl_DeleteHashTable(&cache->borderTable);
     Tcl_DeleteHashTable(&cache->imageTable);
 
     /*
@@ -259,33 +358,47 @@ static void *AllocBorder(Tcl_Interp *interp, Tk_Window tkwin, Tcl_Obj *objPtr) {
 }
 
 static Tcl_Obj *Ttk_Use(
-    Tcl_Interp *interp,
-    Tcl_HashTable *table,
+    Ttk_ResourceCache cache,
+    int kind,
     Allocator allocate,
     Tk_Window tkwin,
     Tcl_Obj *objPtr)
 {
     int newEntry;
-    Tcl_HashEntry *entryPtr =
-	Tcl_CreateHashEntry(table,Tcl_GetString(objPtr),&newEntry);
+    Tcl_HashEntry *entryPtr;
+    CacheEntry *entry;
     Tcl_Obj *cacheObj;
 
+    if (cache->nEntries >= cache->budget) {
+	Ttk_EvictCache(cache);
+    }
+
+    entryPtr = Tcl_CreateHashEntry(
+	CacheTable(cache, kind), Tcl_GetString(objPtr), &newEntry);
     if (!newEntry) {
-	return (Tcl_Obj *)Tcl_GetHashValue(entryPtr);
+	entry = (CacheEntry *)Tcl_GetHashValue(entryPtr);
+	entry->lastUsed = cache->generation;
+	++cache->hits;
+	return entry->obj;
     }
+    ++cache->misses;
+    ++cache->nEntries;
+    entry = (CacheEntry *)ckalloc(sizeof(*entry));
+    entry->obj = NULL;
+    entry->image = NULL;
+    entry->lastUsed = cache->generation;
+    Tcl_SetHashValue(entryPtr, entry);
 
     cacheObj = Tcl_DuplicateObj(objPtr);
     Tcl_IncrRefCount(cacheObj);
 
-    if (allocate(interp, tkwin, cacheObj)) {
-	Tcl_SetHashValue(entryPtr, cacheObj);
-	return cacheObj;
+    if (allocate(cache->interp, tkwin, cacheObj)) {
+	entry->obj = cacheObj;
     } else {
 	Tcl_DecrRefCount(cacheObj);
-	Tcl_SetHashValue(entryPtr, NULL);
-	Tcl_BackgroundException(interp, TCL_ERROR);
-	return NULL;
+	Tcl_BackgroundException(cache->interp, TCL_ERROR);
     }
+    return entry->obj;
 }
 
 /*
@@ -295,8 +408,7 @@ static Tcl_Obj *Ttk_Use(
 Tcl_Obj *Ttk_UseFont(Ttk_ResourceCache cache, Tk_Window tkwin, Tcl_Obj *objPtr)
 {
     InitCacheWindow(cache, tkwin);
-    return Ttk_Use(cache->interp,
-	&cache->fontTable, AllocFont, tkwin, objPtr);
+    return Ttk_Use(cache, CACHE_FONT, AllocFont, tkwin, objPtr);
 }
 
 /*
@@ -307,8 +419,7 @@ Tcl_Obj *Ttk_UseColor(Ttk_ResourceCache cache, Tk_Window tkwin, Tcl_Obj *objPtr)
 {
     objPtr = CheckNamedColor(cache, objPtr);
     InitCacheWindow(cache, tkwin);
-    return Ttk_Use(cache->interp,
-	&cache->colorTable, AllocColor, tkwin, objPtr);
+    return Ttk_Use(cache, CACHE_COLOR, AllocColor, tkwin, objPtr);
 }
 
 /*
@@ -320,8 +431,7 @@ Tcl_Obj *Ttk_UseBorder(
 {
     objPtr = CheckNamedColor(cache, objPtr);
     InitCacheWindow(cache, tkwin);
-    return Ttk_Use(cache->interp,
-	&cache->borderTable, AllocBorder, tkwin, objPtr);
+    return Ttk_Use(cache, CACHE_BORDER, AllocBorder, tkwin, objPtr);
 }
 
 /* NullImageChanged --
@@ -347,24 +457,36 @@ Tk_Image Ttk_UseImage(Ttk_ResourceCache cache, Tk_Window tkwin, Tcl_Obj *objPtr)
 {
     const char *imageName = Tcl_GetString(objPtr);
     int newEntry;
-    Tcl_HashEntry *entryPtr =
-	Tcl_CreateHashEntry(&cache->imageTable,imageName,&newEntry);
-    Tk_Image image;
+    Tcl_HashEntry *entryPtr;
+    CacheEntry *entry;
 
     InitCacheWindow(cache, tkwin);
 
-    if (!newEntry) {
-	return (Tk_Image)Tcl_GetHashValue(entryPtr);
+    if (cache->nEntries >= cache->budget) {
+	Ttk_EvictCache(cache);
     }
 
-    image = Tk_GetImage(cache->interp, tkwin, imageName, NullImageChanged,0);
-    Tcl_SetHashValue(entryPtr, image);
-
-    if (!image) {
+    entryPtr = Tcl_CreateHashEntry(&cache->imageTable, imageName, &newEntry);
+    if (!newEntry) {
+	entry = (CacheEntry *)Tcl_GetHashValue(entryPtr);
+	entry->lastUsed = cache->generation;
+	++cache->hits;
+	return entry->image;
+    }
+    ++cache->misses;
+    ++cache->nEntries;
+    entry = (CacheEntry *)ckalloc(sizeof(*entry));
+    entry->obj = NULL;
+    entry->lastUsed = cache->generation;
+    Tcl_SetHashValue(entryPtr, entry);
+
+    entry->image = Tk_GetImage(cache->interp, tkwin, imageName,
+	    NullImageChanged, 0);
+    if (!entry->image) {
 	Tcl_BackgroundException(cache->interp, TCL_ERROR);
     }
 
-    return image;
+    return entry->image;
 }
 
 /*EOF*/
@@ -62,29 +62,74 @@ static void DrawSmoothBorder(
     int x1 = b.x, x2 = b.x + b.width - 1;
     int y1 = b.y, y2 = b.y + b.height - 1;
     const int w = WIN32_XDRAWLINE_HACK;
+    XSegment segs[4];
     GC gc;
 
     if (   outerColorObj
 	&& (gc=Ttk_GCForColor(tkwin,outerColorObj,d)))
     {
-	XDrawLine(display,d,gc, x1+1,y1, x2-1+w,y1);		/* N */
-	XDrawLine(display,d,gc, x1+1,y2, x2-1+w,y2);		/* S */
-	XDrawLine(display,d,gc, x1,y1+1, x1,y2-1+w);		/* W */
-	XDrawLine(display,d,gc, x2,y1+1, x2,y2-1+w);		/* E */
+	segs[0].x1 = x1+1; segs[0].y1 = y1;
+	segs[0].x2 = x2-1+w; segs[0].y2 = y1;			/* N */
+	segs[1].x1 = x1+1; segs[1].y1 = y2;
+	segs[1].x2 = x2-1+w; segs[1].y2 = y2;			/* S */
+	segs[2].x1 = x1; segs[2].y1 = y1+1;
+	segs[2].x2 = x1; segs[2].y2 = y2-1+w;			/* W */
+	segs[3].x1 = x2; segs[3].y1 = y1+1;
+	segs[3].x2 = x2; segs[3].y2 = y2-1+w;			/* E */
+	XDrawSegments(display, d, gc, segs, 4);
     }
 
     if (   upperColorObj
 	&& (gc=Ttk_GCForColor(tkwin,upperColorObj,d)))
     {
-	XDrawLine(display,d,gc, x1+1,y1+1, x2-1+w,y1+1);	/* N */
-	XDrawLine(display,d,gc, x1+1,y1+1, x1+1,y2-1);		/* W */
+	segs[0].x1 = x1+1; segs[0].y1 = y1+1;
+	segs[0].x2 = x2-1+w; segs[0].y2 = y1+1;			/* N */
+	segs[1].x1 = x1+1; segs[1].y1 = y1+1;
+	segs[1].x2 = x1+1; segs[1].y2 = y2-1;			/* W */
+	XDrawSegments(display, d, gc, segs, 2);
     }
 
     if (   lowerColorObj
 	&& (gc=Ttk_GCForColor(tkwin,lowerColorObj,d)))
     {
-	XDrawLine(display,d,gc, x2-1,y2-1, x1+1-w,y2-1);	/* S */
-	XDrawLine(display,d,gc, x2-1,y2-1, x2-1,y1+1-w);	/* E */
+	segs[0].x1 = x2-1; segs[0].y1 = y2-1;
+	segs[0].x2 = x1+1-w; segs[0].y2 = y2-1;			/* S */
+	segs[1].x1 = x2-1; segs[1].y1 = y2-1;
+	segs[1].x2 = x2-1; segs[1].y2 = y1+1-w;			/* E */
+	XDrawSegments(display, d, gc, segs, 2);
+    }
+}
+
+/* DrawGripLines --
+ * 	Draw count parallel one-pixel lines, alternating between evenGC
+ * 	and oddGC, advancing by (dx,dy) per line.  The lines are batched
+ * 	into XDrawSegments requests per GC instead of one request each.
+ */
+#define GRIP_SEGMENTS 32
+
+static void DrawGripLines(
+    Display *display, Drawable d, GC evenGC, GC oddGC,
+    int x1, int y1, int x2, int y2, int dx, int dy, int count)
+{
+    XSegment segs[2][GRIP_SEGMENTS];
+    int nsegs[2] = {0, 0};
+    int i;
+
+    for (i = 0; i < count; ++i) {
+	int j = i & 1;
+	segs[j][nsegs[j]].x1 = x1; segs[j][nsegs[j]].y1 = y1;
+	segs[j][nsegs[j]].x2 = x2; segs[j][nsegs[j]].y2 = y2;
+	if (++nsegs[j] == GRIP_SEGMENTS) {
+	    XDrawSegments(display, d, j ? oddGC : evenGC, segs[j], nsegs[j]);
+	    nsegs[j] = 0;
+	}
+	x1 += dx; y1 += dy; x2 += dx; y2 += dy;
+    }
+    if (nsegs[0]) {
+	XDrawSegments(display, d, evenGC, segs[0], nsegs[0]);
+    }
+    if (nsegs[1]) {
+	XDrawSegments(display, d, oddGC, segs[1], nsegs[1]);
     }
 }
 
@@ -590,24 +635,19 @@ static void GripElementDraw(
     GC lightGC = Ttk_GCForColor(tkwin,grip->lightColorObj,d);
     GC darkGC = Ttk_GCForColor(tkwin,grip->borderColorObj,d);
     int gripPad = 1, gripSize = 0;
-    int i;
 
     Tk_GetPixelsFromObj(NULL, tkwin, grip->gripSizeObj, &gripSize);
 
     if (orient == TTK_ORIENT_HORIZONTAL) {
 	int x = b.x + (b.width - gripSize) / 2;
 	int y1 = b.y + gripPad, y2 = b.y + b.height - gripPad - 1 + w;
-	for (i=0; i<gripSize; ++i) {
-	    XDrawLine(Tk_Display(tkwin), d, (i&1)?lightGC:darkGC, x,y1, x,y2);
-	    ++x;
-	}
+	DrawGripLines(Tk_Display(tkwin), d, darkGC, lightGC,
+		x, y1, x, y2, 1, 0, gripSize);
     } else {
 	int y = b.y + (b.height - gripSize) / 2;
 	int x1 = b.x + gripPad, x2 = b.x + b.width - gripPad - 1 + w;
-	for (i=0; i<gripSize; ++i) {
-	    XDrawLine(Tk_Display(tkwin), d, (i&1)?lightGC:darkGC, x1,y, x2,y);
-	    ++y;
-	}
+	DrawGripLines(Tk_Display(tkwin), d, darkGC, lightGC,
+		x1, y, x2, y, 0, 1, gripSize);
     }
 }
 
@@ -714,7 +754,7 @@ static void ThumbElementDraw(
     int gripSize = 0;
     Ttk_Orient orient = TTK_ORIENT_HORIZONTAL;
     GC lightGC, darkGC;
-    int x1, y1, x2, y2, dx, dy, i;
+    int x1, y1, x2, y2, dx, dy;
     const int w = WIN32_XDRAWLINE_HACK;
 
     DrawSmoothBorder(tkwin, d, b,
@@ -743,11 +783,8 @@ static void ThumbElementDraw(
 	x2 = b.x + b.width - 3 + w;
     }
 
-    for (i=0; i<gripSize; ++i) {
-	XDrawLine(Tk_Display(tkwin), d, (i&1)?lightGC:darkGC, x1,y1, x2,y2);
-	x1 += dx; x2 += dx; y1 += dy; y2 += dy;
-
-    }
+    DrawGripLines(Tk_Display(tkwin), d, darkGC, lightGC,
+	    x1, y1, x2, y2, dx, dy, gripSize);
 }
 
 static const Ttk_ElementSpec ThumbElementSpec = {
@@ -1206,6 +1243,15 @@ TtkClamTheme_Init(Tcl_Interp *interp)
         return TCL_ERROR;
     }
 
+    /*
+     * State bits the element code below draws from directly; the rest
+     * is map-driven:
+     */
+    Ttk_SetThemeDirectStateMask(theme,
+	    TTK_STATE_FOCUS | TTK_STATE_SELECTED | TTK_STATE_ALTERNATE
+	    | TTK_STATE_DISABLED | TTK_STATE_INVALID
+	    | TTK_STATE_USER1 | TTK_STATE_USER2);	/* tree open/leaf */
+
     Ttk_RegisterElement(interp, theme, "border",
 	    &BorderElementSpec, NULL);
     Ttk_RegisterElement(interp, theme, "field",
@@ -852,6 +852,15 @@ MODULE_SCOPE int TtkClassicTheme_Init(Tcl_Interp *interp)
 	return TCL_ERROR;
     }
 
+    /*
+     * State bits the element code below draws from directly; the rest
+     * is map-driven:
+     */
+    Ttk_SetThemeDirectStateMask(theme,
+	    TTK_STATE_FOCUS | TTK_STATE_SELECTED | TTK_STATE_ALTERNATE
+	    | TTK_STATE_DISABLED | TTK_STATE_INVALID
+	    | TTK_STATE_USER1 | TTK_STATE_USER2);	/* tree open/leaf */
+
     /*
      * Register elements:
      */
@@ -376,14 +376,20 @@ static void FieldElementDraw(
 	    int x1 = b.x, x2 = b.x + b.width - 1;
 	    int y1 = b.y, y2 = b.y + b.height - 1;
 	    int w = WIN32_XDRAWLINE_HACK;
+	    XSegment segs[4];
 
 	    /*
 	     * Draw the outer rounded rectangle
 	     */
-	    XDrawLine(disp, d, focusGC, x1+1, y1, x2-1+w, y1);	/* N */
-	    XDrawLine(disp, d, focusGC, x1+1, y2, x2-1+w, y2);	/* S */
-	    XDrawLine(disp, d, focusGC, x1, y1+1, x1, y2-1+w);	/* W */
-	    XDrawLine(disp, d, focusGC, x2, y1+1, x2, y2-1+w);	/* E */
+	    segs[0].x1 = x1+1; segs[0].y1 = y1;
+	    segs[0].x2 = x2-1+w; segs[0].y2 = y1;		/* N */
+	    segs[1].x1 = x1+1; segs[1].y1 = y2;
+	    segs[1].x2 = x2-1+w; segs[1].y2 = y2;		/* S */
+	    segs[2].x1 = x1; segs[2].y1 = y1+1;
+	    segs[2].x2 = x1; segs[2].y2 = y2-1+w;		/* W */
+	    segs[3].x1 = x2; segs[3].y1 = y1+1;
+	    segs[3].x2 = x2; segs[3].y2 = y2-1+w;		/* E */
+	    XDrawSegments(disp, d, focusGC, segs, 4);
 
 	    /*
 	     * Draw the inner rectangle
@@ -1300,6 +1306,15 @@ MODULE_SCOPE int TtkAltTheme_Init(Tcl_Interp *interp)
 	return TCL_ERROR;
     }
 
+    /*
+     * State bits the element code below draws from directly; the rest
+     * is map-driven:
+     */
+    Ttk_SetThemeDirectStateMask(theme,
+	    TTK_STATE_FOCUS | TTK_STATE_SELECTED | TTK_STATE_ALTERNATE
+	    | TTK_STATE_DISABLED | TTK_STATE_OPEN | TTK_STATE_LEAF
+	    | TTK_STATE_INVALID);
+
     Ttk_RegisterElement(interp, theme, "border", &BorderElementSpec, NULL);
 
     Ttk_RegisterElement(interp, theme, "Checkbutton.indicator",
@@ -87,6 +87,16 @@ static void FillElementDraw(
     BackgroundElement *bg = (BackgroundElement *)elementRecord;
     Tk_3DBorder backgroundPtr = Tk_Get3DBorderFromObj(tkwin,bg->backgroundObj);
 
+    /*
+     * Skip the fill where opaque children cover it completely: in a deep
+     * hierarchy of themed containers the background of every level would
+     * otherwise be painted under every pixel.
+     */
+    if (TkWindowAreaObscured((TkWindow *)tkwin,
+	    b.x, b.y, b.x + b.width, b.y + b.height)) {
+	return;
+    }
+
     XFillRectangle(Tk_Display(tkwin), d,
 	Tk_3DBorderGC(tkwin, backgroundPtr, TK_3D_FLAT_GC),
 	b.x, b.y, b.width, b.height);
@@ -1872,6 +1882,15 @@ void TtkElements_Init(Tcl_Interp *interp)
 {
     Ttk_Theme theme =  Ttk_GetDefaultTheme(interp);
 
+    /*
+     * Only these bits are drawn from directly (focus ring, indicator
+     * glyphs); all other state handling goes through [ttk::style map]:
+     */
+    Ttk_SetThemeDirectStateMask(theme,
+	    TTK_STATE_FOCUS | TTK_STATE_SELECTED | TTK_STATE_ALTERNATE
+	    | TTK_STATE_DISABLED | TTK_STATE_INVALID
+	    | TTK_STATE_USER1 | TTK_STATE_USER2);	/* tree open/leaf */
+
     /*
      * Elements:
      */
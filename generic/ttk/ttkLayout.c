@@ -527,6 +527,15 @@ struct Ttk_LayoutNode_
     Ttk_State 	 	state;		/* Current state */
     Ttk_Box 		parcel;		/* allocated parcel */
     Ttk_LayoutNode	*next, *child;
+
+    /* Cached element geometry; valid while cacheEpoch matches
+     * TtkStyleCacheEpoch() and cacheState matches the queried state.
+     * cacheEpoch 0 means empty.
+     */
+    size_t		cacheEpoch;
+    Ttk_State		cacheState;
+    int			cacheWidth, cacheHeight;
+    Ttk_Padding		cachePadding;
 };
 
 static Ttk_LayoutNode *Ttk_NewLayoutNode(
@@ -539,6 +548,7 @@ static Ttk_LayoutNode *Ttk_NewLayoutNode(
     node->state = 0u;
     node->next = node->child = 0;
     node->parcel = Ttk_MakeBox(0,0,0,0);
+    node->cacheEpoch = 0;
 
     return node;
 }
@@ -942,11 +952,31 @@ Ttk_CreateSublayout(
 }
 
 /* Ttk_RebindSublayout --
- * 	Bind sublayout to new data source.
+ * 	Bind sublayout to new data source.  Element sizes may depend on
+ * 	the data source, so cached geometry is discarded.
  */
 void Ttk_RebindSublayout(Ttk_Layout layout, void *recordPtr)
 {
     layout->recordPtr = recordPtr;
+    TtkLayoutCacheInvalidate(layout);
+}
+
+/* TtkLayoutCacheInvalidate --
+ * 	Discard cached element geometry for all nodes in a layout.
+ * 	Called when the layout's data source (widget record) changes
+ * 	in a way the style cache epoch does not track.
+ */
+static void InvalidateNodeCache(Ttk_LayoutNode *node)
+{
+    for (; node; node = node->next) {
+	node->cacheEpoch = 0;
+	InvalidateNodeCache(node->child);
+    }
+}
+
+void TtkLayoutCacheInvalidate(Ttk_Layout layout)
+{
+    InvalidateNodeCache(layout->root);
 }
 
 /*
@@ -982,11 +1012,25 @@ static void Ttk_NodeSize(
 {
     int elementWidth, elementHeight, subWidth, subHeight;
     Ttk_Padding elementPadding;
-
-    Ttk_ElementSize(node->eclass,
-	layout->style, layout->recordPtr,layout->optionTable, layout->tkwin,
-	state|node->state,
-	&elementWidth, &elementHeight, &elementPadding);
+    size_t epoch = TtkStyleCacheEpoch();
+
+    if (node->cacheEpoch == epoch
+	    && node->cacheState == (state|node->state)) {
+	++TtkProfile.sizeCacheHits;
+	elementWidth = node->cacheWidth;
+	elementHeight = node->cacheHeight;
+	elementPadding = node->cachePadding;
+    } else {
+	Ttk_ElementSize(node->eclass,
+	    layout->style, layout->recordPtr,layout->optionTable,
+	    layout->tkwin, state|node->state,
+	    &elementWidth, &elementHeight, &elementPadding);
+	node->cacheEpoch = epoch;
+	node->cacheState = state|node->state;
+	node->cacheWidth = elementWidth;
+	node->cacheHeight = elementHeight;
+	node->cachePadding = elementPadding;
+    }
 
     Ttk_NodeListSize(layout,node->child,state,&subWidth,&subHeight);
     subWidth += Ttk_PaddingWidth(elementPadding);
@@ -1101,6 +1145,7 @@ static void Ttk_PlaceNodeList(
 
 void Ttk_PlaceLayout(Ttk_Layout layout, Ttk_State state, Ttk_Box b)
 {
+    ++TtkProfile.layoutsPlaced;
     Ttk_PlaceNodeList(layout, layout->root, state,  b);
 }
 
@@ -1138,6 +1183,7 @@ static void Ttk_DrawNodeList(
 
 void Ttk_DrawLayout(Ttk_Layout layout, Ttk_State state, Drawable d)
 {
+    ++TtkProfile.layoutsDrawn;
     Ttk_DrawNodeList(layout, state, layout->root, d);
 }
 
@@ -38,6 +38,8 @@ typedef struct
     Ttk_Padding	padding;
     Tcl_Obj 	*stickyObj;
     Ttk_Sticky	sticky;
+    Tcl_Obj	*createCommandObj;	/* Deferred pane creation script */
+    int 	created;		/* createCommandObj already run */
 
     /* Label options:
      */
@@ -78,6 +80,9 @@ static const Tk_OptionSpec PaneOptionSpecs[] =
 	offsetof(Tab,paddingObj), TCL_INDEX_NONE, 0, 0, GEOMETRY_CHANGED },
     {TK_OPTION_STRING, "-sticky", "sticky", "Sticky", "nsew",
 	offsetof(Tab,stickyObj), TCL_INDEX_NONE, 0, 0, GEOMETRY_CHANGED },
+    {TK_OPTION_STRING, "-createcommand", "createCommand", "CreateCommand",
+	NULL, offsetof(Tab,createCommandObj), TCL_INDEX_NONE,
+	TK_OPTION_NULL_OK, 0, 0 },
 
     WIDGET_INHERIT_OPTIONS(TabOptionSpecs)
 };
@@ -613,6 +618,44 @@ static void NotebookPlaceContents(void *recordPtr)
     }
 }
 
+/* ActivatePane --
+ * 	Run the pane's -createcommand the first time its tab is selected.
+ * 	The pane window's pathname is appended to the script, which is
+ * 	evaluated at global level; the script is expected to build the
+ * 	pane's contents.  Until then the pane costs only its (empty)
+ * 	container window, whose requested size serves as the size hint
+ * 	for notebook and tab row geometry.  Script errors are reported
+ * 	as background exceptions.
+ */
+static void ActivatePane(Notebook *nb, Tcl_Size index)
+{
+    Tab *tab = (Tab *)Ttk_ContentData(nb->notebook.mgr, index);
+    Tk_Window window = Ttk_ContentWindow(nb->notebook.mgr, index);
+    Tcl_Interp *interp = nb->core.interp;
+    Tcl_Obj *cmd;
+    int code;
+
+    if (!tab->createCommandObj || tab->created) {
+	return;
+    }
+    tab->created = 1;
+
+    cmd = Tcl_DuplicateObj(tab->createCommandObj);
+    Tcl_IncrRefCount(cmd);
+    if (Tcl_ListObjAppendElement(interp, cmd,
+	    Tcl_NewStringObj(Tk_PathName(window), TCL_INDEX_NONE)) != TCL_OK) {
+	Tcl_DecrRefCount(cmd);
+	return;
+    }
+    code = Tcl_EvalObjEx(interp, cmd, TCL_EVAL_GLOBAL);
+    Tcl_DecrRefCount(cmd);
+    if (code != TCL_OK) {
+	Tcl_AddErrorInfo(interp, "\n    (-createcommand callback)");
+	Tcl_BackgroundException(interp, code);
+    }
+    Tcl_ResetResult(interp);
+}
+
 /*
  * SelectTab(nb, index) --
  * 	Change the currently-selected tab.
@@ -636,6 +679,16 @@ static void SelectTab(Notebook *nb, Tcl_Size index)
 	tab->state = TAB_STATE_NORMAL;
     }
 
+    /* Build deferred pane contents before placing the pane.
+     * The callback may destroy the notebook or reselect; bail out if so.
+     */
+    ActivatePane(nb, index);
+    if (WidgetDestroyed(&nb->core)
+	    || nb->notebook.currentIndex != currentIndex
+	    || index >= Ttk_NumberContent(nb->notebook.mgr)) {
+	return;
+    }
+
     if (currentIndex >= 0) {
 	Ttk_UnmapContent(nb->notebook.mgr, currentIndex);
     }
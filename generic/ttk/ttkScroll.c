@@ -267,7 +267,10 @@ void TtkScrollTo(ScrollHandle h, int newFirst, int updateScrollInfo)
 
     if (newFirst != s->first) {
 	s->first = newFirst;
-	TtkRedisplayWidget(h->corePtr);
+	/* A pure scroll: the widget content itself is unchanged,
+	 * so the displayProc may reuse the previous frame.
+	 */
+	TtkScheduleRedisplay(h->corePtr);
     }
 }
 
@@ -24,8 +24,32 @@ struct TtkTagTable {
     int         	recordSize;	/* size of tag record */
     int 		nTags;		/* #tags defined so far */
     Tcl_HashTable	tags;		/* defined tags */
+    Tcl_HashTable	valuesCache;	/* KEY: tag set bitmask;
+					 * VALUE: merged tag record */
 };
 
+/* Each tag owns the bit (priority - 1) in a tag set bitmask, so a tag
+ * set with all priorities below TAGSET_MASK_BITS is identified by one
+ * word.  Merged records for such sets are cached in valuesCache until
+ * any tag is reconfigured or deleted; sets containing a higher-numbered
+ * tag fall back to the direct merge.
+ */
+#define TAGSET_MASK_BITS ((int)(CHAR_BIT * sizeof(void *) - 1))
+
+static void FlushValuesCache(Ttk_TagTable tagTable)
+{
+    Tcl_HashSearch search;
+    Tcl_HashEntry *entryPtr;
+
+    entryPtr = Tcl_FirstHashEntry(&tagTable->valuesCache, &search);
+    while (entryPtr != NULL) {
+	ckfree(Tcl_GetHashValue(entryPtr));
+	entryPtr = Tcl_NextHashEntry(&search);
+    }
+    Tcl_DeleteHashTable(&tagTable->valuesCache);
+    Tcl_InitHashTable(&tagTable->valuesCache, TCL_ONE_WORD_KEYS);
+}
+
 /*------------------------------------------------------------------------
  * +++ Tags.
  */
@@ -62,6 +86,7 @@ Ttk_TagTable Ttk_CreateTagTable(
     tagTable->recordSize = recordSize;
     tagTable->nTags = 0;
     Tcl_InitHashTable(&tagTable->tags, TCL_STRING_KEYS);
+    Tcl_InitHashTable(&tagTable->valuesCache, TCL_ONE_WORD_KEYS);
     return tagTable;
 }
 
@@ -77,6 +102,8 @@ void Ttk_DeleteTagTable(Ttk_TagTable tagTable)
     }
 
     Tcl_DeleteHashTable(&tagTable->tags);
+    FlushValuesCache(tagTable);
+    Tcl_DeleteHashTable(&tagTable->valuesCache);
     ckfree(tagTable);
 }
 
@@ -88,6 +115,7 @@ void Ttk_DeleteTagFromTable(Ttk_TagTable tagTable, Ttk_Tag tag)
     if (entryPtr != NULL) {
         DeleteTag(tagTable, tag);
         Tcl_DeleteHashEntry(entryPtr);
+	FlushValuesCache(tagTable);
     }
 }
 
@@ -290,6 +318,7 @@ int Ttk_ConfigureTag(
     Ttk_Tag tag,
     Tcl_Size objc, Tcl_Obj *const objv[])
 {
+    FlushValuesCache(tagTable);
     return Tk_SetOptions(
 	interp, tag->tagRecord, tagTable->optionTable,
 	objc, objv, tagTable->tkwin, NULL/*savedOptions*/, NULL/*mask*/);
@@ -314,7 +343,13 @@ void Ttk_TagSetDefaults(Ttk_TagTable tagTable, Ttk_Style style, void *record)
     }
 }
 
-void Ttk_TagSetValues(Ttk_TagTable tagTable, Ttk_TagSet tagSet, void *record)
+/* MergeTagSetValues --
+ * 	Compute the merged tag overlay for a tag set: for each option,
+ * 	the value from the highest-priority tag that sets it, or NULL.
+ * 	'record' must be zeroed by the caller.
+ */
+static void MergeTagSetValues(
+    Ttk_TagTable tagTable, Ttk_TagSet tagSet, void *record)
 {
     const int LOWEST_PRIORITY = 0x7FFFFFFF;
     int i, j;
@@ -334,6 +369,65 @@ void Ttk_TagSetValues(Ttk_TagTable tagTable, Ttk_TagSet tagSet, void *record)
     }
 }
 
+/* ApplyOverlay --
+ * 	Copy the non-NULL options of a merged overlay into 'record'.
+ */
+static void ApplyOverlay(Ttk_TagTable tagTable, void *overlay, void *record)
+{
+    int i;
+
+    for (i = 0; tagTable->optionSpecs[i].type != TK_OPTION_END; ++i) {
+	Tcl_Size offset = tagTable->optionSpecs[i].objOffset;
+	if (OBJ_AT(overlay, offset) != 0) {
+	    OBJ_AT(record, offset) = OBJ_AT(overlay, offset);
+	}
+    }
+}
+
+void Ttk_TagSetValues(Ttk_TagTable tagTable, Ttk_TagSet tagSet, void *record)
+{
+    uintptr_t mask = 0;
+    Tcl_HashEntry *entryPtr;
+    void *overlay;
+    int i, isNew;
+
+    if (tagSet->nTags == 0) {
+	return;
+    }
+
+    /* Identify the set by a bitmask of tag priorities, when they fit:
+     */
+    for (i = 0; i < tagSet->nTags; ++i) {
+	int bit = tagSet->tags[i]->priority - 1;
+	if (bit >= TAGSET_MASK_BITS) {
+	    mask = 0;
+	    break;
+	}
+	mask |= (uintptr_t)1 << bit;
+    }
+    if (mask == 0) {
+	void *scratch = ckalloc(tagTable->recordSize);
+
+	memset(scratch, 0, tagTable->recordSize);
+	MergeTagSetValues(tagTable, tagSet, scratch);
+	ApplyOverlay(tagTable, scratch, record);
+	ckfree(scratch);
+	return;
+    }
+
+    entryPtr = Tcl_CreateHashEntry(
+	    &tagTable->valuesCache, (void *)mask, &isNew);
+    if (isNew) {
+	overlay = ckalloc(tagTable->recordSize);
+	memset(overlay, 0, tagTable->recordSize);
+	MergeTagSetValues(tagTable, tagSet, overlay);
+	Tcl_SetHashValue(entryPtr, overlay);
+    } else {
+	overlay = Tcl_GetHashValue(entryPtr);
+    }
+    ApplyOverlay(tagTable, overlay, record);
+}
+
 void Ttk_TagSetApplyStyle(
     Ttk_TagTable tagTable, Ttk_Style style, Ttk_State state, void *record)
 {
@@ -25,6 +25,27 @@
  *
  */
 
+/*------------------------------------------------------------------------
+ * +++ Style cache epoch.
+ *
+ * Incremented whenever any style setting changes; cached element
+ * geometry (see Ttk_NodeSize in ttkLayout.c) is tagged with the epoch
+ * at which it was computed and discarded when the epoch has moved on.
+ * A single process-wide counter over-invalidates (any style change
+ * flushes all caches), but style changes are rare compared to redraws
+ * and the stale entries are simply recomputed on next use.
+ */
+static size_t styleEpoch = 1;
+
+/* Profiling counters for [ttk::style profile]:
+ */
+TtkProfileCounters TtkProfile;
+
+size_t TtkStyleCacheEpoch(void)
+{
+    return styleEpoch;
+}
+
 typedef struct Ttk_Style_
 {
     const char		*styleName;	/* points to hash table key */
@@ -33,8 +54,34 @@ typedef struct Ttk_Style_
     Ttk_LayoutTemplate	layoutTemplate;	/* Layout template for style, or NULL */
     Ttk_Style		parentStyle;	/* Previous style in chain */
     Ttk_ResourceCache	cache;		/* Back-pointer to resource cache */
+    Tcl_HashTable	mapCache;	/* KEY: string; VALUE: MapCache */
+    size_t		mapCacheEpoch;	/* styleEpoch mapCache was filled at */
 } Style;
 
+/* Resolved state map lookups (see Ttk_StyleMap):
+ */
+typedef struct {
+    Ttk_StateMap stateMap;	/* State map from the style chain, or NULL */
+    Tcl_HashTable values;	/* KEY: Ttk_State; VALUE: resolved Tcl_Obj*,
+				 * borrowed from stateMap */
+} MapCache;
+
+static void FlushMapCache(Style *stylePtr)
+{
+    Tcl_HashSearch search;
+    Tcl_HashEntry *entryPtr;
+
+    entryPtr = Tcl_FirstHashEntry(&stylePtr->mapCache, &search);
+    while (entryPtr != NULL) {
+	MapCache *mcPtr = (MapCache *)Tcl_GetHashValue(entryPtr);
+	Tcl_DeleteHashTable(&mcPtr->values);
+	ckfree(mcPtr);
+	entryPtr = Tcl_NextHashEntry(&search);
+    }
+    Tcl_DeleteHashTable(&stylePtr->mapCache);
+    Tcl_InitHashTable(&stylePtr->mapCache, TCL_STRING_KEYS);
+}
+
 static Style *NewStyle(void)
 {
     Style *stylePtr = (Style *)ckalloc(sizeof(Style));
@@ -45,6 +92,8 @@ static Style *NewStyle(void)
     stylePtr->cache = NULL;
     Tcl_InitHashTable(&stylePtr->settingsTable, TCL_STRING_KEYS);
     Tcl_InitHashTable(&stylePtr->defaultsTable, TCL_STRING_KEYS);
+    Tcl_InitHashTable(&stylePtr->mapCache, TCL_STRING_KEYS);
+    stylePtr->mapCacheEpoch = 0;
 
     return stylePtr;
 }
@@ -72,25 +121,65 @@ static void FreeStyle(Style *stylePtr)
 
     Ttk_FreeLayoutTemplate(stylePtr->layoutTemplate);
 
+    FlushMapCache(stylePtr);
+    Tcl_DeleteHashTable(&stylePtr->mapCache);
+
     ckfree(stylePtr);
 }
 
 /*
  * Ttk_StyleMap --
  * 	Look up state-specific option value from specified style.
+ *
+ * 	Resolutions are cached per (option, state) in style->mapCache,
+ * 	so the state-spec list is only scanned the first time a given
+ * 	state is seen.  Any style change bumps styleEpoch (ThemeChanged),
+ * 	which invalidates the cache lazily on next lookup; this also
+ * 	covers changes to maps inherited from the parent style chain.
  */
 Tcl_Obj *Ttk_StyleMap(Ttk_Style style, const char *optionName, Ttk_State state)
 {
-    while (style) {
-	Tcl_HashEntry *entryPtr =
-	    Tcl_FindHashEntry(&style->settingsTable, optionName);
-	if (entryPtr) {
-	    Ttk_StateMap stateMap = (Ttk_StateMap)Tcl_GetHashValue(entryPtr);
-	    return Ttk_StateMapLookup(NULL, stateMap, state);
+    Tcl_HashEntry *entryPtr;
+    MapCache *mcPtr;
+    int newEntry;
+
+    if (style->mapCacheEpoch != styleEpoch) {
+	FlushMapCache(style);
+	style->mapCacheEpoch = styleEpoch;
+    }
+
+    entryPtr = Tcl_CreateHashEntry(&style->mapCache, optionName, &newEntry);
+    if (newEntry) {
+	Ttk_Style stylePtr = style;
+	Ttk_StateMap stateMap = NULL;
+
+	while (stylePtr) {
+	    Tcl_HashEntry *settingPtr =
+		Tcl_FindHashEntry(&stylePtr->settingsTable, optionName);
+	    if (settingPtr) {
+		stateMap = (Ttk_StateMap)Tcl_GetHashValue(settingPtr);
+		break;
+	    }
+	    stylePtr = stylePtr->parentStyle;
 	}
-	style = style->parentStyle;
+	mcPtr = (MapCache *)ckalloc(sizeof(MapCache));
+	mcPtr->stateMap = stateMap;
+	Tcl_InitHashTable(&mcPtr->values, TCL_ONE_WORD_KEYS);
+	Tcl_SetHashValue(entryPtr, mcPtr);
+    } else {
+	mcPtr = (MapCache *)Tcl_GetHashValue(entryPtr);
     }
-    return 0;
+
+    if (!mcPtr->stateMap) {
+	return 0;
+    }
+
+    entryPtr = Tcl_CreateHashEntry(&mcPtr->values, INT2PTR(state), &newEntry);
+    if (newEntry) {
+	Tcl_SetHashValue(entryPtr,
+	    Ttk_StateMapLookup(NULL, mcPtr->stateMap, state));
+    }
+    return (Tcl_Obj *)Tcl_GetHashValue(entryPtr);
 }
 
 /*
@@ -123,6 +212,7 @@ struct Ttk_ElementClass_ {
     int nResources;		/* #Element options */
     Tcl_Obj **defaultValues;	/* Array of option default values */
     Tcl_HashTable optMapCache;	/* Map: Tk_OptionTable * -> OptionMap */
+    Tcl_HashTable snapshotCache;/* Map: (style, state) -> StyleSnapshot */
 };
 
 /* TTKGetOptionSpec --
@@ -210,6 +300,89 @@ GetOptionMap(Ttk_ElementClass *elementClass, Tk_OptionTable optionTable)
     return optionMap;
 }
 
+/*------------------------------------------------------------------------
+ * +++ Style resolution snapshots.
+ *
+ * The style-level resolution of an element option -- state map hit,
+ * else style default, else the element's registration default --
+ * depends only on (style, state), never on the widget, and can only
+ * change when styleEpoch is bumped.  So the resolved values are
+ * snapshotted per (style, state) on the element class: drawing an
+ * element then costs one hash lookup per frame plus an array index
+ * per option, instead of a map cache lookup and a defaults chain walk
+ * per option.  Each snapshot owns a reference to every value, so
+ * reconfiguring a style cannot pull a captured value out from under a
+ * redraw in progress; stale snapshots are re-resolved on next use.
+ */
+
+typedef struct {			/* Hash key; zero the padding! */
+    Ttk_Style style;
+    Ttk_State state;
+} SnapshotKey;
+
+typedef struct {
+    size_t epoch;		/* styleEpoch the values were resolved at */
+    Tcl_Obj **values;		/* Per-resource resolved value (refcounted),
+				 * or NULL where only the widget record can
+				 * supply one */
+} StyleSnapshot;
+
+/* GetStyleSnapshot --
+ * 	Return the resolved element option values for (style, state),
+ * 	creating or refreshing the snapshot if the style epoch has
+ * 	moved on.
+ */
+static StyleSnapshot *
+GetStyleSnapshot(Ttk_ElementClass *eclass, Ttk_Style style, Ttk_State state)
+{
+    SnapshotKey key;
+    Tcl_HashEntry *entryPtr;
+    StyleSnapshot *snapshot;
+    int isNew, i;
+
+    memset(&key, 0, sizeof(key));
+    key.style = style;
+    key.state = state;
+    entryPtr = Tcl_CreateHashEntry(
+	    &eclass->snapshotCache, (void *)&key, &isNew);
+    if (isNew) {
+	snapshot = (StyleSnapshot *)ckalloc(sizeof(StyleSnapshot));
+	snapshot->values = (Tcl_Obj **)
+		ckalloc(eclass->nResources * sizeof(Tcl_Obj *) + 1);
+	Tcl_SetHashValue(entryPtr, snapshot);
+    } else {
+	snapshot = (StyleSnapshot *)Tcl_GetHashValue(entryPtr);
+	if (snapshot->epoch == TtkStyleCacheEpoch()) {
+	    ++TtkProfile.snapshotHits;
+	    return snapshot;
+	}
+	for (i = 0; i < eclass->nResources; ++i) {
+	    if (snapshot->values[i]) {
+		Tcl_DecrRefCount(snapshot->values[i]);
+	    }
+	}
+    }
+
+    for (i = 0; i < eclass->nResources; ++i) {
+	const char *optionName = eclass->specPtr->options[i].optionName;
+	Tcl_Obj *value = Ttk_StyleMap(style, optionName, state);
+
+	if (!value) {
+	    value = Ttk_StyleDefault(style, optionName);
+	}
+	if (!value) {
+	    value = eclass->defaultValues[i];
+	}
+	if (value) {
+	    Tcl_IncrRefCount(value);
+	}
+	snapshot->values[i] = value;
+    }
+    snapshot->epoch = TtkStyleCacheEpoch();
+    ++TtkProfile.snapshotMisses;
+    return snapshot;
+}
+
 /*
  * NewElementClass --
  * 	Allocate and initialize an element class record
@@ -250,6 +423,11 @@ NewElementClass(const char *name, const Ttk_ElementSpec *specPtr, void *clientDa
      */
     Tcl_InitHashTable(&elementClass->optMapCache, TCL_ONE_WORD_KEYS);
 
+    /* Initialize style snapshot cache:
+     */
+    Tcl_InitHashTable(&elementClass->snapshotCache,
+	    sizeof(SnapshotKey)/sizeof(int));
+
     return elementClass;
 }
 
@@ -283,6 +461,24 @@ static void FreeElementClass(Ttk_ElementClass *elementClass)
     }
     Tcl_DeleteHashTable(&elementClass->optMapCache);
 
+    /*
+     * Free style snapshot cache:
+     */
+    entryPtr = Tcl_FirstHashEntry(&elementClass->snapshotCache, &search);
+    while (entryPtr != NULL) {
+	StyleSnapshot *snapshot = (StyleSnapshot *)Tcl_GetHashValue(entryPtr);
+
+	for (i = 0; i < elementClass->nResources; ++i) {
+	    if (snapshot->values[i]) {
+		Tcl_DecrRefCount(snapshot->values[i]);
+	    }
+	}
+	ckfree(snapshot->values);
+	ckfree(snapshot);
+	entryPtr = Tcl_NextHashEntry(&search);
+    }
+    Tcl_DeleteHashTable(&elementClass->snapshotCache);
+
     ckfree(elementClass->elementRecord);
     ckfree(elementClass);
 }
@@ -308,6 +504,10 @@ typedef struct Ttk_Theme_
     Ttk_ThemeEnabledProc *enabledProc;	/* Function called by SetTheme */
     void *enabledData;              	/* ClientData for enabledProc */
     Ttk_ResourceCache cache;		/* Back-pointer to resource cache */
+    Ttk_State directStateMask;		/* State bits the theme's element
+					 * code draws from directly, i.e.
+					 * not via [ttk::style map]; see
+					 * Ttk_StateChangeSignificant */
 } Theme;
 
 static Theme *NewTheme(Ttk_ResourceCache cache, Ttk_Theme parent)
@@ -320,6 +520,7 @@ static Theme *NewTheme(Ttk_ResourceCache cache, Ttk_Theme parent)
     themePtr->enabledProc = ThemeEnabled;
     themePtr->enabledData = NULL;
     themePtr->cache = cache;
+    themePtr->directStateMask = ~(Ttk_State)0;
     Tcl_InitHashTable(&themePtr->elementTable, TCL_STRING_KEYS);
     Tcl_InitHashTable(&themePtr->styleTable, TCL_STRING_KEYS);
 
@@ -517,6 +718,8 @@ static void ThemeChangedProc(void *clientData)
 static void ThemeChanged(StylePackageData *pkgPtr)
 {
     TtkSetBlinkCursorTimes(pkgPtr->interp);
+    ++styleEpoch;
+    Ttk_EvictCache(pkgPtr->cache);
 
     if (!pkgPtr->themeChangePending) {
 	Tcl_DoWhenIdle(ThemeChangedProc, pkgPtr);
@@ -641,6 +844,66 @@ Ttk_Theme Ttk_GetDefaultTheme(Tcl_Interp *interp)
     return pkgPtr->defaultTheme;
 }
 
+/*
+ * Ttk_SetThemeDirectStateMask --
+ *	Declare which state bits a theme's element implementations
+ *	consult directly when drawing (focus rings, indicator glyphs,
+ *	native engine part states, ...).  Everything else is assumed to
+ *	reach the screen only through [ttk::style map] resolutions.
+ *	The default is all bits, which disables the state-change
+ *	significance test below.
+ */
+void Ttk_SetThemeDirectStateMask(Ttk_Theme themePtr, Ttk_State mask)
+{
+    themePtr->directStateMask = mask;
+}
+
+/*
+ * Ttk_StateChangeSignificant --
+ *	Determine whether a widget state change can be visible at all:
+ *	either a changed bit is in the current theme's direct mask, or
+ *	some mapped option of the widget's style resolves differently
+ *	under the new state.  The resolutions come from the per-style
+ *	map cache (see Ttk_StyleMap), so this costs two cached lookups
+ *	per mapped option.  Used by TtkWidgetChangeState to skip the
+ *	redisplay entirely when nothing visible changed.
+ */
+int Ttk_StateChangeSignificant(
+    Tcl_Interp *interp,
+    Ttk_Style style,
+    Ttk_State oldState,
+    Ttk_State newState)
+{
+    Ttk_Theme themePtr = Ttk_GetCurrentTheme(interp);
+    Ttk_Style stylePtr;
+    Tcl_HashSearch search;
+    Tcl_HashEntry *entryPtr;
+
+    if ((oldState ^ newState) & themePtr->directStateMask) {
+	return 1;
+    }
+
+    /*
+     * Diff every mapped option visible from this style (closer styles
+     * override farther ones, but re-checking an overridden option just
+     * repeats the same resolution, so no deduplication is needed):
+     */
+    for (stylePtr = style; stylePtr; stylePtr = stylePtr->parentStyle) {
+	entryPtr = Tcl_FirstHashEntry(&stylePtr->settingsTable, &search);
+	while (entryPtr != NULL) {
+	    const char *optionName = (const char *)
+		    Tcl_GetHashKey(&stylePtr->settingsTable, entryPtr);
+
+	    if (Ttk_StyleMap(style, optionName, oldState)
+		    != Ttk_StyleMap(style, optionName, newState)) {
+		return 1;
+	    }
+	    entryPtr = Tcl_NextHashEntry(&search);
+	}
+    }
+    return 0;
+}
+
 /*
  * Ttk_UseTheme --
  * 	Set the current theme, notify all widgets that the theme has changed.
@@ -974,9 +1237,9 @@ static int AllocateResource(
  * 	Fill in the element record based on the element's option table.
  * 	Resources are initialized from:
  * 	the corresponding widget option if present and non-NULL,
- * 	otherwise the dynamic state map if specified,
- * 	otherwise from the corresponding widget resource if present,
- * 	otherwise the default value specified at registration time.
+ * 	otherwise the snapshotted style resolution for the current state
+ * 	(state map, then style default, then the default value specified
+ * 	at registration time; see GetStyleSnapshot).
  *
  * Returns:
  * 	1 if OK, 0 if an error is detected.
@@ -999,29 +1262,20 @@ int InitializeElementRecord(
     int nResources = eclass->nResources;
     Ttk_ResourceCache cache = style->cache;
     const Ttk_ElementOptionSpec *elementOption = eclass->specPtr->options;
+    StyleSnapshot *snapshot = GetStyleSnapshot(eclass, style, state);
 
     int i;
     for (i=0; i<nResources; ++i, ++elementOption) {
 	Tcl_Obj **dest = (Tcl_Obj **)
 	    ((char *)elementRecord + elementOption->offset);
-	const char *optionName = elementOption->optionName;
-	Tcl_Obj *dynamicSetting = Ttk_StyleMap(style, optionName, state);
 	Tcl_Obj *widgetValue = 0;
-	Tcl_Obj *elementDefault = eclass->defaultValues[i];
 
 	if (optionMap[i]) {
 	    widgetValue = *(Tcl_Obj **)
 		((char *)widgetRecord + optionMap[i]->objOffset);
 	}
 
-	if (widgetValue) {
-	    *dest = widgetValue;
-	} else if (dynamicSetting) {
-	    *dest = dynamicSetting;
-	} else {
-	    Tcl_Obj *styleDefault = Ttk_StyleDefault(style, optionName);
-	    *dest = styleDefault ? styleDefault : elementDefault;
-	}
+	*dest = widgetValue ? widgetValue : snapshot->values[i];
 
 	if (!AllocateResource(cache, tkwin, dest, elementOption->type)) {
 	    return 0;
@@ -1094,6 +1348,7 @@ Ttk_ElementSize(
     paddingPtr->left = paddingPtr->right = paddingPtr->top = paddingPtr->bottom
 	= *widthPtr = *heightPtr = 0;
 
+    ++TtkProfile.elementsSized;
     if (!InitializeElementRecord(
 	    eclass, style, recordPtr, optionTable, tkwin,  state))
     {
@@ -1122,6 +1377,7 @@ Ttk_DrawElement(
 {
     if (b.width <= 0 || b.height <= 0)
 	return;
+    ++TtkProfile.elementsDrawn;
     if (!InitializeElementRecord(
 	    eclass, style, recordPtr, optionTable, tkwin,  state))
     {
@@ -1680,6 +1936,63 @@ StyleThemeUseCmd(
     return Ttk_UseTheme(interp, theme);
 }
 
+/* + style cachestats --
+ * 	Report resource cache statistics.
+ */
+static int StyleCacheStatsCmd(
+    void *clientData,
+    Tcl_Interp *interp,
+    Tcl_Size objc,
+    Tcl_Obj *const objv[])
+{
+    StylePackageData *pkgPtr = (StylePackageData *)clientData;
+
+    if (objc != 2) {
+	Tcl_WrongNumArgs(interp, 2, objv, NULL);
+	return TCL_ERROR;
+    }
+    Tcl_SetObjResult(interp, Ttk_CacheStatsObj(pkgPtr->cache));
+    return TCL_OK;
+}
+
+/* + style profile ?reset? --
+ * 	Report the layout/draw profiling counters as a list of
+ * 	name/value pairs, or reset them.
+ */
+static int StyleProfileCmd(
+    TCL_UNUSED(void *),
+    Tcl_Interp *interp,
+    Tcl_Size objc,
+    Tcl_Obj *const objv[])
+{
+    Tcl_Obj *result;
+
+    if (objc == 3 && !strcmp(Tcl_GetString(objv[2]), "reset")) {
+	memset(&TtkProfile, 0, sizeof(TtkProfile));
+	return TCL_OK;
+    }
+    if (objc != 2) {
+	Tcl_WrongNumArgs(interp, 2, objv, "?reset?");
+	return TCL_ERROR;
+    }
+
+    result = Tcl_NewListObj(0, NULL);
+#define REPORT(name, value) \
+    Tcl_ListObjAppendElement(NULL, result, Tcl_NewStringObj(name, -1)); \
+    Tcl_ListObjAppendElement(NULL, result, \
+	    Tcl_NewWideIntObj((Tcl_WideInt)(value)))
+    REPORT("layouts", TtkProfile.layoutsPlaced);
+    REPORT("draws", TtkProfile.layoutsDrawn);
+    REPORT("elementsdrawn", TtkProfile.elementsDrawn);
+    REPORT("elementssized", TtkProfile.elementsSized);
+    REPORT("sizecachehits", TtkProfile.sizeCacheHits);
+    REPORT("snapshothits", TtkProfile.snapshotHits);
+    REPORT("snapshotmisses", TtkProfile.snapshotMisses);
+#undef REPORT
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
+
 /*
  * StyleObjCmd --
  *	Implementation of the [style] command.
@@ -1702,6 +2015,8 @@ static const Ttk_Ensemble StyleElementEnsemble[] = {
 };
 
 static const Ttk_Ensemble StyleEnsemble[] = {
+    { "cachestats", StyleCacheStatsCmd, 0 },
+    { "profile", StyleProfileCmd, 0 },
     { "configure", StyleConfigureCmd, 0 },
     { "map", StyleMapCmd, 0 },
     { "lookup", StyleLookupCmd, 0 },
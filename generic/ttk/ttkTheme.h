@@ -307,6 +307,10 @@ TTKAPI Ttk_Style Ttk_LayoutStyle(Ttk_Layout);
 TTKAPI Tcl_Obj *Ttk_StyleDefault(Ttk_Style, const char *optionName);
 TTKAPI Tcl_Obj *Ttk_StyleMap(Ttk_Style, const char *optionName, Ttk_State);
 
+MODULE_SCOPE void Ttk_SetThemeDirectStateMask(Ttk_Theme, Ttk_State);
+MODULE_SCOPE int Ttk_StateChangeSignificant(
+    Tcl_Interp *, Ttk_Style, Ttk_State oldState, Ttk_State newState);
+
 /*------------------------------------------------------------------------
  * +++ Resource cache.
  * 	See resource.c for explanation.
@@ -315,6 +319,24 @@ TTKAPI Tcl_Obj *Ttk_StyleMap(Ttk_Style, const char *optionName, Ttk_State);
 typedef struct Ttk_ResourceCache_ *Ttk_ResourceCache;
 MODULE_SCOPE Ttk_ResourceCache Ttk_CreateResourceCache(Tcl_Interp *);
 MODULE_SCOPE void Ttk_FreeResourceCache(Ttk_ResourceCache);
+MODULE_SCOPE void Ttk_EvictCache(Ttk_ResourceCache);
+MODULE_SCOPE Tcl_Obj *Ttk_CacheStatsObj(Ttk_ResourceCache);
+
+/*
+ * Layout/draw profiling counters (see [ttk::style profile]).
+ * Plain increments on the hot paths -- cheap enough to keep always on.
+ */
+typedef struct {
+    size_t layoutsPlaced;	/* Ttk_PlaceLayout calls */
+    size_t layoutsDrawn;	/* Ttk_DrawLayout calls */
+    size_t elementsDrawn;	/* element draw procs invoked */
+    size_t elementsSized;	/* element size procs invoked */
+    size_t sizeCacheHits;	/* node sizes served from the layout cache */
+    size_t snapshotHits;	/* style snapshots reused */
+    size_t snapshotMisses;	/* style snapshots (re)resolved */
+} TtkProfileCounters;
+
+MODULE_SCOPE TtkProfileCounters TtkProfile;
 
 MODULE_SCOPE Ttk_ResourceCache Ttk_GetResourceCache(Tcl_Interp*);
 MODULE_SCOPE Tcl_Obj *Ttk_UseFont(Ttk_ResourceCache, Tk_Window, Tcl_Obj *);
@@ -39,6 +39,9 @@ MODULE_SCOPE Ttk_LayoutTemplate Ttk_FindLayoutTemplate(
 
 MODULE_SCOPE const char *Ttk_StyleName(Ttk_Style);
 
+MODULE_SCOPE size_t TtkStyleCacheEpoch(void);
+MODULE_SCOPE void TtkLayoutCacheInvalidate(Ttk_Layout);
+
 MODULE_SCOPE void TtkSetBlinkCursorTimes(Tcl_Interp* interp);
 
 MODULE_SCOPE int TtkBoxEqual(Ttk_Box, Ttk_Box);
@@ -70,6 +70,9 @@ struct TreeItemRec {
      */
     Ttk_TagSet	tagset;
     Ttk_ImageSpec *imagespec;
+    Tcl_Obj	*sortKeyObj;	/* Cached [$tv sort] key, or NULL */
+    int		sortKeyEpoch;	/* Cache is valid iff this matches
+				 * tree.sortEpoch */
     int itemPos; 		/* Counting items */
     int visiblePos; 		/* Counting visible items */
     int rowPos;			/* Counting rows (visible physical space) */
@@ -136,6 +139,8 @@ static TreeItem *NewItem(void)
 
     item->tagset = NULL;
     item->imagespec = NULL;
+    item->sortKeyObj = NULL;
+    item->sortKeyEpoch = 0;
 
     return item;
 }
@@ -153,6 +158,7 @@ static void FreeItem(TreeItem *item)
     if (item->tagsObj) { Tcl_DecrRefCount(item->tagsObj); }
     if (item->selObj) { Tcl_DecrRefCount(item->selObj); }
     if (item->imageAnchorObj) { Tcl_DecrRefCount(item->imageAnchorObj); }
+    if (item->sortKeyObj) { Tcl_DecrRefCount(item->sortKeyObj); }
 
     if (item->tagset)	{ Ttk_FreeTagSet(item->tagset); }
     if (item->imagespec) { TtkFreeImageSpec(item->imagespec); }
@@ -288,6 +294,8 @@ typedef struct {
     int 	minWidth;	/* Minimum column width, in pixels */
     int 	stretch;	/* Should column stretch while resizing? */
     int         separator;      /* Should this column have a separator? */
+    int 	autofit;	/* Grow width to fit content? */
+    int 	autofitWidth;	/* Running max content width, in pixels */
     Tcl_Obj	*idObj;		/* Column identifier, from -columns option */
 
     Tcl_Obj	*anchorObj;	/* -anchor for cell data <<NOTE-ANCHOR>> */
@@ -314,6 +322,8 @@ static void InitColumn(TreeColumn *column)
     column->minWidth = atoi(DEF_MINWIDTH);
     column->stretch = 1;
     column->separator = 0;
+    column->autofit = 0;
+    column->autofitWidth = 0;
     column->idObj = 0;
     column->anchorObj = 0;
 
@@ -355,6 +365,9 @@ static const Tk_OptionSpec ColumnOptionSpecs[] = {
     {TK_OPTION_BOOLEAN, "-stretch", "stretch", "Stretch",
 	"1", TCL_INDEX_NONE, offsetof(TreeColumn,stretch),
 	0,0,GEOMETRY_CHANGED },
+    {TK_OPTION_BOOLEAN, "-autofit", "autofit", "Autofit",
+	"0", TCL_INDEX_NONE, offsetof(TreeColumn,autofit),
+	0,0,GEOMETRY_CHANGED },
     {TK_OPTION_ANCHOR, "-anchor", "anchor", "Anchor",
 	"w", offsetof(TreeColumn,anchorObj), TCL_INDEX_NONE,	/* <<NOTE-ANCHOR>> */
 	0,0,0 },
@@ -424,6 +437,25 @@ static int GetEnumSetFromObj(
     return TCL_OK;
 }
 
+/*
+ * Dirty-cell record (see TreeviewDisplay): a cell whose value changed
+ * since the last completed frame was saved, and which can therefore be
+ * repainted by itself on top of that frame.
+ */
+typedef struct {
+    TreeItem *item;
+    TreeColumn *column;
+} DirtyCell;
+
+/* An entry in the [$tv find] text index (see the type-ahead search
+ * section): items sorted by the case-folded text of one column, so
+ * that prefix queries are a binary search.
+ */
+typedef struct {
+    TreeItem *item;
+    char *folded;		/* Lowercased item text, ckalloc()d */
+} FindEntry;
+
 /*------------------------------------------------------------------------
  * +++ Treeview widget record.
  *
@@ -482,6 +514,7 @@ typedef struct {
     Tcl_Obj *showObj;		/* -show list */
     Tcl_Obj *selectModeObj;	/* -selectmode option */
     Tcl_Obj *selectTypeObj;	/* -selecttype option */
+    Tcl_Obj *dataCommandObj;	/* -datacommand option */
 
     Scrollable xscroll;
     ScrollHandle xscrollHandle;
@@ -498,10 +531,54 @@ typedef struct {
     int titleRows;		/* Height of non-scrolled items, in rows */
     int totalRows;		/* Height of non-hidden items, in rows */
     int rowPosNeedsUpdate;	/* Internal rowPos data needs update */
+    int batchInserting;		/* In [$tv insert ... -batch]; autofit
+				 * accounting is deferred to the end */
+    TreeItem **displayItems;	/* Flattened array of displayed items in
+				 * preorder; rebuilt together with rowPos */
+    int nDisplayItems;		/* #entries in displayItems */
+    int displayItemsSize;	/* #slots allocated in displayItems */
+    TreeColumn *sortColumn;	/* Column of the active [$tv sort],
+				 * or NULL if no sort is active */
+    Tcl_Obj *sortCommandObj;	/* Comparison script for the active sort,
+				 * or NULL */
+    int sortFlags;		/* SORT_DESCENDING / SORT_DICTIONARY */
+    int sortEpoch;		/* Bumped when the sort criteria change;
+				 * cached item keys from older epochs are
+				 * recomputed on demand */
+    int sortInProgress;		/* A sort comparison script is being
+				 * evaluated; commands that restructure the
+				 * tree are refused until it returns */
     Ttk_Box headingArea;	/* Display area for column headings */
     Ttk_Box treeArea;   	/* Display area for tree */
     int slack;			/* Slack space (see Resizing section) */
     unsigned showFlags;		/* bitmask of subparts to display */
+
+    /* Copy-scroll support (see TreeviewDisplay):
+     */
+    Pixmap savedFrame;		/* Copy of the last fully drawn frame,
+				 * or None */
+    GC copyGC;			/* GC for frame copies, or NULL */
+    int savedWidth;		/* Size of savedFrame ... */
+    int savedHeight;
+    int savedYFirst;		/* Scroll positions savedFrame was */
+    int savedXFirst;		/* drawn with */
+    int redrawBandFirst;	/* Display row range that DrawSubtree */
+    int redrawBandLast;		/* should (re)draw */
+
+    /* Cell-level repaint support (see TreeviewDisplay):
+     */
+    DirtyCell *dirtyCells;	/* Cells changed since the last frame */
+    int nDirtyCells;		/* #entries in dirtyCells */
+    int dirtyCellsSize;		/* #slots allocated in dirtyCells */
+    int dirtyCellsValid;	/* Non-zero means the listed cells are the
+				 * only content changes since savedFrame
+				 * was taken */
+
+    /* Type-ahead search support (see [$tv find]):
+     */
+    FindEntry *findIndex;	/* Sorted text index, or NULL if stale */
+    int nFindEntries;		/* #entries in findIndex */
+    TreeColumn *findColumn;	/* Column findIndex was built over */
 } TreePart;
 
 typedef struct {
@@ -535,6 +612,9 @@ static const Tk_OptionSpec TreeviewOptionSpecs[] = {
     {TK_OPTION_STRING_TABLE, "-selecttype", "selectType", "SelectType",
 	"item", offsetof(Treeview,tree.selectTypeObj), TCL_INDEX_NONE,
 	0, SelectTypeStrings, 0 },
+    {TK_OPTION_STRING, "-datacommand", "dataCommand", "DataCommand",
+	NULL, offsetof(Treeview,tree.dataCommandObj), TCL_INDEX_NONE,
+	TK_OPTION_NULL_OK, 0, 0 },
 
     {TK_OPTION_PIXELS, "-height", "height", "Height",
 	DEF_TREE_ROWS, offsetof(Treeview,tree.heightObj), TCL_INDEX_NONE,
@@ -772,6 +852,27 @@ static Tcl_Obj *ItemID(Treeview *tv, TreeItem *item)
     return Tcl_NewStringObj(ItemName(tv, item), -1);
 }
 
+/* + InvalidateFindIndex --
+ * 	Discard the [$tv find] text index.  Called whenever items are
+ * 	added, removed, re-attached or retitled; the index is rebuilt
+ * 	by the next [$tv find].
+ */
+static void InvalidateFindIndex(Treeview *tv)
+{
+    int i;
+
+    if (!tv->tree.findIndex) {
+	return;
+    }
+    for (i = 0; i < tv->tree.nFindEntries; ++i) {
+	ckfree(tv->tree.findIndex[i].folded);
+    }
+    ckfree(tv->tree.findIndex);
+    tv->tree.findIndex = NULL;
+    tv->tree.nFindEntries = 0;
+    tv->tree.findColumn = NULL;
+}
+
 /*------------------------------------------------------------------------
  * +++ Column configuration.
  */
@@ -814,6 +915,20 @@ static int TreeviewInitColumns(Tcl_Interp *interp, Treeview *tv)
      */
     TreeviewFreeColumns(tv);
 
+    /*
+     * The columns array is reallocated below; an active sort refers
+     * into the old one, so deactivate it.
+     */
+    if (tv->tree.sortColumn) {
+	tv->tree.sortColumn = NULL;
+	if (tv->tree.sortCommandObj) {
+	    Tcl_DecrRefCount(tv->tree.sortCommandObj);
+	    tv->tree.sortCommandObj = NULL;
+	}
+	++tv->tree.sortEpoch;
+    }
+    InvalidateFindIndex(tv);	/* its column pointer would dangle too */
+
     /*
      * Initialize columns array and columnNames hash table:
      */
@@ -1292,6 +1407,15 @@ static void TreeviewInitialize(Tcl_Interp *interp, void *recordPtr)
     tv->tree.titleRows = 0;
     tv->tree.totalRows = 0;
     tv->tree.rowPosNeedsUpdate = 1;
+    tv->tree.batchInserting = 0;
+    tv->tree.displayItems = NULL;
+    tv->tree.nDisplayItems = 0;
+    tv->tree.displayItemsSize = 0;
+    tv->tree.sortColumn = NULL;
+    tv->tree.sortCommandObj = NULL;
+    tv->tree.sortFlags = 0;
+    tv->tree.sortEpoch = 0;
+    tv->tree.sortInProgress = 0;
     tv->tree.striped = 0;
     tv->tree.columns = NULL;
     tv->tree.displayColumns = NULL;
@@ -1330,6 +1454,20 @@ static void TreeviewInitialize(Tcl_Interp *interp, void *recordPtr)
      */
     tv->tree.treeArea = tv->tree.headingArea = Ttk_MakeBox(0,0,0,0);
     tv->tree.slack = 0;
+
+    tv->tree.savedFrame = None;
+    tv->tree.copyGC = NULL;
+    tv->tree.savedWidth = tv->tree.savedHeight = 0;
+    tv->tree.savedYFirst = tv->tree.savedXFirst = 0;
+    tv->tree.redrawBandFirst = 0;
+    tv->tree.redrawBandLast = INT_MAX;
+    tv->tree.dirtyCells = NULL;
+    tv->tree.nDirtyCells = 0;
+    tv->tree.dirtyCellsSize = 0;
+    tv->tree.dirtyCellsValid = 0;
+    tv->tree.findIndex = NULL;
+    tv->tree.nFindEntries = 0;
+    tv->tree.findColumn = NULL;
 }
 
 static void TreeviewCleanup(void *recordPtr)
@@ -1352,12 +1490,26 @@ static void TreeviewCleanup(void *recordPtr)
 
     if (tv->tree.displayColumns)
 	ckfree(tv->tree.displayColumns);
+    if (tv->tree.displayItems)
+	ckfree(tv->tree.displayItems);
+    if (tv->tree.dirtyCells)
+	ckfree(tv->tree.dirtyCells);
+    if (tv->tree.sortCommandObj)
+	Tcl_DecrRefCount(tv->tree.sortCommandObj);
+    InvalidateFindIndex(tv);
 
     foreachHashEntry(&tv->tree.items, FreeItemCB);
     Tcl_DeleteHashTable(&tv->tree.items);
 
     TtkFreeScrollHandle(tv->tree.xscrollHandle);
     TtkFreeScrollHandle(tv->tree.yscrollHandle);
+
+    if (tv->tree.savedFrame != None) {
+	Tk_FreePixmap(Tk_Display(tv->core.tkwin), tv->tree.savedFrame);
+    }
+    if (tv->tree.copyGC != NULL) {
+	XFreeGC(Tk_Display(tv->core.tkwin), tv->tree.copyGC);
+    }
 }
 
 /* + TreeviewConfigure --
@@ -1421,6 +1573,113 @@ TreeviewConfigure(Tcl_Interp *interp, void *recordPtr, int mask)
     return TCL_OK;
 }
 
+/*------------------------------------------------------------------------
+ * +++ Column auto-fit.
+ *
+ * Columns with -autofit keep a running maximum of the pixel width of
+ * the values stored into them, so sizing a column to its content is
+ * O(1) per edit instead of an O(n) rescan from script level.  The
+ * aggregate only grows; re-running [$tv column $c -autofit 1] rescans
+ * and shrinks it back to the current content.
+ */
+
+/* Allowance for cell-internal padding around the measured text. */
+#define AUTOFIT_PADDING 8
+
+static int ItemDepth(TreeItem *item);	/* forward */
+
+/* + AutofitColumn --
+ * 	Account for one cell value in an autofit column; grows the
+ * 	column width (repo style: same resize path as [$tv column
+ * 	-width]) when the running maximum exceeds it.
+ */
+static void AutofitColumn(
+    Treeview *tv, TreeColumn *column, Tcl_Obj *valueObj, int extra)
+{
+    Tcl_Obj *fontObj = Ttk_QueryOption(tv->core.layout, "-font", 0);
+    Tk_Font font;
+    const char *text;
+    Tcl_Size length;
+    int width;
+
+    if (!column->autofit || !valueObj || !fontObj) {
+	return;
+    }
+    font = Tk_GetFontFromObj(tv->core.tkwin, fontObj);
+    if (!font) {
+	return;
+    }
+
+    text = Tcl_GetStringFromObj(valueObj, &length);
+    width = Tk_TextWidth(font, text, length) + extra + AUTOFIT_PADDING;
+    if (width > column->autofitWidth) {
+	column->autofitWidth = width;
+    }
+    if (column->autofitWidth > column->width) {
+	column->width = column->autofitWidth;
+	if (!Tk_IsMapped(tv->core.tkwin)) {
+	    TtkResizeWidget(&tv->core);
+	} else {
+	    RecomputeSlack(tv);
+	    ResizeColumns(tv, TreeWidth(tv));
+	}
+	TtkRedisplayWidget(&tv->core);
+    }
+}
+
+/* + AutofitItemValues --
+ * 	Account for an item's value list (and its -text, for the tree
+ * 	column) in all autofit columns.  'valuesObj' may differ from
+ * 	item->valuesObj for items whose values come from -datacommand.
+ */
+static void AutofitItemValues(
+    Treeview *tv, TreeItem *item, Tcl_Obj *valuesObj)
+{
+    Tcl_Size i, nValues = 0;
+    Tcl_Obj **values = NULL;
+
+    if (valuesObj) {
+	Tcl_ListObjGetElements(NULL, valuesObj, &nValues, &values);
+    }
+    for (i = 0; i < tv->tree.nColumns && i < nValues; ++i) {
+	AutofitColumn(tv, tv->tree.columns + i, values[i], 0);
+    }
+    if (tv->tree.column0.autofit && item->textObj) {
+	AutofitColumn(tv, &tv->tree.column0, item->textObj,
+		(ItemDepth(item) + 1) * tv->tree.indent);
+    }
+}
+
+/* + AutofitScanColumn --
+ * 	Recompute an autofit column's aggregate from all stored values.
+ * 	Used when -autofit is (re)enabled; items in -datacommand mode
+ * 	have no stored values and are sampled as they are drawn instead.
+ */
+static void AutofitScanColumn(Treeview *tv, TreeColumn *column)
+{
+    TreeItem *item;
+    Tcl_Size columnNumber =
+	(column == &tv->tree.column0) ? -1 : column - tv->tree.columns;
+
+    column->autofitWidth = 0;
+    for (item = tv->tree.root->children; item; item = NextPreorder(item)) {
+	if (columnNumber < 0) {
+	    if (item->textObj) {
+		AutofitColumn(tv, column, item->textObj,
+			(ItemDepth(item) + 1) * tv->tree.indent);
+	    }
+	} else if (item->valuesObj) {
+	    Tcl_Obj *valueObj = NULL;
+	    Tcl_ListObjIndex(NULL, item->valuesObj, columnNumber, &valueObj);
+	    AutofitColumn(tv, column, valueObj, 0);
+	}
+    }
+}
+
+/* Forward (see "Widget commands -- sorting" below): */
+static int RepositionItem(Tcl_Interp *interp, Treeview *tv, TreeItem *item);
+static int SortLocked(Tcl_Interp *interp, Treeview *tv);
+
 /* + ConfigureItem --
  * 	Set item options.
  */
@@ -1502,7 +1761,19 @@ static int ConfigureItem(
 	if (item->imagespec) { TtkFreeImageSpec(item->imagespec); }
 	item->imagespec = newImageSpec;
     }
+    if (item->sortKeyObj) {
+	Tcl_DecrRefCount(item->sortKeyObj);
+	item->sortKeyObj = NULL;
+    }
+    InvalidateFindIndex(tv);
     tv->tree.rowPosNeedsUpdate = 1;
+    if (!tv->tree.batchInserting) {
+	AutofitItemValues(tv, item, item->valuesObj);
+    }
+    if (tv->tree.sortColumn && item->parent
+	    && RepositionItem(interp, tv, item) != TCL_OK) {
+	return TCL_ERROR;
+    }
     TtkRedisplayWidget(&tv->core);
     return TCL_OK;
 
@@ -1542,6 +1813,9 @@ static int ConfigureColumn(
      * geometry jumping during interactive column resize.
      */
     if (mask & GEOMETRY_CHANGED) {
+	if (column->autofit) {
+	    AutofitScanColumn(tv, column);
+	}
 	if (!Tk_IsMapped(tv->core.tkwin)) {
 	    TtkResizeWidget(&tv->core);
         } else {
@@ -1627,6 +1901,18 @@ static void UpdatePositionItem(
 	if (*visiblePos == tv->tree.nTitleItems) {
 	    tv->tree.titleRows = *rowPos;
 	}
+	if (*visiblePos >= 0) {	/* the invisible root is not recorded */
+	    if (*visiblePos >= tv->tree.displayItemsSize) {
+		tv->tree.displayItemsSize = 2 * tv->tree.displayItemsSize;
+		if (tv->tree.displayItemsSize < 64) {
+		    tv->tree.displayItemsSize = 64;
+		}
+		tv->tree.displayItems = (TreeItem **)ckrealloc(
+			tv->tree.displayItems,
+			tv->tree.displayItemsSize * sizeof(TreeItem *));
+	    }
+	    tv->tree.displayItems[*visiblePos] = item;
+	}
 
 	*visiblePos += 1;
 	*rowPos += item->height;
@@ -1642,7 +1928,9 @@ static void UpdatePositionItem(
 }
 
 /* + UpdatePositionTree --
- * 	Update position data for all visible items.
+ * 	Update position data for all visible items, and rebuild the
+ * 	flattened displayItems array so row lookups can binary search
+ * 	instead of walking the tree.
  */
 static void UpdatePositionTree(Treeview *tv)
 {
@@ -1651,6 +1939,7 @@ static void UpdatePositionTree(Treeview *tv)
     tv->tree.titleRows = 0;
     UpdatePositionItem(tv, tv->tree.root, 0, &rowPos, &itemPos, &visiblePos);
     tv->tree.totalRows = rowPos;
+    tv->tree.nDisplayItems = visiblePos;
     tv->tree.rowPosNeedsUpdate = 0;
 }
 
@@ -1662,7 +1951,7 @@ static TreeItem *IdentifyItem(Treeview *tv, int y)
     TreeItem *item;
     int rowHeight = tv->tree.rowHeight;
     int ypos = tv->tree.treeArea.y;
-    int nextRow, row;
+    int lo, hi, mid, row;
     if (y < ypos) {
 	return NULL;
     }
@@ -1673,9 +1962,24 @@ static TreeItem *IdentifyItem(Treeview *tv, int y)
     if (row >= tv->tree.titleRows) {
 	row += tv->tree.yscroll.first;
     }
-    for (item = tv->tree.root->children; item; item = NextPreorder(item)) {
-	nextRow = item->rowPos + item->height;
-	if (item->rowPos <= row && row < nextRow) break;
+
+    /* Binary search for the last displayed item starting at or above row;
+     * displayItems is in preorder so rowPos increases with the index.
+     */
+    item = NULL;
+    lo = 0;
+    hi = tv->tree.nDisplayItems - 1;
+    while (lo <= hi) {
+	mid = (lo + hi) / 2;
+	if (tv->tree.displayItems[mid]->rowPos <= row) {
+	    item = tv->tree.displayItems[mid];
+	    lo = mid + 1;
+	} else {
+	    hi = mid - 1;
+	}
+    }
+    if (item && row >= item->rowPos + item->height) {
+	item = NULL;	/* below the last displayed item */
     }
     return item;
 }
@@ -2128,9 +2432,50 @@ static void PrepareItem(
     Ttk_TagSetApplyStyle(tv->tree.tagTable, style, state, displayItem);
 }
 
-/* Fill in data from item to temporary storage in columns. */
+/* + FetchItemValues --
+ * 	Ask the -datacommand script for the cell values of an item that has
+ * 	no stored -values. The item ID is appended to the script, which is
+ * 	evaluated at global level; its result is used as the -values list
+ * 	for display only and is never stored on the item, so memory stays
+ * 	proportional to what is actually drawn.
+ *
+ * 	Returns a list with one extra reference (the caller must release
+ * 	it after drawing), or NULL on error. Script errors are reported
+ * 	as background exceptions.
+ */
+static Tcl_Obj *FetchItemValues(
+    Treeview *tv, TreeItem *item)
+{
+    Tcl_Interp *interp = tv->core.interp;
+    Tcl_Obj *cmd, *result = NULL;
+    int code;
+
+    cmd = Tcl_DuplicateObj(tv->tree.dataCommandObj);
+    Tcl_IncrRefCount(cmd);
+    if (Tcl_ListObjAppendElement(interp, cmd, ItemID(tv, item)) != TCL_OK) {
+	Tcl_DecrRefCount(cmd);
+	return NULL;
+    }
+    code = Tcl_EvalObjEx(interp, cmd, TCL_EVAL_GLOBAL);
+    Tcl_DecrRefCount(cmd);
+    if (code == TCL_OK) {
+	result = Tcl_GetObjResult(interp);
+	Tcl_IncrRefCount(result);
+    } else {
+	Tcl_AddErrorInfo(interp, "\n    (-datacommand callback)");
+	Tcl_BackgroundException(interp, code);
+    }
+    Tcl_ResetResult(interp);
+    return result;
+}
+
+/* Fill in data from item to temporary storage in columns.
+ * If the item has no stored values and a -datacommand is set, the values
+ * are fetched from the callback; *fetchedValuesPtr is set to the fetched
+ * list, which the caller must release after the cells have been drawn.
+ */
 static void PrepareCells(
-   Treeview *tv, TreeItem *item)
+   Treeview *tv, TreeItem *item, Tcl_Obj **fetchedValuesPtr)
 {
     Tcl_Size i, nValues = 0;
     Tcl_Obj **values = NULL;
@@ -2138,6 +2483,14 @@ static void PrepareCells(
 
     if (item->valuesObj) {
 	Tcl_ListObjGetElements(NULL, item->valuesObj, &nValues, &values);
+    } else if (tv->tree.dataCommandObj != NULL && fetchedValuesPtr != NULL) {
+	*fetchedValuesPtr = FetchItemValues(tv, item);
+	if (*fetchedValuesPtr != NULL) {
+	    Tcl_ListObjGetElements(NULL, *fetchedValuesPtr, &nValues,
+		    &values);
+	    /* Sample displayed rows for autofit columns: */
+	    AutofitItemValues(tv, item, *fetchedValuesPtr);
+	}
     }
     for (i = 0; i < tv->tree.nColumns; ++i) {
 	tv->tree.columns[i].data = (i < nValues) ? values[i] : 0;
@@ -2167,12 +2520,14 @@ static void PrepareCells(
 }
 
 /* + DrawCells --
- *	Draw data cells for specified item.
+ *	Draw data cells for specified item.  If 'only' is non-NULL, draw
+ *	just that column's cell (including its slice of the row
+ *	background, which is otherwise painted wholesale by DrawItem).
  */
 static void DrawCells(
     Treeview *tv, TreeItem *item,
     DisplayItem *displayItem, DisplayItem *displayItemSel,
-    Drawable d, int x, int y, int title)
+    Drawable d, int x, int y, int title, TreeColumn *only)
 {
     Ttk_Layout layout = tv->tree.cellLayout;
     Ttk_Style style = Ttk_LayoutStyle(tv->core.layout);
@@ -2219,6 +2574,7 @@ static void DrawCells(
 	if (title  && i >= tv->tree.nTitleColumns) break;
 	if (!title && i <  tv->tree.nTitleColumns) continue;
 	if (!title && x <  tv->tree.titleWidth) continue;
+	if (only != NULL && column != only) continue;
 
 	if (column->selected) {
 	    displayItemUsed = &displayItemCellSel;
@@ -2245,8 +2601,9 @@ static void DrawCells(
 		    &imageAnchor);
 	}
 	/* displayItem was used to draw the full item backgound.
-	   Redraw cell background if needed. */
-	if (displayItemUsed != &displayItemCell) {
+	   Redraw cell background if needed (always, when repainting a
+	   single cell on top of a saved frame). */
+	if (displayItemUsed != &displayItemCell || only != NULL) {
 	    DisplayLayout(tv->tree.rowLayout, displayItemUsed, stateCell,
 		    parcel, d);
 	}
@@ -2270,6 +2627,7 @@ static void DrawItem(
     Ttk_Style style = Ttk_LayoutStyle(tv->core.layout);
     Ttk_State state = ItemState(tv, item);
     DisplayItem displayItem, displayItemSel, displayItemLocal;
+    Tcl_Obj *fetchedValues = NULL;
     int rowHeight = tv->tree.rowHeight * item->height;
     int x = tv->tree.treeArea.x - tv->tree.xscroll.first;
     int xTitle = tv->tree.treeArea.x;
@@ -2294,8 +2652,17 @@ static void DrawItem(
 
     /* Draw data cells:
      */
-    PrepareCells(tv, item);
-    DrawCells(tv, item, &displayItem, &displayItemSel, d, x, y, 0);
+    PrepareCells(tv, item, &fetchedValues);
+    if (WidgetDestroyed(&tv->core)) {
+	/*
+	 * The -datacommand callback is free to destroy the widget.
+	 */
+	if (fetchedValues) {
+	    Tcl_DecrRefCount(fetchedValues);
+	}
+	return;
+    }
+    DrawCells(tv, item, &displayItem, &displayItemSel, d, x, y, 0, NULL);
 
     /* Draw row background for non-scrolled area:
      */
@@ -2364,7 +2731,11 @@ static void DrawItem(
     /* Draw non-scrolled data cells:
      */
     if (tv->tree.nTitleColumns > 1) {
-	DrawCells(tv, item, &displayItem, &displayItemSel, d, xTitle, y, 1);
+	DrawCells(tv, item, &displayItem, &displayItemSel, d, xTitle, y, 1,
+		NULL);
+    }
+    if (fetchedValues) {
+	Tcl_DecrRefCount(fetchedValues);
     }
 }
 
@@ -2379,7 +2750,10 @@ static void DrawSubtree(
     Treeview *tv, TreeItem *item, Drawable d, int depth)
 {
     int dispRow = DisplayRow(item->rowPos, tv);
-    if (dispRow >= 0) {
+    if (dispRow >= 0
+	    && (dispRow < tv->tree.titleRows
+		|| (dispRow + item->height > tv->tree.redrawBandFirst
+		    && dispRow <= tv->tree.redrawBandLast))) {
 	DrawItem(tv, item, d, depth);
     }
 
@@ -2400,19 +2774,210 @@ static void DrawForest(
     }
 }
 
+/* + MarkCellDirty --
+ * 	Record that a single cell's value changed and schedule a repaint
+ * 	without invalidating the rest of the frame.  Falls back to a full
+ * 	redisplay when the list grows past the point where walking it
+ * 	would cost more than repainting everything.
+ */
+#define DIRTY_CELL_MAX 1024
+
+static void MarkCellDirty(Treeview *tv, TreeItem *item, TreeColumn *column)
+{
+    if (tv->tree.nDirtyCells >= DIRTY_CELL_MAX) {
+	TtkRedisplayWidget(&tv->core);
+	return;
+    }
+    if (tv->tree.nDirtyCells >= tv->tree.dirtyCellsSize) {
+	tv->tree.dirtyCellsSize = 2 * tv->tree.dirtyCellsSize;
+	if (tv->tree.dirtyCellsSize < 64) {
+	    tv->tree.dirtyCellsSize = 64;
+	}
+	tv->tree.dirtyCells = (DirtyCell *)ckrealloc(tv->tree.dirtyCells,
+		tv->tree.dirtyCellsSize * sizeof(DirtyCell));
+    }
+    tv->tree.dirtyCells[tv->tree.nDirtyCells].item = item;
+    tv->tree.dirtyCells[tv->tree.nDirtyCells].column = column;
+    ++tv->tree.nDirtyCells;
+    tv->tree.dirtyCellsValid = 1;
+    TtkScheduleRedisplay(&tv->core);
+}
+
+/* + RedrawCell --
+ * 	Repaint one data cell on top of an otherwise valid frame.
+ * 	Mirrors the cell-drawing part of DrawItem.
+ */
+static void RedrawCell(
+    Treeview *tv, TreeItem *item, TreeColumn *column, Drawable d)
+{
+    Ttk_State state = ItemState(tv, item);
+    DisplayItem displayItem, displayItemSel;
+    Tcl_Obj *fetchedValues = NULL;
+    int x = tv->tree.treeArea.x - tv->tree.xscroll.first;
+    int xTitle = tv->tree.treeArea.x;
+    int dispRow = DisplayRow(item->rowPos, tv);
+    int y;
+
+    if (dispRow < 0) {
+	return;			/* not viewable, or scrolled off-screen */
+    }
+    y = tv->tree.treeArea.y + tv->tree.rowHeight * dispRow;
+
+    PrepareItem(tv, item, &displayItem, state);
+    PrepareItem(tv, item, &displayItemSel, state | TTK_STATE_SELECTED);
+    if (tv->tree.showFlags & SHOW_TREE) {
+	x += tv->tree.column0.width;
+	xTitle += tv->tree.column0.width -
+		(tv->tree.column0.separator ? tv->tree.colSeparatorWidth/2 : 0);
+    }
+
+    PrepareCells(tv, item, &fetchedValues);
+    if (WidgetDestroyed(&tv->core)) {
+	/*
+	 * The -datacommand callback is free to destroy the widget.
+	 */
+	if (fetchedValues) {
+	    Tcl_DecrRefCount(fetchedValues);
+	}
+	return;
+    }
+    DrawCells(tv, item, &displayItem, &displayItemSel, d, x, y, 0, column);
+    if (tv->tree.nTitleColumns > 1) {
+	DrawCells(tv, item, &displayItem, &displayItemSel, d, xTitle, y, 1,
+		column);
+    }
+    if (fetchedValues) {
+	Tcl_DecrRefCount(fetchedValues);
+    }
+}
+
 /* + TreeviewDisplay --
  * 	Display() widget hook.  Draw the widget contents.
+ *
+ * 	A copy of each completed frame is kept in tv->tree.savedFrame.
+ * 	When the only thing that changed since the last frame is the
+ * 	vertical scroll position (CONTENT_CHANGED clear, see
+ * 	TtkScheduleRedisplay), the still-valid band of the saved frame
+ * 	is blitted into place and only the newly exposed rows (plus
+ * 	the pinned title rows) are redrawn.  When additionally (or only)
+ * 	some cell values changed via [$tv set], the affected cells are
+ * 	listed in tv->tree.dirtyCells and just their rectangles are
+ * 	repainted on top of the blit, instead of their whole rows.
  */
 static void TreeviewDisplay(void *clientData, Drawable d)
 {
     Treeview *tv = (Treeview *)clientData;
+    Tk_Window tkwin = tv->core.tkwin;
+    Display *display = Tk_Display(tkwin);
+    int width = Tk_Width(tkwin), height = Tk_Height(tkwin);
+    int rowHeight = tv->tree.rowHeight;
+    int blitDelta = 0;
+    int cellsOnly = 0;
+
+    tv->tree.redrawBandFirst = 0;
+    tv->tree.redrawBandLast = INT_MAX;
+
+#ifndef TK_NO_DOUBLE_BUFFERING
+    if (tv->tree.savedFrame != None
+	    && !(tv->core.flags & CONTENT_CHANGED)
+	    && tv->tree.savedWidth == width
+	    && tv->tree.savedHeight == height
+	    && tv->tree.savedXFirst == tv->tree.xscroll.first) {
+	if (tv->tree.savedYFirst != tv->tree.yscroll.first) {
+	    blitDelta = tv->tree.yscroll.first - tv->tree.savedYFirst;
+	}
+	cellsOnly = tv->tree.dirtyCellsValid;
+    }
+#endif
 
     Ttk_DrawLayout(tv->core.layout, tv->core.state, d);
     if (tv->tree.showFlags & SHOW_HEADINGS) {
 	DrawHeadings(tv, d);
     }
+
+    if (blitDelta != 0) {
+	/* The scrollable band starts below the pinned title rows:
+	 */
+	int sy = tv->tree.treeArea.y + tv->tree.titleRows * rowHeight;
+	int sh = tv->tree.treeArea.height - tv->tree.titleRows * rowHeight;
+	int shift = blitDelta * rowHeight;
+
+	if (shift > 0 && shift < sh) {
+	    /* Scrolled down: band moves up, bottom rows exposed.
+	     * The bottommost copied row may be clipped, redraw it too.
+	     */
+	    XCopyArea(display, tv->tree.savedFrame, d, tv->tree.copyGC,
+		    tv->tree.treeArea.x, sy + shift,
+		    tv->tree.treeArea.width, sh - shift,
+		    tv->tree.treeArea.x, sy);
+	    tv->tree.redrawBandFirst =
+		tv->tree.titleRows + (sh - shift) / rowHeight;
+	} else if (shift < 0 && -shift < sh) {
+	    /* Scrolled up: band moves down, top rows exposed.
+	     */
+	    XCopyArea(display, tv->tree.savedFrame, d, tv->tree.copyGC,
+		    tv->tree.treeArea.x, sy,
+		    tv->tree.treeArea.width, sh + shift,
+		    tv->tree.treeArea.x, sy - shift);
+	    tv->tree.redrawBandLast = tv->tree.titleRows - blitDelta - 1;
+	}
+    } else if (cellsOnly) {
+	/* Same scroll position, only cell values changed: blit the whole
+	 * content area and repaint just the dirty cells below.
+	 */
+	XCopyArea(display, tv->tree.savedFrame, d, tv->tree.copyGC,
+		tv->tree.treeArea.x, tv->tree.treeArea.y,
+		tv->tree.treeArea.width, tv->tree.treeArea.height,
+		tv->tree.treeArea.x, tv->tree.treeArea.y);
+	tv->tree.redrawBandFirst = INT_MAX;
+	tv->tree.redrawBandLast = INT_MAX;
+    }
+
     DrawForest(tv, tv->tree.root->children, d, 0);
+    tv->tree.redrawBandFirst = 0;
+    tv->tree.redrawBandLast = INT_MAX;
+    if (cellsOnly) {
+	int c;
+
+	for (c = 0; c < tv->tree.nDirtyCells; ++c) {
+	    RedrawCell(tv, tv->tree.dirtyCells[c].item,
+		    tv->tree.dirtyCells[c].column, d);
+	    if (WidgetDestroyed(&tv->core)) {
+		return;
+	    }
+	}
+    }
+    tv->tree.nDirtyCells = 0;
+    tv->tree.dirtyCellsValid = 0;
     DrawSeparators(tv, d);
+
+#ifndef TK_NO_DOUBLE_BUFFERING
+    /* Keep a copy of the completed frame for the next pure scroll:
+     */
+    if (tv->tree.savedFrame != None
+	    && (tv->tree.savedWidth != width
+		|| tv->tree.savedHeight != height)) {
+	Tk_FreePixmap(display, tv->tree.savedFrame);
+	tv->tree.savedFrame = None;
+    }
+    if (tv->tree.savedFrame == None) {
+	tv->tree.savedFrame = Tk_GetPixmap(display, Tk_WindowId(tkwin),
+		width, height, Tk_Depth(tkwin));
+	tv->tree.savedWidth = width;
+	tv->tree.savedHeight = height;
+    }
+    if (tv->tree.copyGC == NULL) {
+	XGCValues gcValues;
+
+	gcValues.graphics_exposures = False;
+	tv->tree.copyGC = XCreateGC(display, d,
+		GCGraphicsExposures, &gcValues);
+    }
+    XCopyArea(display, d, tv->tree.savedFrame, tv->tree.copyGC,
+	    0, 0, width, height, 0, 0);
+    tv->tree.savedYFirst = tv->tree.yscroll.first;
+    tv->tree.savedXFirst = tv->tree.xscroll.first;
+#endif
 }
 
 /*------------------------------------------------------------------------
@@ -2532,6 +3097,9 @@ static int TreeviewChildrenCommand(
     if (!item) {
 	return TCL_ERROR;
     }
+    if (objc == 4 && SortLocked(interp, tv)) {
+	return TCL_ERROR;
+    }
 
     if (objc == 3) {
 	result = Tcl_NewListObj(0,0);
@@ -2588,6 +3156,7 @@ static int TreeviewChildrenCommand(
 	}
 
 	ckfree(newChildren);
+	InvalidateFindIndex(tv);
 	tv->tree.rowPosNeedsUpdate = 1;
 	TtkRedisplayWidget(&tv->core);
     }
@@ -3126,7 +3695,27 @@ static int TreeviewSetCommand(
 	/* Set value:
 	 */
 	Tcl_ListObjReplace(interp,item->valuesObj,columnNumber,1,1,objv+4);
-	TtkRedisplayWidget(&tv->core);
+	AutofitColumn(tv, column, objv[4], 0);
+	if (column == tv->tree.findColumn) {
+	    InvalidateFindIndex(tv);
+	}
+	if (column == tv->tree.sortColumn) {
+	    if (item->sortKeyObj) {
+		Tcl_DecrRefCount(item->sortKeyObj);
+		item->sortKeyObj = NULL;
+	    }
+	    if (item->parent && RepositionItem(interp, tv, item) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	}
+	if (!item->parent || tv->tree.rowPosNeedsUpdate) {
+	    /* The root or a detached item, or rows have shifted (e.g.
+	     * an active sort moved the item): repaint everything.
+	     */
+	    TtkRedisplayWidget(&tv->core);
+	} else {
+	    MarkCellDirty(tv, item, column);
+	}
 	return TCL_OK;
     }
 }
@@ -3138,41 +3727,25 @@ static int TreeviewSetCommand(
 /* + $tv insert $parent $index ?-id id? ?-option value ...?
  * 	Insert a new item.
  */
-static int TreeviewInsertCommand(
-    void *recordPtr, Tcl_Interp *interp, Tcl_Size objc, Tcl_Obj *const objv[])
+/* + InsertOneItem --
+ * 	Create, configure and link one new item for [$tv insert].
+ * 	objv[] holds the item options, optionally preceded by -id $id;
+ * 	if no -id is supplied a new one is autogenerated.
+ *
+ * 	Returns the new item, or NULL on error.
+ */
+static TreeItem *InsertOneItem(
+    Tcl_Interp *interp, Treeview *tv, TreeItem *parent, TreeItem *sibling,
+    Tcl_Size objc, Tcl_Obj *const objv[])
 {
-    Treeview *tv = (Treeview *)recordPtr;
-    TreeItem *parent, *sibling, *newItem;
+    TreeItem *newItem;
     Tcl_HashEntry *entryPtr;
     int isNew;
 
-    if (objc < 4) {
-	Tcl_WrongNumArgs(interp, 2, objv, "parent index ?-id id? -options...");
-	return TCL_ERROR;
-    }
-
-    /* Get parent node:
-     */
-    if ((parent = FindItem(interp, tv, objv[2])) == NULL) {
-	return TCL_ERROR;
-    }
-
-    /* Locate previous sibling based on $index:
-     */
-    if (!strcmp(Tcl_GetString(objv[3]), "end")) {
-	sibling = EndPosition(tv, parent);
-    } else {
-	int index;
-	if (Tcl_GetIntFromObj(interp, objv[3], &index) != TCL_OK)
-	    return TCL_ERROR;
-	sibling = InsertPosition(parent, index);
-    }
-
     /* Get node name:
      *     If -id supplied and does not already exist, use that;
      *     Otherwise autogenerate new one.
      */
-    objc -= 4; objv += 4;
     if (objc >= 2 && !strcmp("-id", Tcl_GetString(objv[0]))) {
 	const char *itemName = Tcl_GetString(objv[1]);
 
@@ -3181,7 +3754,7 @@ static int TreeviewInsertCommand(
 	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
 		"Item %s already exists", itemName));
 	    Tcl_SetErrorCode(interp, "TTK", "TREE", "ITEM_EXISTS", NULL);
-	    return TCL_ERROR;
+	    return NULL;
 	}
 	objc -= 2; objv += 2;
     } else {
@@ -3202,7 +3775,7 @@ static int TreeviewInsertCommand(
     if (ConfigureItem(interp, tv, newItem, objc, objv) != TCL_OK) {
     	Tcl_DeleteHashEntry(entryPtr);
 	FreeItem(newItem);
-	return TCL_ERROR;
+	return NULL;
     }
 
     /* Store in hash table, link into tree:
@@ -3210,51 +3783,157 @@ static int TreeviewInsertCommand(
     Tcl_SetHashValue(entryPtr, newItem);
     newItem->entryPtr = entryPtr;
     InsertItem(parent, sibling, newItem);
-    tv->tree.rowPosNeedsUpdate = 1;
-    TtkRedisplayWidget(&tv->core);
 
-    Tcl_SetObjResult(interp, ItemID(tv, newItem));
-    return TCL_OK;
+    return newItem;
 }
 
-/* + $tv detach $items --
- * 	Unlink each item in $items from the tree.
- */
-static int TreeviewDetachCommand(
+static int TreeviewInsertCommand(
     void *recordPtr, Tcl_Interp *interp, Tcl_Size objc, Tcl_Obj *const objv[])
 {
     Treeview *tv = (Treeview *)recordPtr;
-    TreeItem **items;
-    Tcl_Size i;
+    TreeItem *parent, *sibling, *newItem;
 
-    if (objc != 3) {
-	Tcl_WrongNumArgs(interp, 2, objv, "item");
+    if (objc < 4) {
+	Tcl_WrongNumArgs(interp, 2, objv, "parent index ?-id id? -options...");
 	return TCL_ERROR;
     }
-    if (!(items = GetItemListFromObj(interp, tv, objv[2]))) {
+    if (SortLocked(interp, tv)) {
 	return TCL_ERROR;
     }
 
-    /* Sanity-check */
-    for (i = 0; items[i]; ++i) {
-	if (items[i] == tv->tree.root) {
-	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
-		"Cannot detach root item", -1));
-	    Tcl_SetErrorCode(interp, "TTK", "TREE", "ROOT", NULL);
-	    ckfree(items);
-	    return TCL_ERROR;
-	}
+    /* Get parent node:
+     */
+    if ((parent = FindItem(interp, tv, objv[2])) == NULL) {
+	return TCL_ERROR;
     }
 
-    for (i = 0; items[i]; ++i) {
-	DetachItem(items[i]);
+    /* Locate previous sibling based on $index:
+     */
+    if (!strcmp(Tcl_GetString(objv[3]), "end")) {
+	sibling = EndPosition(tv, parent);
+    } else {
+	int index;
+	if (Tcl_GetIntFromObj(interp, objv[3], &index) != TCL_OK)
+	    return TCL_ERROR;
+	sibling = InsertPosition(parent, index);
     }
 
-    tv->tree.rowPosNeedsUpdate = 1;
-    TtkRedisplayWidget(&tv->core);
-    ckfree(items);
-    return TCL_OK;
-}
+    /* Bulk insertion: [$tv insert $parent $index -batch $rowSpecs]
+     * inserts one item per row spec, each spec a list of item options
+     * (optionally preceded by -id $id), in a single pass.  Column
+     * autofit accounting is deferred until all rows are in place.
+     */
+    if (objc >= 5 && !strcmp("-batch", Tcl_GetString(objv[4]))) {
+	Tcl_Obj **specs, *result;
+	Tcl_Size i, j, nSpecs;
+
+	if (objc != 6) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "parent index -batch rowSpecs");
+	    return TCL_ERROR;
+	}
+	if (Tcl_ListObjGetElements(interp, objv[5], &nSpecs, &specs)
+		!= TCL_OK) {
+	    return TCL_ERROR;
+	}
+
+	result = Tcl_NewListObj(nSpecs, NULL);
+	tv->tree.batchInserting = 1;
+	for (i = 0; i < nSpecs; ++i) {
+	    Tcl_Obj **specv;
+	    Tcl_Size specc;
+
+	    if (Tcl_ListObjGetElements(interp, specs[i], &specc, &specv)
+		    != TCL_OK
+		|| !(newItem = InsertOneItem(
+			interp, tv, parent, sibling, specc, specv))) {
+		char rowInfo[64];
+		snprintf(rowInfo, sizeof(rowInfo),
+		    "\n    (row %" TCL_SIZE_MODIFIER "d of -batch list)", i);
+		Tcl_AppendObjToErrorInfo(interp, Tcl_NewStringObj(rowInfo,
+		    TCL_INDEX_NONE));
+		Tcl_DecrRefCount(result);
+		break;
+	    }
+	    sibling = newItem;
+	    Tcl_ListObjAppendElement(NULL, result, ItemID(tv, newItem));
+	}
+	tv->tree.batchInserting = 0;
+
+	/* Deferred autofit accounting over the final contents:
+	 */
+	if (tv->tree.column0.autofit) {
+	    AutofitScanColumn(tv, &tv->tree.column0);
+	}
+	for (j = 0; j < tv->tree.nColumns; ++j) {
+	    if (tv->tree.columns[j].autofit) {
+		AutofitScanColumn(tv, &tv->tree.columns[j]);
+	    }
+	}
+	InvalidateFindIndex(tv);
+	tv->tree.rowPosNeedsUpdate = 1;
+	TtkRedisplayWidget(&tv->core);
+
+	if (i < nSpecs) {	/* a row failed; earlier rows remain */
+	    return TCL_ERROR;
+	}
+	Tcl_SetObjResult(interp, result);
+	return TCL_OK;
+    }
+
+    newItem = InsertOneItem(interp, tv, parent, sibling, objc - 4, objv + 4);
+    if (!newItem) {
+	return TCL_ERROR;
+    }
+    InvalidateFindIndex(tv);
+    tv->tree.rowPosNeedsUpdate = 1;
+    TtkRedisplayWidget(&tv->core);
+
+    Tcl_SetObjResult(interp, ItemID(tv, newItem));
+    return TCL_OK;
+}
+
+/* + $tv detach $items --
+ * 	Unlink each item in $items from the tree.
+ */
+static int TreeviewDetachCommand(
+    void *recordPtr, Tcl_Interp *interp, Tcl_Size objc, Tcl_Obj *const objv[])
+{
+    Treeview *tv = (Treeview *)recordPtr;
+    TreeItem **items;
+    Tcl_Size i;
+
+    if (objc != 3) {
+	Tcl_WrongNumArgs(interp, 2, objv, "item");
+	return TCL_ERROR;
+    }
+    if (SortLocked(interp, tv)) {
+	return TCL_ERROR;
+    }
+    if (!(items = GetItemListFromObj(interp, tv, objv[2]))) {
+	return TCL_ERROR;
+    }
+
+    /* Sanity-check */
+    for (i = 0; items[i]; ++i) {
+	if (items[i] == tv->tree.root) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		"Cannot detach root item", -1));
+	    Tcl_SetErrorCode(interp, "TTK", "TREE", "ROOT", NULL);
+	    ckfree(items);
+	    return TCL_ERROR;
+	}
+    }
+
+    for (i = 0; items[i]; ++i) {
+	DetachItem(items[i]);
+    }
+
+    InvalidateFindIndex(tv);
+    tv->tree.rowPosNeedsUpdate = 1;
+    TtkRedisplayWidget(&tv->core);
+    ckfree(items);
+    return TCL_OK;
+}
 
 /* Is an item detached? The root is never detached. */
 static int IsDetached(Treeview *tv, TreeItem *item)
@@ -3324,6 +4003,9 @@ static int TreeviewDeleteCommand(
 	Tcl_WrongNumArgs(interp, 2, objv, "items");
 	return TCL_ERROR;
     }
+    if (SortLocked(interp, tv)) {
+	return TCL_ERROR;
+    }
 
     if (!(items = GetItemListFromObj(interp, tv, objv[2]))) {
 	return TCL_ERROR;
@@ -3341,6 +4023,8 @@ static int TreeviewDeleteCommand(
 	}
     }
 
+    InvalidateFindIndex(tv);
+
     /* Remove items from hash table.
      */
     delq = 0;
@@ -3392,6 +4076,9 @@ static int TreeviewMoveCommand(
 	Tcl_WrongNumArgs(interp, 2, objv, "item parent index");
 	return TCL_ERROR;
     }
+    if (SortLocked(interp, tv)) {
+	return TCL_ERROR;
+    }
     if ((item = FindItem(interp, tv, objv[2])) == 0
 	    || (parent = FindItem(interp, tv, objv[3])) == 0) {
 	return TCL_ERROR;
@@ -3435,11 +4122,695 @@ static int TreeviewMoveCommand(
     DetachItem(item);
     InsertItem(parent, sibling, item);
 
+    InvalidateFindIndex(tv);	/* $item may have been detached */
     tv->tree.rowPosNeedsUpdate = 1;
     TtkRedisplayWidget(&tv->core);
     return TCL_OK;
 }
 
+/*------------------------------------------------------------------------
+ * +++ Widget commands -- sorting.
+ *
+ * [$tv sort] orders the children of an item (and, recursively, of its
+ * descendants) in C, using per-item cached sort keys, instead of making
+ * scripts extract, sort and re-insert every row. The criteria stay
+ * active afterwards: [$tv set] and [$tv item] move a modified item to
+ * its place among its siblings by binary insertion, so a large view is
+ * kept sorted at per-edit cost rather than per-refresh cost.
+ */
+
+#define SORT_DESCENDING	0x1
+#define SORT_DICTIONARY	0x2
+
+typedef struct {
+    Treeview *tv;
+    Tcl_Interp *interp;
+    int result;			/* TCL_OK, or TCL_ERROR after a -command
+				 * script has failed */
+} SortContext;
+
+/* + ItemColumnText --
+ * 	Return the item's value in the given column (the -text for the
+ * 	tree column), or NULL if it has none.
+ */
+static Tcl_Obj *ItemColumnText(Treeview *tv, TreeItem *item, TreeColumn *column)
+{
+    Tcl_Obj *textObj = NULL;
+
+    if (column == &tv->tree.column0) {
+	textObj = item->textObj;
+    } else if (item->valuesObj) {
+	Tcl_ListObjIndex(NULL, item->valuesObj,
+		column - tv->tree.columns, &textObj);
+    }
+    return textObj;
+}
+
+/* + GetSortKey --
+ * 	Return the item's value in the sort column (the -text for the
+ * 	tree column), caching it on the item. The cache is dropped when
+ * 	the value changes and ignored when tree.sortEpoch has moved on.
+ * 	Only called while a sort is active.
+ */
+static Tcl_Obj *GetSortKey(Treeview *tv, TreeItem *item)
+{
+    Tcl_Obj *key;
+
+    if (item->sortKeyObj && item->sortKeyEpoch == tv->tree.sortEpoch) {
+	return item->sortKeyObj;
+    }
+    key = ItemColumnText(tv, item, tv->tree.sortColumn);
+    if (!key) {
+	key = Tcl_NewStringObj("", 0);
+    }
+    Tcl_IncrRefCount(key);
+    if (item->sortKeyObj) {
+	Tcl_DecrRefCount(item->sortKeyObj);
+    }
+    item->sortKeyObj = key;
+    item->sortKeyEpoch = tv->tree.sortEpoch;
+    return key;
+}
+
+/* + DictionaryCompare --
+ * 	Case-insensitive comparison with embedded numbers compared by
+ * 	value; same ordering as [lsort -dictionary] (adapted from Tcl's
+ * 	tclCmdIL.c).
+ */
+static int DictionaryCompare(const char *left, const char *right)
+{
+    Tcl_UniChar uniLeft = 0, uniRight = 0, uniLeftLower, uniRightLower;
+    int diff, zeros;
+    int secondaryDiff = 0;
+
+    while (1) {
+	if (isdigit(UCHAR(*right)) && isdigit(UCHAR(*left))) {
+	    /*
+	     * There are decimal numbers embedded in the two strings.
+	     * Compare them as numbers, rather than strings. If one number
+	     * has more leading zeros than the other, the number with more
+	     * leading zeros sorts later, but only as a secondary choice.
+	     */
+
+	    zeros = 0;
+	    while ((*right == '0') && isdigit(UCHAR(right[1]))) {
+		right++;
+		zeros--;
+	    }
+	    while ((*left == '0') && isdigit(UCHAR(left[1]))) {
+		left++;
+		zeros++;
+	    }
+	    if (secondaryDiff == 0) {
+		secondaryDiff = zeros;
+	    }
+
+	    /*
+	     * The code below compares the numbers in the two strings
+	     * without ever converting them to integers. It does this by
+	     * first comparing the lengths of the numbers and then
+	     * comparing the digit values.
+	     */
+
+	    diff = 0;
+	    while (1) {
+		if (diff == 0) {
+		    diff = UCHAR(*left) - UCHAR(*right);
+		}
+		right++;
+		left++;
+		if (!isdigit(UCHAR(*right))) {
+		    if (isdigit(UCHAR(*left))) {
+			return 1;
+		    } else {
+			if (diff) {
+			    return diff;
+			}
+			break;
+		    }
+		} else if (!isdigit(UCHAR(*left))) {
+		    return -1;
+		}
+	    }
+	    continue;
+	}
+
+	/*
+	 * Convert character to Unicode for comparison purposes. If either
+	 * string is at the terminating null, do a byte-wise comparison and
+	 * bail out immediately.
+	 */
+
+	if ((*left != '\0') && (*right != '\0')) {
+	    left += Tcl_UtfToUniChar(left, &uniLeft);
+	    right += Tcl_UtfToUniChar(right, &uniRight);
+
+	    /*
+	     * Convert both chars to lower for the comparison, because
+	     * dictionary sorts are case-insensitive. Convert to lower, not
+	     * upper, so chars between Z and a will sort before A (where
+	     * most other interesting punctuations occur).
+	     */
+
+	    uniLeftLower = Tcl_UniCharToLower(uniLeft);
+	    uniRightLower = Tcl_UniCharToLower(uniRight);
+	} else {
+	    diff = UCHAR(*left) - UCHAR(*right);
+	    break;
+	}
+
+	diff = uniLeftLower - uniRightLower;
+	if (diff) {
+	    return diff;
+	}
+	if (secondaryDiff == 0) {
+	    if (Tcl_UniCharIsUpper(uniLeft) && Tcl_UniCharIsLower(uniRight)) {
+		secondaryDiff = -1;
+	    } else if (Tcl_UniCharIsUpper(uniRight)
+		    && Tcl_UniCharIsLower(uniLeft)) {
+		secondaryDiff = 1;
+	    }
+	}
+    }
+    if (diff == 0) {
+	diff = secondaryDiff;
+    }
+    return diff;
+}
+
+/* + SortLocked --
+ * 	A sort comparison script runs arbitrary code while the sorting
+ * 	machinery holds snapshots of the sibling lists, so commands that
+ * 	restructure the tree must be refused for the duration.  Leaves
+ * 	an error message when the tree is locked.
+ */
+static int SortLocked(Tcl_Interp *interp, Treeview *tv)
+{
+    if (tv->tree.sortInProgress) {
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		"cannot modify the tree from a sort comparison", -1));
+	Tcl_SetErrorCode(interp, "TTK", "TREE", "SORT", NULL);
+	return 1;
+    }
+    return 0;
+}
+
+/* + CompareItems --
+ * 	Compare two items according to the active sort criteria.
+ * 	A -command script failure - including the script destroying the
+ * 	widget - is recorded in ctx->result; once set, further
+ * 	comparisons return equality without touching the items, so the
+ * 	sort unwinds quickly and safely.
+ */
+static int CompareItems(SortContext *ctx, TreeItem *a, TreeItem *b)
+{
+    Treeview *tv = ctx->tv;
+    Tcl_Obj *keyA, *keyB;
+    int order = 0;
+
+    if (ctx->result != TCL_OK) {
+	return 0;
+    }
+    keyA = GetSortKey(tv, a);
+    keyB = GetSortKey(tv, b);
+    if (tv->tree.sortCommandObj) {
+	Tcl_Interp *interp = ctx->interp;
+	Tcl_Obj *cmd = Tcl_DuplicateObj(tv->tree.sortCommandObj);
+	int code;
+
+	Tcl_IncrRefCount(cmd);
+	Tcl_ListObjAppendElement(NULL, cmd, keyA);
+	Tcl_ListObjAppendElement(NULL, cmd, keyB);
+	code = Tcl_EvalObjEx(interp, cmd, TCL_EVAL_GLOBAL);
+	if (WidgetDestroyed(&tv->core)) {
+	    /*
+	     * The script destroyed the widget and with it every item;
+	     * nothing may touch them again.
+	     */
+
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "widget has been destroyed", -1));
+	    ctx->result = TCL_ERROR;
+	} else if (code != TCL_OK
+		|| Tcl_GetIntFromObj(interp, Tcl_GetObjResult(interp),
+			&order) != TCL_OK) {
+	    Tcl_AddErrorInfo(interp, "\n    (-command comparison)");
+	    ctx->result = TCL_ERROR;
+	    order = 0;
+	}
+	Tcl_DecrRefCount(cmd);
+    } else if (tv->tree.sortFlags & SORT_DICTIONARY) {
+	order = DictionaryCompare(Tcl_GetString(keyA), Tcl_GetString(keyB));
+    } else {
+	order = strcmp(Tcl_GetString(keyA), Tcl_GetString(keyB));
+    }
+    if (tv->tree.sortFlags & SORT_DESCENDING) {
+	order = -order;
+    }
+    return order;
+}
+
+/* + MergeItemRuns --
+ * 	Merge two adjacent sorted runs src[lo..mid) and src[mid..hi)
+ * 	into dst.  Ties go to the left run, which holds the earlier
+ * 	elements, so the sort is stable.
+ */
+static void MergeItemRuns(SortContext *ctx, TreeItem **src, TreeItem **dst,
+    Tcl_Size lo, Tcl_Size mid, Tcl_Size hi)
+{
+    Tcl_Size i = lo, j = mid, k = lo;
+
+    while (i < mid && j < hi) {
+	if (CompareItems(ctx, src[i], src[j]) <= 0) {
+	    dst[k++] = src[i++];
+	} else {
+	    dst[k++] = src[j++];
+	}
+    }
+    while (i < mid) {
+	dst[k++] = src[i++];
+    }
+    while (j < hi) {
+	dst[k++] = src[j++];
+    }
+}
+
+/* + SortItemArray --
+ * 	Bottom-up merge sort of a snapshot array of siblings; scratch
+ * 	must have room for n entries.  Returns whichever buffer (items
+ * 	or scratch) holds the sorted result.  The items themselves are
+ * 	never touched here: a -command comparison script runs arbitrary
+ * 	code, so the real child links must stay intact until every
+ * 	comparison has succeeded.
+ */
+static TreeItem **SortItemArray(SortContext *ctx,
+    TreeItem **items, TreeItem **scratch, Tcl_Size n)
+{
+    Tcl_Size width, lo, mid, hi;
+
+    for (width = 1; width < n; width *= 2) {
+	TreeItem **swap;
+
+	for (lo = 0; lo < n; lo += 2*width) {
+	    mid = (lo + width < n) ? lo + width : n;
+	    hi = (lo + 2*width < n) ? lo + 2*width : n;
+	    MergeItemRuns(ctx, items, scratch, lo, mid, hi);
+	}
+	swap = items;
+	items = scratch;
+	scratch = swap;
+    }
+    return items;
+}
+
+/* + SortChildren --
+ * 	Sort the children of item, and recursively those of each
+ * 	descendant, according to the active sort criteria.
+ */
+static void SortChildren(SortContext *ctx, TreeItem *item)
+{
+    TreeItem *child, *prev;
+    Tcl_Size i, n = 0;
+
+    for (child = item->children; child; child = child->next) {
+	++n;
+    }
+    if (n > 1) {
+	TreeItem **items = (TreeItem **)ckalloc(n * sizeof(TreeItem *));
+	TreeItem **scratch = (TreeItem **)ckalloc(n * sizeof(TreeItem *));
+	TreeItem **sorted;
+
+	for (child = item->children, i = 0; child; child = child->next) {
+	    items[i++] = child;
+	}
+	sorted = SortItemArray(ctx, items, scratch, n);
+	if (ctx->result == TCL_OK) {
+	    /*
+	     * Relink the children only after every comparison has
+	     * succeeded, so a failed sort leaves the tree as it was.
+	     */
+
+	    prev = NULL;
+	    item->children = sorted[0];
+	    for (i = 0; i < n; ++i) {
+		sorted[i]->prev = prev;
+		if (prev) {
+		    prev->next = sorted[i];
+		}
+		prev = sorted[i];
+	    }
+	    prev->next = NULL;
+	}
+	ckfree(items);
+	ckfree(scratch);
+    }
+    if (ctx->result != TCL_OK) {
+	return;
+    }
+    for (child = item->children; child; child = child->next) {
+	SortChildren(ctx, child);
+	if (ctx->result != TCL_OK) {
+	    return;
+	}
+    }
+}
+
+/* + RepositionItem --
+ * 	Move an item whose sort key has changed to its place among its
+ * 	siblings, which are already in order. Binary search keeps the
+ * 	number of comparisons at O(log n) per edit, which matters when
+ * 	the comparison is a -command script; equal keys insert after
+ * 	their peers so the order of unmodified items is preserved.
+ *
+ * 	Returns a standard Tcl result (a comparison script may fail).
+ */
+static int RepositionItem(Tcl_Interp *interp, Treeview *tv, TreeItem *item)
+{
+    SortContext ctx;
+    TreeItem *parent = item->parent, *sibling, **siblings;
+    Tcl_Size lo, hi, n;
+    int inPlace;
+
+    if (tv->tree.sortInProgress) {
+	/*
+	 * A comparison script is editing an item mid-sort; the
+	 * enclosing sort places every sibling when it relinks its
+	 * snapshot, so there is nothing to do here.
+	 */
+
+	return TCL_OK;
+    }
+
+    ctx.tv = tv;
+    ctx.interp = interp;
+    ctx.result = TCL_OK;
+    tv->tree.sortInProgress = 1;
+
+    /* Fast path: the item is still in position.  Each comparison may
+     * fail (or destroy the widget), so check ctx.result before looking
+     * at the item again.
+     */
+    inPlace = (item->prev == NULL
+	    || CompareItems(&ctx, item->prev, item) <= 0);
+    if (inPlace && ctx.result == TCL_OK && item->next != NULL) {
+	inPlace = (CompareItems(&ctx, item, item->next) <= 0);
+    }
+    if (inPlace || ctx.result != TCL_OK) {
+	tv->tree.sortInProgress = 0;
+	return ctx.result;
+    }
+
+    n = 0;
+    for (sibling = parent->children; sibling; sibling = sibling->next) {
+	if (sibling != item) {
+	    ++n;
+	}
+    }
+    siblings = (TreeItem **)ckalloc(n * sizeof(TreeItem *));
+    n = 0;
+    for (sibling = parent->children; sibling; sibling = sibling->next) {
+	if (sibling != item) {
+	    siblings[n++] = sibling;
+	}
+    }
+
+    lo = 0;
+    hi = n;
+    while (lo < hi) {
+	Tcl_Size mid = (lo + hi) / 2;
+	if (CompareItems(&ctx, siblings[mid], item) <= 0) {
+	    lo = mid + 1;
+	} else {
+	    hi = mid;
+	}
+    }
+    tv->tree.sortInProgress = 0;
+
+    if (ctx.result != TCL_OK) {
+	ckfree(siblings);
+	return TCL_ERROR;
+    }
+    DetachItem(item);
+    InsertItem(parent, lo ? siblings[lo-1] : NULL, item);
+    ckfree(siblings);
+    tv->tree.rowPosNeedsUpdate = 1;
+    return TCL_OK;
+}
+
+/* + $tv sort ?item? ?-column column? ?-command script? ?-descending? ?-dictionary?
+ * 	Sort the children of item (default: the whole tree) recursively.
+ * 	The criteria stay active: subsequent edits keep the order.
+ */
+static int TreeviewSortCommand(
+    void *recordPtr, Tcl_Interp *interp, Tcl_Size objc, Tcl_Obj *const objv[])
+{
+    enum { SORT_OPT_COLUMN, SORT_OPT_COMMAND,
+	   SORT_OPT_DESCENDING, SORT_OPT_DICTIONARY };
+    static const char *const optStrings[] = {
+	"-column", "-command", "-descending", "-dictionary", NULL };
+    Treeview *tv = (Treeview *)recordPtr;
+    TreeItem *item = tv->tree.root;
+    TreeColumn *column = &tv->tree.column0;
+    Tcl_Obj *commandObj = NULL;
+    int flags = 0;
+    SortContext ctx;
+    Tcl_Size i = 2;
+
+    if (SortLocked(interp, tv)) {
+	return TCL_ERROR;
+    }
+    if (objc > 2 && Tcl_GetString(objv[2])[0] != '-') {
+	if (!(item = FindItem(interp, tv, objv[2]))) {
+	    return TCL_ERROR;
+	}
+	++i;
+    }
+    for (; i < objc; ++i) {
+	int index;
+
+	if (Tcl_GetIndexFromObjStruct(interp, objv[i], optStrings,
+		sizeof(char *), "option", 0, &index) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	switch (index) {
+	    case SORT_OPT_COLUMN:
+	    case SORT_OPT_COMMAND:
+		if (i+1 >= objc) {
+		    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+			    "Missing value for option %s",
+			    Tcl_GetString(objv[i])));
+		    Tcl_SetErrorCode(interp, "TTK", "TREE", "SORT", NULL);
+		    return TCL_ERROR;
+		}
+		if (index == SORT_OPT_COLUMN) {
+		    if (!(column = FindColumn(interp, tv, objv[++i]))) {
+			return TCL_ERROR;
+		    }
+		} else {
+		    commandObj = objv[++i];
+		}
+		break;
+	    case SORT_OPT_DESCENDING:
+		flags |= SORT_DESCENDING;
+		break;
+	    case SORT_OPT_DICTIONARY:
+		flags |= SORT_DICTIONARY;
+		break;
+	}
+    }
+
+    /* Record the criteria, so that later edits can keep the order:
+     */
+    if (tv->tree.sortCommandObj) {
+	Tcl_DecrRefCount(tv->tree.sortCommandObj);
+	tv->tree.sortCommandObj = NULL;
+    }
+    if (commandObj) {
+	Tcl_IncrRefCount(commandObj);
+	tv->tree.sortCommandObj = commandObj;
+    }
+    tv->tree.sortColumn = column;
+    tv->tree.sortFlags = flags;
+    ++tv->tree.sortEpoch;	/* cached keys may be for another column */
+
+    ctx.tv = tv;
+    ctx.interp = interp;
+    ctx.result = TCL_OK;
+    tv->tree.sortInProgress = 1;
+    SortChildren(&ctx, item);
+    tv->tree.sortInProgress = 0;
+
+    if (WidgetDestroyed(&tv->core)) {
+	return TCL_ERROR;
+    }
+    tv->tree.rowPosNeedsUpdate = 1;
+    TtkRedisplayWidget(&tv->core);
+    return ctx.result;
+}
+
+/*------------------------------------------------------------------------
+ * +++ Widget commands -- type-ahead search.
+ *
+ * [$tv find] matches item text in C against an index of case-folded
+ * strings, sorted so that a prefix query is a binary search.  The
+ * index is built lazily by the first [$tv find] after a change and
+ * kept until items are added, removed, re-attached or retitled
+ * (see InvalidateFindIndex), so a burst of type-ahead keystrokes over
+ * a static tree pays one build and then a few string comparisons per
+ * key.
+ */
+
+/* + FoldString --
+ * 	Return a lowercased copy (ckalloc()d) of the string,
+ * 	for caseless matching.
+ */
+static char *FoldString(const char *s)
+{
+    char *folded = (char *)ckalloc(strlen(s) + 1);
+
+    strcpy(folded, s);
+    Tcl_UtfToLower(folded);
+    return folded;
+}
+
+/* + CompareFindEntries -- qsort() comparison, by folded text.
+ */
+static int CompareFindEntries(const void *a, const void *b)
+{
+    return strcmp(((const FindEntry *)a)->folded,
+	    ((const FindEntry *)b)->folded);
+}
+
+/* + BuildFindIndex --
+ * 	(Re)build the sorted text index over the given column for all
+ * 	items attached to the tree (detached items never match).
+ */
+static void BuildFindIndex(Treeview *tv, TreeColumn *column)
+{
+    TreeItem *item;
+    int n = 0;
+
+    InvalidateFindIndex(tv);
+    for (item = NextPreorder(tv->tree.root); item;
+	    item = NextPreorder(item)) {
+	++n;
+    }
+    if (n == 0) {
+	return;		/* rebuilding an empty index is free anyway */
+    }
+
+    tv->tree.findIndex = (FindEntry *)ckalloc(n * sizeof(FindEntry));
+    for (item = NextPreorder(tv->tree.root); item;
+	    item = NextPreorder(item)) {
+	Tcl_Obj *textObj = ItemColumnText(tv, item, column);
+	FindEntry *entry = tv->tree.findIndex + tv->tree.nFindEntries++;
+
+	entry->item = item;
+	entry->folded = FoldString(textObj ? Tcl_GetString(textObj) : "");
+    }
+    qsort(tv->tree.findIndex, n, sizeof(FindEntry), CompareFindEntries);
+    tv->tree.findColumn = column;
+}
+
+/* + $tv find ?-column column? -prefix text
+ *   $tv find ?-column column? -substring text
+ * 	Return the items whose text in the column (default: the tree
+ * 	column) matches the pattern case-insensitively, ordered by
+ * 	that text.
+ */
+static int TreeviewFindCommand(
+    void *recordPtr, Tcl_Interp *interp, Tcl_Size objc, Tcl_Obj *const objv[])
+{
+    enum { FIND_OPT_COLUMN, FIND_OPT_PREFIX, FIND_OPT_SUBSTRING };
+    static const char *const optStrings[] = {
+	"-column", "-prefix", "-substring", NULL };
+    Treeview *tv = (Treeview *)recordPtr;
+    TreeColumn *column = &tv->tree.column0;
+    Tcl_Obj *patternObj = NULL;
+    Tcl_Obj *result;
+    char *folded;
+    size_t patLen;
+    int substring = 0;
+    int i, lo, hi;
+    Tcl_Size j;
+
+    for (j = 2; j < objc; ++j) {
+	int index;
+
+	if (Tcl_GetIndexFromObjStruct(interp, objv[j], optStrings,
+		sizeof(char *), "option", 0, &index) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	if (j+1 >= objc) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "Missing value for option %s", Tcl_GetString(objv[j])));
+	    Tcl_SetErrorCode(interp, "TTK", "TREE", "FIND", NULL);
+	    return TCL_ERROR;
+	}
+	switch (index) {
+	    case FIND_OPT_COLUMN:
+		if (!(column = FindColumn(interp, tv, objv[++j]))) {
+		    return TCL_ERROR;
+		}
+		break;
+	    case FIND_OPT_PREFIX:
+	    case FIND_OPT_SUBSTRING:
+		patternObj = objv[++j];
+		substring = (index == FIND_OPT_SUBSTRING);
+		break;
+	}
+    }
+    if (!patternObj) {
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		"One of -prefix or -substring is required", -1));
+	Tcl_SetErrorCode(interp, "TTK", "TREE", "FIND", NULL);
+	return TCL_ERROR;
+    }
+
+    if (!tv->tree.findIndex || tv->tree.findColumn != column) {
+	BuildFindIndex(tv, column);
+    }
+
+    folded = FoldString(Tcl_GetString(patternObj));
+    patLen = strlen(folded);
+    result = Tcl_NewListObj(0, NULL);
+
+    if (substring) {
+	for (i = 0; i < tv->tree.nFindEntries; ++i) {
+	    if (strstr(tv->tree.findIndex[i].folded, folded)) {
+		Tcl_ListObjAppendElement(NULL, result,
+			ItemID(tv, tv->tree.findIndex[i].item));
+	    }
+	}
+    } else {
+	/* Lower bound by binary search, then walk the matching run
+	 * (every entry with this prefix compares >= the pattern, so
+	 * the run is contiguous):
+	 */
+	lo = 0;
+	hi = tv->tree.nFindEntries;
+	while (lo < hi) {
+	    int mid = (lo + hi) / 2;
+
+	    if (strcmp(tv->tree.findIndex[mid].folded, folded) < 0) {
+		lo = mid + 1;
+	    } else {
+		hi = mid;
+	    }
+	}
+	for (i = lo; i < tv->tree.nFindEntries
+		&& strncmp(tv->tree.findIndex[i].folded, folded, patLen) == 0;
+		++i) {
+	    Tcl_ListObjAppendElement(NULL, result,
+		    ItemID(tv, tv->tree.findIndex[i].item));
+	}
+    }
+
+    ckfree(folded);
+    Tcl_SetObjResult(interp, result);
+    return TCL_OK;
+}
+
 /*------------------------------------------------------------------------
  * +++ Widget commands -- scrolling
  */
@@ -4414,6 +5785,7 @@ static const Ttk_Ensemble TreeviewCommands[] = {
     { "drag",   	TreeviewDragCommand,0 },
     { "drop",   	TreeviewDropCommand,0 },
     { "exists", 	TreeviewExistsCommand,0 },
+    { "find", 		TreeviewFindCommand,0 },
     { "focus", 		TreeviewFocusCommand,0 },
     { "heading", 	TreeviewHeadingCommand,0 },
     { "identify",  	TreeviewIdentifyCommand,0 },
@@ -4428,6 +5800,7 @@ static const Ttk_Ensemble TreeviewCommands[] = {
     { "see", 		TreeviewSeeCommand,0 },
     { "selection" ,	TreeviewSelectionCommand,0 },
     { "set",  		TreeviewSetCommand,0 },
+    { "sort",  		TreeviewSortCommand,0 },
     { "state",  	TtkWidgetStateCommand,0 },
     { "style",		TtkWidgetStyleCommand,0 },
     { "tag",    	0,TreeviewTagCommands },
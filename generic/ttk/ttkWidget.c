@@ -97,10 +97,22 @@ static void DrawWidget(void *recordPtr)
 
     corePtr->flags &= ~REDISPLAY_PENDING;
     if (Tk_IsMapped(corePtr->tkwin)) {
-	Drawable d = BeginDrawing(corePtr->tkwin);
+	int recordPaint = TkPaintRecording();
+	Tcl_Time paintStart;
+	Drawable d;
+
+	if (recordPaint) {
+	    Tcl_GetTime(&paintStart);
+	}
+	d = BeginDrawing(corePtr->tkwin);
 	corePtr->widgetSpec->layoutProc(recordPtr);
 	corePtr->widgetSpec->displayProc(recordPtr, d);
 	EndDrawing(corePtr->tkwin, d);
+	corePtr->flags &= ~CONTENT_CHANGED;
+	if (recordPaint) {
+	    TkRecordPaint(corePtr->tkwin, &paintStart, 0, 0,
+		    Tk_Width(corePtr->tkwin), Tk_Height(corePtr->tkwin));
+	}
     }
 }
 
@@ -108,13 +120,25 @@ static void DrawWidget(void *recordPtr)
  * 	Schedule redisplay as an idle handler.
  */
 void TtkRedisplayWidget(WidgetCore *corePtr)
+{
+    corePtr->flags |= CONTENT_CHANGED;
+    TtkScheduleRedisplay(corePtr);
+}
+
+/* TtkScheduleRedisplay --
+ * 	Schedule a repaint without marking the widget content as
+ * 	changed.  Used for pure scrolls, so that the displayProc can
+ * 	tell (via CONTENT_CHANGED) whether the previous frame is still
+ * 	valid and may be blitted.
+ */
+void TtkScheduleRedisplay(WidgetCore *corePtr)
 {
     if (corePtr->flags & WIDGET_DESTROYED) {
 	return;
     }
 
     if (!(corePtr->flags & REDISPLAY_PENDING)) {
-	Tcl_DoWhenIdle(DrawWidget, corePtr);
+	TkDoWhenIdle(DrawWidget, corePtr, TK_IDLE_DISPLAY);
 	corePtr->flags |= REDISPLAY_PENDING;
     }
 }
@@ -153,7 +177,20 @@ void TtkWidgetChangeState(WidgetCore *corePtr,
 {
     Ttk_State oldState = corePtr->state;
     corePtr->state = (oldState & ~clearBits) | setBits;
-    if (corePtr->state ^ oldState) {
+    if (!(corePtr->state ^ oldState)) {
+	return;
+    }
+
+    /*
+     * Skip the redisplay when no element can look different under the
+     * new state (e.g. hover enter/leave on a style with no -active
+     * map entries); anything later that does change appearance will
+     * schedule its own redisplay.
+     */
+    if (corePtr->layout == NULL
+	    || Ttk_StateChangeSignificant(corePtr->interp,
+		    Ttk_LayoutStyle(corePtr->layout),
+		    oldState, corePtr->state)) {
 	TtkRedisplayWidget(corePtr);
     }
 }
@@ -224,7 +261,7 @@ DestroyWidget(WidgetCore *corePtr)
     }
 
     if (corePtr->flags & REDISPLAY_PENDING) {
-	Tcl_CancelIdleCall(DrawWidget, corePtr);
+	TkCancelDoWhenIdle(DrawWidget, corePtr);
     }
 
     corePtr->tkwin = NULL;
@@ -393,6 +430,13 @@ int TtkWidgetConstructorObjCmd(
     Tk_SetClassProcs(tkwin, &widgetClassProcs, recordPtr);
     Tk_SetWindowBackgroundPixmap(tkwin, ParentRelative);
 
+    /*
+     * The layout's background element fills the whole window, so the
+     * widget is opaque to its container even though its X background is
+     * ParentRelative.
+     */
+    ((TkWindow *)tkwin)->flags |= TK_WIN_OPAQUE;
+
     widgetSpec->initializeProc(interp, recordPtr);
 
     Tk_CreateEventHandler(tkwin, CoreEventMask, CoreEventProc, recordPtr);
@@ -656,6 +700,10 @@ int TtkWidgetConfigureCommand(
 	}
 
 	if (mask & (STYLE_CHANGED | GEOMETRY_CHANGED)) {
+	    /*
+	     * Element sizes may depend on the changed options.
+	     */
+	    TtkLayoutCacheInvalidate(corePtr->layout);
 	    SizeChanged(corePtr);
 	}
 
@@ -12,6 +12,11 @@
 #define WIDGET_DESTROYED	0x0001
 #define REDISPLAY_PENDING 	0x0002	/* scheduled call to RedisplayWidget */
 #define CURSOR_ON 		0x0020	/* See TtkBlinkCursor() */
+#define CONTENT_CHANGED		0x0040	/* Widget content changed since the
+					 * last repaint; when clear, a pending
+					 * repaint is a pure scroll and the
+					 * displayProc may blit unchanged
+					 * regions of the previous frame. */
 #define WIDGET_USER_FLAG        0x0100  /* 0x0100 - 0x8000 for user flags */
 
 /*
@@ -151,6 +156,7 @@ MODULE_SCOPE void TtkWidgetChangeState(WidgetCore *,
 	unsigned int setBits, unsigned int clearBits);
 
 MODULE_SCOPE void TtkRedisplayWidget(WidgetCore *);
+MODULE_SCOPE void TtkScheduleRedisplay(WidgetCore *);
 MODULE_SCOPE void TtkResizeWidget(WidgetCore *);
 
 MODULE_SCOPE void TtkTrackElementState(WidgetCore *);
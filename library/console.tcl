@@ -19,6 +19,10 @@ namespace eval ::tk::console {
     variable blinkRange  1   ; # enable blinking of the entire braced range
     variable magicKeys   1   ; # enable brace matching and proc/var recognition
     variable maxLines    600 ; # maximum # of lines buffered in console
+    variable maxPendingSize 100000 ; # max chars of output buffered while
+				   ; # the console is hidden
+    variable pending     {}  ; # dest/string pairs held while hidden
+    variable pendingSize 0   ; # total chars currently held in pending
     variable showMatches 1   ; # show multiple expand matches
     variable useFontchooser [llength [info command ::tk::fontchooser]]
     variable inPlugin [info exists embed_args]
@@ -618,6 +622,9 @@ proc ::tk::ConsoleBind {w} {
     bind Console <<Console_FitScreenWidth>> {
 	::tk::console::FitScreenWidth %W
     }
+    bind Console <Map> {
+	::tk::ConsoleFlush {}
+    }
 
     ##
     ## Bindings for doing special things based on certain keys
@@ -688,8 +695,42 @@ proc ::tk::ConsoleInsert {w s} {
 # string -	The string to be displayed.
 
 proc ::tk::ConsoleOutput {dest string} {
+    ConsoleFlush [list $dest $string]
+}
+
+# ::tk::ConsoleFlush --
+#
+# Called from C once per event-loop cycle with all of the output that
+# accumulated since the last flush, and displays it with a single
+# insert.  While the console is withdrawn nothing is rendered at all:
+# a bounded tail of the output is saved instead and displayed when the
+# console is next mapped, so a hidden console stays cheap under heavy
+# logging.
+#
+# Arguments:
+# pairs -	List of alternating dest/string elements, where dest is
+#		"stderr" or "stdout".  May be empty (used by the <Map>
+#		binding to push out saved output).
+
+proc ::tk::ConsoleFlush {pairs} {
     set w .console
-    $w insert output $string $dest
+    if {![winfo ismapped $w]} {
+	::tk::console::SavePending $pairs
+	return
+    }
+    if {[llength $::tk::console::pending]} {
+	set pairs [concat $::tk::console::pending $pairs]
+	set ::tk::console::pending {}
+	set ::tk::console::pendingSize 0
+    }
+    if {![llength $pairs]} {
+	return
+    }
+    set iargs {}
+    foreach {dest string} $pairs {
+	lappend iargs $string $dest
+    }
+    $w insert output {*}$iargs
     ::tk::console::ConstrainBuffer $w $::tk::console::maxLines
     $w see insert
 }
@@ -917,6 +958,42 @@ proc ::tk::console::ConstrainBuffer {w size} {
     }
 }
 
+# ::tk::console::SavePending --
+#
+# Remember output that arrived while the console was hidden, keeping at
+# most maxPendingSize characters.  The oldest output is discarded first,
+# mirroring what ConstrainBuffer would have scrolled away had the
+# console been visible.
+# Called by ConsoleFlush
+#
+# Arguments:
+#	pairs	- list of alternating dest/string elements
+#
+# Outputs:
+#	may discard previously saved output
+
+proc ::tk::console::SavePending {pairs} {
+    variable pending
+    variable pendingSize
+    variable maxPendingSize
+    foreach {dest string} $pairs {
+	lappend pending $dest $string
+	incr pendingSize [string length $string]
+    }
+    while {$pendingSize > $maxPendingSize} {
+	set string [lindex $pending 1]
+	set over [expr {$pendingSize - $maxPendingSize}]
+	if {[string length $string] <= $over} {
+	    incr pendingSize -[string length $string]
+	    set pending [lrange $pending 2 end]
+	} else {
+	    set pending [lreplace $pending 1 1 \
+		    [string range $string $over end]]
+	    incr pendingSize -$over
+	}
+    }
+}
+
 # ::tk::console::Expand --
 #
 # Arguments:
@@ -74,12 +74,43 @@ proc ::tk::panedwindow::DragSash {w x y proxy} {
 	if {$proxy} {
 	    $w proxy place [expr {$x+$Priv(dx)}] [expr {$y+$Priv(dy)}]
 	} else {
-	    $w sash place $Priv(sash) \
-		    [expr {$x+$Priv(dx)}] [expr {$y+$Priv(dy)}]
+	    # Opaque resize: don't re-arrange the panes for every motion
+	    # event, which arrives much faster than the panes can be laid
+	    # out and repainted.  Remember the latest position and let
+	    # DragTick apply it at ~30 Hz.
+	    set Priv(panedDragPos) \
+		    [list [expr {$x+$Priv(dx)}] [expr {$y+$Priv(dy)}]]
+	    if {![info exists Priv(panedDragTimer)]} {
+		DragTick $w
+	    }
 	}
     }
 }
 
+# ::tk::panedwindow::DragTick --
+#
+#   Apply the most recent opaque-drag position, then hold further
+#   relayouts for 33 ms (~30 Hz).  The chain stops by itself once no
+#   new position has come in; ReleaseSash always applies the final one.
+#
+# Arguments:
+#   w		the widget
+# Results:
+#   Moves sash
+#
+proc ::tk::panedwindow::DragTick {w} {
+    variable ::tk::Priv
+    unset -nocomplain Priv(panedDragTimer)
+    if {![info exists Priv(sash)] || ![info exists Priv(panedDragPos)]
+	    || ![winfo exists $w]} {
+	return
+    }
+    lassign $Priv(panedDragPos) x y
+    unset Priv(panedDragPos)
+    $w sash place $Priv(sash) $x $y
+    set Priv(panedDragTimer) [after 33 [list ::tk::panedwindow::DragTick $w]]
+}
+
 # ::tk::panedwindow::ReleaseSash --
 #
 #   Handle releasing of the sash
@@ -95,11 +126,19 @@ proc ::tk::panedwindow::ReleaseSash {w proxy} {
     if {[$w cget -opaqueresize]} {
 	set proxy 0
     }
+    if {[info exists Priv(panedDragTimer)]} {
+	after cancel $Priv(panedDragTimer)
+	unset Priv(panedDragTimer)
+    }
     if {[info exists Priv(sash)]} {
 	if {$proxy} {
 	    lassign [$w proxy coord] x y
 	    $w sash place $Priv(sash) $x $y
 	    $w proxy forget
+	} elseif {[info exists Priv(panedDragPos)]} {
+	    lassign $Priv(panedDragPos) x y
+	    unset Priv(panedDragPos)
+	    $w sash place $Priv(sash) $x $y
 	}
 	unset Priv(sash) Priv(dx) Priv(dy)
     }
@@ -508,15 +508,25 @@ if {$::tk_library ne ""} {
 	SourceLibFile listbox
 	SourceLibFile menu
 	SourceLibFile panedwindow
-	SourceLibFile print
 	SourceLibFile scale
 	SourceLibFile scrlbar
 	SourceLibFile spinbox
-	if {![interp issafe]} {
-	    SourceLibFile systray
-	}
 	SourceLibFile text
     }
+
+    # The printing and system-tray scripts are large and most applications
+    # never touch them, so don't source them now: just register their entries
+    # in the "tk" ensemble here and let [unknown] pull the implementations in
+    # from tclIndex on first use.
+
+    namespace ensemble configure tk -map \
+	    [dict merge [namespace ensemble configure tk -map] \
+		{print ::tk::print}]
+    if {![interp issafe]} {
+	namespace ensemble configure tk -map \
+		[dict merge [namespace ensemble configure tk -map] \
+		    {systray ::tk::systray sysnotify ::tk::sysnotify::sysnotify}]
+    }
 }
 
 # ----------------------------------------------------------------------
@@ -30,7 +30,10 @@
 #
 
 namespace eval ttk::combobox {
-    variable Values	;# Values($cb) is -listvariable of listbox widget
+    variable Values	;# Values($popdown) is -listvariable of the shared
+			 # popdown listbox
+    variable Owner	;# Owner($popdown) is the combobox a shared popdown
+			 # is currently posted for
     variable State
     set State(entryPress) 0
 }
@@ -64,6 +67,7 @@ bind TCombobox <TouchpadScroll> {
     }
 }
 bind TCombobox <<TraverseIn>> 		{ ttk::combobox::TraverseIn %W }
+bind TCombobox <Destroy>		{ ttk::combobox::Cleanup %W }
 
 ### Combobox listbox bindings.
 #
@@ -83,7 +87,7 @@ switch -- [tk windowingsystem] {
 	bind ComboboxListbox <FocusOut>		{ ttk::combobox::LBCancel %W }
     }
     aqua {
-	bind TCombobox <Destroy>		{ ttk::combobox::AquaCleanup %W }
+	bind ComboboxPopdown <Destroy>		{ ttk::combobox::AquaCleanup %W }
     }
 }
 
@@ -92,7 +96,7 @@ switch -- [tk windowingsystem] {
 bind ComboboxPopdown	<Map>		{ ttk::combobox::MapPopdown %W }
 bind ComboboxPopdown	<Unmap>		{ ttk::combobox::UnmapPopdown %W }
 bind ComboboxPopdown	<Button> \
-			{ ttk::combobox::Unpost [winfo parent %W] }
+			{ ttk::combobox::Unpost [ttk::combobox::PopdownOwner %W] }
 
 ### Option database settings.
 #
@@ -255,32 +259,73 @@ proc ttk::combobox::LBHover {w x y} {
 ## MapPopdown -- <Map> binding for ComboboxPopdown
 #
 proc ttk::combobox::MapPopdown {w} {
-    [winfo parent $w] state pressed
+    [PopdownOwner $w] state pressed
     ttk::globalGrab $w
 }
 
 ## UnmapPopdown -- <Unmap> binding for ComboboxPopdown
 #
 proc ttk::combobox::UnmapPopdown {w} {
-    [winfo parent $w] state !pressed
+    variable Owner
+    if {![info exists Owner($w)]} {
+	# [Cleanup] already released the grab when the owning combobox
+	# was destroyed while the popdown was posted.
+	return
+    }
+    [PopdownOwner $w] state !pressed
     ttk::releaseGrab $w
 }
 
+## PopdownShell --
+#	Returns the window path of the shared popdown toplevel for a
+#	combobox.  A single popdown is created per containing toplevel
+#	and reconfigured for whichever combobox posts it, instead of
+#	constructing one listbox (or menu) per widget.
+#
+proc ttk::combobox::PopdownShell {cb} {
+    set top [winfo toplevel $cb]
+    if {$top eq "."} {
+	set top {}
+    }
+    return $top.__combobox_popdown
+}
+
+## PopdownOwner --
+#	Returns the combobox a shared popdown window is currently
+#	posted for.
+#
+proc ttk::combobox::PopdownOwner {popdown} {
+    variable Owner
+    return $Owner($popdown)
+}
+
 ## PopdownWindow --
-#	Returns the popdown widget associated with a combobox,
-#	creating it if necessary.
+#	Returns the shared popdown widget for a combobox, creating it
+#	if necessary and claiming it for that combobox.
 #
 
 if {[tk windowingsystem] ne "aqua"} {
     proc ttk::combobox::PopdownWindow {cb} {
-	if {![winfo exists $cb.popdown]} {
-	    set poplevel [PopdownToplevel $cb.popdown]
-	    set popdown [ttk::frame $poplevel.f -style ComboboxPopdownFrame]
+	variable Owner
+
+	set poplevel [PopdownShell $cb]
+	if {![winfo exists $poplevel]} {
+	    PopdownToplevel $poplevel
+
+	    # The frame carries class TCombobox so that option database
+	    # patterns of the documented form "*TCombobox*Listbox.font"
+	    # keep matching the listbox now that the shared popdown no
+	    # longer lives underneath a combobox's window path.  Its
+	    # bindtags are reset so combobox class bindings don't fire
+	    # on the frame itself.
+	    set popdown [ttk::frame $poplevel.f \
+		-class TCombobox -style ComboboxPopdownFrame]
+	    bindtags $popdown [list $popdown TFrame $poplevel all]
 
 	    ttk::scrollbar $popdown.sb \
 		-orient vertical -command [list $popdown.l yview]
 	    listbox $popdown.l \
-		-listvariable ttk::combobox::Values($cb) \
+		-listvariable ttk::combobox::Values($poplevel) \
 		-yscrollcommand [list $popdown.sb set] \
 		-exportselection false \
 		-selectmode browse \
@@ -299,22 +344,27 @@ if {[tk windowingsystem] ne "aqua"} {
 	    grid rowconfigure $poplevel 0 -weight 1
 	    grid columnconfigure $poplevel 0 -weight 1
 	}
-	return $cb.popdown
+	set Owner($poplevel) $cb
+	return $poplevel
     }
 } else {
     proc ttk::combobox::PopdownWindow {cb} {
-	if {![winfo exists $cb.popdown]} {
-	    set poplevel [PopdownToplevel $cb.popdown]
+	variable Owner
+
+	set poplevel [PopdownShell $cb]
+	if {![winfo exists $poplevel]} {
+	    PopdownToplevel $poplevel
 	    # The menu should be (at least) the same length as the button.
 	    # Since there is no direct way to control the width of a menu
 	    # in Tk, we fake it by using an invisible image in a disabled
 	    # menu item, adjusting the image size to make the menu be the
 	    # correct width.
-	    image create nsimage $cb.spacer -source NSStatusNone -as name \
+	    image create nsimage $poplevel.spacer -source NSStatusNone -as name \
 		-alpha 0
-	    set menu [menu $cb.popdown.menu -tearoff 0]
+	    menu $poplevel.menu -tearoff 0
 	}
-	return $cb.popdown
+	set Owner($poplevel) $cb
+	return $poplevel
     }
 }
 
@@ -352,13 +402,14 @@ proc ttk::combobox::PopdownToplevel {w} {
 proc ttk::combobox::ConfigureListbox {cb} {
     variable Values
 
-    set popdown [PopdownWindow $cb].f
+    set poplevel [PopdownWindow $cb]
+    set popdown $poplevel.f
     set values [$cb cget -values]
     set current [$cb current]
     if {$current < 0} {
 	set current 0 		;# no current entry, highlight first one
     }
-    set Values($cb) $values
+    set Values($poplevel) $values
     $popdown.l selection clear 0 end
     $popdown.l selection set $current
     $popdown.l activate $current
@@ -382,8 +433,8 @@ proc ttk::combobox::ConfigureAquaMenu {cb width} {
     if {$current < 0} {
 	set current 0 		;# no current entry, highlight first one
     }
-    $cb.popdown.menu delete 0 end
-    $cb.spacer configure -width [expr {$width - 40}] -height 1
+    $popdown.menu delete 0 end
+    $popdown.spacer configure -width [expr {$width - 40}] -height 1
     set i 0
     foreach item $values {
 	if {$i == 0} {
@@ -393,10 +444,10 @@ proc ttk::combobox::ConfigureAquaMenu {cb width} {
 	    while {[font measure $menufont $stretch] < [expr {$width - 32}]} {
 		set stretch "$stretch "
 	    }
-	    $cb.popdown.menu add command -label "$stretch" \
+	    $popdown.menu add command -label "$stretch" \
 		-command "ttk::combobox::SelectEntry $cb $i"
 	} else {
-	    $cb.popdown.menu add command -label "$item" \
+	    $popdown.menu add command -label "$item" \
 		-command "ttk::combobox::SelectEntry $cb $i"
 	}
 	incr i
@@ -404,7 +455,7 @@ proc ttk::combobox::ConfigureAquaMenu {cb width} {
     if { $i == 0 } {
 	# There are no items.  To make an empty menu appear add a dummy item
 	# containing a transparent image of the right width.
-	$cb.popdown.menu add command -label {} -image $cb.spacer -state disabled
+	$popdown.menu add command -label {} -image $popdown.spacer -state disabled
     }
 }
 
@@ -511,17 +562,20 @@ if {[tk windowingsystem] ne "aqua"} {
 #	Unpost the listbox.
 #
 proc ttk::combobox::Unpost {cb} {
-    if {[winfo exists $cb.popdown]} {
-	wm withdraw $cb.popdown
+    set poplevel [PopdownShell $cb]
+    if {![winfo exists $poplevel] || [PopdownOwner $poplevel] ne $cb} {
+	return
     }
-    grab release $cb.popdown ;# in case of stuck or unexpected grab [#1239190]
+    wm withdraw $poplevel
+    grab release $poplevel ;# in case of stuck or unexpected grab [#1239190]
 }
 
 ## LBMain $lb --
-#	Return the combobox main widget that owns the listbox.
+#	Return the combobox main widget the listbox is currently
+#	posted for.
 #
 proc ttk::combobox::LBMain {lb} {
-    winfo parent [winfo parent [winfo parent $lb]]
+    PopdownOwner [winfo parent [winfo parent $lb]]
 }
 
 ## LBSelect $lb --
@@ -535,9 +589,30 @@ proc ttk::combobox::LBSelect {lb} {
     }
 }
 
+## Cleanup $cb --
+#	<Destroy> binding for comboboxes.
+#	If the destroyed combobox currently owns the shared popdown, the
+#	popdown would stay mapped with the global grab held and a stale
+#	owner entry that later [PopdownOwner] calls trip over; withdraw
+#	it, drop the grab and clear the entry.  (LBCleanup only covers
+#	the popdown itself being destroyed.)
+#
+proc ttk::combobox::Cleanup {cb} {
+    variable Owner
+    set poplevel [PopdownShell $cb]
+    if {[info exists Owner($poplevel)] && $Owner($poplevel) eq $cb} {
+	unset Owner($poplevel)
+	if {[winfo exists $poplevel]} {
+	    wm withdraw $poplevel
+	    ttk::releaseGrab $poplevel
+	}
+    }
+}
+
 ## LBCleanup $lb --
 #	<Destroy> binding for combobox listboxes.
-#	Cleans up by unsetting the linked textvariable.
+#	Cleans up by unsetting the linked textvariable and the owner
+#	entry of the shared popdown.
 #
 #	Note: we can't just use { unset [%W cget -listvariable] }
 #	because the widget command is already gone when this binding fires).
@@ -545,11 +620,19 @@ proc ttk::combobox::LBSelect {lb} {
 #
 proc ttk::combobox::LBCleanup {lb} {
     variable Values
-    unset Values([LBMain $lb])
+    variable Owner
+    set poplevel [winfo parent [winfo parent $lb]]
+    unset -nocomplain Values($poplevel) Owner($poplevel)
 }
 
-proc ttk::combobox::AquaCleanup {cb} {
-    catch {image delete $cb.spacer}
+## AquaCleanup $popdown --
+#	<Destroy> binding for shared popdowns on aqua:
+#	deletes the width-spacer image and the owner entry.
+#
+proc ttk::combobox::AquaCleanup {popdown} {
+    variable Owner
+    catch {image delete $popdown.spacer}
+    unset -nocomplain Owner($popdown)
 }
 
 #*EOF*
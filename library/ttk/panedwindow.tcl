@@ -10,6 +10,8 @@ namespace eval ttk::panedwindow {
 	pressY	-
 	sash 	-
 	sashPos -
+	dragPos -
+	dragTimer {}
     }
 }
 
@@ -40,6 +42,7 @@ proc ttk::panedwindow::Press {w x y} {
     set State(pressY) 	$y
     set State(sash) 	$sash
     set State(sashPos)	[$w sashpos $sash]
+    set State(dragPos)	-
 }
 
 proc ttk::panedwindow::Drag {w x y} {
@@ -49,11 +52,41 @@ proc ttk::panedwindow::Drag {w x y} {
     	h*  { set delta [expr {$x - $State(pressX)}] }
     	v*  { set delta [expr {$y - $State(pressY)}] }
     }
-    $w sashpos $State(sash) [expr {$State(sashPos) + $delta}]
+    set State(dragPos) [expr {$State(sashPos) + $delta}]
+    if {$State(dragTimer) eq ""} {
+	DragTick $w
+    }
+}
+
+## DragTick -- apply the most recent drag position, then hold further
+#	relayouts for 33 ms (~30 Hz).  A fast drag delivers motion
+#	events much faster than the panes can be re-arranged and
+#	repainted, so intermediate positions are coalesced; the chain
+#	stops by itself once no new position has come in, and Release
+#	always applies the final one.
+#
+proc ttk::panedwindow::DragTick {w} {
+    variable State
+    set State(dragTimer) {}
+    if {!$State(pressed) || $State(dragPos) eq "-" || ![winfo exists $w]} {
+	return
+    }
+    set pos $State(dragPos)
+    set State(dragPos) -
+    $w sashpos $State(sash) $pos
+    set State(dragTimer) [after 33 [list ttk::panedwindow::DragTick $w]]
 }
 
 proc ttk::panedwindow::Release {w x y} {
     variable State
+    if {$State(dragTimer) ne ""} {
+	after cancel $State(dragTimer)
+	set State(dragTimer) {}
+    }
+    if {$State(pressed) && $State(dragPos) ne "-"} {
+	$w sashpos $State(sash) $State(dragPos)
+	set State(dragPos) -
+    }
     set State(pressed) 0
     SetCursor $w $x $y
 }
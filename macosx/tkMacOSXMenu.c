@@ -31,6 +31,19 @@
 #define ENTRY_APPLE_MENU	ENTRY_PLATFORM_FLAG2
 #define ENTRY_WINDOWS_MENU	ENTRY_PLATFORM_FLAG3
 
+/*
+ * ENTRY_RECONFIGURE_PENDING
+ *			Non-zero means that the NSMenuItem of this entry is
+ *			out of date and will be rebuilt by the idle handler.
+ * MENU_RECONFIGURE_PENDING
+ *			Non-zero means that an idle handler has been set up to
+ *			reconfigure the NSMenuItems of this menu (c.f.
+ *			tkWinMenu.c).
+ */
+
+#define ENTRY_RECONFIGURE_PENDING	ENTRY_PLATFORM_FLAG4
+#define MENU_RECONFIGURE_PENDING	MENU_PLATFORM_FLAG1
+
 #define sl(s) ((int) (sizeof(s "") - 1))
 
 #define SPECIALMENU(n, f) {.name = "." #n, .len = sl(#n) + 1, \
@@ -99,11 +112,33 @@ static SInt16 menuSeparatorHeight = 0;
 
 static void	CheckForSpecialMenu(TkMenu *menuPtr);
 static NSString *ParseAccelerator(const char *accel, NSUInteger *maskPtr);
+static int	ConfigureMenuEntryNow(TkMenuEntry *mePtr);
 static int	GenerateMenuSelectEvent(TKMenu *menu, NSMenuItem *menuItem);
 static void	MenuSelectEvent(TkMenu *menuPtr);
+static void	ReconfigureMacintoshMenu(void *clientData);
 static void	RecursivelyClearActiveMenu(TkMenu *menuPtr);
 static int	ModifierCharWidth(Tk_Font tkfont);
 
+static inline void
+ScheduleMenuReconfigure(
+    TkMenu *menuPtr)
+{
+    if (!(menuPtr->menuFlags & MENU_RECONFIGURE_PENDING)) {
+	menuPtr->menuFlags |= MENU_RECONFIGURE_PENDING;
+	Tcl_DoWhenIdle(ReconfigureMacintoshMenu, menuPtr);
+    }
+}
+
+static inline void
+CallPendingReconfigureImmediately(
+    TkMenu *menuPtr)
+{
+    if (menuPtr->menuFlags & MENU_RECONFIGURE_PENDING) {
+	Tcl_CancelIdleCall(ReconfigureMacintoshMenu, menuPtr);
+	ReconfigureMacintoshMenu(menuPtr);
+    }
+}
+
 #pragma mark TkBackgroundLoop
 
 /*
@@ -387,6 +422,10 @@ static Bool runMenuCommand = true;
 {
     (void)menu;
 
+    if (_tkMenu) {
+	CallPendingReconfigureImmediately((TkMenu *)_tkMenu);
+    }
+
     /*
      * Use lowercaseString when comparing keyEquivalents since the notion of
      * a shifted upper case letter does not make much sense.
@@ -487,6 +526,7 @@ static Bool runMenuCommand = true;
 	      Tcl_AddErrorInfo(interp, "\n    (menu preprocess)");
 	      Tcl_BackgroundException(interp, result);
 	}
+	CallPendingReconfigureImmediately(menuPtr);
 	Tcl_Release(menuPtr);
 	Tcl_Release(interp);
     }
@@ -656,6 +696,10 @@ TkpDestroyMenu(
 {
     NSMenu* nsmenu = (NSMenu*)(menuPtr->platformData);
 
+    if (menuPtr->menuFlags & MENU_RECONFIGURE_PENDING) {
+	Tcl_CancelIdleCall(ReconfigureMacintoshMenu, menuPtr);
+	menuPtr->menuFlags &= ~MENU_RECONFIGURE_PENDING;
+    }
     [nsmenu release];
     menuPtr->platformData = NULL;
 }
@@ -706,15 +750,21 @@ TkpMenuNewEntry(
  *
  * TkpConfigureMenuEntry --
  *
- *	Processes configurations for menu entries.
+ *	Processes configurations for menu entries.  Rebuilding an NSMenuItem
+ *	is relatively expensive (attributed title, accelerator parsing, image
+ *	conversion), so rather than realizing each change immediately the
+ *	entry is marked and an idle handler is scheduled which brings all
+ *	marked entries of the menu up to date in one pass, as the Windows
+ *	port does.  Code which consults the NSMenu before the idle handler
+ *	has run must call CallPendingReconfigureImmediately first.
  *
  * Results:
  *	Returns standard TCL result. If TCL_ERROR is returned, then the
  *	interp's result contains an error message.
  *
  * Side effects:
- *	Configuration information get set for mePtr; old resources get freed,
- *	if any need it.
+ *	An idle handler may be scheduled; the NSMenuItem is updated when it
+ *	runs.
  *
  *----------------------------------------------------------------------
  */
@@ -723,6 +773,35 @@ int
 TkpConfigureMenuEntry(
     TkMenuEntry *mePtr) 	/* Information about menu entry; may or may
 				 * not already have values for some fields. */
+{
+    mePtr->entryFlags |= ENTRY_RECONFIGURE_PENDING;
+    ScheduleMenuReconfigure(mePtr->menuPtr);
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ConfigureMenuEntryNow --
+ *
+ *	Brings the NSMenuItem of a menu entry up to date with the generic
+ *	entry record.  Called from ReconfigureMacintoshMenu for each entry
+ *	marked ENTRY_RECONFIGURE_PENDING.
+ *
+ * Results:
+ *	Returns standard TCL result.
+ *
+ * Side effects:
+ *	Configuration information get set for mePtr; old resources get freed,
+ *	if any need it.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ConfigureMenuEntryNow(
+    TkMenuEntry *mePtr) 	/* Information about menu entry; may or may
+				 * not already have values for some fields. */
 {
     NSMenuItem *menuItem = (NSMenuItem *) mePtr->platformEntryData;
     NSString *title = @"";
@@ -869,6 +948,45 @@ TkpConfigureMenuEntry(
     return TCL_OK;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * ReconfigureMacintoshMenu --
+ *
+ *	Idle handler which reconfigures the NSMenuItem of every entry of the
+ *	menu that was marked by TkpConfigureMenuEntry, so that a burst of
+ *	entry configurations costs a single pass over the menu.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	NSMenuItems get updated.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ReconfigureMacintoshMenu(
+    void *clientData)		/* The menu being updated. */
+{
+    TkMenu *menuPtr = (TkMenu *)clientData;
+    Tcl_Size i;
+
+    menuPtr->menuFlags &= ~MENU_RECONFIGURE_PENDING;
+    if (!menuPtr->platformData) {
+	return;
+    }
+    for (i = 0; i < menuPtr->numEntries; i++) {
+	TkMenuEntry *mePtr = menuPtr->entries[i];
+
+	if (mePtr->entryFlags & ENTRY_RECONFIGURE_PENDING) {
+	    mePtr->entryFlags &= ~ENTRY_RECONFIGURE_PENDING;
+	    ConfigureMenuEntryNow(mePtr);
+	}
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -990,6 +1108,8 @@ TkpPostMenu(
     	return TCL_OK;
     }
 
+    CallPendingReconfigureImmediately(menuPtr);
+
     [menu popUpMenuPositioningItem:item
 			atLocation:[win tkConvertPointFromScreen:location]
 			    inView:view];
@@ -1190,6 +1310,7 @@ Tk_SetMainMenubar(
 	 */
 
 	if (menubar != NULL && strcmp(menuName, Tk_PathName(menubar)) == 0) {
+	    CallPendingReconfigureImmediately(winPtr->wmInfoPtr->menuPtr);
 	    menu = (TKMenu *) winPtr->wmInfoPtr->menuPtr->platformData;
 	} else {
 	    TkMenuReferences *menuRefPtr = TkFindMenuReferences(interp,
@@ -1197,6 +1318,7 @@ Tk_SetMainMenubar(
 
 	    if (menuRefPtr && menuRefPtr->menuPtr &&
 		    menuRefPtr->menuPtr->platformData) {
+		CallPendingReconfigureImmediately(menuRefPtr->menuPtr);
 		menu = (TKMenu *) menuRefPtr->menuPtr->platformData;
 	    }
 	}
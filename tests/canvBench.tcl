@@ -0,0 +1,150 @@
+# canvBench.tcl --
+#
+# Canvas scalability benchmark.  This is a performance harness, not part of
+# the correctness suite: it times item creation, tag searching, coordinate
+# updates, hit testing and full redraw at several scene sizes and prints one
+# machine-readable line per measurement, so downstream builds can compare
+# runs and catch regressions.  Execute it directly with tktest or wish, or
+# via "make bench" in the unix build directory.
+#
+# Each result line has the tab-separated form
+#
+#	BENCH	<operation>	<items>	<iters>	<total-us>	<us-per-iter>
+#
+# Options (after the script name):
+#	-scales list	Scene sizes to run (default: 1000 10000 100000).
+#			Add 1000000 for the large configuration.
+#	-ops list	Operations to time (default: all of create withtag
+#			coords move closest overlapping redraw).
+#	-geometry spec	Accepted and applied to the toplevel, for symmetry
+#			with the test targets.
+
+package require tk
+
+set scales {1000 10000 100000}
+set allOps {create withtag coords move closest overlapping redraw}
+set ops $allOps
+
+foreach {flag value} $argv {
+    switch -- $flag {
+	-scales	{ set scales $value }
+	-ops	{ set ops $value }
+	-geometry { wm geometry . $value }
+	default {
+	    puts stderr "unknown option \"$flag\": must be -scales, -ops or -geometry"
+	    exit 1
+	}
+    }
+}
+foreach op $ops {
+    if {$op ni $allOps} {
+	puts stderr "unknown operation \"$op\": must be one of $allOps"
+	exit 1
+    }
+}
+
+canvas .c -width 800 -height 600 -scrollregion {0 0 4000 4000}
+pack .c -fill both -expand 1
+wm title . "canvas benchmark"
+update
+
+proc emit {op n iters us} {
+    puts [format "BENCH\t%s\t%d\t%d\t%d\t%.3f" \
+	    $op $n $iters $us [expr {double($us) / $iters}]]
+    flush stdout
+}
+
+# Build a scene of n items: a deterministic mix of lines, rectangles and
+# text spread over the scroll region, each carrying a shared "probe" tag and
+# one of ten group tags so that tag searches hit a tenth of the scene.
+
+proc fillScene {n} {
+    for {set i 0} {$i < $n} {incr i} {
+	set x [expr {($i * 37) % 3900}]
+	set y [expr {($i * 91) % 3900}]
+	set tags [list probe grp[expr {$i % 10}]]
+	switch [expr {$i % 3}] {
+	    0 {
+		.c create line $x $y [expr {$x + 30}] [expr {$y + 12}] \
+			-tags $tags
+	    }
+	    1 {
+		.c create rectangle $x $y [expr {$x + 18}] [expr {$y + 18}] \
+			-tags $tags
+	    }
+	    2 {
+		.c create text $x $y -text $i -tags $tags
+	    }
+	}
+    }
+}
+
+foreach n $scales {
+    .c delete all
+    update idletasks
+
+    if {"create" in $ops} {
+	emit create $n $n [lindex [time {fillScene $n}] 0]
+    } else {
+	fillScene $n
+    }
+    update idletasks
+
+    if {"withtag" in $ops} {
+	set iters 50
+	emit withtag $n $iters [lindex [time {
+	    .c find withtag grp3
+	} $iters] 0]
+    }
+
+    if {"coords" in $ops} {
+	# Batched coordinate replacement of every item in one group.
+	set batch {}
+	foreach id [.c find withtag grp0] {
+	    set c [.c coords $id]
+	    lappend batch $id [lmap v $c {expr {$v + 1}}]
+	}
+	set iters 10
+	emit coords $n $iters [lindex [time {
+	    .c coords -batch {*}$batch
+	} $iters] 0]
+	update idletasks
+    }
+
+    if {"move" in $ops} {
+	set iters 10
+	emit move $n $iters [lindex [time {
+	    .c move probe 1 1
+	} $iters] 0]
+	update idletasks
+    }
+
+    if {"closest" in $ops} {
+	set iters 200
+	set i 0
+	emit closest $n $iters [lindex [time {
+	    .c find closest [expr {([incr i] * 53) % 3900}] \
+		    [expr {($i * 17) % 3900}]
+	} $iters] 0]
+    }
+
+    if {"overlapping" in $ops} {
+	set iters 50
+	set i 0
+	emit overlapping $n $iters [lindex [time {
+	    set x [expr {([incr i] * 131) % 3600}]
+	    .c find overlapping $x $x [expr {$x + 200}] [expr {$x + 200}]
+	} $iters] 0]
+    }
+
+    if {"redraw" in $ops} {
+	# Damage the whole scene, then time the resulting full display pass.
+	set iters 5
+	emit redraw $n $iters [lindex [time {
+	    .c move all 1 0
+	    update idletasks
+	} $iters] 0]
+    }
+}
+
+exit 0
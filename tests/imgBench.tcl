@@ -0,0 +1,213 @@
+# imgBench.tcl --
+#
+# Photo image benchmark.  This is a performance harness, not part of the
+# correctness suite: it times pixel block transfers, zoom and subsample
+# copies, encoding and decoding for the png, gif, ppm and raw string
+# formats, SVG rasterization and display into the current visual, and
+# prints one machine-readable line per measurement so downstream builds
+# can compare runs and catch regressions.  Execute it directly with tktest
+# or wish, or via "make bench-img" in the unix build directory.
+#
+# Each result line has the tab-separated form
+#
+#	BENCH	<operation>	<size>	<iters>	<total-us>	<us-per-iter>	<MB/s>
+#
+# where <size> is the image edge length in pixels and the MB/s figure is
+# computed over the unpacked RGBA payload of the image.
+#
+# Options (after the script name):
+#	-sizes list	Image edge lengths to run (default: 256 1024).
+#	-ops list	Operations to time (default: all of put copy zoom
+#			subsample png gif ppm raw svg display).
+#	-json file	Also write the results to the named file as a JSON
+#			document, for baseline storage and regression
+#			tracking.
+#	-geometry spec	Accepted and applied to the toplevel, for symmetry
+#			with the test targets.
+
+package require tk
+
+set sizes {256 1024}
+set allOps {put copy zoom subsample png gif ppm raw svg display}
+set ops $allOps
+set jsonFile {}
+
+foreach {flag value} $argv {
+    switch -- $flag {
+	-sizes	{ set sizes $value }
+	-ops	{ set ops $value }
+	-json	{ set jsonFile $value }
+	-geometry { wm geometry . $value }
+	default {
+	    puts stderr "unknown option \"$flag\": must be -sizes, -ops, -json or -geometry"
+	    exit 1
+	}
+    }
+}
+foreach op $ops {
+    if {$op ni $allOps} {
+	puts stderr "unknown operation \"$op\": must be one of $allOps"
+	exit 1
+    }
+}
+
+wm title . "photo image benchmark"
+update
+
+set results {}
+
+proc emit {op size iters us bytes} {
+    global results
+    set mbs [expr {$us > 0 ? $bytes * $iters / double($us) : 0.0}]
+    puts [format "BENCH\t%s\t%d\t%d\t%d\t%.3f\t%.2f" \
+	    $op $size $iters $us [expr {double($us) / $iters}] $mbs]
+    flush stdout
+    lappend results [list $op $size $iters $us $mbs]
+}
+
+# Build an n x n source photo holding a deterministic gradient-plus-noise
+# pattern.  The pattern compresses neither trivially nor badly, so the
+# codec timings reflect ordinary picture content.
+
+proc fillSource {img n} {
+    set rows {}
+    for {set y 0} {$y < $n} {incr y} {
+	set row {}
+	for {set x 0} {$x < $n} {incr x} {
+	    set r [expr {($x * 255 / $n + ($x * $y * 13) % 32) % 256}]
+	    set g [expr {($y * 255 / $n + ($x ^ $y) % 32) % 256}]
+	    set b [expr {(($x + $y) * 255 / (2 * $n)) % 256}]
+	    lappend row [format "#%02x%02x%02x" $r $g $b]
+	}
+	lappend rows $row
+    }
+    $img put $rows
+}
+
+foreach n $sizes {
+    set src [image create photo -width $n -height $n]
+    fillSource $src $n
+    set bytes [expr {$n * $n * 4}]
+
+    if {"put" in $ops} {
+	# Color list parsing plus block transfer, one full image per iter.
+	set rows {}
+	for {set y 0} {$y < $n} {incr y} {
+	    set row {}
+	    for {set x 0} {$x < $n} {incr x} {
+		lappend row [format "#%02x%02x%02x" \
+			[expr {$x % 256}] [expr {$y % 256}] 128]
+	    }
+	    lappend rows $row
+	}
+	set dst [image create photo]
+	set iters 5
+	emit put $n $iters [lindex [time {
+	    $dst put $rows
+	} $iters] 0] $bytes
+	image delete $dst
+    }
+
+    if {"copy" in $ops} {
+	# Straight Tk_PhotoPutBlock throughput, photo to photo.
+	set dst [image create photo -width $n -height $n]
+	set iters 20
+	emit copy $n $iters [lindex [time {
+	    $dst copy $src -compositingrule set
+	} $iters] 0] $bytes
+	image delete $dst
+    }
+
+    if {"zoom" in $ops} {
+	set dst [image create photo]
+	set iters 10
+	emit zoom $n $iters [lindex [time {
+	    $dst copy $src -zoom 2 2 -compositingrule set
+	} $iters] 0] [expr {$bytes * 4}]
+	image delete $dst
+    }
+
+    if {"subsample" in $ops} {
+	set dst [image create photo]
+	set iters 20
+	emit subsample $n $iters [lindex [time {
+	    $dst copy $src -subsample 2 2 -compositingrule set
+	} $iters] 0] $bytes
+	image delete $dst
+    }
+
+    foreach fmt {png gif ppm raw} {
+	if {$fmt ni $ops} {
+	    continue
+	}
+	set iters [expr {$fmt eq "raw" ? 20 : 5}]
+	emit $fmt-encode $n $iters [lindex [time {
+	    set data [$src data -format $fmt]
+	} $iters] 0] $bytes
+	emit $fmt-decode $n $iters [lindex [time {
+	    set dst [image create photo -data $data -format $fmt]
+	    image delete $dst
+	} $iters] 0] $bytes
+	unset data
+    }
+
+    if {"svg" in $ops} {
+	# Rasterize a generated scene of circles and rectangles at n x n.
+	set shapes {}
+	for {set i 0} {$i < 200} {incr i} {
+	    set x [expr {($i * 37) % 90}]
+	    set y [expr {($i * 91) % 90}]
+	    set col [format "#%02x%02x%02x" \
+		    [expr {($i * 41) % 256}] [expr {($i * 59) % 256}] 96]
+	    if {$i % 2} {
+		append shapes "<circle cx='$x' cy='$y' r='6' fill='$col'/>"
+	    } else {
+		append shapes "<rect x='$x' y='$y' width='9' height='9'\
+			fill='$col'/>"
+	    }
+	}
+	set svg "<svg xmlns='http://www.w3.org/2000/svg' width='100'\
+		height='100' viewBox='0 0 100 100'>$shapes</svg>"
+	set iters 5
+	emit svg $n $iters [lindex [time {
+	    set dst [image create photo -data $svg \
+		    -format [list svg -scaletowidth $n]]
+	    image delete $dst
+	} $iters] 0] $bytes
+    }
+
+    if {"display" in $ops} {
+	# Instance redraw into the current visual; on anything but a
+	# 24-bit TrueColor display this is dominated by DitherInstance.
+	label .l -image $src
+	pack .l
+	update idletasks
+	set iters 10
+	emit display $n $iters [lindex [time {
+	    .l configure -image ""
+	    .l configure -image $src
+	    update idletasks
+	} $iters] 0] $bytes
+	destroy .l
+    }
+
+    image delete $src
+}
+
+# Emit the JSON baseline document, if requested.
+
+if {$jsonFile ne ""} {
+    set entries {}
+    foreach r $results {
+	lassign $r op size iters us mbs
+	lappend entries [format \
+		{{"op": "%s", "size": %d, "iters": %d, "total_us": %d, "mb_per_s": %.2f}} \
+		$op $size $iters $us $mbs]
+    }
+    set f [open $jsonFile w]
+    puts $f [format {{"harness": "imgBench", "tk_version": "%s", "depth": %d, "results": [%s]}} \
+	    [info patchlevel] [winfo depth .] [join $entries ",\n  "]]
+    close $f
+}
+
+exit 0
@@ -0,0 +1,136 @@
+# bench.tcl --
+#
+# Simple benchmark suite for the ttk widgets: treeview population,
+# scrolling and sorting, notebook tab switching, and style resolution
+# throughput.  Not run as part of the test suite; invoke directly:
+#
+#	wish bench.tcl ?pattern?
+#
+# Each benchmark prints its wall-clock time; the [ttk::style profile]
+# and [ttk::style cachestats] counters are reported at the end so the
+# layout cache and style snapshot hit rates can be checked alongside
+# the timings.
+
+package require tk
+
+wm withdraw .
+
+set benchResults {}
+
+# bench name iterations script --
+#	Time $script (as one batch) and record/print the result.
+#
+proc bench {name iterations script} {
+    global argv benchResults
+    set pattern [expr {[llength $argv] ? [lindex $argv 0] : "*"}]
+    if {![string match $pattern $name]} {
+	return
+    }
+    update idletasks
+    set usec [lindex [time {uplevel 1 $script}] 0]
+    lappend benchResults $name $usec
+    puts [format "%-28s %10.1f ms  (%d iterations)" \
+	    $name [expr {$usec / 1000.0}] $iterations]
+}
+
+# Map the main window briefly so that drawing actually happens.
+#
+toplevel .b
+wm geometry .b 600x400+50+50
+update
+
+## Treeview --
+#
+ttk::treeview .b.tv -columns {a b c} -height 20
+pack .b.tv -expand true -fill both
+update
+
+bench treeview-populate 10000 {
+    for {set i 0} {$i < 10000} {incr i} {
+	.b.tv insert {} end -text "item$i" \
+		-values [list "alpha$i" "beta$i" [expr {$i * 7 % 1000}]]
+    }
+    update idletasks
+}
+
+bench treeview-scroll 200 {
+    for {set i 0} {$i < 200} {incr i} {
+	.b.tv yview scroll 5 units
+	update idletasks
+    }
+}
+
+bench treeview-sort 3 {
+    .b.tv sort -column a
+    update idletasks
+    .b.tv sort -column c -dictionary
+    update idletasks
+    .b.tv sort -column a -descending
+    update idletasks
+}
+
+bench treeview-find 1000 {
+    for {set i 0} {$i < 1000} {incr i} {
+	.b.tv find -prefix "item1"
+    }
+}
+
+destroy .b.tv
+
+## Notebook --
+#
+ttk::notebook .b.nb
+pack .b.nb -expand true -fill both
+for {set i 0} {$i < 20} {incr i} {
+    .b.nb add [ttk::frame .b.nb.f$i] -text "Tab $i"
+}
+update
+
+bench notebook-switch 400 {
+    for {set i 0} {$i < 400} {incr i} {
+	.b.nb select [expr {$i % 20}]
+	update idletasks
+    }
+}
+
+destroy .b.nb
+
+## Style resolution --
+#
+ttk::style configure Bench.TButton -foreground black -padding 2
+ttk::style map Bench.TButton \
+	-foreground {disabled #a3a3a3 active #000000} \
+	-background {active #ececec}
+
+bench style-lookup 20000 {
+    for {set i 0} {$i < 20000} {incr i} {
+	ttk::style lookup Bench.TButton -foreground {active} black
+    }
+}
+
+ttk::button .b.btn -style Bench.TButton -text "Bench"
+pack .b.btn
+update
+
+bench style-redraw 1000 {
+    for {set i 0} {$i < 1000} {incr i} {
+	.b.btn state active
+	update idletasks
+	.b.btn state !active
+	update idletasks
+    }
+}
+
+## Counters --
+#
+puts ""
+puts "ttk::style profile:"
+foreach {name value} [ttk::style profile] {
+    puts [format "    %-16s %s" $name $value]
+}
+puts "ttk::style cachestats:"
+foreach {name value} [ttk::style cachestats] {
+    puts [format "    %-16s %s" $name $value]
+}
+
+exit
@@ -221,6 +221,11 @@ Tk_3DHorizontalBevel(
     GC topGC = NULL, bottomGC = NULL;
 				/* Initializations needed only to prevent
 				 * compiler warnings. */
+#define BEVEL_BATCH 64
+    XRectangle rects[2][BEVEL_BATCH];
+				/* Scan-line rectangles accumulated for the
+				 * top and bottom GCs respectively. */
+    int nRects[2] = {0, 0};
 
     if ((borderPtr->lightGC == NULL) && (relief != TK_RELIEF_FLAT) &&
 	    (relief != TK_RELIEF_SOLID)) {
@@ -283,7 +288,11 @@ Tk_3DHorizontalBevel(
     bottom = y + height;
 
     /*
-     * Draw one line for each y-coordinate covered by the bevel.
+     * Compute one rectangle for each y-coordinate covered by the bevel,
+     * then hand each GC's rectangles to the server in a single
+     * XFillRectangles request rather than one request per scan line. Since
+     * the top and bottom GCs are the same for most reliefs, a bevel is
+     * normally one protocol request regardless of the border width.
      */
 
     for ( ; y < bottom; y++) {
@@ -305,14 +314,30 @@ Tk_3DHorizontalBevel(
 	 */
 
 	if (x1 < x2) {
-	    XFillRectangle(display, drawable,
-		    (y < halfway) ? topGC : bottomGC, x1, y,
-		    (unsigned) (x2-x1), (unsigned) 1);
+	    int i = (y < halfway || bottomGC == topGC) ? 0 : 1;
+	    XRectangle *rectPtr = &rects[i][nRects[i]++];
+
+	    rectPtr->x = (short) x1;
+	    rectPtr->y = (short) y;
+	    rectPtr->width = (unsigned short) (x2 - x1);
+	    rectPtr->height = 1;
+	    if (nRects[i] == BEVEL_BATCH) {
+		XFillRectangles(display, drawable, i ? bottomGC : topGC,
+			rects[i], nRects[i]);
+		nRects[i] = 0;
+	    }
 	}
 	x1 += x1Delta;
 	x2 += x2Delta;
     }
+    if (nRects[0] > 0) {
+	XFillRectangles(display, drawable, topGC, rects[0], nRects[0]);
+    }
+    if (nRects[1] > 0) {
+	XFillRectangles(display, drawable, bottomGC, rects[1], nRects[1]);
+    }
 }
+#undef BEVEL_BATCH
 
 /*
  *----------------------------------------------------------------------
@@ -342,8 +367,7 @@ TkpGetShadows(
 				 * drawing. */
 {
     XColor lightColor, darkColor;
-    int stressed, tmp1, tmp2;
-    int r, g, b;
+    int stressed;
     XGCValues gcValues;
 
     if (borderPtr->lightGC != NULL) {
@@ -363,81 +387,20 @@ TkpGetShadows(
 
     if (!stressed && (Tk_Depth(tkwin) >= 6)) {
 	/*
-	 * This is a color display with lots of colors. For the dark shadow,
-	 * cut 40% from each of the background color components. But if the
-	 * background is already very dark, make the dark color a little
-	 * lighter than the background by increasing each color component
-	 * 1/4th of the way to MAX_INTENSITY.
-	 *
-	 * For the light shadow, boost each component by 40% or half-way to
-	 * white, whichever is greater (the first approach works better for
-	 * unsaturated colors, the second for saturated ones). But if the
-	 * background is already very bright, instead choose a slightly darker
-	 * color for the light shadow by reducing each color component by 10%.
-	 *
-	 * Compute the colors using integers, not using lightColor.red etc.:
-	 * these are shorts and may have problems with integer overflow.
+	 * This is a color display with lots of colors.  Compute the shared
+	 * shadow ramp for the background color, then allocate the two shadow
+	 * colors and their GCs.  Tk_GetColorByValue interns colors by value,
+	 * so every border built from the same base color shares the same
+	 * ramp (and, on TrueColor displays, the allocation involves no
+	 * server round trip at all).
 	 */
 
-	/*
-	 * Compute the dark shadow color.
-	 */
-
-	r = (int) borderPtr->bgColorPtr->red;
-	g = (int) borderPtr->bgColorPtr->green;
-	b = (int) borderPtr->bgColorPtr->blue;
-
-	if (r*0.5*r + g*1.0*g + b*0.28*b < MAX_INTENSITY*0.05*MAX_INTENSITY) {
-	    darkColor.red = (MAX_INTENSITY + 3*r)/4;
-	    darkColor.green = (MAX_INTENSITY + 3*g)/4;
-	    darkColor.blue = (MAX_INTENSITY + 3*b)/4;
-	} else {
-	    darkColor.red = (60 * r)/100;
-	    darkColor.green = (60 * g)/100;
-	    darkColor.blue = (60 * b)/100;
-	}
-
-	/*
-	 * Allocate the dark shadow color and its GC.
-	 */
+	TkComputeShadowColors(borderPtr->bgColorPtr, &lightColor, &darkColor);
 
 	borderPtr->darkColorPtr = Tk_GetColorByValue(tkwin, &darkColor);
 	gcValues.foreground = borderPtr->darkColorPtr->pixel;
 	borderPtr->darkGC = Tk_GetGC(tkwin, GCForeground, &gcValues);
 
-	/*
-	 * Compute the light shadow color.
-	 */
-
-	if (g > MAX_INTENSITY*0.95) {
-	    lightColor.red = (90 * r)/100;
-	    lightColor.green = (90 * g)/100;
-	    lightColor.blue = (90 * b)/100;
-	} else {
-	    tmp1 = (14 * r)/10;
-	    if (tmp1 > MAX_INTENSITY) {
-		tmp1 = MAX_INTENSITY;
-	    }
-	    tmp2 = (MAX_INTENSITY + r)/2;
-	    lightColor.red = (tmp1 > tmp2) ? tmp1 : tmp2;
-	    tmp1 = (14 * g)/10;
-	    if (tmp1 > MAX_INTENSITY) {
-		tmp1 = MAX_INTENSITY;
-	    }
-	    tmp2 = (MAX_INTENSITY + g)/2;
-	    lightColor.green = (tmp1 > tmp2) ? tmp1 : tmp2;
-	    tmp1 = (14 * b)/10;
-	    if (tmp1 > MAX_INTENSITY) {
-		tmp1 = MAX_INTENSITY;
-	    }
-	    tmp2 = (MAX_INTENSITY + b)/2;
-	    lightColor.blue = (tmp1 > tmp2) ? tmp1 : tmp2;
-	}
-
-	/*
-	 * Allocate the light shadow color and its GC.
-	 */
-
 	borderPtr->lightColorPtr = Tk_GetColorByValue(tkwin, &lightColor);
 	gcValues.foreground = borderPtr->lightColorPtr->pixel;
 	borderPtr->lightGC = Tk_GetGC(tkwin, GCForeground, &gcValues);
@@ -45,6 +45,7 @@ struct TkStressedCmap {
 
 static void		DeleteStressedCmap(Display *display,
 			    Colormap colormap);
+static int		AllocTrueColor(Tk_Window tkwin, XColor *colorPtr);
 static void		FindClosestColor(Tk_Window tkwin,
 			    XColor *desiredColorPtr, XColor *actualColorPtr);
 
@@ -86,6 +87,7 @@ TkpFreeColor(
 
     visual = tkColPtr->visual;
     if ((visual->c_class != StaticGray) && (visual->c_class != StaticColor)
+	    && (visual->c_class != TrueColor)
 	    && (tkColPtr->color.pixel != BlackPixelOfScreen(screen))
 	    && (tkColPtr->color.pixel != WhitePixelOfScreen(screen))) {
 	Tk_ErrorHandler handler;
@@ -127,45 +129,27 @@ TkpGetColor(
     XColor color;
     TkColor *tkColPtr;
 
-    /*
-     * Map from the name to a pixel value. Call XAllocNamedColor rather than
-     * XParseColor for non-# names: this saves a server round-trip for those
-     * names.
-     */
-
     if (*name != '#') {
 	XColor screen;
 
-	if (((*name - 'A') & 0xDF) < sizeof(tkWebColors)/sizeof(tkWebColors[0])) {
-	    if (!((name[0] - 'G') & 0xDF) && !((name[1] - 'R') & 0xDF)
-		    && !((name[2] - 'A') & 0xDB) && !((name[3] - 'Y') & 0xDF)
-		    && !name[4]) {
-		name = "#808080808080";
-		goto gotWebColor;
-	    } else {
-		const char *p = tkWebColors[((*name - 'A') & 0x1F)];
-		if (p) {
-		    const char *q = name;
-		    while (!((*p - *(++q)) & 0xDF)) {
-			if (!*p++) {
-			    name = p;
-			    goto gotWebColor;
-			}
-		    }
-		}
-	}
-	}
+	/*
+	 * Color names are resolved by the server on X11 builds (TkParseColor
+	 * falls through to XParseColor for anything but a # spec), so use
+	 * XAllocNamedColor, which folds the lookup and the allocation into a
+	 * single round trip.
+	 */
+
 	if (strlen(name) > 99) {
-	/* Don't bother to parse this. [Bug 2809525]*/
-	return NULL;
-    } else if (XAllocNamedColor(display, colormap, name, &screen, &color) != 0) {
+	    return NULL;
+	}
+	if (XAllocNamedColor(display, colormap, name, &screen, &color) != 0) {
 	    DeleteStressedCmap(display, colormap);
 	} else {
 	    /*
 	     * Couldn't allocate the color. Try translating the name to a
 	     * color value, to see whether the problem is a bad color name or
-	     * a full colormap. If the colormap is full, then pick an
-	     * approximation to the desired color.
+	     * a full colormap. If the colormap is full, pick the closest
+	     * available color.
 	     */
 
 	    if (XLookupColor(display, colormap, name, &color, &screen) == 0) {
@@ -174,14 +158,21 @@ TkpGetColor(
 	    FindClosestColor(tkwin, &screen, &color);
 	}
     } else {
-    gotWebColor:
+	/*
+	 * Hex specs are parsed entirely client-side, and on TrueColor
+	 * visuals the pixel value can be computed client-side as well, so
+	 * this branch involves no server traffic at all on such displays.
+	 */
+
 	if (TkParseColor(display, colormap, name, &color) == 0) {
 	    return NULL;
 	}
-	if (XAllocColor(display, colormap, &color) != 0) {
-	    DeleteStressedCmap(display, colormap);
-	} else {
-	    FindClosestColor(tkwin, &color, &color);
+	if (!AllocTrueColor(tkwin, &color)) {
+	    if (XAllocColor(display, colormap, &color) != 0) {
+		DeleteStressedCmap(display, colormap);
+	    } else {
+		FindClosestColor(tkwin, &color, &color);
+	    }
 	}
     }
 
@@ -225,6 +216,9 @@ TkpGetColorByValue(
     tkColPtr->color.red = colorPtr->red;
     tkColPtr->color.green = colorPtr->green;
     tkColPtr->color.blue = colorPtr->blue;
+    if (AllocTrueColor(tkwin, &tkColPtr->color)) {
+	return tkColPtr;
+    }
     if (XAllocColor(display, colormap, &tkColPtr->color) != 0) {
 	DeleteStressedCmap(display, colormap);
     } else {
@@ -234,6 +228,72 @@ TkpGetColorByValue(
     return tkColPtr;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * AllocTrueColor --
+ *
+ *	Computes the pixel value for a color on a TrueColor visual directly
+ *	from the visual's channel masks, the same way the server would.
+ *	TrueColor colormaps are read-only with a fixed mapping, so the
+ *	XAllocColor round trip adds nothing but latency; skipping it makes
+ *	color allocation free on the displays that are by far the most
+ *	common today.
+ *
+ * Results:
+ *	Returns 1 if the visual is TrueColor, in which case the pixel field
+ *	of *colorPtr is filled in and its color fields are rounded to the
+ *	values the hardware will actually display.  Returns 0 otherwise; the
+ *	caller must then allocate the color from the server.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static unsigned long
+TrueColorChannel(
+    unsigned long mask,		/* Pixel bits devoted to this channel. */
+    unsigned short *valuePtr)	/* Points to the desired 16-bit intensity;
+				 * overwritten with the displayed one. */
+{
+    int shift = 0, bits = 0;
+    unsigned long value;
+
+    while (!(mask & 1)) {
+	mask >>= 1;
+	shift++;
+    }
+    while (mask & 1) {
+	mask >>= 1;
+	bits++;
+    }
+    value = *valuePtr >> (16 - bits);
+    *valuePtr = (unsigned short) ((value * 65535UL) / ((1UL << bits) - 1));
+    return value << shift;
+}
+
+static int
+AllocTrueColor(
+    Tk_Window tkwin,		/* Window in which color will be used. */
+    XColor *colorPtr)		/* Red, green, and blue fields indicate the
+				 * desired color. */
+{
+    Visual *visual = Tk_Visual(tkwin);
+
+    if ((visual == NULL) || (visual->c_class != TrueColor)
+	    || (visual->red_mask == 0) || (visual->green_mask == 0)
+	    || (visual->blue_mask == 0)) {
+	return 0;
+    }
+    colorPtr->pixel = TrueColorChannel(visual->red_mask, &colorPtr->red)
+	    | TrueColorChannel(visual->green_mask, &colorPtr->green)
+	    | TrueColorChannel(visual->blue_mask, &colorPtr->blue);
+    colorPtr->flags = DoRed|DoGreen|DoBlue;
+    return 1;
+}
+
 /*
  *----------------------------------------------------------------------
  *
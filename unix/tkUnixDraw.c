@@ -14,6 +14,9 @@
 #ifndef _WIN32
 #include "tkUnixInt.h"
 #endif
+#ifdef HAVE_XRENDER
+#include <X11/extensions/Xrender.h>
+#endif
 
 /*
  * The following structure is used to pass information to ScrollRestrictProc
@@ -237,6 +240,88 @@ TkpDrawFrameEx(
 	    Tk_Height(tkwin) - 2*highlightWidth, borderWidth, relief);
 }
 
+#ifdef HAVE_XRENDER
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkpDrawAntialiasedPolygon --
+ *
+ *	Fill a polygon with antialiased edges, rasterized by the X server
+ *	through the RENDER extension. The coordinates are doubles relative
+ *	to the drawable's origin, so subpixel positions contribute to the
+ *	edge coverage. The interior is determined by the even-odd rule,
+ *	matching what XFillPolygon does with the default fill rule.
+ *
+ * Results:
+ *	Returns 1 if the polygon was filled, or 0 if the display does not
+ *	support a usable version of RENDER (negotiated when the display was
+ *	opened; see TkpOpenDisplay) or the drawable's visual has no RENDER
+ *	format. On a 0 return the caller must fill the polygon itself.
+ *
+ * Side effects:
+ *	Issues RENDER requests. The temporary Pictures are freed before
+ *	returning.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkpDrawAntialiasedPolygon(
+    Display *display,		/* Display containing d. */
+    Visual *visual,		/* Visual of the window d was created for. */
+    Drawable d,			/* Pixmap or window to draw into. */
+    XColor *colorPtr,		/* Fill color. */
+    const double *coordPtr,	/* Vertices as x/y pairs, in drawable
+				 * coordinates. */
+    int numPoints)		/* Number of vertices; twice this many
+				 * doubles are present at coordPtr. */
+{
+    TkDisplay *dispPtr = TkGetDisplay(display);
+    XRenderPictFormat *formatPtr;
+    XRenderColor color;
+    XPointDouble staticPoints[64];
+    XPointDouble *points;
+    Picture src, dst;
+    int i;
+
+    if ((dispPtr == NULL) || !(dispPtr->flags & TK_DISPLAY_XRENDER)) {
+	return 0;
+    }
+    formatPtr = XRenderFindVisualFormat(display, visual);
+    if (formatPtr == NULL) {
+	return 0;
+    }
+
+    if (numPoints <= (int) (sizeof(staticPoints)/sizeof(XPointDouble))) {
+	points = staticPoints;
+    } else {
+	points = (XPointDouble *) ckalloc(numPoints * sizeof(XPointDouble));
+    }
+    for (i = 0; i < numPoints; i++) {
+	points[i].x = coordPtr[2*i];
+	points[i].y = coordPtr[2*i + 1];
+    }
+
+    color.red = colorPtr->red;
+    color.green = colorPtr->green;
+    color.blue = colorPtr->blue;
+    color.alpha = 0xffff;
+    src = XRenderCreateSolidFill(display, &color);
+    dst = XRenderCreatePicture(display, d, formatPtr, 0, NULL);
+    XRenderCompositeDoublePoly(display, PictOpOver, src, dst,
+	    XRenderFindStandardFormat(display, PictStandardA8),
+	    0, 0, 0, 0, points, numPoints, EvenOddRule);
+    XRenderFreePicture(display, dst);
+    XRenderFreePicture(display, src);
+    if (points != staticPoints) {
+	ckfree(points);
+    }
+    return 1;
+}
+
+#endif /* HAVE_XRENDER */
+
 /*
  * Local Variables:
  * mode: c
@@ -38,6 +38,11 @@ typedef struct Container {
 				 * in this process. Note that this is *not*
 				 * the same window as wrapper: wrapper is the
 				 * parent of embeddedPtr. */
+    int resizePending;		/* Non-zero means EmbedResizeProc is
+				 * scheduled to push the container's current
+				 * size to the wrapper. Intermediate sizes
+				 * seen while it is pending are never sent;
+				 * only the final state is. */
     struct Container *nextPtr;	/* Next in list of all containers in this
 				 * process. */
 } Container;
@@ -63,6 +68,7 @@ static void		EmbedFocusProc(ClientData clientData,
 			    XEvent *eventPtr);
 static void		EmbedGeometryRequest(Container *containerPtr,
 			    int width, int height);
+static void		EmbedResizeProc(void *clientData);
 static void		EmbedSendConfigure(Container *containerPtr);
 static void		EmbedStructureProc(ClientData clientData,
 			    XEvent *eventPtr);
@@ -183,6 +189,7 @@ Tk_UseWindow(
 	containerPtr->parentRoot = parentAtts.root;
 	containerPtr->parentPtr = NULL;
 	containerPtr->wrapper = None;
+	containerPtr->resizePending = 0;
 	containerPtr->nextPtr = tsdPtr->firstContainerPtr;
 	tsdPtr->firstContainerPtr = containerPtr;
     }
@@ -288,6 +295,7 @@ Tk_MakeContainer(
     containerPtr->parentPtr = winPtr;
     containerPtr->wrapper = None;
     containerPtr->embeddedPtr = NULL;
+    containerPtr->resizePending = 0;
     containerPtr->nextPtr = tsdPtr->firstContainerPtr;
     tsdPtr->firstContainerPtr = containerPtr;
     winPtr->flags |= TK_CONTAINER;
@@ -512,26 +520,71 @@ EmbedStructureProc(
         if (containerPtr->embeddedPtr != NULL) {
             TkDoConfigureNotify(containerPtr->embeddedPtr);
         }
-	if (containerPtr->wrapper != None) {
-
+	if ((containerPtr->wrapper != None) && !containerPtr->resizePending) {
 	    /*
-	     * Ignore errors, since the embedded application could have
-	     * deleted its window.
+	     * Don't push every intermediate size across the embedding
+	     * boundary: an interactive resize delivers a ConfigureNotify
+	     * storm, and forwarding each one makes the embedded application
+	     * relayout for sizes that are already stale. Schedule one
+	     * deferred resize instead; it reads the container's size when it
+	     * runs, so only the final state of a burst is sent.
 	     */
 
-	    errHandler = Tk_CreateErrorHandler(eventPtr->xfocus.display, -1,
-		    -1, -1, NULL, NULL);
-	    XMoveResizeWindow(eventPtr->xconfigure.display,
-		    containerPtr->wrapper, 0, 0,
-		    (unsigned) Tk_Width((Tk_Window) containerPtr->parentPtr),
-		    (unsigned) Tk_Height((Tk_Window) containerPtr->parentPtr));
-	    Tk_DeleteErrorHandler(errHandler);
+	    containerPtr->resizePending = 1;
+	    TkDoWhenIdle(EmbedResizeProc, containerPtr, TK_IDLE_DISPLAY);
 	}
     } else if (eventPtr->type == DestroyNotify) {
 	EmbedWindowDeleted(containerPtr->parentPtr);
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * EmbedResizeProc --
+ *
+ *	This function is invoked as an idle callback (batched per frame when
+ *	the frame clock is on) to reflect the container's size in the
+ *	embedded application's wrapper window. It is scheduled by
+ *	EmbedStructureProc, which coalesces a burst of ConfigureNotify
+ *	events into a single resize of the wrapper at the final size.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The wrapper window gets resized to match the container.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+EmbedResizeProc(
+    void *clientData)		/* Token for container window. */
+{
+    Container *containerPtr = (Container *)clientData;
+    Tk_ErrorHandler errHandler;
+
+    containerPtr->resizePending = 0;
+    if ((containerPtr->parentPtr == NULL)
+	    || (containerPtr->wrapper == None)) {
+	return;
+    }
+
+    /*
+     * Ignore errors, since the embedded application could have deleted its
+     * window.
+     */
+
+    errHandler = Tk_CreateErrorHandler(
+	    Tk_Display(containerPtr->parentPtr), -1, -1, -1, NULL, NULL);
+    XMoveResizeWindow(Tk_Display(containerPtr->parentPtr),
+	    containerPtr->wrapper, 0, 0,
+	    (unsigned) Tk_Width((Tk_Window) containerPtr->parentPtr),
+	    (unsigned) Tk_Height((Tk_Window) containerPtr->parentPtr));
+    Tk_DeleteErrorHandler(errHandler);
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -683,6 +736,10 @@ EmbedSendConfigure(
      */
 
     if (containerPtr->embeddedPtr == NULL) {
+	if (containerPtr->resizePending) {
+	    TkCancelDoWhenIdle(EmbedResizeProc, containerPtr);
+	    containerPtr->resizePending = 0;
+	}
 	XMoveResizeWindow(winPtr->display, containerPtr->wrapper, 0, 0,
 		(unsigned) winPtr->changes.width,
 		(unsigned) winPtr->changes.height);
@@ -989,6 +1046,10 @@ EmbedWindowDeleted(
 	    break;
 	}
 	if (containerPtr->parentPtr == winPtr) {
+	    if (containerPtr->resizePending) {
+		TkCancelDoWhenIdle(EmbedResizeProc, containerPtr);
+		containerPtr->resizePending = 0;
+	    }
 	    containerPtr->parentPtr = NULL;
 	    break;
 	}
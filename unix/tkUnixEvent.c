@@ -16,6 +16,12 @@
 #define XkbOpenDisplay XkbOpenDisplay_ /* Move out of the way, conflicting definitions */
 #include <X11/XKBlib.h>
 #undef XkbOpenDisplay
+#ifdef HAVE_XSHM
+#include <X11/extensions/XShm.h>
+#endif
+#ifdef HAVE_XRENDER
+#include <X11/extensions/Xrender.h>
+#endif
 
 /*
  * The following static indicates whether this module has been initialized in
@@ -37,6 +43,7 @@ static void		DisplayFileProc(ClientData clientData, int flags);
 static void		DisplaySetupProc(ClientData clientData, int flags);
 static void		TransferXEventsToTcl(Display *display);
 #ifdef TK_USE_INPUT_METHODS
+static void		InitInputMethods(TkDisplay *dispPtr);
 static void		InstantiateIMCallback(Display *, XPointer client_data, XPointer call_data);
 static void		DestroyIMCallback(XIM im, XPointer client_data, XPointer call_data);
 static void		OpenIM(TkDisplay *dispPtr);
@@ -166,12 +173,46 @@ TkpOpenDisplay(
     dispPtr = (TkDisplay *)ckalloc(sizeof(TkDisplay));
     memset(dispPtr, 0, sizeof(TkDisplay));
     dispPtr->display = display;
-#ifdef TK_USE_INPUT_METHODS
-    XSetLocaleModifiers("");
-    OpenIM(dispPtr);
-    XRegisterIMInstantiateCallback(dispPtr->display, NULL, NULL, NULL,
-	    InstantiateIMCallback, (XPointer) dispPtr);
+#ifdef HAVE_XSHM
+    {
+	int shmMajor, shmMinor;
+	Bool shmPixmaps;
+
+	/*
+	 * Negotiate use of the MIT-SHM extension now, so that image code
+	 * only has to test the flag (c.f. TkpShmCreateImage, tkUnixShm.c).
+	 */
+
+	if (XShmQueryVersion(display, &shmMajor, &shmMinor, &shmPixmaps)) {
+	    dispPtr->flags |= TK_DISPLAY_XSHM;
+	}
+    }
 #endif
+#ifdef HAVE_XRENDER
+    {
+	int renderMajor, renderMinor;
+
+	/*
+	 * Negotiate use of the RENDER extension now, so that drawing code
+	 * only has to test the flag (c.f. TkpRenderGradient,
+	 * tkUnixGradient.c). Gradient Pictures need RENDER 0.10 or later.
+	 */
+
+	if (XRenderQueryVersion(display, &renderMajor, &renderMinor)
+		&& ((renderMajor > 0) || (renderMinor >= 10))) {
+	    dispPtr->flags |= TK_DISPLAY_XRENDER;
+	}
+    }
+#endif
+
+    /*
+     * Input method setup is not done here: opening the XIM connection
+     * costs several round trips (and may load a preedit font set), all
+     * wasted when the application exits before any keyboard input.  It
+     * is deferred until the first focus or key event arrives; see
+     * InitInputMethods.
+     */
+
     Tcl_CreateFileHandler(ConnectionNumber(display), TCL_READABLE,
 	    DisplayFileProc, dispPtr);
 
@@ -330,7 +371,12 @@ DisplaySetupProc(
  *
  * TransferXEventsToTcl --
  *
- *	Transfer events from the X event queue to the Tk event queue.
+ *	Transfer events from the X event queue to the Tk event queue. The
+ *	whole queue is drained per call, including events that arrive on the
+ *	X connection while the drain is in progress, so that a burst of
+ *	events costs a single notifier wakeup. Queue-level compression of
+ *	motion and mouse wheel events happens in Tk_QueueWindowEvent as the
+ *	events are queued.
  *
  * Results:
  *	None.
@@ -351,6 +397,7 @@ TransferXEventsToTcl(
 	TkKeyEvent k;
     } event;
     Window w;
+    int doFilter;
     TkDisplay *dispPtr = NULL;
 
     /*
@@ -364,56 +411,91 @@ TransferXEventsToTcl(
      * for this to not be an issue anyway. [Bug 1924761]
      */
 
-    while (QLength(display) > 0) {
-	XNextEvent(display, &event.x);
-	if ((event.type >= VirtualEvent) && (event.type <= MouseWheelEvent)) {
-	    /* See [fe87e9af39]. Those are internal Tk event types, if they come
-	     * from an external source they most likely would be totally mis-interpreted */
-	    continue;
-	}
-	w = None;
-	if (event.type == KeyPress || event.type == KeyRelease) {
-	    for (dispPtr = TkGetDisplayList(); ; dispPtr = dispPtr->nextPtr) {
-		if (dispPtr == NULL) {
-		    break;
-		} else if (dispPtr->display == event.x.xany.display) {
-		    if (dispPtr->focusPtr != NULL) {
-			w = dispPtr->focusPtr->window;
+    do {
+	while (QLength(display) > 0) {
+	    XNextEvent(display, &event.x);
+	    if ((event.type >= VirtualEvent) && (event.type <= MouseWheelEvent)) {
+		/* See [fe87e9af39]. Those are internal Tk event types, if they come
+		 * from an external source they most likely would be totally mis-interpreted */
+		continue;
+	    }
+	    w = None;
+	    doFilter = 1;
+	    if (event.type == KeyPress || event.type == KeyRelease
+		    || event.type == FocusIn) {
+		for (dispPtr = TkGetDisplayList(); ; dispPtr = dispPtr->nextPtr) {
+		    if (dispPtr == NULL) {
+			break;
+		    } else if (dispPtr->display == event.x.xany.display) {
+#ifdef TK_USE_INPUT_METHODS
+			if (dispPtr->flags & TK_DISPLAY_USE_IM) {
+			    InitInputMethods(dispPtr);
+			}
+#endif
+			if ((event.type != FocusIn)
+				&& (dispPtr->focusPtr != NULL)) {
+			    w = dispPtr->focusPtr->window;
+			}
+
+			/*
+			 * When no input method is open on the display there
+			 * is nothing that could consume the keystroke, so
+			 * don't funnel it through XFilterEvent; for plain
+			 * typing this skips a round through the XIM
+			 * machinery per key event. Compose and dead-key
+			 * sequences arrive with an open input method, so
+			 * those still get filtered.
+			 */
+
+			if ((event.type != FocusIn)
+				&& (dispPtr->inputMethod == NULL)) {
+			    doFilter = 0;
+			}
+			break;
 		    }
-		    break;
 		}
 	    }
-	}
-	if (XFilterEvent(&event.x, w)) {
-	    continue;
-	}
-	if (event.type == KeyPress || event.type == KeyRelease) {
-	    event.k.charValuePtr = NULL;
-	    event.k.charValueLen = 0;
-	    event.k.keysym = NoSymbol;
-
-	    /*
-	     * Force the calling of the input method engine now. The results
-	     * from it will be cached in the event so that they don't get lost
-	     * (to a race condition with other XIM-handled key events) between
-	     * entering the event queue and getting serviced. [Bug 1924761]
-	     */
+	    if (doFilter && XFilterEvent(&event.x, w)) {
+		continue;
+	    }
+	    if (event.type == KeyPress || event.type == KeyRelease) {
+		event.k.charValuePtr = NULL;
+		event.k.charValueLen = 0;
+		event.k.charValueInline = 0;
+		event.k.keysym = NoSymbol;
+
+		/*
+		 * Force the calling of the input method engine now. The results
+		 * from it will be cached in the event so that they don't get lost
+		 * (to a race condition with other XIM-handled key events) between
+		 * entering the event queue and getting serviced. [Bug 1924761]
+		 */
 
 #ifdef TK_USE_INPUT_METHODS
-	    if (event.type == KeyPress && dispPtr &&
-		    (dispPtr->flags & TK_DISPLAY_USE_IM)) {
-		if (dispPtr->focusPtr && dispPtr->focusPtr->inputContext) {
-		    Tcl_DString ds;
-
-		    Tcl_DStringInit(&ds);
-		    (void) TkpGetString(dispPtr->focusPtr, &event.x, &ds);
-		    Tcl_DStringFree(&ds);
+		if (event.type == KeyPress && dispPtr &&
+			(dispPtr->flags & TK_DISPLAY_USE_IM)) {
+		    if (dispPtr->focusPtr && dispPtr->focusPtr->inputContext) {
+			Tcl_DString ds;
+
+			Tcl_DStringInit(&ds);
+			(void) TkpGetString(dispPtr->focusPtr, &event.x, &ds);
+			Tcl_DStringFree(&ds);
+		    }
 		}
-	    }
 #endif
+	    }
+	    Tk_QueueWindowEvent(&event.x, TCL_QUEUE_TAIL);
 	}
-	Tk_QueueWindowEvent(&event.x, TCL_QUEUE_TAIL);
-    }
+
+	/*
+	 * Pick up any events that the operating system buffered while the
+	 * queue was being drained. XEventsQueued with QueuedAfterReading
+	 * reads whatever is already on the connection without blocking; if
+	 * an event storm is still in flight this loops, otherwise the drain
+	 * ends and control returns to the notifier with an empty queue.
+	 */
+
+    } while (XEventsQueued(display, QueuedAfterReading) > 0);
 }
 
 /*
@@ -681,6 +763,42 @@ TkpSync(
 }
 #ifdef TK_USE_INPUT_METHODS
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * InitInputMethods --
+ *
+ *	Performs the input method setup for a display the first time it is
+ *	called; later calls return immediately.  Tk used to do this while
+ *	opening the display, but XOpenIM costs several round trips to the X
+ *	server (plus a preedit font set), so it is deferred until the first
+ *	focus or key event signals that keyboard input is actually coming.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Opens an input method for the display and registers for
+ *	instantiation callbacks, exactly as used to happen in
+ *	TkpOpenDisplay.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+InitInputMethods(
+    TkDisplay *dispPtr)		/* Tk's structure for the display. */
+{
+    if (dispPtr->flags & TK_DISPLAY_IM_INITIALIZED) {
+	return;
+    }
+    dispPtr->flags |= TK_DISPLAY_IM_INITIALIZED;
+    XSetLocaleModifiers("");
+    OpenIM(dispPtr);
+    XRegisterIMInstantiateCallback(dispPtr->display, NULL, NULL, NULL,
+	    InstantiateIMCallback, (XPointer) dispPtr);
+}
+
 static void
 InstantiateIMCallback(
     Display      *display,
@@ -42,7 +42,7 @@ TkpChangeFocus(
 				 * application. */
 {
     TkDisplay *dispPtr = winPtr->dispPtr;
-    Tk_ErrorHandler errHandler;
+    TkErrorGuard errGuard;
     Window window, root, parent, *children;
     unsigned int numChildren, serial;
     TkWindow *winPtr2;
@@ -106,13 +106,13 @@ TkpChangeFocus(
      * have gotten unmapped, which will generate an error.
      */
 
-    errHandler = Tk_CreateErrorHandler(dispPtr->display, -1,-1,-1, NULL,NULL);
+    TkPushErrorGuard(dispPtr->display, &errGuard);
     if (winPtr->window == None) {
 	Tcl_Panic("ChangeXFocus got null X window");
     }
     XSetInputFocus(dispPtr->display, winPtr->window, RevertToParent,
 	    CurrentTime);
-    Tk_DeleteErrorHandler(errHandler);
+    TkPopErrorGuard(&errGuard);
 
     /*
      * Remember the current serial number for the X server and issue a dummy
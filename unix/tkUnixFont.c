@@ -1786,7 +1786,9 @@ FreeFontFamily(
  *	lookup and remember any SubFonts that were dynamically loaded. The
  *	table of SubFonts might be extended, and if a non-NULL reference to a
  *	subfont pointer is available, it is updated if it previously pointed
- *	into the old subfont table.
+ *	into the old subfont table.  A successful probe is also recorded in
+ *	the process-wide fallback cache so that other font instances can
+ *	skip straight to the winning family.
  *
  *-------------------------------------------------------------------------
  */
@@ -1830,6 +1832,21 @@ FindSubFontForChar(
 
     Tcl_DStringInit(&ds);
 
+    /*
+     * If another font instance has already resolved a fallback for this
+     * block of characters, try that family first; this usually turns the
+     * probe storm below into a single probe.
+     */
+
+    fallback = TkFontFallbackLookup(ch);
+    if (fallback != NULL) {
+	subFontPtr = CanUseFallbackWithAliases(fontPtr, fallback, ch, &ds,
+		fixSubFontPtrPtr);
+	if (subFontPtr != NULL) {
+	    goto end;
+	}
+    }
+
     /*
      * Are there any other fonts with the same face name as the base font that
      * could display this character, e.g., if the base font is
@@ -1841,6 +1858,7 @@ FindSubFontForChar(
     if (SeenName(faceName, &ds) == 0) {
 	subFontPtr = CanUseFallback(fontPtr, faceName, ch, fixSubFontPtrPtr);
 	if (subFontPtr != NULL) {
+	    TkFontFallbackRemember(ch, faceName);
 	    goto end;
 	}
     }
@@ -1882,6 +1900,7 @@ FindSubFontForChar(
 	    subFontPtr = CanUseFallbackWithAliases(fontPtr, fallback, ch, &ds,
 		    fixSubFontPtrPtr);
 	    if (subFontPtr != NULL) {
+		TkFontFallbackRemember(ch, fallback);
 		goto end;
 	    }
 	}
@@ -1896,6 +1915,7 @@ FindSubFontForChar(
 	subFontPtr = CanUseFallbackWithAliases(fontPtr, fallback, ch, &ds,
 		fixSubFontPtrPtr);
 	if (subFontPtr != NULL) {
+	    TkFontFallbackRemember(ch, fallback);
 	    goto end;
 	}
     }
@@ -1913,6 +1933,7 @@ FindSubFontForChar(
 	    subFontPtr = CanUseFallback(fontPtr, fallback, ch,
 		    fixSubFontPtrPtr);
 	    if (subFontPtr != NULL) {
+		TkFontFallbackRemember(ch, fallback);
 		XFreeFontNames(nameList);
 		goto end;
 	    }
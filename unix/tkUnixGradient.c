@@ -0,0 +1,104 @@
+/*
+ * tkUnixGradient.c --
+ *
+ *	This file renders linear color blends on the X server using the
+ *	RENDER extension.  A gradient Picture carries only its two stop
+ *	colors over the connection, so a blend of any size is painted with a
+ *	handful of requests and no client-side pixel data at all.
+ *
+ * Copyright © 2026 Tk Core Team.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#include "tkUnixInt.h"
+
+#ifdef HAVE_XRENDER
+
+#include <X11/extensions/Xrender.h>
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkpRenderGradient --
+ *
+ *	Fills a drawable with a linear blend between two colors, running
+ *	top-to-bottom when vertical is set and left-to-right otherwise.  The
+ *	blend is computed by the X server from a gradient Picture holding
+ *	just the two stops, so no pixel data crosses the connection.
+ *
+ * Results:
+ *	Returns 1 if the drawable was filled, or 0 if the display does not
+ *	support a usable version of the RENDER extension (negotiated when
+ *	the display was opened; see TkpOpenDisplay) or the drawable's visual
+ *	has no RENDER format.  On a 0 return the caller must paint the blend
+ *	itself.
+ *
+ * Side effects:
+ *	Issues RENDER requests.  The temporary Pictures are freed before
+ *	returning.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkpRenderGradient(
+    Display *display,		/* Display containing d. */
+    Visual *visual,		/* Visual of the window d was created for. */
+    Drawable d,			/* Pixmap or window to fill. */
+    unsigned int width,		/* Dimensions of the area to fill, anchored */
+    unsigned int height,	/* at the drawable's origin. */
+    XColor *startPtr,		/* Color at the top (or left) edge. */
+    XColor *endPtr,		/* Color at the bottom (or right) edge. */
+    int vertical)		/* 1 means blend top-to-bottom, 0 means
+				 * left-to-right. */
+{
+    TkDisplay *dispPtr = TkGetDisplay(display);
+    XRenderPictFormat *formatPtr;
+    XLinearGradient gradient;
+    XFixed stops[2];
+    XRenderColor colors[2];
+    Picture src, dst;
+
+    if ((dispPtr == NULL) || !(dispPtr->flags & TK_DISPLAY_XRENDER)) {
+	return 0;
+    }
+    formatPtr = XRenderFindVisualFormat(display, visual);
+    if (formatPtr == NULL) {
+	return 0;
+    }
+
+    gradient.p1.x = XDoubleToFixed(0.0);
+    gradient.p1.y = XDoubleToFixed(0.0);
+    gradient.p2.x = XDoubleToFixed(vertical ? 0.0 : (double) width);
+    gradient.p2.y = XDoubleToFixed(vertical ? (double) height : 0.0);
+    stops[0] = XDoubleToFixed(0.0);
+    stops[1] = XDoubleToFixed(1.0);
+    colors[0].red = startPtr->red;
+    colors[0].green = startPtr->green;
+    colors[0].blue = startPtr->blue;
+    colors[0].alpha = 0xffff;
+    colors[1].red = endPtr->red;
+    colors[1].green = endPtr->green;
+    colors[1].blue = endPtr->blue;
+    colors[1].alpha = 0xffff;
+
+    src = XRenderCreateLinearGradient(display, &gradient, stops, colors, 2);
+    dst = XRenderCreatePicture(display, d, formatPtr, 0, NULL);
+    XRenderComposite(display, PictOpSrc, src, None, dst, 0, 0, 0, 0,
+	    0, 0, width, height);
+    XRenderFreePicture(display, dst);
+    XRenderFreePicture(display, src);
+    return 1;
+}
+
+#endif /* HAVE_XRENDER */
+
+/*
+ * Local Variables:
+ * mode: c
+ * c-basic-offset: 4
+ * fill-column: 78
+ * End:
+ */
@@ -108,9 +108,10 @@ TkpGetString(
      * If we have the value cached already, use it now. [Bug 1373712]
      */
 
-    if (kePtr->charValuePtr != NULL) {
+    if ((kePtr->charValuePtr != NULL) || kePtr->charValueInline) {
 	Tcl_DStringSetLength(dsPtr, kePtr->charValueLen);
-	memcpy(Tcl_DStringValue(dsPtr), kePtr->charValuePtr,
+	memcpy(Tcl_DStringValue(dsPtr), (kePtr->charValuePtr != NULL)
+		? kePtr->charValuePtr : kePtr->charValueBuf,
 		kePtr->charValueLen+1);
 	return Tcl_DStringValue(dsPtr);
     }
@@ -217,9 +218,20 @@ TkpGetString(
      */
 
 done:
-    kePtr->charValuePtr = (char *)ckalloc(len + 1);
+    if (len < TK_KEY_VALUE_SPACE) {
+	/*
+	 * Ordinary keystrokes produce at most a few bytes of UTF-8; keep the
+	 * copy inside the event itself so that no heap traffic happens per
+	 * keystroke and the cache survives event structure copies.
+	 */
+
+	kePtr->charValueInline = 1;
+	memcpy(kePtr->charValueBuf, Tcl_DStringValue(dsPtr), len + 1);
+    } else {
+	kePtr->charValuePtr = (char *)ckalloc(len + 1);
+	memcpy(kePtr->charValuePtr, Tcl_DStringValue(dsPtr), len + 1);
+    }
     kePtr->charValueLen = len;
-    memcpy(kePtr->charValuePtr, Tcl_DStringValue(dsPtr), len + 1);
     return Tcl_DStringValue(dsPtr);
 }
 
@@ -329,7 +341,7 @@ TkpGetKeySym(
 
     if (eventPtr->type == KeyPress && dispPtr
 	    && (dispPtr->flags & TK_DISPLAY_USE_IM)) {
-	if (kePtr->charValuePtr == NULL) {
+	if ((kePtr->charValuePtr == NULL) && !kePtr->charValueInline) {
 	    Tcl_DString ds;
 	    TkWindow *winPtr = (TkWindow *)
 		Tk_IdToWindow(eventPtr->xany.display, eventPtr->xany.window);
@@ -338,7 +350,7 @@ TkpGetKeySym(
 	    (void) TkpGetString(winPtr, eventPtr, &ds);
 	    Tcl_DStringFree(&ds);
 	}
-	if (kePtr->charValuePtr != NULL) {
+	if ((kePtr->charValuePtr != NULL) || kePtr->charValueInline) {
 	    return kePtr->keysym;
 	}
     }
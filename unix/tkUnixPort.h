@@ -145,6 +145,61 @@
 #define TkSetPixmapColormap(p,c) {}
 #endif
 
+#ifndef MODULE_SCOPE
+#   ifdef __cplusplus
+#	define MODULE_SCOPE extern "C"
+#   else
+#	define MODULE_SCOPE extern
+#   endif
+#endif
+
+/*
+ * Inform tkImgPhInstance.c that the unix port can provide shared-memory
+ * XImages, via the MIT-SHM extension, for transferring dithered photo
+ * blocks to the server (see tkUnixShm.c).
+ */
+
+#ifdef HAVE_XSHM
+#define TK_SHM_IMAGES
+
+MODULE_SCOPE XImage *	TkpShmCreateImage(Display *display, Visual *visual,
+			    int depth, int format, unsigned int width,
+			    unsigned int height);
+MODULE_SCOPE void	TkpShmDestroyImage(Display *display,
+			    XImage *imagePtr);
+MODULE_SCOPE void	TkpShmPutImage(Display *display, Drawable drawable,
+			    GC gc, XImage *imagePtr, int srcX, int srcY,
+			    int destX, int destY, unsigned int width,
+			    unsigned int height);
+#endif /* HAVE_XSHM */
+
+/*
+ * Inform tkImgGradient.c that the unix port can paint linear gradients on
+ * the server, via the RENDER extension (see tkUnixGradient.c).
+ */
+
+#ifdef HAVE_XRENDER
+#define TK_RENDER_GRADIENTS
+
+MODULE_SCOPE int	TkpRenderGradient(Display *display, Visual *visual,
+			    Drawable d, unsigned int width,
+			    unsigned int height, XColor *startPtr,
+			    XColor *endPtr, int vertical);
+#endif /* HAVE_XRENDER */
+
+/*
+ * Inform the generic canvas code that the unix port can fill antialiased
+ * polygons on the server, via the RENDER extension (see tkUnixDraw.c).
+ */
+
+#ifdef HAVE_XRENDER
+#define TK_RENDER_POLYGONS
+
+MODULE_SCOPE int	TkpDrawAntialiasedPolygon(Display *display,
+			    Visual *visual, Drawable d, XColor *colorPtr,
+			    const double *coordPtr, int numPoints);
+#endif /* HAVE_XRENDER */
+
 /*
  * This macro stores a representation of the window handle in a string.
  * This should perhaps use the real size of an XID.
@@ -28,13 +28,35 @@ typedef struct {
     int next;
 } UnixFtColorList;
 
+/*
+ * Per-font cache of resolved glyph data for the ASCII range.  Xft keeps the
+ * rendered glyph images in a server-side XRender glyph set, but looking up
+ * the glyph index and extents is still a client-side hash walk per character;
+ * for the base face we remember both so the draw loop can batch glyphs
+ * without touching Xft at all.
+ */
+
+#define ASCII_GLYPH_CACHE_SIZE 128
+
+typedef struct {
+    FT_UInt glyph;		/* Glyph index in the base face. */
+    short xOff;			/* Horizontal advance, or -1 if this entry
+				 * has not been resolved yet. */
+    unsigned short width;	/* Ink width of the glyph. */
+    unsigned short height;	/* Ink height of the glyph. */
+} UnixFtCachedGlyph;
+
 typedef struct {
     TkFont font;	    	/* Stuff used by generic font package. Must be
 				 * first in structure. */
     UnixFtFace *faces;
     int nfaces;
-    FcFontSet *fontset;
+    int fallbacksLoaded;	/* Non-zero once LoadFallbackFaces has run. */
+    FcFontSet *fontset;		/* Sorted fallback set, or NULL until a
+				 * character misses the base face. */
     FcPattern *pattern;
+    FcPattern *matchPattern;	/* Owned pattern for the base face; also
+				 * referenced by faces[0].source. */
 
     Display *display;
     int screen;
@@ -42,6 +64,9 @@ typedef struct {
     int ncolors;
     int firstColor;
     UnixFtColorList colors[MAX_CACHED_COLORS];
+    XftFont *glyph0Font;	/* Face described by asciiGlyph below, or
+				 * NULL if no glyph has been cached yet. */
+    UnixFtCachedGlyph asciiGlyph[ASCII_GLYPH_CACHE_SIZE];
 } UnixFtFont;
 
 /*
@@ -91,6 +116,8 @@ TkpFontPkgInit(
 {
 }
 
+static void		LoadFallbackFaces(UnixFtFont *fontPtr);
+
 static XftFont *
 GetFont(
     UnixFtFont *fontPtr,
@@ -107,7 +134,23 @@ GetFont(
 		break;
 	    }
 	}
-	if (i == fontPtr->nfaces) {
+	if (i == fontPtr->nfaces && !fontPtr->fallbacksLoaded) {
+	    /*
+	     * The faces resolved so far cannot display this character.
+	     * Bring in the fallback faces, which are matched lazily because
+	     * sorting the whole installed font set is expensive.
+	     */
+
+	    LoadFallbackFaces(fontPtr);
+	    for (i = 1; i < fontPtr->nfaces; i++) {
+		FcCharSet *charset = fontPtr->faces[i].charset;
+
+		if (charset && FcCharSetHasChar(charset, ucs4)) {
+		    break;
+		}
+	    }
+	}
+	if (i >= fontPtr->nfaces) {
 	    i = 0;
 	}
     } else {
@@ -291,7 +334,7 @@ InitFont(
     FcPattern *pattern,
     UnixFtFont *fontPtr)
 {
-    FcFontSet *set;
+    FcPattern *match;
     FcCharSet *charset;
     FcResult result;
     XftFont *ftFont;
@@ -306,42 +349,45 @@ InitFont(
     XftDefaultSubstitute(Tk_Display(tkwin), Tk_ScreenNumber(tkwin), pattern);
 
     /*
-     * Generate the list of fonts
+     * Resolve only the best matching face up front.  FcFontSort matches and
+     * sorts every installed font to build the fallback list, which dominates
+     * cold-start font setup; the fallback faces are only needed once a
+     * character misses the base face, so GetFont brings them in lazily
+     * through LoadFallbackFaces.  FcFontMatch is served straight from the
+     * fontconfig on-disk cache.
      */
 
-    set = FcFontSort(0, pattern, FcTrue, NULL, &result);
-    if (!set || set->nfont == 0) {
+    match = FcFontMatch(0, pattern, &result);
+    if (!match) {
 	ckfree(fontPtr);
 	return NULL;
     }
 
-    fontPtr->fontset = set;
+    fontPtr->fontset = NULL;
+    fontPtr->fallbacksLoaded = 0;
     fontPtr->pattern = pattern;
-    fontPtr->faces = (UnixFtFace *)ckalloc(set->nfont * sizeof(UnixFtFace));
-    fontPtr->nfaces = set->nfont;
-
-    /*
-     * Fill in information about each returned font
-     */
-
-    for (i = 0; i < set->nfont; i++) {
-	fontPtr->faces[i].ftFont = 0;
-	fontPtr->faces[i].ft0Font = 0;
-	fontPtr->faces[i].source = set->fonts[i];
-	if (FcPatternGetCharSet(set->fonts[i], FC_CHARSET, 0,
-		&charset) == FcResultMatch) {
-	    fontPtr->faces[i].charset = FcCharSetCopy(charset);
-	} else {
-	    fontPtr->faces[i].charset = 0;
-	}
-	fontPtr->faces[i].angle = 0.0;
+    fontPtr->matchPattern = match;
+    fontPtr->faces = (UnixFtFace *)ckalloc(sizeof(UnixFtFace));
+    fontPtr->nfaces = 1;
+    fontPtr->faces[0].ftFont = 0;
+    fontPtr->faces[0].ft0Font = 0;
+    fontPtr->faces[0].source = match;
+    if (FcPatternGetCharSet(match, FC_CHARSET, 0, &charset) == FcResultMatch) {
+	fontPtr->faces[0].charset = FcCharSetCopy(charset);
+    } else {
+	fontPtr->faces[0].charset = 0;
     }
+    fontPtr->faces[0].angle = 0.0;
 
     fontPtr->display = Tk_Display(tkwin);
     fontPtr->screen = Tk_ScreenNumber(tkwin);
     fontPtr->ftDraw = 0;
     fontPtr->ncolors = 0;
     fontPtr->firstColor = -1;
+    fontPtr->glyph0Font = NULL;
+    for (i = 0; i < ASCII_GLYPH_CACHE_SIZE; i++) {
+	fontPtr->asciiGlyph[i].xOff = -1;
+    }
 
     /*
      * Fill in platform-specific fields of TkFont.
@@ -446,6 +492,9 @@ FinishedWithFont(
     if (fontPtr->pattern) {
 	FcPatternDestroy(fontPtr->pattern);
     }
+    if (fontPtr->matchPattern) {
+	FcPatternDestroy(fontPtr->matchPattern);
+    }
     if (fontPtr->ftDraw) {
 	XftDrawDestroy(fontPtr->ftDraw);
     }
@@ -457,6 +506,67 @@ FinishedWithFont(
     }
     Tk_DeleteErrorHandler(handler);
 }
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * LoadFallbackFaces --
+ *
+ *	Match and sort the installed fonts against the font's pattern and
+ *	append the result to the face table.  Called the first time a
+ *	character cannot be displayed by the faces resolved so far; until
+ *	then the font gets by with the single best match, which keeps
+ *	FcFontSort out of font creation entirely.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The face table is extended.  Runs at most once per font instance,
+ *	even if the sort fails.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+static void
+LoadFallbackFaces(
+    UnixFtFont *fontPtr)
+{
+    FcFontSet *set;
+    FcCharSet *charset;
+    FcResult result;
+    int i, n;
+
+    fontPtr->fallbacksLoaded = 1;
+    set = FcFontSort(0, fontPtr->pattern, FcTrue, NULL, &result);
+    if (!set) {
+	return;
+    }
+    if (set->nfont == 0) {
+	FcFontSetDestroy(set);
+	return;
+    }
+
+    n = fontPtr->nfaces;
+    fontPtr->faces = (UnixFtFace *)ckrealloc(fontPtr->faces,
+	    (n + set->nfont) * sizeof(UnixFtFace));
+    for (i = 0; i < set->nfont; i++) {
+	UnixFtFace *facePtr = &fontPtr->faces[n + i];
+
+	facePtr->ftFont = 0;
+	facePtr->ft0Font = 0;
+	facePtr->source = set->fonts[i];
+	if (FcPatternGetCharSet(set->fonts[i], FC_CHARSET, 0,
+		&charset) == FcResultMatch) {
+	    facePtr->charset = FcCharSetCopy(charset);
+	} else {
+	    facePtr->charset = 0;
+	}
+	facePtr->angle = 0.0;
+    }
+    fontPtr->fontset = set;
+    fontPtr->nfaces = n + set->nfont;
+}
 
 TkFont *
 TkpGetNativeFont(
@@ -984,11 +1094,32 @@ Tk_DrawChars(
 
 	ftFont = GetFont(fontPtr, c, 0.0);
 	if (ftFont) {
-	    specs[nspec].glyph = XftCharIndex(fontPtr->display, ftFont, c);
-	    LOCK;
-	    XftGlyphExtents(fontPtr->display, ftFont, &specs[nspec].glyph, 1,
-		    &metrics);
-	    UNLOCK;
+	    UnixFtCachedGlyph *cgPtr = NULL;
+
+	    if (c < ASCII_GLYPH_CACHE_SIZE && (fontPtr->glyph0Font == NULL
+		    || fontPtr->glyph0Font == ftFont)) {
+		cgPtr = &fontPtr->asciiGlyph[c];
+	    }
+	    if (cgPtr != NULL && cgPtr->xOff >= 0) {
+		specs[nspec].glyph = cgPtr->glyph;
+		metrics.xOff = cgPtr->xOff;
+		metrics.yOff = 0;
+		metrics.width = cgPtr->width;
+		metrics.height = cgPtr->height;
+	    } else {
+		specs[nspec].glyph = XftCharIndex(fontPtr->display, ftFont, c);
+		LOCK;
+		XftGlyphExtents(fontPtr->display, ftFont, &specs[nspec].glyph,
+			1, &metrics);
+		UNLOCK;
+		if (cgPtr != NULL && metrics.xOff >= 0 && metrics.yOff == 0) {
+		    fontPtr->glyph0Font = ftFont;
+		    cgPtr->glyph = specs[nspec].glyph;
+		    cgPtr->xOff = metrics.xOff;
+		    cgPtr->width = metrics.width;
+		    cgPtr->height = metrics.height;
+		}
+	    }
 
 	    /*
 	     * Draw glyph only when it fits entirely into 16 bit coords.
@@ -244,13 +244,14 @@ TkSelPropProc(
 {
     IncrInfo *incrPtr;
     TkSelHandler *selPtr;
-    int length;
+    int length, chunkSize, atEnd;
+    long maxRequest;
     Tcl_Size numItems;
     unsigned long i;
     Atom target, formatType;
-    long buffer[TK_SEL_WORDS_AT_ONCE];
+    char *chunk;
     TkDisplay *dispPtr = TkGetDisplay(eventPtr->xany.display);
-    Tk_ErrorHandler errorHandler;
+    TkErrorGuard errorGuard;
     ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
 	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
 
@@ -305,10 +306,31 @@ TkSelPropProc(
 	    }
 
 	    /*
-	     * We found a handler, so get the next chunk from it.
+	     * We found a handler. Size the property chunk from the largest
+	     * request the server will take (each chunk costs a full
+	     * PropertyNotify round trip, so big chunks are what makes large
+	     * INCR transfers move), then fill it with as many handler calls
+	     * as it takes. Each individual call still asks for at most
+	     * TK_SEL_BYTES_AT_ONCE bytes, which is the documented interface
+	     * for Tk_CreateSelHandler procedures.
 	     */
 
+	    maxRequest = XExtendedMaxRequestSize(eventPtr->xproperty.display);
+	    if (maxRequest == 0) {
+		maxRequest = XMaxRequestSize(eventPtr->xproperty.display);
+	    }
+	    maxRequest = (maxRequest - 1024) * 4;
+	    if (maxRequest > MAX_PROP_WORDS * 4) {
+		maxRequest = MAX_PROP_WORDS * 4;
+	    }
+	    chunkSize = (int) maxRequest;
+	    if (chunkSize < TK_SEL_BYTES_AT_ONCE) {
+		chunkSize = TK_SEL_BYTES_AT_ONCE;
+	    }
+	    chunk = (char *)ckalloc(chunkSize + 1);
+
 	    formatType = selPtr->format;
+	    atEnd = 0;
 	    if (incrPtr->converts[i].offset == -2) {
 		/*
 		 * We already got the last chunk, so send a null chunk to
@@ -317,8 +339,10 @@ TkSelPropProc(
 
 		numItems = 0;
 		length = 0;
+		atEnd = 1;
 	    } else {
 		TkSelInProgress ip;
+		Tcl_Size got;
 
 		ip.selPtr = selPtr;
 		ip.nextPtr = TkSelGetInProgress();
@@ -326,38 +350,51 @@ TkSelPropProc(
 
 		/*
 		 * Copy any bytes left over from a partial character at the
-		 * end of the previous chunk into the beginning of the buffer.
-		 * Pass the rest of the buffer space into the selection
-		 * handler.
+		 * end of the previous chunk into the beginning of the
+		 * buffer, then append handler data until the chunk is full
+		 * or the handler runs out of selection.
 		 */
 
 		length = strlen(incrPtr->converts[i].buffer);
-		strcpy((char *)buffer, incrPtr->converts[i].buffer);
+		strcpy(chunk, incrPtr->converts[i].buffer);
+		numItems = length;
 
-		numItems = selPtr->proc(selPtr->clientData,
-			incrPtr->converts[i].offset,
-			((char *) buffer) + length,
-			TK_SEL_BYTES_AT_ONCE - length);
-		TkSelSetInProgress(ip.nextPtr);
-		if (ip.selPtr == NULL) {
-		    /*
-		     * The selection handler deleted itself.
-		     */
+		while ((numItems == length)
+			|| (numItems + TK_SEL_BYTES_AT_ONCE <= chunkSize)) {
+		    int ask = TK_SEL_BYTES_AT_ONCE;
 
-		    return;
-		}
-		if (numItems == TCL_INDEX_NONE) {
-		    numItems = 0;
-		}
-		numItems += length;
-		if (numItems > TK_SEL_BYTES_AT_ONCE) {
-		    Tcl_Panic("selection handler returned too many bytes");
+		    if (numItems == length) {
+			ask -= length;
+		    }
+		    got = selPtr->proc(selPtr->clientData,
+			    incrPtr->converts[i].offset + (numItems - length),
+			    chunk + numItems, ask);
+		    if (ip.selPtr == NULL) {
+			/*
+			 * The selection handler deleted itself.
+			 */
+
+			TkSelSetInProgress(ip.nextPtr);
+			ckfree(chunk);
+			return;
+		    }
+		    if (got == TCL_INDEX_NONE) {
+			got = 0;
+		    }
+		    if (got > ask) {
+			Tcl_Panic("selection handler returned too many bytes");
+		    }
+		    numItems += got;
+		    if (got < ask) {
+			atEnd = 1;
+			break;
+		    }
 		}
+		TkSelSetInProgress(ip.nextPtr);
 	    }
-	    ((char *) buffer)[numItems] = 0;
+	    chunk[numItems] = 0;
 
-	    errorHandler = Tk_CreateErrorHandler(eventPtr->xproperty.display,
-		    -1, -1, -1, NULL, NULL);
+	    TkPushErrorGuard(eventPtr->xproperty.display, &errorGuard);
 
 	    /*
 	     * Encode the data using the proper format for each type.
@@ -381,7 +418,7 @@ TkSelPropProc(
 		if (incrPtr->converts[i].offset == 0) {
 		    encodingCvtFlags |= TCL_ENCODING_START;
 		}
-		if (numItems < TK_SEL_BYTES_AT_ONCE) {
+		if (atEnd) {
 		    encodingCvtFlags |= TCL_ENCODING_END;
 		}
 		if (formatType == XA_STRING) {
@@ -396,7 +433,7 @@ TkSelPropProc(
 		 * Now convert the data.
 		 */
 
-		src = (char *)buffer;
+		src = chunk;
 		srcLen = numItems;
 		Tcl_DStringInit(&ds);
 		dst = Tcl_DStringValue(&ds);
@@ -457,7 +494,7 @@ TkSelPropProc(
 		 * Set the property to the encoded string value.
 		 */
 
-		char *propPtr = (char *) SelCvtToX((char *) buffer,
+		char *propPtr = (char *) SelCvtToX(chunk,
 			formatType, (Tk_Window) incrPtr->winPtr, &numItems);
 
 		if (propPtr == NULL) {
@@ -471,7 +508,8 @@ TkSelPropProc(
 		    ckfree(propPtr);
 		}
 	    }
-	    Tk_DeleteErrorHandler(errorHandler);
+	    TkPopErrorGuard(&errorGuard);
+	    ckfree(chunk);
 
 	    /*
 	     * Compute the next offset value. If this was the last chunk, then
@@ -479,7 +517,7 @@ TkSelPropProc(
 	     * offset to -1 to indicate we are done.
 	     */
 
-	    if (numItems < TK_SEL_BYTES_AT_ONCE) {
+	    if (atEnd) {
 		if (numItems < 1) {
 		    incrPtr->converts[i].offset = -1;
 		    incrPtr->numIncrs--;
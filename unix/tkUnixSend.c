@@ -92,6 +92,11 @@ typedef struct PendingCommand {
 				 * NULL (malloc'ed). */
     int gotResponse;		/* 1 means a response has been received, 0
 				 * means the command is still outstanding. */
+    int localFailure;		/* 1 means the command never reached the
+				 * target: the property append failed or the
+				 * target was found to be dead. Used to
+				 * distinguish delivery failures from errors
+				 * reported by the target itself. */
     struct PendingCommand *nextPtr;
 				/* Next in list of all outstanding commands.
 				 * NULL means end of list. */
@@ -104,6 +109,16 @@ typedef struct {
     RegisteredInterp *interpListPtr;
 				/* List of all interpreters registered in the
 				 * current process. */
+    int cacheInitialized;	/* 1 means nameWindowCache has been set up. */
+    Tcl_HashTable nameWindowCache;
+				/* Maps "displayName interpName" to the comm
+				 * window that the name registry gave for it
+				 * last time, so that repeated synchronous
+				 * sends to the same peer need not re-read
+				 * the registry property. Stale entries are
+				 * detected by delivery failure and dropped,
+				 * after which the send is retried through
+				 * the registry. */
 } ThreadSpecificData;
 static Tcl_ThreadDataKey dataKey;
 
@@ -967,7 +982,9 @@ Tk_SendObjCmd(
     TkDisplay *dispPtr;
     Tcl_Time timeout;
     NameRegistry *regPtr;
-    Tcl_DString request;
+    Tcl_DString request, cacheKey;
+    Tcl_HashEntry *hPtr;
+    int triedCache;
     ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
 	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
     Tcl_Interp *localInterp;	/* Used when the interpreter to send the
@@ -1081,18 +1098,53 @@ Tk_SendObjCmd(
     }
 
     /*
-     * Bind the interpreter name to a communication window.
+     * Bind the interpreter name to a communication window. For synchronous
+     * sends the binding found in the registry is cached, so that repeated
+     * sends to the same peer skip the registry read; a stale cache entry
+     * shows up as a delivery failure below, which drops the entry and
+     * retries here through the registry. Asynchronous sends get no
+     * delivery feedback, so they always consult the registry.
      */
 
-    regPtr = RegOpen(interp, winPtr->dispPtr, 0);
-    commWindow = RegFindName(regPtr, destName);
-    RegClose(regPtr);
+    if (!tsdPtr->cacheInitialized) {
+	tsdPtr->cacheInitialized = 1;
+	Tcl_InitHashTable(&tsdPtr->nameWindowCache, TCL_STRING_KEYS);
+    }
+    Tcl_DStringInit(&cacheKey);
+    Tcl_DStringAppend(&cacheKey, dispPtr->name, TCL_INDEX_NONE);
+    Tcl_DStringAppend(&cacheKey, " ", 1);
+    Tcl_DStringAppend(&cacheKey, destName, TCL_INDEX_NONE);
+    triedCache = 0;
+
+  lookup:
+    commWindow = None;
+    if (!async && !triedCache) {
+	hPtr = Tcl_FindHashEntry(&tsdPtr->nameWindowCache,
+		Tcl_DStringValue(&cacheKey));
+	if (hPtr != NULL) {
+	    commWindow = (Window) (uintptr_t) Tcl_GetHashValue(hPtr);
+	    triedCache = 1;
+	}
+    }
     if (commWindow == None) {
-	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
-		"no application named \"%s\"", destName));
-	Tcl_SetErrorCode(interp, "TK", "LOOKUP", "APPLICATION", destName,
-		NULL);
-	return TCL_ERROR;
+	regPtr = RegOpen(interp, winPtr->dispPtr, 0);
+	commWindow = RegFindName(regPtr, destName);
+	RegClose(regPtr);
+	if (commWindow == None) {
+	    Tcl_DStringFree(&cacheKey);
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "no application named \"%s\"", destName));
+	    Tcl_SetErrorCode(interp, "TK", "LOOKUP", "APPLICATION", destName,
+		    NULL);
+	    return TCL_ERROR;
+	}
+	if (!async) {
+	    int isNew;
+
+	    hPtr = Tcl_CreateHashEntry(&tsdPtr->nameWindowCache,
+		    Tcl_DStringValue(&cacheKey), &isNew);
+	    Tcl_SetHashValue(hPtr, (void *) (uintptr_t) commWindow);
+	}
     }
 
     /*
@@ -1141,6 +1193,7 @@ Tk_SendObjCmd(
 	pending.errorInfo = NULL;
 	pending.errorCode = NULL;
 	pending.gotResponse = 0;
+	pending.localFailure = 0;
 	pending.nextPtr = tsdPtr->pendingCommands;
 	tsdPtr->pendingCommands = &pending;
     }
@@ -1154,6 +1207,7 @@ Tk_SendObjCmd(
 	 * for a response.
 	 */
 
+	Tcl_DStringFree(&cacheKey);
 	return TCL_OK;
     }
 
@@ -1188,6 +1242,7 @@ Tk_SendObjCmd(
 		pending.code = TCL_ERROR;
 		pending.result = (char *)ckalloc(strlen(msg) + 1);
 		strcpy(pending.result, msg);
+		pending.localFailure = 1;
 		pending.gotResponse = 1;
 	    } else {
 		Tcl_GetTime(&timeout);
@@ -1206,6 +1261,32 @@ Tk_SendObjCmd(
 	Tcl_Panic("Tk_SendCmd: corrupted send stack");
     }
     tsdPtr->pendingCommands = pending.nextPtr;
+
+    /*
+     * If delivery through a cached window binding failed, the peer has
+     * probably exited and restarted with a new comm window. Drop the stale
+     * entry and try again, this time reading the registry.
+     */
+
+    if (pending.localFailure && triedCache) {
+	hPtr = Tcl_FindHashEntry(&tsdPtr->nameWindowCache,
+		Tcl_DStringValue(&cacheKey));
+	if (hPtr != NULL) {
+	    Tcl_DeleteHashEntry(hPtr);
+	}
+	if (pending.result != NULL) {
+	    ckfree(pending.result);
+	}
+	if (pending.errorInfo != NULL) {
+	    ckfree(pending.errorInfo);
+	}
+	if (pending.errorCode != NULL) {
+	    ckfree(pending.errorCode);
+	}
+	triedCache = 0;
+	goto lookup;
+    }
+    Tcl_DStringFree(&cacheKey);
     if (pending.errorInfo != NULL) {
 	/*
 	 * Special trick: must clear the interp's result before calling
@@ -1810,6 +1891,7 @@ AppendErrorProc(
 	    snprintf(pcPtr->result, strlen(pcPtr->target) + 50, "no application named \"%s\"",
 		    pcPtr->target);
 	    pcPtr->code = TCL_ERROR;
+	    pcPtr->localFailure = 1;
 	    pcPtr->gotResponse = 1;
 	    break;
 	}
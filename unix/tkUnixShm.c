@@ -0,0 +1,283 @@
+/*
+ * tkUnixShm.c --
+ *
+ *	This file implements shared-memory XImage transfers using the MIT-SHM
+ *	extension.  When the X server runs on the same machine as Tk, image
+ *	data placed in a shared segment can be read by the server directly,
+ *	avoiding the copy of every pixel through the connection socket that
+ *	XPutImage performs.
+ *
+ * Copyright © 2026 Tk Core Team.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#include "tkUnixInt.h"
+
+#ifdef HAVE_XSHM
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/extensions/XShm.h>
+
+/*
+ * One of the following structures exists for every shared-memory image
+ * created by TkpShmCreateImage.  The segments are kept on a list so that
+ * TkpShmDestroyImage can recover the segment belonging to an image.
+ */
+
+typedef struct TkShmSegment {
+    XImage *imagePtr;		/* The image using this segment. */
+    Display *display;		/* Display the segment is attached to. */
+    XShmSegmentInfo info;	/* MIT-SHM bookkeeping for the segment. */
+    struct TkShmSegment *nextPtr;
+				/* Next segment on the list, or NULL. */
+} TkShmSegment;
+
+static TkShmSegment *segmentList = NULL;
+TCL_DECLARE_MUTEX(shmMutex)
+
+/*
+ * Set by ShmErrorProc when the server rejects an attach, which is how a
+ * server on a different machine (or one that cannot see this client's
+ * shared memory) reports that MIT-SHM cannot be used.  Protected by
+ * shmMutex.
+ */
+
+static int shmAttachFailed = 0;
+
+static int		ShmErrorProc(void *clientData,
+			    XErrorEvent *errorPtr);
+
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkpShmCreateImage --
+ *
+ *	Creates an XImage whose pixel storage is a System V shared memory
+ *	segment that is also attached to the X server, so that the image can
+ *	later be pushed to the server with TkpShmPutImage without copying
+ *	the pixels through the connection.
+ *
+ * Results:
+ *	A pointer to the image, or NULL if the MIT-SHM extension is not
+ *	usable on this display (in particular when the server runs on a
+ *	different machine), if the format is not ZPixmap, or if the segment
+ *	could not be created or attached.  Callers must be prepared to fall
+ *	back to a conventional XImage and XPutImage.
+ *
+ * Side effects:
+ *	A shared memory segment is created and attached both to this process
+ *	and to the server.  If the server rejects the attach, MIT-SHM is
+ *	disabled for the display so that later calls fail cheaply.
+ *
+ *----------------------------------------------------------------------
+ */
+
+XImage *
+TkpShmCreateImage(
+    Display *display,		/* Display the image will be written to. */
+    Visual *visual,		/* Visual the image is formatted for. */
+    int depth,			/* Depth of the image. */
+    int format,			/* Image format; only ZPixmap is eligible
+				 * for shared transfers. */
+    unsigned int width,		/* Dimensions determining the size of the */
+    unsigned int height)	/* shared segment. */
+{
+    TkDisplay *dispPtr = TkGetDisplay(display);
+    TkShmSegment *segPtr;
+    XImage *imagePtr;
+    Tk_ErrorHandler handler;
+    size_t size;
+    int failed;
+
+    if ((dispPtr == NULL) || !(dispPtr->flags & TK_DISPLAY_XSHM)
+	    || (format != ZPixmap)) {
+	return NULL;
+    }
+
+    segPtr = (TkShmSegment *)ckalloc(sizeof(TkShmSegment));
+    memset(segPtr, 0, sizeof(TkShmSegment));
+    imagePtr = XShmCreateImage(display, visual, (unsigned) depth, format,
+	    NULL, &segPtr->info, width, height);
+    if (imagePtr == NULL) {
+	ckfree(segPtr);
+	return NULL;
+    }
+    size = (size_t)imagePtr->bytes_per_line * (size_t)imagePtr->height;
+    segPtr->info.shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+    if (segPtr->info.shmid < 0) {
+	XDestroyImage(imagePtr);
+	ckfree(segPtr);
+	return NULL;
+    }
+    segPtr->info.shmaddr = (char *)shmat(segPtr->info.shmid, NULL, 0);
+    if (segPtr->info.shmaddr == (char *)-1) {
+	shmctl(segPtr->info.shmid, IPC_RMID, NULL);
+	XDestroyImage(imagePtr);
+	ckfree(segPtr);
+	return NULL;
+    }
+    segPtr->info.readOnly = True;
+    imagePtr->data = segPtr->info.shmaddr;
+
+    /*
+     * The attach is the point where a server that cannot share memory with
+     * this client reports failure, as a protocol error.  Catch it, and give
+     * up on MIT-SHM for this display entirely so that later images go
+     * straight to the socket path instead of repeating a handshake that
+     * cannot succeed.
+     */
+
+    Tcl_MutexLock(&shmMutex);
+    shmAttachFailed = 0;
+    handler = Tk_CreateErrorHandler(display, -1, -1, -1, ShmErrorProc, NULL);
+    XShmAttach(display, &segPtr->info);
+    XSync(display, False);
+    Tk_DeleteErrorHandler(handler);
+    failed = shmAttachFailed;
+
+    /*
+     * Mark the segment for deletion now: it goes away for good once both
+     * sides have detached, and is not left behind if this process dies
+     * without cleaning up.
+     */
+
+    shmctl(segPtr->info.shmid, IPC_RMID, NULL);
+    if (failed) {
+	Tcl_MutexUnlock(&shmMutex);
+	dispPtr->flags &= ~TK_DISPLAY_XSHM;
+	shmdt(segPtr->info.shmaddr);
+	imagePtr->data = NULL;
+	XDestroyImage(imagePtr);
+	ckfree(segPtr);
+	return NULL;
+    }
+
+    segPtr->imagePtr = imagePtr;
+    segPtr->display = display;
+    segPtr->nextPtr = segmentList;
+    segmentList = segPtr;
+    Tcl_MutexUnlock(&shmMutex);
+    return imagePtr;
+}
+
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkpShmPutImage --
+ *
+ *	Pushes (part of) a shared-memory image created by TkpShmCreateImage
+ *	to a drawable.  The server reads the pixels from the shared segment,
+ *	so only the request itself travels over the connection.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Waits until the server has read the segment, so that the caller is
+ *	free to overwrite the image data as soon as this returns.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkpShmPutImage(
+    Display *display,		/* Display to draw on. */
+    Drawable drawable,		/* Pixmap or window to draw into. */
+    GC gc,			/* Graphics context to draw with. */
+    XImage *imagePtr,		/* Image returned by TkpShmCreateImage. */
+    int srcX, int srcY,		/* Origin of the block within the image. */
+    int destX, int destY,	/* Where to place the block. */
+    unsigned int width,		/* Dimensions of the block. */
+    unsigned int height)
+{
+    XShmPutImage(display, drawable, gc, imagePtr, srcX, srcY, destX, destY,
+	    width, height, False);
+    XSync(display, False);
+}
+
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkpShmDestroyImage --
+ *
+ *	Releases an image created by TkpShmCreateImage together with its
+ *	shared memory segment.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The segment is detached from the server and from this process, and
+ *	the image structure is freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkpShmDestroyImage(
+    Display *display,		/* Display the image was created for. */
+    XImage *imagePtr)		/* Image returned by TkpShmCreateImage. */
+{
+    TkShmSegment *segPtr, **segPtrPtr;
+
+    Tcl_MutexLock(&shmMutex);
+    for (segPtrPtr = &segmentList; (segPtr = *segPtrPtr) != NULL;
+	    segPtrPtr = &segPtr->nextPtr) {
+	if (segPtr->imagePtr == imagePtr) {
+	    *segPtrPtr = segPtr->nextPtr;
+	    break;
+	}
+    }
+    Tcl_MutexUnlock(&shmMutex);
+    if (segPtr == NULL) {
+	return;
+    }
+    XShmDetach(display, &segPtr->info);
+    XSync(display, False);
+    shmdt(segPtr->info.shmaddr);
+    imagePtr->data = NULL;
+    XDestroyImage(imagePtr);
+    ckfree(segPtr);
+}
+
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ShmErrorProc --
+ *
+ *	Error handler installed while attaching a segment to the server.
+ *
+ * Results:
+ *	Returns 0, indicating that the error has been dealt with.
+ *
+ * Side effects:
+ *	Records that the attach failed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ShmErrorProc(
+    TCL_UNUSED(void *),
+    TCL_UNUSED(XErrorEvent *))
+{
+    shmAttachFailed = 1;
+    return 0;
+}
+
+#endif /* HAVE_XSHM */
+
+/*
+ * Local Variables:
+ * mode: c
+ * c-basic-offset: 4
+ * fill-column: 78
+ * End:
+ */
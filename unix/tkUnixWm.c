@@ -176,6 +176,16 @@ typedef struct TkWmInfo {
 				 * issued to change geometry of the wrapper.
 				 * Used to eliminate redundant resize
 				 * operations. */
+    unsigned long syncSerial;	/* Serial number of the last geometry request
+				 * issued to the X server; a ConfigureNotify
+				 * carrying at least this serial completes the
+				 * synchronization started by BeginSync. */
+    int syncEvent;		/* Type of event (ConfigureNotify, MapNotify,
+				 * or UnmapNotify) that will complete the
+				 * pending synchronization, if any. */
+    Tcl_TimerToken syncTimer;	/* Timer after which a pending synchronization
+				 * is abandoned, or NULL; the window manager
+				 * may legitimately decide not to respond. */
 
     /*
      * Information about the virtual root window for this top-level, if there
@@ -234,8 +244,12 @@ typedef struct TkWmInfo {
  *				down from top.
  * WM_UPDATE_SIZE_HINTS -	non-zero means that new size hints need to be
  *				propagated to window manager.
- * WM_SYNC_PENDING -		set to non-zero while waiting for the window
- *				manager to respond to some state change.
+ * WM_SYNC_PENDING -		non-zero means we have asked the window
+ *				manager for some state change and the event
+ *				acknowledging it hasn't arrived yet (see
+ *				BeginSync). ConfigureNotify events received
+ *				in the meantime reflect our own request, not
+ *				a user action.
  * WM_VROOT_OFFSET_STALE -	non-zero means that (x,y) offset information
  *				about the virtual root window is stale and
  *				needs to be fetched fresh from the X server.
@@ -320,20 +334,6 @@ static const Tk_GeomMgr menubarMgrType = {
     NULL,			/* lostContentProc */
 };
 
-/*
- * Structures of the following type are used for communication between
- * WaitForEvent, WaitRestrictProc, and WaitTimeoutProc.
- */
-
-typedef struct WaitRestrictInfo {
-    Display *display;		/* Window belongs to this display. */
-    WmInfo *wmInfoPtr;
-    int type;			/* We only care about this type of event. */
-    XEvent *eventPtr;		/* Where to store the event when it's found. */
-    int foundEvent;		/* Non-zero means that an event of the desired
-				 * type has been found. */
-} WaitRestrictInfo;
-
 /*
  * Forward declarations for functions defined in this file:
  */
@@ -368,12 +368,10 @@ static Tcl_Obj *	GetNetWmType(TkWindow *winPtr);
 static void 		SetNetWmState(TkWindow*, const char *atomName, int on);
 static void 		CheckNetWmState(WmInfo *, Atom *atoms, int numAtoms);
 static void 		UpdateNetWmState(WmInfo *);
-static void		WaitForConfigureNotify(TkWindow *winPtr,
+static void		BeginSync(TkWindow *winPtr, int type,
 			    unsigned long serial);
-static int		WaitForEvent(Display *display,
-			    WmInfo *wmInfoPtr, int type, XEvent *eventPtr);
-static void		WaitForMapNotify(TkWindow *winPtr, int mapped);
-static Tk_RestrictProc WaitRestrictProc;
+static void		EndSync(WmInfo *wmPtr);
+static void		SyncTimeoutProc(void *clientData);
 static void		WrapperEventProc(void *clientData,
 			    XEvent *eventPtr);
 static void		WmWaitMapProc(void *clientData,
@@ -471,6 +469,9 @@ static int		WmStateCmd(Tk_Window tkwin, TkWindow *winPtr,
 static int		WmTitleCmd(Tk_Window tkwin, TkWindow *winPtr,
 			    Tcl_Interp *interp, Tcl_Size objc,
 			    Tcl_Obj *const objv[]);
+static int		WmTransactionCmd(Tk_Window tkwin, TkWindow *winPtr,
+			    Tcl_Interp *interp, Tcl_Size objc,
+			    Tcl_Obj *const objv[]);
 static int		WmTransientCmd(Tk_Window tkwin, TkWindow *winPtr,
 			    Tcl_Interp *interp, Tcl_Size objc,
 			    Tcl_Obj *const objv[]);
@@ -763,13 +764,27 @@ TkWmMapWindow(
     UpdateNetWmState(wmPtr);
 
     /*
-     * Map the window, then wait to be sure that the window manager has
-     * processed the map operation.
+     * Apply an alpha value that was requested before the wrapper existed;
+     * WmSetAttribute could only record it at that point.
+     */
+
+    if (wmPtr->attributes.alpha != wmPtr->reqState.alpha
+	    && wmPtr->reqState.alpha < 1.0) {
+	unsigned long opacity = 0xFFFFFFFFul * wmPtr->reqState.alpha;
+
+	SetWindowProperty(wmPtr->wrapperPtr, "_NET_WM_WINDOW_OPACITY",
+		XA_CARDINAL, 32, &opacity, 1L);
+	wmPtr->attributes.alpha = wmPtr->reqState.alpha;
+    }
+
+    /*
+     * Map the window. The window manager's MapNotify event will complete
+     * the synchronization begun below; see BeginSync.
      */
 
     XMapWindow(winPtr->display, wmPtr->wrapperPtr->window);
     if (wmPtr->hints.initial_state == NormalState) {
-	WaitForMapNotify(winPtr, 1);
+	BeginSync(winPtr, MapNotify, 0);
     }
 }
 
@@ -779,7 +794,7 @@ TkWmMapWindow(
  * TkWmUnmapWindow --
  *
  *	This function is invoked to unmap a top-level window. The only thing
- *	it does special is to wait for the window actually to be unmapped.
+ *	it does special is to track when the window actually gets unmapped.
  *
  * Results:
  *	None.
@@ -796,17 +811,18 @@ TkWmUnmapWindow(
 				 * mapped. */
 {
     /*
-     * It seems to be important to wait after unmapping a top-level window
-     * until the window really gets unmapped. I don't completely understand
-     * all the interactions with the window manager, but if we go on without
-     * waiting, and if the window is then mapped again quickly, events seem to
-     * get lost so that we think the window isn't mapped when in fact it is
-     * mapped. I suspect that this has something to do with the window manager
-     * filtering Map events (and possily not filtering Unmap events?).
+     * It seems to be important to synchronize with the window manager after
+     * unmapping a top-level window. I don't completely understand all the
+     * interactions with the window manager, but if the window is mapped
+     * again quickly while the UnmapNotify is still outstanding, events seem
+     * to get lost so that we think the window isn't mapped when in fact it
+     * is mapped. I suspect that this has something to do with the window
+     * manager filtering Map events (and possily not filtering Unmap
+     * events?). BeginSync keeps track of the outstanding UnmapNotify.
      */
 
     XUnmapWindow(winPtr->display, winPtr->wmInfoPtr->wrapperPtr->window);
-    WaitForMapNotify(winPtr, 0);
+    BeginSync(winPtr, UnmapNotify, 0);
 }
 
 /*
@@ -910,6 +926,9 @@ TkWmDeadWindow(
     if (wmPtr->flags & WM_UPDATE_PENDING) {
 	Tcl_CancelIdleCall(UpdateGeometryInfo, winPtr);
     }
+    if (wmPtr->syncTimer != NULL) {
+	Tcl_DeleteTimerHandler(wmPtr->syncTimer);
+    }
 
     /*
      * Reset all transient windows whose container is the dead window.
@@ -1024,7 +1043,7 @@ Tk_WmObjCmd(
 	"iconposition", "iconwindow", "manage", "maxsize",
 	"minsize", "overrideredirect", "positionfrom",
 	"protocol", "resizable", "sizefrom", "stackorder",
-	"state", "title", "transient", "withdraw", NULL };
+	"state", "title", "transaction", "transient", "withdraw", NULL };
     enum options {
 	WMOPT_ASPECT, WMOPT_ATTRIBUTES, WMOPT_CLIENT, WMOPT_COLORMAPWINDOWS,
 	WMOPT_COMMAND, WMOPT_DEICONIFY, WMOPT_FOCUSMODEL, WMOPT_FORGET,
@@ -1034,7 +1053,8 @@ Tk_WmObjCmd(
 	WMOPT_ICONPOSITION, WMOPT_ICONWINDOW, WMOPT_MANAGE, WMOPT_MAXSIZE,
 	WMOPT_MINSIZE, WMOPT_OVERRIDEREDIRECT, WMOPT_POSITIONFROM,
 	WMOPT_PROTOCOL, WMOPT_RESIZABLE, WMOPT_SIZEFROM, WMOPT_STACKORDER,
-	WMOPT_STATE, WMOPT_TITLE, WMOPT_TRANSIENT, WMOPT_WITHDRAW };
+	WMOPT_STATE, WMOPT_TITLE, WMOPT_TRANSACTION, WMOPT_TRANSIENT,
+	WMOPT_WITHDRAW };
     int index;
     const char *argv1;
     TkWindow *winPtr;
@@ -1157,6 +1177,8 @@ Tk_WmObjCmd(
 	return WmStateCmd(tkwin, winPtr, interp, objc, objv);
     case WMOPT_TITLE:
 	return WmTitleCmd(tkwin, winPtr, interp, objc, objv);
+    case WMOPT_TRANSACTION:
+	return WmTransactionCmd(tkwin, winPtr, interp, objc, objv);
     case WMOPT_TRANSIENT:
 	return WmTransientCmd(tkwin, winPtr, interp, objc, objv);
     case WMOPT_WITHDRAW:
@@ -1283,9 +1305,27 @@ WmSetAttribute(
 	    break;
 	}
 
-	opacity = 0xFFFFFFFFul * wmPtr->reqState.alpha;
-	SetWindowProperty(wmPtr->wrapperPtr, "_NET_WM_WINDOW_OPACITY",
-		XA_CARDINAL, 32, &opacity, 1L);
+	/*
+	 * The compositor applies the opacity itself, so nothing needs to be
+	 * repainted; only the property has to change, and not even that
+	 * when the value is the same as before (fading code tends to replay
+	 * its endpoints). A fully opaque window gets the property removed
+	 * instead, which lets the compositor take it off its translucency
+	 * path altogether.
+	 */
+
+	if (wmPtr->attributes.alpha == wmPtr->reqState.alpha) {
+	    break;
+	}
+	if (wmPtr->reqState.alpha >= 1.0) {
+	    XDeleteProperty(winPtr->display, wmPtr->wrapperPtr->window,
+		    Tk_InternAtom((Tk_Window) wmPtr->wrapperPtr,
+		    "_NET_WM_WINDOW_OPACITY"));
+	} else {
+	    opacity = 0xFFFFFFFFul * wmPtr->reqState.alpha;
+	    SetWindowProperty(wmPtr->wrapperPtr, "_NET_WM_WINDOW_OPACITY",
+		    XA_CARDINAL, 32, &opacity, 1L);
+	}
 	wmPtr->attributes.alpha = wmPtr->reqState.alpha;
 
 	break;
@@ -2725,7 +2765,7 @@ WmIconwindowCmd(
 		Tcl_SetErrorCode(interp, "TK", "WM", "COMMUNICATION", NULL);
 		return TCL_ERROR;
 	    }
-	    WaitForMapNotify((TkWindow *) tkwin2, 0);
+	    BeginSync((TkWindow *) tkwin2, UnmapNotify, 0);
 	}
     }
     UpdateHints(winPtr);
@@ -3549,6 +3589,50 @@ WmTitleCmd(
     return TCL_OK;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * WmTransactionCmd --
+ *
+ *	This function is invoked to process the "wm transaction" Tcl command.
+ *	See the user documentation for details on what it does.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	See the user documentation.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+WmTransactionCmd(
+    TCL_UNUSED(Tk_Window),	/* Main window of the application. */
+    TkWindow *winPtr,		/* Toplevel to work with */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    Tcl_Size objc,		/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    static const char *const optionStrings[] = {
+	"begin", "commit", NULL };
+    enum transOptions { TRANS_BEGIN, TRANS_COMMIT };
+    int index;
+
+    if (objc != 4) {
+	Tcl_WrongNumArgs(interp, 2, objv, "window begin|commit");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObjStruct(interp, objv[3], optionStrings,
+	    sizeof(char *), "option", 0, &index) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (index == TRANS_BEGIN) {
+	return TkWmTransactionBegin(interp, winPtr);
+    }
+    return TkWmTransactionCommit(interp, winPtr);
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -4160,6 +4244,18 @@ ConfigureEvent(
     winPtr->changes.width = wrapperPtr->changes.width;
     winPtr->changes.height = wrapperPtr->changes.height - wmPtr->menuHeight;
     TkDoConfigureNotify(winPtr);
+
+    /*
+     * If we have asked the window manager to move or resize the window and
+     * this event carries the serial number of that request (or a later one),
+     * the negotiation is complete.
+     */
+
+    if ((wmPtr->flags & WM_SYNC_PENDING)
+	    && (wmPtr->syncEvent == ConfigureNotify)
+	    && ((int) (configEventPtr->serial - wmPtr->syncSerial) >= 0)) {
+	EndSync(wmPtr);
+    }
 }
 
 /*
@@ -4453,7 +4549,7 @@ PropertyEvent(
  */
 
 static const unsigned WrapperEventMask =
-	(StructureNotifyMask | PropertyChangeMask);
+	(StructureNotifyMask | PropertyChangeMask | VisibilityChangeMask);
 
 static void
 WrapperEventProc(
@@ -4502,16 +4598,35 @@ WrapperEventProc(
 	wmPtr->wrapperPtr->flags |= TK_MAPPED;
 	wmPtr->winPtr->flags |= TK_MAPPED;
 	XMapWindow(wmPtr->winPtr->display, wmPtr->winPtr->window);
+	if ((wmPtr->flags & WM_SYNC_PENDING)
+		&& (wmPtr->syncEvent == MapNotify)) {
+	    EndSync(wmPtr);
+	}
 	goto doMapEvent;
     } else if (eventPtr->type == UnmapNotify) {
 	wmPtr->wrapperPtr->flags &= ~TK_MAPPED;
 	wmPtr->winPtr->flags &= ~TK_MAPPED;
 	XUnmapWindow(wmPtr->winPtr->display, wmPtr->winPtr->window);
+	if ((wmPtr->flags & WM_SYNC_PENDING)
+		&& (wmPtr->syncEvent == UnmapNotify)) {
+	    EndSync(wmPtr);
+	}
 	goto doMapEvent;
     } else if (eventPtr->type == ReparentNotify) {
 	ReparentEvent(wmPtr, &eventPtr->xreparent);
     } else if (eventPtr->type == PropertyNotify) {
 	PropertyEvent(wmPtr, &eventPtr->xproperty);
+    } else if (eventPtr->type == VisibilityNotify) {
+	/*
+	 * The wrapper is the window the server reports visibility for, but
+	 * display procedures check the toplevel, so mirror the state there.
+	 */
+
+	if (eventPtr->xvisibility.state == VisibilityFullyObscured) {
+	    wmPtr->winPtr->flags |= TK_OBSCURED;
+	} else {
+	    wmPtr->winPtr->flags &= ~TK_OBSCURED;
+	}
     }
     return;
 
@@ -4592,8 +4707,8 @@ TopLevelReqProc(
  *	This function is invoked when a top-level window is first mapped, and
  *	also as a when-idle function, to bring the geometry and/or position of
  *	a top-level window back into line with what has been requested by the
- *	user and/or widgets. This function doesn't return until the window
- *	manager has responded to the geometry change.
+ *	user and/or widgets. The window manager's response to the geometry
+ *	change is tracked asynchronously; see BeginSync.
  *
  * Results:
  *	None.
@@ -4746,8 +4861,8 @@ UpdateGeometryInfo(
      *    asked for (e.g. mwm has a minimum size for windows), so base the
      *    size check on what we *asked for* last time, not what we got.
      * 3. Can't just reconfigure always, because we may not get a
-     *    ConfigureNotify event back if nothing changed, so
-     *    WaitForConfigureNotify will hang a long time.
+     *    ConfigureNotify event back if nothing changed, so the
+     *    synchronization started below would just time out.
      * 4. Don't move window unless a new position has been requested for it.
      *	  This is because of "features" in some window managers (e.g. twm, as
      *	  of 4/24/91) where they don't interpret coordinates according to
@@ -4785,8 +4900,8 @@ UpdateGeometryInfo(
 	    /*
 	     * The window already has the correct geometry, so don't bother to
 	     * configure it; the X server appears to ignore these requests, so
-	     * we won't get back a ConfigureNotify and the
-	     * WaitForConfigureNotify call below will hang for a while.
+	     * we won't get back a ConfigureNotify, and the
+	     * synchronization started below would just time out.
 	     */
 
 	    wmPtr->flags &= ~WM_MOVE_PENDING;
@@ -4807,8 +4922,8 @@ UpdateGeometryInfo(
 	    /*
 	     * The window is already just the size we want, so don't bother to
 	     * configure it; the X server appears to ignore these requests, so
-	     * we won't get back a ConfigureNotify and the
-	     * WaitForConfigureNotify call below will hang for a while.
+	     * we won't get back a ConfigureNotify, and the
+	     * synchronization started below would just time out.
 	     */
 
 	    return;
@@ -4838,13 +4953,13 @@ UpdateGeometryInfo(
     }
 
     /*
-     * Wait for the configure operation to complete. Don't need to do this,
-     * however, if the window is about to be mapped: it will be taken care of
-     * elsewhere.
+     * Track the configure operation until the window manager acknowledges
+     * it. Don't need to do this, however, if the window is about to be
+     * mapped: it will be taken care of elsewhere.
      */
 
     if (!(wmPtr->flags & WM_ABOUT_TO_MAP)) {
-	WaitForConfigureNotify(winPtr, serial);
+	BeginSync(winPtr, ConfigureNotify, serial);
     }
 }
 
@@ -5179,263 +5294,126 @@ UpdateNetWmState(
 /*
  *----------------------------------------------------------------------
  *
- * WaitForConfigureNotify --
+ * BeginSync --
  *
- *	This function is invoked in order to synchronize with the window
- *	manager. It waits for a ConfigureNotify event to arrive, signalling
- *	that the window manager has seen an attempt on our part to move or
- *	resize a top-level window.
+ *	This function is invoked after asking the window manager to map,
+ *	unmap, move, or resize a top-level window. It records which event
+ *	will acknowledge the request, so that when the event arrives it can
+ *	be told apart from a spontaneous user action. Earlier versions of Tk
+ *	made this distinction by blocking the event loop until the
+ *	acknowledgement arrived; recording the expectation instead lets any
+ *	number of top-level windows negotiate geometry with the window
+ *	manager at the same time.
  *
  * Results:
  *	None.
  *
  * Side effects:
- *	Delays the execution of the process until a ConfigureNotify event
- *	arrives with serial number at least as great as serial. This is useful
- *	for two reasons:
- *
- *	1. It's important to distinguish ConfigureNotify events that are
- *	   coming in response to a request we've made from those generated
- *	   spontaneously by the user. The reason for this is that if the user
- *	   resizes the window we take that as an order to ignore geometry
- *	   requests coming from inside the window hierarchy. If we
- *	   accidentally interpret a response to our request as a user-
- *	   initiated action, the window will stop responding to new geometry
- *	   requests. To make this distinction, (a) this function sets a flag
- *	   for TopLevelEventProc to indicate that we're waiting to sync with
- *	   the wm, and (b) all changes to the size of a top-level window are
- *	   followed by calls to this function.
- *	2. Races and confusion can come about if there are multiple operations
- *	   outstanding at a time (e.g. two different resizes of the top-level
- *	   window: it's hard to tell which of the ConfigureNotify events
- *	   coming back is for which request).
- *	While waiting, some events covered by StructureNotifyMask are
- *	processed (ConfigureNotify, MapNotify, and UnmapNotify) and all others
- *	are deferred.
+ *	Sets WM_SYNC_PENDING, which makes ConfigureEvent treat incoming
+ *	geometry changes as responses to our own requests rather than as
+ *	user-initiated ones. The flag is cleared by EndSync when the
+ *	expected event arrives, or by SyncTimeoutProc if the window manager
+ *	decides to ignore the request (e.g. because it thinks the window is
+ *	already in the right place).
  *
  *----------------------------------------------------------------------
  */
 
 static void
-WaitForConfigureNotify(
-    TkWindow *winPtr,		/* Top-level window for which we want to see a
-				 * ConfigureNotify. */
-    unsigned long serial)	/* Serial number of resize request. Want to be
-				 * sure wm has seen this. */
+BeginSync(
+    TkWindow *winPtr,		/* Top-level window of interest. */
+    int type,			/* Type of event that will acknowledge the
+				 * request: ConfigureNotify, MapNotify or
+				 * UnmapNotify. */
+    unsigned long serial)	/* For ConfigureNotify, serial number of the
+				 * configure request; the acknowledging event
+				 * must carry at least this serial. Ignored
+				 * for the other event types. */
 {
     WmInfo *wmPtr = winPtr->wmInfoPtr;
-    XEvent event;
-    int diff, code;
-    int gotConfig = 0;
-
-    /*
-     * One more tricky detail about this function. In some cases the window
-     * manager will decide to ignore a configure request (e.g. because it
-     * thinks the window is already in the right place). To avoid hanging in
-     * this situation, only wait for a few seconds, then give up.
-     */
 
-    while (!gotConfig) {
-	wmPtr->flags |= WM_SYNC_PENDING;
-	code = WaitForEvent(winPtr->display, wmPtr, ConfigureNotify, &event);
-	wmPtr->flags &= ~WM_SYNC_PENDING;
-	if (code != TCL_OK) {
-	    if (winPtr->dispPtr->flags & TK_DISPLAY_WM_TRACING) {
-		printf("WaitForConfigureNotify giving up on %s\n",
-			winPtr->pathName);
-	    }
-	    break;
-	}
-	diff = event.xconfigure.serial - serial;
-	if (diff >= 0) {
-	    gotConfig = 1;
-	}
-    }
-    wmPtr->flags &= ~WM_MOVE_PENDING;
-    if (winPtr->dispPtr->flags & TK_DISPLAY_WM_TRACING) {
-	printf("WaitForConfigureNotify finished with %s, serial %ld\n",
-		winPtr->pathName, serial);
+    if ((type == MapNotify) && (winPtr->flags & TK_MAPPED)) {
+	return;
     }
-}
-
-/*
- *----------------------------------------------------------------------
- *
- * WaitForEvent --
- *
- *	This function is used by WaitForConfigureNotify and WaitForMapNotify
- *	to wait for an event of a certain type to arrive.
- *
- * Results:
- *	Under normal conditions, TCL_OK is returned and an event for display
- *	and window that matches "mask" is stored in *eventPtr. This event has
- *	already been processed by Tk before this function returns. If a long
- *	time goes by with no event of the right type arriving, or if an error
- *	occurs while waiting for the event to arrive, then TCL_ERROR is
- *	returned.
- *
- * Side effects:
- *	While waiting for the desired event to occur, Configurenotify,
- *	MapNotify, and UnmapNotify events for window are processed, as are all
- *	ReparentNotify events.
- *
- *----------------------------------------------------------------------
- */
-
-static int
-WaitForEvent(
-    Display *display,		/* Display event is coming from. */
-    WmInfo *wmInfoPtr,		/* Window for which event is desired. */
-    int type,			/* Type of event that is wanted. */
-    XEvent *eventPtr)		/* Place to store event. */
-{
-    WaitRestrictInfo info;
-    Tk_RestrictProc *prevProc;
-    void *prevArg;
-    Tcl_Time timeout;
-
-    /*
-     * Set up an event filter to select just the events we want, and a timer
-     * handler, then wait for events until we get the event we want or a
-     * timeout happens.
-     */
-
-    info.display = display;
-    info.wmInfoPtr = wmInfoPtr;
-    info.type = type;
-    info.eventPtr = eventPtr;
-    info.foundEvent = 0;
-    prevProc = Tk_RestrictEvents(WaitRestrictProc, &info, &prevArg);
-
-    Tcl_GetTime(&timeout);
-    timeout.sec += 2;
-
-    while (!info.foundEvent) {
-	if (!TkUnixDoOneXEvent(&timeout)) {
-	    break;
-	}
+    if ((type == UnmapNotify) && !(winPtr->flags & TK_MAPPED)) {
+	return;
     }
-    Tk_RestrictEvents(prevProc, prevArg, &prevArg);
-    if (info.foundEvent) {
-	return TCL_OK;
+    wmPtr->syncEvent = type;
+    wmPtr->syncSerial = serial;
+    wmPtr->flags |= WM_SYNC_PENDING;
+    if (wmPtr->syncTimer != NULL) {
+	Tcl_DeleteTimerHandler(wmPtr->syncTimer);
     }
-    return TCL_ERROR;
+    wmPtr->syncTimer = Tcl_CreateTimerHandler(2000, SyncTimeoutProc, wmPtr);
 }
 
 /*
  *----------------------------------------------------------------------
  *
- * WaitRestrictProc --
+ * EndSync --
  *
- *	This function is a Tk_RestrictProc that is used to filter events while
- *	WaitForEvent is active.
+ *	This function is invoked by ConfigureEvent and WrapperEventProc when
+ *	the event that acknowledges an outstanding window manager request
+ *	arrives, ending the synchronization started by BeginSync.
  *
  * Results:
- *	Returns TK_PROCESS_EVENT if the right event is found. Also returns
- *	TK_PROCESS_EVENT if any ReparentNotify event is found or if the event
- *	is a ConfigureNotify, MapNotify, or UnmapNotify for window. Otherwise
- *	returns TK_DEFER_EVENT.
+ *	None.
  *
  * Side effects:
- *	An event may get stored in the area indicated by the caller of
- *	WaitForEvent.
+ *	Clears WM_SYNC_PENDING and WM_MOVE_PENDING, so subsequent
+ *	ConfigureNotify events are treated as user actions again.
  *
  *----------------------------------------------------------------------
  */
 
-static Tk_RestrictAction
-WaitRestrictProc(
-    void *clientData,	/* Pointer to WaitRestrictInfo structure. */
-    XEvent *eventPtr)		/* Event that is about to be handled. */
+static void
+EndSync(
+    WmInfo *wmPtr)		/* Top-level window whose expected event has
+				 * arrived. */
 {
-    WaitRestrictInfo *infoPtr = (WaitRestrictInfo *)clientData;
-
-    if (eventPtr->type == ReparentNotify) {
-	return TK_PROCESS_EVENT;
-    }
-    if (((eventPtr->xany.window != infoPtr->wmInfoPtr->wrapperPtr->window)
-	    && (eventPtr->xany.window != infoPtr->wmInfoPtr->reparent))
-	    || (eventPtr->xany.display != infoPtr->display)) {
-	return TK_DEFER_EVENT;
+    wmPtr->flags &= ~(WM_SYNC_PENDING|WM_MOVE_PENDING);
+    if (wmPtr->syncTimer != NULL) {
+	Tcl_DeleteTimerHandler(wmPtr->syncTimer);
+	wmPtr->syncTimer = NULL;
     }
-    if (eventPtr->type == infoPtr->type) {
-	*infoPtr->eventPtr = *eventPtr;
-	infoPtr->foundEvent = 1;
-	return TK_PROCESS_EVENT;
+    if (wmPtr->winPtr->dispPtr->flags & TK_DISPLAY_WM_TRACING) {
+	printf("EndSync finished with %s, serial %ld\n",
+		wmPtr->winPtr->pathName, wmPtr->syncSerial);
     }
-    if (eventPtr->type == ConfigureNotify || eventPtr->type == MapNotify
-	    || eventPtr->type == UnmapNotify) {
-	return TK_PROCESS_EVENT;
-    }
-    return TK_DEFER_EVENT;
 }
 
 /*
  *----------------------------------------------------------------------
  *
- * WaitForMapNotify --
+ * SyncTimeoutProc --
  *
- *	This function is invoked in order to synchronize with the window
- *	manager. It waits for the window's mapped state to reach the value
- *	given by mapped.
+ *	Timer handler invoked when the window manager has not responded to a
+ *	request within a reasonable time. In some cases the window manager
+ *	will decide to ignore a request (e.g. because it thinks the window
+ *	is already in the right place), or it can't respond (e.g. if we've
+ *	got a grab set); to avoid treating the user's actions as our own
+ *	forever in that situation, give up on the acknowledgement.
  *
  * Results:
  *	None.
  *
  * Side effects:
- *	Delays the execution of the process until winPtr becomes mapped or
- *	unmapped, depending on the "mapped" argument. This allows us to
- *	synchronize with the window manager, and allows us to identify changes
- *	in window size that come about when the window manager first starts
- *	managing the window (as opposed to those requested interactively by
- *	the user later). See the comments for WaitForConfigureNotify and
- *	WM_SYNC_PENDING. While waiting, some events covered by
- *	StructureNotifyMask are processed and all others are deferred.
+ *	Clears WM_SYNC_PENDING and WM_MOVE_PENDING.
  *
  *----------------------------------------------------------------------
  */
 
 static void
-WaitForMapNotify(
-    TkWindow *winPtr,		/* Top-level window for which we want to see a
-				 * particular mapping state. */
-    int mapped)			/* If non-zero, wait for window to become
-				 * mapped, otherwise wait for it to become
-				 * unmapped. */
+SyncTimeoutProc(
+    void *clientData)		/* Pointer to WmInfo structure. */
 {
-    WmInfo *wmPtr = winPtr->wmInfoPtr;
-    XEvent event;
-    int code;
-
-    while (1) {
-	if (mapped) {
-	    if (winPtr->flags & TK_MAPPED) {
-		break;
-	    }
-	} else if (!(winPtr->flags & TK_MAPPED)) {
-	    break;
-	}
-	wmPtr->flags |= WM_SYNC_PENDING;
-	code = WaitForEvent(winPtr->display, wmPtr,
-		mapped ? MapNotify : UnmapNotify, &event);
-	wmPtr->flags &= ~WM_SYNC_PENDING;
-	if (code != TCL_OK) {
-	    /*
-	     * There are some bizarre situations in which the window manager
-	     * can't respond or chooses not to (e.g. if we've got a grab set
-	     * it can't respond). If this happens then just quit.
-	     */
+    WmInfo *wmPtr = (WmInfo *)clientData;
 
-	    if (winPtr->dispPtr->flags & TK_DISPLAY_WM_TRACING) {
-		printf("WaitForMapNotify giving up on %s\n", winPtr->pathName);
-	    }
-	    break;
-	}
-    }
-    wmPtr->flags &= ~WM_MOVE_PENDING;
-    if (winPtr->dispPtr->flags & TK_DISPLAY_WM_TRACING) {
-	printf("WaitForMapNotify finished with %s (winPtr %p, wmPtr %p)\n",
-		winPtr->pathName, winPtr, wmPtr);
+    wmPtr->syncTimer = NULL;
+    wmPtr->flags &= ~(WM_SYNC_PENDING|WM_MOVE_PENDING);
+    if (wmPtr->winPtr->dispPtr->flags & TK_DISPLAY_WM_TRACING) {
+	printf("SyncTimeoutProc giving up on %s\n",
+		wmPtr->winPtr->pathName);
     }
 }
 
@@ -7443,7 +7421,7 @@ TkpWmSetState(
 		winPtr->screenNum) == 0) {
 	    return 0;
 	}
-	WaitForMapNotify(winPtr, 0);
+	BeginSync(winPtr, UnmapNotify, 0);
     } else if (state == NormalState) {
 	wmPtr->hints.initial_state = NormalState;
 	wmPtr->withdrawn = 0;
@@ -7466,7 +7444,7 @@ TkpWmSetState(
 		    winPtr->screenNum) == 0) {
 		return 0;
 	    }
-	    WaitForMapNotify(winPtr, 0);
+	    BeginSync(winPtr, UnmapNotify, 0);
 	}
     }
 
@@ -957,6 +957,59 @@ XDrawLines(
     return Success;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * XDrawSegments --
+ *
+ *	Draw a number of unconnected lines.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Renders the given segments, sharing a single DC and pen for the
+ *	whole batch.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+XDrawSegments(
+    Display *display,
+    Drawable d,
+    GC gc,
+    XSegment *segments,
+    int nsegments)
+{
+    HPEN pen;
+    TkWinDCState state;
+    HDC dc;
+    int i;
+
+    if (d == None) {
+	return BadDrawable;
+    }
+
+    dc = TkWinGetDrawableDC(display, d, &state);
+
+    pen = SetUpGraphicsPort(gc);
+    SetBkMode(dc, TRANSPARENT);
+    for (i = 0; i < nsegments; i++) {
+	XPoint points[2];
+
+	points[0].x = segments[i].x1;
+	points[0].y = segments[i].y1;
+	points[1].x = segments[i].x2;
+	points[1].y = segments[i].y2;
+	RenderObject(dc, gc, points, 2, CoordModeOrigin, pen, Polyline);
+    }
+    DeleteObject(pen);
+
+    TkWinReleaseDrawableDC(d, dc, &state);
+    return Success;
+}
+
 /*
  *----------------------------------------------------------------------
  *
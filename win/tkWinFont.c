@@ -1972,6 +1972,21 @@ FindSubFontForChar(
     Tcl_DStringInit(&ds);
     hdc = GetDC(fontPtr->hwnd);
 
+    /*
+     * If another font instance has already resolved a fallback for this
+     * block of characters, try that family first; this usually turns the
+     * probe storm below into a single probe.
+     */
+
+    fallbackName = TkFontFallbackLookup(ch);
+    if (fallbackName != NULL) {
+	subFontPtr = CanUseFallbackWithAliases(hdc, fontPtr, fallbackName,
+		ch, &ds, subFontPtrPtr);
+	if (subFontPtr != NULL) {
+	    goto end;
+	}
+    }
+
     aliases = TkFontGetAliasList(fontPtr->font.fa.family);
 
     fontFallbacks = TkFontGetFallbacks();
@@ -2009,6 +2024,7 @@ FindSubFontForChar(
 	    subFontPtr = CanUseFallbackWithAliases(hdc, fontPtr, fallbackName,
 		    ch, &ds, subFontPtrPtr);
 	    if (subFontPtr != NULL) {
+		TkFontFallbackRemember(ch, fallbackName);
 		goto end;
 	    }
 	}
@@ -2024,6 +2040,7 @@ FindSubFontForChar(
 	subFontPtr = CanUseFallbackWithAliases(hdc, fontPtr, fallbackName,
 		ch, &ds, subFontPtrPtr);
 	if (subFontPtr != NULL) {
+	    TkFontFallbackRemember(ch, fallbackName);
 	    goto end;
 	}
     }
@@ -2090,6 +2107,7 @@ WinFontCanUseProc(
 	subFontPtr = CanUseFallback(hdc, fontPtr, fallbackName, ch,
 		canUsePtr->subFontPtrPtr);
 	if (subFontPtr != NULL) {
+	    TkFontFallbackRemember(ch, fallbackName);
 	    canUsePtr->subFontPtr = subFontPtr;
 	    Tcl_DStringFree(&faceString);
 	    return 0;
@@ -372,7 +372,8 @@ static int GdiPhoto(
     Tcl_Obj *const *objv)
 {
     static const char usage_message[] =
-	"::tk::print::_gdi photo hdc [-destination x y [w [h]]] -photo name\n";
+	"::tk::print::_gdi photo hdc [-destination x y [w [h]]] "
+	"[-bandheight n] -photo name\n";
     HDC dst;
     int dst_x = 0, dst_y = 0, dst_w = 0, dst_h = 0;
     int nx, ny, sll;
@@ -385,6 +386,12 @@ static int GdiPhoto(
     POINT pt;			/* For saving the brush org. */
     char *pbuf = NULL;
     int i, j, k;
+    int bandHeight = 256;	/* Rows converted and sent per StretchDIBits
+				 * call; bounds peak memory for large photos
+				 * and lets the spooler start consuming the
+				 * page while later bands are still being
+				 * converted. */
+    int bandY, bandRows, stripY, stripH;
     int retval = TCL_OK;
 
     /*
@@ -440,6 +447,14 @@ static int GdiPhoto(
 		dst_w = (int) w;
 		dst_h = (int) h;
 	    }
+	} else if (strcmp(Tcl_GetString(objv[j]), "-bandheight") == 0) {
+	    if (j + 1 >= argc || Tcl_GetIntFromObj(interp, objv[++j],
+		    &bandHeight) != TCL_OK || bandHeight <= 0) {
+		Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+			"-bandheight requires a positive integer\n%s",
+			usage_message));
+		return TCL_ERROR;
+	    }
 	} else if (strcmp(Tcl_GetString(objv[j]), "-photo") == 0) {
 	    photoname = Tcl_GetString(objv[++j]);
 	}
@@ -464,13 +479,19 @@ static int GdiPhoto(
     nx  = img_block.width;
     ny  = img_block.height;
     sll = ((3*nx + 3) / 4)*4; /* Must be multiple of 4. */
+    if (bandHeight > ny) {
+	bandHeight = ny;
+    }
 
     /*
-     * Buffer is potentially large enough that failure to allocate might be
+     * The image is converted and sent to the device one band of at most
+     * bandHeight rows at a time, reusing this buffer, so peak memory stays
+     * bounded no matter how large the photo is. The buffer is still
+     * potentially large enough that failure to allocate might be
      * recoverable.
      */
 
-    pbuf = (char *)attemptckalloc(sll * ny * sizeof(char));
+    pbuf = (char *)attemptckalloc(sll * bandHeight * sizeof(char));
     if (pbuf == 0) { /* Memory allocation failure. */
 	Tcl_AppendResult(interp,
 		"::tk::print::_gdi photo failed--out of memory", NULL);
@@ -479,18 +500,6 @@ static int GdiPhoto(
 
     /* After this, all returns must go through retval. */
 
-    /* BITMAP expects BGR; photo provides RGB. */
-    for (k = 0; k < ny; k++) {
-	for (i = 0; i < nx; i++) {
-	    pbuf[k*sll + 3*i] = img_block.pixelPtr[
-		    k*img_block.pitch + i*img_block.pixelSize + img_block.offset[2]];
-	    pbuf[k*sll + 3*i + 1] = img_block.pixelPtr[
-		    k*img_block.pitch + i*img_block.pixelSize + img_block.offset[1]];
-	    pbuf[k*sll + 3*i + 2] = img_block.pixelPtr[
-		    k*img_block.pitch + i*img_block.pixelSize + img_block.offset[0]];
-	}
-    }
-
     memset(&bitmapinfo, 0L, sizeof(BITMAPINFO));
 
     bitmapinfo.bmiHeader.biSize          = sizeof(BITMAPINFOHEADER);
@@ -519,14 +528,49 @@ static int GdiPhoto(
 	dst_h = ny*dst_w / nx;
     }
 
-    if (StretchDIBits(dst, dst_x, dst_y, dst_w, dst_h, 0, 0, nx, ny,
-	    pbuf, &bitmapinfo, DIB_RGB_COLORS, SRCCOPY) == (int)GDI_ERROR) {
-	int errcode = GetLastError();
+    for (bandY = 0; bandY < ny; bandY += bandHeight) {
+	bandRows = ny - bandY;
+	if (bandRows > bandHeight) {
+	    bandRows = bandHeight;
+	}
 
-	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
-		"::tk::print::_gdi photo internal failure: "
-		"StretchDIBits error code %d", errcode));
-	retval = TCL_ERROR;
+	/* BITMAP expects BGR; photo provides RGB. */
+	for (k = 0; k < bandRows; k++) {
+	    for (i = 0; i < nx; i++) {
+		pbuf[k*sll + 3*i] = img_block.pixelPtr[
+			(bandY+k)*img_block.pitch + i*img_block.pixelSize + img_block.offset[2]];
+		pbuf[k*sll + 3*i + 1] = img_block.pixelPtr[
+			(bandY+k)*img_block.pitch + i*img_block.pixelSize + img_block.offset[1]];
+		pbuf[k*sll + 3*i + 2] = img_block.pixelPtr[
+			(bandY+k)*img_block.pitch + i*img_block.pixelSize + img_block.offset[0]];
+	    }
+	}
+
+	/*
+	 * Each band is its own top-down DIB, mapped onto the destination
+	 * strip that its source rows scale to; strips that round to zero
+	 * height when shrinking contribute no output.
+	 */
+
+	bitmapinfo.bmiHeader.biHeight = -bandRows;
+	stripY = dst_y + (int) ((bandY * (double) dst_h) / ny);
+	stripH = dst_y + (int) (((bandY + bandRows) * (double) dst_h) / ny)
+		- stripY;
+	if (stripH <= 0) {
+	    continue;
+	}
+
+	if (StretchDIBits(dst, dst_x, stripY, dst_w, stripH, 0, 0,
+		nx, bandRows, pbuf, &bitmapinfo, DIB_RGB_COLORS,
+		SRCCOPY) == (int)GDI_ERROR) {
+	    int errcode = GetLastError();
+
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "::tk::print::_gdi photo internal failure: "
+		    "StretchDIBits error code %d", errcode));
+	    retval = TCL_ERROR;
+	    break;
+	}
     }
 
     /* Clean up the hDC. */
@@ -502,6 +502,9 @@ static int		WmStateCmd(Tk_Window tkwin,
 static int		WmTitleCmd(Tk_Window tkwin,
 			    TkWindow *winPtr, Tcl_Interp *interp, Tcl_Size objc,
 			    Tcl_Obj *const objv[]);
+static int		WmTransactionCmd(Tk_Window tkwin,
+			    TkWindow *winPtr, Tcl_Interp *interp, Tcl_Size objc,
+			    Tcl_Obj *const objv[]);
 static int		WmTransientCmd(Tk_Window tkwin,
 			    TkWindow *winPtr, Tcl_Interp *interp, Tcl_Size objc,
 			    Tcl_Obj *const objv[]);
@@ -2668,7 +2671,7 @@ Tk_WmObjCmd(
 	"iconphoto", "iconposition",
 	"iconwindow", "manage", "maxsize", "minsize", "overrideredirect",
 	"positionfrom", "protocol", "resizable", "sizefrom",
-	"stackorder", "state", "title", "transient",
+	"stackorder", "state", "title", "transaction", "transient",
 	"withdraw", NULL
     };
     enum options {
@@ -2681,8 +2684,8 @@ Tk_WmObjCmd(
 	WMOPT_ICONWINDOW, WMOPT_MANAGE, WMOPT_MAXSIZE, WMOPT_MINSIZE,
 	WMOPT_OVERRIDEREDIRECT,
 	WMOPT_POSITIONFROM, WMOPT_PROTOCOL, WMOPT_RESIZABLE, WMOPT_SIZEFROM,
-	WMOPT_STACKORDER, WMOPT_STATE, WMOPT_TITLE, WMOPT_TRANSIENT,
-	WMOPT_WITHDRAW
+	WMOPT_STACKORDER, WMOPT_STATE, WMOPT_TITLE, WMOPT_TRANSACTION,
+	WMOPT_TRANSIENT, WMOPT_WITHDRAW
     };
     int index;
     Tcl_Size length;
@@ -2806,6 +2809,8 @@ Tk_WmObjCmd(
 	return WmStateCmd(tkwin, winPtr, interp, objc, objv);
     case WMOPT_TITLE:
 	return WmTitleCmd(tkwin, winPtr, interp, objc, objv);
+    case WMOPT_TRANSACTION:
+	return WmTransactionCmd(tkwin, winPtr, interp, objc, objv);
     case WMOPT_TRANSIENT:
 	return WmTransientCmd(tkwin, winPtr, interp, objc, objv);
     case WMOPT_WITHDRAW:
@@ -5419,6 +5424,50 @@ WmTitleCmd(
     return TCL_OK;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * WmTransactionCmd --
+ *
+ *	This function is invoked to process the "wm transaction" Tcl command.
+ *	See the user documentation for details on what it does.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	See the user documentation.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+WmTransactionCmd(
+    TCL_UNUSED(Tk_Window),	/* Main window of the application. */
+    TkWindow *winPtr,		/* Toplevel to work with */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    Tcl_Size objc,		/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    static const char *const optionStrings[] = {
+	"begin", "commit", NULL };
+    enum transOptions { TRANS_BEGIN, TRANS_COMMIT };
+    int index;
+
+    if (objc != 4) {
+	Tcl_WrongNumArgs(interp, 2, objv, "window begin|commit");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObjStruct(interp, objv[3], optionStrings,
+	    sizeof(char *), "option", 0, &index) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (index == TRANS_BEGIN) {
+	return TkWmTransactionBegin(interp, winPtr);
+    }
+    return TkWmTransactionCommit(interp, winPtr);
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -329,6 +329,60 @@ colorcmp(
     return r;
 }
 
+/*
+ * Hash index over the xColors table. Each slot holds 0 when empty, or
+ * ((letter index << 8) | (table index + 1)) for one table entry. The index
+ * is built once, on the first named-color lookup, from the table itself so
+ * it can never fall out of step with it; after that every lookup is a
+ * single hash probe (plus linear probing on the rare collision), with each
+ * candidate still verified by colorcmp() so that the special cases that
+ * routine knows about - case folding, numbered variants, names such as
+ * "gray0" and rejected spellings such as "burly wood" - behave exactly as
+ * they did with the binary search this replaces.
+ */
+
+#define COLOR_HASH_SIZE	512	/* Power of 2, > twice the number of
+				 * entries in xColors. */
+#define COLOR_HASH_MASK	(COLOR_HASH_SIZE - 1)
+
+static unsigned short colorHash[COLOR_HASH_SIZE];
+static int colorHashInitialized = 0;
+TCL_DECLARE_MUTEX(colorHashMutex)
+
+static void
+InitColorHash(void)
+{
+    unsigned h, slot;
+    int r, i, j, c;
+
+    for (r = 0; r < (int) sizeof(az) - 1; r++) {
+	for (i = az[r]; i < az[r + 1]; i++) {
+	    const char *name = xColors[i];
+
+	    if (name[0] & 0x80) {
+		/*
+		 * Placeholder entry (there are no colors starting with
+		 * 'e'); nothing can match it.
+		 */
+
+		continue;
+	    }
+	    h = (unsigned) ('a' + r);
+	    for (j = 0; (c = UCHAR(name[j])) != 0; j++) {
+		if ((unsigned) (c - 'A') <= (unsigned) ('Z' - 'A')) {
+		    c += 'a' - 'A';
+		}
+		h = h * 33 + (unsigned) c;
+	    }
+	    slot = h & COLOR_HASH_MASK;
+	    while (colorHash[slot] != 0) {
+		slot = (slot + 1) & COLOR_HASH_MASK;
+	    }
+	    colorHash[slot] = (unsigned short) ((r << 8) | (i + 1));
+	}
+    }
+}
+
 #define RED(p)		((unsigned char) (p)[0])
 #define GREEN(p)	((unsigned char) (p)[1])
 #define BLUE(p)		((unsigned char) (p)[2])
@@ -381,36 +435,71 @@ XParseColor(
 	}
     } else {
 	/*
-	 * Perform a binary search on the sorted array of colors.
-	 * size = current size of search range
-	 * p    = pointer to current element being considered.
+	 * Look the name up in the hash index over the color table, built on
+	 * first use.
 	 */
 
-	int size, num;
+	int num, c;
 	const elem *p;
-	const char *q;
+	const char *q, *s;
+	unsigned h, slot;
 	int r = (spec[0] - 'A') & 0xdf;
 
 	if (r >= (int) sizeof(az) - 1) {
 	    return 0;
 	}
-	size = az[r + 1] - az[r];
-	p = &xColors[(az[r + 1] + az[r]) >> 1];
-	r = colorcmp(spec + 1, *p, &num);
+	if (!colorHashInitialized) {
+	    Tcl_MutexLock(&colorHashMutex);
+	    if (!colorHashInitialized) {
+		InitColorHash();
+		colorHashInitialized = 1;
+	    }
+	    Tcl_MutexUnlock(&colorHashMutex);
+	}
+
+	/*
+	 * Hash the leading letters of the name, folding case the same way
+	 * the index was built, plus a single following '0' so that "gray0"
+	 * and "grey0" find their own entries. Spaces are skipped, since
+	 * colorcmp() allows them in front of a capital ("alice blue"); it
+	 * is left to that routine to reject them elsewhere ("burly wood"),
+	 * and to parse and validate any numbered variant suffix.
+	 */
 
-	while (r != 0) {
-	    if (r < 0) {
-		size = (size >> 1);
-		p -= ((size + 1) >> 1);
-	    } else {
-		--size;
-		size = (size >> 1);
-		p += ((size + 2) >> 1);
+	h = (unsigned) (r + 'a');
+	s = spec + 1;
+	while ((c = UCHAR(*s)) != 0) {
+	    if (c == ' ') {
+		s++;
+		continue;
 	    }
-	    if (!size) {
-		return 0;
+	    if ((unsigned) (c - 'A') <= (unsigned) ('Z' - 'A')) {
+		c += 'a' - 'A';
+	    } else if ((unsigned) (c - 'a') > (unsigned) ('z' - 'a')) {
+		break;
 	    }
-	    r = colorcmp(spec + 1, *p, &num);
+	    h = h * 33 + (unsigned) c;
+	    s++;
+	}
+	if (c == '0') {
+	    h = h * 33 + '0';
+	}
+
+	num = 0;
+	p = NULL;
+	for (slot = h & COLOR_HASH_MASK; colorHash[slot] != 0;
+		slot = (slot + 1) & COLOR_HASH_MASK) {
+	    if ((colorHash[slot] >> 8) != r) {
+		continue;
+	    }
+	    p = &xColors[(colorHash[slot] & 0xff) - 1];
+	    if (colorcmp(spec + 1, *p, &num) == 0) {
+		break;
+	    }
+	    p = NULL;
+	}
+	if (p == NULL) {
+	    return 0;
 	}
 	if (num > (*p)[31]) {
 	    if (((*p)[31] != 8) || num > 100) {
@@ -538,7 +538,7 @@ XDrawPoints(
     return res;
 }
 
-#if !defined(MAC_OSX_TK)
+#if !defined(MAC_OSX_TK) && !defined(_WIN32)
 int
 XDrawSegments(
     TCL_UNUSED(Display *),
@@ -41,6 +41,42 @@ XInternAtom(
     return ++atom;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * XInternAtoms --
+ *
+ *	This procedure simulates the XInternAtoms function, which interns a
+ *	whole list of atom names with one server round trip, by interning
+ *	each name in turn. There is no round trip to save here; the routine
+ *	exists so that generic code may batch its requests for the benefit
+ *	of the unix port.
+ *
+ * Results:
+ *	Returns non-zero and fills in atoms_return.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Status
+XInternAtoms(
+    Display *display,
+    char **names,
+    int count,
+    Bool onlyIfExists,
+    Atom *atoms_return)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+	atoms_return[i] = XInternAtom(display, names[i], onlyIfExists);
+    }
+    return 1;
+}
+
 /*
  *----------------------------------------------------------------------
  *